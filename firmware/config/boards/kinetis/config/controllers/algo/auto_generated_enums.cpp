@@ -399,8 +399,10 @@ case DBG_2:
   return "DBG_2";
 case DBG_BOOST:
   return "DBG_BOOST";
-case DBG_37:
-  return "DBG_37";
+case DBG_ISR_BUDGET:
+  return "DBG_ISR_BUDGET";
+case DBG_SENSOR_FRESHNESS:
+  return "DBG_SENSOR_FRESHNESS";
 case DBG_ALTERNATOR_PID:
   return "DBG_ALTERNATOR_PID";
 case DBG_ANALOG_INPUTS:
@@ -1896,8 +1896,9 @@ struct engine_configuration_s {
 	offset 1476 bit 3 */
 	bool secondTriggerChannelEnabled : 1;
 	/**
+	 * FSIO expressions #3 and #4 supply aux valve open/close angles instead of the fsioCurve1/fsioCurve2 TPS curves
 	offset 1476 bit 4 */
-	bool unusedBit4_1476 : 1;
+	bool useFSIOForAuxValveAngles : 1;
 	/**
 	offset 1476 bit 5 */
 	bool isMapAveragingEnabled : 1;
@@ -31,5 +31,13 @@ ifeq ($(EFI_FATAL_ERROR_PIN),)
 endif
 
 
+# Injectors and coils are wired to MCU pins on this board, enable the inlined
+# single-store path for engine-cycle pin edges
+DDEFS += -DEFI_BOARD_INJECTOR_COIL_PINS_ONCHIP=TRUE
+
+# Board feature manifest: no HIP9011 knock chip, no CJ125 controller and no LCD
+# header on this board, see board_features.h
+DDEFS += -DBOARD_HAS_HIP9011=FALSE -DBOARD_HAS_CJ125=FALSE -DBOARD_HAS_HD44780_LCD=FALSE
+
 # Add them all together
 DDEFS += $(MCU_DEFS) -DEFI_USE_OSC=TRUE -DFIRMWARE_ID=\"microRusEfi\" $(DEFAULT_ENGINE_TYPE)
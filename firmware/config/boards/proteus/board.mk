@@ -9,4 +9,8 @@ BOARDINC = $(PROJECT_DIR)/config/boards/nucleo_f767 $(PROJECT_DIR)/config/stm32f
 LDSCRIPT= $(PROJECT_DIR)/config/boards/nucleo_f767/STM32F76xxI.ld
 
 # Override DEFAULT_ENGINE_TYPE
+# Board feature manifest: no HIP9011 knock chip, no CJ125 controller and no LCD
+# header on this board, see board_features.h
+DDEFS += -DBOARD_HAS_HIP9011=FALSE -DBOARD_HAS_CJ125=FALSE -DBOARD_HAS_HD44780_LCD=FALSE
+
 DDEFS += -DSTM32F767xx -DEFI_USE_OSC=TRUE -DEFI_FATAL_ERROR_PIN=GPIOE_3 -DFIRMWARE_ID=\"proteus\" -DDEFAULT_ENGINE_TYPE=PROTEUS -DUSE_ADC3_VBATT_HACK -DSTM32_ADC_USE_ADC3=TRUE
@@ -18,6 +18,9 @@ extern "C"
 #endif /* __cplusplus */
  #ifndef __ASSEMBLER__
  void firmwareError(obd_code_e code, const char *fmt, ...);
+ // idle thread accounting for the CPU utilization gauge, see cpu_load.cpp
+ void onIdleEnterHook(void);
+ void onIdleLeaveHook(void);
   #if ENABLE_PERF_TRACE
     void irqEnterHook(void);
     void irqExitHook(void);
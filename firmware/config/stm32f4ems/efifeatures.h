@@ -11,17 +11,112 @@
 
 #define EFI_GPIO_HARDWARE TRUE
 
+/**
+ * Bit-trick approximations of log/exp/reciprocal instead of libm on hot paths,
+ * see util/math/fast_math.cpp. Accuracy is way beyond sensor noise.
+ */
+#ifndef EFI_FAST_MATH
+#define EFI_FAST_MATH TRUE
+#endif
+
+/**
+ * Boards from config/boards whose injector and coil outputs all live on MCU
+ * ports can bypass the gpiochip dispatch for engine-cycle pin edges, see
+ * OutputPin::setOnchipValue. Smart-GPIO routed outputs keep the generic
+ * setValue() path. Set from board.mk: DDEFS += -DEFI_BOARD_INJECTOR_COIL_PINS_ONCHIP=TRUE
+ */
+#ifndef EFI_BOARD_INJECTOR_COIL_PINS_ONCHIP
+#define EFI_BOARD_INJECTOR_COIL_PINS_ONCHIP FALSE
+#endif
+
 #define EFI_BOOST_CONTROL TRUE
 #define EFI_FSIO TRUE
 
+/**
+ * Boards with fixed production logic can run the system relay expressions as
+ * generated native code instead of the RPN interpreter, see system_fsio_native.h
+ * and gen_system_fsio.bat. Runtime FSIO remains available for user expressions.
+ */
+#ifndef EFI_USE_NATIVE_SYSTEM_FSIO
+#define EFI_USE_NATIVE_SYSTEM_FSIO FALSE
+#endif
+
+/**
+ * Re-evaluate user FSIO outputs only when one of their inputs moved past a
+ * deadband, with a max-staleness fallback tick - see runFsio in fsio_impl.cpp
+ */
+#ifndef EFI_FSIO_EVENT_DRIVEN
+#define EFI_FSIO_EVENT_DRIVEN TRUE
+#endif
+
 #ifndef EFI_CDM_INTEGRATION
 #define EFI_CDM_INTEGRATION TRUE
 #endif
 
+/**
+ * Shadow-mode second tune for A/B comparison, see shadow_tune.cpp
+ */
+#ifndef EFI_SHADOW_TUNE
+#define EFI_SHADOW_TUNE TRUE
+#endif
+
+/**
+ * Concurrent key-on initialization, see prearm.cpp
+ */
+#ifndef EFI_KEYON_PREARM
+#define EFI_KEYON_PREARM TRUE
+#endif
+
+/**
+ * Incremental async sensor calibration jobs, see sensor_calibration.cpp
+ */
+#ifndef EFI_SENSOR_CALIBRATION
+#define EFI_SENSOR_CALIBRATION TRUE
+#endif
+
+/**
+ * Cylinder-sequenced DFCO entry/exit, see dfco_sequencer.cpp
+ */
+#ifndef EFI_DFCO_SEQUENCER
+#define EFI_DFCO_SEQUENCER TRUE
+#endif
+
+/**
+ * ADC batch-completion conversion stage, see adc_transforms.cpp
+ */
+#ifndef EFI_ADC_TRANSFORMS
+#define EFI_ADC_TRANSFORMS TRUE
+#endif
+
+/**
+ * Debounced switch input framework, see switch_inputs.cpp
+ */
+#ifndef EFI_SWITCH_INPUTS
+#define EFI_SWITCH_INPUTS TRUE
+#endif
+
+/**
+ * Always-on actuator edge ring in CCM RAM, see flight_recorder.cpp
+ */
+#ifndef EFI_FLIGHT_RECORDER
+#define EFI_FLIGHT_RECORDER TRUE
+#endif
+
+/**
+ * Trigger sync preservation across controlled resets, see warm_boot.cpp
+ */
+#ifndef EFI_WARM_BOOT
+#define EFI_WARM_BOOT TRUE
+#endif
+
 #ifndef EFI_TOOTH_LOGGER
 #define EFI_TOOTH_LOGGER TRUE
 #endif
 
+#ifndef EFI_DATALOG_STREAM
+#define EFI_DATALOG_STREAM TRUE
+#endif
+
 #define EFI_TEXT_LOGGING TRUE
 
 #define EFI_PWM_TESTER FALSE
@@ -66,6 +161,29 @@
 #define EFI_ICU_INPUTS TRUE
 #endif
 
+/**
+ * Output timing self-measurement via a loopback jumper wire, see timing_loopback.cpp
+ */
+#ifndef EFI_TIMING_LOOPBACK
+#define EFI_TIMING_LOOPBACK TRUE
+#endif
+
+/**
+ * DWT watchpoint write tracer for chasing data races, see race_detector.cpp.
+ * Debug tool: it takes over the debug monitor exception, so it stays off by
+ * default and is mutually exclusive with hardware watchpoints from gdb.
+ */
+#ifndef EFI_RACE_DETECTOR
+#define EFI_RACE_DETECTOR FALSE
+#endif
+
+/**
+ * Use the MCU CRC unit for binary protocol checksums, see hw_crc.cpp
+ */
+#ifndef EFI_HW_CRC
+#define EFI_HW_CRC TRUE
+#endif
+
 #ifndef HAL_TRIGGER_USE_PAL
 #define HAL_TRIGGER_USE_PAL FALSE
 #endif /* HAL_TRIGGER_USE_PAL */
@@ -102,6 +220,43 @@
 #define EFI_SIGNAL_EXECUTOR_ONE_TIMER TRUE
 #define EFI_SIGNAL_EXECUTOR_HW_TIMER FALSE
 
+// O(log n) min-heap event queue instead of O(n) sorted linked list
+#define EFI_EVENT_QUEUE_HEAP TRUE
+
+// Q16.16 integer math for the trigger sync gap check, keeps the FPU out of the trigger ISR
+#define EFI_FIXED_POINT_TRIGGER_MATH TRUE
+
+// optional mode: trigger edges are only timestamped in the interrupt and decoded in batches
+// by a high priority thread, see trigger_central.cpp capture ring
+#define EFI_TRIGGER_DEFERRED_DECODE FALSE
+
+// skip fast callback recalculation while RPM/load stay within the same table cell
+#define EFI_FAST_CALLBACK_CACHE TRUE
+
+/**
+ * Closed-loop per-cylinder fuel balance from crank acceleration segments,
+ * see cylinder_balance.cpp. Armed from the console, off by default.
+ */
+#ifndef EFI_CYLINDER_BALANCE
+#define EFI_CYLINDER_BALANCE TRUE
+#endif
+
+/**
+ * Direct piezo knock input on the internal ADC, see knock_analyzer.cpp.
+ * Off by default - a board enables this once it wires the burst-sampling
+ * ADC channel.
+ */
+#ifndef EFI_INTERNAL_KNOCK_ADC
+#define EFI_INTERNAL_KNOCK_ADC FALSE
+#endif
+
+/**
+ * Crash diagnostic ring in the 4k battery-backed SRAM region, see postmortem_ring.cpp
+ */
+#ifndef EFI_POSTMORTEM_RING
+#define EFI_POSTMORTEM_RING TRUE
+#endif
+
 #define FUEL_MATH_EXTREME_LOGGING FALSE
 
 #define SPARK_EXTREME_LOGGING FALSE
@@ -112,6 +267,48 @@
 #define EFI_INTERNAL_FLASH TRUE
 #endif
 
+/**
+ * Burn the configuration into internal flash as a sequence of bounded steps from the
+ * slow callback instead of one long synchronous call, see flash_main.cpp
+ */
+#ifndef EFI_ASYNC_FLASH_BURN
+#define EFI_ASYNC_FLASH_BURN TRUE
+#endif
+
+/**
+ * Wear-leveled multi-slot configuration journal across the two config flash sectors
+ * with header-scan slot discovery at boot, see flash_main.cpp
+ */
+#ifndef EFI_CONFIG_JOURNAL
+#define EFI_CONFIG_JOURNAL TRUE
+#endif
+
+/**
+ * TunerStudio write commands report which configuration byte ranges they have touched
+ * so that the Burn apply pass only reinitializes the affected subsystems,
+ * see markConfigurationDirty in engine_configuration.cpp
+ */
+#ifndef EFI_CONFIG_DIRTY_TRACKING
+#define EFI_CONFIG_DIRTY_TRACKING TRUE
+#endif
+
+/**
+ * When only a few byte ranges of the tune changed since the last burn, append a small
+ * delta record to the configuration journal instead of programming the full image -
+ * a burn drops from seconds to tens of milliseconds, see flash_main.cpp
+ */
+#ifndef EFI_CONFIG_DELTA_BURN
+#define EFI_CONFIG_DELTA_BURN TRUE
+#endif
+
+/**
+ * Learned values (idle integrator etc) shadowed in RAM and committed to battery-backed
+ * RTC registers in batches so that they survive power cycles, see backup_ram.cpp
+ */
+#ifndef EFI_LEARNED_VALUE_STORE
+#define EFI_LEARNED_VALUE_STORE TRUE
+#endif
+
 /**
  * Usually you need shaft position input, but maybe you do not need it?
  */
@@ -239,6 +436,21 @@
 #define EFI_FILE_LOGGING TRUE
 #endif
 
+/**
+ * SD logging mode which pre-allocates a contiguous file and appends via raw
+ * multi-block MMC writes, bypassing FatFS on the hot path. See mmc_card.cpp
+ */
+#ifndef EFI_SD_RAW_LOGGING
+#define EFI_SD_RAW_LOGGING TRUE
+#endif
+
+/**
+ * Write SD logs as compact MLVLite binary records instead of CSV-style text, see binary_log.cpp
+ */
+#ifndef EFI_SD_BINARY_LOGGING
+#define EFI_SD_BINARY_LOGGING TRUE
+#endif
+
 #ifndef EFI_USB_SERIAL
 #define EFI_USB_SERIAL TRUE
 #endif
@@ -260,6 +472,22 @@
 #define EFI_HISTOGRAMS FALSE
 #define EFI_SENSOR_CHART TRUE
 
+/**
+ * Boot stage timing table ('bootinfo' command) and deferred initialization of subsystems
+ * which are not needed for engine start, see boot_profiler.cpp
+ */
+#ifndef EFI_BOOT_PROFILER
+#define EFI_BOOT_PROFILER TRUE
+#endif
+
+/**
+ * Runtime memory accounting: per-thread stack high-water marks and a registry of
+ * large static buffers, printed by the 'memoryinfo' command, see memory_report.cpp
+ */
+#ifndef EFI_MEMORY_REPORT
+#define EFI_MEMORY_REPORT TRUE
+#endif
+
 #if defined __GNUC__
 #define EFI_PERF_METRICS FALSE
 #define DL_OUTPUT_BUFFER 6500
@@ -297,6 +525,9 @@
 // todo: switch to continues ADC conversion for fast ADC?
 #define EFI_INTERNAL_FAST_ADC_PWM	&PWMD4
 
+// map SimplePwm outputs onto free TIM1/TIM8 channels when the pin allows it, see hardware_pwm.cpp
+#define EFI_HARDWARE_PWM TRUE
+
 #define EFI_SPI1_AF 5
 
 #define EFI_SPI2_AF 5
@@ -695,6 +695,7 @@
  * @note    This macro can be used to activate a power saving mode.
  */
 #define CH_CFG_IDLE_ENTER_HOOK() {                                          \
+  onIdleEnterHook();                                                        \
 }
 
 /**
@@ -704,6 +705,7 @@
  * @note    This macro can be used to deactivate a power saving mode.
  */
 #define CH_CFG_IDLE_LEAVE_HOOK() {                                          \
+  onIdleLeaveHook();                                                        \
 }
 
 /**
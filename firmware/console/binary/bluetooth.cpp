@@ -24,14 +24,15 @@ static const int baudRates[] = { 0, 1200, 2400, 4800, 9600, 19200, 38400, 57600,
 static const int baudRateIndexList[] = { 4 /*9600*/, 6 /*38400*/, 8 /*115200*/, 7, 5, 3, 2, 1, -1 };
 static const int btModuleTimeout = TIME_MS2I(1000);
 
-static ts_channel_s *tsChannel;
+// the channel the bluetooth module is wired to - the serial/UART one
+static ts_channel_s *btChannel;
 
 
 static THD_WORKING_AREA(btThreadStack, UTILITY_THREAD_STACK_SIZE);
 static thread_t *btThread = nullptr;
 static thread_reference_t btThreadRef = nullptr; // used by thread suspend/resume as a flag
 
-static LoggingWithStorage btLogger("bluetooth");
+static Logging btLogger("bluetooth");
 
 
 EXTERN_ENGINE
@@ -69,15 +70,16 @@ static void runCommands() {
 		// if the baud rate is changed, reinit the UART
 		if (baudIdx != prevBaudIdx || restoreAndExit) {
 			// deinit UART
-			if (!stopTsPort(tsChannel)) {
+			if (!stopTsPort(btChannel)) {
 				scheduleMsg(&btLogger, "Failed! Cannot restart serial port connection!");
 				return;
 			}
 			chThdSleepMilliseconds(10);	// safety
 			// change the port speed
 			CONFIG(tunerStudioSerialSpeed) = restoreAndExit ? savedSerialSpeed : baudRates[baudIdx];
-			// init UART
-			startTsPort(tsChannel);
+			// init UART - serial flavor only, on USB-console boards startTsPort
+			// would grab the USB device which belongs to the primary channel
+			startTsSerialPort(btChannel);
 			chThdSleepMilliseconds(10);	// safety
 			prevBaudIdx = baudIdx;
 		}
@@ -87,18 +89,18 @@ static void runCommands() {
 			break;
 
 		// send current command
-		sr5WriteData(tsChannel, (uint8_t *)commands[cmdIdx], strlen(commands[cmdIdx]));
+		sr5WriteData(btChannel, (uint8_t *)commands[cmdIdx], strlen(commands[cmdIdx]));
 		
 		// waiting for an answer
 		bool wasAnswer = false;
-		if (sr5ReadDataTimeout(tsChannel, buffer, 2, btModuleTimeout) == 2) {
+		if (sr5ReadDataTimeout(btChannel, buffer, 2, btModuleTimeout) == 2) {
 			wasAnswer = (buffer[0] == 'O' && buffer[1] == 'K') || 
 				(buffer[0] == '+' && (buffer[1] >= 'A' && buffer[1] <= 'Z'));
 		}
 
 		// wait 1 second and skip all remaining response bytes from the bluetooth module
 		while (true) {
-			if (sr5ReadDataTimeout(tsChannel, buffer, 1, btModuleTimeout) < 1)
+			if (sr5ReadDataTimeout(btChannel, buffer, 1, btModuleTimeout) < 1)
 				break;
 		}
 		
@@ -157,7 +159,7 @@ static THD_FUNCTION(btThreadEntryPoint, arg) {
 void bluetoothStart(ts_channel_s *tsChan, bluetooth_module_e moduleType, const char *baudRate, const char *name, const char *pinCode) {
 	static const char *usage = "Usage: bluetooth_hc06 <baud> <name> <pincode>";
 
-	tsChannel = tsChan;
+	btChannel = tsChan;
 	
 	// if a binary protocol uses USB, we cannot init the bluetooth module!
 	if (!CONFIG(useSerialPort)) {
@@ -257,7 +259,11 @@ void bluetoothStart(ts_channel_s *tsChan, bluetooth_module_e moduleType, const c
 	btProcessIsStarted = true;
 }
 	
-void bluetoothSoftwareDisconnectNotify() {
+void bluetoothSoftwareDisconnectNotify(ts_channel_s *tsChannel) {
+	if (tsChannel != btChannel) {
+		// an idle timeout on some other channel says nothing about the module link
+		return;
+	}
 	if (btProcessIsStarted) {
 		// start communication with the module
 		chThdResume(&btThreadRef, MSG_OK);
@@ -40,8 +40,10 @@ void bluetoothCancel(void);
 
 /**
  * Called by runBinaryProtocolLoop() if a connection disconnect is detected.
- * Bluetooth init code needs to make sure that there's no interference of the BT module and USB-UART (connected to PC)
+ * Bluetooth init code needs to make sure that there's no interference of the BT module and USB-UART (connected to PC).
+ * Only a disconnect on the channel the module is wired to counts - idle timeouts on
+ * concurrent channels are ignored.
  */
-void bluetoothSoftwareDisconnectNotify();
+void bluetoothSoftwareDisconnectNotify(ts_channel_s *tsChannel);
 
 #endif /* BLUETOOTH_H_ */
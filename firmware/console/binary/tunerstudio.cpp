@@ -69,13 +69,16 @@
 #include "flash_main.h"
 
 #include "tunerstudio_io.h"
+#include "copy_audit.h"
 #include "tunerstudio_configuration.h"
 #include "malfunction_central.h"
 #include "console_io.h"
 #include "crc.h"
+#include "hw_crc.h"
 #include "bluetooth.h"
 #include "tunerstudio_io.h"
 #include "tooth_logger.h"
+#include "datalog_streamer.h"
 #include "electronic_throttle.h"
 
 #include <string.h>
@@ -118,6 +121,10 @@ LoggingWithStorage tsLogger("binary");
 /**
  * this is a local copy of the configuration. Any changes to this copy
  * have no effect until this copy is explicitly propagated to the main working copy
+ *
+ * This shadow is also what makes multi-KB page reads cheap: write commands maintain
+ * it incrementally and handlePageReadCommand serves straight from it, so a full-page
+ * fetch never contends with the engine threads consulting engineConfiguration.
  */
 persistent_config_s configWorkingCopy;
 
@@ -127,11 +134,28 @@ static efitimems_t previousWriteReportMs = 0;
 
 static ts_channel_s tsChannel;
 
+#if EFI_PROD_CODE && defined(CONSOLE_USB_DEVICE) && (defined(TS_UART_DEVICE) || defined(TS_SERIAL_DEVICE))
+// boards with both a USB device and a TunerStudio serial port serve two clients at
+// once, see startTsSecondaryPort
+#define TS_SECONDARY_CHANNEL TRUE
+#endif
+
+#ifdef TS_SECONDARY_CHANNEL
+static ts_channel_s tsSecondaryChannel;
+#endif /* TS_SECONDARY_CHANNEL */
+
 // this thread wants a bit extra stack
 static THD_WORKING_AREA(tunerstudioThreadStack, 3 * UTILITY_THREAD_STACK_SIZE);
+#ifdef TS_SECONDARY_CHANNEL
+static THD_WORKING_AREA(tsSecondaryThreadStack, 3 * UTILITY_THREAD_STACK_SIZE);
+#endif /* TS_SECONDARY_CHANNEL */
+
+static void attachTsSession(ts_channel_s *tsChannel);
+static void invalidateAllOutputChannelsSnapshots(void);
 
 static void resetTs(void) {
 	memset(&tsState, 0, sizeof(tsState));
+	invalidateAllOutputChannelsSnapshots();
 }
 
 static void printErrorCounters(void) {
@@ -140,6 +164,11 @@ static void printErrorCounters(void) {
 			tsState.outputChannelsCommandCounter, tsState.readPageCommandsCounter, tsState.burnCommandCounter);
 	scheduleMsg(&tsLogger, "TunerStudio W=%d / C=%d / P=%d", tsState.writeValueCommandCounter,
 			tsState.writeChunkCommandCounter, tsState.pageCommandCounter);
+	scheduleMsg(&tsLogger, "TunerStudio output refreshes fast=%d / slow=%d", tsState.fastOutputRefreshCounter,
+			tsState.slowOutputRefreshCounter);
+#if EFI_INTERNAL_FLASH
+	scheduleMsg(&tsLogger, "burn progress=%d%%", tsState.burnProgressPercent);
+#endif /* EFI_INTERNAL_FLASH */
 }
 
 void printTsStats(void) {
@@ -153,6 +182,11 @@ void printTsStats(void) {
 	}
 #endif /* EFI_PROD_CODE */
 
+#if EFI_PROD_CODE && defined(CONSOLE_USB_DEVICE)
+	scheduleMsg(&tsLogger, "USB TX coalescing: %d bytes, %d bulk packets saved",
+			getUsbCoalescedBytes(), getUsbPacketsSaved());
+#endif /* EFI_PROD_CODE && CONSOLE_USB_DEVICE */
+
 	printErrorCounters();
 
 //	scheduleMsg(logger, "analogChartFrequency %d",
@@ -177,17 +211,24 @@ static void setTsSpeed(int value) {
 }
 
 #if EFI_BLUETOOTH_SETUP
+#ifdef TS_SECONDARY_CHANNEL
+// the bluetooth module hangs off the serial port, which is the secondary channel
+// on boards where USB took the primary
+#define BT_CHANNEL tsSecondaryChannel
+#else
+#define BT_CHANNEL tsChannel
+#endif /* TS_SECONDARY_CHANNEL */
 // Bluetooth HC-05 module initialization start (it waits for disconnect and then communicates to the module)
 static void bluetoothHC05(const char *baudRate, const char *name, const char *pinCode) {
-	bluetoothStart(&tsChannel, BLUETOOTH_HC_05, baudRate, name, pinCode);
+	bluetoothStart(&BT_CHANNEL, BLUETOOTH_HC_05, baudRate, name, pinCode);
 }
 // Bluetooth HC-06 module initialization start (it waits for disconnect and then communicates to the module)
 static void bluetoothHC06(const char *baudRate, const char *name, const char *pinCode) {
-	bluetoothStart(&tsChannel, BLUETOOTH_HC_06, baudRate, name, pinCode);
+	bluetoothStart(&BT_CHANNEL, BLUETOOTH_HC_06, baudRate, name, pinCode);
 }
 // Bluetooth SPP-C module initialization start (it waits for disconnect and then communicates to the module)
 static void bluetoothSPP(const char *baudRate, const char *name, const char *pinCode) {
-	bluetoothStart(&tsChannel, BLUETOOTH_SPP, baudRate, name, pinCode);
+	bluetoothStart(&BT_CHANNEL, BLUETOOTH_SPP, baudRate, name, pinCode);
 }
 #endif  /* EFI_BLUETOOTH_SETUP */
 
@@ -340,7 +381,13 @@ void handleWriteChunkCommand(ts_channel_s *tsChannel, ts_response_format_e mode,
 	}
 
 	uint8_t * addr = (uint8_t *) (getWorkingPageAddr() + offset);
-	memcpy(addr, content, count);
+	copyAuditMemcpy(COPY_AUDIT_TS, addr, content, count);
+#if EFI_CONFIG_DIRTY_TRACKING
+	markConfigurationDirty(offset, count);
+#endif /* EFI_CONFIG_DIRTY_TRACKING */
+#if EFI_CONFIG_DELTA_BURN
+	flashMarkConfigDirty(offset, count);
+#endif /* EFI_CONFIG_DELTA_BURN */
 	onlineApplyWorkingCopyBytes(offset, count);
 
 	sendOkResponse(tsChannel, mode);
@@ -356,7 +403,7 @@ void handleCrc32Check(ts_channel_s *tsChannel, ts_response_format_e mode, uint16
 
 	scheduleMsg(&tsLogger, "CRC32 request: offset %d size %d", offset, count);
 
-	uint32_t crc = SWAP_UINT32(crc32((void * ) getWorkingPageAddr(), count));
+	uint32_t crc = SWAP_UINT32(hwCrc32((void * ) getWorkingPageAddr(), count));
 
 	scheduleMsg(&tsLogger, "CRC32 response: %x", crc);
 
@@ -392,6 +439,12 @@ void handleWriteValueCommand(ts_channel_s *tsChannel, ts_response_format_e mode,
 	}
 
 	getWorkingPageAddr()[offset] = value;
+#if EFI_CONFIG_DIRTY_TRACKING
+	markConfigurationDirty(offset, 1);
+#endif /* EFI_CONFIG_DIRTY_TRACKING */
+#if EFI_CONFIG_DELTA_BURN
+	flashMarkConfigDirty(offset, 1);
+#endif /* EFI_CONFIG_DELTA_BURN */
 
 	onlineApplyWorkingCopyBytes(offset, 1);
 
@@ -458,6 +511,7 @@ void handleBurnCommand(ts_channel_s *tsChannel, ts_response_format_e mode, uint1
 
 static bool isKnownCommand(char command) {
 	return command == TS_HELLO_COMMAND || command == TS_READ_COMMAND || command == TS_OUTPUT_COMMAND
+			|| command == TS_OUTPUT_DELTA_COMMAND
 			|| command == TS_PAGE_COMMAND || command == TS_BURN_COMMAND || command == TS_SINGLE_WRITE_COMMAND
 			|| command == TS_CHUNK_WRITE_COMMAND || command == TS_EXECUTE
 			|| command == TS_IO_TEST_COMMAND
@@ -465,6 +519,7 @@ static bool isKnownCommand(char command) {
 			|| command == TS_GET_FILE_RANGE
 			|| command == TS_SET_LOGGER_MODE
 			|| command == TS_GET_LOGGER_BUFFER
+			|| command == TS_STREAM_COMMAND
 			|| command == TS_GET_TEXT
 			|| command == TS_CRC_CHECK_COMMAND
 			|| command == TS_GET_FIRMWARE_VERSION
@@ -476,6 +531,12 @@ static bool isKnownCommand(char command) {
 void runBinaryProtocolLoop(ts_channel_s *tsChannel) {
 	int wasReady = false;
 
+	attachTsSession(tsChannel);
+	if (tsChannel->session == NULL) {
+		// without a session we cannot serve the output channels commands at all
+		return;
+	}
+
 	while (true) {
 		int isReady = sr5IsReady(tsChannel);
 		if (!isReady) {
@@ -491,6 +552,10 @@ void runBinaryProtocolLoop(ts_channel_s *tsChannel) {
 
 		tsState.totalCounter++;
 
+		// everything we meant to send this round is written: push out any tail still
+		// pending in the USB bulk aggregation buffer before blocking on the read
+		sr5FlushData(tsChannel);
+
 		uint8_t firstByte;
 		int received = sr5ReadData(tsChannel, &firstByte, 1);
 #if EFI_SIMULATOR
@@ -502,8 +567,12 @@ void runBinaryProtocolLoop(ts_channel_s *tsChannel) {
 //			tunerStudioError("ERROR: no command");
 #if EFI_BLUETOOTH_SETUP
 			// assume there's connection loss and notify the bluetooth init code
-			bluetoothSoftwareDisconnectNotify();
+			bluetoothSoftwareDisconnectNotify(tsChannel);
 #endif  /* EFI_BLUETOOTH_SETUP */
+#if EFI_DATALOG_STREAM
+			// the line is idle, a good moment to push buffered datalog samples
+			flushDatalogStream(tsChannel);
+#endif /* EFI_DATALOG_STREAM */
 			continue;
 		}
 		onDataArrived();
@@ -564,7 +633,7 @@ void runBinaryProtocolLoop(ts_channel_s *tsChannel) {
 
 		expectedCrc = SWAP_UINT32(expectedCrc);
 
-		uint32_t actualCrc = crc32(tsChannel->crcReadBuffer, incomingPacketSize);
+		uint32_t actualCrc = hwCrc32(tsChannel->crcReadBuffer, incomingPacketSize);
 		if (actualCrc != expectedCrc) {
 			scheduleMsg(&tsLogger, "TunerStudio: CRC %x %x %x %x", tsChannel->crcReadBuffer[incomingPacketSize + 0],
 					tsChannel->crcReadBuffer[incomingPacketSize + 1], tsChannel->crcReadBuffer[incomingPacketSize + 2],
@@ -583,6 +652,11 @@ void runBinaryProtocolLoop(ts_channel_s *tsChannel) {
 		if (!success)
 			print("got unexpected TunerStudio command %x:%c\r\n", command, command);
 
+#if EFI_DATALOG_STREAM
+		// with an active client the line is rarely idle, so also piggyback a frame
+		// after each served request
+		flushDatalogStream(tsChannel);
+#endif /* EFI_DATALOG_STREAM */
 	}
 }
 
@@ -595,6 +669,19 @@ static THD_FUNCTION(tsThreadEntryPoint, arg) {
 	runBinaryProtocolLoop(&tsChannel);
 }
 
+#ifdef TS_SECONDARY_CHANNEL
+static THD_FUNCTION(tsSecondaryThreadEntryPoint, arg) {
+	(void) arg;
+	chRegSetThreadName("tunerstudio secondary");
+
+	if (!startTsSecondaryPort(&tsSecondaryChannel)) {
+		// runtime configuration left us with nothing to serve on the second port
+		return;
+	}
+	runBinaryProtocolLoop(&tsSecondaryChannel);
+}
+#endif /* TS_SECONDARY_CHANNEL */
+
 /**
  * Copy real configuration into the communications layer working copy
  */
@@ -607,6 +694,84 @@ void syncTunerStudioCopy(void) {
 tunerstudio_counters_s tsState;
 TunerStudioOutputChannels tsOutputChannels;
 
+// output channels as 32-bit words, for word-wise delta comparison
+#define TS_OUTPUT_WORDS (TS_OUTPUT_SIZE / 4)
+#define TS_OUTPUT_BITMAP_SIZE ((TS_OUTPUT_WORDS + 7) / 8)
+
+/**
+ * Everything one client conversation owns beyond the ts_channel_s I/O buffers: the
+ * frozen output channels snapshot it is currently serializing and its delta protocol
+ * cursor. With this per-session a USB client and a serial client poll at completely
+ * independent rates - neither one's baseline nor in-flight snapshot is disturbed by
+ * the other.
+ */
+typedef struct ts_session_s {
+	// the live struct frozen for the duration of this session's response
+	TunerStudioOutputChannels outputSnapshot;
+	// delta protocol reference: what this session's client has seen so far
+	uint32_t previousOutputSnapshot[TS_OUTPUT_WORDS];
+	bool outputSnapshotValid;
+	uint8_t deltaResponseBuffer[TS_OUTPUT_BITMAP_SIZE + TS_OUTPUT_SIZE];
+} ts_session_s;
+
+/**
+ * one session per channel which may talk the binary protocol: the primary port, the
+ * console fallback channel (see console_io.cpp) and, where compiled, the secondary port
+ */
+#ifdef TS_SECONDARY_CHANNEL
+#define TS_SESSION_COUNT 3
+#else
+#define TS_SESSION_COUNT 2
+#endif /* TS_SECONDARY_CHANNEL */
+
+static ts_session_s tsSessions[TS_SESSION_COUNT];
+static int tsSessionCount = 0;
+
+/**
+ * invoked by runBinaryProtocolLoop before serving a channel - lazy so that channels
+ * which are not wired here still get their state
+ */
+static void attachTsSession(ts_channel_s *tsChannel) {
+	if (tsChannel->session != NULL) {
+		return;
+	}
+	if (tsSessionCount >= TS_SESSION_COUNT) {
+		// the pool is sized for every static channel, running out is a wiring error
+		warning(CUSTOM_ERR_6635, "TS session pool exhausted");
+		return;
+	}
+	tsChannel->session = &tsSessions[tsSessionCount++];
+}
+
+static void invalidateOutputChannelsSnapshot(ts_channel_s *tsChannel) {
+	tsChannel->session->outputSnapshotValid = false;
+}
+
+static void invalidateAllOutputChannelsSnapshots(void) {
+	for (int i = 0; i < TS_SESSION_COUNT; i++) {
+		tsSessions[i].outputSnapshotValid = false;
+	}
+}
+
+/**
+ * Control threads and ISRs keep poking tsOutputChannels fields while we stream it out,
+ * so serializing straight from the live struct produces torn frames in MLV logs. The
+ * comms thread freezes the live struct into its own session buffer under a brief
+ * critical section and serializes the frozen copy: producers never wait for TX, and
+ * one session's in-flight snapshot stays intact no matter how the other channels poll.
+ */
+static const TunerStudioOutputChannels * takeOutputChannelsSnapshot(ts_channel_s *tsChannel) {
+	TunerStudioOutputChannels *snapshot = &tsChannel->session->outputSnapshot;
+	prepareTunerStudioOutputs();
+	// copying ~220 bytes inside the critical section is a couple of microseconds,
+	// way below our jitter budget
+	chSysLock();
+	copyAuditMemcpy(COPY_AUDIT_TS, snapshot, &tsOutputChannels, sizeof(TunerStudioOutputChannels));
+	tsState.outputSnapshotCounter++;
+	chSysUnlock();
+	return snapshot;
+}
+
 void tunerStudioError(const char *msg) {
 	tunerStudioDebug(msg);
 	printErrorCounters();
@@ -623,6 +788,8 @@ void handleQueryCommand(ts_channel_s *tsChannel, ts_response_format_e mode) {
 	scheduleMsg(&tsLogger, "got S/H (queryCommand) mode=%d", mode);
 	printTsStats();
 #endif
+	// a query means a (re)connecting client: the next delta poll ships a full baseline
+	invalidateOutputChannelsSnapshot(tsChannel);
 	sr5SendResponse(tsChannel, mode, (const uint8_t *) TS_SIGNATURE, strlen(TS_SIGNATURE) + 1);
 }
 
@@ -637,9 +804,46 @@ void handleOutputChannelsCommand(ts_channel_s *tsChannel, ts_response_format_e m
 	}
 
 	tsState.outputChannelsCommandCounter++;
-	prepareTunerStudioOutputs();
+	const TunerStudioOutputChannels *snapshot = takeOutputChannelsSnapshot(tsChannel);
 	// this method is invoked too often to print any debug information
-	sr5SendResponse(tsChannel, mode, ((const uint8_t *) &tsOutputChannels) + offset, count);
+	sr5SendResponse(tsChannel, mode, ((const uint8_t *) snapshot) + offset, count);
+}
+
+/**
+ * @brief delta flavor of the 'Output' command: a bitmap of changed 32-bit words
+ * followed by just the changed words
+ *
+ * At a steady 50Hz gauge poll most of the struct does not move, so this cuts the
+ * bandwidth roughly tenfold on slow links like bluetooth. The first poll after a
+ * Query command ships the full struct - see handleQueryCommand - which is how a
+ * reconnecting client gets its baseline.
+ */
+static void handleOutputChannelsDeltaCommand(ts_channel_s *tsChannel) {
+	tsState.outputChannelsCommandCounter++;
+	ts_session_s *session = tsChannel->session;
+
+	const uint32_t *currentOutput = (const uint32_t *) takeOutputChannelsSnapshot(tsChannel);
+	uint8_t *bitmap = session->deltaResponseBuffer;
+	uint8_t *changedWords = session->deltaResponseBuffer + TS_OUTPUT_BITMAP_SIZE;
+	int changedSize = 0;
+
+	memset(bitmap, 0, TS_OUTPUT_BITMAP_SIZE);
+	for (int i = 0; i < TS_OUTPUT_WORDS; i++) {
+		// currentOutput is a frozen snapshot so re-reading a word is safe, but the
+		// local still reads better
+		uint32_t word = currentOutput[i];
+		if (session->outputSnapshotValid && word == session->previousOutputSnapshot[i]) {
+			continue;
+		}
+		bitmap[i / 8] |= 1 << (i % 8);
+		// the payload right after the bitmap is not 4-byte aligned
+		memcpy(changedWords + changedSize, &word, 4);
+		changedSize += 4;
+		session->previousOutputSnapshot[i] = word;
+	}
+	session->outputSnapshotValid = true;
+
+	sr5SendResponse(tsChannel, TS_CRC, session->deltaResponseBuffer, TS_OUTPUT_BITMAP_SIZE + changedSize);
 }
 
 void handleTestCommand(ts_channel_s *tsChannel) {
@@ -745,6 +949,9 @@ int tunerStudioHandleCrcCommand(ts_channel_s *tsChannel, char *data, int incomin
 	case TS_OUTPUT_COMMAND:
 		handleOutputChannelsCommand(tsChannel, TS_CRC, data16[0], data16[1]);
 		break;
+	case TS_OUTPUT_DELTA_COMMAND:
+		handleOutputChannelsDeltaCommand(tsChannel);
+		break;
 	case TS_HELLO_COMMAND:
 		tunerStudioDebug("got Query command");
 		handleQueryCommand(tsChannel, TS_CRC);
@@ -826,12 +1033,47 @@ int tunerStudioHandleCrcCommand(ts_channel_s *tsChannel, char *data, int incomin
 		break;
 	case TS_GET_LOGGER_BUFFER:
 		{
+			// the ring goes out in place as two chronological spans, no staging copy
 			auto toothBuffer = GetToothLoggerBuffer();
-			sr5SendResponse(tsChannel, TS_CRC, toothBuffer.Buffer, toothBuffer.Length);
+			sr5WriteCrcPacketTwoSpans(tsChannel, TS_RESPONSE_OK, toothBuffer.Buffer, toothBuffer.Length,
+					toothBuffer.Buffer2, toothBuffer.Length2);
 		}
 
 		break;
 #endif /* EFI_TOOTH_LOGGER */
+#if EFI_DATALOG_STREAM
+	case TS_STREAM_COMMAND:
+		switch (data[0]) {
+		case 0x01:
+			{
+				// [mode][periodMs][channelCount][channelCount big-endian byte offsets]
+				int channelCount = data[2];
+				if (incomingPacketSize - 1 != 3 + 2 * channelCount) {
+					return false;
+				}
+				uint16_t byteOffsets[DATALOG_MAX_CHANNELS];
+				if (channelCount < 1 || channelCount > DATALOG_MAX_CHANNELS) {
+					return false;
+				}
+				for (int i = 0; i < channelCount; i++) {
+					byteOffsets[i] = SWAP_UINT16(*(uint16_t *) (data + 3 + 2 * i));
+				}
+				if (!startDatalogStream(data[1], byteOffsets, channelCount)) {
+					return false;
+				}
+			}
+			break;
+		case 0x02:
+			stopDatalogStream();
+			break;
+		default:
+			return false;
+		}
+
+		sendOkResponse(tsChannel, TS_CRC);
+
+		break;
+#endif /* EFI_DATALOG_STREAM */
 #if ENABLE_PERF_TRACE
 	case TS_PERF_TRACE_BEGIN:
 		perfTraceEnable();
@@ -839,8 +1081,10 @@ int tunerStudioHandleCrcCommand(ts_channel_s *tsChannel, char *data, int incomin
 		break;
 	case TS_PERF_TRACE_GET_BUFFER:
 		{
+			// capture continues into the other half while this one is on the wire
 			auto trace = perfTraceGetBuffer();
 			sr5SendResponse(tsChannel, TS_CRC, trace.Buffer, trace.Size);
+			perfTraceReleaseBuffer();
 		}
 
 		break;
@@ -857,6 +1101,8 @@ void startTunerStudioConnectivity(void) {
 	// Assert tune & output channel struct sizes
 	static_assert(sizeof(persistent_config_s) == TOTAL_CONFIG_SIZE, "TS datapage size mismatch");
 	static_assert(sizeof(TunerStudioOutputChannels) == TS_OUTPUT_SIZE, "TS output channels size mismatch");
+	// the delta protocol compares the output channels word-wise
+	static_assert(TS_OUTPUT_SIZE % 4 == 0, "TS output channels not a whole number of words");
 
 	memset(&tsState, 0, sizeof(tsState));
 	syncTunerStudioCopy();
@@ -875,6 +1121,9 @@ void startTunerStudioConnectivity(void) {
 #endif /* EFI_BLUETOOTH_SETUP */
 
 	chThdCreateStatic(tunerstudioThreadStack, sizeof(tunerstudioThreadStack), NORMALPRIO, (tfunc_t)tsThreadEntryPoint, NULL);
+#ifdef TS_SECONDARY_CHANNEL
+	chThdCreateStatic(tsSecondaryThreadStack, sizeof(tsSecondaryThreadStack), NORMALPRIO, (tfunc_t)tsSecondaryThreadEntryPoint, NULL);
+#endif /* TS_SECONDARY_CHANNEL */
 }
 
 #endif
@@ -27,6 +27,13 @@ typedef struct {
 	int totalCounter;
 	int textCommandCounter;
 	int testCommandCounter;
+	// number of frozen output channel snapshots taken, see takeOutputChannelsSnapshot
+	int outputSnapshotCounter;
+	// percentage of the background configuration burn completed, see flash_main.cpp
+	int burnProgressPercent;
+	// per-tier output channel refreshes, see updateTunerStudioState()
+	int fastOutputRefreshCounter;
+	int slowOutputRefreshCounter;
 } tunerstudio_counters_s;
 
 extern tunerstudio_counters_s tsState;
@@ -8,6 +8,7 @@
 #include "global.h"
 #include "os_access.h"
 #include "tunerstudio_io.h"
+#include "copy_audit.h"
 #include "console_io.h"
 #include "engine.h"
 #if EFI_SIMULATOR
@@ -83,6 +84,54 @@ static SerialConfig tsSerialConfig = { .speed = 0, .cr1 = 0, .cr2 = USART_CR2_ST
 #endif /* EFI_PROD_CODE */
 
 
+#if EFI_PROD_CODE && (defined(TS_UART_DEVICE) || defined(TS_SERIAL_DEVICE))
+/**
+ * The serial/UART flavor of the transport: the primary port on serial-console boards,
+ * the secondary port on USB-console boards, and the link which the bluetooth module
+ * setup bounces when it reconfigures the baud rate.
+ */
+bool startTsSerialPort(ts_channel_s *tsChannel) {
+	UNUSED(tsChannel);
+	if (!CONFIG(useSerialPort))
+		return false;
+
+	print("TunerStudio over USART");
+	/**
+	 * We have hard-coded USB serial console so that it would be clear how to connect to each specific board,
+	 * but for UART serial we allow users to change settings.
+	 */
+	efiSetPadMode("tunerstudio rx", engineConfiguration->binarySerialRxPin, PAL_MODE_ALTERNATE(TS_SERIAL_AF));
+	efiSetPadMode("tunerstudio tx", engineConfiguration->binarySerialTxPin, PAL_MODE_ALTERNATE(TS_SERIAL_AF));
+
+	#if TS_UART_DMA_MODE
+		print("Using UART-DMA mode");
+		// init FIFO queue
+		iqObjectInit(&tsUartDma.fifoRxQueue, tsUartDma.buffer, sizeof(tsUartDma.buffer), NULL, NULL);
+
+		// start DMA driver
+		tsDmaUartConfig.speed = CONFIG(tunerStudioSerialSpeed);
+		uartStart(TS_UART_DEVICE, &tsDmaUartConfig);
+
+		// start continuous DMA transfer using our circular buffer
+		tsUartDma.readPos = 0;
+		uartStartReceive(TS_UART_DEVICE, sizeof(tsUartDma.dmaBuffer), tsUartDma.dmaBuffer);
+	#elif TS_UART_MODE
+		print("Using UART mode");
+		// start DMA driver
+		tsUartConfig.speed = CONFIG(tunerStudioSerialSpeed);
+		uartStart(TS_UART_DEVICE, &tsUartConfig);
+	#elif defined(TS_SERIAL_DEVICE)
+		print("Using Serial mode");
+		tsSerialConfig.speed = CONFIG(tunerStudioSerialSpeed);
+
+		sdStart(TS_SERIAL_DEVICE, &tsSerialConfig);
+
+		tsChannel->channel = (BaseChannel *) TS_SERIAL_DEVICE;
+	#endif
+	return true;
+}
+#endif /* EFI_PROD_CODE && (TS_UART_DEVICE || TS_SERIAL_DEVICE) */
+
 void startTsPort(ts_channel_s *tsChannel) {
 	tsChannel->channel = (BaseChannel *) NULL;
 
@@ -99,54 +148,36 @@ void startTsPort(ts_channel_s *tsChannel) {
 			return;
 		#endif /* CONSOLE_USB_DEVICE */
 		#if defined(TS_UART_DEVICE) || defined(TS_SERIAL_DEVICE)
-			if (CONFIG(useSerialPort)) {
-
-				print("TunerStudio over USART");
-				/**
-				 * We have hard-coded USB serial console so that it would be clear how to connect to each specific board,
-				 * but for UART serial we allow users to change settings.
-				 */
-				efiSetPadMode("tunerstudio rx", engineConfiguration->binarySerialRxPin, PAL_MODE_ALTERNATE(TS_SERIAL_AF));
-				efiSetPadMode("tunerstudio tx", engineConfiguration->binarySerialTxPin, PAL_MODE_ALTERNATE(TS_SERIAL_AF));
-
-				#if TS_UART_DMA_MODE
-					print("Using UART-DMA mode");
-					// init FIFO queue
-					iqObjectInit(&tsUartDma.fifoRxQueue, tsUartDma.buffer, sizeof(tsUartDma.buffer), NULL, NULL);
-
-					// start DMA driver
-					tsDmaUartConfig.speed = CONFIG(tunerStudioSerialSpeed);
-					uartStart(TS_UART_DEVICE, &tsDmaUartConfig);
-
-					// start continuous DMA transfer using our circular buffer
-					tsUartDma.readPos = 0;
-					uartStartReceive(TS_UART_DEVICE, sizeof(tsUartDma.dmaBuffer), tsUartDma.dmaBuffer);
-				#elif TS_UART_MODE
-					print("Using UART mode");
-					// start DMA driver
-					tsUartConfig.speed = CONFIG(tunerStudioSerialSpeed);
-					uartStart(TS_UART_DEVICE, &tsUartConfig);
-				#elif defined(TS_SERIAL_DEVICE)
-					print("Using Serial mode");
-					tsSerialConfig.speed = CONFIG(tunerStudioSerialSpeed);
-
-					sdStart(TS_SERIAL_DEVICE, &tsSerialConfig);
-
-					tsChannel->channel = (BaseChannel *) TS_SERIAL_DEVICE;
-				#endif
-			}
-		#endif /* TS_UART_DMA_MODE || TS_UART_MODE */
+			startTsSerialPort(tsChannel);
+		#endif /* TS_UART_DEVICE || TS_SERIAL_DEVICE */
 	#else  /* EFI_PROD_CODE */
 		tsChannel->channel = (BaseChannel *) TS_SIMULATOR_PORT;
 	#endif /* EFI_PROD_CODE */
 }
 
+/**
+ * Brings the serial/UART transport up as a second concurrent TunerStudio port on
+ * boards where startTsPort took the USB device. Returns false when this
+ * configuration has no second physical port to offer.
+ */
+bool startTsSecondaryPort(ts_channel_s *tsChannel) {
+	tsChannel->channel = (BaseChannel *) NULL;
+	#if EFI_PROD_CODE && defined(CONSOLE_USB_DEVICE) && (defined(TS_UART_DEVICE) || defined(TS_SERIAL_DEVICE))
+		return startTsSerialPort(tsChannel);
+	#else
+		UNUSED(tsChannel);
+		return false;
+	#endif
+}
+
 bool stopTsPort(ts_channel_s *tsChannel) {
 	#if EFI_PROD_CODE
 		#if EFI_USB_SERIAL
-			// don't stop USB!
-			//usb_serial_stop();
-			return false;
+			if (isUsbSerial(tsChannel->channel)) {
+				// don't stop USB!
+				//usb_serial_stop();
+				return false;
+			}
 		#endif
 		if (CONFIG(useSerialPort)) {
 			// todo: disable Rx/Tx pads?
@@ -171,6 +202,17 @@ void sr5WriteData(ts_channel_s *tsChannel, const uint8_t * buffer, int size) {
 			logMsg("chSequentialStreamWrite [%d]\r\n", size);
 #endif
 
+#if EFI_PROD_CODE && defined(CONSOLE_USB_DEVICE)
+	// routed by channel, not by build flags: in dual-port builds the USB channel
+	// and the serial/UART channel are both live
+	if (tsChannel->channel == (BaseChannel *) &CONSOLE_USB_DEVICE) {
+		// USB writes go through the bulk packet aggregation layer - the pending tail
+		// is pushed out by sr5FlushData before the protocol loop blocks on a read
+		usb_buffered_write(buffer, size, BINARY_IO_TIMEOUT);
+		return;
+	}
+#endif /* EFI_PROD_CODE && CONSOLE_USB_DEVICE */
+
 #if (TS_UART_DMA_MODE || TS_UART_MODE) && EFI_PROD_CODE
 	UNUSED(tsChannel);
 	int transferred = size;
@@ -204,7 +246,27 @@ void sr5WriteData(ts_channel_s *tsChannel, const uint8_t * buffer, int size) {
 	}
 }
 
+/**
+ * Push out any data pending in a coalescing transport layer. Must be invoked before
+ * blocking on a read - the peer is request-response driven, so it will not talk to us
+ * until it has seen the tail of our previous response.
+ */
+void sr5FlushData(ts_channel_s *tsChannel) {
+	(void)tsChannel;
+#if EFI_PROD_CODE && defined(CONSOLE_USB_DEVICE)
+	if (tsChannel->channel == (BaseChannel *) &CONSOLE_USB_DEVICE) {
+		usb_buffered_flush(BINARY_IO_TIMEOUT);
+	}
+#endif /* EFI_PROD_CODE && CONSOLE_USB_DEVICE */
+}
+
 int sr5ReadDataTimeout(ts_channel_s *tsChannel, uint8_t * buffer, int size, int timeout) {
+#if EFI_PROD_CODE && defined(CONSOLE_USB_DEVICE)
+	// see sr5WriteData on why the USB channel is routed by channel pointer
+	if (tsChannel->channel == (BaseChannel *) &CONSOLE_USB_DEVICE) {
+		return chnReadTimeout(tsChannel->channel, (uint8_t * )buffer, size, timeout);
+	}
+#endif /* EFI_PROD_CODE && CONSOLE_USB_DEVICE */
 #if TS_UART_DMA_MODE
 	UNUSED(tsChannel);
 	return (int)iqReadTimeout(&tsUartDma.fifoRxQueue, (uint8_t * )buffer, (size_t)size, timeout);
@@ -229,6 +291,26 @@ int sr5ReadData(ts_channel_s *tsChannel, uint8_t * buffer, int size) {
  * Adds size to the beginning of a packet and a crc32 at the end. Then send the packet.
  */
 void sr5WriteCrcPacket(ts_channel_s *tsChannel, const uint8_t responseCode, const void *buf, const uint16_t size) {
+	// most packets fit the gather buffer and go out as one contiguous write: in
+	// UART-DMA mode that's a single DMA transfer and a single TX completion interrupt
+	// instead of three header/body/footer transfers
+	if ((size_t)(size + 7) <= sizeof(tsChannel->scratchBuffer)) {
+		uint8_t *gatherBuffer = tsChannel->scratchBuffer;
+
+		*(uint16_t *) gatherBuffer = SWAP_UINT16(size + 1);   // packet size including command
+		gatherBuffer[2] = responseCode;
+		if (size > 0) {
+			copyAuditMemcpy(COPY_AUDIT_TS_IO, gatherBuffer + 3, buf, size);
+		}
+
+		// CRC on command byte and payload, now contiguous
+		uint32_t crc = crc32((void *) (gatherBuffer + 2), (uint32_t) (size + 1));
+		*(uint32_t *) (gatherBuffer + 3 + size) = SWAP_UINT32(crc);
+
+		sr5WriteData(tsChannel, gatherBuffer, size + 7);
+		return;
+	}
+
 	uint8_t *writeBuffer = tsChannel->writeBuffer;
 	uint8_t *crcBuffer = &tsChannel->writeBuffer[3];
 
@@ -248,6 +330,37 @@ void sr5WriteCrcPacket(ts_channel_s *tsChannel, const uint8_t responseCode, cons
 	sr5WriteData(tsChannel, crcBuffer, 4);      // CRC footer
 }
 
+/**
+ * Same as sr5WriteCrcPacket but the payload is two separate memory spans - this is how
+ * a wrapped ring buffer goes out in chronological order without being copied into a
+ * staging buffer first: each span is written straight from where it lives, which in
+ * UART-DMA mode means the DMA engine reads the ring memory directly.
+ */
+void sr5WriteCrcPacketTwoSpans(ts_channel_s *tsChannel, const uint8_t responseCode, const void *buf1,
+		const uint16_t size1, const void *buf2, const uint16_t size2) {
+	uint8_t *writeBuffer = tsChannel->writeBuffer;
+	uint8_t *crcBuffer = &tsChannel->writeBuffer[3];
+
+	*(uint16_t *) writeBuffer = SWAP_UINT16(size1 + size2 + 1);   // packet size including command
+	*(uint8_t *) (writeBuffer + 2) = responseCode;
+
+	// CRC on whole packet
+	uint32_t crc = crc32((void *) (writeBuffer + 2), 1); // command part of CRC
+	crc = crc32inc((void *) buf1, crc, (uint32_t) size1);
+	crc = crc32inc((void *) buf2, crc, (uint32_t) size2);
+
+	*(uint32_t *) (crcBuffer) = SWAP_UINT32(crc);
+
+	sr5WriteData(tsChannel, writeBuffer, 3);      // header
+	if (size1 > 0) {
+		sr5WriteData(tsChannel, (const uint8_t*)buf1, size1);
+	}
+	if (size2 > 0) {
+		sr5WriteData(tsChannel, (const uint8_t*)buf2, size2);
+	}
+	sr5WriteData(tsChannel, crcBuffer, 4);      // CRC footer
+}
+
 void sr5SendResponse(ts_channel_s *tsChannel, ts_response_format_e mode, const uint8_t * buffer, int size) {
 	if (mode == TS_CRC) {
 		sr5WriteCrcPacket(tsChannel, TS_RESPONSE_OK, buffer, size);
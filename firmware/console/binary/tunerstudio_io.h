@@ -19,6 +19,8 @@
 #define TS_RESPONSE_OK 0x00
 #define TS_RESPONSE_BURN_OK 0x04
 #define TS_RESPONSE_COMMAND_OK 0x07
+// unsolicited frame of the high-rate datalog stream, see datalog_streamer.cpp
+#define TS_RESPONSE_STREAM_FRAME 0x08
 
 #define TS_RESPONSE_UNDERRUN 0x80
 #define TS_RESPONSE_CRC_FAILURE 0x82
@@ -28,13 +30,30 @@ typedef enum {
 	TS_CRC = 1
 } ts_response_format_e;
 
+// per-client conversation state owned by tunerstudio.cpp, see ts_session_s there
+struct ts_session_s;
+
 typedef struct {
 	BaseChannel * channel;
-	uint8_t writeBuffer[7];	// size(2 bytes) + response(1 byte) + crc32 (4 bytes)
 	/**
 	 * See 'blockingFactor' in rusefi.ini
+	 * This buffer is deliberately word-aligned (right after the channel pointer) so
+	 * that incoming packets are eligible for the CRC unit, see hwCrc32
 	 */
 	char crcReadBuffer[BLOCKING_FACTOR + 30];
+	uint8_t writeBuffer[7];	// size(2 bytes) + response(1 byte) + crc32 (4 bytes)
+	/**
+	 * Response gather buffer: header, payload and crc32 are assembled here so that a
+	 * whole packet goes out as a single write - in UART-DMA mode that's one DMA
+	 * transfer instead of three, see sr5WriteCrcPacket
+	 */
+	uint8_t scratchBuffer[BLOCKING_FACTOR + 30];
+	/**
+	 * attached lazily by runBinaryProtocolLoop: output channels snapshot and delta
+	 * protocol cursor of the client served over this channel, so concurrent
+	 * channels poll at independent rates
+	 */
+	struct ts_session_s *session;
 } ts_channel_s;
 
 // See uart_dma_s
@@ -64,6 +83,9 @@ typedef struct {
 // These commands are used by TunerStudio and the rusEfi console
 #define TS_HELLO_COMMAND 'S' // 0x53 queryCommand
 #define TS_OUTPUT_COMMAND 'O' // 0x4F ochGetCommand
+// rusEfi protocol extension: only the output channel words which changed since the
+// previous delta poll, see handleOutputChannelsDeltaCommand
+#define TS_OUTPUT_DELTA_COMMAND 'o' // 0x6F
 #define TS_READ_COMMAND 'R' // 0x52
 #define TS_PAGE_COMMAND 'P' // 0x50
 #define TS_COMMAND_F 'F' // 0x46
@@ -73,6 +95,9 @@ typedef struct {
 #define TS_SET_LOGGER_MODE   'l'
 #define TS_GET_LOGGER_BUFFER 'L'
 
+// rusEfi protocol extension: start/stop the delta+varint datalog stream, see datalog_streamer.cpp
+#define TS_STREAM_COMMAND 's' // 0x73
+
 // Performance tracing
 #define TS_PERF_TRACE_BEGIN 'r'
 #define TS_PERF_TRACE_GET_BUFFER 'b'
@@ -93,6 +118,11 @@ typedef struct {
 #endif /* HAL_USE_SERIAL_USB */
 
 void startTsPort(ts_channel_s *tsChannel);
+// serial/UART transport only: the bluetooth module setup bounces just this flavor
+// when it reconfigures the link speed
+bool startTsSerialPort(ts_channel_s *tsChannel);
+// second concurrent port on boards where USB took the primary, see tunerstudio.cpp
+bool startTsSecondaryPort(ts_channel_s *tsChannel);
 bool stopTsPort(ts_channel_s *tsChannel);
 
 // that's 1 second
@@ -102,7 +132,10 @@ bool stopTsPort(ts_channel_s *tsChannel);
 #define SR5_READ_TIMEOUT TIME_MS2I(1000)
 
 void sr5WriteData(ts_channel_s *tsChannel, const uint8_t * buffer, int size);
+void sr5FlushData(ts_channel_s *tsChannel);
 void sr5WriteCrcPacket(ts_channel_s *tsChannel, const uint8_t responseCode, const void *buf, const uint16_t size);
+void sr5WriteCrcPacketTwoSpans(ts_channel_s *tsChannel, const uint8_t responseCode, const void *buf1,
+		const uint16_t size1, const void *buf2, const uint16_t size2);
 void sr5SendResponse(ts_channel_s *tsChannel, ts_response_format_e mode, const uint8_t * buffer, int size);
 int sr5ReadData(ts_channel_s *tsChannel, uint8_t * buffer, int size);
 int sr5ReadDataTimeout(ts_channel_s *tsChannel, uint8_t * buffer, int size, int timeout);
@@ -0,0 +1,279 @@
+/**
+ * @file	binary_log.cpp
+ * @brief	compiled log record serializer, binary and text emitters
+ *
+ * The CSV-style writer runs every field through appendPrintf, and that text formatting
+ * is the single largest CPU item in the logging profile. Here a record has a fixed
+ * layout: a constant descriptor table says which bytes of tsOutputChannels go where,
+ * the header describing that layout is written once when the log file is created, and
+ * every record after that is a plain byte copy. Records are also several times smaller
+ * than their text equivalent, so the same card bandwidth carries more channels at a
+ * higher rate.
+ *
+ * The descriptor table is compiled once into a flat program of (source offset, size,
+ * flags, scale) steps, and every emitter is a tight loop over that program: the binary
+ * writer copies bytes, the text writer converts through integer math and itoa10 - no
+ * varargs, no per-field type branching, and both formats can be produced from the same
+ * pass over tsOutputChannels.
+ *
+ * Like the datalog streamer this samples tsOutputChannels as-is, so a channel is only
+ * as fresh as its producer keeps the gauge struct. All multi-byte values are big-endian
+ * as MegaLogViewer expects.
+ *
+ * File layout:
+ *   6 byte "MLVLG\0" magic, u16 format version, u32 timestamp, u32 info block start
+ *   (zero, we do not write one), u32 data begin index, u16 record length, u16 field
+ *   count, then one 55 byte descriptor per field: type u8, name char[34], units
+ *   char[10], display style u8, scale f32, transform f32, digits u8.
+ * Each record: block type u8 (zero), running counter u8 for loss detection, u16
+ * timestamp in 10ms steps, then the field values in descriptor order.
+ *
+ * @date May 9, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_FILE_LOGGING
+
+#include "binary_log.h"
+#include "mmc_card.h"
+#include "efilib.h"
+#include "efitime.h"
+#include "tunerstudio_configuration.h"
+
+// MLG field data types
+#define MLG_TYPE_U08 0
+#define MLG_TYPE_S08 1
+#define MLG_TYPE_U16 2
+#define MLG_TYPE_S16 3
+#define MLG_TYPE_U32 4
+#define MLG_TYPE_S32 5
+#define MLG_TYPE_S64 6
+#define MLG_TYPE_F32 7
+
+typedef struct {
+	uint16_t offset;	// byte offset within TunerStudioOutputChannels
+	uint8_t type;	// MLG_TYPE_*
+	uint8_t digits;
+	const char *name;
+	const char *units;
+	// multiplier which turns the stored integer into the display value
+	float scale;
+} mlg_field_s;
+
+#define MLG_FIELD(field, type, name, units, scale, digits) \
+	{ offsetof(TunerStudioOutputChannels, field), type, digits, name, units, scale }
+
+/**
+ * The channel set of the text log, expressed as copy instructions. The scaled_channel
+ * wrappers already store integers with a known multiplier, so the descriptor just
+ * forwards 1/PACK_MULT as the display scale and no conversion happens at runtime.
+ */
+static const mlg_field_s fields[] = {
+	MLG_FIELD(rpm, MLG_TYPE_U16, "RPM", "RPM", 1, 0),
+	MLG_FIELD(coolantTemperature, MLG_TYPE_S16, "CLT", "C", 1.0f / PACK_MULT_TEMPERATURE, 1),
+	MLG_FIELD(intakeAirTemperature, MLG_TYPE_S16, "IAT", "C", 1.0f / PACK_MULT_TEMPERATURE, 1),
+	MLG_FIELD(throttlePosition, MLG_TYPE_S16, "TPS", "%", 1.0f / PACK_MULT_PERCENT, 2),
+	MLG_FIELD(manifoldAirPressure, MLG_TYPE_U16, "MAP", "kPa", 1.0f / PACK_MULT_PRESSURE, 1),
+	MLG_FIELD(airFuelRatio, MLG_TYPE_U16, "AFR", "AFR", 1.0f / PACK_MULT_AFR, 2),
+	MLG_FIELD(engineLoad, MLG_TYPE_U16, "engineLoad", "%", 0.01f, 2),
+	MLG_FIELD(vBatt, MLG_TYPE_U16, "VBatt", "V", 1.0f / PACK_MULT_VOLTAGE, 2),
+	MLG_FIELD(actualLastInjection, MLG_TYPE_S16, "injPulse", "ms", 1.0f / PACK_MULT_MS, 3),
+	MLG_FIELD(ignitionAdvance, MLG_TYPE_S16, "ignAdvance", "deg", 1.0f / PACK_MULT_ANGLE, 2),
+	MLG_FIELD(vehicleSpeedKph, MLG_TYPE_U08, "VSS", "kph", 1, 0),
+};
+
+#define MLG_FIELD_COUNT (sizeof(fields) / sizeof(fields[0]))
+
+static const uint8_t typeSize[8] = { 1, 1, 2, 2, 4, 4, 8, 4 };
+static const uint8_t typeIsSigned[8] = { 0, 1, 0, 1, 0, 1, 1, 0 };
+
+#define LOG_STEP_SIGNED 1
+#define LOG_STEP_FLOAT 2
+
+/**
+ * one copy/convert instruction of the compiled serializer - everything an
+ * emitter needs without touching the descriptor table again
+ */
+typedef struct {
+	uint16_t sourceOffset;
+	uint8_t size;
+	uint8_t flags;
+	uint8_t digits;
+	float scale;
+} log_step_s;
+
+static log_step_s logProgram[MLG_FIELD_COUNT];
+static bool logProgramCompiled = false;
+
+static void compileLogProgram(void) {
+	for (uint32_t i = 0; i < MLG_FIELD_COUNT; i++) {
+		const mlg_field_s *field = &fields[i];
+		log_step_s *step = &logProgram[i];
+		step->sourceOffset = field->offset;
+		step->size = typeSize[field->type];
+		step->flags = (typeIsSigned[field->type] ? LOG_STEP_SIGNED : 0)
+				| (field->type == MLG_TYPE_F32 ? LOG_STEP_FLOAT : 0);
+		step->digits = field->digits;
+		step->scale = field->scale;
+	}
+	logProgramCompiled = true;
+}
+
+#if EFI_SD_BINARY_LOGGING
+
+#define MLG_HEADER_SIZE 24
+#define MLG_FIELD_HEADER_SIZE 55
+// block type, counter and 16 bit timestamp
+#define MLG_RECORD_PREFIX 4
+
+static uint8_t recordBuffer[MLG_RECORD_PREFIX + 8 * MLG_FIELD_COUNT];
+static uint8_t recordCounter = 0;
+
+static void writeBE16(uint8_t *target, uint16_t value) {
+	target[0] = value >> 8;
+	target[1] = value & 0xFF;
+}
+
+static void writeBE32(uint8_t *target, uint32_t value) {
+	target[0] = value >> 24;
+	target[1] = (value >> 16) & 0xFF;
+	target[2] = (value >> 8) & 0xFF;
+	target[3] = value & 0xFF;
+}
+
+static int getRecordLength(void) {
+	int length = MLG_RECORD_PREFIX;
+	for (uint32_t i = 0; i < MLG_FIELD_COUNT; i++) {
+		length += typeSize[fields[i].type];
+	}
+	return length;
+}
+
+void writeBinaryLogHeader(void) {
+	uint8_t header[MLG_HEADER_SIZE];
+	memcpy(header, "MLVLG", 6); // the terminating zero of the literal is part of the magic
+	writeBE16(&header[6], 1); // format version
+	writeBE32(&header[8], 0); // timestamp
+	writeBE32(&header[12], 0); // info block start, we do not write one
+	writeBE32(&header[16], MLG_HEADER_SIZE + MLG_FIELD_HEADER_SIZE * MLG_FIELD_COUNT);
+	writeBE16(&header[20], getRecordLength());
+	writeBE16(&header[22], MLG_FIELD_COUNT);
+	appendToLogBuffer((const char *) header, sizeof(header));
+
+	for (uint32_t i = 0; i < MLG_FIELD_COUNT; i++) {
+		const mlg_field_s *field = &fields[i];
+		uint8_t entry[MLG_FIELD_HEADER_SIZE];
+		memset(entry, 0, sizeof(entry));
+		entry[0] = field->type;
+		strncpy((char *) &entry[1], field->name, 33);
+		strncpy((char *) &entry[35], field->units, 9);
+		entry[45] = 0; // display style: float
+		uint32_t scaleBits;
+		memcpy(&scaleBits, &field->scale, sizeof(scaleBits));
+		writeBE32(&entry[46], scaleBits);
+		writeBE32(&entry[50], 0); // transform
+		entry[54] = field->digits;
+		appendToLogBuffer((const char *) entry, sizeof(entry));
+	}
+	recordCounter = 0;
+}
+
+void writeBinaryLogRecord(void) {
+	if (!logProgramCompiled) {
+		compileLogProgram();
+	}
+	const uint8_t *source = (const uint8_t *) &tsOutputChannels;
+	uint8_t *target = recordBuffer;
+
+	*target++ = 0; // block type: plain record
+	*target++ = recordCounter++;
+	writeBE16(target, (uint16_t) (currentTimeMillis() / 10));
+	target += 2;
+
+	for (uint32_t i = 0; i < MLG_FIELD_COUNT; i++) {
+		const log_step_s *step = &logProgram[i];
+		const uint8_t *value = source + step->sourceOffset;
+		// a byte-reversing copy is all the "formatting" a record ever needs
+		for (int b = step->size - 1; b >= 0; b--) {
+			*target++ = value[b];
+		}
+	}
+	appendToLogBuffer((const char *) recordBuffer, target - recordBuffer);
+}
+
+#endif /* EFI_SD_BINARY_LOGGING */
+
+void writeTextLogNames(Logging *log) {
+	for (uint32_t i = 0; i < MLG_FIELD_COUNT; i++) {
+		append(log, fields[i].name);
+		append(log, "\t");
+	}
+}
+
+void writeTextLogUnits(Logging *log) {
+	for (uint32_t i = 0; i < MLG_FIELD_COUNT; i++) {
+		append(log, fields[i].units);
+		append(log, "\t");
+	}
+}
+
+/**
+ * fixed-point decimal emission: the value is scaled into an integer once and
+ * rendered with itoa10, which replaces the chvprintf float path entirely
+ */
+static void appendStepValue(Logging *log, const log_step_s *step, const uint8_t *source) {
+	float value;
+	if (step->flags & LOG_STEP_FLOAT) {
+		float raw;
+		memcpy(&raw, source, sizeof(raw));
+		value = raw * step->scale;
+	} else {
+		int32_t raw = 0;
+		memcpy(&raw, source, step->size);
+		if ((step->flags & LOG_STEP_SIGNED) && step->size < 4) {
+			// sign-extend the little-endian value we just copied
+			int shift = 32 - 8 * step->size;
+			raw = (raw << shift) >> shift;
+		}
+		value = raw * step->scale;
+	}
+
+	int multiplier = efiPow10(step->digits);
+	int fixed = (int)(value * multiplier + (value >= 0 ? 0.5f : -0.5f));
+
+	char buffer[16];
+	char *p = buffer;
+	if (fixed < 0) {
+		*p++ = '-';
+		fixed = -fixed;
+	}
+	p = itoa10(p, fixed / multiplier);
+	if (step->digits > 0) {
+		*p++ = '.';
+		int fraction = fixed % multiplier;
+		for (int digit = step->digits - 1; digit > 0; digit--) {
+			if (fraction < efiPow10(digit)) {
+				*p++ = '0';
+			}
+		}
+		p = itoa10(p, fraction);
+	}
+	*p++ = '\t';
+	*p = 0;
+	append(log, buffer);
+}
+
+void writeTextLogRecord(Logging *log) {
+	if (!logProgramCompiled) {
+		compileLogProgram();
+	}
+	const uint8_t *source = (const uint8_t *) &tsOutputChannels;
+	for (uint32_t i = 0; i < MLG_FIELD_COUNT; i++) {
+		const log_step_s *step = &logProgram[i];
+		appendStepValue(log, step, source + step->sourceOffset);
+	}
+}
+
+#endif /* EFI_FILE_LOGGING */
@@ -0,0 +1,38 @@
+/**
+ * @file	binary_log.h
+ * @brief	MLVLite binary SD log writer, see binary_log.cpp
+ *
+ * @date May 9, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+#if EFI_FILE_LOGGING
+
+#include "datalogging.h"
+
+#if EFI_SD_BINARY_LOGGING
+/**
+ * Emits the file header with the channel descriptor table, to be invoked exactly once
+ * right after a new log file was created.
+ */
+void writeBinaryLogHeader(void);
+
+/**
+ * Assembles one fixed-layout record from tsOutputChannels and stages it for the card.
+ */
+void writeBinaryLogRecord(void);
+#endif /* EFI_SD_BINARY_LOGGING */
+
+/**
+ * The text emitters run the very same compiled step program as the binary writer,
+ * formatting with integer math only - no printf machinery anywhere in the log path.
+ */
+void writeTextLogNames(Logging *log);
+void writeTextLogUnits(Logging *log);
+void writeTextLogRecord(Logging *log);
+
+#endif /* EFI_FILE_LOGGING */
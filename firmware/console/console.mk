@@ -4,5 +4,7 @@ CONSOLESRC =
 CONSOLE_SRC_CPP = $(PROJECT_DIR)/console/status_loop.cpp \
 	$(PROJECT_DIR)/console/console_io.cpp \
 	$(PROJECT_DIR)/console/eficonsole.cpp \
-	$(PROJECT_DIR)/console/tooth_logger.cpp
+	$(PROJECT_DIR)/console/tooth_logger.cpp \
+	$(PROJECT_DIR)/console/datalog_streamer.cpp \
+	$(PROJECT_DIR)/console/binary_log.cpp
 
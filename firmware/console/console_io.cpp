@@ -22,6 +22,7 @@
 #include "engine.h"
 #include "console_io.h"
 #include "os_util.h"
+#include "efitime.h"
 #include "tunerstudio.h"
 
 #if EFI_SIMULATOR
@@ -48,8 +49,27 @@ static event_listener_t consoleEventListener;
 
 bool consoleByteArrived = false;
 
+/**
+ * Time of the most recent byte received from any console consumer, in seconds.
+ * Both rusEfi console and TunerStudio poll us, so this is a reliable liveness
+ * signal for the other end of the cable.
+ */
+static volatile efitimesec_t timeOfLastConsoleActivity = 0;
+
+// with no activity for this long we consider the cable unplugged
+#define CONSOLE_IDLE_TIMEOUT_SEC 15
+
 void onDataArrived(void) {
 	consoleByteArrived = true;
+	timeOfLastConsoleActivity = getTimeNowSeconds();
+}
+
+bool isConsoleActive(void) {
+	/**
+	 * the zero initial value doubles as 'full rate for the first seconds after
+	 * boot' so a console attached before power-up sees output right away
+	 */
+	return overflowDiff(getTimeNowSeconds(), timeOfLastConsoleActivity) < CONSOLE_IDLE_TIMEOUT_SEC;
 }
 
 
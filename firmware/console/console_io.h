@@ -42,4 +42,13 @@ bool isCommandLineConsoleReady(void);
 #define isCommandLineConsoleReady() true
 #endif
 
+/**
+ * true if some console consumer has talked to us recently, see onDataArrived()
+ */
+#if EFI_PROD_CODE || EFI_SIMULATOR || EFI_EGT
+bool isConsoleActive(void);
+#else
+#define isConsoleActive() true
+#endif
+
 #endif /* CONSOLE_IO_H_ */
@@ -0,0 +1,171 @@
+/*
+ * @file datalog_streamer.cpp
+ *
+ * High-rate datalog stream over the binary protocol: a configurable set of output
+ * channel words is sampled at up to 1kHz into a ring buffer, delta+varint encoded,
+ * and pushed out as TS_RESPONSE_STREAM_FRAME packets whenever the comms thread has
+ * nothing better to do - see runBinaryProtocolLoop.
+ *
+ * Values are encoded as the zigzag varint of the difference against the previous
+ * sample of the same channel, so a channel which did not move costs one byte. That
+ * also works surprisingly well for floats: bit patterns of nearby same-sign IEEE754
+ * values are numerically close. The polled 'O' command tops out around 50Hz on a
+ * bluetooth link, this stream makes 1kHz fit into the same bandwidth.
+ *
+ * Same firmware-buffered approach as tooth_logger.cpp, just with a generic payload.
+ *
+ * @date Apr 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "datalog_streamer.h"
+
+#include "global.h"
+
+#if EFI_DATALOG_STREAM
+
+#include "periodic_task.h"
+#include "tunerstudio.h"
+#include "tunerstudio_configuration.h"
+
+// about a second worth of buffering at 1kHz with a handful of quiet channels
+#define STREAM_RING_SIZE 2048
+
+// sequence byte + up to this many payload bytes per frame
+#define STREAM_FRAME_PAYLOAD 200
+
+static uint8_t streamRing[STREAM_RING_SIZE] CCM_OPTIONAL;
+// single writer (timer callback), single reader (comms thread)
+static volatile int ringWriteIndex = 0;
+static volatile int ringReadIndex = 0;
+
+static uint16_t channelWordOffsets[DATALOG_MAX_CHANNELS];
+static int32_t previousSample[DATALOG_MAX_CHANNELS];
+static int streamChannelCount = 0;
+static int streamPeriodMs = 0;
+static volatile bool isStreamEnabled = false;
+
+// counts samples dropped because the comms thread could not drain fast enough
+static uint32_t streamOverrunCounter = 0;
+static uint8_t frameSequence = 0;
+
+static int getRingUsed(void) {
+	return (ringWriteIndex - ringReadIndex + STREAM_RING_SIZE) % STREAM_RING_SIZE;
+}
+
+static void appendVarint(uint8_t *record, int *length, uint32_t value) {
+	do {
+		uint8_t b = value & 0x7F;
+		value >>= 7;
+		if (value != 0) {
+			b |= 0x80;
+		}
+		record[(*length)++] = b;
+	} while (value != 0);
+}
+
+class DatalogSampler : public PeriodicTimerController {
+public:
+	int getPeriodMs() override {
+		return streamPeriodMs;
+	}
+
+	void PeriodicTask() override {
+		if (!isStreamEnabled) {
+			return;
+		}
+
+		uint8_t record[DATALOG_MAX_CHANNELS * 5];
+		int recordLength = 0;
+
+		const uint32_t *words = (const uint32_t *) &tsOutputChannels;
+		for (int i = 0; i < streamChannelCount; i++) {
+			int32_t value = (int32_t) words[channelWordOffsets[i]];
+			int32_t delta = value - previousSample[i];
+			previousSample[i] = value;
+			// zigzag so that small negative deltas stay small
+			appendVarint(record, &recordLength, ((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31));
+		}
+
+		// whole records only: a partial record would corrupt the stream
+		if (STREAM_RING_SIZE - 1 - getRingUsed() < recordLength) {
+			streamOverrunCounter++;
+			return;
+		}
+		int writeIndex = ringWriteIndex;
+		for (int i = 0; i < recordLength; i++) {
+			streamRing[writeIndex] = record[i];
+			writeIndex = (writeIndex + 1) % STREAM_RING_SIZE;
+		}
+		ringWriteIndex = writeIndex;
+	}
+};
+
+static DatalogSampler datalogSampler;
+
+bool startDatalogStream(int periodMs, const uint16_t *byteOffsets, int channelCount) {
+	if (channelCount < 1 || channelCount > DATALOG_MAX_CHANNELS) {
+		return false;
+	}
+	if (periodMs < 1 || periodMs > 1000) {
+		return false;
+	}
+	for (int i = 0; i < channelCount; i++) {
+		// channels are whole 32-bit words of the output struct, same addressing as
+		// the delta protocol
+		if (byteOffsets[i] % 4 != 0 || byteOffsets[i] >= TS_OUTPUT_SIZE) {
+			return false;
+		}
+	}
+
+	stopDatalogStream();
+
+	for (int i = 0; i < channelCount; i++) {
+		channelWordOffsets[i] = byteOffsets[i] / 4;
+		// first delta is against zero, i.e. the first record carries absolute values
+		previousSample[i] = 0;
+	}
+	streamChannelCount = channelCount;
+	streamPeriodMs = periodMs;
+	ringWriteIndex = 0;
+	ringReadIndex = 0;
+	streamOverrunCounter = 0;
+	frameSequence = 0;
+
+	isStreamEnabled = true;
+	datalogSampler.Start();
+	return true;
+}
+
+void stopDatalogStream(void) {
+	isStreamEnabled = false;
+#if !EFI_UNIT_TEST
+	chVTReset(&datalogSampler.timer);
+#endif /* EFI_UNIT_TEST */
+}
+
+void flushDatalogStream(ts_channel_s *tsChannel) {
+	int used = getRingUsed();
+	if (used == 0) {
+		return;
+	}
+	if (used > STREAM_FRAME_PAYLOAD) {
+		used = STREAM_FRAME_PAYLOAD;
+	}
+
+	static uint8_t frameBuffer[1 + STREAM_FRAME_PAYLOAD];
+	// the client detects lost frames by the gap in sequence numbers and re-syncs by
+	// restarting the stream
+	frameBuffer[0] = frameSequence++;
+
+	int readIndex = ringReadIndex;
+	for (int i = 0; i < used; i++) {
+		frameBuffer[1 + i] = streamRing[readIndex];
+		readIndex = (readIndex + 1) % STREAM_RING_SIZE;
+	}
+	ringReadIndex = readIndex;
+
+	sr5WriteCrcPacket(tsChannel, TS_RESPONSE_STREAM_FRAME, frameBuffer, 1 + used);
+}
+
+#endif /* EFI_DATALOG_STREAM */
@@ -0,0 +1,30 @@
+/*
+ * @file datalog_streamer.h
+ *
+ * High-rate datalog stream over the binary protocol, see datalog_streamer.cpp
+ *
+ * @date Apr 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include <cstdint>
+#include "tunerstudio_io.h"
+
+// enough for one varint-encoded sample at the maximum channel count
+#define DATALOG_MAX_CHANNELS 16
+
+/**
+ * (Re)starts the stream: 'channelCount' channels, each identified by its byte offset
+ * into TunerStudioOutputChannels, sampled every 'periodMs' milliseconds.
+ *
+ * @return false if the channel set is invalid
+ */
+bool startDatalogStream(int periodMs, const uint16_t *byteOffsets, int channelCount);
+
+// Stop sampling - whatever is still buffered can be flushed out
+void stopDatalogStream(void);
+
+// Push at most one frame of buffered samples down the channel, if there is anything to push
+void flushDatalogStream(ts_channel_s *tsChannel);
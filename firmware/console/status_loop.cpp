@@ -32,14 +32,21 @@
 #include "adc_inputs.h"
 #if EFI_LOGIC_ANALYZER
 #include "logic_analyzer.h"
+#include "sensor_chart.h"
+#include "board_features.h"
 #endif /* EFI_LOGIC_ANALYZER */
 
 #include "trigger_central.h"
+#include "isr_budget.h"
+#include "perf_trace.h"
+#include "cpu_load.h"
+#include "copy_audit.h"
 #include "allsensors.h"
 #include "sensor_reader.h"
 #include "io_pins.h"
 #include "efi_gpio.h"
 #include "mmc_card.h"
+#include "binary_log.h"
 #include "console_io.h"
 #include "malfunction_central.h"
 #include "speed_density.h"
@@ -119,58 +126,14 @@ static void setWarningEnabled(int value) {
 }
 
 #if EFI_FILE_LOGGING
+static int logFileLineIndex = 0;
+#if ! EFI_SD_BINARY_LOGGING
 // this one needs to be in main ram so that SD card SPI DMA works fine
 static char FILE_LOGGER[1000] MAIN_RAM;
 static Logging fileLogger("file logger", FILE_LOGGER, sizeof(FILE_LOGGER));
-static int logFileLineIndex = 0;
-
-#endif /* EFI_FILE_LOGGING */
-
-#define TAB "\t"
-
-static void reportSensorF(Logging *log, const char *caption, const char *units, float value,
-		int precision) {
-	bool isLogFileFormatting = true;
-
-	if (!isLogFileFormatting) {
-#if EFI_PROD_CODE || EFI_SIMULATOR
-		debugFloat(log, caption, value, precision);
-#endif /* EFI_PROD_CODE || EFI_SIMULATOR */
-	} else {
-
-#if EFI_FILE_LOGGING
-		if (logFileLineIndex == 0) {
-			append(log, caption);
-			append(log, TAB);
-		} else if (logFileLineIndex == 1) {
-			append(log, units);
-			append(log, TAB);
-		} else {
-			appendFloat(log, value, precision);
-			append(log, TAB);
-		}
-#else
-		UNUSED(log);UNUSED(caption);UNUSED(units);UNUSED(value);
-		UNUSED(precision);
+#endif /* EFI_SD_BINARY_LOGGING */
 #endif /* EFI_FILE_LOGGING */
-	}
-}
 
-static void reportSensorI(Logging *log, const char *caption, const char *units, int value) {
-#if EFI_FILE_LOGGING
-		if (logFileLineIndex == 0) {
-			append(log, caption);
-			append(log, TAB);
-		} else if (logFileLineIndex == 1) {
-			append(log, units);
-			append(log, TAB);
-		} else {
-			appendPrintf(log, "%d%s", value, TAB);
-		}
-#else
-		UNUSED(log);UNUSED(caption);UNUSED(units);UNUSED(value);
-#endif /* EFI_FILE_LOGGING */
-}
 
 EXTERN_ENGINE
 ;
@@ -191,229 +154,53 @@ static float getAirFlowGauge(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	return hasMafSensor() ? getRealMaf(PASS_ENGINE_PARAMETER_SIGNATURE) : engine->engineState.airFlow;
 }
 
-#if EFI_FILE_LOGGING
-static void printSensors(Logging *log) {
-	bool fileFormat = true; // todo:remove this unused variable
-	// current time, in milliseconds
-	int nowMs = currentTimeMillis();
-	float sec = ((float) nowMs) / 1000;
-	reportSensorF(log, "time", "", sec, 3); // log column 1
-
-	int rpm = 0;
-#if EFI_SHAFT_POSITION_INPUT
-	rpm = GET_RPM();
-	reportSensorI(log, "rpm", "RPM", rpm); // log column 2
-#endif
-	// why do we still send data into console in text mode?
-
-	if (hasCltSensor()) {
-		reportSensorF(log, "CLT", "C", getCoolantTemperature(), 2); // log column #4
-	}
-
-	SensorResult tps = Sensor::get(SensorType::Tps1);
-	if (tps) {
-		reportSensorF(log, "TPS", "%", tps.Value, 2); // log column #5
-	}
-
-	if (hasIatSensor()) {
-		reportSensorF(log, "IAT", "C", getIntakeAirTemperature(), 2); // log column #7
-	}
-
-	if (hasVBatt(PASS_ENGINE_PARAMETER_SIGNATURE)) {
-		reportSensorF(log, GAUGE_NAME_VBAT, "V", getVBatt(PASS_ENGINE_PARAMETER_SIGNATURE), 2); // log column #6
-	}
-
-
-	// 312
-	reportSensorF(log, GAUGE_NAME_ETB_TARGET, "v", tsOutputChannels.etbTarget, 2);
-	// 316
-	reportSensorF(log, GAUGE_NAME_ETB_DUTY, "e", tsOutputChannels.etb1DutyCycle, 2);
-	// 320
-	reportSensorF(log, GAUGE_NAME_ETB_ERROR, "d", tsOutputChannels.etb1Error, 2);
-
-
-	reportSensorF(log, GAUGE_NAME_FUEL_BARO_CORR, "x", engine->engineState.baroCorrection, 2);
-
-	reportSensorF(log, GAUGE_NAME_AIR_FLOW, "v", getAirFlowGauge(PASS_ENGINE_PARAMETER_SIGNATURE), 2);
-	reportSensorF(log, GAUGE_NAME_AIR_MASS, "x", engine->engineState.sd.airMassInOneCylinder, 2);
-
-//	if (hasMafSensor()) {
-//		reportSensorF(log, , "V", getMafVoltage(PASS_ENGINE_PARAMETER_SIGNATURE));
-//	}
-
-#if EFI_ANALOG_SENSORS
-	if (hasMapSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
-		reportSensorF(log, "MAP", "kPa", getMap(PASS_ENGINE_PARAMETER_SIGNATURE), 2);
-//		reportSensorF(log, "map_r", "V", getRawMap(), 2);
-	}
-#endif /* EFI_ANALOG_SENSORS */
-#if EFI_ANALOG_SENSORS
-	if (hasBaroSensor()) {
-		reportSensorF(log, "baro", "kPa", getBaroPressure(), 2);
-	}
-#endif /* EFI_ANALOG_SENSORS */
-
-
-	if (!fileFormat) {
-		return;
-	}
-
-	if (hasAfrSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
-		reportSensorF(log, GAUGE_NAME_AFR, "AFR", getAfr(PASS_ENGINE_PARAMETER_SIGNATURE), 2);
-	}
-
-	// below are the more advanced data points which only go into log file
-
-
-#if HAL_USE_ADC
-	reportSensorF(log, GAUGE_NAME_CPU_TEMP, "C", getMCUInternalTemperature(), 2); // log column #3
-#endif
-
-	reportSensorI(log, "mode", "v", packEngineMode(PASS_ENGINE_PARAMETER_SIGNATURE)); // log column #3
-
-	reportSensorF(log, GAUGE_NAME_ACCEL_X, "G", engine->sensors.accelerometer.x, 3);
-	reportSensorF(log, GAUGE_NAME_ACCEL_Y, "G", engine->sensors.accelerometer.y, 3);
-
-	if (hasMafSensor()) {
-		reportSensorF(log, "maf", "V", getMafVoltage(PASS_ENGINE_PARAMETER_SIGNATURE), 2);
-		reportSensorF(log, "mafr", "kg/hr", getRealMaf(PASS_ENGINE_PARAMETER_SIGNATURE), 2);
-	}
-
-#if EFI_IDLE_CONTROL
-	reportSensorF(log, GAUGE_NAME_IAC, "%", getIdlePosition(), 2);
-#endif /* EFI_IDLE_CONTROL */
-
-#if EFI_ANALOG_SENSORS
-	reportSensorF(log, GAUGE_NAME_TARGET_AFR, "AFR", engine->engineState.targetAFR, 2);
-#endif /* EFI_ANALOG_SENSORS */
-
-
-#define DEBUG_F_PRECISION 6
-
-#if EFI_TUNER_STUDIO
-		reportSensorF(log, GAUGE_NAME_DEBUG_F1, "v", tsOutputChannels.debugFloatField1, DEBUG_F_PRECISION);
-		reportSensorF(log, GAUGE_NAME_DEBUG_F2, "v", tsOutputChannels.debugFloatField2, DEBUG_F_PRECISION);
-		reportSensorF(log, GAUGE_NAME_DEBUG_F3, "v", tsOutputChannels.debugFloatField3, DEBUG_F_PRECISION);
-		reportSensorF(log, GAUGE_NAME_DEBUG_F4, "v", tsOutputChannels.debugFloatField4, DEBUG_F_PRECISION);
-		reportSensorF(log, GAUGE_NAME_DEBUG_F5, "v", tsOutputChannels.debugFloatField5, DEBUG_F_PRECISION);
-		reportSensorF(log, GAUGE_NAME_DEBUG_F6, "v", tsOutputChannels.debugFloatField6, DEBUG_F_PRECISION);
-		reportSensorF(log, GAUGE_NAME_DEBUG_F7, "v", tsOutputChannels.debugFloatField7, DEBUG_F_PRECISION);
-
-		reportSensorI(log, GAUGE_NAME_DEBUG_I1, "v", tsOutputChannels.debugIntField1);
-		reportSensorI(log, GAUGE_NAME_DEBUG_I2, "v", tsOutputChannels.debugIntField2);
-		reportSensorI(log, GAUGE_NAME_DEBUG_I3, "v", tsOutputChannels.debugIntField3);
-		reportSensorI(log, GAUGE_NAME_DEBUG_I4, "v", tsOutputChannels.debugIntField4);
-		reportSensorI(log, GAUGE_NAME_DEBUG_I5, "v", tsOutputChannels.debugIntField5);
-#endif /* EFI_TUNER_STUDIO */
-
-		reportSensorF(log, GAUGE_NAME_TCHARGE, "K", engine->engineState.sd.tChargeK, 2); // log column #8
-		if (hasMapSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
-			reportSensorF(log, GAUGE_NAME_FUEL_VE, "%", engine->engineState.currentBaroCorrectedVE * PERCENT_MULT, 2);
-		}
-		reportSensorF(log, GAUGE_NAME_VVT, "deg", engine->triggerCentral.getVVTPosition(), 1);
-
-	float engineLoad = getEngineLoadT(PASS_ENGINE_PARAMETER_SIGNATURE);
-	reportSensorF(log, GAUGE_NAME_ENGINE_LOAD, "x", engineLoad, 2);
-
-
-	reportSensorF(log, GAUGE_COIL_DWELL_TIME, "ms", ENGINE(engineState.sparkDwell), 2);
-	reportSensorF(log, GAUGE_NAME_TIMING_ADVANCE, "deg", engine->engineState.timingAdvance, 2);
-
-
-	if (hasPedalPositionSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
-		// 136
-		reportSensorF(log, GAUGE_NAME_THROTTLE_PEDAL, "%", getPedalPosition(PASS_ENGINE_PARAMETER_SIGNATURE), 2);
-	}
-
-
-		floatms_t fuelBase = getBaseFuel(rpm PASS_ENGINE_PARAMETER_SUFFIX);
-		reportSensorF(log, GAUGE_NAME_FUEL_BASE, "ms", fuelBase, 2);
-		reportSensorF(log, GAUGE_NAME_FUEL_LAST_INJECTION, "ms", ENGINE(actualLastInjection), 2);
-		reportSensorF(log, GAUGE_NAME_INJECTOR_LAG, "ms", engine->engineState.running.injectorLag, 2);
-		reportSensorF(log, GAUGE_NAME_FUEL_RUNNING, "ms", ENGINE(engineState.running.fuel), 2);
-		// 268
-		reportSensorF(log, GAUGE_NAME_FUEL_PID_CORR, "ms", ENGINE(engineState.running.pidCorrection), 2);
-
-		reportSensorF(log, GAUGE_NAME_FUEL_WALL_AMOUNT, "v", ENGINE(wallFuel[0]).getWallFuel(), 2);
-		reportSensorF(log, GAUGE_NAME_FUEL_WALL_CORRECTION, "v", ENGINE(wallFuel[0]).wallFuelCorrection, 2);
-
-		reportSensorI(log, GAUGE_NAME_VERSION, "#", getRusEfiVersion());
-
-#if EFI_VEHICLE_SPEED
-	if (hasVehicleSpeedSensor()) {
-		float vehicleSpeed = getVehicleSpeed();
-		reportSensorF(log, GAUGE_NAME_VVS, "kph", vehicleSpeed, 2);
-		float sp2rpm = rpm == 0 ? 0 : vehicleSpeed / rpm;
-		reportSensorF(log, "sp2rpm", "x", sp2rpm, 2);
-	}
-#endif /* EFI_PROD_CODE */
-
-
-	reportSensorF(log, GAUGE_NAME_KNOCK_COUNTER, "count", engine->knockCount, 0);
-	reportSensorF(log, GAUGE_NAME_KNOCK_LEVEL, "v", engine->knockVolts, 2);
-
-	//	reportSensorF(log, "vref", "V", getVRef(engineConfiguration), 2);
-
-
-		reportSensorF(log, "f: tps delta", "v", engine->tpsAccelEnrichment.getMaxDelta(), 2);
-		reportSensorF(log, GAUGE_NAME_FUEL_TPS_EXTRA, "ms", engine->engineState.tpsAccelEnrich, 2);
-
-		reportSensorF(log, "f: el delta", "v", engine->engineLoadAccelEnrichment.getMaxDelta(), 2);
-		if (hasMapSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
-			reportSensorF(log, "f: el fuel", "v", engine->engineLoadAccelEnrichment.getEngineLoadEnrichment(PASS_ENGINE_PARAMETER_SIGNATURE) * 100 / getMap(PASS_ENGINE_PARAMETER_SIGNATURE), 2);
-		}
-
-		reportSensorF(log, GAUGE_NAME_FUEL_INJ_DUTY, "%", getInjectorDutyCycle(rpm PASS_ENGINE_PARAMETER_SUFFIX), 2);
-		reportSensorF(log, GAUGE_NAME_DWELL_DUTY, "%", getCoilDutyCycle(rpm PASS_ENGINE_PARAMETER_SUFFIX), 2);
-
-
-
-//	debugFloat(&logger, "tch", getTCharge1(tps), 2);
-
-	for (int i = 0;i<FSIO_ANALOG_INPUT_COUNT;i++) {
-		if (engineConfiguration->fsioAdc[i] != EFI_ADC_NONE) {
-			strcpy(buf, "adcX");
-			buf[3] = '0' + i;
-			reportSensorF(log, buf, "", getVoltage("fsio", engineConfiguration->fsioAdc[i] PASS_ENGINE_PARAMETER_SUFFIX), 2);
-		}
-	}
-
-		reportSensorI(log, GAUGE_NAME_WARNING_COUNTER, "count", engine->engineState.warnings.warningCounter);
-		reportSensorI(log, GAUGE_NAME_WARNING_LAST, "code", engine->engineState.warnings.lastErrorCode);
-
-		reportSensorI(log, INDICATOR_NAME_CLUTCH_UP, "bool", engine->clutchUpState);
-		reportSensorI(log, INDICATOR_NAME_CLUTCH_DOWN, "bool", engine->clutchDownState);
-		reportSensorI(log, INDICATOR_NAME_BRAKE_DOWN, "bool", engine->brakePedalState);
-		reportSensorI(log, INDICATOR_NAME_AC_SWITCH, "bool", engine->acSwitchState);
-
-}
-#endif /* EFI_FILE_LOGGING */
 
 
 void writeLogLine(void) {
 #if EFI_FILE_LOGGING
 	if (!main_loop_started)
 		return;
+#if EFI_SD_BINARY_LOGGING
+	if (isSdCardAlive()) {
+		writeBinaryLogRecord();
+		logFileLineIndex++;
+	}
+#else
 	resetLogging(&fileLogger);
-	printSensors(&fileLogger);
+	// same compiled step program as the binary writer, see binary_log.cpp
+	if (logFileLineIndex == 0) {
+		writeTextLogNames(&fileLogger);
+	} else if (logFileLineIndex == 1) {
+		writeTextLogUnits(&fileLogger);
+	} else {
+		writeTextLogRecord(&fileLogger);
+	}
 
 	if (isSdCardAlive()) {
-		appendPrintf(&fileLogger, "\r\n");
+		append(&fileLogger, "\r\n");
 		appendToLog(fileLogger.buffer);
 		logFileLineIndex++;
 	}
+#endif /* EFI_SD_BINARY_LOGGING */
 #endif /* EFI_FILE_LOGGING */
 }
 
 volatile int needToReportStatus = FALSE;
 static int prevCkpEventCounter = -1;
 
-static LoggingWithStorage logger2("main event handler");
+static Logging logger2("main event handler");
 
 static void printStatus(void) {
 	needToReportStatus = TRUE;
 }
 
+#if EFI_PROD_CODE
+static void printCpuInfo(void) {
+	scheduleMsg(&logger, "CPU busy %f%%, worst 10ms window %f%%", getCpuUsagePercent(),
+			getWorstCpuUsagePercent());
+}
+#endif /* EFI_PROD_CODE */
+
 /**
  * Time when the firmware version was reported last time, in seconds
  * TODO: implement a request/response instead of just constantly sending this out
@@ -437,6 +224,10 @@ void printOverallStatus(systime_t nowSeconds) {
 	waveChart.publishIfFull();
 #endif /* EFI_ENGINE_SNIFFER */
 
+#if EFI_SENSOR_CHART
+	publishSensorChart();
+#endif /* EFI_SENSOR_CHART */
+
 	/**
 	 * we report the version every 4 seconds - this way the console does not need to
 	 * request it and we will display it pretty soon
@@ -488,10 +279,18 @@ void updateDevConsoleState(void) {
 
 
 
+	// format warnings that hot paths only enqueued as raw operands
+	publishDeferredWarnings();
+
 	if (!isCommandLineConsoleReady()) {
 		return;
 	}
 
+	// nobody is listening - skip the formatting work, any received byte re-enables us
+	if (!isConsoleActive()) {
+		return;
+	}
+
 #if EFI_PROD_CODE
 	// todo: unify with simulator!
 	if (hasFirmwareError()) {
@@ -672,15 +471,20 @@ static CommunicationBlinkingTask communicationsBlinkingTask;
 #if EFI_LCD
 class LcdController : public PeriodicController<UTILITY_THREAD_STACK_SIZE> {
 public:
-	LcdController() : PeriodicController("LCD") { }
+	// lowest priority: the frame diff keeps transmissions short but the 4-bit bus
+	// still sleeps between nibbles, gauge rendering should never preempt real work
+	LcdController() : PeriodicController("LCD", LOWPRIO, 2) { }
 private:
 	void PeriodicTask(efitick_t nowNt) override	{
 		UNUSED(nowNt);
-		setPeriod(NOT_TOO_OFTEN(10 /* ms */, engineConfiguration->lcdThreadPeriodMs));
-		if (engineConfiguration->useLcdScreen) {
+		if (board::hasHd44780Lcd && engineConfiguration->useLcdScreen) {
+			setPeriod(NOT_TOO_OFTEN(10 /* ms */, engineConfiguration->lcdThreadPeriodMs));
 #if EFI_HD44780_LCD
 			updateHD44780lcd();
 #endif
+		} else {
+			// no screen in use - just poll the flag a couple of times a second
+			setPeriod(500);
 		}
 	}
 };
@@ -695,12 +499,18 @@ extern HIP9011 instance;
 
 #if EFI_TUNER_STUDIO
 
-void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+/**
+ * The slow tier: temperatures, totals, status flags and version constants. Most of
+ * this is effectively constant between consecutive gauge frames, so it is refreshed
+ * at 10Hz regardless of how fast consumers poll - see updateTunerStudioState().
+ */
+static void updateSlowOutputChannels(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #if EFI_SHAFT_POSITION_INPUT
 	int rpm = GET_RPM();
 #else /* EFI_SHAFT_POSITION_INPUT */
 	int rpm = 0;
 #endif /* EFI_SHAFT_POSITION_INPUT */
+	UNUSED(rpm);
 
 #if EFI_PROD_CODE
 	executorStatistics();
@@ -709,130 +519,43 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 	float coolant = getCoolantTemperature();
 	float intake = getIntakeAirTemperature();
 
-	float engineLoad = getEngineLoadT(PASS_ENGINE_PARAMETER_SIGNATURE);
-
 	// header
 	tsOutputChannels->tsConfigVersion = TS_FILE_VERSION;
 
-	// offset 0
-	tsOutputChannels->rpm = rpm;
 	// offset 4
 	tsOutputChannels->coolantTemperature = coolant;
 	// offset 8
 	tsOutputChannels->intakeAirTemperature = intake;
-
-	SensorResult tps = Sensor::get(SensorType::Tps1);
-	tsOutputChannels->throttlePosition = tps.Value;
-	tsOutputChannels->isTpsError = !tps.Valid;
-	tsOutputChannels->tpsADC = convertVoltageTo10bitADC(Sensor::getRaw(SensorType::Tps1));
-
-	// offset 16
-	tsOutputChannels->massAirFlowVoltage = hasMafSensor() ? getMafVoltage(PASS_ENGINE_PARAMETER_SIGNATURE) : 0;
-
-	if (hasAfrSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
-		// offset 20
-		tsOutputChannels->airFuelRatio = getAfr(PASS_ENGINE_PARAMETER_SIGNATURE);
-	}
-	// offset 24
-	tsOutputChannels->engineLoad = engineLoad;
-	if (hasVBatt(PASS_ENGINE_PARAMETER_SIGNATURE)) {
-		// offset 28
-		tsOutputChannels->vBatt = getVBatt(PASS_ENGINE_PARAMETER_SIGNATURE);
-	}
-
 	// offset 36
 #if EFI_ANALOG_SENSORS
 	tsOutputChannels->baroPressure = hasBaroSensor() ? getBaroPressure() : 0;
 #endif /* EFI_ANALOG_SENSORS */
-	// 48
-	tsOutputChannels->fuelBase = engine->engineState.baseFuel;
-	// 64
-	tsOutputChannels->actualLastInjection = ENGINE(actualLastInjection);
-
-
-	// 104
-	tsOutputChannels->rpmAcceleration = engine->rpmCalculator.getRpmAcceleration();
-	// offset 108
-	// For air-interpolated tCharge mode, we calculate a decent massAirFlow approximation, so we can show it to users even without MAF sensor!
-	tsOutputChannels->massAirFlow = getAirFlowGauge(PASS_ENGINE_PARAMETER_SIGNATURE);
-	// offset 116
-	// TPS acceleration
-	tsOutputChannels->deltaTps = engine->tpsAccelEnrichment.getMaxDelta();
 	// 128
 	tsOutputChannels->totalTriggerErrorCounter = engine->triggerCentral.triggerState.totalTriggerErrorCounter;
 	// 132
 	tsOutputChannels->orderingErrorCounter = engine->triggerCentral.triggerState.orderingErrorCounter;
 	// 68
 	tsOutputChannels->baroCorrection = engine->engineState.baroCorrection;
-	// 136
-	tsOutputChannels->pedalPosition = hasPedalPositionSensor(PASS_ENGINE_PARAMETER_SIGNATURE) ? getPedalPosition(PASS_ENGINE_PARAMETER_SIGNATURE) : 0;
-	// 140
-	tsOutputChannels->injectorDutyCycle = getInjectorDutyCycle(rpm PASS_ENGINE_PARAMETER_SUFFIX);
 	// 148
 	tsOutputChannels->fuelTankLevel = engine->sensors.fuelTankLevel;
-	// 160
-	tsOutputChannels->wallFuelAmount = ENGINE(wallFuel[0]).getWallFuel();
 	// 164
 	tsOutputChannels->iatCorrection = ENGINE(engineState.running.intakeTemperatureCoefficient);
-	// 168
-	tsOutputChannels->wallFuelCorrection = ENGINE(wallFuel[0]).wallFuelCorrection;
 	// 184
 	tsOutputChannels->cltCorrection = ENGINE(engineState.running.coolantTemperatureCoefficient);
-	// 188
-	tsOutputChannels->fuelRunning = ENGINE(engineState.running.fuel);
-	// 196
-	tsOutputChannels->injectorLagMs = ENGINE(engineState.running.injectorLag);
 	// 224
 	efitimesec_t timeSeconds = getTimeNowSeconds();
 	tsOutputChannels->timeSeconds = timeSeconds;
-	// 248
-	tsOutputChannels->vvtPosition = engine->triggerCentral.getVVTPosition();
 	// 252
 	tsOutputChannels->engineMode = packEngineMode(PASS_ENGINE_PARAMETER_SIGNATURE);
 	// 120
 	tsOutputChannels->firmwareVersion = getRusEfiVersion();
-	// 268
-	tsOutputChannels->fuelPidCorrection = ENGINE(engineState.running.pidCorrection);
-	// 276
-	tsOutputChannels->accelerationX = engine->sensors.accelerometer.x;
-	// 278
-	tsOutputChannels->accelerationY = engine->sensors.accelerometer.y;
-	// 280
-	tsOutputChannels->oilPressure = Sensor::get(SensorType::OilPressure).Value;
-	// 288
-	tsOutputChannels->injectionOffset = engine->engineState.injectionOffset;
-
-	if (hasMapSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
-		float mapValue = getMap(PASS_ENGINE_PARAMETER_SIGNATURE);
-		// // offset 112
-		tsOutputChannels->veValue = engine->engineState.currentBaroCorrectedVE * PERCENT_MULT;
-		// todo: bug here? target afr could work based on real MAF?
-		tsOutputChannels->currentTargetAfr = afrMap.getValue(rpm, mapValue);
-		// offset 40
-		tsOutputChannels->manifoldAirPressure = mapValue;
-	}
-
-	tsOutputChannels->knockCount = engine->knockCount;
-	tsOutputChannels->knockLevel = engine->knockVolts;
-
 	tsOutputChannels->hasFatalError = hasFirmwareError();
 
-	tsOutputChannels->coilDutyCycle = getCoilDutyCycle(rpm PASS_ENGINE_PARAMETER_SUFFIX);
-
-
 	tsOutputChannels->isWarnNow = engine->engineState.warnings.isWarningNow(timeSeconds, true);
 #if EFI_HIP_9011
 	tsOutputChannels->isKnockChipOk = (instance.invalidHip9011ResponsesCount == 0);
 #endif /* EFI_HIP_9011 */
 
-
-	tsOutputChannels->tpsAccelFuel = engine->engineState.tpsAccelEnrich;
-	// engine load acceleration
-	if (hasMapSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
-		tsOutputChannels->engineLoadAccelExtra = engine->engineLoadAccelEnrichment.getEngineLoadEnrichment(PASS_ENGINE_PARAMETER_SIGNATURE) * 100 / getMap(PASS_ENGINE_PARAMETER_SIGNATURE);
-	}
-	tsOutputChannels->engineLoadDelta = engine->engineLoadAccelEnrichment.getMaxDelta();
-
 	tsOutputChannels->checkEngine = hasErrorCodes();
 
 #if	HAL_USE_ADC
@@ -844,10 +567,6 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 		tsOutputChannels->egtValues.values[i] = getEgtValue(i);
 #endif /* EFI_MAX_31855 */
 
-#if EFI_IDLE_CONTROL
-	tsOutputChannels->idlePosition = getIdlePosition();
-#endif
-
 #if EFI_PROD_CODE
 	tsOutputChannels->isTriggerError = isTriggerErrorNow();
 
@@ -894,6 +613,111 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 	tsOutputChannels->brakePedalState = engine->brakePedalState;
 	tsOutputChannels->acSwitchState = engine->acSwitchState;
 
+}
+
+/**
+ * The fast tier: everything that moves within an engine cycle, populated on every
+ * consumer request. The debugMode switch at the bottom is lazy by construction -
+ * only the page a consumer actually selected is ever computed.
+ */
+static void updateFastOutputChannels(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+#if EFI_SHAFT_POSITION_INPUT
+	int rpm = GET_RPM();
+#else /* EFI_SHAFT_POSITION_INPUT */
+	int rpm = 0;
+#endif /* EFI_SHAFT_POSITION_INPUT */
+
+	float engineLoad = getEngineLoadT(PASS_ENGINE_PARAMETER_SIGNATURE);
+
+	// offset 0
+	tsOutputChannels->rpm = rpm;
+
+	SensorResult tps = Sensor::get(SensorType::Tps1);
+	tsOutputChannels->throttlePosition = tps.Value;
+	tsOutputChannels->isTpsError = !tps.Valid;
+	tsOutputChannels->tpsADC = convertVoltageTo10bitADC(Sensor::getRaw(SensorType::Tps1));
+
+	// offset 16
+	tsOutputChannels->massAirFlowVoltage = hasMafSensor() ? getMafVoltage(PASS_ENGINE_PARAMETER_SIGNATURE) : 0;
+
+	if (hasAfrSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
+		// offset 20
+		tsOutputChannels->airFuelRatio = getAfr(PASS_ENGINE_PARAMETER_SIGNATURE);
+	}
+	// offset 24
+	tsOutputChannels->engineLoad = engineLoad;
+	if (hasVBatt(PASS_ENGINE_PARAMETER_SIGNATURE)) {
+		// offset 28
+		tsOutputChannels->vBatt = getVBatt(PASS_ENGINE_PARAMETER_SIGNATURE);
+	}
+
+	// 48
+	tsOutputChannels->fuelBase = engine->engineState.baseFuel;
+	// 64
+	tsOutputChannels->actualLastInjection = ENGINE(actualLastInjection);
+
+
+	// 104
+	tsOutputChannels->rpmAcceleration = engine->rpmCalculator.getRpmAcceleration();
+	// offset 108
+	// For air-interpolated tCharge mode, we calculate a decent massAirFlow approximation, so we can show it to users even without MAF sensor!
+	tsOutputChannels->massAirFlow = getAirFlowGauge(PASS_ENGINE_PARAMETER_SIGNATURE);
+	// offset 116
+	// TPS acceleration
+	tsOutputChannels->deltaTps = engine->tpsAccelEnrichment.getMaxDelta();
+	// 136
+	tsOutputChannels->pedalPosition = hasPedalPositionSensor(PASS_ENGINE_PARAMETER_SIGNATURE) ? getPedalPosition(PASS_ENGINE_PARAMETER_SIGNATURE) : 0;
+	// 140
+	tsOutputChannels->injectorDutyCycle = getInjectorDutyCycle(rpm PASS_ENGINE_PARAMETER_SUFFIX);
+	// 160
+	tsOutputChannels->wallFuelAmount = ENGINE(wallFuel[0]).getWallFuel();
+	// 168
+	tsOutputChannels->wallFuelCorrection = ENGINE(wallFuel[0]).wallFuelCorrection;
+	// 188
+	tsOutputChannels->fuelRunning = ENGINE(engineState.running.fuel);
+	// 196
+	tsOutputChannels->injectorLagMs = ENGINE(engineState.running.injectorLag);
+	// 248
+	tsOutputChannels->vvtPosition = engine->triggerCentral.getVVTPosition();
+	// 268
+	tsOutputChannels->fuelPidCorrection = ENGINE(engineState.running.pidCorrection);
+	// 276
+	tsOutputChannels->accelerationX = engine->sensors.accelerometer.x;
+	// 278
+	tsOutputChannels->accelerationY = engine->sensors.accelerometer.y;
+	// 280
+	tsOutputChannels->oilPressure = Sensor::get(SensorType::OilPressure).Value;
+	// 288
+	tsOutputChannels->injectionOffset = engine->engineState.injectionOffset;
+
+	if (hasMapSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
+		float mapValue = getMap(PASS_ENGINE_PARAMETER_SIGNATURE);
+		// // offset 112
+		tsOutputChannels->veValue = engine->engineState.currentBaroCorrectedVE * PERCENT_MULT;
+		// todo: bug here? target afr could work based on real MAF?
+		tsOutputChannels->currentTargetAfr = afrMap.getValue(rpm, mapValue);
+		// offset 40
+		tsOutputChannels->manifoldAirPressure = mapValue;
+	}
+
+	tsOutputChannels->knockCount = engine->knockCount;
+	tsOutputChannels->knockLevel = engine->knockVolts;
+
+	tsOutputChannels->coilDutyCycle = getCoilDutyCycle(rpm PASS_ENGINE_PARAMETER_SUFFIX);
+
+
+
+	tsOutputChannels->tpsAccelFuel = engine->engineState.tpsAccelEnrich;
+	// engine load acceleration
+	if (hasMapSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
+		tsOutputChannels->engineLoadAccelExtra = engine->engineLoadAccelEnrichment.getEngineLoadEnrichment(PASS_ENGINE_PARAMETER_SIGNATURE) * 100 / getMap(PASS_ENGINE_PARAMETER_SIGNATURE);
+	}
+	tsOutputChannels->engineLoadDelta = engine->engineLoadAccelEnrichment.getMaxDelta();
+
+#if EFI_IDLE_CONTROL
+	tsOutputChannels->idlePosition = getIdlePosition();
+#endif
+
 	// tCharge depends on the previous state, so we should use the stored value.
 	tsOutputChannels->tCharge = ENGINE(engineState.sd.tCharge);
 	float timing = engine->engineState.timingAdvance;
@@ -911,7 +735,7 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 		tsOutputChannels->debugFloatField2 = engine->sensors.auxTemp2;
 		break;
 	case DBG_STATUS:
-		tsOutputChannels->debugFloatField1 = timeSeconds;
+		tsOutputChannels->debugFloatField1 = getTimeNowSeconds();
 		tsOutputChannels->debugIntField1 = atoi(VCS_VERSION);
 		break;
 	case DBG_METRICS:
@@ -919,6 +743,24 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 		tsOutputChannels->debugIntField1 = maxLockedDuration;
 		tsOutputChannels->debugIntField2 = maxTriggerReentraint;
 #endif /* EFI_CLOCK_LOCKS */
+#if EFI_PROD_CODE
+		tsOutputChannels->debugFloatField1 = getCpuUsagePercent();
+		tsOutputChannels->debugFloatField2 = getWorstCpuUsagePercent();
+#endif /* EFI_PROD_CODE */
+#if ENABLE_PERF_TRACE
+		// worst-case cycles of the two hottest paths, see 'perfcount' for the full picture
+		tsOutputChannels->debugIntField3 = getPerfCounter(PE::MainTriggerCallback)->maxCycles;
+		tsOutputChannels->debugIntField4 = getPerfCounter(PE::EnginePeriodicFastCallback)->maxCycles;
+#endif /* ENABLE_PERF_TRACE */
+		break;
+	case DBG_ISR_BUDGET:
+		updateIsrBudgetDebugChannels(tsOutputChannels);
+		break;
+	case DBG_SENSOR_FRESHNESS:
+		tsOutputChannels->debugIntField1 = Sensor::getTotalStaleCounter();
+		tsOutputChannels->debugIntField2 = Sensor::getStaleCount();
+		tsOutputChannels->debugIntField3 = Sensor::getStaleCounter(SensorType::Tps1);
+		tsOutputChannels->debugIntField4 = Sensor::getStaleCounter(SensorType::OilPressure);
 		break;
 	case DBG_TPS_ACCEL:
 		tsOutputChannels->debugIntField1 = engine->tpsAccelEnrichment.cb.getSize();
@@ -964,10 +806,12 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 		tsOutputChannels->debugFloatField5 = getFsioOutputValue(4 PASS_ENGINE_PARAMETER_SUFFIX);
 		tsOutputChannels->debugFloatField6 = getFsioOutputValue(5 PASS_ENGINE_PARAMETER_SUFFIX);
 		tsOutputChannels->debugFloatField7 = getFsioOutputValue(6 PASS_ENGINE_PARAMETER_SUFFIX);
+		tsOutputChannels->debugIntField1 = getFsioBudgetOverrunCounter();
 #endif /* EFI_FSIO */
 		break;
 	case DBG_VEHICLE_SPEED_SENSOR:
 		tsOutputChannels->debugIntField1 = engine->engineState.vssEventCounter;
+		tsOutputChannels->debugIntField2 = getDetectedGear();
 		break;
 	case DBG_CRANKING_DETAILS:
 		tsOutputChannels->debugIntField1 = engine->rpmCalculator.getRevolutionCounterSinceStart();
@@ -1028,6 +872,27 @@ void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_
 	}
 }
 
+/**
+ * Output channel population is split into rate tiers: profiling showed this among the
+ * top thread-context CPU users, mostly recomputing values that had not moved. Consumers
+ * pull at up to ~100Hz, the slow fields genuinely change at human speed.
+ */
+#define SLOW_OUTPUT_CHANNELS_PERIOD_MS 100
+
+static efitick_t lastSlowRefreshTimeNt = 0;
+
+void updateTunerStudioState(TunerStudioOutputChannels *tsOutputChannels DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	updateFastOutputChannels(tsOutputChannels PASS_ENGINE_PARAMETER_SUFFIX);
+	tsState.fastOutputRefreshCounter++;
+
+	efitick_t nowNt = getTimeNowNt();
+	if (nowNt - lastSlowRefreshTimeNt >= US2NT(MS2US(SLOW_OUTPUT_CHANNELS_PERIOD_MS))) {
+		lastSlowRefreshTimeNt = nowNt;
+		updateSlowOutputChannels(tsOutputChannels PASS_ENGINE_PARAMETER_SUFFIX);
+		tsState.slowOutputRefreshCounter++;
+	}
+}
+
 void prepareTunerStudioOutputs(void) {
 	// sensor state for EFI Analytics Tuner Studio
 	updateTunerStudioState(&tsOutputChannels PASS_ENGINE_PARAMETER_SUFFIX);
@@ -1046,6 +911,10 @@ void initStatusLoop(void) {
 #if EFI_PROD_CODE
 
 	addConsoleAction("status", printStatus);
+	addConsoleAction("cpuinfo", printCpuInfo);
+	addConsoleAction("cpureset", resetCpuUsageStats);
+	initPeriodicDeadlineTracking();
+	initCopyAudit();
 #endif /* EFI_PROD_CODE */
 }
 
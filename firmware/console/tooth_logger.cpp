@@ -16,7 +16,10 @@
 #include "efilib.h"
 #include "tunerstudio_configuration.h"
 
-static uint16_t buffer[1000] CCM_OPTIONAL;
+// at 10us per LSB that's four revolutions worth of 60-2 teeth even at 9000 RPM, long
+// enough to catch intermittent trigger noise. The ring lives in CCM and is served to
+// the console in place, so growing it only costs otherwise-idle core-coupled RAM.
+static uint16_t buffer[2000] CCM_OPTIONAL;
 static size_t NextIdx = 0;
 static volatile bool ToothLoggerEnabled = false;
 
@@ -80,7 +83,12 @@ void DisableToothLogger() {
 }
 
 ToothLoggerBuffer GetToothLoggerBuffer() {
-	return { reinterpret_cast<uint8_t*>(buffer), sizeof(buffer) };
+	// NextIdx is the next slot to be written, which makes it the oldest entry: the
+	// span from there to the end goes first, the span from the start of the ring
+	// second, so the client sees one chronological stream
+	size_t splitIdx = NextIdx;
+	return { reinterpret_cast<uint8_t*>(buffer + splitIdx), sizeof(buffer) - 2 * splitIdx,
+			reinterpret_cast<uint8_t*>(buffer), 2 * splitIdx };
 }
 
 #endif /* EFI_TOOTH_LOGGER */
@@ -23,8 +23,13 @@ void LogTriggerTooth(trigger_event_e tooth, efitick_t timestamp);
 
 struct ToothLoggerBuffer
 {
+	// the ring in chronological order: older span first, newer span second. Two spans
+	// instead of one buffer so that a wrapped ring can be transmitted in place, with
+	// no staging copy - see sr5WriteCrcPacketTwoSpans
 	const uint8_t* const Buffer;
 	const size_t Length;
+	const uint8_t* const Buffer2;
+	const size_t Length2;
 };
 
 // Get a reference to the buffer
@@ -85,12 +85,14 @@ public:
 
 
 			float value = engine->triggerCentral.getVVTPosition();
+			// measured cam movement rate, handy while tuning the D term
+			float valueRate = engine->triggerCentral.getVVTPhaseRate();
 			float targetValue = table->getValue(rpm, getEngineLoadT(PASS_ENGINE_PARAMETER_SIGNATURE));
 
 			percent_t pwm = auxPid.getOutput(targetValue, value);
 			if (engineConfiguration->isVerboseAuxPid1) {
-				scheduleMsg(logger, "aux duty: %.2f/value=%.2f/p=%.2f/i=%.2f/d=%.2f int=%.2f", pwm, value,
-						auxPid.getP(), auxPid.getI(), auxPid.getD(), auxPid.getIntegration());
+				scheduleMsg(logger, "aux duty: %.2f/value=%.2f/rate=%.2f/p=%.2f/i=%.2f/d=%.2f int=%.2f", pwm, value,
+						valueRate, auxPid.getP(), auxPid.getI(), auxPid.getD(), auxPid.getIntegration());
 			}
 
 
@@ -98,6 +100,7 @@ public:
 #if EFI_TUNER_STUDIO
 				auxPid.postState(&tsOutputChannels);
 				tsOutputChannels.debugIntField3 = (int)(10 * targetValue);
+				tsOutputChannels.debugFloatField7 = valueRate;
 #endif /* EFI_TUNER_STUDIO */
 			}
 
@@ -25,6 +25,7 @@
 #include "pwm_generator.h"
 #include "pid_auto_tune.h"
 #include "local_version_holder.h"
+#include "engine_math.h"
 #define NO_PIN_PERIOD 500
 
 #if defined(HAS_OS_ACCESS)
@@ -50,6 +51,60 @@ static void pidReset(void) {
 	boostControlPid.reset();
 }
 
+static float previousCycleMap = 0;
+
+/**
+ * Invoked from the main trigger callback once per engine cycle, in the same event batch
+ * as the injection math. A wall-clock PID at the default 100ms period is several cycles
+ * stale at speed; here every cycle gets a fresh duty, and the open-loop lookup leads the
+ * measurement by one cycle of MAP trajectory so the wastegate starts moving before a
+ * gear-change boost spike has built.
+ */
+void onEngineCycleBoostControl(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (!engineConfiguration->isBoostControlEnabled) {
+		return;
+	}
+	if (rpm <= engineConfiguration->cranking.rpm) {
+		previousCycleMap = 0;
+		return;
+	}
+
+	float mapValue = getMap(PASS_ENGINE_PARAMETER_SIGNATURE);
+	// extrapolate one cycle ahead along the MAP trajectory; at steady state this
+	// degenerates to the measured value
+	float predictedMap = mapValue;
+	if (previousCycleMap > 0) {
+		predictedMap = mapValue + (mapValue - previousCycleMap);
+	}
+	previousCycleMap = mapValue;
+
+	percent_t openLoopDuty = boostMapOpen.getValue(rpm / RPM_1_BYTE_PACKING_MULT, predictedMap / LOAD_1_BYTE_PACKING_MULT) * LOAD_1_BYTE_PACKING_MULT;
+	percent_t closedLoopDuty = 0;
+	percent_t duty = openLoopDuty;
+
+	if (engineConfiguration->boostType == CLOSED_LOOP) {
+		float tps = getTPS(PASS_ENGINE_PARAMETER_SIGNATURE);
+		float targetBoost = boostMapClosed.getValue(rpm / RPM_1_BYTE_PACKING_MULT, tps / TPS_1_BYTE_PACKING_MULT) * LOAD_1_BYTE_PACKING_MULT;
+		// the PID still integrates in real elapsed time, which is now one engine cycle
+		float dTime = MS2SEC(getEngineCycleDuration(rpm PASS_ENGINE_PARAMETER_SUFFIX));
+		closedLoopDuty = openLoopDuty + boostControlPid.getOutput(targetBoost, mapValue, dTime);
+		duty += closedLoopDuty;
+	}
+
+	boostControlPid.iTermMin = -50;
+	boostControlPid.iTermMax = 50;
+
+	if (engineConfiguration->debugMode == DBG_BOOST) {
+#if EFI_TUNER_STUDIO
+		boostControlPid.postState(&tsOutputChannels);
+		tsOutputChannels.debugFloatField1 = openLoopDuty;
+		tsOutputChannels.debugFloatField7 = closedLoopDuty;
+#endif /* EFI_TUNER_STUDIO */
+	}
+
+	boostPwmControl.setSimplePwmDutyCycle(PERCENT_TO_DUTY(duty));
+}
+
 class BoostControl: public PeriodicTimerController {
 	int getPeriodMs() override {
 		return GET_PERIOD_LIMITED(&engineConfiguration->boostPid);
@@ -61,41 +116,17 @@ class BoostControl: public PeriodicTimerController {
 			shouldResetPid = false;
 		}
 
-		float rpm = GET_RPM_VALUE;
-		float mapValue = getMap(PASS_ENGINE_PARAMETER_SIGNATURE);
-
 		if (!engineConfiguration->isBoostControlEnabled)
 			return;
 
+		// the engine cycle callback owns the duty while running, this wall-clock
+		// fallback only winds the controller down once the engine stops
+		float rpm = GET_RPM_VALUE;
 		bool engineRunning = rpm > engineConfiguration->cranking.rpm;
 		if (!engineRunning) {
 			boostControlPid.reset();
-			return;
+			previousCycleMap = 0;
 		}
-
-		percent_t openLoopDuty = boostMapOpen.getValue(rpm / RPM_1_BYTE_PACKING_MULT, mapValue / LOAD_1_BYTE_PACKING_MULT) * LOAD_1_BYTE_PACKING_MULT;
-		percent_t closedLoopDuty = 0;
-		percent_t duty = openLoopDuty;
-
-		if (engineConfiguration->boostType == CLOSED_LOOP) {
-			float tps = getTPS(PASS_ENGINE_PARAMETER_SIGNATURE);
-			float targetBoost = boostMapClosed.getValue(rpm / RPM_1_BYTE_PACKING_MULT, tps / TPS_1_BYTE_PACKING_MULT) * LOAD_1_BYTE_PACKING_MULT;
-			closedLoopDuty = openLoopDuty + boostControlPid.getOutput(targetBoost, mapValue);
-			duty += closedLoopDuty;
-		}
-
-		boostControlPid.iTermMin = -50;
-		boostControlPid.iTermMax = 50;
-
-		if (engineConfiguration->debugMode == DBG_BOOST) {
-#if EFI_TUNER_STUDIO
-			boostControlPid.postState(&tsOutputChannels);
-			tsOutputChannels.debugFloatField1 = openLoopDuty;
-			tsOutputChannels.debugFloatField7 = closedLoopDuty;
-#endif /* EFI_TUNER_STUDIO */
-		}
-
-		boostPwmControl.setSimplePwmDutyCycle(PERCENT_TO_DUTY(duty));
 	}
 };
 
@@ -13,6 +13,7 @@
 
 
 
+void onEngineCycleBoostControl(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX);
 void startBoostPin(void);
 void stopBoostPin(void);
 void initBoostCtrl(Logging *sharedLogger);
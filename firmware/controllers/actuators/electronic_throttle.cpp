@@ -204,10 +204,16 @@ void EtbController::showStatus(Logging* logger) {
 }
 
 int EtbController::getPeriodMs() {
-	return GET_PERIOD_LIMITED(&engineConfiguration->etb);
+	// the inner loop is allowed to run faster than the generic PID floor, the
+	// actual tick period is fed into the PID math explicitly
+	return maxI(ETB_MINIMAL_PERIOD_MS, engineConfiguration->etb.periodMs);
 }
 
-void EtbController::PeriodicTask() {
+/**
+ * supervision at the decimated rate: everything with table lookups, formatting
+ * or TunerStudio traffic. The inner tick only consumes the cached results.
+ */
+bool EtbController::runOuterLoop(percent_t actualThrottlePosition) {
 #if EFI_TUNER_STUDIO
 	// Only debug throttle #0
 	if (m_myIndex == 0) {
@@ -222,32 +228,6 @@ void EtbController::PeriodicTask() {
 	}
 #endif /* EFI_TUNER_STUDIO */
 
-	if (!m_motor) {
-		return;
-	}
-
-	if (startupPositionError) {
-		m_motor->set(0);
-		return;
-	}
-
-	if (m_shouldResetPid) {
-		m_pid.reset();
-		m_shouldResetPid = false;
-	}
-
-	if (!cisnan(directPwmValue)) {
-		m_motor->set(directPwmValue);
-		return;
-	}
-
-	if (engineConfiguration->pauseEtbControl) {
-		m_motor->set(0);
-		return;
-	}
-
-	percent_t actualThrottlePosition = getTPSWithIndex(m_myIndex PASS_ENGINE_PARAMETER_SUFFIX);
-
 	if (engine->etbAutoTune) {
 		autoTune.input = actualThrottlePosition;
 		bool result = autoTune.Runtime(&logger);
@@ -263,18 +243,25 @@ void EtbController::PeriodicTask() {
 
 		if (result) {
 			scheduleMsg(&logger, "GREAT NEWS! %f/%f/%f", autoTune.GetKp(), autoTune.GetKi(), autoTune.GetKd());
+			// the tune converged: stop driving the throttle and apply the result
+			// atomically through the configuration versioning path so every
+			// listener picks it up like any other setting change
+			engineConfiguration->etb.pFactor = autoTune.GetKp();
+			engineConfiguration->etb.iFactor = autoTune.GetKi();
+			engineConfiguration->etb.dFactor = autoTune.GetKd();
+			engine->etbAutoTune = false;
+			incrementGlobalConfigurationVersion(PASS_ENGINE_PARAMETER_SIGNATURE);
 		}
 
-		return;
+		return true;
 	}
 
-
 	percent_t pedalPosition = getPedalPosition(PASS_ENGINE_PARAMETER_SIGNATURE);
 
 	int rpm = GET_RPM();
 	engine->engineState.targetFromTable = pedal2tpsMap.getValue(rpm / RPM_1_BYTE_PACKING_MULT, pedalPosition);
 	percent_t etbIdleAddition = CONFIG(useETBforIdleControl) ? engine->engineState.idle.etbIdleAddition : 0;
-	percent_t targetPosition = engine->engineState.targetFromTable + etbIdleAddition;
+	m_targetPosition = engine->engineState.targetFromTable + etbIdleAddition;
 
 	if (engineConfiguration->debugMode == DBG_ETB_LOGIC) {
 #if EFI_TUNER_STUDIO
@@ -283,24 +270,72 @@ void EtbController::PeriodicTask() {
 #endif /* EFI_TUNER_STUDIO */
 	}
 
-	if (cisnan(targetPosition)) {
+	if (cisnan(m_targetPosition)) {
 		// this could happen while changing settings
 		warning(CUSTOM_ERR_ETB_TARGET, "target");
-		return;
+	} else {
+		engine->engineState.etbFeedForward = interpolate2d("etbb", m_targetPosition, engineConfiguration->etbBiasBins, engineConfiguration->etbBiasValues);
+		m_feedForward = engine->engineState.etbFeedForward;
 	}
-	engine->engineState.etbFeedForward = interpolate2d("etbb", targetPosition, engineConfiguration->etbBiasBins, engineConfiguration->etbBiasValues);
 
 	m_pid.iTermMin = engineConfiguration->etb_iTermMin;
 	m_pid.iTermMax = engineConfiguration->etb_iTermMax;
 
-	currentEtbDuty = engine->engineState.etbFeedForward +
-			m_pid.getOutput(targetPosition, actualThrottlePosition);
-
-	m_motor->set(ETB_PERCENT_TO_DUTY(currentEtbDuty));
-
 	if (engineConfiguration->isVerboseETB) {
 		m_pid.showPidStatus(&logger, "ETB");
 	}
+	return false;
+}
+
+void EtbController::PeriodicTask() {
+	/**
+	 * the cheap safety flag checks stay in the fast path, everything heavyweight
+	 * lives in runOuterLoop() and runs every ETB_OUTER_DECIMATION ticks
+	 */
+	if (!m_motor) {
+		return;
+	}
+
+	if (startupPositionError) {
+		m_motor->set(0);
+		return;
+	}
+
+	if (m_shouldResetPid) {
+		m_pid.reset();
+		m_shouldResetPid = false;
+	}
+
+	if (!cisnan(directPwmValue)) {
+		m_motor->set(directPwmValue);
+		return;
+	}
+
+	if (engineConfiguration->pauseEtbControl) {
+		m_motor->set(0);
+		return;
+	}
+
+	percent_t actualThrottlePosition = getTPSWithIndex(m_myIndex PASS_ENGINE_PARAMETER_SUFFIX);
+
+	if (--m_outerDecimationCounter <= 0) {
+		m_outerDecimationCounter = ETB_OUTER_DECIMATION;
+		if (runOuterLoop(actualThrottlePosition)) {
+			// autotune drove the motor on this tick
+			return;
+		}
+	}
+
+	if (cisnan(m_targetPosition)) {
+		return;
+	}
+
+	// the explicit dTime keeps the PID math correct now that the loop is allowed
+	// to run below the generic PID_MINIMAL_PERIOD_MS floor
+	currentEtbDuty = m_feedForward +
+			m_pid.getOutput(m_targetPosition, actualThrottlePosition, MS2SEC(getPeriodMs()));
+
+	m_motor->set(ETB_PERCENT_TO_DUTY(currentEtbDuty));
 
 	DISPLAY_STATE(Engine)
 DISPLAY(DISPLAY_IF(hasEtbPedalPositionSensor))
@@ -361,6 +396,27 @@ static EtbHardware etbHardware[ETB_COUNT];
 // real implementation (we mock for some unit tests)
 EtbController etbControllers[ETB_COUNT];
 
+// set once the control loops are started, so that early sensor pushes do not touch idle timers
+static bool etbPushModeArmed = false;
+
+void etbOnTpsChanged(float position, efitick_t nowNt) {
+	UNUSED(position);
+	UNUSED(nowNt);
+
+	if (!etbPushModeArmed) {
+		return;
+	}
+
+	/**
+	 * We are in the ADC thread context here so we do not run the control math in place -
+	 * we just pull the next PID iteration in so that it consumes the fresh reading now
+	 * instead of up to one loop period later.
+	 */
+	for (int i = 0; i < ETB_COUNT; i++) {
+		etbControllers[i].rescheduleSoon();
+	}
+}
+
 static void showEthInfo(void) {
 #if EFI_PROD_CODE
 	static char pinNameBuffer[16];
@@ -756,6 +812,9 @@ void doInitElectronicThrottle(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	for (int i = 0 ; i < engine->etbActualCount; i++) {
 		engine->etbControllers[i]->Start();
 	}
+
+	// from now on fresh TPS readings are allowed to pull PID iterations in, see etbOnTpsChanged
+	etbPushModeArmed = true;
 }
 
 
@@ -8,8 +8,12 @@
 #pragma once
 
 // https://en.wikipedia.org/wiki/Nyquist%E2%80%93Shannon_sampling_theorem
-#define DEFAULT_ETB_LOOP_FREQUENCY 200
+#define DEFAULT_ETB_LOOP_FREQUENCY 500
 #define DEFAULT_ETB_PWM_FREQUENCY 300
+// the millisecond-granularity timer caps the inner loop at 1 kHz
+#define ETB_MINIMAL_PERIOD_MS 1
+// supervision work (target table, limp checks, autotune, logging) runs every Nth inner tick
+#define ETB_OUTER_DECIMATION 5
 
 #include "engine.h"
 #include "periodic_task.h"
@@ -44,15 +48,32 @@ public:
 	const pid_state_s* getPidState() const { return &m_pid; };
 
 private:
+	/**
+	 * the decimated outer loop: target table lookup, feed-forward, autotune and
+	 * logging. @return true if autotune consumed this tick
+	 */
+	bool runOuterLoop(percent_t actualThrottlePosition);
+
 	int m_myIndex;
 	DcMotor *m_motor;
 	Pid m_pid;
 	bool m_shouldResetPid = false;
+	int m_outerDecimationCounter = 0;
+	// refreshed by the outer loop, consumed by every inner tick
+	percent_t m_targetPosition = 0;
+	percent_t m_feedForward = 0;
 };
 
 void initElectronicThrottle(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 void doInitElectronicThrottle(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 
+/**
+ * Push-mode notification about a fresh throttle position reading, see
+ * StoredValueSensor::setOnChange. Makes the control loop react within one ADC tick
+ * instead of up to one loop period later.
+ */
+void etbOnTpsChanged(float position, efitick_t nowNt);
+
 void setDefaultEtbBiasCurve(DECLARE_CONFIG_PARAMETER_SIGNATURE);
 void setDefaultEtbParameters(DECLARE_CONFIG_PARAMETER_SIGNATURE);
 void setBoschVNH2SP30Curve(DECLARE_CONFIG_PARAMETER_SIGNATURE);
@@ -43,6 +43,7 @@
 #if ! EFI_UNIT_TEST
 #include "stepper.h"
 #include "pin_repository.h"
+#include "backup_ram.h"
 static StepDirectionStepper iacStepperHw;
 static StepperMotor iacMotor;
 #endif /* EFI_UNIT_TEST */
@@ -228,10 +229,98 @@ static bool isOutOfAutomaticIdleCondition(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 }
 
 /**
- * @return idle valve position percentage for automatic closed loop mode
+ * Top-level idle phases. The guards below are evaluated once per tick in priority
+ * order and the rest of the tick dispatches on the resulting phase instead of
+ * re-deriving the same conditions in several places.
  */
-static percent_t automaticIdleController(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+typedef enum {
+	IDLE_PHASE_CRANKING = 0,
+	IDLE_PHASE_BLIP,
+	IDLE_PHASE_MANUAL,
+	IDLE_PHASE_OUT_OF_IDLE,
+	IDLE_PHASE_AUTO,
+} idle_phase_e;
+
+static const char *idlePhaseNames[] = { "cranking", "blip", "manual", "out-of-idle", "auto" };
+
+typedef struct {
+	idle_phase_e fromPhase;
+	idle_phase_e toPhase;
+	efitimeus_t atUs;
+	// how long we spent in fromPhase
+	int durationUs;
+	int rpm;
+} idle_phase_transition_s;
+
+#define IDLE_TRACE_SIZE 16
+
+static idle_phase_transition_s idleTrace[IDLE_TRACE_SIZE];
+static int idleTraceCount = 0;
+static idle_phase_e currentIdlePhase = IDLE_PHASE_CRANKING;
+static efitimeus_t idlePhaseStartUs = 0;
+
+static idle_phase_e determineIdlePhase(bool isRunning DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (timeToStopBlip != 0) {
+		return IDLE_PHASE_BLIP;
+	}
+	if (!isRunning) {
+		// during cranking it's always manual mode, PID would make no sense during cranking
+		return IDLE_PHASE_CRANKING;
+	}
+	if (engineConfiguration->idleMode == IM_MANUAL) {
+		return IDLE_PHASE_MANUAL;
+	}
 	if (isOutOfAutomaticIdleCondition(PASS_ENGINE_PARAMETER_SIGNATURE)) {
+		return IDLE_PHASE_OUT_OF_IDLE;
+	}
+	return IDLE_PHASE_AUTO;
+}
+
+/**
+ * records phase transitions so that idle-entry latency - say the dip on A/C
+ * engagement - is measurable from the 'idletrace' console command instead of
+ * being guessed from a log
+ */
+static void recordIdlePhase(idle_phase_e newPhase DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (newPhase == currentIdlePhase) {
+		return;
+	}
+	efitimeus_t nowUs = getTimeNowUs();
+	idle_phase_transition_s *transition = &idleTrace[idleTraceCount % IDLE_TRACE_SIZE];
+	transition->fromPhase = currentIdlePhase;
+	transition->toPhase = newPhase;
+	transition->atUs = nowUs;
+	transition->durationUs = (int) (nowUs - idlePhaseStartUs);
+	transition->rpm = GET_RPM();
+	idleTraceCount++;
+
+	if (engineConfiguration->isVerboseIAC) {
+		scheduleMsg(logger, "idle: %s -> %s after %dms @ rpm=%d", idlePhaseNames[currentIdlePhase],
+				idlePhaseNames[newPhase], transition->durationUs / 1000, transition->rpm);
+	}
+
+	currentIdlePhase = newPhase;
+	idlePhaseStartUs = nowUs;
+}
+
+static void printIdleTrace(void) {
+	scheduleMsg(logger, "idle phase=%s for %dms, %d transitions", idlePhaseNames[currentIdlePhase],
+			(int) ((getTimeNowUs() - idlePhaseStartUs) / 1000), idleTraceCount);
+	int count = minI(idleTraceCount, IDLE_TRACE_SIZE);
+	for (int i = 0; i < count; i++) {
+		// oldest first
+		idle_phase_transition_s *transition = &idleTrace[(idleTraceCount - count + i) % IDLE_TRACE_SIZE];
+		scheduleMsg(logger, "idletrace: t=%dms %s -> %s after %dms @ rpm=%d",
+				(int) (transition->atUs / 1000), idlePhaseNames[transition->fromPhase],
+				idlePhaseNames[transition->toPhase], transition->durationUs / 1000, transition->rpm);
+	}
+}
+
+/**
+ * @return idle valve position percentage for automatic closed loop mode
+ */
+static percent_t automaticIdleController(bool isOutOfIdle DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (isOutOfIdle) {
 		// Don't store old I and D terms if PID doesn't work anymore.
 		// Otherwise they will affect the idle position much later, when the throttle is closed.
 		if (mightResetPid) {
@@ -274,6 +363,11 @@ static percent_t automaticIdleController(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	percent_t newValue = idlePid.getOutput(targetRpm, rpm);
 	engine->engineState.idle.idleState = PID_VALUE;
 
+#if EFI_PROD_CODE
+	// shadow the integrator so that the next power cycle starts from a converged position
+	setLearnedValue(LEARNED_IDLE_INTEGRATOR, idlePid.getIntegration());
+#endif /* EFI_PROD_CODE */
+
 	// the state of PID has been changed, so we might reset it now, but only when needed (see idlePidDeactivationTpsThreshold)
 	mightResetPid = true;
 
@@ -341,10 +435,12 @@ static percent_t automaticIdleController(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 
 
 #if EFI_GPIO_HARDWARE
+#if !EFI_SWITCH_INPUTS
 		// this value is not used yet
 		if (CONFIG(clutchDownPin) != GPIO_UNASSIGNED) {
 			engine->clutchDownState = efiReadPin(CONFIG(clutchDownPin));
 		}
+#endif /* EFI_SWITCH_INPUTS */
 		if (hasAcToggle(PASS_ENGINE_PARAMETER_SIGNATURE)) {
 			bool result = getAcToggle(PASS_ENGINE_PARAMETER_SIGNATURE);
 			if (engine->acSwitchState != result) {
@@ -353,6 +449,7 @@ static percent_t automaticIdleController(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 			}
 			engine->acSwitchState = result;
 		}
+#if !EFI_SWITCH_INPUTS
 		if (CONFIG(clutchUpPin) != GPIO_UNASSIGNED) {
 			engine->clutchUpState = efiReadPin(CONFIG(clutchUpPin));
 		}
@@ -363,6 +460,7 @@ static percent_t automaticIdleController(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 		if (engineConfiguration->brakePedalPin != GPIO_UNASSIGNED) {
 			engine->brakePedalState = efiReadPin(engineConfiguration->brakePedalPin);
 		}
+#endif /* EFI_SWITCH_INPUTS */
 #endif /* EFI_GPIO_HARDWARE */
 
 		finishIdleTestIfNeeded();
@@ -389,23 +487,25 @@ static percent_t automaticIdleController(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 
 		percent_t iacPosition;
 
-		if (timeToStopBlip != 0) {
+		idle_phase_e phase = determineIdlePhase(isRunning PASS_ENGINE_PARAMETER_SUFFIX);
+		recordIdlePhase(phase PASS_ENGINE_PARAMETER_SUFFIX);
+
+		if (phase == IDLE_PHASE_BLIP) {
 			iacPosition = blipIdlePosition;
 			engine->engineState.idle.baseIdlePosition = iacPosition;
 			engine->engineState.idle.idleState = BLIP;
-		} else if (!isRunning) {
-			// during cranking it's always manual mode, PID would make no sense during cranking
+		} else if (phase == IDLE_PHASE_CRANKING) {
 			iacPosition = cltCorrection * engineConfiguration->crankingIACposition;
 			// save cranking position & cycles counter for taper transition
 			lastCrankingIacPosition = iacPosition;
 			lastCrankingCyclesCounter = engine->rpmCalculator.getRevolutionCounterSinceStart();
 			engine->engineState.idle.baseIdlePosition = iacPosition;
 		} else {
-			if (engineConfiguration->idleMode == IM_MANUAL) {
+			if (phase == IDLE_PHASE_MANUAL) {
 				// let's re-apply CLT correction
 				iacPosition = manualIdleController(cltCorrection PASS_ENGINE_PARAMETER_SUFFIX);
 			} else {
-				iacPosition = automaticIdleController(PASS_ENGINE_PARAMETER_SIGNATURE);
+				iacPosition = automaticIdleController(phase == IDLE_PHASE_OUT_OF_IDLE PASS_ENGINE_PARAMETER_SUFFIX);
 			}
 			
 			// store 'base' iacPosition without adjustments
@@ -594,6 +694,14 @@ void startIdleThread(Logging*sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
 
 	idlePid.initPidClass(&engineConfiguration->idleRpmPid);
 
+#if EFI_PROD_CODE
+	if (hasLearnedValue(LEARNED_IDLE_INTEGRATOR)) {
+		// restore the integrator learned during the previous drive cycle instead
+		// of spending the first minutes of every drive re-learning it
+		idlePid.iTerm = getLearnedValue(LEARNED_IDLE_INTEGRATOR);
+	}
+#endif /* EFI_PROD_CODE */
+
 #if ! EFI_UNIT_TEST
 	// todo: we still have to explicitly init all hardware on start in addition to handling configuration change via
 	// 'applyNewHardwareSettings' todo: maybe unify these two use-cases?
@@ -672,6 +780,7 @@ void startIdleThread(Logging*sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	}
 
 	addConsoleAction("idleinfo", showIdleInfo);
+	addConsoleAction("idletrace", printIdleTrace);
 
 	addConsoleActionII("blipidle", blipIdle);
 
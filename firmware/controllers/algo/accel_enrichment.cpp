@@ -41,16 +41,63 @@ static Logging *logger = nullptr;
 
 void WallFuel::resetWF() {
 	wallFuel = 0;
+#if EFI_WALL_FUEL_FIXED_POINT
+	filmMassFp = 0;
+#endif /* EFI_WALL_FUEL_FIXED_POINT */
+}
+
+void refreshWallFuelCoefficients(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	WallFuelCoefficients &coefficients = ENGINE(wallFuelCoefficients);
+	coefficients.active = false;
+	// disable this correction for cranking
+	if (ENGINE(rpmCalculator).isCranking(PASS_ENGINE_PARAMETER_SIGNATURE)) {
+		return;
+	}
+	// if tau is really small, we get div/0.
+	// you probably meant to disable wwae.
+	DISPLAY_STATE(wall_fuel)
+	float tau = CONFIG(DISPLAY_CONFIG(wwaeTau));
+	if (tau < 0.01f) {
+		return;
+	}
+	// Ignore really slow RPM
+	int rpm = GET_RPM();
+	if (rpm < 100) {
+		return;
+	}
+
+	float alpha = expf_taylor(-120 / (rpm * tau));
+	float beta = CONFIG(DISPLAY_CONFIG(wwaeBeta));
+
+	// If beta is larger than alpha, the system is underdamped.
+	// For reasonable values {tau, beta}, this should only be possible
+	// at extremely low engine speeds (<300rpm ish)
+	// Clamp beta to less than alpha.
+	if (beta > alpha) {
+		beta = alpha;
+	}
+	coefficients.alpha = alpha;
+	coefficients.beta = beta;
+	coefficients.oneMinusAlpha = 1 - alpha;
+	// beta is clamped to alpha < 1 above so this division is safe
+	coefficients.invOneMinusBeta = 1 / (1 - beta);
+#if EFI_WALL_FUEL_FIXED_POINT
+	coefficients.alphaFp = (int32_t)(alpha * WALL_FUEL_FP_ONE);
+	coefficients.betaFp = (int32_t)(beta * WALL_FUEL_FP_ONE);
+	coefficients.oneMinusAlphaFp = (int32_t)(coefficients.oneMinusAlpha * WALL_FUEL_FP_ONE);
+	coefficients.invOneMinusBetaFp = (int32_t)(coefficients.invOneMinusBeta * WALL_FUEL_FP_ONE);
+#endif /* EFI_WALL_FUEL_FIXED_POINT */
+	coefficients.active = true;
 }
 
-//
 floatms_t WallFuel::adjust(floatms_t desiredFuel DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	invocationCounter++;
 	if (cisnan(desiredFuel)) {
 		return desiredFuel;
 	}
-	// disable this correction for cranking
-	if (ENGINE(rpmCalculator).isCranking(PASS_ENGINE_PARAMETER_SIGNATURE)) {
+	DISPLAY_STATE(wall_fuel)
+	const WallFuelCoefficients &coefficients = ENGINE(wallFuelCoefficients);
+	if (!coefficients.active) {
 		return desiredFuel;
 	}
 
@@ -88,36 +135,38 @@ floatms_t WallFuel::adjust(floatms_t desiredFuel DECLARE_ENGINE_PARAMETER_SUFFIX
 
 		BETA: decreases with increasing temperature.
 		     decreases with decreasing manifold pressure.
-	*/
 
-	// if tau is really small, we get div/0.
-	// you probably meant to disable wwae.
-	DISPLAY_STATE(wall_fuel)
-	float tau = CONFIG(DISPLAY_CONFIG(wwaeTau));
-	if (tau < 0.01f) {
-		return desiredFuel;
-	}
+		tau, beta and the derived alpha are shared across cylinders and cached by
+		refreshWallFuelCoefficients() once per fast callback.
+	*/
+#if EFI_WALL_FUEL_FIXED_POINT
+	// Q16.16 integer path: two MACs and two shifts, no FPU involvement
+	int32_t desiredFp = (int32_t)(desiredFuel * WALL_FUEL_FP_ONE);
+	int32_t filmFp = filmMassFp;
+	int32_t mCmdFp = (int32_t)((((int64_t)desiredFp
+			- (((int64_t)coefficients.oneMinusAlphaFp * filmFp) >> WALL_FUEL_FP_BITS))
+			* coefficients.invOneMinusBetaFp) >> WALL_FUEL_FP_BITS);
 
-	// Ignore really slow RPM
-	int rpm = GET_RPM();
-	if (rpm < 100) {
-		return desiredFuel;
+	// We can't inject a negative amount of fuel
+	// If this goes below zero we will be over-fueling slightly,
+	// but that's ok.
+	if (mCmdFp <= 0) {
+		mCmdFp = 0;
 	}
 
-	float alpha = expf_taylor(-120 / (rpm * tau));
-	float beta = CONFIG(DISPLAY_CONFIG(wwaeBeta));
+	// remainder on walls from last time + new from this time
+	filmMassFp = (int32_t)((((int64_t)coefficients.alphaFp * filmFp)
+			+ ((int64_t)coefficients.betaFp * mCmdFp)) >> WALL_FUEL_FP_BITS);
 
-	// If beta is larger than alpha, the system is underdamped.
-	// For reasonable values {tau, beta}, this should only be possible
-	// at extremely low engine speeds (<300rpm ish)
-	// Clamp beta to less than alpha.
-	if (beta > alpha) {
-		beta = alpha;
-	}
+	float fuelFilmMassNext = filmMassFp * (1.0f / WALL_FUEL_FP_ONE);
+	float M_cmd = mCmdFp * (1.0f / WALL_FUEL_FP_ONE);
+#else /* EFI_WALL_FUEL_FIXED_POINT */
+	float alpha = coefficients.alpha;
+	float beta = coefficients.beta;
 
 	float fuelFilmMass = wallFuel;
-	float M_cmd = (desiredFuel - (1 - alpha) * fuelFilmMass) / (1 - beta);
-	
+	float M_cmd = (desiredFuel - coefficients.oneMinusAlpha * fuelFilmMass) * coefficients.invOneMinusBeta;
+
 	// We can't inject a negative amount of fuel
 	// If this goes below zero we will be over-fueling slightly,
 	// but that's ok.
@@ -127,6 +176,7 @@ floatms_t WallFuel::adjust(floatms_t desiredFuel DECLARE_ENGINE_PARAMETER_SUFFIX
 
 	// remainder on walls from last time + new from this time
 	float fuelFilmMassNext = alpha * fuelFilmMass + beta * M_cmd;
+#endif /* EFI_WALL_FUEL_FIXED_POINT */
 
 	DISPLAY_TEXT(Current_Wall_Fuel_Film);
 	DISPLAY_FIELD(wallFuel) = fuelFilmMassNext;
@@ -173,12 +223,17 @@ float AccelEnrichment::getMaxDelta(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 floatms_t TpsAccelEnrichment::getTpsEnrichment(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	ScopePerf perf(PE::GetTpsEnrichment);
 
-	int maxDeltaIndex = getMaxDeltaIndex(PASS_ENGINE_PARAMETER_SIGNATURE);
-
-//	FuelSchedule *fs = engineConfiguration->injectionEvents;
-	percent_t tpsTo = cb.get(maxDeltaIndex);
-	percent_t tpsFrom = cb.get(maxDeltaIndex - 1);
-	percent_t deltaTps = tpsTo - tpsFrom;
+	percent_t deltaTps;
+	percent_t tpsTo;
+	if (tpsDeltaWindow.isEmpty()) {
+		// fewer than two samples so far, no rate of change to speak of
+		deltaTps = 0;
+		tpsTo = 0;
+	} else {
+		deltaTps = tpsDeltaWindow.getMax();
+		tpsTo = tpsDeltaWindow.getMaxTag();
+	}
+	percent_t tpsFrom = tpsTo - deltaTps;
 
 	float valueFromTable = tpsTpsMap.getValue(tpsFrom, tpsTo);
 
@@ -266,6 +321,8 @@ void AccelEnrichment::resetAE() {
 
 void TpsAccelEnrichment::resetAE() {
 	AccelEnrichment::resetAE();
+	tpsDeltaWindow.clear();
+	previousValue = NAN;
 	resetFractionValues();
 }
 
@@ -285,6 +342,22 @@ void AccelEnrichment::onNewValue(float currentValue DECLARE_ENGINE_PARAMETER_SUF
 	cb.add(currentValue);
 }
 
+void TpsAccelEnrichment::setLength(int length) {
+	AccelEnrichment::setLength(length);
+	// N samples give N - 1 deltas
+	tpsDeltaWindow.setWindow(length - 1);
+	previousValue = NAN;
+}
+
+void TpsAccelEnrichment::onNewValue(float currentValue DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// the cyclic buffer is still fed: getMaxDelta() and the console diagnostics read it
+	AccelEnrichment::onNewValue(currentValue PASS_ENGINE_PARAMETER_SUFFIX);
+	if (!cisnan(previousValue)) {
+		tpsDeltaWindow.add(currentValue - previousValue, currentValue);
+	}
+	previousValue = currentValue;
+}
+
 void TpsAccelEnrichment::onEngineCycleTps(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	// we update values in handleFuel() directly
 	//onNewValue(getTPS(PASS_ENGINE_PARAMETER_SIGNATURE) PASS_ENGINE_PARAMETER_SUFFIX);
@@ -325,6 +398,12 @@ AccelEnrichment::AccelEnrichment() {
 	cb.setSize(4);
 }
 
+TpsAccelEnrichment::TpsAccelEnrichment() {
+	previousValue = NAN;
+	// matching the default sample buffer size set just above, see AccelEnrichment()
+	tpsDeltaWindow.setWindow(3);
+}
+
 #if ! EFI_UNIT_TEST
 
 static void accelInfo() {
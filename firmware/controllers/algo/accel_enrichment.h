@@ -11,6 +11,7 @@
 
 #include "global.h"
 #include "cyclic_buffer.h"
+#include "monotonic_deque.h"
 #include "table_helper.h"
 #include "wall_fuel_generated.h"
 
@@ -43,14 +44,27 @@ public:
 
 class TpsAccelEnrichment : public AccelEnrichment {
 public:
+	TpsAccelEnrichment();
 	/**
 	 * @return Extra fuel squirt duration for TPS acceleration
 	 */
 	floatms_t getTpsEnrichment(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 	void onEngineCycleTps(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+	void onNewValue(float currentValue DECLARE_ENGINE_PARAMETER_SUFFIX);
+	void setLength(int length);
 	void resetFractionValues();
 	void resetAE();
 private:
+	/**
+	 * O(1) sliding-window maximum over per-sample TPS deltas, so that getTpsEnrichment()
+	 * does not rescan the history buffer on every injection event. The tag keeps the 'to'
+	 * position of the winning delta, which recovers both tpsTpsAccelTable axes.
+	 */
+	monotonic_deque<float, float> tpsDeltaWindow;
+	/**
+	 * NAN until the first sample arrives, deltas need two points
+	 */
+	float previousValue;
 	/**
 	 * Used for Fractional TPS enrichment. 
 	 */
@@ -61,6 +75,18 @@ private:
 	int cycleCnt;
 };
 
+/**
+ * Optional fixed-point film mass accumulation, see WallFuel::adjust(): on cores
+ * without an FPU (Kinetis) the Q16.16 integer path keeps the per-injection cost to a
+ * couple of integer MACs. Cortex-M4F boards are better off with the float path.
+ */
+#ifndef EFI_WALL_FUEL_FIXED_POINT
+#define EFI_WALL_FUEL_FIXED_POINT FALSE
+#endif
+
+#define WALL_FUEL_FP_BITS 16
+#define WALL_FUEL_FP_ONE (1 << WALL_FUEL_FP_BITS)
+
 /**
  * Wall wetting, also known as fuel film
  * See https://github.com/rusefi/rusefi/issues/151 for the theory
@@ -75,8 +101,47 @@ public:
 	floatms_t getWallFuel() const;
 	void resetWF();
 	int invocationCounter = 0;
+#if EFI_WALL_FUEL_FIXED_POINT
+	/**
+	 * film mass in Q16.16 milliseconds, the float wallFuel field is kept in sync
+	 * for logging and TunerStudio display
+	 */
+	int32_t filmMassFp = 0;
+#endif /* EFI_WALL_FUEL_FIXED_POINT */
 };
 
+/**
+ * Cross-cylinder stage of the wall wetting model: the cranking gate, tau/beta config
+ * reads and the expf_taylor() evaporation term are identical for every cylinder yet
+ * used to be recomputed by each injection event. This stage runs once per fast
+ * callback, see EngineState::periodicFastCallback(), and WallFuel::adjust() consumes
+ * the cached coefficients with a couple of multiply-adds per cylinder.
+ */
+class WallFuelCoefficients {
+public:
+	/**
+	 * false while cranking, at really low RPM or with wall wetting disabled -
+	 * adjust() passes fuel through unchanged
+	 */
+	bool active = false;
+	float alpha = 0;
+	float beta = 0;
+	/**
+	 * derived values so that adjust() is division-free: the division by (1 - beta)
+	 * happens here, once per refresh, not once per injection
+	 */
+	float oneMinusAlpha = 0;
+	float invOneMinusBeta = 0;
+#if EFI_WALL_FUEL_FIXED_POINT
+	int32_t alphaFp = 0;
+	int32_t betaFp = 0;
+	int32_t oneMinusAlphaFp = 0;
+	int32_t invOneMinusBetaFp = 0;
+#endif /* EFI_WALL_FUEL_FIXED_POINT */
+};
+
+void refreshWallFuelCoefficients(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+
 void initAccelEnrichment(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX);
 
 void setEngineLoadAccelLen(int len);
@@ -99,7 +99,8 @@ static angle_t getRunningAdvance(int rpm, float engineLoad DECLARE_ENGINE_PARAME
 		float tps = getTPS(PASS_ENGINE_PARAMETER_SIGNATURE);
 		advanceAngle = advanceTpsMap.getValue((float) rpm, tps);
 	} else {
-		advanceAngle = advanceMap.getValue((float) rpm, engineLoad);
+		// NaN engine load is rejected above, see getValueFast contract
+		advanceAngle = advanceMap.getValueFast((float) rpm, engineLoad);
 	}
 	
 	// get advance from the separate table for Idle
@@ -114,6 +115,10 @@ static angle_t getRunningAdvance(int rpm, float engineLoad DECLARE_ENGINE_PARAME
 	return advanceAngle;
 }
 
+void validateTimingTableAxes() {
+	advanceMap.validateAxes();
+}
+
 angle_t getAdvanceCorrections(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	float iatCorrection;
 	if (!hasIatSensor()) {
@@ -541,8 +541,14 @@ const char *getDebug_mode_e(debug_mode_e value){
 switch(value) {
 case DBG_BOOST:
   return "DBG_BOOST";
-case DBG_37:
-  return "DBG_37";
+case DBG_ISR_BUDGET:
+  return "DBG_ISR_BUDGET";
+case DBG_SENSOR_FRESHNESS:
+  return "DBG_SENSOR_FRESHNESS";
+case DBG_SHADOW_TUNE:
+  return "DBG_SHADOW_TUNE";
+case DBG_CALIBRATION:
+  return "DBG_CALIBRATION";
 case DBG_ALTERNATOR_PID:
   return "DBG_ALTERNATOR_PID";
 case DBG_ANALOG_INPUTS:
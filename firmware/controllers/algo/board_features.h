@@ -0,0 +1,53 @@
+/**
+ * @file	board_features.h
+ * @brief	constexpr hardware-capability constants derived from board manifests
+ *
+ * efifeatures.h flags decide which code is compiled; these constants describe what
+ * the board can physically have. A feature is often compiled in for the generic
+ * image yet runtime-gated by a CONFIG flag the specific board can never satisfy -
+ * e.g. HIP9011 handling on a board without the chip. A board narrows a constant in
+ * its board.mk via DDEFS (see config/boards/microrusefi/board.mk) and every
+ * runtime 'is feature enabled' branch guarded by it folds to constant false, so
+ * the optimizer drops the branch from hot paths and the linker garbage-collects
+ * the feature body from flash.
+ *
+ * Defaults follow the compile flags, so boards without a manifest entry behave
+ * exactly as before.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "efifeatures.h"
+
+#ifndef BOARD_HAS_HIP9011
+#ifdef EFI_HIP_9011
+#define BOARD_HAS_HIP9011 EFI_HIP_9011
+#else
+#define BOARD_HAS_HIP9011 FALSE
+#endif
+#endif
+
+#ifndef BOARD_HAS_CJ125
+#ifdef EFI_CJ125
+#define BOARD_HAS_CJ125 EFI_CJ125
+#else
+#define BOARD_HAS_CJ125 FALSE
+#endif
+#endif
+
+#ifndef BOARD_HAS_HD44780_LCD
+#ifdef EFI_HD44780_LCD
+#define BOARD_HAS_HD44780_LCD EFI_HD44780_LCD
+#else
+#define BOARD_HAS_HD44780_LCD FALSE
+#endif
+#endif
+
+namespace board {
+constexpr bool hasHip9011 = BOARD_HAS_HIP9011;
+constexpr bool hasCj125 = BOARD_HAS_CJ125;
+constexpr bool hasHd44780Lcd = BOARD_HAS_HD44780_LCD;
+}
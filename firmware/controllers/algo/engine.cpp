@@ -22,6 +22,7 @@
 #include "os_util.h"
 #include "settings.h"
 #include "aux_valves.h"
+#include "sensor_calibration.h"
 #include "map_averaging.h"
 #include "fsio_impl.h"
 #include "perf_trace.h"
@@ -68,16 +69,25 @@ void Engine::resetEngineSnifferIfInTestMode() {
 #endif /* EFI_ENGINE_SNIFFER */
 }
 
+/**
+ * trigger shape rebuild happens on this staging bank so that the live shape stays fully usable
+ * by the decode ISR until the quick bank copy below. Rebuilds are serialized by the slow
+ * configuration-apply path so a single shared staging instance is enough.
+ */
+static TriggerWaveform shapeStagingBank;
+
 void Engine::initializeTriggerWaveform(Logging *logger DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #if EFI_ENGINE_CONTROL && EFI_SHAFT_POSITION_INPUT
-	// we have a confusing threading model so some synchronization would not hurt
-	bool alreadyLocked = lockAnyContext();
-
-	TRIGGER_WAVEFORM(initializeTriggerWaveform(logger,
+	/**
+	 * The expensive rebuild including sync point simulation runs with interrupts enabled,
+	 * real trigger events keep decoding against the live shape meanwhile.
+	 * See #192 for what happens when hardware events race a shape rebuild.
+	 */
+	shapeStagingBank.initializeTriggerWaveform(logger,
 			engineConfiguration->ambiguousOperationMode,
-			engineConfiguration->useOnlyRisingEdgeForTrigger, &engineConfiguration->trigger));
+			engineConfiguration->useOnlyRisingEdgeForTrigger, &engineConfiguration->trigger);
 
-	if (TRIGGER_WAVEFORM(bothFrontsRequired) && engineConfiguration->useOnlyRisingEdgeForTrigger) {
+	if (shapeStagingBank.bothFrontsRequired && engineConfiguration->useOnlyRisingEdgeForTrigger) {
 #if EFI_PROD_CODE || EFI_SIMULATOR
 		firmwareError(CUSTOM_ERR_BOTH_FRONTS_REQUIRED, "Inconsistent trigger setup");
 #else
@@ -85,22 +95,31 @@ void Engine::initializeTriggerWaveform(Logging *logger DECLARE_ENGINE_PARAMETER_
 #endif
 	}
 
+	// calculateTriggerSynchPoint() updates engineCycleEventCount early, keep the live value
+	// until the new shape is actually swapped in
+	int liveEngineCycleEventCount = engine->engineCycleEventCount;
 
-	if (!TRIGGER_WAVEFORM(shapeDefinitionError)) {
+	if (!shapeStagingBank.shapeDefinitionError) {
 		/**
-	 	 * this instance is used only to initialize 'this' TriggerWaveform instance
-	 	 * #192 BUG real hardware trigger events could be coming even while we are initializing trigger
+	 	 * this instance is used only to initialize the staging TriggerWaveform instance
 	 	 */
 		initState.resetTriggerState();
-		calculateTriggerSynchPoint(&ENGINE(triggerCentral.triggerShape),
+		calculateTriggerSynchPoint(&shapeStagingBank,
 				&initState PASS_ENGINE_PARAMETER_SUFFIX);
 
-		if (engine->triggerCentral.triggerShape.getSize() == 0) {
+		if (shapeStagingBank.getSize() == 0) {
 			firmwareError(CUSTOM_ERR_TRIGGER_ZERO, "triggerShape size is zero");
 		}
-		engine->engineCycleEventCount = TRIGGER_WAVEFORM(getLength());
 	}
+	int stagingEngineCycleEventCount = engine->engineCycleEventCount;
+	engine->engineCycleEventCount = liveEngineCycleEventCount;
 
+	// quick bank copy - this is the only part the decode ISR ever has to wait for
+	bool alreadyLocked = lockAnyContext();
+	ENGINE(triggerCentral.triggerShape).copyShapeFrom(shapeStagingBank);
+	if (!shapeStagingBank.shapeDefinitionError) {
+		engine->engineCycleEventCount = stagingEngineCycleEventCount;
+	}
 	if (!alreadyLocked) {
 		unlockAnyContext();
 	}
@@ -143,6 +162,17 @@ void Engine::periodicSlowCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 
 	cylinderCleanupControl(PASS_ENGINE_PARAMETER_SIGNATURE);
 
+#if EFI_SENSOR_CALIBRATION
+	updateSensorCalibration(PASS_ENGINE_PARAMETER_SIGNATURE);
+#endif /* EFI_SENSOR_CALIBRATION */
+
+	/**
+	 * Once-per-cycle table axis sanity stage: while axes are known-good the hot fuel and
+	 * timing lookups take the unchecked Map3D::getValueFast() path.
+	 */
+	validateFuelTableAxes();
+	validateTimingTableAxes();
+
 #if (BOARD_TLE8888_COUNT > 0)
 	if (CONFIG(useTLE8888_cranking_hack) && ENGINE(rpmCalculator).isCranking(PASS_ENGINE_PARAMETER_SIGNATURE)) {
 		efitick_t nowNt = getTimeNowNt();
@@ -241,6 +271,91 @@ void Engine::preCalculate(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 #else
 	adcToVoltageInputDividerCoefficient = engineConfigurationPtr->analogInputDividerCoefficient;
 #endif
+
+	validateConfiguration(PASS_ENGINE_PARAMETER_SIGNATURE);
+	refreshHotConfig(PASS_ENGINE_PARAMETER_SIGNATURE);
+}
+
+void Engine::refreshHotConfig(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	hotConfig.cylindersCount = validatedConfig.cylindersCount;
+	hotConfig.rpmHardLimit = engineConfiguration->rpmHardLimit;
+	hotConfig.crankingRpm = engineConfiguration->cranking.rpm;
+	hotConfig.ignMathCalculateAtIndex = engineConfiguration->ignMathCalculateAtIndex;
+	hotConfig.boostCutPressure = engineConfiguration->boostCutPressure;
+	hotConfig.injectionMode = engineConfiguration->injectionMode;
+	hotConfig.crankingInjectionMode = engineConfiguration->crankingInjectionMode;
+	hotConfig.isCylinderCleanupEnabled = engineConfiguration->isCylinderCleanupEnabled;
+	// any firing order misconfiguration warns here, once, instead of on every event
+	for (int i = 0; i < INJECTION_PIN_COUNT; i++) {
+		int cylinderId = i < hotConfig.cylindersCount ? getCylinderId(i PASS_ENGINE_PARAMETER_SUFFIX) : 1;
+		hotConfig.cylinderIndexByFiringIndex[i] = (uint8_t)ID2INDEX(cylinderId);
+	}
+}
+
+#if EFI_ENGINE_CONTROL
+
+FuelSchedule * Engine::getRetiredFuelSchedule(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	FuelSchedule *shadow = injectionEvents == &injectionEventBuffers[0] ? &injectionEventBuffers[1] : &injectionEventBuffers[0];
+	if (rpmCalculator.isStopped(PASS_ENGINE_PARAMETER_SIGNATURE)) {
+		// without trigger events nothing from this buffer can still be in flight
+		return shadow;
+	}
+	// in-flight scheduling entries retire within one engine cycle, two revolutions
+	// covers both one and two revolution cycles
+	uint32_t revolution = (uint32_t)rpmCalculator.getRevolutionCounterM();
+	if (revolution < shadow->replacedAtRevolution + 2) {
+		return nullptr;
+	}
+	return shadow;
+}
+
+void Engine::rebuildFuelSchedule(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	FuelSchedule *shadow = getRetiredFuelSchedule(PASS_ENGINE_PARAMETER_SIGNATURE);
+	if (shadow == nullptr) {
+		// grace period still running: keep serving the published schedule and let
+		// the trigger path retry on the next tooth
+		injectionEvents->isReady = false;
+		return;
+	}
+	shadow->addFuelEvents(PASS_ENGINE_PARAMETER_SIGNATURE);
+	if (!shadow->isReady) {
+		// no RPM yet or an event failed to resolve - keep the published buffer
+		return;
+	}
+	FuelSchedule *previous = injectionEvents;
+	// publication is this single pointer store
+	injectionEvents = shadow;
+	previous->replacedAtRevolution = (uint32_t)rpmCalculator.getRevolutionCounterM();
+}
+
+#endif /* EFI_ENGINE_CONTROL */
+
+void Engine::validateConfiguration(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	validatedConfig.fixupCounter = 0;
+
+	int cylindersCount = engineConfiguration->specs.cylindersCount;
+	if (cylindersCount < 1 || cylindersCount > INJECTION_PIN_COUNT) {
+		warning(CUSTOM_OBD_ZERO_CYLINDER_COUNT, "invalid cylindersCount %d", cylindersCount);
+		cylindersCount = maxI(1, minI(cylindersCount, INJECTION_PIN_COUNT));
+		validatedConfig.fixupCounter++;
+	}
+	validatedConfig.cylindersCount = cylindersCount;
+
+	float displacement = engineConfiguration->specs.displacement;
+	if (cisnan(displacement) || displacement <= 0) {
+		warning(CUSTOM_OBD_INVALID_DISPLACEMENT, "invalid displacement %.2f", displacement);
+		displacement = 1;
+		validatedConfig.fixupCounter++;
+	}
+	validatedConfig.displacement = displacement;
+
+	float injectorFlow = engineConfiguration->injector.flow;
+	if (cisnan(injectorFlow) || injectorFlow <= 0) {
+		warning(CUSTOM_OBD_INVALID_INJECTOR_FLOW, "invalid injector flow %.2f", injectorFlow);
+		injectorFlow = 1;
+		validatedConfig.fixupCounter++;
+	}
+	validatedConfig.injectorFlow = injectorFlow;
 }
 
 void Engine::OnTriggerStateDecodingError() {
@@ -453,7 +568,7 @@ bool Engine::isInShutdownMode() const {
 }
 
 injection_mode_e Engine::getCurrentInjectionMode(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
-	return rpmCalculator.isCranking(PASS_ENGINE_PARAMETER_SIGNATURE) ? CONFIG(crankingInjectionMode) : CONFIG(injectionMode);
+	return rpmCalculator.isCranking(PASS_ENGINE_PARAMETER_SIGNATURE) ? hotConfig.crankingInjectionMode : hotConfig.injectionMode;
 }
 
 // see also in TunerStudio project '[doesTriggerImplyOperationMode] tag
@@ -478,6 +593,12 @@ operation_mode_e Engine::getOperationMode(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
  * The idea of this method is to execute all heavy calculations in a lower-priority thread,
  * so that trigger event handler/IO scheduler tasks are faster.
  */
+/**
+ * maximum age of cached fast calculation outputs - time based corrections like the
+ * post-cranking taper still have to make progress even at perfectly steady cruise
+ */
+#define FAST_CALC_CACHE_MAX_AGE_MS 100
+
 void Engine::periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	ScopePerf pc(PE::EnginePeriodicFastCallback);
 
@@ -485,10 +606,40 @@ void Engine::periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	refreshMapAveragingPreCalc(PASS_ENGINE_PARAMETER_SIGNATURE);
 #endif
 
+	int rpm = GET_RPM();
+
+#if EFI_FAST_CALLBACK_CACHE
+	/**
+	 * At steady cruise both RPM and load sit in the same table cell for seconds at a time
+	 * and the whole interpolation chain keeps producing identical outputs. Skip the
+	 * recalculation while we are in the same cell, nothing in the configuration has changed
+	 * and the cached outputs are not too old.
+	 */
+	efitick_t nowNt = getTimeNowNt();
+	bool configChanged = fastCalcConfigVersion.isOld(getGlobalConfigurationVersion());
+	int rpmBin = findIndex(config->fuelRpmBins, FUEL_RPM_COUNT, rpm);
+	int loadBin = findIndex(config->fuelLoadBins, FUEL_LOAD_COUNT, getEngineLoadT(PASS_ENGINE_PARAMETER_SIGNATURE));
+	bool sameCell = rpmBin == fastCalcRpmBin && loadBin == fastCalcLoadBin;
+
+	if (!configChanged && sameCell
+			&& !ENGINE(rpmCalculator).isCranking(PASS_ENGINE_PARAMETER_SIGNATURE)
+			&& nowNt - fastCalcLastTimeNt < MS2NT(FAST_CALC_CACHE_MAX_AGE_MS)) {
+		/**
+		 * RPM usually keeps drifting inside the cell: the angle/time table lookups are
+		 * still valid but the angle-per-millisecond scale is not, so refresh just the
+		 * time-domain conversions from the cached lookups
+		 */
+		engineState.updateTimeDomainConversions(rpm PASS_ENGINE_PARAMETER_SUFFIX);
+		return;
+	}
+	fastCalcRpmBin = rpmBin;
+	fastCalcLoadBin = loadBin;
+	fastCalcLastTimeNt = nowNt;
+#endif /* EFI_FAST_CALLBACK_CACHE */
+
 	engineState.periodicFastCallback(PASS_ENGINE_PARAMETER_SIGNATURE);
 
 	engine->m.beforeFuelCalc = getTimeNowLowerNt();
-	int rpm = GET_RPM();
 
 	ENGINE(injectionDuration) = getInjectionDuration(rpm PASS_ENGINE_PARAMETER_SUFFIX);
 	engine->m.fuelCalcTime = getTimeNowLowerNt() - engine->m.beforeFuelCalc;
@@ -509,6 +660,10 @@ schfunc_t action_s::getCallback() const {
 	return callback;
 }
 
+schedule_priority_e action_s::getPriority() const {
+	return priority;
+}
+
 void * action_s::getArgument() const {
 	return param;
 }
@@ -12,7 +12,6 @@
 #include "rpm_calculator.h"
 #include "event_registry.h"
 #include "table_helper.h"
-#include "listener_array.h"
 #include "accel_enrichment.h"
 #include "trigger_central.h"
 #include "local_version_holder.h"
@@ -49,6 +48,69 @@ class RpmCalculator;
 
 class IEtbController;
 
+/**
+ * Trusted, denormalized view of the raw configuration, see Engine::validateConfiguration().
+ *
+ * Raw engineConfiguration arrives from flash or the tuning software and may hold anything,
+ * which is why hot paths historically armor themselves with per-call range checks. These
+ * fields are normalized exactly once per configuration change so that per-event code can
+ * read them without re-checking.
+ */
+class ValidatedConfig {
+public:
+	/**
+	 * specs.cylindersCount clamped into [1..INJECTION_PIN_COUNT], event schedule loops
+	 * index pin arrays with this
+	 */
+	int cylindersCount = 1;
+	/**
+	 * specs.displacement forced positive, airmass math divides by it
+	 */
+	float displacement = 1;
+	/**
+	 * injector.flow forced positive, fuel math divides by it
+	 */
+	float injectorFlow = 1;
+	/**
+	 * how many raw fields were out of range and got fixed up during the last pass,
+	 * each fixup also produces its own warning()
+	 */
+	int fixupCounter = 0;
+};
+
+/**
+ * Cache-friendly mirror of the most frequently read configuration fields.
+ *
+ * persistent_config_s field order follows the .ini generator, not access patterns, so
+ * the handful of fields the per-event path reads are scattered across a multi-KB
+ * struct - on a 16KB D-cache that is a config-field miss in every profile. This mirror
+ * packs them into two cache lines next to each other. Refreshed together with
+ * validatedConfig on every configuration change, see Engine::refreshHotConfig().
+ *
+ * Keep this read-mostly and under two cache lines: anything written per event or read
+ * once per second does not belong here.
+ */
+struct hot_config_mirror_s {
+	// from validatedConfig, so already clamped
+	int cylindersCount;
+	int rpmHardLimit;
+	int crankingRpm;
+	int ignMathCalculateAtIndex;
+	float boostCutPressure;
+	injection_mode_e injectionMode;
+	injection_mode_e crankingInjectionMode;
+	bool isCylinderCleanupEnabled;
+	/**
+	 * firing-order dispatch table: i-th position in the firing order to zero-based
+	 * cylinder index. The getCylinderId() switch runs once per config apply to fill
+	 * this, per-event consumers do a single indexed load.
+	 */
+	uint8_t cylinderIndexByFiringIndex[INJECTION_PIN_COUNT];
+} __attribute__((aligned(32)));
+
+// two 32-byte cache lines, see hot_config_mirror_s doc
+static_assert(sizeof(hot_config_mirror_s) <= 64, "hot config mirror grew past two cache lines");
+
 class Engine : public TriggerStateListener {
 public:
 	explicit Engine(persistent_config_s *config);
@@ -56,7 +118,10 @@ public:
 
 	IEtbController *etbControllers[ETB_COUNT];
 
-	cyclic_buffer<int> triggerErrorDetection;
+	/**
+	 * last 6 decoding outcomes, isTriggerDecoderError() reads the running sum from the trigger ISR path
+	 */
+	running_cyclic_buffer<int, 8> triggerErrorDetection = running_cyclic_buffer<int, 8>(6);
 
 	void OnTriggerStateDecodingError();
 	void OnTriggerStateProperState(efitick_t nowNt) override;
@@ -69,6 +134,16 @@ public:
 
 	LocalVersionHolder versionForConfigurationListeners;
 	LocalVersionHolder auxParametersVersion;
+
+	/**
+	 * Steady state cache for periodicFastCallback(): while RPM and load stay within the
+	 * same fuel table cell and configuration has not changed there is no reason to re-run
+	 * the whole interpolation chain on every invocation. See EFI_FAST_CALLBACK_CACHE.
+	 */
+	LocalVersionHolder fastCalcConfigVersion;
+	int fastCalcRpmBin = -1;
+	int fastCalcLoadBin = -1;
+	efitick_t fastCalcLastTimeNt = 0;
 	operation_mode_e getOperationMode(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 
 	AuxActor auxValves[AUX_DIGITAL_VALVE_COUNT][2];
@@ -120,11 +195,31 @@ public:
 #endif
 
 #if EFI_ENGINE_CONTROL
-	FuelSchedule injectionEvents;
+	/**
+	 * RCU-style double buffered fuel schedule: readers grab the published pointer once
+	 * and use that buffer for the whole tooth, builders fill the retired buffer and
+	 * publish it by single pointer store in rebuildFuelSchedule(). A replaced buffer is
+	 * not reused until its in-flight scheduling entries have had an engine cycle to
+	 * retire, so a rebuild can never corrupt an event the executor still owns.
+	 */
+	FuelSchedule injectionEventBuffers[2];
+	FuelSchedule * volatile injectionEvents = &injectionEventBuffers[0];
 	IgnitionEventList ignitionEvents;
+
+	/**
+	 * build a fresh schedule into the retired buffer and publish it; while the retired
+	 * buffer is still in its grace period the published schedule is only marked stale
+	 * and the next trigger tooth retries
+	 */
+	void rebuildFuelSchedule(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+	FuelSchedule *getRetiredFuelSchedule(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 #endif /* EFI_ENGINE_CONTROL */
 
 	WallFuel wallFuel[INJECTION_PIN_COUNT];
+	/**
+	 * cross-cylinder wall wetting coefficients, see refreshWallFuelCoefficients()
+	 */
+	WallFuelCoefficients wallFuelCoefficients;
 	bool needToStopEngine(efitick_t nowNt) const;
 	bool etbAutoTune = false;
 	/**
@@ -145,6 +240,8 @@ public:
 	 * based on current RPM and isAlternatorControlEnabled setting
 	 */
 	bool isAlternatorControlEnabled = false;
+	// experimental, see enable_dwell_vcomp console command
+	bool isDwellVoltageCompensationArmed = false;
 
 	bool isCltBroken = false;
 	bool slowCallBackWasInvoked = false;
@@ -292,6 +389,21 @@ public:
 
 	void preCalculate(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 
+	/**
+	 * normalization pass over the raw configuration, refreshes validatedConfig.
+	 * Runs via preCalculate() on boot and on every configuration change.
+	 */
+	void validateConfiguration(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+
+	/**
+	 * copies the per-event fields out of the raw configuration, see hot_config_mirror_s
+	 */
+	void refreshHotConfig(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+
+	ValidatedConfig validatedConfig;
+
+	hot_config_mirror_s hotConfig;
+
 	void watchdog();
 
 	/**
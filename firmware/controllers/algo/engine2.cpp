@@ -15,17 +15,26 @@
 #include "engine_math.h"
 #include "advance_map.h"
 #include "aux_valves.h"
+#include "shadow_tune.h"
+#include "gear_detector.h"
+#include "dfco_sequencer.h"
+#include "switch_inputs.h"
 #include "perf_trace.h"
 
 #if EFI_PROD_CODE
 #include "svnversion.h"
 #endif
 
+#if EFI_VEHICLE_SPEED
+#include "vehicle_speed.h"
+#endif /* EFI_VEHICLE_SPEED */
+
 #if ! EFI_UNIT_TEST
 #include "status_loop.h"
 #endif
 
 extern fuel_Map3D_t veMap;
+static SharedTableCell<FUEL_RPM_COUNT, FUEL_LOAD_COUNT, float> sharedFuelCell;
 extern afr_Map3D_t afrMap;
 
 EXTERN_ENGINE
@@ -157,12 +166,21 @@ void EngineState::periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	updateAuxValves(PASS_ENGINE_PARAMETER_SIGNATURE);
 
 	int rpm = ENGINE(rpmCalculator).getRpm(PASS_ENGINE_PARAMETER_SIGNATURE);
-	sparkDwell = getSparkDwell(rpm PASS_ENGINE_PARAMETER_SUFFIX);
-	dwellAngle = cisnan(rpm) ? NAN :  sparkDwell / getOneDegreeTimeMs(rpm);
+	baseDwell = getSparkDwell(rpm PASS_ENGINE_PARAMETER_SUFFIX);
+	updateTimeDomainConversions(rpm PASS_ENGINE_PARAMETER_SUFFIX);
 	if (hasAfrSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
 		engine->sensors.currentAfr = getAfr(PASS_ENGINE_PARAMETER_SIGNATURE);
 	}
 
+#if EFI_VEHICLE_SPEED
+	// one multiply and one table read, see gear_detector.cpp
+	updateGearDetection(rpm, getVehicleSpeed());
+#endif /* EFI_VEHICLE_SPEED */
+
+#if EFI_SWITCH_INPUTS
+	updateSwitchInputs(getTimeNowUs());
+#endif /* EFI_SWITCH_INPUTS */
+
 	// todo: move this into slow callback, no reason for IAT corr to be here
 	running.intakeTemperatureCoefficient = getIatFuelCorrection(getIntakeAirTemperature() PASS_ENGINE_PARAMETER_SUFFIX);
 	// todo: move this into slow callback, no reason for CLT corr to be here
@@ -171,8 +189,17 @@ void EngineState::periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	// update fuel consumption states
 	fuelConsumption.update(nowNt PASS_ENGINE_PARAMETER_SUFFIX);
 
+	// shared wall wetting coefficients consumed by every cylinder's injection event
+	refreshWallFuelCoefficients(PASS_ENGINE_PARAMETER_SIGNATURE);
+
 	// Fuel cut-off isn't just 0 or 1, it can be tapered
 	fuelCutoffCorrection = getFuelCutOffCorrection(nowNt, rpm PASS_ENGINE_PARAMETER_SUFFIX);
+#if EFI_DFCO_SEQUENCER
+	if (dfcoSequencerTakesOver(fuelCutoffCorrection == 0)) {
+		// the sequencer implements the cut per cylinder, keep the global correction out of it
+		fuelCutoffCorrection = 1;
+	}
+#endif /* EFI_DFCO_SEQUENCER */
 
 	// post-cranking fuel enrichment.
 	// for compatibility reasons, apply only if the factor is greater than zero (0.01 margin used)
@@ -208,8 +235,27 @@ void EngineState::periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 		if (CONFIG(useTPSBasedVeTable)) {
 			// todo: should we have 'veTpsMap' fuel_Map3D_t variable here?
 			currentRawVE = interpolate3d<float, float>(tps, CONFIG(ignitionTpsBins), IGN_TPS_COUNT, rpm, config->veRpmBins, FUEL_RPM_COUNT, veMap.pointers);
-		} else {
+			targetAFR = afrMap.getValue(rpm, map);
+		} else if (cisnan(map)) {
+			// let the regular lookups produce the usual NaN warnings
 			currentRawVE = veMap.getValue(rpm, map);
+			targetAFR = afrMap.getValue(rpm, map);
+		} else {
+			/**
+			 * VE and AFR target are looked up with the same (RPM, load) arguments, so the
+			 * cell and interpolation weights are resolved once and both tables evaluate
+			 * against the shared weights as long as the tune keeps the axes identical.
+			 */
+			sharedFuelCell.resolve(config->veRpmBins, config->veLoadBins, rpm, map);
+			currentRawVE = veMap.getValueAtCell(sharedFuelCell);
+			if (afrMap.axesMatch(sharedFuelCell)) {
+				targetAFR = afrMap.getValueAtCell(sharedFuelCell);
+			} else {
+				targetAFR = afrMap.getValue(rpm, map);
+			}
+#if EFI_SHADOW_TUNE
+			runShadowTune(sharedFuelCell, rpm, engineLoad PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_SHADOW_TUNE */
 		}
 		// get VE from the separate table for Idle
 		if (CONFIG(useSeparateVeForIdle)) {
@@ -218,13 +264,45 @@ void EngineState::periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 			currentRawVE = interpolateClamped(0.0f, idleVe, CONFIG(idlePidDeactivationTpsThreshold), currentRawVE, tps);
 		}
 		currentBaroCorrectedVE = baroCorrection * currentRawVE * PERCENT_DIV;
-		targetAFR = afrMap.getValue(rpm, map);
 	} else {
 		baseTableFuel = getBaseTableFuel(rpm, engineLoad);
 	}
 #endif
 }
 
+/**
+ * Coil charge time scales roughly inversely with supply voltage: the same spark
+ * energy needs longer dwell on a sagging battery. CONFIG(targetVBatt) doubles as
+ * the voltage the dwell table was calibrated at.
+ */
+#define DWELL_VBATT_HYSTERESIS_VOLTS 0.25f
+#define DWELL_VOLTAGE_CORRECTION_MIN 0.6f
+#define DWELL_VOLTAGE_CORRECTION_MAX 1.8f
+
+void EngineState::updateDwellVoltageCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	if (!engine->isDwellVoltageCompensationArmed || !hasVBatt(PASS_ENGINE_PARAMETER_SIGNATURE)) {
+		dwellVoltageCorrection = 1;
+		return;
+	}
+	float vBatt = getVBatt(PASS_ENGINE_PARAMETER_SIGNATURE);
+	if (absF(vBatt - dwellCorrectionVBatt) < DWELL_VBATT_HYSTERESIS_VOLTS) {
+		// still inside the band - keep the batch we have
+		return;
+	}
+	dwellCorrectionVBatt = vBatt;
+	dwellVoltageCorrection = maxF(DWELL_VOLTAGE_CORRECTION_MIN,
+			minF(CONFIG(targetVBatt) / vBatt, DWELL_VOLTAGE_CORRECTION_MAX));
+}
+
+void EngineState::updateTimeDomainConversions(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// battery voltage moves independently of the RPM/load cell so the dwell
+	// correction is refreshed here, on fast-callback cache hits as well
+	updateDwellVoltageCorrection(PASS_ENGINE_PARAMETER_SIGNATURE);
+	sparkDwell = baseDwell * dwellVoltageCorrection;
+	dwellAngle = cisnan(rpm) ? NAN :  sparkDwell / getOneDegreeTimeMs(rpm);
+	sparkDwellUs = (cisnan(sparkDwell) || sparkDwell <= 0) ? 0 : (uint32_t) MS2US(sparkDwell);
+}
+
 void EngineState::updateTChargeK(int rpm, float tps DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #if EFI_ENGINE_CONTROL
 	float newTCharge = getTCharge(rpm, tps, getCoolantTemperature(), getIntakeAirTemperature() PASS_ENGINE_PARAMETER_SUFFIX);
@@ -27,6 +27,7 @@
 #include "allsensors.h"
 #include "interpolation.h"
 #include "engine_math.h"
+#include "fuel_math.h"
 #include "speed_density.h"
 #include "advance_map.h"
 
@@ -164,6 +165,97 @@ void rememberCurrentConfiguration(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 
 extern LoggingWithStorage sharedLogger;
 
+/**
+ * Differential configuration apply: a full apply pass stops and restarts every output
+ * pin which causes a perceptible stumble while the engine is running, so the TunerStudio
+ * write path reports which configuration byte ranges it has touched and a region map
+ * below translates those ranges into the set of subsystems which actually need
+ * a reinitialization pass.
+ *
+ * Any dirty byte which does not fall into one of the known regions makes the whole
+ * apply conservative again, same for writers which do not report ranges at all,
+ * like console 'set' commands.
+ */
+#define DIRTY_SUBSYSTEM_HARDWARE	0x01
+#define DIRTY_SUBSYSTEM_TRIGGER		0x02
+#define DIRTY_SUBSYSTEM_ALTERNATOR	0x04
+#define DIRTY_SUBSYSTEM_BOOST		0x08
+#define DIRTY_SUBSYSTEM_ETB			0x10
+#define DIRTY_SUBSYSTEM_IDLE		0x20
+#define DIRTY_SUBSYSTEM_FSIO		0x40
+#define DIRTY_SUBSYSTEM_ALL			0xffffffff
+
+#if EFI_CONFIG_DIRTY_TRACKING
+
+typedef struct {
+	int start;
+	int end;
+	uint32_t subsystems;
+} config_region_s;
+
+#define CONFIG_REGION(field, subsystems) { (int) offsetof(persistent_config_s, field), \
+	(int) (offsetof(persistent_config_s, field) + sizeof(((persistent_config_s *) 0)->field)), subsystems }
+
+/**
+ * first match wins, so specific regions go before the catch-all table region
+ */
+static const config_region_s configRegionMap[] = {
+		CONFIG_REGION(engineConfiguration.trigger, DIRTY_SUBSYSTEM_TRIGGER),
+		// PID blocks: the matching callback resets the corresponding PID state
+		CONFIG_REGION(engineConfiguration.boostPid, DIRTY_SUBSYSTEM_BOOST),
+		CONFIG_REGION(engineConfiguration.alternatorControl, DIRTY_SUBSYSTEM_ALTERNATOR),
+		CONFIG_REGION(engineConfiguration.etb, DIRTY_SUBSYSTEM_ETB),
+		CONFIG_REGION(engineConfiguration.idleRpmPid, DIRTY_SUBSYSTEM_IDLE),
+		CONFIG_REGION(engineConfiguration.idleRpmPid2, DIRTY_SUBSYSTEM_IDLE),
+		// formulas are recompiled by the FSIO callback
+		CONFIG_REGION(fsioFormulas, DIRTY_SUBSYSTEM_FSIO),
+		CONFIG_REGION(timingMultiplier, DIRTY_SUBSYSTEM_FSIO),
+		CONFIG_REGION(timingAdditive, DIRTY_SUBSYSTEM_FSIO),
+		// everything else beyond engine_configuration_s is tables and bins which are
+		// consumed in-place, those only need the always-on recalculation
+		{ (int) sizeof(engine_configuration_s), (int) sizeof(persistent_config_s), 0 },
+};
+
+static uint32_t dirtySubsystems = 0;
+static bool isDirtyTracked = false;
+
+void markConfigurationDirty(int offset, int count) {
+	isDirtyTracked = true;
+	int position = offset;
+	int end = offset + count;
+	while (position < end) {
+		const config_region_s *region = NULL;
+		for (size_t i = 0; i < sizeof(configRegionMap) / sizeof(configRegionMap[0]); i++) {
+			if (position >= configRegionMap[i].start && position < configRegionMap[i].end) {
+				region = &configRegionMap[i];
+				break;
+			}
+		}
+		if (region == NULL) {
+			// this byte belongs to no known region - better safe than sorry
+			dirtySubsystems = DIRTY_SUBSYSTEM_ALL;
+			return;
+		}
+		dirtySubsystems |= region->subsystems;
+		position = region->end;
+	}
+}
+
+static uint32_t consumeDirtySubsystems(void) {
+	if (!isDirtyTracked) {
+		// the writer did not report any ranges, assume everything has changed
+		return DIRTY_SUBSYSTEM_ALL;
+	}
+	uint32_t result = dirtySubsystems;
+	dirtySubsystems = 0;
+	isDirtyTracked = false;
+	return result;
+}
+
+#else
+#define consumeDirtySubsystems() DIRTY_SUBSYSTEM_ALL
+#endif /* EFI_CONFIG_DIRTY_TRACKING */
+
 /**
  * this is the top-level method which should be called in case of any changes to engine configuration
  * online tuning of most values in the maps does not count as configuration change, but 'Burn' command does
@@ -172,41 +264,64 @@ extern LoggingWithStorage sharedLogger;
  */
 void incrementGlobalConfigurationVersion(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	ENGINE(globalConfigurationVersion++);
+	uint32_t dirtySubsystemMask = consumeDirtySubsystems();
 #if EFI_DEFAILED_LOGGING
 	scheduleMsg(&sharedLogger, "set globalConfigurationVersion=%d", globalConfigurationVersion);
 #endif /* EFI_DEFAILED_LOGGING */
+#if EFI_TUNER_STUDIO && ! EFI_UNIT_TEST
+	/**
+	 * The TunerStudio shadow page serves all reads without touching the live
+	 * configuration - see configWorkingCopy. Console commands mutate the live
+	 * configuration directly and end up here, so refresh the shadow or the next page
+	 * read would serve stale bytes. Note that this discards any not-yet-burned edits
+	 * pending in the shadow, which is the usual last-writer-wins between two
+	 * concurrent tuning sources.
+	 */
+	syncTunerStudioCopy();
+#endif /* EFI_TUNER_STUDIO */
 /**
  * All these callbacks could be implemented as listeners, but these days I am saving RAM
  */
 #if EFI_PROD_CODE
-	applyNewHardwareSettings();
-	reconfigureSensors();
+	if (dirtySubsystemMask & DIRTY_SUBSYSTEM_HARDWARE) {
+		applyNewHardwareSettings();
+		reconfigureSensors();
+	}
 #endif /* EFI_PROD_CODE */
 	engine->preCalculate(PASS_ENGINE_PARAMETER_SIGNATURE);
+	resetSpeedDensityCache();
 #if EFI_ALTERNATOR_CONTROL
-	onConfigurationChangeAlternatorCallback(&activeConfiguration);
+	if (dirtySubsystemMask & DIRTY_SUBSYSTEM_ALTERNATOR)
+		onConfigurationChangeAlternatorCallback(&activeConfiguration);
 #endif /* EFI_ALTERNATOR_CONTROL */
 
 #if EFI_BOOST_CONTROL
-	onConfigurationChangeBoostCallback(&activeConfiguration);
+	if (dirtySubsystemMask & DIRTY_SUBSYSTEM_BOOST)
+		onConfigurationChangeBoostCallback(&activeConfiguration);
 #endif
 #if EFI_ELECTRONIC_THROTTLE_BODY
-	onConfigurationChangeElectronicThrottleCallback(&activeConfiguration);
+	if (dirtySubsystemMask & DIRTY_SUBSYSTEM_ETB)
+		onConfigurationChangeElectronicThrottleCallback(&activeConfiguration);
 #endif /* EFI_ELECTRONIC_THROTTLE_BODY */
 
 #if EFI_IDLE_CONTROL && ! EFI_UNIT_TEST
-	onConfigurationChangeIdleCallback(&activeConfiguration);
+	if (dirtySubsystemMask & DIRTY_SUBSYSTEM_IDLE)
+		onConfigurationChangeIdleCallback(&activeConfiguration);
 #endif /* EFI_IDLE_CONTROL */
 
 #if EFI_SHAFT_POSITION_INPUT
-	onConfigurationChangeTriggerCallback(PASS_ENGINE_PARAMETER_SIGNATURE);
+	if (dirtySubsystemMask & DIRTY_SUBSYSTEM_TRIGGER)
+		onConfigurationChangeTriggerCallback(PASS_ENGINE_PARAMETER_SIGNATURE);
 #endif /* EFI_SHAFT_POSITION_INPUT */
 #if EFI_EMULATE_POSITION_SENSORS
-	onConfigurationChangeRpmEmulatorCallback(&activeConfiguration);
+	// the emulator follows the trigger settings
+	if (dirtySubsystemMask & DIRTY_SUBSYSTEM_TRIGGER)
+		onConfigurationChangeRpmEmulatorCallback(&activeConfiguration);
 #endif /* EFI_EMULATE_POSITION_SENSORS */
 
 #if EFI_FSIO
-	onConfigurationChangeFsioCallback(&activeConfiguration PASS_ENGINE_PARAMETER_SUFFIX);
+	if (dirtySubsystemMask & DIRTY_SUBSYSTEM_FSIO)
+		onConfigurationChangeFsioCallback(&activeConfiguration PASS_ENGINE_PARAMETER_SUFFIX);
 #endif /* EFI_FSIO */
 	rememberCurrentConfiguration(PASS_ENGINE_PARAMETER_SIGNATURE);
 }
@@ -1085,6 +1200,8 @@ void setDefaultFrankensoConfiguration(DECLARE_CONFIG_PARAMETER_SIGNATURE) {
 
 void resetConfigurationExt(Logging * logger, configuration_callback_t boardCallback, engine_type_e engineType DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	enginePins.reset(); // that's mostly important for functional tests
+	resetSpeedDensityCache(); // ditto - each test deserves a fresh delta gate
+	resetInjectorLagLut();
 	/**
 	 * Let's apply global defaults first
 	 */
@@ -1348,6 +1465,13 @@ void applyNonPersistentConfiguration(Logging * logger DECLARE_ENGINE_PARAMETER_S
 
 	assertEngineReference();
 
+	/**
+	 * the validated/hot views must be populated before prepareShapes() and friends
+	 * start reading them - the configuration-change path refreshes them again via
+	 * incrementGlobalConfigurationVersion()
+	 */
+	ENGINE(preCalculate(PASS_ENGINE_PARAMETER_SIGNATURE));
+
 #if EFI_ENGINE_CONTROL
 	ENGINE(initializeTriggerWaveform(logger PASS_ENGINE_PARAMETER_SUFFIX));
 #endif
@@ -1362,7 +1486,7 @@ void applyNonPersistentConfiguration(Logging * logger DECLARE_ENGINE_PARAMETER_S
 void prepareShapes(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	prepareOutputSignals(PASS_ENGINE_PARAMETER_SIGNATURE);
 
-	engine->injectionEvents.addFuelEvents(PASS_ENGINE_PARAMETER_SIGNATURE);
+	engine->rebuildFuelSchedule(PASS_ENGINE_PARAMETER_SIGNATURE);
 }
 
 #endif
@@ -57,6 +57,10 @@ void setDefaultSdCardParameters(DECLARE_CONFIG_PARAMETER_SIGNATURE);
 
 void rememberCurrentConfiguration(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 void incrementGlobalConfigurationVersion(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+#if EFI_CONFIG_DIRTY_TRACKING
+// reports a modified configuration byte range so that the next apply pass only reinitializes affected subsystems
+void markConfigurationDirty(int offset, int count);
+#endif /* EFI_CONFIG_DIRTY_TRACKING */
 
 void commonFrankensoAnalogInputs(engine_configuration_s *engineConfiguration);
 void setFrankenso0_1_joystick(engine_configuration_s *engineConfiguration);
@@ -24,17 +24,31 @@ public:
 	int getMockAdcValue(int hwChannel) const;
 };
 
+// number of entries in the pre-compiled voltage-to-Celsius curve, see buildTemperatureLut
+#define THERM_LUT_SIZE 64
+
 class ThermistorMath : public thermistor_state_s {
 public:
 	void setConfig(thermistor_conf_s *config);
 	void prepareThermistorCurve(thermistor_conf_s *tc);
 	float getKelvinTemperatureByResistance(float resistance) const;
+	/**
+	 * Performance optimization: Steinhart-Hart is evaluated only on configuration changes
+	 * into a piecewise-linear voltage-to-Celsius curve, each read is then just a lookup
+	 * plus lerp. logf() costs hundreds of cycles on Cortex-M4 while we read CLT/IAT far
+	 * more often than the curve changes.
+	 */
+	float getCelsiusByVoltage(float voltage);
 	float s_h_a = 0;
 	float s_h_b = 0;
 	float s_h_c = 0;
 	bool isLinear;
 private:
+	void buildTemperatureLut(thermistor_conf_s *tc);
 	thermistor_conf_s currentConfig = {0,0,0,0,0,0,0};
+	float lutVoltageBins[THERM_LUT_SIZE];
+	float lutCelsius[THERM_LUT_SIZE];
+	bool isLutReady = false;
 };
 
 class Accelerometer {
@@ -12,6 +12,7 @@
 #include "engine_parts.h"
 #include "pid.h"
 #include "engine_state_generated.h"
+#include "local_version_holder.h"
 
 #define BRAIN_PIN_COUNT (1 << sizeof(brain_pin_e))
 
@@ -20,8 +21,49 @@ public:
 	EngineState();
 	void periodicFastCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 	void updateSlowSensors(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+	/**
+	 * re-derives the time-domain values from the cached angle/time lookups when only
+	 * RPM has moved - one divide instead of the whole interpolation chain
+	 */
+	void updateTimeDomainConversions(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX);
+	/**
+	 * one batched recalculation of the battery voltage dwell multiplier, gated by a
+	 * hysteresis band so a noisy VBatt reading does not modulate dwell tooth to tooth
+	 */
+	void updateDwellVoltageCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 	void updateTChargeK(int rpm, float tps DECLARE_ENGINE_PARAMETER_SUFFIX);
 
+	/**
+	 * dwell table value before battery voltage compensation, milliseconds
+	 */
+	floatms_t baseDwell = 0;
+	/**
+	 * battery voltage dwell multiplier, neutral until armed from the console - see
+	 * updateDwellVoltageCorrection()
+	 */
+	float dwellVoltageCorrection = 1;
+	/**
+	 * voltage the current correction batch was computed at
+	 */
+	float dwellCorrectionVBatt = 0;
+	/**
+	 * corrected dwell as ready-to-use integer microseconds for the per-tooth path,
+	 * zero doubles as the not-ready flag
+	 */
+	uint32_t sparkDwellUs = 0;
+
+	/**
+	 * Cranking fast path, see getCrankingFuel3(): the slow-moving coefficients are
+	 * re-interpolated only when their input actually moved, so between teeth the
+	 * cranking fuel math is a few multiplies. Coolant drives one batch, the
+	 * revolution counter the other, a configuration change invalidates both.
+	 */
+	float crankingCltCoefficient = 1;
+	float crankingCltBatchTemperature = NAN;
+	float crankingDurationCoefficient = 1;
+	uint32_t crankingDurationRevolution = (uint32_t) -1;
+	LocalVersionHolder crankingSnapshotVersion;
+
 #if ! EFI_PROD_CODE
 	bool mockPinStates[BRAIN_PIN_COUNT];
 #endif
@@ -67,6 +109,21 @@ public:
 
 	float currentRawVE = 0;
 
+	/**
+	 * mean torque estimate in Nm, the last speed-density pipeline stage - see
+	 * updateTorqueEstimate() in speed_density.cpp. Published for ETB/traction torque
+	 * coordination; the fuel math itself does not read it.
+	 */
+	float estimatedEngineTorque = 0;
+
+	/**
+	 * shadow-tune outputs, see shadow_tune.cpp: what the shadow VE/timing tables
+	 * would command at the current operating point. Logged for A/B comparison on
+	 * the dyno, never actuated.
+	 */
+	float shadowVe = 0;
+	angle_t shadowTimingAdvance = 0;
+
 	int vssEventCounter = 0;
 
 
@@ -57,14 +57,32 @@ public:
 	void addFuelEvents(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 	bool addFuelEventsForCylinder(int cylinderIndex DECLARE_ENGINE_PARAMETER_SUFFIX);
 
+	/**
+	 * Structure-of-arrays layout for the hot angle data: per-cylinder injection start angles
+	 * live in this compact array and not interleaved with scheduling_s state inside
+	 * InjectionEvent, so the per-cycle angle sweep stays within a couple of cache lines
+	 * even on 12 cylinder engines. See also Engine#ignitionPositionWithinEngineCycle
+	 */
+	angle_t injectionStartAngles[MAX_INJECTION_OUTPUT_COUNT];
+
 	/**
 	 * injection events, per cylinder
 	 */
 	InjectionEvent elements[MAX_INJECTION_OUTPUT_COUNT];
 	bool isReady;
+	/**
+	 * revolution counter at the moment this buffer stopped being the published one,
+	 * see Engine::getRetiredFuelSchedule() grace period
+	 */
+	uint32_t replacedAtRevolution = 0;
 
 private:
 	void clear();
+	/**
+	 * @return NAN if we do not have RPM or injection duration yet
+	 */
+	angle_t getBaseAngle(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+	bool registerInjectionEvent(int cylinderIndex DECLARE_ENGINE_PARAMETER_SUFFIX);
 };
 
 class AngleBasedEvent {
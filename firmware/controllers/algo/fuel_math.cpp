@@ -53,20 +53,43 @@ DISPLAY(DISPLAY_IF(isCrankingState)) floatms_t getCrankingFuel3(float coolantTem
 		uint32_t revolutionCounterSinceStart DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	// these magic constants are in Celsius
 	float baseCrankingFuel = engineConfiguration->cranking.baseFuel;
+
+	EngineState *state = &engine->engineState;
+	if (state->crankingSnapshotVersion.isOld(ENGINE(getGlobalConfigurationVersion()))) {
+		// cranking tables were just tuned, force both batches stale
+		state->crankingCltBatchTemperature = NAN;
+		state->crankingDurationRevolution = (uint32_t) -1;
+	}
+
 	/**
-	 * Cranking fuel changes over time
+	 * Cranking fuel changes over time - but only as the revolution counter advances,
+	 * not between the teeth of one revolution
 	 */
+	if (revolutionCounterSinceStart != state->crankingDurationRevolution) {
+		state->crankingDurationRevolution = revolutionCounterSinceStart;
+		state->crankingDurationCoefficient = interpolate2d("crank", revolutionCounterSinceStart, config->crankingCycleBins,
+				config->crankingCycleCoef);
+	}
 	DISPLAY_TEXT(Duration_coef);
-	engine->engineState.DISPLAY_PREFIX(cranking).DISPLAY_FIELD(durationCoefficient) = interpolate2d("crank", revolutionCounterSinceStart, config->crankingCycleBins,
-			config->crankingCycleCoef);
+	engine->engineState.DISPLAY_PREFIX(cranking).DISPLAY_FIELD(durationCoefficient) = state->crankingDurationCoefficient;
 	DISPLAY_TEXT(eol);
 
 	/**
-	 * Cranking fuel is different depending on engine coolant temperature
+	 * Cranking fuel is different depending on engine coolant temperature - which moves
+	 * orders of magnitude slower than cranking teeth arrive, so the interpolation runs
+	 * only when the reading drifts past half a degree
 	 */
+	if (cisnan(coolantTemperature)) {
+		state->crankingCltCoefficient = 1;
+		state->crankingCltBatchTemperature = NAN;
+	} else if (cisnan(state->crankingCltBatchTemperature)
+			|| absF(coolantTemperature - state->crankingCltBatchTemperature) > 0.5f) {
+		state->crankingCltBatchTemperature = coolantTemperature;
+		state->crankingCltCoefficient = interpolate2d("crank", coolantTemperature, config->crankingFuelBins,
+				config->crankingFuelCoef);
+	}
 	DISPLAY_TEXT(Coolant_coef);
-	engine->engineState.DISPLAY_PREFIX(cranking).DISPLAY_FIELD(coolantTemperatureCoefficient) = cisnan(coolantTemperature) ? 1 : interpolate2d("crank", coolantTemperature, config->crankingFuelBins,
-			config->crankingFuelCoef);
+	engine->engineState.DISPLAY_PREFIX(cranking).DISPLAY_FIELD(coolantTemperatureCoefficient) = state->crankingCltCoefficient;
 	DISPLAY_SENSOR(CLT);
 	DISPLAY_TEXT(eol);
 
@@ -214,7 +237,7 @@ int getNumberOfInjections(injection_mode_e mode DECLARE_ENGINE_PARAMETER_SUFFIX)
 	switch (mode) {
 	case IM_SIMULTANEOUS:
 	case IM_SINGLE_POINT:
-		return engineConfiguration->specs.cylindersCount;
+		return ENGINE(hotConfig.cylindersCount);
 	case IM_BATCH:
 		return 2;
 	case IM_SEQUENTIAL:
@@ -230,7 +253,7 @@ int getNumberOfInjections(injection_mode_e mode DECLARE_ENGINE_PARAMETER_SUFFIX)
  * @see getCoilDutyCycle
  */
 percent_t getInjectorDutyCycle(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	floatms_t totalInjectiorAmountPerCycle = ENGINE(injectionDuration) * getNumberOfInjections(engineConfiguration->injectionMode PASS_ENGINE_PARAMETER_SUFFIX);
+	floatms_t totalInjectiorAmountPerCycle = ENGINE(injectionDuration) * getNumberOfInjections(ENGINE(hotConfig.injectionMode) PASS_ENGINE_PARAMETER_SUFFIX);
 	floatms_t engineCycleDuration = getEngineCycleDuration(rpm PASS_ENGINE_PARAMETER_SUFFIX);
 	return 100 * totalInjectiorAmountPerCycle / engineCycleDuration;
 }
@@ -245,8 +268,8 @@ floatms_t getInjectionDuration(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #if EFI_ENGINE_CONTROL && EFI_SHAFT_POSITION_INPUT
 	bool isCranking = ENGINE(rpmCalculator).isCranking(PASS_ENGINE_PARAMETER_SIGNATURE);
 	injection_mode_e mode = isCranking ?
-			engineConfiguration->crankingInjectionMode :
-			engineConfiguration->injectionMode;
+			ENGINE(hotConfig.crankingInjectionMode) :
+			ENGINE(hotConfig.injectionMode);
 	int numberOfInjections = getNumberOfInjections(mode PASS_ENGINE_PARAMETER_SUFFIX);
 	if (numberOfInjections == 0) {
 		warning(CUSTOM_CONFIG_NOT_READY, "config not ready");
@@ -267,7 +290,7 @@ floatms_t getInjectionDuration(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	}
 	if (mode == IM_SINGLE_POINT) {
 		// here we convert per-cylinder fuel amount into total engine amount since the single injector serves all cylinders
-		fuelPerCycle *= engineConfiguration->specs.cylindersCount;
+		fuelPerCycle *= ENGINE(hotConfig.cylindersCount);
 	}
 	// Fuel cut-off isn't just 0 or 1, it can be tapered
 	fuelPerCycle *= ENGINE(engineState.fuelCutoffCorrection);
@@ -287,6 +310,32 @@ floatms_t getInjectionDuration(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #endif
 }
 
+/**
+ * Direct-indexed injector dead time LUT: battery voltage spans a tiny range so a
+ * 0.1V-granularity table covering 0..16V turns the per-injection-event binary search
+ * plus interpolation into one multiply and one load. Rebuilt lazily whenever the
+ * configuration version moves, same pattern as the other LocalVersionHolder consumers.
+ */
+#define INJECTOR_LAG_LUT_PER_VOLT 10
+#define INJECTOR_LAG_LUT_SIZE 160
+
+static float injectorLagLut[INJECTOR_LAG_LUT_SIZE];
+static bool injectorLagLutReady = false;
+static LocalVersionHolder injectorLagCurveVersion;
+
+void resetInjectorLagLut(void) {
+	injectorLagLutReady = false;
+}
+
+static void rebuildInjectorLagLut(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	for (int i = 0; i < INJECTOR_LAG_LUT_SIZE; i++) {
+		float vBatt = i / (float)INJECTOR_LAG_LUT_PER_VOLT;
+		injectorLagLut[i] = interpolate2d("lag", vBatt, engineConfiguration->injector.battLagCorrBins,
+				engineConfiguration->injector.battLagCorr);
+	}
+	injectorLagLutReady = true;
+}
+
 /**
  * @brief	Injector lag correction
  * @param	vBatt	Battery voltage.
@@ -297,8 +346,14 @@ floatms_t getInjectorLag(float vBatt DECLARE_ENGINE_PARAMETER_SUFFIX) {
 		warning(OBD_System_Voltage_Malfunction, "vBatt=%.2f", vBatt);
 		return 0;
 	}
-	
-	return interpolate2d("lag", vBatt, engineConfiguration->injector.battLagCorrBins, engineConfiguration->injector.battLagCorr);
+
+	if (injectorLagCurveVersion.isOld(ENGINE(getGlobalConfigurationVersion())) || !injectorLagLutReady) {
+		rebuildInjectorLagLut(PASS_ENGINE_PARAMETER_SIGNATURE);
+	}
+	int index = (int)(vBatt * INJECTOR_LAG_LUT_PER_VOLT);
+	// voltage beyond the LUT range degenerates into the edge value, like interpolate2d
+	index = maxI(0, minI(index, INJECTOR_LAG_LUT_SIZE - 1));
+	return injectorLagLut[index];
 }
 
 /**
@@ -382,7 +437,8 @@ floatms_t getBaseTableFuel(int rpm, float engineLoad) {
 		warning(CUSTOM_NAN_ENGINE_LOAD_2, "NaN engine load");
 		return 0;
 	}
-	floatms_t result = fuelMap.getValue(rpm, engineLoad);
+	// NaN engine load is rejected above, see getValueFast contract
+	floatms_t result = fuelMap.getValueFast(rpm, engineLoad);
 	if (cisnan(result)) {
 		// result could be NaN in case of invalid table, like during initialization
 		result = 0;
@@ -394,6 +450,10 @@ floatms_t getBaseTableFuel(int rpm, float engineLoad) {
 #endif
 }
 
+void validateFuelTableAxes() {
+	fuelMap.validateAxes();
+}
+
 float getBaroCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	if (hasBaroSensor(PASS_ENGINE_PARAMETER_SIGNATURE)) {
 		float correction = baroCorrMap.getValue(GET_RPM(), getBaroPressure(PASS_ENGINE_PARAMETER_SIGNATURE));
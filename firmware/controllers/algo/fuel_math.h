@@ -24,11 +24,16 @@ floatms_t getRunningFuel(floatms_t baseFuel DECLARE_ENGINE_PARAMETER_SUFFIX);
 floatms_t getRealMafFuel(float airMass, int rpm DECLARE_ENGINE_PARAMETER_SUFFIX);
 
 floatms_t getBaseTableFuel(int rpm, float engineLoad);
+/**
+ * periodic axis sanity stage enabling the unchecked fuel lookup, see Map3D::getValueFast()
+ */
+void validateFuelTableAxes();
 float getBaroCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 int getNumberOfInjections(injection_mode_e mode DECLARE_ENGINE_PARAMETER_SUFFIX);
 angle_t getInjectionOffset(float rpm DECLARE_ENGINE_PARAMETER_SUFFIX);
 float getIatFuelCorrection(float iat DECLARE_ENGINE_PARAMETER_SUFFIX);
 floatms_t getInjectorLag(float vBatt DECLARE_ENGINE_PARAMETER_SUFFIX);
+void resetInjectorLagLut(void);
 float getCltFuelCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 float getFuelCutOffCorrection(efitick_t nowNt, int rpm DECLARE_ENGINE_PARAMETER_SUFFIX);
 angle_t getCltTimingCorrection(DECLARE_ENGINE_PARAMETER_SIGNATURE);
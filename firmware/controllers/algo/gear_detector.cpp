@@ -0,0 +1,172 @@
+/**
+ * @file	gear_detector.cpp
+ * @brief	gear detection by RPM/VSS ratio classification
+ *
+ * Gear used to be computed offline from logs. Here the RPM over vehicle speed
+ * ratio is classified against precomputed per-gear bands: when the ratio list
+ * changes the bands are flattened into a direct range table, so the per-sample
+ * work is one multiply and one byte read - no binary search, cheap enough to run
+ * on every fast callback which is faster than the filtered VSS ever updates.
+ * A few consecutive identical classifications are required before the published
+ * gear moves, so the wandering ratio of a shift in progress reads as "unknown"
+ * rather than flickering through neighbouring gears.
+ *
+ * The detected gear feeds the table overlay engine (per-gear timing retard, see
+ * TableOverlayComposer) and anything else that wants it via getDetectedGear().
+ * The configuration image has no gear ratio fields, so the nominal RPM-per-km/h
+ * ratios are set from the console and applied immediately:
+ *
+ *     set_gear_ratio <gear> <rpm per kph>
+ *     gearinfo
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+#include "gear_detector.h"
+#include "efilib.h"
+
+#if !EFI_UNIT_TEST
+#include "eficonsole.h"
+#endif /* EFI_UNIT_TEST */
+
+/**
+ * below this the vehicle is standing for ratio purposes - the VSS filter tail
+ * makes very low readings meaningless anyway
+ */
+#define GEAR_MIN_SPEED_KPH 3
+#define GEAR_MIN_RPM 400
+
+static Logging *logger;
+
+GearDetector::GearDetector() {
+	reset();
+}
+
+void GearDetector::reset() {
+	memset(ratios, 0, sizeof(ratios));
+	memset(rangeTable, 0, sizeof(rangeTable));
+	indexPerRatio = 0;
+	currentGear = 0;
+	candidateGear = 0;
+	candidateCount = 0;
+}
+
+void GearDetector::setGearRatio(int gear, float rpmPerKph) {
+	if (gear < 1 || gear > GEAR_MAX_GEARS) {
+		warning(CUSTOM_ERR_6639, "gear ratio index %d", gear);
+		return;
+	}
+	ratios[gear - 1] = rpmPerKph;
+	applyRatios();
+}
+
+void GearDetector::applyRatios() {
+	memset(rangeTable, 0, sizeof(rangeTable));
+	// first gear has the largest ratio, it sets the table span
+	float maxRatio = 0;
+	for (int i = 0; i < GEAR_MAX_GEARS; i++) {
+		maxRatio = maxF(maxRatio, ratios[i]);
+	}
+	if (maxRatio <= 0) {
+		indexPerRatio = 0;
+		return;
+	}
+	indexPerRatio = (GEAR_RANGE_TABLE_SIZE - 1) / (maxRatio * (1 + GEAR_RATIO_TOLERANCE));
+
+	for (int i = 0; i < GEAR_MAX_GEARS; i++) {
+		if (ratios[i] <= 0) {
+			continue;
+		}
+		int from = (int)(ratios[i] * (1 - GEAR_RATIO_TOLERANCE) * indexPerRatio);
+		int to = (int)(ratios[i] * (1 + GEAR_RATIO_TOLERANCE) * indexPerRatio);
+		from = maxI(0, from);
+		to = minI(to, GEAR_RANGE_TABLE_SIZE - 1);
+		// mis-entered overlapping bands resolve in favor of the higher gear
+		for (int index = from; index <= to; index++) {
+			rangeTable[index] = i + 1;
+		}
+	}
+}
+
+int GearDetector::classifyRatio(float rpmPerKph) const {
+	if (indexPerRatio <= 0 || rpmPerKph < 0) {
+		return 0;
+	}
+	int index = (int)(rpmPerKph * indexPerRatio);
+	if (index >= GEAR_RANGE_TABLE_SIZE) {
+		return 0;
+	}
+	return rangeTable[index];
+}
+
+int GearDetector::update(int rpm, float speedKph) {
+	if (speedKph < GEAR_MIN_SPEED_KPH || rpm < GEAR_MIN_RPM) {
+		currentGear = 0;
+		candidateGear = 0;
+		candidateCount = 0;
+		return currentGear;
+	}
+	int classified = classifyRatio(rpm / speedKph);
+	if (classified == currentGear) {
+		candidateCount = 0;
+	} else if (classified == candidateGear) {
+		if (++candidateCount >= GEAR_CONFIRM_COUNT) {
+			currentGear = classified;
+			candidateCount = 0;
+		}
+	} else {
+		candidateGear = classified;
+		candidateCount = 1;
+	}
+	return currentGear;
+}
+
+int GearDetector::getCurrentGear() const {
+	return currentGear;
+}
+
+float GearDetector::getGearRatio(int gear) const {
+	if (gear < 1 || gear > GEAR_MAX_GEARS) {
+		return 0;
+	}
+	return ratios[gear - 1];
+}
+
+static GearDetector gearDetector;
+
+void updateGearDetection(int rpm, float speedKph) {
+	gearDetector.update(rpm, speedKph);
+}
+
+int getDetectedGear(void) {
+	return gearDetector.getCurrentGear();
+}
+
+#if !EFI_UNIT_TEST
+
+static void consoleSetGearRatio(int gear, float rpmPerKph) {
+	gearDetector.setGearRatio(gear, rpmPerKph);
+	scheduleMsg(logger, "gear %d = %.1f RPM/kph", gear, rpmPerKph);
+}
+
+static void gearInfo(void) {
+	for (int gear = 1; gear <= GEAR_MAX_GEARS; gear++) {
+		float ratio = gearDetector.getGearRatio(gear);
+		if (ratio > 0) {
+			scheduleMsg(logger, "gear %d: %.1f RPM/kph", gear, ratio);
+		}
+	}
+	scheduleMsg(logger, "detected gear %d", gearDetector.getCurrentGear());
+}
+
+#endif /* EFI_UNIT_TEST */
+
+void initGearDetector(Logging *sharedLogger) {
+	logger = sharedLogger;
+#if !EFI_UNIT_TEST
+	addConsoleActionIF("set_gear_ratio", consoleSetGearRatio);
+	addConsoleAction("gearinfo", gearInfo);
+#endif /* EFI_UNIT_TEST */
+}
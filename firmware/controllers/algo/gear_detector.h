@@ -0,0 +1,68 @@
+/**
+ * @file	gear_detector.h
+ * @brief	gear detection by RPM/VSS ratio classification, see gear_detector.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+#include "datalogging.h"
+
+#define GEAR_MAX_GEARS 8
+/**
+ * the direct classification table: ratio quantized to an index, one byte per
+ * entry holding the gear number. 256 entries over the first-gear ratio keep the
+ * quantization step well under the band tolerance.
+ */
+#define GEAR_RANGE_TABLE_SIZE 256
+/**
+ * half-width of each gear band relative to its nominal ratio; tyre slip, VSS
+ * filtering lag and torque converter slop all land inside this
+ */
+#define GEAR_RATIO_TOLERANCE 0.12f
+/**
+ * consecutive identical classifications required before the published gear
+ * changes, so the wandering ratio of a shift in progress does not flicker
+ */
+#define GEAR_CONFIRM_COUNT 3
+
+/**
+ * 0 means unknown: neutral, clutch in, standing still, or mid-shift
+ */
+class GearDetector {
+public:
+	GearDetector();
+	void reset();
+	/**
+	 * @param gear 1-based
+	 * @param rpmPerKph nominal engine RPM per km/h of vehicle speed in this gear
+	 */
+	void setGearRatio(int gear, float rpmPerKph);
+	/**
+	 * rebuilds the range table from the configured ratios, invoked on every
+	 * ratio change - classification itself never touches the ratio list
+	 */
+	void applyRatios();
+	/**
+	 * O(1): one multiply and one table read, no searching
+	 */
+	int classifyRatio(float rpmPerKph) const;
+	int update(int rpm, float speedKph);
+	int getCurrentGear() const;
+	float getGearRatio(int gear) const;
+
+private:
+	float ratios[GEAR_MAX_GEARS];
+	uint8_t rangeTable[GEAR_RANGE_TABLE_SIZE];
+	float indexPerRatio;
+	int currentGear;
+	int candidateGear;
+	int candidateCount;
+};
+
+void initGearDetector(Logging *sharedLogger);
+void updateGearDetection(int rpm, float speedKph);
+int getDetectedGear(void);
@@ -301,6 +301,222 @@ int nmea_valid_checksum(const char *message) {
 	return _EMPTY;
 }
 
+/* incremental parser states */
+#define NMEA_STATE_IDLE 0
+#define NMEA_STATE_FIELDS 1
+#define NMEA_STATE_CHECKSUM_HIGH 2
+#define NMEA_STATE_CHECKSUM_LOW 3
+
+void nmea_parser_init(nmea_parser_state *parser) {
+	memset(parser, 0, sizeof(nmea_parser_state));
+	parser->state = NMEA_STATE_IDLE;
+}
+
+static void nmea_start_sentence(nmea_parser_state *parser) {
+	parser->state = NMEA_STATE_FIELDS;
+	parser->type = NMEA_UNKNOWN;
+	parser->fieldIndex = 0;
+	parser->fieldLength = 0;
+	parser->runningChecksum = 0;
+	parser->invalid = 0;
+	parser->statusInvalid = 0;
+	parser->timeValid = 0;
+	parser->dateValid = 0;
+	memset(&parser->fix, 0, sizeof(parser->fix));
+	memset(&parser->stagedTm, 0, sizeof(parser->stagedTm));
+}
+
+static void nmea_on_field(nmea_parser_state *parser) {
+	char *field = parser->field;
+	int length = parser->fieldLength;
+	field[length] = '\0';
+
+	if (parser->fieldIndex == 0) {
+		if (strcmp(field, "GPRMC") == 0) {
+			parser->type = NMEA_GPRMC;
+		} else if (strcmp(field, "GPGGA") == 0) {
+			parser->type = NMEA_GPGGA;
+		}
+		return;
+	}
+
+	if (parser->type == NMEA_GPGGA) {
+		switch (parser->fieldIndex) {
+		case 2:
+			if (length == 0) {
+				parser->invalid = 1;
+			} else {
+				parser->fix.latitude = atoff(field);
+			}
+			break;
+		case 3:
+			parser->fix.lat = length > 0 ? field[0] : '\0';
+			break;
+		case 4:
+			parser->fix.longitude = atoff(field);
+			break;
+		case 5:
+			parser->fix.lon = length > 0 ? field[0] : '\0';
+			break;
+		case 6:
+			parser->fix.quality = atoi(field);
+			break;
+		case 7:
+			parser->fix.satellites = atoi(field);
+			break;
+		case 9:
+			parser->fix.altitude = atoff(field);
+			break;
+		}
+	} else if (parser->type == NMEA_GPRMC) {
+		switch (parser->fieldIndex) {
+		case 1:
+			if (length > 5) {
+				parser->stagedTm.tm_hour = str2int(field, 2);
+				parser->stagedTm.tm_min = str2int(field + 2, 2);
+				parser->stagedTm.tm_sec = str2int(field + 4, 2);
+				parser->timeValid = 1;
+			}
+			break;
+		case 2:
+			if (field[0] == 'V') {
+				parser->statusInvalid = 1;
+			}
+			break;
+		case 3:
+			parser->fix.latitude = atoff(field);
+			break;
+		case 4:
+			parser->fix.lat = length > 0 ? field[0] : '\0';
+			break;
+		case 5:
+			parser->fix.longitude = atoff(field);
+			break;
+		case 6:
+			parser->fix.lon = length > 0 ? field[0] : '\0';
+			break;
+		case 7:
+			parser->fix.speed = atoff(field);
+			break;
+		case 8:
+			parser->fix.course = atoff(field);
+			break;
+		case 9:
+			if (length > 5) {
+				parser->stagedTm.tm_mday = str2int(field, 2);
+				parser->stagedTm.tm_mon = str2int(field + 2, 2);
+				// we receive -2000, standard wants -1900 = add correction
+				parser->stagedTm.tm_year = str2int(field + 4, 2) + 100;
+				if (parser->stagedTm.tm_year > 0) {
+					parser->dateValid = 1;
+				}
+			}
+			break;
+		}
+	}
+}
+
+static int nmea_commit(nmea_parser_state *parser, loc_t *loc) {
+	if (parser->type == NMEA_UNKNOWN) {
+		return 0;
+	}
+	loc->type = parser->type;
+
+	if (parser->type == NMEA_GPGGA) {
+		if (parser->invalid) {
+			return 0;
+		}
+		loc->latitude = parser->fix.latitude;
+		loc->lat = parser->fix.lat;
+		loc->longitude = parser->fix.longitude;
+		loc->lon = parser->fix.lon;
+		loc->quality = parser->fix.quality;
+		loc->satellites = parser->fix.satellites;
+		loc->altitude = parser->fix.altitude;
+		gps_convert_deg_to_dec(&loc->latitude, loc->lat, &loc->longitude, loc->lon);
+		return 1;
+	}
+
+	/* GPRMC */
+	if (parser->statusInvalid) {
+		loc->quality = 0;
+		return 1;
+	}
+	/* this is declaration that last received field is VALID */
+	loc->quality = 4;
+	loc->latitude = parser->fix.latitude;
+	loc->lat = parser->fix.lat;
+	loc->longitude = parser->fix.longitude;
+	loc->lon = parser->fix.lon;
+	loc->speed = parser->fix.speed;
+	loc->course = parser->fix.course;
+	if (parser->dateValid) {
+		if (parser->timeValid) {
+			parser->stagedTm.tm_isdst = 0;
+		}
+		memcpy(&loc->GPStm, &parser->stagedTm, sizeof(parser->stagedTm));
+	}
+	return 1;
+}
+
+/* unlike hex2int() this handles the upper case hex real receivers emit */
+static int nmea_hex_digit(char c) {
+	if (c >= '0' && c <= '9')
+		return c - '0';
+	if (c >= 'A' && c <= 'F')
+		return c - 'A' + 10;
+	if (c >= 'a' && c <= 'f')
+		return c - 'a' + 10;
+	return 0;
+}
+
+int nmea_parser_feed(nmea_parser_state *parser, char c, loc_t *loc) {
+	if (c == '$') {
+		/* a new sentence restarts the machine no matter what state we are in */
+		nmea_start_sentence(parser);
+		return 0;
+	}
+
+	switch (parser->state) {
+	case NMEA_STATE_IDLE:
+		return 0;
+	case NMEA_STATE_FIELDS:
+		if (c == '*') {
+			nmea_on_field(parser);
+			parser->state = NMEA_STATE_CHECKSUM_HIGH;
+			return 0;
+		}
+		parser->runningChecksum ^= (unsigned char) c;
+		if (c == ',') {
+			nmea_on_field(parser);
+			parser->fieldIndex++;
+			parser->fieldLength = 0;
+			return 0;
+		}
+		if (c == '\r' || c == '\n') {
+			/* no checksum on this line, drop it */
+			parser->state = NMEA_STATE_IDLE;
+			return 0;
+		}
+		if (parser->fieldLength < NMEA_MAX_FIELD_LENGTH - 1) {
+			parser->field[parser->fieldLength++] = c;
+		}
+		return 0;
+	case NMEA_STATE_CHECKSUM_HIGH:
+		parser->expectedChecksum = (unsigned char) (nmea_hex_digit(c) << 4);
+		parser->state = NMEA_STATE_CHECKSUM_LOW;
+		return 0;
+	case NMEA_STATE_CHECKSUM_LOW:
+		parser->expectedChecksum |= (unsigned char) nmea_hex_digit(c);
+		parser->state = NMEA_STATE_IDLE;
+		if (parser->runningChecksum != parser->expectedChecksum) {
+			return 0;
+		}
+		return nmea_commit(parser, loc);
+	}
+	return 0;
+}
+
 // Compute the GPS location using decimal scale
 void gps_location(loc_t *coord, char *buffer) {
 
@@ -49,6 +49,37 @@ void nmea_parse_gpgga(char *, loc_t *);
 void nmea_parse_gprmc(char *, loc_t *);
 void gps_location(loc_t *, char *);
 
+/**
+ * Incremental byte-at-a-time parser: fixed state, no sentence buffer, each byte
+ * is touched exactly once including the running checksum. This is what the UART
+ * thread feeds, the buffer-based functions above remain for whole-line use.
+ */
+#define NMEA_MAX_FIELD_LENGTH 20
+
+typedef struct {
+	/* staged fix, committed into the caller's loc_t on a valid checksum */
+	loc_t fix;
+	struct tm stagedTm;
+	int state;
+	nmea_message_type type;
+	int fieldIndex;
+	int fieldLength;
+	char field[NMEA_MAX_FIELD_LENGTH];
+	unsigned char runningChecksum;
+	unsigned char expectedChecksum;
+	char invalid;
+	char statusInvalid;
+	char timeValid;
+	char dateValid;
+} nmea_parser_state;
+
+void nmea_parser_init(nmea_parser_state *parser);
+/**
+ * @return 1 when this byte completed a known sentence with a valid checksum and
+ * the fix in *loc was updated
+ */
+int nmea_parser_feed(nmea_parser_state *parser, char c, loc_t *loc);
+
 
 #ifdef __cplusplus
 }
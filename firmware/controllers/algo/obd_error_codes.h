@@ -1745,8 +1745,8 @@ typedef enum {
 	CUSTOM_INTERPOLATE_NAN = 6055,
 	ERROR_HISTO_NAME = 6056,
 	CUSTOM_AUX_OUT_OF_ORDER = 6057,
-	CUSTOM_OBD_58 = 6058,
-	CUSTOM_OBD_59 = 6059,
+	CUSTOM_OBD_INVALID_DISPLACEMENT = 6058,
+	CUSTOM_OBD_INVALID_INJECTOR_FLOW = 6059,
 
 	CUSTOM_OBD_MMC_START1 = 6060,
 	CUSTOM_OBD_MMC_START2 = 6061,
@@ -1942,7 +1942,7 @@ typedef enum {
 
 	CUSTOM_ERR_6590 = 6590,
 	CUSTOM_ERR_6591 = 6591,
-	CUSTOM_ERR_6592 = 6592,
+	CUSTOM_ERR_CYLBAL_ANGLE = 6592,
 	CUSTOM_ERR_6593 = 6593,
 	CUSTOM_SHAPE_LEN_ZERO = 6594,
 	CUSTOM_TRIGGER_CYCLE = 6595,
@@ -2082,9 +2082,9 @@ typedef enum {
 	CUSTOM_INVALID_ADC = 6720,
 	CUSTOM_INVALID_MODE_SETTING = 6721,
 	CUSTOM_ERR_TASK_TIMER_OVERFLOW = 6722,
-	CUSTOM_ERR_6723 = 6723,
-	CUSTOM_ERR_6724 = 6724,
-	CUSTOM_ERR_6725 = 6725,
+	CUSTOM_EVENT_QUEUE_FULL = 6723,
+	CUSTOM_SCHEDULING_POOL_EXHAUSTED = 6724,
+	CUSTOM_TRIGGER_SYNC_GAPS_MISMATCH = 6725,
 	CUSTOM_ERR_6726 = 6726,
 	CUSTOM_ERR_6727 = 6727,
 	CUSTOM_ERR_6728 = 6728,
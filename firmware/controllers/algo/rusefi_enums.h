@@ -662,7 +662,22 @@ typedef enum {
 	DBG_AUX_TEMPERATURE = 34,
 	DBG_ETB_LOGIC = 35,
 	DBG_BOOST = 36,
-	DBG_37 = 37,
+	/**
+	 * ISR CPU budget, see isr_budget.h
+	 */
+	DBG_ISR_BUDGET = 37,
+	/**
+	 * sensor staleness counters, see Sensor::checkFreshness
+	 */
+	DBG_SENSOR_FRESHNESS = 38,
+	/**
+	 * shadow-tune A/B comparison outputs, see shadow_tune.cpp
+	 */
+	DBG_SHADOW_TUNE = 39,
+	/**
+	 * async sensor calibration progress, see sensor_calibration.cpp
+	 */
+	DBG_CALIBRATION = 40,
 
 	Force_4_bytes_size_debug_mode_e = ENUM_32_BITS,
 } debug_mode_e;
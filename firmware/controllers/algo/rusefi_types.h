@@ -69,6 +69,17 @@ typedef efitime_t efitick_t;
 
 typedef float angle_t;
 
+/**
+ * Q16.16 fixed point storage for angle/ratio values on ISR hot paths.
+ * On STM32F4 the FPU context save/restore in interrupt handlers costs real cycles, with
+ * EFI_FIXED_POINT_TRIGGER_MATH the trigger decoder compares tooth durations using integer
+ * math and converts to float only at table-lookup boundaries.
+ */
+typedef int32_t fixed16_t;
+#define FIXED16_ONE 65536
+#define FLOAT_TO_FIXED16(x) ((fixed16_t)((x) * FIXED16_ONE))
+#define FIXED16_TO_FLOAT(x) ((x) / (float)FIXED16_ONE)
+
 // temperature, in Celsius
 typedef float temperature_t;
 typedef float floatms_t;
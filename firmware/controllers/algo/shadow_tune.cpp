@@ -0,0 +1,159 @@
+/**
+ * @file	shadow_tune.cpp
+ * @brief	shadow-mode second tune evaluated for A/B comparison on the dyno
+ *
+ * The active tune keeps control of the engine while a shadow tune is evaluated
+ * against the same sensor stream, with outputs logged but never actuated. The
+ * shadow tune is represented as int8 delta tables over the active VE and timing
+ * grids rather than complete second tables: the configuration image has no room
+ * for another table pair, a dyno A/B experiment is naturally expressed as "this
+ * region plus five percent", and sharing the axes means the shadow VE evaluates
+ * against the fuel cell which periodicFastCallback() has already resolved - see
+ * SharedTableCell. Per callback the shadow adds two bilinear blends and one
+ * ignition-axis cell resolve, with no binary searches at steady state.
+ *
+ *     set_shadow_tune_enabled <0/1>
+ *     set_shadow_ve_delta <load index> <rpm index> <delta percent>
+ *     set_shadow_timing_delta <load index> <rpm index> <delta degrees>
+ *     shadowinfo
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_SHADOW_TUNE
+
+#include "engine.h"
+#include "shadow_tune.h"
+#include "advance_map.h"
+
+#if !EFI_UNIT_TEST
+#include "eficonsole.h"
+#endif /* EFI_UNIT_TEST */
+
+#if EFI_TUNER_STUDIO
+#include "tunerstudio_configuration.h"
+extern TunerStudioOutputChannels tsOutputChannels;
+#endif /* EFI_TUNER_STUDIO */
+
+EXTERN_ENGINE;
+
+static Logging *logger;
+
+/**
+ * deltas are stored quantized, see the scale/offset Map3D constructor: 0.1 unit
+ * resolution over a -12.7..12.7 range covers any sane A/B experiment in 256 bytes
+ * per table
+ */
+#define SHADOW_DELTA_STORAGE_MULT 0.1f
+
+static int8_t shadowVeDelta[FUEL_RPM_COUNT][FUEL_LOAD_COUNT];
+static int8_t shadowTimingDelta[IGN_RPM_COUNT][IGN_LOAD_COUNT];
+
+static Map3D<FUEL_RPM_COUNT, FUEL_LOAD_COUNT, int8_t, float> shadowVeDeltaMap("shadow VE", SHADOW_DELTA_STORAGE_MULT, 0);
+static Map3D<IGN_RPM_COUNT, IGN_LOAD_COUNT, int8_t, float> shadowTimingDeltaMap("shadow timing", SHADOW_DELTA_STORAGE_MULT, 0);
+
+/**
+ * the ignition table keeps its own bin arrays so the timing delta needs its own
+ * resolved cell, the hint fields make that cheap at steady state
+ */
+static SharedTableCell<IGN_RPM_COUNT, IGN_LOAD_COUNT, float> shadowIgnitionCell;
+
+static bool shadowTuneEnabled = false;
+
+void setShadowTuneEnabled(bool enabled) {
+	shadowTuneEnabled = enabled;
+}
+
+static int8_t quantizeDelta(float value) {
+	float raw = value / SHADOW_DELTA_STORAGE_MULT;
+	return (int8_t)maxF(-127, minF(raw, 127));
+}
+
+void setShadowVeDelta(int loadIndex, int rpmIndex, float value) {
+	if (loadIndex < 0 || loadIndex >= FUEL_LOAD_COUNT || rpmIndex < 0 || rpmIndex >= FUEL_RPM_COUNT) {
+		warning(CUSTOM_ERR_6639, "shadow VE delta index [%d][%d]", loadIndex, rpmIndex);
+		return;
+	}
+	shadowVeDelta[rpmIndex][loadIndex] = quantizeDelta(value);
+}
+
+void setShadowTimingDelta(int loadIndex, int rpmIndex, float value) {
+	if (loadIndex < 0 || loadIndex >= IGN_LOAD_COUNT || rpmIndex < 0 || rpmIndex >= IGN_RPM_COUNT) {
+		warning(CUSTOM_ERR_6639, "shadow timing delta index [%d][%d]", loadIndex, rpmIndex);
+		return;
+	}
+	shadowTimingDelta[rpmIndex][loadIndex] = quantizeDelta(value);
+}
+
+void runShadowTune(const SharedTableCell<FUEL_RPM_COUNT, FUEL_LOAD_COUNT, float> &fuelCell, int rpm, float engineLoad DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (!shadowTuneEnabled) {
+		return;
+	}
+	// the delta table was initialized with the same bin arrays the caller resolved
+	// the cell against, axesMatch() would degenerate into a pointer compare
+	float veDelta = shadowVeDeltaMap.getValueAtCell(fuelCell);
+	float shadowVe = ENGINE(engineState.currentRawVE) + veDelta;
+	ENGINE(engineState.shadowVe) = shadowVe;
+
+	shadowIgnitionCell.resolve(config->ignitionRpmBins, config->ignitionLoadBins, rpm, engineLoad);
+	float timingDelta = shadowTimingDeltaMap.getValueAtCell(shadowIgnitionCell);
+	ENGINE(engineState.shadowTimingAdvance) = ENGINE(engineState.timingAdvance) + timingDelta;
+
+#if EFI_TUNER_STUDIO
+	if (engineConfiguration->debugMode == DBG_SHADOW_TUNE) {
+		tsOutputChannels.debugFloatField1 = shadowVe;
+		tsOutputChannels.debugFloatField2 = veDelta;
+		tsOutputChannels.debugFloatField3 = ENGINE(engineState.shadowTimingAdvance);
+		tsOutputChannels.debugFloatField4 = timingDelta;
+		// what the shadow tune would have injected: VE enters the speed-density
+		// fuel mass linearly so the active base fuel scales by the VE ratio
+		float activeVe = ENGINE(engineState.currentRawVE);
+		if (activeVe > 1) {
+			tsOutputChannels.debugFloatField5 = ENGINE(engineState.baseFuel) * shadowVe / activeVe;
+		}
+	}
+#endif /* EFI_TUNER_STUDIO */
+}
+
+#if !EFI_UNIT_TEST
+
+static void consoleSetShadowTuneEnabled(int value) {
+	setShadowTuneEnabled(value != 0);
+	scheduleMsg(logger, "shadow tune %s", boolToString(shadowTuneEnabled));
+}
+
+static void consoleSetShadowVeDelta(const char *loadStr, const char *rpmStr, const char *valueStr) {
+	setShadowVeDelta(atoi(loadStr), atoi(rpmStr), atoff(valueStr));
+}
+
+static void consoleSetShadowTimingDelta(const char *loadStr, const char *rpmStr, const char *valueStr) {
+	setShadowTimingDelta(atoi(loadStr), atoi(rpmStr), atoff(valueStr));
+}
+
+static void showShadowInfo(void) {
+	scheduleMsg(logger, "shadow tune %s", boolToString(shadowTuneEnabled));
+	scheduleMsg(logger, "shadow VE=%.2f%% (active %.2f%%) timing=%.2f (active %.2f)",
+			engine->engineState.shadowVe,
+			engine->engineState.currentRawVE,
+			engine->engineState.shadowTimingAdvance,
+			engine->engineState.timingAdvance);
+}
+
+#endif /* EFI_UNIT_TEST */
+
+void initShadowTune(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	logger = sharedLogger;
+	shadowVeDeltaMap.init(shadowVeDelta, config->veLoadBins, config->veRpmBins);
+	shadowTimingDeltaMap.init(shadowTimingDelta, config->ignitionLoadBins, config->ignitionRpmBins);
+#if !EFI_UNIT_TEST
+	addConsoleActionI("set_shadow_tune_enabled", consoleSetShadowTuneEnabled);
+	addConsoleActionSSS("set_shadow_ve_delta", consoleSetShadowVeDelta);
+	addConsoleActionSSS("set_shadow_timing_delta", consoleSetShadowTimingDelta);
+	addConsoleAction("shadowinfo", showShadowInfo);
+#endif /* EFI_UNIT_TEST */
+}
+
+#endif /* EFI_SHADOW_TUNE */
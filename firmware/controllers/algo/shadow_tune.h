@@ -0,0 +1,22 @@
+/**
+ * @file	shadow_tune.h
+ * @brief	shadow-mode second tune evaluated for A/B comparison, see shadow_tune.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "engine.h"
+#include "table_helper.h"
+
+void initShadowTune(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX);
+/**
+ * @param fuelCell cell already resolved against the active VE axes, see
+ * EngineState::periodicFastCallback()
+ */
+void runShadowTune(const SharedTableCell<FUEL_RPM_COUNT, FUEL_LOAD_COUNT, float> &fuelCell, int rpm, float engineLoad DECLARE_ENGINE_PARAMETER_SUFFIX);
+void setShadowTuneEnabled(bool enabled);
+void setShadowVeDelta(int loadIndex, int rpmIndex, float value);
+void setShadowTimingDelta(int loadIndex, int rpmIndex, float value);
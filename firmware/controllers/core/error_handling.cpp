@@ -8,6 +8,8 @@
 #include "global.h"
 #include "os_access.h"
 #include "engine.h"
+#include "postmortem_ring.h"
+#include "flight_recorder.h"
 
 #if EFI_SIMULATOR || EFI_PROD_CODE
 //todo: move into simulator global
@@ -65,6 +67,8 @@ void chDbgPanic3(const char *msg, const char * file, int line) {
 		return;
 	dbg_panic_file = file;
 	dbg_panic_line = line;
+	postmortemRecordFatal(msg, file, line);
+	flightRecorderFreeze();
 #if CH_DBG_SYSTEM_STATE_CHECK
 	ch.dbg.panic_msg = msg;
 #endif /* CH_DBG_SYSTEM_STATE_CHECK */
@@ -135,6 +139,7 @@ bool warning(obd_code_e code, const char *fmt, ...) {
 		return false;
 	}
 	engine->engineState.warnings.addWarningCode(code);
+	postmortemRecordWarning(code);
 
 	// todo: move this logic into WarningCodeState?
 	efitimesec_t now = getTimeNowSeconds();
@@ -164,6 +169,71 @@ char *getWarning(void) {
 	return warningBuffer;
 }
 
+// power of two so that the modulo below is a cheap mask
+#define DEFERRED_WARNING_RING_SIZE 16
+
+typedef struct {
+	obd_code_e code;
+	const char *fmt;
+	const char *msg;
+	float param1;
+	float param2;
+	/**
+	 * set by the producer only once the whole slot is filled so that the consumer
+	 * never formats a half-written entry
+	 */
+	volatile bool isReady;
+} deferred_warning_s;
+
+static deferred_warning_s deferredWarningRing[DEFERRED_WARNING_RING_SIZE];
+static volatile unsigned int deferredWriteIndex = 0;
+static unsigned int deferredReadIndex = 0;
+// number of warnings we shed completely because the console thread was too far behind
+int deferredWarningOverflowCounter = 0;
+
+bool warningDeferred(obd_code_e code, const char *fmt, const char *msg, float param1, float param2) {
+	if (hasFirmwareErrorFlag)
+		return true;
+#if EFI_SIMULATOR || EFI_PROD_CODE
+	while (true) {
+		unsigned int index = deferredWriteIndex;
+		if (index - deferredReadIndex >= DEFERRED_WARNING_RING_SIZE) {
+			// consumer is behind, we shed the whole warning rather than spin or format here
+			deferredWarningOverflowCounter++;
+			return false;
+		}
+		// claim the slot atomically, we can be invoked from any interrupt or thread context
+		if (__sync_bool_compare_and_swap(&deferredWriteIndex, index, index + 1)) {
+			deferred_warning_s *slot = &deferredWarningRing[index % DEFERRED_WARNING_RING_SIZE];
+			slot->code = code;
+			slot->fmt = fmt;
+			slot->msg = msg;
+			slot->param1 = param1;
+			slot->param2 = param2;
+			slot->isReady = true;
+			return false;
+		}
+	}
+#else
+	// in the test environment formatting cost is irrelevant
+	return warning(code, fmt, msg, param1, param2);
+#endif /* EFI_SIMULATOR || EFI_PROD_CODE */
+}
+
+void publishDeferredWarnings(void) {
+	while (deferredReadIndex != deferredWriteIndex) {
+		deferred_warning_s *slot = &deferredWarningRing[deferredReadIndex % DEFERRED_WARNING_RING_SIZE];
+		if (!slot->isReady) {
+			// producer claimed this slot but has not finished filling it, try again next period
+			break;
+		}
+		// extra varargs beyond the conversions in 'fmt' are harmless per printf semantics
+		warning(slot->code, slot->fmt, slot->msg, slot->param1, slot->param2);
+		slot->isReady = false;
+		deferredReadIndex++;
+	}
+}
+
 
 #if EFI_CLOCK_LOCKS
 uint32_t lastLockTime;
@@ -243,6 +313,8 @@ void firmwareError(obd_code_e code, const char *fmt, ...) {
 		// todo: reuse warning buffer helper method
 		firmwareErrorMessageStream.buffer[firmwareErrorMessageStream.eos] = 0; // need to terminate explicitly
 	}
+	postmortemRecordFatal((const char *) errorMessageBuffer, "firmwareError", (int) code);
+	flightRecorderFreeze();
 #else
 	printf("firmwareError [%s]\r\n", fmt);
 
@@ -24,6 +24,22 @@ extern "C"
  */
 bool warning(obd_code_e code, const char *fmt, ...);
 
+/**
+ * Hot-path flavor of warning(): only the error code, the format literal pointer and raw
+ * operands are captured into a lock-free ring here, the printf-style formatting happens
+ * later on the low-priority console thread, see publishDeferredWarnings(). A burst of
+ * warnings during sync loss would otherwise spend milliseconds formatting exactly when
+ * the CPU is busiest.
+ *
+ * 'fmt' MUST be a string literal with an optional leading %s followed by up to two
+ * float conversions, extra conversion specifiers are not supported.
+ */
+bool warningDeferred(obd_code_e code, const char *fmt, const char *msg, float param1, float param2);
+/**
+ * drains the deferred warning ring, invoked periodically from the console thread
+ */
+void publishDeferredWarnings(void);
+
 typedef uint8_t fatal_msg_t[200];
 /**
  * Something really bad had happened - firmware cannot function, we cannot run the engine
@@ -21,6 +21,7 @@
 #include "fsio_core.h"
 #include "fsio_impl.h"
 #include "adc_inputs.h"
+#include "fast_math.h"
 
 extern fsio8_Map3D_f32t fsioTable1;
 extern fsio8_Map3D_u8t fsioTable2;
@@ -58,6 +59,10 @@ static LENameOrdinalPair leMax(LE_METHOD_MAX, "max");
 static LENameOrdinalPair leMin(LE_METHOD_MIN, "min");
 static LENameOrdinalPair leIf(LE_METHOD_IF, "if");
 static LENameOrdinalPair leSelf(LE_METHOD_SELF, "self");
+static LENameOrdinalPair leHysteresis(LE_METHOD_HYSTERESIS, "hysteresis");
+static LENameOrdinalPair leOnDelay(LE_METHOD_ON_DELAY, "on_delay");
+static LENameOrdinalPair leOffDelay(LE_METHOD_OFF_DELAY, "off_delay");
+static LENameOrdinalPair leEdgeLatch(LE_METHOD_EDGE_LATCH, "edge_latch");
 
 LENameOrdinalPair::LENameOrdinalPair(le_action_e action, const char *name) {
 	this->action = action;
@@ -139,26 +144,35 @@ void LECalculator::push(le_action_e action, float value) {
  * @return true in case of error, false otherwise
  */
 bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// for the stateful methods the state word is the otherwise unused fValue
+	return processAction(element->action, element->fValue, &element->fValue PASS_ENGINE_PARAMETER_SUFFIX);
+}
+
+/**
+ * Shared between linked-list and compiled program evaluation
+ * @return true in case of error, false otherwise
+ */
+bool LECalculator::processAction(le_action_e action, float fValue, float *state DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #if EFI_PROD_CODE
 	efiAssert(CUSTOM_ERR_ASSERT, getCurrentRemainingStack() > 64, "FSIO logic", false);
 #endif
-	switch (element->action) {
+	switch (action) {
 
 	case LE_NUMERIC_VALUE:
-		push(element->action, element->fValue);
+		push(action, fValue);
 		break;
 	case LE_OPERATOR_AND: {
 		float v1 = pop(LE_OPERATOR_AND);
 		float v2 = pop(LE_OPERATOR_AND);
 
-		push(element->action, float2bool(v1) && float2bool(v2));
+		push(action, float2bool(v1) && float2bool(v2));
 	}
 		break;
 	case LE_OPERATOR_OR: {
 		float v1 = pop(LE_OPERATOR_OR);
 		float v2 = pop(LE_OPERATOR_OR);
 
-		push(element->action, float2bool(v1) || float2bool(v2));
+		push(action, float2bool(v1) || float2bool(v2));
 	}
 		break;
 	case LE_OPERATOR_LESS: {
@@ -166,12 +180,12 @@ bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SU
 		float v2 = pop(LE_OPERATOR_LESS);
 		float v1 = pop(LE_OPERATOR_LESS);
 
-		push(element->action, v1 < v2);
+		push(action, v1 < v2);
 	}
 		break;
 	case LE_OPERATOR_NOT: {
 		float v = pop(LE_OPERATOR_NOT);
-		push(element->action, !float2bool(v));
+		push(action, !float2bool(v));
 	}
 		break;
 	case LE_OPERATOR_MORE: {
@@ -179,7 +193,7 @@ bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SU
 		float v2 = pop(LE_OPERATOR_MORE);
 		float v1 = pop(LE_OPERATOR_MORE);
 
-		push(element->action, v1 > v2);
+		push(action, v1 > v2);
 	}
 		break;
 	case LE_OPERATOR_ADDITION: {
@@ -187,7 +201,7 @@ bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SU
 		float v2 = pop(LE_OPERATOR_MORE);
 		float v1 = pop(LE_OPERATOR_MORE);
 
-		push(element->action, v1 + v2);
+		push(action, v1 + v2);
 	}
 		break;
 	case LE_OPERATOR_SUBTRACTION: {
@@ -195,7 +209,7 @@ bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SU
 		float v2 = pop(LE_OPERATOR_MORE);
 		float v1 = pop(LE_OPERATOR_MORE);
 
-		push(element->action, v1 - v2);
+		push(action, v1 - v2);
 	}
 		break;
 	case LE_OPERATOR_MULTIPLICATION: {
@@ -203,7 +217,7 @@ bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SU
 		float v2 = pop(LE_OPERATOR_MORE);
 		float v1 = pop(LE_OPERATOR_MORE);
 
-		push(element->action, v1 * v2);
+		push(action, v1 * v2);
 	}
 		break;
 	case LE_OPERATOR_DIVISION: {
@@ -211,7 +225,7 @@ bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SU
 		float v2 = pop(LE_OPERATOR_MORE);
 		float v1 = pop(LE_OPERATOR_MORE);
 
-		push(element->action, v1 / v2);
+		push(action, v1 * efiRecipf(v2));
 	}
 		break;
 	case LE_OPERATOR_LESS_OR_EQUAL: {
@@ -219,7 +233,7 @@ bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SU
 		float v2 = pop(LE_OPERATOR_LESS_OR_EQUAL);
 		float v1 = pop(LE_OPERATOR_LESS_OR_EQUAL);
 
-		push(element->action, v1 <= v2);
+		push(action, v1 <= v2);
 	}
 		break;
 	case LE_OPERATOR_MORE_OR_EQUAL: {
@@ -227,7 +241,7 @@ bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SU
 		float v2 = pop(LE_OPERATOR_MORE_OR_EQUAL);
 		float v1 = pop(LE_OPERATOR_MORE_OR_EQUAL);
 
-		push(element->action, v1 >= v2);
+		push(action, v1 >= v2);
 	}
 		break;
 	case LE_METHOD_IF: {
@@ -235,28 +249,91 @@ bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SU
 		float vFalse = pop(LE_METHOD_IF);
 		float vTrue = pop(LE_METHOD_IF);
 		float vCond = pop(LE_METHOD_IF);
-		push(element->action, vCond != 0 ? vTrue : vFalse);
+		push(action, vCond != 0 ? vTrue : vFalse);
 	}
 		break;
 	case LE_METHOD_MAX: {
 		float v2 = pop(LE_METHOD_MAX);
 		float v1 = pop(LE_METHOD_MAX);
-		push(element->action, maxF(v1, v2));
+		push(action, maxF(v1, v2));
 	}
 		break;
 	case LE_METHOD_MIN: {
 		float v2 = pop(LE_METHOD_MIN);
 		float v1 = pop(LE_METHOD_MIN);
-		push(element->action, minF(v1, v2));
+		push(action, minF(v1, v2));
+	}
+		break;
+	case LE_METHOD_HYSTERESIS: {
+		// elements on stack are in reverse order
+		float hi = pop(LE_METHOD_HYSTERESIS);
+		float lo = pop(LE_METHOD_HYSTERESIS);
+		float value = pop(LE_METHOD_HYSTERESIS);
+		float result;
+		if (value >= hi) {
+			result = 1;
+		} else if (value <= lo) {
+			result = 0;
+		} else {
+			// in the dead band we keep the previous output, initially off
+			result = cisnan(*state) ? 0 : *state;
+		}
+		*state = result;
+		push(action, result);
+	}
+		break;
+	case LE_METHOD_ON_DELAY: {
+		float delaySeconds = pop(LE_METHOD_ON_DELAY);
+		bool input = float2bool(pop(LE_METHOD_ON_DELAY));
+		float now = getEngineValue(LE_METHOD_TIME_SINCE_BOOT PASS_ENGINE_PARAMETER_SUFFIX);
+		if (!input) {
+			// state is the moment input became true, NaN while input is false
+			*state = NAN;
+			push(action, 0);
+		} else {
+			if (cisnan(*state)) {
+				*state = now;
+			}
+			push(action, now - *state >= delaySeconds);
+		}
+	}
+		break;
+	case LE_METHOD_OFF_DELAY: {
+		float delaySeconds = pop(LE_METHOD_OFF_DELAY);
+		bool input = float2bool(pop(LE_METHOD_OFF_DELAY));
+		float now = getEngineValue(LE_METHOD_TIME_SINCE_BOOT PASS_ENGINE_PARAMETER_SUFFIX);
+		if (input) {
+			// state is the moment input was last seen true
+			*state = now;
+			push(action, 1);
+		} else {
+			push(action, !cisnan(*state) && now - *state < delaySeconds);
+		}
+	}
+		break;
+	case LE_METHOD_EDGE_LATCH: {
+		bool reset = float2bool(pop(LE_METHOD_EDGE_LATCH));
+		bool input = float2bool(pop(LE_METHOD_EDGE_LATCH));
+		// state packs the latch in bit 0 and the previous input in bit 1
+		int packed = cisnan(*state) ? 0 : (int) *state;
+		bool latched = (packed & 1) != 0;
+		bool previousInput = (packed & 2) != 0;
+		if (reset) {
+			latched = false;
+		} else if (input && !previousInput) {
+			latched = true;
+		}
+		*state = (latched ? 1 : 0) + (input ? 2 : 0);
+		push(action, latched);
 	}
 		break;
 	case LE_METHOD_FSIO_SETTING: {
 		float humanIndex = pop(LE_METHOD_FSIO_SETTING);
 		int index = (int) humanIndex - 1;
 		if (index >= 0 && index < FSIO_COMMAND_COUNT) {
-			push(element->action, CONFIG(fsio_setting)[index]);
+			push(action, CONFIG(fsio_setting)[index]);
 		} else {
-			push(element->action, NAN);
+			push(action, NAN);
 		}
 	}
 		break;
@@ -266,16 +343,16 @@ bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SU
 		float xValue = pop(LE_METHOD_FSIO_TABLE);
 		int index = (int) i;
 		if (index < 1 || index > MAX_TABLE_INDEX) {
-			push(element->action, NAN);
+			push(action, NAN);
 		} else {
 			if (index == 1) {
 				fsio8_Map3D_f32t *t = &fsioTable1;
 
-				push(element->action, t->getValue(xValue, yValue));
+				push(action, t->getValue(xValue, yValue));
 			} else {
 				fsio8_Map3D_u8t *t = fsio8t_tables[index];
 
-				push(element->action, t->getValue(xValue, yValue));
+				push(action, t->getValue(xValue, yValue));
 			}
 		}
 	}
@@ -284,23 +361,26 @@ bool LECalculator::processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SU
 		// todo: implement code for digital inout!!!
 	case LE_METHOD_FSIO_ANALOG_INPUT:
 		// todo: start taking index parameter!!!
-		push(element->action, getVoltage("fsio", engineConfiguration->fsioAdc[0] PASS_ENGINE_PARAMETER_SUFFIX));
+		push(action, getVoltage("fsio", engineConfiguration->fsioAdc[0] PASS_ENGINE_PARAMETER_SUFFIX));
 		break;
 	case LE_METHOD_KNOCK:
-		push(element->action, ENGINE(knockCount));
+		push(action, ENGINE(knockCount));
 		break;
 	case LE_UNDEFINED:
 		warning(CUSTOM_UNKNOWN_FSIO, "FSIO undefined action");
 		return true;
 	default:
-		push(element->action, getEngineValue(element->action PASS_ENGINE_PARAMETER_SUFFIX));
+		push(action, getEngineValue(action PASS_ENGINE_PARAMETER_SUFFIX));
 	}
 	return false;
 }
 
 float LECalculator::getValue2(float selfValue, LEElement *fistElementInList DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	reset(fistElementInList);
-	return getValue(selfValue PASS_ENGINE_PARAMETER_SUFFIX);
+	uint32_t startNt = getTimeNowLowerNt();
+	float result = getValue(selfValue PASS_ENGINE_PARAMETER_SUFFIX);
+	lastEvalDurationNt = getTimeNowLowerNt() - startNt;
+	return result;
 }
 
 bool LECalculator::isEmpty() const {
@@ -321,7 +401,7 @@ float LECalculator::getValue(float selfValue DECLARE_ENGINE_PARAMETER_SUFFIX) {
 		efiAssert(CUSTOM_ERR_ASSERT, counter < 200, "FSIOcount", NAN); // just in case
 
 		if (element->action == LE_METHOD_SELF) {
-			push(element->action, selfValue);
+			push(LE_METHOD_SELF, selfValue);
 		} else {
 			bool isError = processElement(element PASS_ENGINE_PARAMETER_SUFFIX);
 			if (isError) {
@@ -339,6 +419,41 @@ float LECalculator::getValue(float selfValue DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	return stack.pop();
 }
 
+/**
+ * Same RPN semantics as getValue() but iterating a contiguous instruction array,
+ * this is the hot path executed at FSIO_FREQUENCY for each output
+ */
+float LECalculator::getCompiledValue(float selfValue, le_instruction_s *program DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (program == nullptr) {
+		warning(CUSTOM_NO_FSIO, "no FSIO code");
+		return NAN;
+	}
+	uint32_t startNt = getTimeNowLowerNt();
+	stack.reset();
+	currentCalculationLogPosition = 0;
+
+	for (le_instruction_s *instruction = program; instruction->opcode != LE_UNDEFINED; instruction++) {
+		le_action_e action = (le_action_e) instruction->opcode;
+		if (action == LE_METHOD_SELF) {
+			push(LE_METHOD_SELF, selfValue);
+		} else {
+			// the immediate word doubles as the state word for stateful methods
+			bool isError = processAction(action, instruction->immediate, &instruction->immediate PASS_ENGINE_PARAMETER_SUFFIX);
+			if (isError) {
+				// error already reported
+				lastEvalDurationNt = getTimeNowLowerNt() - startNt;
+				return NAN;
+			}
+		}
+	}
+	lastEvalDurationNt = getTimeNowLowerNt() - startNt;
+	if (stack.size() != 1) {
+		warning(CUSTOM_FSIO_STACK_SIZE, "unexpected FSIO stack size: %d", stack.size());
+		return NAN;
+	}
+	return stack.pop();
+}
+
 LEElementPool::LEElementPool(LEElement *pool, int size) {
 	this->pool = pool;
 	this->size = size;
@@ -364,6 +479,174 @@ LEElement *LEElementPool::next() {
 	return result;
 }
 
+LEBytecodeArena::LEBytecodeArena(le_instruction_s *storage, int capacity) {
+	this->storage = storage;
+	this->capacity = capacity;
+	reset();
+}
+
+void LEBytecodeArena::reset() {
+	index = 0;
+}
+
+int LEBytecodeArena::getSize() const {
+	return index;
+}
+
+/**
+ * Pure operators have no side effects and depend only on their operands, those are
+ * the ones we are allowed to evaluate at compile time
+ * @return operand count, or zero if the action is not foldable
+ */
+static int getFoldableArity(le_action_e action) {
+	switch (action) {
+	case LE_OPERATOR_NOT:
+		return 1;
+	case LE_OPERATOR_AND:
+	case LE_OPERATOR_OR:
+	case LE_OPERATOR_LESS:
+	case LE_OPERATOR_MORE:
+	case LE_OPERATOR_LESS_OR_EQUAL:
+	case LE_OPERATOR_MORE_OR_EQUAL:
+	case LE_OPERATOR_ADDITION:
+	case LE_OPERATOR_SUBTRACTION:
+	case LE_OPERATOR_MULTIPLICATION:
+	case LE_OPERATOR_DIVISION:
+	case LE_METHOD_MAX:
+	case LE_METHOD_MIN:
+		return 2;
+	case LE_METHOD_IF:
+		return 3;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * Mirrors processAction() for the pure operators, keep the two in sync
+ */
+static float foldConstant(le_action_e action, float v1, float v2, float v3) {
+	switch (action) {
+	case LE_OPERATOR_NOT:
+		return !float2bool(v1);
+	case LE_OPERATOR_AND:
+		return float2bool(v1) && float2bool(v2);
+	case LE_OPERATOR_OR:
+		return float2bool(v1) || float2bool(v2);
+	case LE_OPERATOR_LESS:
+		return v1 < v2;
+	case LE_OPERATOR_MORE:
+		return v1 > v2;
+	case LE_OPERATOR_LESS_OR_EQUAL:
+		return v1 <= v2;
+	case LE_OPERATOR_MORE_OR_EQUAL:
+		return v1 >= v2;
+	case LE_OPERATOR_ADDITION:
+		return v1 + v2;
+	case LE_OPERATOR_SUBTRACTION:
+		return v1 - v2;
+	case LE_OPERATOR_MULTIPLICATION:
+		return v1 * v2;
+	case LE_OPERATOR_DIVISION:
+		return v1 / v2;
+	case LE_METHOD_MAX:
+		return maxF(v1, v2);
+	case LE_METHOD_MIN:
+		return minF(v1, v2);
+	case LE_METHOD_IF:
+		return v1 != 0 ? v2 : v3;
+	default:
+		return NAN;
+	}
+}
+
+le_instruction_s *LEBytecodeArena::compile(LEElement *first) {
+	if (first == nullptr) {
+		return nullptr;
+	}
+	// one extra slot for the LE_UNDEFINED terminator, folding can only make it shorter
+	int length = 1;
+	for (LEElement *element = first; element != nullptr; element = element->next) {
+		length++;
+	}
+	if (index + length > capacity) {
+		// todo: this should not be a fatal error, just an error
+		firmwareError(CUSTOM_ERR_FSIO_POOL, "FSIO bytecode arena overflow");
+		return nullptr;
+	}
+	le_instruction_s *program = &storage[index];
+	int emitted = 0;
+	for (LEElement *element = first; element != nullptr; element = element->next) {
+		le_action_e action = element->action;
+		/**
+		 * constant folding: in RPN a pure operator whose operands are all numeric
+		 * literals is immediately preceded by those literals, so we can evaluate it
+		 * right here and emit a single literal instead. Nested constant subtrees
+		 * like "2 3 + 4 *" collapse bottom-up as we go.
+		 */
+		int arity = getFoldableArity(action);
+		bool allOperandsConstant = arity > 0 && emitted >= arity;
+		for (int i = 0; allOperandsConstant && i < arity; i++) {
+			allOperandsConstant = program[emitted - 1 - i].opcode == LE_NUMERIC_VALUE;
+		}
+		if (allOperandsConstant) {
+			float v1 = program[emitted - arity].immediate;
+			float v2 = arity > 1 ? program[emitted - arity + 1].immediate : NAN;
+			float v3 = arity > 2 ? program[emitted - arity + 2].immediate : NAN;
+			emitted -= arity;
+			program[emitted].opcode = LE_NUMERIC_VALUE;
+			program[emitted].immediate = foldConstant(action, v1, v2, v3);
+			emitted++;
+		} else {
+			program[emitted].opcode = (uint16_t) action;
+			program[emitted].immediate = element->fValue;
+			emitted++;
+		}
+	}
+	program[emitted].opcode = LE_UNDEFINED;
+	program[emitted].immediate = NAN;
+	index += emitted + 1;
+	return program;
+}
+
+uint32_t getProgramDependencyMask(const le_instruction_s *program) {
+	if (program == nullptr) {
+		return FSIO_DEPENDENCY_ALL;
+	}
+	uint32_t mask = 0;
+	for (const le_instruction_s *instruction = program; instruction->opcode != LE_UNDEFINED; instruction++) {
+		le_action_e action = (le_action_e) instruction->opcode;
+		if (action < LE_METHOD_RPM) {
+			// literals and operators read nothing
+			continue;
+		}
+		switch (action) {
+		case LE_METHOD_SELF:
+		case LE_METHOD_FSIO_TABLE:
+		case LE_METHOD_FSIO_SETTING:
+		case LE_METHOD_FSIO_ANALOG_INPUT:
+		case LE_METHOD_FSIO_DIGITAL_INPUT:
+		case LE_METHOD_KNOCK:
+			// these depend on the stack or on state outside the sensor snapshot
+			return FSIO_DEPENDENCY_ALL;
+		case LE_METHOD_HYSTERESIS:
+		case LE_METHOD_ON_DELAY:
+		case LE_METHOD_OFF_DELAY:
+		case LE_METHOD_EDGE_LATCH:
+			// stateful methods advance with time, not only with their inputs
+			return FSIO_DEPENDENCY_ALL;
+		default:
+			break;
+		}
+		if (action <= LE_METHOD_FSIO_SETTING) {
+			mask |= 1u << (action - LE_METHOD_RPM);
+		}
+		// four-digit fsio_setting getters are configuration reads, a tune change
+		// recompiles the programs anyway so those are not tracked
+	}
+	return mask;
+}
+
 bool isNumeric(const char* line) {
 	return line[0] >= '0' && line[0] <= '9';
 }
@@ -56,6 +56,18 @@ typedef enum {
 	LE_METHOD_IN_SHUTDOWN = 122,
 	LE_METHOD_FSIO_DIGITAL_INPUT = 123,
 	LE_METHOD_FSIO_SETTING = 124,
+	/**
+	 * stateful methods: one word of state lives in the program itself, in the
+	 * otherwise unused value word of the instruction - see processAction
+	 */
+	// "value lo hi hysteresis": 1 above hi, 0 below lo, previous output in between
+	LE_METHOD_HYSTERESIS = 125,
+	// "input seconds on_delay": 1 only once input has been true for the given time
+	LE_METHOD_ON_DELAY = 126,
+	// "input seconds off_delay": stays 1 for the given time after input drops
+	LE_METHOD_OFF_DELAY = 127,
+	// "input reset edge_latch": latches on input rising edge, cleared by reset
+	LE_METHOD_EDGE_LATCH = 128,
 
 #include "fsio_enums_generated.def"
 
@@ -92,6 +104,57 @@ private:
 };
 
 
+/**
+ * Compiled FSIO instruction: the same RPN program as the LEElement linked list but
+ * flattened into a contiguous array of 8-byte opcode/immediate pairs. Linked
+ * 20-byte LEElement nodes are kept for parsing and diagnostics, the per-tick
+ * evaluation loop runs over these instead - sequential access is much friendlier
+ * to the data cache than pointer-chasing.
+ *
+ * A program is terminated by an LE_UNDEFINED opcode.
+ */
+typedef struct {
+	uint16_t opcode;
+	/**
+	 * literal for LE_NUMERIC_VALUE instructions, one word of mutable state for
+	 * the stateful methods, unused otherwise
+	 */
+	float immediate;
+} le_instruction_s;
+
+/**
+ * An arena holding compiled FSIO programs back to back, see LEElementPool for the
+ * matching parse-tree storage
+ */
+class LEBytecodeArena {
+public:
+	LEBytecodeArena(le_instruction_s *storage, int capacity);
+	/**
+	 * Flattens a parsed linked list into contiguous instructions
+	 * @return program start, or NULL if the expression is empty or the arena is full
+	 */
+	le_instruction_s *compile(LEElement *first);
+	void reset();
+	int getSize() const;
+private:
+	le_instruction_s *storage;
+	int index;
+	int capacity;
+};
+
+/**
+ * magic dependency mask meaning 'evaluate every tick', used for programs reading
+ * state we cannot track: self feedback, tables, parametrized inputs
+ */
+#define FSIO_DEPENDENCY_ALL 0xffffffff
+
+/**
+ * @return bit mask of sensor methods read by a compiled program, bit index is
+ * (action - LE_METHOD_RPM). Event-driven evaluation in fsio_impl.cpp skips
+ * programs none of whose inputs have changed.
+ */
+uint32_t getProgramDependencyMask(const le_instruction_s *program);
+
 #define MAX_STACK_DEPTH 32
 
 typedef FLStack<float, MAX_STACK_DEPTH> calc_stack_t;
@@ -103,6 +166,10 @@ public:
 	LECalculator();
 	float getValue(float selfValue DECLARE_ENGINE_PARAMETER_SUFFIX);
 	float getValue2(float selfValue, LEElement *fistElementInList DECLARE_ENGINE_PARAMETER_SUFFIX);
+	/**
+	 * Evaluates a compiled program, see LEBytecodeArena
+	 */
+	float getCompiledValue(float selfValue, le_instruction_s *program DECLARE_ENGINE_PARAMETER_SUFFIX);
 	void add(LEElement *element);
 	bool isEmpty() const;
 	void reset();
@@ -110,9 +177,16 @@ public:
 	le_action_e calcLogAction[MAX_CALC_LOG];
 	float calcLogValue[MAX_CALC_LOG];
 	int currentCalculationLogPosition;
+	/**
+	 * profiling: duration of the most recent getValue2/getCompiledValue run in
+	 * getTimeNowLowerNt() ticks - CPU cycles on STM32. Accumulated per slot by
+	 * fsio_impl.cpp and reported by 'fsioinfo'.
+	 */
+	uint32_t lastEvalDurationNt = 0;
 private:
 	void push(le_action_e action, float value);
 	bool processElement(LEElement *element DECLARE_ENGINE_PARAMETER_SUFFIX);
+	bool processAction(le_action_e action, float fValue, float *state DECLARE_ENGINE_PARAMETER_SUFFIX);
 	float pop(le_action_e action);
 	LEElement *first;
 	calc_stack_t stack;
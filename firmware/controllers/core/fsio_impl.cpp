@@ -23,6 +23,15 @@
 #include "efi_gpio.h"
 #include "pwm_generator_logic.h"
 
+// native system logic and event-driven evaluation need the real getEngineValue,
+// unit tests mock that one
+#if !(EFI_PROD_CODE || EFI_SIMULATOR)
+#undef EFI_USE_NATIVE_SYSTEM_FSIO
+#define EFI_USE_NATIVE_SYSTEM_FSIO FALSE
+#undef EFI_FSIO_EVENT_DRIVEN
+#define EFI_FSIO_EVENT_DRIVEN FALSE
+#endif
+
 /**
  * in case of zero frequency pin is operating as simple on/off. '1' for ON and '0' for OFF
  *
@@ -87,13 +96,27 @@ LEElementPool sysPool(sysElements, SYS_ELEMENT_POOL_SIZE);
 static LEElement userElements[UD_ELEMENT_POOL_SIZE] CCM_OPTIONAL;
 LEElementPool userPool(userElements, UD_ELEMENT_POOL_SIZE);
 
+/**
+ * parsed linked lists are flattened into these arenas, the per-tick evaluation
+ * runs over the compiled programs - see LEBytecodeArena
+ */
+#define SYS_BYTECODE_ARENA_SIZE 96
+#define UD_BYTECODE_ARENA_SIZE 160
+
+static le_instruction_s sysInstructions[SYS_BYTECODE_ARENA_SIZE] CCM_OPTIONAL;
+static LEBytecodeArena sysCode(sysInstructions, SYS_BYTECODE_ARENA_SIZE);
+
+static le_instruction_s userInstructions[UD_BYTECODE_ARENA_SIZE] CCM_OPTIONAL;
+static LEBytecodeArena userCode(userInstructions, UD_BYTECODE_ARENA_SIZE);
+
 class FsioPointers {
 public:
 	FsioPointers();
 	LEElement * fsioLogics[FSIO_COMMAND_COUNT];
+	le_instruction_s * fsioPrograms[FSIO_COMMAND_COUNT];
 };
 
-FsioPointers::FsioPointers() : fsioLogics() {
+FsioPointers::FsioPointers() : fsioLogics(), fsioPrograms() {
 }
 
 static FsioPointers state;
@@ -104,8 +127,14 @@ static LEElement * radiatorFanLogic;
 static LEElement * alternatorLogic;
 static LEElement * starterRelayLogic;
 
+static le_instruction_s * acRelayProgram;
+static le_instruction_s * fuelPumpProgram;
+static le_instruction_s * radiatorFanProgram;
+static le_instruction_s * starterRelayProgram;
+
 #if EFI_MAIN_RELAY_CONTROL
 static LEElement * mainRelayLogic;
+static le_instruction_s * mainRelayProgram;
 #endif /* EFI_MAIN_RELAY_CONTROL */
 
 EXTERN_ENGINE
@@ -114,7 +143,50 @@ EXTERN_ENGINE
 static Logging *logger;
 #if EFI_PROD_CODE || EFI_SIMULATOR
 
+/**
+ * One sensor snapshot shared by the whole runFsio() batch: the first program to ask
+ * for a value fetches it, every following program within the same tick gets the
+ * cached copy. Besides skipping redundant fetches this makes all outputs of one
+ * tick see the same engine state - previously two relays comparing the same
+ * sensor could disagree within a single tick.
+ *
+ * Covers the sensor methods, the four-digit fsio_setting getters are plain
+ * configuration reads and bypass the snapshot.
+ */
+#define FSIO_SNAPSHOT_FIRST LE_METHOD_RPM
+#define FSIO_SNAPSHOT_SIZE (LE_METHOD_FSIO_SETTING - LE_METHOD_RPM + 1)
+
+static float engineValueSnapshot[FSIO_SNAPSHOT_SIZE];
+static bool engineValueSnapshotValid[FSIO_SNAPSHOT_SIZE];
+/**
+ * only the periodic batch uses the snapshot, console 'rpn_eval' always reads fresh values
+ */
+static bool isBatchEvaluation = false;
+
+static void startSensorSnapshot(void) {
+	memset(engineValueSnapshotValid, 0, sizeof(engineValueSnapshotValid));
+	isBatchEvaluation = true;
+}
+
+static void endSensorSnapshot(void) {
+	isBatchEvaluation = false;
+}
+
+static float getFreshEngineValue(le_action_e action DECLARE_ENGINE_PARAMETER_SUFFIX);
+
 float getEngineValue(le_action_e action DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (isBatchEvaluation && action >= FSIO_SNAPSHOT_FIRST && action < FSIO_SNAPSHOT_FIRST + FSIO_SNAPSHOT_SIZE) {
+		int snapshotIndex = action - FSIO_SNAPSHOT_FIRST;
+		if (!engineValueSnapshotValid[snapshotIndex]) {
+			engineValueSnapshot[snapshotIndex] = getFreshEngineValue(action PASS_ENGINE_PARAMETER_SUFFIX);
+			engineValueSnapshotValid[snapshotIndex] = true;
+		}
+		return engineValueSnapshot[snapshotIndex];
+	}
+	return getFreshEngineValue(action PASS_ENGINE_PARAMETER_SUFFIX);
+}
+
+static float getFreshEngineValue(le_action_e action DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	efiAssert(CUSTOM_ERR_ASSERT, engine!=NULL, "getLEValue", NAN);
 	switch (action) {
 	case LE_METHOD_FAN:
@@ -158,6 +230,10 @@ float getEngineValue(le_action_e action DECLARE_ENGINE_PARAMETER_SUFFIX) {
 }
 
 
+#if EFI_USE_NATIVE_SYSTEM_FSIO
+#include "system_fsio_native.h"
+#endif /* EFI_USE_NATIVE_SYSTEM_FSIO */
+
 #if EFI_PROD_CODE
 
 #include "pin_repository.h"
@@ -255,8 +331,41 @@ void setFsio(int index, brain_pin_e pin, const char * exp DECLARE_CONFIG_PARAMET
 	setFsioExt(index, pin, exp, NO_PWM PASS_CONFIG_PARAMETER_SUFFIX);
 }
 
+#if EFI_FSIO_EVENT_DRIVEN
+// which sensors each compiled program reads and when it last ran, see runFsio
+static uint32_t slotDependencyMask[FSIO_COMMAND_COUNT];
+static efitimeus_t slotLastEvalUs[FSIO_COMMAND_COUNT];
+#endif /* EFI_FSIO_EVENT_DRIVEN */
+
+/**
+ * Per-tick element budget: runFsio() executes in the same periodic task context
+ * as the control loops, see periodic_thread_controller.h, so one pathological
+ * user expression must not be allowed to eat the whole tick. Slots past the
+ * budget are deferred and resume from the same point next tick; system relay
+ * logic below the slot loop is never deferred.
+ */
+#define FSIO_TICK_ELEMENT_BUDGET 200
+
+static int slotElementCount[FSIO_COMMAND_COUNT];
+static int fsioNextSlotIndex = 0;
+static int fsioBudgetOverrunCounter = 0;
+
+static int countElements(LEElement *element) {
+	int result = 0;
+	while (element != NULL) {
+		result++;
+		element = element->next;
+	}
+	return result;
+}
+
+int getFsioBudgetOverrunCounter(void) {
+	return fsioBudgetOverrunCounter;
+}
+
 void applyFsioConfiguration(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	userPool.reset();
+	userCode.reset();
 	for (int i = 0; i < FSIO_COMMAND_COUNT; i++) {
 		const char *formula = config->fsioFormulas[i];
 		LEElement *logic = userPool.parseExpression(formula);
@@ -266,7 +375,16 @@ void applyFsioConfiguration(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 		}
 
 		state.fsioLogics[i] = logic;
+		state.fsioPrograms[i] = userCode.compile(logic);
+		// upper bound for the compiled program as well, folding only shrinks it
+		slotElementCount[i] = countElements(logic);
+#if EFI_FSIO_EVENT_DRIVEN
+		slotDependencyMask[i] = getProgramDependencyMask(state.fsioPrograms[i]);
+		// force a fresh evaluation after every configuration apply
+		slotLastEvalUs[i] = 0;
+#endif /* EFI_FSIO_EVENT_DRIVEN */
 	}
+	fsioNextSlotIndex = 0;
 }
 
 void onConfigurationChangeFsioCallback(engine_configuration_s *previousConfiguration DECLARE_ENGINE_PARAMETER_SUFFIX) {
@@ -278,6 +396,67 @@ void onConfigurationChangeFsioCallback(engine_configuration_s *previousConfigura
 
 static LECalculator calc;
 
+/**
+ * per-slot execution profiling: accumulated evaluation time in
+ * getTimeNowLowerNt() ticks plus evaluation counter, reported and reset by 'fsioinfo'
+ */
+static uint32_t fsioEvalDurationNt[FSIO_COMMAND_COUNT];
+static uint32_t fsioEvalCounter[FSIO_COMMAND_COUNT];
+static efitimeus_t fsioStatsStartUs = 0;
+
+#if EFI_FSIO_EVENT_DRIVEN
+/**
+ * Event-driven evaluation: each slot knows which sensors its program reads
+ * (see getProgramDependencyMask) and is re-evaluated only when one of them
+ * moved past its deadband since the previous tick, or when the result is
+ * older than FSIO_MAX_STALENESS. Programs with untrackable inputs - self
+ * feedback, tables, parametrized methods - evaluate every tick as before.
+ */
+#define FSIO_MAX_STALENESS MS2US(200)
+#define FSIO_TRACKED_SENSOR_BITS ((1u << FSIO_SNAPSHOT_SIZE) - 1)
+
+static float previousSensorValue[FSIO_SNAPSHOT_SIZE];
+static bool previousSensorValid[FSIO_SNAPSHOT_SIZE];
+
+static float getSensorDeadband(le_action_e action) {
+	switch (action) {
+	case LE_METHOD_RPM:
+		return 10;
+	case LE_METHOD_COOLANT:
+	case LE_METHOD_INTAKE_AIR:
+		return 0.5;
+	case LE_METHOD_VBATT:
+		return 0.1;
+	case LE_METHOD_TIME_SINCE_BOOT:
+	case LE_METHOD_TIME_SINCE_AC_TOGGLE:
+		// time never rests, any movement counts as a change
+		return 0;
+	default:
+		return 0.01;
+	}
+}
+
+/**
+ * @return bit mask of tracked sensors which moved past their deadband since last tick
+ */
+static uint32_t detectChangedSensors(uint32_t unionMask DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	uint32_t changed = 0;
+	for (int i = 0; i < FSIO_SNAPSHOT_SIZE; i++) {
+		if ((unionMask & (1u << i)) == 0) {
+			continue;
+		}
+		le_action_e action = (le_action_e) (FSIO_SNAPSHOT_FIRST + i);
+		float value = getEngineValue(action PASS_ENGINE_PARAMETER_SUFFIX);
+		if (!previousSensorValid[i] || absF(value - previousSensorValue[i]) > getSensorDeadband(action)) {
+			changed |= 1u << i;
+			previousSensorValue[i] = value;
+			previousSensorValid[i] = true;
+		}
+	}
+	return changed;
+}
+#endif /* EFI_FSIO_EVENT_DRIVEN */
+
 static SimplePwm fsioPwm[FSIO_COMMAND_COUNT] CCM_OPTIONAL;
 
 // that's crazy, but what's an alternative? we need const char *, a shared buffer would not work for pin repository
@@ -323,7 +502,10 @@ float getFsioOutputValue(int index DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	if (state.fsioLogics[index] == NULL) {
 		warning(CUSTOM_NO_FSIO, "no FSIO for #%d %s", index + 1, hwPortname(CONFIG(fsioOutputPins)[index]));
 		return NAN;
+	} else if (state.fsioPrograms[index] != NULL) {
+		return calc.getCompiledValue(engine->fsioState.fsioLastValue[index], state.fsioPrograms[index] PASS_ENGINE_PARAMETER_SUFFIX);
 	} else {
+		// arena overflow, fall back to walking the linked list
 		return calc.getValue2(engine->fsioState.fsioLastValue[index], state.fsioLogics[index] PASS_ENGINE_PARAMETER_SUFFIX);
 	}
 }
@@ -340,6 +522,10 @@ static void handleFsio(int index DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	bool isPwmMode = CONFIG(fsioFrequency)[index] != NO_PWM;
 
 	float fvalue = getFsioOutputValue(index PASS_ENGINE_PARAMETER_SUFFIX);
+	if (state.fsioLogics[index] != NULL) {
+		fsioEvalDurationNt[index] += calc.lastEvalDurationNt;
+		fsioEvalCounter[index]++;
+	}
 	engine->fsioState.fsioLastValue[index] = fvalue;
 
 	if (isPwmMode) {
@@ -379,7 +565,7 @@ static const char * action2String(le_action_e action) {
 	return buffer;
 }
 
-static void setPinState(const char * msg, OutputPin *pin, LEElement *element DECLARE_ENGINE_PARAMETER_SUFFIX) {
+static void setPinState(const char * msg, OutputPin *pin, LEElement *element, le_instruction_s *program DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #if EFI_PROD_CODE
 	if (isRunningBenchTest()) {
 		return; // let's not mess with bench testing
@@ -389,7 +575,9 @@ static void setPinState(const char * msg, OutputPin *pin, LEElement *element DEC
 	if (!element) {
 		warning(CUSTOM_FSIO_INVALID_EXPRESSION, "invalid expression for %s", msg);
 	} else {
-		int value = (int)calc.getValue2(pin->getLogicValue(), element PASS_ENGINE_PARAMETER_SUFFIX);
+		int value = (int)(program != NULL ?
+				calc.getCompiledValue(pin->getLogicValue(), program PASS_ENGINE_PARAMETER_SUFFIX) :
+				calc.getValue2(pin->getLogicValue(), element PASS_ENGINE_PARAMETER_SUFFIX));
 		if (pin->isInitialized() && value != pin->getLogicValue()) {
 
 			for (int i = 0;i < calc.currentCalculationLogPosition;i++) {
@@ -403,6 +591,24 @@ static void setPinState(const char * msg, OutputPin *pin, LEElement *element DEC
 }
 
 
+#if EFI_USE_NATIVE_SYSTEM_FSIO
+/**
+ * same on-change handling as setPinState but for natively evaluated system logic
+ */
+static void setPinStateDirect(const char *msg, OutputPin *pin, float fvalue) {
+#if EFI_PROD_CODE
+	if (isRunningBenchTest()) {
+		return; // let's not mess with bench testing
+	}
+#endif /* EFI_PROD_CODE */
+	int value = (int) fvalue;
+	if (pin->isInitialized() && value != pin->getLogicValue()) {
+		scheduleMsg(logger, "setPin %s %s", msg, value ? "on" : "off");
+		pin->setValue(value);
+	}
+}
+#endif /* EFI_USE_NATIVE_SYSTEM_FSIO */
+
 #if EFI_PROD_CODE
 static void setFsioFrequency(int index, int frequency) {
 	index--;
@@ -430,7 +636,10 @@ static bool updateValueOrWarning(int fsioIndex, const char *msg, float *value DE
 		return false;
 	} else {
 		float beforeValue = *value;
-		*value = calc.getValue2(beforeValue, element PASS_ENGINE_PARAMETER_SUFFIX);
+		le_instruction_s *program = state.fsioPrograms[fsioIndex];
+		*value = program != NULL ?
+				calc.getCompiledValue(beforeValue, program PASS_ENGINE_PARAMETER_SUFFIX) :
+				calc.getValue2(beforeValue, element PASS_ENGINE_PARAMETER_SUFFIX);
 		// floating '==' comparison without EPS seems fine here
 		return (beforeValue != *value);
 	}
@@ -444,19 +653,85 @@ static void useFsioForServo(int servoIndex DECLARE_ENGINE_PARAMETER_SUFFIX) {
  * this method should be invoked periodically to calculate FSIO and toggle corresponding FSIO outputs
  */
 void runFsio(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+#if EFI_PROD_CODE || EFI_SIMULATOR
+	startSensorSnapshot();
+#endif
+
+#if EFI_FSIO_EVENT_DRIVEN
+	uint32_t unionMask = 0;
 	for (int index = 0; index < FSIO_COMMAND_COUNT; index++) {
+		uint32_t dependencyMask = slotDependencyMask[index];
+		if (dependencyMask != FSIO_DEPENDENCY_ALL) {
+			unionMask |= dependencyMask;
+		}
+	}
+	uint32_t changedSensors = detectChangedSensors(unionMask & FSIO_TRACKED_SENSOR_BITS PASS_ENGINE_PARAMETER_SUFFIX);
+	efitimeus_t nowUs = getTimeNowUs();
+
+	int budgetRemaining = FSIO_TICK_ELEMENT_BUDGET;
+	bool budgetExceeded = false;
+	for (int slot = 0; slot < FSIO_COMMAND_COUNT; slot++) {
+		int index = (fsioNextSlotIndex + slot) % FSIO_COMMAND_COUNT;
+		uint32_t dependencyMask = slotDependencyMask[index];
+		bool mustEvaluate = dependencyMask == FSIO_DEPENDENCY_ALL
+				|| (dependencyMask & changedSensors) != 0
+				|| nowUs - slotLastEvalUs[index] > FSIO_MAX_STALENESS;
+		if (!mustEvaluate) {
+			// inputs are where they were, output keeps its state
+			continue;
+		}
+		if (slot > 0 && slotElementCount[index] > budgetRemaining) {
+			// out of budget: this and the remaining slots resume next tick,
+			// 'slot > 0' guarantees progress even for one oversized program
+			fsioNextSlotIndex = index;
+			fsioBudgetOverrunCounter++;
+			budgetExceeded = true;
+			break;
+		}
+		budgetRemaining -= slotElementCount[index];
+		slotLastEvalUs[index] = nowUs;
 		handleFsio(index PASS_ENGINE_PARAMETER_SUFFIX);
 	}
+#else
+	int budgetRemaining = FSIO_TICK_ELEMENT_BUDGET;
+	bool budgetExceeded = false;
+	for (int slot = 0; slot < FSIO_COMMAND_COUNT; slot++) {
+		int index = (fsioNextSlotIndex + slot) % FSIO_COMMAND_COUNT;
+		if (slot > 0 && slotElementCount[index] > budgetRemaining) {
+			// out of budget: this and the remaining slots resume next tick,
+			// 'slot > 0' guarantees progress even for one oversized program
+			fsioNextSlotIndex = index;
+			fsioBudgetOverrunCounter++;
+			budgetExceeded = true;
+			break;
+		}
+		budgetRemaining -= slotElementCount[index];
+		handleFsio(index PASS_ENGINE_PARAMETER_SUFFIX);
+	}
+#endif /* EFI_FSIO_EVENT_DRIVEN */
+	if (!budgetExceeded) {
+		// the whole ring fit into the budget, back to natural order
+		fsioNextSlotIndex = 0;
+	}
 
 #if EFI_FUEL_PUMP
 	if (CONFIG(fuelPumpPin) != GPIO_UNASSIGNED) {
-		setPinState("pump", &enginePins.fuelPumpRelay, fuelPumpLogic PASS_ENGINE_PARAMETER_SUFFIX);
+#if EFI_USE_NATIVE_SYSTEM_FSIO
+		setPinStateDirect("pump", &enginePins.fuelPumpRelay, getSystemFsioNative_FUEL_PUMP_LOGIC(PASS_ENGINE_PARAMETER_SIGNATURE));
+#else
+		setPinState("pump", &enginePins.fuelPumpRelay, fuelPumpLogic, fuelPumpProgram PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_USE_NATIVE_SYSTEM_FSIO */
 	}
 #endif /* EFI_FUEL_PUMP */
 
 #if EFI_MAIN_RELAY_CONTROL
-	if (CONFIG(mainRelayPin) != GPIO_UNASSIGNED)
-		setPinState("main_relay", &enginePins.mainRelay, mainRelayLogic PASS_ENGINE_PARAMETER_SUFFIX);
+	if (CONFIG(mainRelayPin) != GPIO_UNASSIGNED) {
+#if EFI_USE_NATIVE_SYSTEM_FSIO
+		setPinStateDirect("main_relay", &enginePins.mainRelay, getSystemFsioNative_MAIN_RELAY_LOGIC(PASS_ENGINE_PARAMETER_SIGNATURE));
+#else
+		setPinState("main_relay", &enginePins.mainRelay, mainRelayLogic, mainRelayProgram PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_USE_NATIVE_SYSTEM_FSIO */
+	}
 #else /* EFI_MAIN_RELAY_CONTROL */
 	/**
 	 * main relay is always on if ECU is on, that's a good enough initial implementation
@@ -465,8 +740,13 @@ void runFsio(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 		enginePins.mainRelay.setValue(true);
 #endif /* EFI_MAIN_RELAY_CONTROL */
 
-	if (CONFIG(starterRelayPin) != GPIO_UNASSIGNED)
-		setPinState("starter_relay", &enginePins.starterRelay, starterRelayLogic PASS_ENGINE_PARAMETER_SUFFIX);
+	if (CONFIG(starterRelayPin) != GPIO_UNASSIGNED) {
+#if EFI_USE_NATIVE_SYSTEM_FSIO
+		setPinStateDirect("starter_relay", &enginePins.starterRelay, getSystemFsioNative_STARTER_RELAY_LOGIC(PASS_ENGINE_PARAMETER_SIGNATURE));
+#else
+		setPinState("starter_relay", &enginePins.starterRelay, starterRelayLogic, starterRelayProgram PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_USE_NATIVE_SYSTEM_FSIO */
+	}
 
 	/**
 	 * o2 heater is off during cranking
@@ -476,7 +756,11 @@ void runFsio(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	enginePins.o2heater.setValue(engine->rpmCalculator.isRunning(PASS_ENGINE_PARAMETER_SIGNATURE));
 
 	if (CONFIG(acRelayPin) != GPIO_UNASSIGNED) {
-		setPinState("A/C", &enginePins.acRelay, acRelayLogic PASS_ENGINE_PARAMETER_SUFFIX);
+#if EFI_USE_NATIVE_SYSTEM_FSIO
+		setPinStateDirect("A/C", &enginePins.acRelay, getSystemFsioNative_AC_RELAY_LOGIC(PASS_ENGINE_PARAMETER_SIGNATURE));
+#else
+		setPinState("A/C", &enginePins.acRelay, acRelayLogic, acRelayProgram PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_USE_NATIVE_SYSTEM_FSIO */
 	}
 
 //	if (CONFIG(alternatorControlPin) != GPIO_UNASSIGNED) {
@@ -484,7 +768,11 @@ void runFsio(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 //	}
 
 	if (CONFIG(fanPin) != GPIO_UNASSIGNED) {
-		setPinState("fan", &enginePins.fanRelay, radiatorFanLogic PASS_ENGINE_PARAMETER_SUFFIX);
+#if EFI_USE_NATIVE_SYSTEM_FSIO
+		setPinStateDirect("fan", &enginePins.fanRelay, getSystemFsioNative_FAN_CONTROL_LOGIC(PASS_ENGINE_PARAMETER_SIGNATURE));
+#else
+		setPinState("fan", &enginePins.fanRelay, radiatorFanLogic, radiatorFanProgram PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_USE_NATIVE_SYSTEM_FSIO */
 	}
 
 #if EFI_ENABLE_ENGINE_WARNING
@@ -502,6 +790,18 @@ void runFsio(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	}
 #endif /* EFI_ENABLE_CRITICAL_ENGINE_STOP */
 
+	if (engineConfiguration->useFSIOForAuxValveAngles) {
+		// low-rate angle computation, the edges themselves are scheduled with
+		// ISR precision by the self-rescheduling actors in aux_valves.cpp
+		updateValueOrWarning(MAGIC_OFFSET_FOR_AUX_VALVE_START, "aux valve start", &ENGINE(engineState.auxValveStart) PASS_ENGINE_PARAMETER_SUFFIX);
+		updateValueOrWarning(MAGIC_OFFSET_FOR_AUX_VALVE_END, "aux valve end", &ENGINE(engineState.auxValveEnd) PASS_ENGINE_PARAMETER_SUFFIX);
+		if (ENGINE(engineState.auxValveStart) >= ENGINE(engineState.auxValveEnd)) {
+			warning(CUSTOM_AUX_OUT_OF_ORDER, "aux valve angles out of order %.2f %.2f",
+					ENGINE(engineState.auxValveStart),
+					ENGINE(engineState.auxValveEnd));
+		}
+	}
+
 	if (engineConfiguration->useFSIO12ForIdleOffset) {
 		updateValueOrWarning(MAGIC_OFFSET_FOR_IDLE_OFFSET, "idle offset", &ENGINE(fsioState.fsioIdleOffset) PASS_ENGINE_PARAMETER_SUFFIX);
 	}
@@ -531,6 +831,9 @@ void runFsio(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 		useFsioForServo(4 PASS_ENGINE_PARAMETER_SUFFIX);
 	}
 
+#if EFI_PROD_CODE || EFI_SIMULATOR
+	endSensorSnapshot();
+#endif
 }
 
 
@@ -546,12 +849,41 @@ static void showFsio(const char *msg, LEElement *element) {
 #endif
 }
 
+/**
+ * Shows what actually runs per tick: the compiled program after constant folding,
+ * which is usually shorter than the parsed expression shown by showFsio()
+ */
+static void showProgram(const char *msg, const le_instruction_s *program) {
+#if EFI_PROD_CODE || EFI_SIMULATOR
+	if (msg != NULL)
+		scheduleMsg(logger, "%s compiled:", msg);
+	if (program == NULL) {
+		scheduleMsg(logger, "<not compiled>");
+		return;
+	}
+	while (program->opcode != LE_UNDEFINED) {
+		le_action_e action = (le_action_e) program->opcode;
+		if (action == LE_NUMERIC_VALUE) {
+			scheduleMsg(logger, "push %.2f", program->immediate);
+		} else {
+			scheduleMsg(logger, "action %s", action2String(action));
+		}
+		program++;
+	}
+	scheduleMsg(logger, "<end>");
+#endif
+}
+
 static void showFsioInfo(void) {
 #if EFI_PROD_CODE || EFI_SIMULATOR
 	scheduleMsg(logger, "sys used %d/user used %d", sysPool.getSize(), userPool.getSize());
+	scheduleMsg(logger, "bytecode sys used %d/user used %d", sysCode.getSize(), userCode.getSize());
 	showFsio("a/c", acRelayLogic);
+	showProgram("a/c", acRelayProgram);
 	showFsio("fuel", fuelPumpLogic);
+	showProgram("fuel", fuelPumpProgram);
 	showFsio("fan", radiatorFanLogic);
+	showProgram("fan", radiatorFanProgram);
 	showFsio("alt", alternatorLogic);
 
 	for (int i = 0; i < AUX_PID_COUNT ; i++) {
@@ -577,6 +909,14 @@ static void showFsioInfo(void) {
 					engine->fsioState.fsioLastValue[i]);
 //			scheduleMsg(logger, "user-defined #%d value=%.2f", i, engine->engineConfigurationPtr2->fsioLastValue[i]);
 			showFsio(NULL, state.fsioLogics[i]);
+			showProgram(NULL, state.fsioPrograms[i]);
+			if (fsioEvalCounter[i] > 0) {
+				float windowSeconds = (getTimeNowUs() - fsioStatsStartUs) / US_PER_SECOND_F;
+				// ticks are CPU cycles on STM32, see getTimeNowLowerNt
+				float nsPerEval = fsioEvalDurationNt[i] * 1000.0f / US_TO_NT_MULTIPLIER / fsioEvalCounter[i];
+				scheduleMsg(logger, "profile: %.1f evals/sec %.0f ns/eval",
+						windowSeconds > 0 ? fsioEvalCounter[i] / windowSeconds : 0, nsPerEval);
+			}
 		}
 	}
 	for (int i = 0; i < FSIO_COMMAND_COUNT; i++) {
@@ -591,6 +931,10 @@ static void showFsioInfo(void) {
 			scheduleMsg(logger, "FSIO digital input #%d: %s", i, hwPortname(inputPin));
 		}
 	}
+	// restart the profiling window so repeated 'fsioinfo' shows recent load
+	memset(fsioEvalDurationNt, 0, sizeof(fsioEvalDurationNt));
+	memset(fsioEvalCounter, 0, sizeof(fsioEvalCounter));
+	fsioStatsStartUs = getTimeNowUs();
 #endif
 }
 
@@ -662,23 +1006,31 @@ void initFsioImpl(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #else
 	// only unit test needs this
 	sysPool.reset();
+	sysCode.reset();
 #endif
 
 #if EFI_FUEL_PUMP
 	fuelPumpLogic = sysPool.parseExpression(FUEL_PUMP_LOGIC);
+	fuelPumpProgram = sysCode.compile(fuelPumpLogic);
 #endif /* EFI_FUEL_PUMP */
 
 	acRelayLogic = sysPool.parseExpression(AC_RELAY_LOGIC);
+	acRelayProgram = sysCode.compile(acRelayLogic);
 	radiatorFanLogic = sysPool.parseExpression(FAN_CONTROL_LOGIC);
+	radiatorFanProgram = sysCode.compile(radiatorFanLogic);
 
 	alternatorLogic = sysPool.parseExpression(ALTERNATOR_LOGIC);
-	
+
 #if EFI_MAIN_RELAY_CONTROL
-	if (CONFIG(mainRelayPin) != GPIO_UNASSIGNED)
+	if (CONFIG(mainRelayPin) != GPIO_UNASSIGNED) {
 		mainRelayLogic = sysPool.parseExpression(MAIN_RELAY_LOGIC);
+		mainRelayProgram = sysCode.compile(mainRelayLogic);
+	}
 #endif /* EFI_MAIN_RELAY_CONTROL */
-	if (CONFIG(starterRelayPin) != GPIO_UNASSIGNED)
+	if (CONFIG(starterRelayPin) != GPIO_UNASSIGNED) {
 		starterRelayLogic = sysPool.parseExpression(STARTER_RELAY_LOGIC);
+		starterRelayProgram = sysCode.compile(starterRelayLogic);
+	}
 
 #if EFI_PROD_CODE
 	for (int i = 0; i < FSIO_COMMAND_COUNT; i++) {
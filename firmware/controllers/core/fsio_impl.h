@@ -24,6 +24,10 @@ typedef Map3D<FSIO_TABLE_8, FSIO_TABLE_8, uint8_t, float> fsio8_Map3D_u8t;
 #define MAGIC_OFFSET_FOR_ENGINE_WARNING 4
 #define MAGIC_OFFSET_FOR_CRITICAL_ENGINE 5
 
+// see useFSIOForAuxValveAngles
+#define MAGIC_OFFSET_FOR_AUX_VALVE_START 2
+#define MAGIC_OFFSET_FOR_AUX_VALVE_END 3
+
 float getEngineValue(le_action_e action DECLARE_ENGINE_PARAMETER_SUFFIX);
 /**
  * set_fsio_output_pin 7 PE3
@@ -36,6 +40,10 @@ void initFsioImpl(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX);
 void runFsio(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 void setFsioExpression(const char *indexStr, const char *quotedLine DECLARE_ENGINE_PARAMETER_SUFFIX);
 float getFsioOutputValue(int index DECLARE_ENGINE_PARAMETER_SUFFIX);
+/**
+ * how many times the per-tick element budget deferred user slots, see runFsio
+ */
+int getFsioBudgetOverrunCounter(void);
 void applyFsioConfiguration(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 void onConfigurationChangeFsioCallback(engine_configuration_s *previousConfiguration DECLARE_ENGINE_PARAMETER_SUFFIX);
 void runHardcodedFsio(DECLARE_ENGINE_PARAMETER_SIGNATURE);
@@ -50,10 +50,22 @@
 #include "aux_pid.h"
 #include "spark_logic.h"
 #include "aux_valves.h"
+#include "shadow_tune.h"
+#include "gear_detector.h"
+#include "prearm.h"
+#include "sensor_calibration.h"
+#include "dfco_sequencer.h"
+#include "switch_inputs.h"
+#include "flight_recorder.h"
+#include "cylinder_balance.h"
+#include "knock_analyzer.h"
 #include "accelerometer.h"
 #include "counter64.h"
 #include "perf_trace.h"
+#include "boot_profiler.h"
+#include "backup_ram.h"
 #include "boost_control.h"
+#include "power_state.h"
 
 #if EFI_SENSOR_CHART
 #include "sensor_chart.h"
@@ -65,6 +77,10 @@
 
 #if EFI_LOGIC_ANALYZER
 #include "logic_analyzer.h"
+#include "timing_loopback.h"
+#include "race_detector.h"
+#include "trigger_replay.h"
+#include "perf_sweep.h"
 #endif
 
 #if HAL_USE_ADC
@@ -113,8 +129,24 @@ static void mostCommonInitEngineController(Logging *sharedLogger DECLARE_ENGINE_
 
 	initSensors(sharedLogger PASS_ENGINE_PARAMETER_SUFFIX);
 
+#if EFI_SENSOR_CALIBRATION
+	initSensorCalibration(sharedLogger);
+#endif /* EFI_SENSOR_CALIBRATION */
+
+#if EFI_SWITCH_INPUTS
+	initSwitchInputs(sharedLogger);
+#endif /* EFI_SWITCH_INPUTS */
+
+#if EFI_FLIGHT_RECORDER
+	initFlightRecorder(sharedLogger);
+#endif /* EFI_FLIGHT_RECORDER */
+
 	initAccelEnrichment(sharedLogger PASS_ENGINE_PARAMETER_SUFFIX);
 
+#if EFI_SHADOW_TUNE
+	initShadowTune(sharedLogger PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_SHADOW_TUNE */
+
 #if EFI_FSIO
 	initFsioImpl(sharedLogger PASS_ENGINE_PARAMETER_SUFFIX);
 #endif /* EFI_FSIO */
@@ -153,6 +185,7 @@ static void doPeriodicSlowCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 
 class PeriodicFastController : public PeriodicTimerController {
 	void PeriodicTask() override {
+		updatePowerState(PASS_ENGINE_PARAMETER_SIGNATURE);
 		engine->periodicFastCallback();
 	}
 
@@ -176,7 +209,7 @@ class PeriodicSlowController : public PeriodicTimerController {
 static PeriodicFastController fastController;
 static PeriodicSlowController slowController;
 
-static LoggingWithStorage logger("Engine Controller");
+static Logging logger("Engine Controller");
 
 #if EFI_PROD_CODE || EFI_SIMULATOR
 
@@ -354,12 +387,23 @@ static void doPeriodicSlowCallback(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 		resetAccel();
 	} else {
 		updatePrimeInjectionPulseState(PASS_ENGINE_PARAMETER_SIGNATURE);
+#if EFI_INTERNAL_FLASH && EFI_ASYNC_FLASH_BURN
+		// the incremental burn engine is bounded per step, so it is allowed to make
+		// progress with the engine spinning - that's the whole point of it
+		writeToFlashIfPending();
+#endif /* EFI_INTERNAL_FLASH && EFI_ASYNC_FLASH_BURN */
 	}
 
 	if (engine->versionForConfigurationListeners.isOld(engine->getGlobalConfigurationVersion())) {
 		updateAccelParameters();
 	}
 
+#if EFI_PROD_CODE
+	commitLearnedValuesIfNeeded();
+#endif /* EFI_PROD_CODE */
+
+	updateTachometer(GET_RPM() PASS_ENGINE_PARAMETER_SUFFIX);
+
 	engine->periodicSlowCallback(PASS_ENGINE_PARAMETER_SIGNATURE);
 #endif
 }
@@ -687,7 +731,12 @@ void commonInitEngineController(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_S
 	 * This has to go after 'initInjectorCentral' in order to
 	 * properly detect un-assigned output pins
 	 */
+#if EFI_KEYON_PREARM
+	// submitted to the pre-arm worker back in initHardware, this is the join point
+	prearmJoin(PREARM_TRIGGER_SHAPES);
+#else
 	prepareShapes(PASS_ENGINE_PARAMETER_SIGNATURE);
+#endif /* EFI_KEYON_PREARM */
 #endif /* EFI_PROD_CODE && EFI_ENGINE_CONTROL */
 
 
@@ -696,7 +745,8 @@ void commonInitEngineController(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_S
 #endif /* EFI_ENABLE_MOCK_ADC */
 
 #if EFI_SENSOR_CHART
-	initSensorChart();
+	// development tool, not needed for engine start
+	bootDeferInit("sensor chart", initSensorChart);
 #endif /* EFI_SENSOR_CHART */
 
 
@@ -732,6 +782,16 @@ void commonInitEngineController(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_S
 		 */
 		initSparkLogic(sharedLogger);
 		initMainEventListener(sharedLogger PASS_ENGINE_PARAMETER_SUFFIX);
+#if EFI_CYLINDER_BALANCE
+		initCylinderBalance(sharedLogger PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_CYLINDER_BALANCE */
+
+#if EFI_DFCO_SEQUENCER
+		initDfcoSequencer(sharedLogger PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_DFCO_SEQUENCER */
+#if EFI_INTERNAL_KNOCK_ADC
+		initKnockAnalyzer(sharedLogger PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_INTERNAL_KNOCK_ADC */
 	}
 #endif /* EFI_ENGINE_CONTROL */
 
@@ -739,6 +799,13 @@ void commonInitEngineController(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_S
 
 #if !EFI_UNIT_TEST
 
+#if EFI_LOGIC_ANALYZER
+static void lazyInitWaveAnalyzer(void) {
+	extern LoggingWithStorage sharedLogger;
+	initWaveAnalyzer(&sharedLogger);
+}
+#endif /* EFI_LOGIC_ANALYZER */
+
 void initEngineContoller(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #if EFI_SIMULATOR
 	printf("initEngineContoller\n");
@@ -747,6 +814,11 @@ void initEngineContoller(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX)
 
 #if EFI_PROD_CODE && EFI_ENGINE_CONTROL
 	initInjectorCentral(sharedLogger);
+#if EFI_KEYON_PREARM
+	// injection pins are started now, the trigger-shapes worker node waits on
+	// this milestone so its un-assigned pin detection sees initialized outputs
+	prearmMarkDone(PREARM_INJECTOR_PINS);
+#endif /* EFI_KEYON_PREARM */
 #endif /* EFI_PROD_CODE && EFI_ENGINE_CONTROL */
 
 	commonInitEngineController(sharedLogger);
@@ -757,10 +829,29 @@ void initEngineContoller(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX)
 
 #if EFI_LOGIC_ANALYZER
 	if (engineConfiguration->isWaveAnalyzerEnabled) {
-		initWaveAnalyzer(sharedLogger);
+		// development tool, not needed for engine start
+		bootDeferInit("wave analyzer", lazyInitWaveAnalyzer);
 	}
 #endif /* EFI_LOGIC_ANALYZER */
 
+#if EFI_TIMING_LOOPBACK
+	// bench test mode, only console commands are registered here
+	initTimingLoopback(sharedLogger);
+#endif /* EFI_TIMING_LOOPBACK */
+
+#if EFI_RACE_DETECTOR
+	initRaceDetector(sharedLogger);
+#endif /* EFI_RACE_DETECTOR */
+
+#if EFI_TOOTH_LOGGER && EFI_SHAFT_POSITION_INPUT
+	initTriggerReplay(sharedLogger);
+#endif /* EFI_TOOTH_LOGGER && EFI_SHAFT_POSITION_INPUT */
+
+#if EFI_EMULATE_POSITION_SENSORS && EFI_PROD_CODE
+	// bench acceptance test mode, only a console command is registered here
+	initPerfSweep(sharedLogger);
+#endif /* EFI_EMULATE_POSITION_SENSORS && EFI_PROD_CODE */
+
 #if EFI_CJ125
 	/**
 	 * this uses SimplePwm which depends on scheduler, has to be initialized after scheduler
@@ -791,6 +882,10 @@ void initEngineContoller(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX)
 #if EFI_BOOST_CONTROL
 	initBoostCtrl(sharedLogger PASS_ENGINE_PARAMETER_SUFFIX);
 #endif
+
+#if EFI_VEHICLE_SPEED
+	initGearDetector(sharedLogger);
+#endif /* EFI_VEHICLE_SPEED */
 #if EFI_AUX_PID
 	initAuxPid(sharedLogger);
 #endif
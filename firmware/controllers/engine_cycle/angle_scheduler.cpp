@@ -0,0 +1,90 @@
+/**
+ * @file angle_scheduler.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "angle_scheduler.h"
+#include "engine_math.h"
+#include "utlist.h"
+#include "event_queue.h"
+
+EXTERN_ENGINE;
+
+static bool assertNotInAngleEventList(AngleBasedEvent *head, AngleBasedEvent *element) {
+	assertNotInListMethodBody(AngleBasedEvent, head, element, nextToothEvent)
+}
+
+/**
+ * @return true if event corresponds to current tooth and was time-based scheduled
+ *         false if event was put into queue for scheduling at a later tooth
+ */
+bool scheduleOrQueue(AngleBasedEvent *event,
+		uint32_t trgEventIndex,
+		efitick_t edgeTimestamp,
+		angle_t angle,
+		action_s action
+		DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	event->position.setAngle(angle PASS_ENGINE_PARAMETER_SUFFIX);
+
+	/**
+	 * Here's the status as of Jan 2020:
+	 * Once we hit the last trigger tooth prior to needed event, schedule it by time.  We use as much trigger position angle as possible
+	 * and only use less precise RPM-based time calculation for the last portion of the angle, the one between two teeth closest to the
+	 * desired angle moment.
+	 */
+	if (trgEventIndex != TRIGGER_EVENT_UNDEFINED && event->position.triggerEventIndex == trgEventIndex) {
+		/**
+		 * Event should be fired before the next trigger event - time-based delay is best precision possible
+		 */
+		scheduling_s * sDown = &event->scheduling;
+
+		scheduleByAngle(
+			sDown,
+			edgeTimestamp,
+			event->position.angleOffsetFromTriggerEvent,
+			action
+			PASS_ENGINE_PARAMETER_SUFFIX
+		);
+
+		return true;
+	} else {
+		event->action = action;
+		/**
+		 * Event should be scheduled in relation to some future trigger event, this way we get better firing precision
+		 */
+		bool isPending = assertNotInAngleEventList(ENGINE(angleBasedEventsHead), event);
+		(void)isPending;
+		if (!isPending) {
+			LL_APPEND2(ENGINE(angleBasedEventsHead), event, nextToothEvent);
+		}
+		return false;
+	}
+}
+
+/**
+ * Invoked by the trigger decode path on every tooth: pending angle events which are anchored
+ * to the current tooth get converted into a hardware timer covering only the last tooth gap.
+ */
+void scheduleAngleEventsUntilNextTriggerTooth(uint32_t trgEventIndex, efitick_t edgeTimestamp DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	AngleBasedEvent *current, *tmp;
+
+	LL_FOREACH_SAFE2(ENGINE(angleBasedEventsHead), current, tmp, nextToothEvent)
+	{
+		if (current->position.triggerEventIndex == trgEventIndex) {
+			// time to fire an event which was scheduled previously
+			LL_DELETE2(ENGINE(angleBasedEventsHead), current, nextToothEvent);
+
+			scheduling_s * sDown = &current->scheduling;
+
+			scheduleByAngle(
+				sDown,
+				edgeTimestamp,
+				current->position.angleOffsetFromTriggerEvent,
+				current->action
+				PASS_ENGINE_PARAMETER_SUFFIX
+			);
+		}
+	}
+}
@@ -0,0 +1,31 @@
+/**
+ * @file angle_scheduler.h
+ *
+ * Angle-domain scheduling: actions are registered at an engine angle, not at a wall-clock
+ * time. Pending events stay anchored to the trigger tooth closest before the desired angle
+ * and are only converted into a hardware timer once the trigger decode path reaches that
+ * tooth - see scheduleAngleEventsUntilNextTriggerTooth(). This way only the final sub-tooth
+ * portion of the angle is extrapolated from current RPM, so during hard acceleration the
+ * accumulated RPM-delta error is limited to a single tooth gap.
+ *
+ * Historically this logic lived inside spark_logic.cpp, it was extracted here once
+ * auxiliary valves started using the same mechanism.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "engine.h"
+
+#define TRIGGER_EVENT_UNDEFINED -1
+
+bool scheduleOrQueue(AngleBasedEvent *event,
+		uint32_t trgEventIndex,
+		efitick_t edgeTimestamp,
+		angle_t angle,
+		action_s action
+		DECLARE_ENGINE_PARAMETER_SUFFIX);
+
+void scheduleAngleEventsUntilNextTriggerTooth(uint32_t trgEventIndex, efitick_t edgeTimestamp DECLARE_ENGINE_PARAMETER_SUFFIX);
@@ -17,7 +17,7 @@
 #include "aux_valves.h"
 #include "allsensors.h"
 #include "trigger_central.h"
-#include "spark_logic.h"
+#include "angle_scheduler.h"
 
 EXTERN_ENGINE
 ;
@@ -130,10 +130,13 @@ void initAuxValves(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	chThdSleepMilliseconds(50);
 #endif /* EFI_UNIT_TESTS */
 
-	float tps = getTPS(PASS_ENGINE_PARAMETER_SIGNATURE);
-	if (cisnan(tps)) {
-		firmwareError(CUSTOM_OBD_91, "No TPS for Aux Valves");
-		return;
+	if (!CONFIG(useFSIOForAuxValveAngles)) {
+		// the default TPS curves need a TPS, the FSIO expressions may not
+		float tps = getTPS(PASS_ENGINE_PARAMETER_SIGNATURE);
+		if (cisnan(tps)) {
+			firmwareError(CUSTOM_OBD_91, "No TPS for Aux Valves");
+			return;
+		}
 	}
 
 	updateAuxValves(PASS_ENGINE_PARAMETER_SIGNATURE);
@@ -167,6 +170,14 @@ void updateAuxValves(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 		return;
 	}
 
+#if EFI_FSIO
+	if (CONFIG(useFSIOForAuxValveAngles)) {
+		// runFsio() computes the angles from FSIO expressions #3 and #4, the
+		// self-rescheduling actors pick fresh values up every revolution
+		return;
+	}
+#endif /* EFI_FSIO */
+
 	float tps = getTPS(PASS_ENGINE_PARAMETER_SIGNATURE);
 	if (cisnan(tps)) {
 		// error should be already reported by now
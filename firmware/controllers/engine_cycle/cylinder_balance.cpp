@@ -0,0 +1,169 @@
+/**
+ * @file	cylinder_balance.cpp
+ * @brief	closed-loop per-cylinder fuel balance from crank acceleration segments
+ *
+ * Each cylinder's power stroke accelerates the crank; a weak cylinder leaves its
+ * segment of the engine cycle a little longer than the average. We timestamp one
+ * precomputed trigger tooth per cylinder, compare segment durations once per cycle,
+ * low-pass the deviation per cylinder and feed a micro fuel trim back into each
+ * InjectionEvent.
+ *
+ * The per-tooth cost is one table lookup: all the geometry is resolved into
+ * cylinderByEventIndex[] when the trigger shape is prepared.
+ *
+ * Feature is experimental so it is disabled until armed from the console:
+ *     cylbal_enable / cylbal_disable / cylbalinfo
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "cylinder_balance.h"
+
+#if EFI_CYLINDER_BALANCE && EFI_SHAFT_POSITION_INPUT
+
+#include "engine.h"
+#include "engine_math.h"
+
+EXTERN_ENGINE
+;
+
+static Logging *logger;
+
+static bool isCylinderBalanceArmed = false;
+
+// smoothing factor of the per-cylinder deviation low-pass
+#define CYLBAL_FILTER_ALPHA 0.05f
+// fuel trim per unit of filtered relative deviation
+#define CYLBAL_GAIN 0.5f
+// micro-trims only: never move any cylinder by more than 3%
+#define CYLBAL_TRIM_LIMIT 0.03f
+
+/**
+ * -1 means 'not a segment boundary', otherwise the cylinder index whose power
+ * stroke begins at this trigger event
+ */
+static int8_t cylinderByEventIndex[PWM_PHASE_MAX_COUNT];
+static efitick_t lastBoundaryNt = 0;
+static int lastBoundaryCylinder = -1;
+static efitick_t segmentDuration[INJECTION_PIN_COUNT];
+static float filteredDeviation[INJECTION_PIN_COUNT];
+static float balanceTrim[INJECTION_PIN_COUNT];
+static int segmentsSeen = 0;
+
+float getCylinderBalanceTrim(size_t injectorIndex) {
+	if (!isCylinderBalanceArmed || injectorIndex >= INJECTION_PIN_COUNT) {
+		return 1;
+	}
+	return 1 + balanceTrim[injectorIndex];
+}
+
+static void resetCylinderBalance(void) {
+	lastBoundaryNt = 0;
+	lastBoundaryCylinder = -1;
+	segmentsSeen = 0;
+	for (int i = 0; i < INJECTION_PIN_COUNT; i++) {
+		segmentDuration[i] = 0;
+		filteredDeviation[i] = 0;
+		balanceTrim[i] = 0;
+	}
+}
+
+/**
+ * resolves cylinder geometry into the per-tooth lookup, invoked together with
+ * trigger shape preparation - see prepareOutputSignals()
+ */
+void prepareCylinderBalance(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	for (int i = 0; i < PWM_PHASE_MAX_COUNT; i++) {
+		cylinderByEventIndex[i] = -1;
+	}
+	resetCylinderBalance();
+
+	int cylindersCount = ENGINE(validatedConfig.cylindersCount);
+	angle_t perCylinderAngle = ENGINE(engineCycle) / cylindersCount;
+	for (int i = 0; i < cylindersCount; i++) {
+		angle_t boundaryAngle = i * perCylinderAngle;
+		fixAngle(boundaryAngle, "cylbal", CUSTOM_ERR_CYLBAL_ANGLE);
+		int eventIndex = TRIGGER_WAVEFORM(triggerIndexByAngle[(int)boundaryAngle]);
+		// i-th position in the firing order, zero based cylinder index
+		cylinderByEventIndex[eventIndex] = ENGINE(hotConfig.cylinderIndexByFiringIndex[i]);
+	}
+}
+
+/**
+ * invoked on every trigger tooth from the main trigger callback, the common case
+ * is one array read and out
+ */
+void onCylinderBalanceTriggerTooth(uint32_t trgEventIndex, efitick_t nowNt DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (!isCylinderBalanceArmed) {
+		return;
+	}
+	int cylinderIndex = cylinderByEventIndex[trgEventIndex];
+	if (cylinderIndex < 0) {
+		return;
+	}
+
+	if (lastBoundaryCylinder >= 0 && lastBoundaryNt != 0) {
+		// the segment which just ended belongs to the previous boundary's cylinder
+		segmentDuration[lastBoundaryCylinder] = nowNt - lastBoundaryNt;
+		segmentsSeen++;
+	}
+	lastBoundaryCylinder = cylinderIndex;
+	lastBoundaryNt = nowNt;
+
+	int cylindersCount = ENGINE(validatedConfig.cylindersCount);
+	// once per engine cycle, when the full set of segments is fresh
+	if (cylinderIndex != 0 || segmentsSeen < cylindersCount) {
+		return;
+	}
+
+	efitick_t totalDuration = 0;
+	for (int i = 0; i < cylindersCount; i++) {
+		totalDuration += segmentDuration[i];
+	}
+	if (totalDuration == 0) {
+		return;
+	}
+	float meanDuration = 1.0f * totalDuration / cylindersCount;
+
+	for (int i = 0; i < cylindersCount; i++) {
+		// positive deviation = longer segment = weak cylinder
+		float deviation = (segmentDuration[i] - meanDuration) / meanDuration;
+		filteredDeviation[i] += CYLBAL_FILTER_ALPHA * (deviation - filteredDeviation[i]);
+		balanceTrim[i] = maxF(-CYLBAL_TRIM_LIMIT, minF(CYLBAL_GAIN * filteredDeviation[i], CYLBAL_TRIM_LIMIT));
+	}
+}
+
+#if ! EFI_UNIT_TEST
+static void showCylinderBalance(void) {
+	scheduleMsg(logger, "cylinder balance: %s", isCylinderBalanceArmed ? "armed" : "off");
+	int cylindersCount = ENGINE(validatedConfig.cylindersCount);
+	for (int i = 0; i < cylindersCount; i++) {
+		scheduleMsg(logger, "cyl #%d: deviation=%.4f trim=%.4f", i + 1,
+				filteredDeviation[i], balanceTrim[i]);
+	}
+}
+
+static void enableCylinderBalance(void) {
+	resetCylinderBalance();
+	isCylinderBalanceArmed = true;
+	scheduleMsg(logger, "cylinder balance armed");
+}
+
+static void disableCylinderBalance(void) {
+	isCylinderBalanceArmed = false;
+	resetCylinderBalance();
+	scheduleMsg(logger, "cylinder balance off");
+}
+#endif /* EFI_UNIT_TEST */
+
+void initCylinderBalance(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	logger = sharedLogger;
+#if ! EFI_UNIT_TEST
+	addConsoleAction("cylbalinfo", showCylinderBalance);
+	addConsoleAction("cylbal_enable", enableCylinderBalance);
+	addConsoleAction("cylbal_disable", disableCylinderBalance);
+#endif /* EFI_UNIT_TEST */
+}
+
+#endif /* EFI_CYLINDER_BALANCE && EFI_SHAFT_POSITION_INPUT */
@@ -0,0 +1,28 @@
+/**
+ * @file	cylinder_balance.h
+ * @brief	closed-loop per-cylinder fuel balance from crank acceleration segments
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "engine.h"
+
+#if EFI_CYLINDER_BALANCE && EFI_SHAFT_POSITION_INPUT
+
+void initCylinderBalance(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX);
+void prepareCylinderBalance(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+void onCylinderBalanceTriggerTooth(uint32_t trgEventIndex, efitick_t nowNt DECLARE_ENGINE_PARAMETER_SUFFIX);
+/**
+ * @return multiplier to apply to this cylinder's injection duration, 1 while the
+ * feature is not armed
+ */
+float getCylinderBalanceTrim(size_t injectorIndex);
+
+#else /* EFI_CYLINDER_BALANCE */
+
+#define getCylinderBalanceTrim(injectorIndex) (1)
+
+#endif /* EFI_CYLINDER_BALANCE && EFI_SHAFT_POSITION_INPUT */
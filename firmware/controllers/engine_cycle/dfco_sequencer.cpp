@@ -0,0 +1,174 @@
+/**
+ * @file	dfco_sequencer.cpp
+ * @brief	cylinder-sequenced overrun fuel cut entry/exit
+ *
+ * The plain coasting fuel cut is a binary multiplier on the global injection
+ * duration: every cylinder loses fuel on the same engine cycle and gets it all
+ * back on the same cycle, which is exactly the driveline shock people feel at
+ * throttle lift and tip-in. With the sequencer enabled the binary decision
+ * from getFuelCutOffCorrection() only *requests* the cut; entry then walks the
+ * firing order one cylinder per engine cycle, and resume restores one cylinder
+ * per cycle with a fuel ramp on each.
+ *
+ * The schedule is advanced once per engine cycle at trigger index zero and
+ * consumed as a precomputed per-injector multiplier table - the per-event hot
+ * path does a single array read, same shape as getCylinderBalanceTrim().
+ *
+ * The sequencer is off by default and is armed from the console, the plain
+ * binary behavior is fully preserved while it is disabled.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "dfco_sequencer.h"
+
+DfcoSequencer::DfcoSequencer() {
+	configure(0, DFCO_DEFAULT_RESUME_RAMP_CYCLES);
+}
+
+void DfcoSequencer::configure(int newCylinderCount, int resumeRampCycles) {
+	cylinderCount = minI(newCylinderCount, INJECTION_PIN_COUNT);
+	rampCycles = maxI(1, resumeRampCycles);
+	cutRequested = false;
+	for (int i = 0; i < INJECTION_PIN_COUNT; i++) {
+		multiplier[i] = 1;
+	}
+}
+
+void DfcoSequencer::setCutRequest(bool isCutRequested) {
+	cutRequested = isCutRequested;
+}
+
+void DfcoSequencer::onEngineCycle() {
+	if (cutRequested) {
+		// cut exactly one more cylinder, walking the firing order
+		for (int i = 0; i < cylinderCount; i++) {
+			if (multiplier[i] > 0) {
+				multiplier[i] = 0;
+				break;
+			}
+		}
+	} else {
+		float rampStep = 1.0f / rampCycles;
+		// every partially restored cylinder climbs one ramp step
+		for (int i = 0; i < cylinderCount; i++) {
+			if (multiplier[i] > 0 && multiplier[i] < 1) {
+				multiplier[i] = minF(1, multiplier[i] + rampStep);
+			}
+		}
+		// and exactly one cut cylinder starts its ramp
+		for (int i = 0; i < cylinderCount; i++) {
+			if (multiplier[i] == 0) {
+				multiplier[i] = rampStep;
+				break;
+			}
+		}
+	}
+}
+
+float DfcoSequencer::getPositionMultiplier(int firingOrderPosition) const {
+	if (firingOrderPosition < 0 || firingOrderPosition >= cylinderCount) {
+		return 1;
+	}
+	return multiplier[firingOrderPosition];
+}
+
+bool DfcoSequencer::isFullyCut() const {
+	for (int i = 0; i < cylinderCount; i++) {
+		if (multiplier[i] > 0) {
+			return false;
+		}
+	}
+	return cylinderCount > 0;
+}
+
+bool DfcoSequencer::isFullyRunning() const {
+	for (int i = 0; i < cylinderCount; i++) {
+		if (multiplier[i] < 1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+#if EFI_DFCO_SEQUENCER
+
+#include "engine_math.h"
+#if !EFI_UNIT_TEST
+#include "eficonsole.h"
+#endif /* EFI_UNIT_TEST */
+
+EXTERN_ENGINE
+;
+
+static Logging *logger;
+
+static DfcoSequencer sequencer;
+static bool isSequencerEnabled = false;
+/**
+ * precomputed per-injector view of the schedule, rebuilt once per engine cycle
+ */
+static float multByInjector[INJECTION_PIN_COUNT];
+
+bool dfcoSequencerTakesOver(bool cutRequested) {
+	if (!isSequencerEnabled) {
+		return false;
+	}
+	sequencer.setCutRequest(cutRequested);
+	return true;
+}
+
+void dfcoOnEngineCycle(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	if (!isSequencerEnabled) {
+		return;
+	}
+	sequencer.onEngineCycle();
+	// remap firing order positions to injector indexes while we are cold, the
+	// injection event path only reads the result
+	for (int position = 0; position < ENGINE(hotConfig.cylindersCount); position++) {
+		int injectorIndex = getCylinderId(position PASS_ENGINE_PARAMETER_SUFFIX) - 1;
+		if (injectorIndex >= 0 && injectorIndex < INJECTION_PIN_COUNT) {
+			multByInjector[injectorIndex] = sequencer.getPositionMultiplier(position);
+		}
+	}
+}
+
+float getDfcoMultiplier(size_t injectorIndex) {
+	if (!isSequencerEnabled || injectorIndex >= INJECTION_PIN_COUNT) {
+		return 1;
+	}
+	return multByInjector[injectorIndex];
+}
+
+#if !EFI_UNIT_TEST
+
+static void consoleSetDfcoSequencer(int value) {
+	isSequencerEnabled = value != 0;
+	sequencer.configure(engineConfiguration->specs.cylindersCount, DFCO_DEFAULT_RESUME_RAMP_CYCLES);
+	for (int i = 0; i < INJECTION_PIN_COUNT; i++) {
+		multByInjector[i] = 1;
+	}
+	scheduleMsg(logger, "DFCO sequencer %s", isSequencerEnabled ? "enabled" : "disabled");
+}
+
+static void showDfcoInfo(void) {
+	scheduleMsg(logger, "DFCO sequencer %s, %s", isSequencerEnabled ? "enabled" : "disabled",
+			sequencer.isFullyCut() ? "cut" : sequencer.isFullyRunning() ? "running" : "in transition");
+}
+
+#endif /* EFI_UNIT_TEST */
+
+void initDfcoSequencer(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	logger = sharedLogger;
+	sequencer.configure(engineConfiguration->specs.cylindersCount, DFCO_DEFAULT_RESUME_RAMP_CYCLES);
+	for (int i = 0; i < INJECTION_PIN_COUNT; i++) {
+		multByInjector[i] = 1;
+	}
+#if !EFI_UNIT_TEST
+	addConsoleActionI("set_dfco_sequencer", consoleSetDfcoSequencer);
+	addConsoleAction("dfcoinfo", showDfcoInfo);
+#endif /* EFI_UNIT_TEST */
+}
+
+#endif /* EFI_DFCO_SEQUENCER */
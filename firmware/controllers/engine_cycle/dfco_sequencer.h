@@ -0,0 +1,77 @@
+/**
+ * @file	dfco_sequencer.h
+ * @brief	cylinder-sequenced overrun fuel cut entry/exit, see dfco_sequencer.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "engine.h"
+
+/**
+ * resume ramp length per cylinder, in engine cycles: a restored cylinder comes
+ * back at 1/DFCO_RESUME_RAMP_CYCLES of its fuel and climbs one step per cycle
+ */
+#define DFCO_DEFAULT_RESUME_RAMP_CYCLES 4
+
+/**
+ * Precomputed cut/resume schedule for decel fuel cut-off. Instead of cutting
+ * every cylinder on the same cycle - which is a driveline shock - the cut
+ * walks the firing order one cylinder per engine cycle, and resume brings
+ * cylinders back one per cycle with a fuel ramp. The injection path consumes
+ * the result as a per-position multiplier table rebuilt once per cycle, so
+ * nothing is decided per injection event.
+ *
+ * The class is pure math indexed by firing order position, the firmware glue
+ * in dfco_sequencer.cpp remaps positions to injectors and hooks the engine
+ * cycle.
+ */
+class DfcoSequencer {
+public:
+	DfcoSequencer();
+	void configure(int cylinderCount, int resumeRampCycles);
+	/**
+	 * latches the desired state, the schedule advances on engine cycles only
+	 */
+	void setCutRequest(bool cutRequested);
+	/**
+	 * advances the schedule by one engine cycle and rebuilds the multiplier table
+	 */
+	void onEngineCycle();
+	/**
+	 * @return fuel multiplier for the cylinder at this firing order position, 0..1
+	 */
+	float getPositionMultiplier(int firingOrderPosition) const;
+	bool isFullyCut() const;
+	bool isFullyRunning() const;
+
+private:
+	int cylinderCount = 0;
+	int rampCycles = DFCO_DEFAULT_RESUME_RAMP_CYCLES;
+	bool cutRequested = false;
+	float multiplier[INJECTION_PIN_COUNT];
+};
+
+#if EFI_DFCO_SEQUENCER
+
+void initDfcoSequencer(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX);
+/**
+ * called from the fast callback with the binary DFCO decision, replaces the
+ * global fuel cut correction while the sequencer is enabled
+ */
+bool dfcoSequencerTakesOver(bool cutRequested);
+/**
+ * called at trigger index zero, advances the schedule and rebuilds the
+ * per-injector multiplier table
+ */
+void dfcoOnEngineCycle(DECLARE_ENGINE_PARAMETER_SIGNATURE);
+float getDfcoMultiplier(size_t injectorIndex);
+
+#else /* EFI_DFCO_SEQUENCER */
+
+#define dfcoSequencerTakesOver(cutRequested) (false)
+#define getDfcoMultiplier(injectorIndex) (1)
+
+#endif /* EFI_DFCO_SEQUENCER */
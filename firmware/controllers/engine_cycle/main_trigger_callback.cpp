@@ -34,6 +34,10 @@
 #include "engine_math.h"
 #include "trigger_central.h"
 #include "spark_logic.h"
+#include "boost_control.h"
+#include "cylinder_balance.h"
+#include "dfco_sequencer.h"
+#include "angle_scheduler.h"
 #include "rpm_calculator.h"
 #include "engine_configuration.h"
 #include "interpolation.h"
@@ -76,13 +80,13 @@ static Pid fuelPid(fuelPidS);
 //#endif
 
 void startSimultaniousInjection(Engine *engine) {
-	for (int i = 0; i < engine->engineConfigurationPtr->specs.cylindersCount; i++) {
+	for (int i = 0; i < engine->hotConfig.cylindersCount; i++) {
 		enginePins.injectors[i].setHigh();
 	}
 }
 
 static void endSimultaniousInjectionOnlyTogglePins(Engine *engine) {
-	for (int i = 0; i < engine->engineConfigurationPtr->specs.cylindersCount; i++) {
+	for (int i = 0; i < engine->hotConfig.cylindersCount; i++) {
 		enginePins.injectors[i].setLow();
 	}
 }
@@ -95,7 +99,7 @@ void endSimultaniousInjection(InjectionEvent *event) {
 	event->isScheduled = false;
 
 	endSimultaniousInjectionOnlyTogglePins(engine);
-	engine->injectionEvents.addFuelEventsForCylinder(event->ownIndex PASS_ENGINE_PARAMETER_SUFFIX);
+	engine->injectionEvents->addFuelEventsForCylinder(event->ownIndex PASS_ENGINE_PARAMETER_SUFFIX);
 }
 
 static inline void turnInjectionPinHigh(InjectorOutputPin *output) {
@@ -170,7 +174,7 @@ void turnInjectionPinLow(InjectionEvent *event) {
 	Engine *engine = event->engine;
 	EXPAND_Engine;
 #endif
-	ENGINE(injectionEvents.addFuelEventsForCylinder(event->ownIndex PASS_ENGINE_PARAMETER_SUFFIX));
+	ENGINE(injectionEvents)->addFuelEventsForCylinder(event->ownIndex PASS_ENGINE_PARAMETER_SUFFIX);
 }
 
 static ALWAYS_INLINE void handleFuelInjectionEvent(int injEventIndex, InjectionEvent *event,
@@ -183,7 +187,10 @@ static ALWAYS_INLINE void handleFuelInjectionEvent(int injEventIndex, InjectionE
 	 */
 
 	size_t injectorIndex = event->outputs[0]->injectorIndex;
-	const floatms_t injectionDuration = ENGINE(wallFuel[injectorIndex]).adjust(ENGINE(injectionDuration) PASS_ENGINE_PARAMETER_SUFFIX);
+	// per-cylinder balance micro-trim scales the commanded fuel before wall wetting dynamics
+	// DFCO sequencer and balance trim are both precomputed tables, this is two array reads
+	const floatms_t injectionDuration = ENGINE(wallFuel[injectorIndex]).adjust(
+			getDfcoMultiplier(injectorIndex) * getCylinderBalanceTrim(injectorIndex) * ENGINE(injectionDuration) PASS_ENGINE_PARAMETER_SUFFIX);
 #if EFI_PRINTF_FUEL_DETAILS
 	printf("fuel injectionDuration=%.2f adjusted=%.2f\t\n", ENGINE(injectionDuration), injectionDuration);
 #endif /*EFI_PRINTF_FUEL_DETAILS */
@@ -193,9 +200,9 @@ static ALWAYS_INLINE void handleFuelInjectionEvent(int injEventIndex, InjectionE
 	 * todo: pre-calculate 'numberOfInjections'
 	 * see also injectorDutyCycle
 	 */
-	if (!isCranking && injectionDuration * getNumberOfInjections(engineConfiguration->injectionMode PASS_ENGINE_PARAMETER_SUFFIX) > getEngineCycleDuration(rpm PASS_ENGINE_PARAMETER_SUFFIX)) {
+	if (!isCranking && injectionDuration * getNumberOfInjections(ENGINE(hotConfig.injectionMode) PASS_ENGINE_PARAMETER_SUFFIX) > getEngineCycleDuration(rpm PASS_ENGINE_PARAMETER_SUFFIX)) {
 		warning(CUSTOM_TOO_LONG_FUEL_INJECTION, "Too long fuel injection %.2fms", injectionDuration);
-	} else if (isCranking && injectionDuration * getNumberOfInjections(engineConfiguration->crankingInjectionMode PASS_ENGINE_PARAMETER_SUFFIX) > getEngineCycleDuration(rpm PASS_ENGINE_PARAMETER_SUFFIX)) {
+	} else if (isCranking && injectionDuration * getNumberOfInjections(ENGINE(hotConfig.crankingInjectionMode) PASS_ENGINE_PARAMETER_SUFFIX) > getEngineCycleDuration(rpm PASS_ENGINE_PARAMETER_SUFFIX)) {
 		warning(CUSTOM_TOO_LONG_CRANKING_FUEL_INJECTION, "Too long cranking fuel injection %.2fms", injectionDuration);
 	}
 
@@ -225,11 +232,11 @@ static ALWAYS_INLINE void handleFuelInjectionEvent(int injEventIndex, InjectionE
 
 
 	// we are ignoring low RPM in order not to handle "engine was stopped to engine now running" transition
-	if (rpm > 2 * engineConfiguration->cranking.rpm) {
+	if (rpm > 2 * ENGINE(hotConfig.crankingRpm)) {
 		const char *outputName = event->outputs[0]->name;
 		if (prevOutputName == outputName
-				&& engineConfiguration->injectionMode != IM_SIMULTANEOUS
-				&& engineConfiguration->injectionMode != IM_SINGLE_POINT) {
+				&& ENGINE(hotConfig.injectionMode) != IM_SIMULTANEOUS
+				&& ENGINE(hotConfig.injectionMode) != IM_SINGLE_POINT) {
 			warning(CUSTOM_OBD_SKIPPED_FUEL, "looks like skipped fuel event %d %s", getRevolutionCounter(), outputName);
 		}
 		prevOutputName = outputName;
@@ -253,17 +260,20 @@ static ALWAYS_INLINE void handleFuelInjectionEvent(int injEventIndex, InjectionE
 	action_s startAction, endAction;
 	// We use different callbacks based on whether we're running sequential mode or not - everything else is the same
 	if (event->isSimultanious) {
-		startAction = { &startSimultaniousInjection, engine };
-		endAction = { &endSimultaniousInjection, event };
+		startAction = { &startSimultaniousInjection, engine, SCHEDULE_PRIORITY_INJECTION };
+		endAction = { &endSimultaniousInjection, event, SCHEDULE_PRIORITY_INJECTION };
 	} else {
 		// sequential or batch
-		startAction = { &turnInjectionPinHigh, event };
-		endAction = { &turnInjectionPinLow, event };
+		startAction = { &turnInjectionPinHigh, event, SCHEDULE_PRIORITY_INJECTION };
+		endAction = { &turnInjectionPinLow, event, SCHEDULE_PRIORITY_INJECTION };
 	}
 
+	// both edges of the injection signal are submitted as one batch: single lock, single timer re-arm
+	engine->executor.batchBegin();
 	efitick_t startTime = scheduleByAngle(&event->signalTimerUp, nowNt, event->injectionStart.angleOffsetFromTriggerEvent, startAction PASS_ENGINE_PARAMETER_SUFFIX);
 	efitick_t turnOffTime = startTime + US2NT((int)durationUs);
 	engine->executor.scheduleByTimestampNt(&event->endOfInjectionEvent, turnOffTime, endAction);
+	engine->executor.batchEnd();
 
 #if EFI_UNIT_TEST
 		printf("scheduling injection angle=%.2f/delay=%.2f injectionDuration=%.2f\r\n", event->injectionStart.angleOffsetFromTriggerEvent, NT2US(startTime - nowNt), injectionDuration);
@@ -320,9 +330,11 @@ static ALWAYS_INLINE void handleFuel(const bool limitedFuel, uint32_t trgEventIn
 	 * Ignition events are defined by addFuelEvents() according to selected
 	 * fueling strategy
 	 */
-	FuelSchedule *fs = &ENGINE(injectionEvents);
+	FuelSchedule *fs = ENGINE(injectionEvents);
 	if (!fs->isReady) {
-		fs->addFuelEvents(PASS_ENGINE_PARAMETER_SIGNATURE);
+		ENGINE(rebuildFuelSchedule(PASS_ENGINE_PARAMETER_SIGNATURE));
+		// the published pointer may have just moved to the freshly built buffer
+		fs = ENGINE(injectionEvents);
 	}
 
 #if FUEL_MATH_EXTREME_LOGGING
@@ -333,9 +345,12 @@ static ALWAYS_INLINE void handleFuel(const bool limitedFuel, uint32_t trgEventIn
 	if (trgEventIndex == 0) {
 		ENGINE(tpsAccelEnrichment.onEngineCycleTps(PASS_ENGINE_PARAMETER_SIGNATURE));
 		ENGINE(engineLoadAccelEnrichment.onEngineCycle(PASS_ENGINE_PARAMETER_SIGNATURE));
+#if EFI_DFCO_SEQUENCER
+		dfcoOnEngineCycle(PASS_ENGINE_PARAMETER_SIGNATURE);
+#endif /* EFI_DFCO_SEQUENCER */
 	}
 
-	for (int injEventIndex = 0; injEventIndex < CONFIG(specs.cylindersCount); injEventIndex++) {
+	for (int injEventIndex = 0; injEventIndex < ENGINE(hotConfig.cylindersCount); injEventIndex++) {
 		InjectionEvent *event = &fs->elements[injEventIndex];
 		uint32_t eventIndex = event->injectionStart.triggerEventIndex;
 // right after trigger change we are still using old & invalid fuel schedule. good news is we do not change trigger on the fly in real life
@@ -400,16 +415,32 @@ static void mainTriggerCallback(trigger_event_e ckpSignalType, uint32_t trgEvent
 		// TODO: add 'pin shutdown' invocation somewhere - coils might be still open here!
 		return;
 	}
-	bool limitedSpark = rpm > CONFIG(rpmHardLimit);
-	bool limitedFuel = rpm > CONFIG(rpmHardLimit);
+	/**
+	 * Predictive rev limiting: reacting only once computed RPM has crossed the limit makes
+	 * the first cut cycle late by one decode latency, which is the overshoot band at a
+	 * 2-step launch. Forecast RPM at the next ignition event from the per-cycle RPM delta
+	 * and make the cut decision in the same batch as the coil events.
+	 */
+	int predictedRpm = rpm;
+	int previousRpm = ENGINE(rpmCalculator).previousRpmValue;
+	if (previousRpm > 0 && rpm > previousRpm) {
+		// ignition events are spread evenly over the 720 degree cycle
+		predictedRpm = rpm + (rpm - previousRpm) / maxI(1, ENGINE(hotConfig.cylindersCount));
+	}
+	bool limitedSpark = predictedRpm > ENGINE(hotConfig.rpmHardLimit);
+	bool limitedFuel = predictedRpm > ENGINE(hotConfig.rpmHardLimit);
 
-	if (CONFIG(boostCutPressure) !=0) {
-		if (getMap(PASS_ENGINE_PARAMETER_SIGNATURE) > CONFIG(boostCutPressure)) {
+	if (ENGINE(hotConfig.boostCutPressure) !=0) {
+		if (getMap(PASS_ENGINE_PARAMETER_SIGNATURE) > ENGINE(hotConfig.boostCutPressure)) {
 			limitedSpark = true;
 			limitedFuel = true;
 		}
 	}
 
+#if EFI_CYLINDER_BALANCE
+	onCylinderBalanceTriggerTooth(trgEventIndex, edgeTimestamp PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_CYLINDER_BALANCE */
+
 	if (limitedSpark || limitedFuel) {
 		// todo: this is not really a warning
 		warning(CUSTOM_SKIPPING_STROKE, "skipping stroke due to rpm=%d", rpm);
@@ -422,7 +453,7 @@ static void mainTriggerCallback(trigger_event_e ckpSignalType, uint32_t trgEvent
 
 		if (checkIfTriggerConfigChanged(PASS_ENGINE_PARAMETER_SIGNATURE)) {
 			engine->ignitionEvents.isReady = false; // we need to rebuild complete ignition schedule
-			engine->injectionEvents.isReady = false;
+			engine->rebuildFuelSchedule(PASS_ENGINE_PARAMETER_SIGNATURE);
 			// moved 'triggerIndexByAngle' into trigger initialization (why was it invoked from here if it's only about trigger shape & optimization?)
 			// see initializeTriggerWaveform() -> prepareOutputSignals(PASS_ENGINE_PARAMETER_SIGNATURE)
 
@@ -433,11 +464,16 @@ static void mainTriggerCallback(trigger_event_e ckpSignalType, uint32_t trgEvent
 		if (CONFIG(fuelClosedLoopCorrectionEnabled)) {
 			fuelClosedLoopCorrection(PASS_ENGINE_PARAMETER_SIGNATURE);
 		}
+
+#if EFI_BOOST_CONTROL
+		// wastegate duty rides the same per-cycle batch as the injection math
+		onEngineCycleBoostControl(rpm PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_BOOST_CONTROL */
 	}
 
-	efiAssertVoid(CUSTOM_IGN_MATH_STATE, !CONFIG(useOnlyRisingEdgeForTrigger) || CONFIG(ignMathCalculateAtIndex) % 2 == 0, "invalid ignMathCalculateAtIndex");
+	efiAssertVoid(CUSTOM_IGN_MATH_STATE, !CONFIG(useOnlyRisingEdgeForTrigger) || ENGINE(hotConfig.ignMathCalculateAtIndex) % 2 == 0, "invalid ignMathCalculateAtIndex");
 
-	if (trgEventIndex == (uint32_t)CONFIG(ignMathCalculateAtIndex)) {
+	if (trgEventIndex == (uint32_t)ENGINE(hotConfig.ignMathCalculateAtIndex)) {
 		if (CONFIG(externalKnockSenseAdc) != EFI_ADC_NONE) {
 			float externalKnockValue = getVoltageDivided("knock", engineConfiguration->externalKnockSenseAdc PASS_ENGINE_PARAMETER_SUFFIX);
 			engine->knockLogic(externalKnockValue PASS_ENGINE_PARAMETER_SUFFIX);
@@ -445,6 +481,13 @@ static void mainTriggerCallback(trigger_event_e ckpSignalType, uint32_t trgEvent
 	}
 
 
+	/**
+	 * Pending angle-based events are converted into hardware timers here, on every tooth,
+	 * regardless of whether ignition or injection are enabled - auxiliary consumers use the
+	 * same angle-domain scheduling API.
+	 */
+	scheduleAngleEventsUntilNextTriggerTooth(trgEventIndex, edgeTimestamp PASS_ENGINE_PARAMETER_SUFFIX);
+
 	/**
 	 * For fuel we schedule start of injection based on trigger angle, and then inject for
 	 * specified duration of time
@@ -464,7 +507,7 @@ static void mainTriggerCallback(trigger_event_e ckpSignalType, uint32_t trgEvent
 static bool isPrimeInjectionPulseSkipped(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	if (!engine->rpmCalculator.isStopped(PASS_ENGINE_PARAMETER_SIGNATURE))
 		return true;
-	return CONFIG(isCylinderCleanupEnabled) && (getTPS(PASS_ENGINE_PARAMETER_SIGNATURE) > CLEANUP_MODE_TPS);
+	return ENGINE(hotConfig.isCylinderCleanupEnabled) && (getTPS(PASS_ENGINE_PARAMETER_SIGNATURE) > CLEANUP_MODE_TPS);
 }
 
 /**
@@ -496,7 +539,7 @@ void startPrimeInjectionPulse(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 		primeInjEvent.ownIndex = 0;
 		primeInjEvent.isSimultanious = true;
 
-		scheduling_s *sDown = &ENGINE(injectionEvents.elements[0]).endOfInjectionEvent;
+		scheduling_s *sDown = &ENGINE(injectionEvents)->elements[0].endOfInjectionEvent;
 		// When the engine is hot, basically we don't need prime inj.pulse, so we use an interpolation over temperature (falloff).
 		// If 'primeInjFalloffTemperature' is not specified (by default), we have a prime pulse deactivation at zero celsius degrees, which is okay.
 		const float maxPrimeInjAtTemperature = -40.0f;	// at this temperature the pulse is maximal.
@@ -505,7 +548,7 @@ void startPrimeInjectionPulse(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 		if (pulseLength > 0) {
 			startSimultaniousInjection(engine);
 			efitimeus_t turnOffDelayUs = (efitimeus_t)efiRound(MS2US(pulseLength), 1.0f);
-			engine->executor.scheduleForLater(sDown, turnOffDelayUs, { &endSimultaniousInjectionOnlyTogglePins, engine });
+			engine->executor.scheduleForLater(sDown, turnOffDelayUs, { &endSimultaniousInjectionOnlyTogglePins, engine, SCHEDULE_PRIORITY_INJECTION });
 		}
 	}
 #if EFI_PROD_CODE
@@ -60,21 +60,27 @@ static volatile int measurementsPerRevolutionCounter = 0;
 static volatile int measurementsPerRevolution = 0;
 
 /**
- * In this lock-free implementation 'readIndex' is always pointing
- * to the consistent copy of accumulator and counter pair
+ * Lock-free running prefix sum of all MAP samples ever taken: the ADC callback is the
+ * only writer and 'readIndex' is always pointing to the consistent sum and counter pair.
+ * Averaging windows are just two snapshots of this state - the ISR does not know or
+ * care where the windows are.
  */
 static int readIndex = 0;
-static float accumulators[2];
-static int counters[2];
+static uint64_t sampleSums[2];
+static uint32_t sampleCounts[2];
 
 /**
- * Running MAP accumulator - sum of all measurements within averaging window
+ * prefix sum state captured by startAveraging()
  */
-static volatile float mapAdcAccumulator = 0;
+static uint64_t windowStartSum = 0;
+static uint32_t windowStartCount = 0;
 /**
- * Running counter of measurements to consider for averaging
+ * latest completed window, published by endAveraging() and folded into the
+ * min-buffer in thread context, see processPendingWindow()
  */
-static volatile int mapMeasurementsCounter = 0;
+static uint64_t windowSum = 0;
+static uint32_t windowCount = 0;
+static volatile bool windowPending = false;
 
 /**
  * v_ for Voltage
@@ -108,18 +114,25 @@ static scheduling_s endTimer[INJECTION_PIN_COUNT][2];
  */
 static bool isAveraging = false;
 
+/**
+ * Consistent snapshot of the running prefix sum. The retry loop handles the ADC
+ * callback committing a new pair while we are half-way through reading one.
+ */
+static void readSampleState(uint64_t *sum, uint32_t *count) {
+	int localIndex;
+	do {
+		localIndex = readIndex;
+		*sum = sampleSums[localIndex];
+		*count = sampleCounts[localIndex];
+	} while (localIndex != readIndex);
+}
+
 static void startAveraging(void *arg) {
 	(void) arg;
 	efiAssertVoid(CUSTOM_ERR_6649, getCurrentRemainingStack() > 128, "lowstck#9");
 
-	bool wasLocked = lockAnyContext();
-	// with locking we would have a consistent state
-	mapAdcAccumulator = 0;
-	mapMeasurementsCounter = 0;
+	readSampleState(&windowStartSum, &windowStartCount);
 	isAveraging = true;
-	if (!wasLocked) {
-		unlockAnyContext();
-	}
 
 	mapAveragingPin.setHigh();
 }
@@ -152,60 +165,68 @@ void mapAveragingAdcCallback(adcsample_t adcValue) {
 	}
 #endif /* EFI_SENSOR_CHART */
 
-	/**
-	 * Local copy is now safe, but it's an overkill: we only
-	 * have one writing thread anyway
-	 */
 	int readIndexLocal = readIndex;
 	int writeIndex = readIndexLocal ^ 1;
-	accumulators[writeIndex] = accumulators[readIndexLocal] + adcValue;
-	counters[writeIndex] = counters[readIndexLocal] + 1;
-	// this would commit the new pair of values
+	sampleSums[writeIndex] = sampleSums[readIndexLocal] + adcValue;
+	sampleCounts[writeIndex] = sampleCounts[readIndexLocal] + 1;
+	// this commits the new pair of values
 	readIndex = writeIndex;
+}
+
+/**
+ * Zero-copy flavor of the callback above: 'samples' points straight into the live DMA
+ * buffer, 'stride' is the scan sequence width in samples and 'count' is how many scan
+ * rows the completed buffer chunk holds. All rows are folded into the accumulator in
+ * one pass - with the per-sample flavor every row but the first one of each conversion
+ * used to be thrown away.
+ */
+void mapAveragingAdcBufferCallback(const adcsample_t *samples, size_t stride, size_t count) {
+	if (!isAveraging && ENGINE(sensorChartMode) != SC_MAP) {
+		return;
+	}
+
+	efiAssertVoid(CUSTOM_ERR_6650, getCurrentRemainingStack() > 128, "lowstck#9a");
+
+#if EFI_SENSOR_CHART && EFI_ANALOG_SENSORS
+	if (ENGINE(sensorChartMode) == SC_MAP) {
+		if (measurementsPerRevolutionCounter % FAST_MAP_CHART_SKIP_FACTOR
+				== 0) {
+			float voltage = adcToVoltsDivided(samples[0]);
+			float currentPressure = getMapByVoltage(voltage);
+			scAddData(
+					getCrankshaftAngleNt(getTimeNowNt() PASS_ENGINE_PARAMETER_SUFFIX),
+					currentPressure);
+		}
+	}
+#endif /* EFI_SENSOR_CHART */
 
-	// todo: migrate to the lock-free implementation
-	bool alreadyLocked = lockAnyContext();
-	;
-	// with locking we would have a consistent state
+	uint32_t chunkAccumulator = 0;
+	for (size_t i = 0; i < count; i++) {
+		chunkAccumulator += samples[i * stride];
+	}
+	measurementsPerRevolutionCounter += count;
 
-	mapAdcAccumulator += adcValue;
-	mapMeasurementsCounter++;
-	if (!alreadyLocked)
-		unlockAnyContext();
-	;
+	int readIndexLocal = readIndex;
+	int writeIndex = readIndexLocal ^ 1;
+	sampleSums[writeIndex] = sampleSums[readIndexLocal] + chunkAccumulator;
+	sampleCounts[writeIndex] = sampleCounts[readIndexLocal] + count;
+	// this commits the new pair of values
+	readIndex = writeIndex;
 }
 #endif
 
 static void endAveraging(void *arg) {
 	(void) arg;
-#if ! EFI_UNIT_TEST
-	bool wasLocked = lockAnyContext();
-#endif
 	isAveraging = false;
-	// with locking we would have a consistent state
-#if HAL_USE_ADC
-	if (mapMeasurementsCounter > 0) {
-		v_averagedMapValue = adcToVoltsDivided(mapAdcAccumulator / mapMeasurementsCounter);
-		// todo: move out of locked context?
-		averagedMapRunningBuffer[averagedMapBufIdx] = getMapByVoltage(v_averagedMapValue);
-		// increment circular running buffer index
-		averagedMapBufIdx = (averagedMapBufIdx + 1) % mapMinBufferLength;
-		// find min. value (only works for pressure values, not raw voltages!)
-		float minPressure = averagedMapRunningBuffer[0];
-		for (int i = 1; i < mapMinBufferLength; i++) {
-			if (averagedMapRunningBuffer[i] < minPressure)
-				minPressure = averagedMapRunningBuffer[i];
-		}
-		currentPressure = minPressure;
-	} else {
-		warning(CUSTOM_UNEXPECTED_MAP_VALUE, "No MAP values");
-	}
-#endif
-#if ! EFI_UNIT_TEST
-	if (!wasLocked)
-		unlockAnyContext();
-	;
-#endif
+
+	uint64_t endSum;
+	uint32_t endCount;
+	readSampleState(&endSum, &endCount);
+	// two snapshots of the running prefix sum bracket exactly the in-window samples
+	windowSum = endSum - windowStartSum;
+	windowCount = endCount - windowStartCount;
+	windowPending = true;
+
 	mapAveragingPin.setLow();
 }
 
@@ -225,7 +246,7 @@ void postMapState(TunerStudioOutputChannels *tsOutputChannels) {
 	tsOutputChannels->debugFloatField1 = v_averagedMapValue;
 	tsOutputChannels->debugFloatField2 = engine->engineState.mapAveragingDuration;
 	tsOutputChannels->debugFloatField3 = currentPressure;
-	tsOutputChannels->debugIntField1 = mapMeasurementsCounter;
+	tsOutputChannels->debugIntField1 = windowCount;
 }
 #endif /* EFI_TUNER_STUDIO */
 
@@ -329,6 +350,36 @@ static void showMapStats(void) {
 
 #if EFI_PROD_CODE
 
+/**
+ * Folds the most recent completed averaging window into the MAP min-buffer. This runs
+ * in thread context - the voltage division, pressure curve lookup and min-scan used to
+ * live inside the locked endAveraging() callback in interrupt context. Worst case a
+ * window completes while we are here and we pick up the fresher one next time around.
+ */
+static void processPendingWindow(void) {
+#if HAL_USE_ADC
+	if (!windowPending) {
+		return;
+	}
+	windowPending = false;
+	if (windowCount == 0) {
+		warning(CUSTOM_UNEXPECTED_MAP_VALUE, "No MAP values");
+		return;
+	}
+	v_averagedMapValue = adcToVoltsDivided((float)windowSum / windowCount);
+	averagedMapRunningBuffer[averagedMapBufIdx] = getMapByVoltage(v_averagedMapValue);
+	// increment circular running buffer index
+	averagedMapBufIdx = (averagedMapBufIdx + 1) % mapMinBufferLength;
+	// find min. value (only works for pressure values, not raw voltages!)
+	float minPressure = averagedMapRunningBuffer[0];
+	for (int i = 1; i < mapMinBufferLength; i++) {
+		if (averagedMapRunningBuffer[i] < minPressure)
+			minPressure = averagedMapRunningBuffer[i];
+	}
+	currentPressure = minPressure;
+#endif /* HAL_USE_ADC */
+}
+
 /**
  * Because of MAP window averaging, MAP is only available while engine is spinning
  * @return Manifold Absolute Pressure, in kPa
@@ -338,6 +389,8 @@ float getMap(void) {
 		return getRawMap();
 	}
 
+	processPendingWindow();
+
 #if EFI_ANALOG_SENSORS
 	if (!isValidRpm(GET_RPM_VALUE) || currentPressure == NO_VALUE_YET)
 		return validateMap(getRawMap()); // maybe return NaN in case of stopped engine?
@@ -13,6 +13,7 @@
 
 #if HAL_USE_ADC
 void mapAveragingAdcCallback(adcsample_t newValue);
+void mapAveragingAdcBufferCallback(const adcsample_t *samples, size_t stride, size_t count);
 #endif
 
 void initMapAveraging(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX);
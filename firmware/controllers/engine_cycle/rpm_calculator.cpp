@@ -97,6 +97,32 @@ RpmCalculator::RpmCalculator() {
 
 	// we need this initial to have not_running at first invocation
 	lastRpmEventTimeNt = (efitick_t) DEEP_IN_THE_PAST_SECONDS * NT_PER_SECOND;
+	publishStateSnapshot();
+}
+
+void RpmCalculator::publishStateSnapshot() {
+	// odd sequence value tells readers that a write is in progress
+	snapshotSequence++;
+	stateSnapshot.rpm = rpmValue;
+	stateSnapshot.oneDegreeUs = oneDegreeUs;
+	stateSnapshot.lastRpmEventTimeNt = lastRpmEventTimeNt;
+	stateSnapshot.revolutionCounter = revolutionCounterSinceBoot;
+	snapshotSequence++;
+}
+
+void RpmCalculator::getStateSnapshot(rpm_snapshot_s *snapshot) const {
+	uint32_t sequence;
+	do {
+		sequence = snapshotSequence;
+		if (sequence & 1) {
+			// the writer is in the middle of an update, which is just a handful of stores - spin
+			continue;
+		}
+		snapshot->rpm = stateSnapshot.rpm;
+		snapshot->oneDegreeUs = stateSnapshot.oneDegreeUs;
+		snapshot->lastRpmEventTimeNt = stateSnapshot.lastRpmEventTimeNt;
+		snapshot->revolutionCounter = stateSnapshot.revolutionCounter;
+	} while (sequence != snapshotSequence);
 }
 
 /**
@@ -147,6 +173,7 @@ void RpmCalculator::assignRpmValue(float floatRpmValue DECLARE_ENGINE_PARAMETER_
 			ENGINE(periodicFastCallback(PASS_ENGINE_PARAMETER_SIGNATURE));
 		}
 	}
+	publishStateSnapshot();
 }
 
 void RpmCalculator::setRpmValue(float value DECLARE_ENGINE_PARAMETER_SUFFIX) {
@@ -168,7 +195,7 @@ void RpmCalculator::setRpmValue(float value DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	// This presumably fixes injection mode change for cranking-to-running transition.
 	// 'isSimultanious' flag should be updated for events if injection modes differ for cranking and running.
 	if (state != oldState) {
-		engine->injectionEvents.addFuelEvents(PASS_ENGINE_PARAMETER_SIGNATURE);
+		engine->rebuildFuelSchedule(PASS_ENGINE_PARAMETER_SIGNATURE);
 	}
 #endif
 }
@@ -180,6 +207,7 @@ spinning_state_e RpmCalculator::getState() const {
 void RpmCalculator::onNewEngineCycle() {
 	revolutionCounterSinceBoot++;
 	revolutionCounterSinceStart++;
+	publishStateSnapshot();
 }
 
 uint32_t RpmCalculator::getRevolutionCounterM(void) const {
@@ -254,8 +282,9 @@ void rpmShaftPositionCallback(trigger_event_e ckpSignalType,
 				rpmState->setRpmValue(rpm > UNREALISTIC_RPM ? NOISY_RPM : rpm PASS_ENGINE_PARAMETER_SUFFIX);
 			}
 		}
-		rpmState->onNewEngineCycle();
+		// the new cycle snapshot is published by onNewEngineCycle(), set the timestamp first
 		rpmState->lastRpmEventTimeNt = nowNt;
+		rpmState->onNewEngineCycle();
 		ENGINE(m.rpmCbTime) = getTimeNowLowerNt() - ENGINE(m.beforeRpmCb);
 	}
 
@@ -332,15 +361,23 @@ static void tdcMarkCallback(trigger_event_e ckpSignalType,
  * @return Current crankshaft angle, 0 to 720 for four-stroke
  */
 float getCrankshaftAngleNt(efitick_t timeNt DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	efitick_t timeSinceZeroAngleNt = timeNt
-			- engine->rpmCalculator.lastRpmEventTimeNt;
+	// rpm and cycle timestamp have to be from the same engine cycle, otherwise a trigger
+	// event between the two reads would give us a wildly wrong angle
+	rpm_snapshot_s snapshot;
+	ENGINE(rpmCalculator).getStateSnapshot(&snapshot);
+
+	efitick_t timeSinceZeroAngleNt = timeNt - snapshot.lastRpmEventTimeNt;
 
 	/**
 	 * even if we use 'getOneDegreeTimeUs' macros here, it looks like the
 	 * compiler is not smart enough to figure out that "A / ( B / C)" could be optimized into
 	 * "A * C / B" in order to replace a slower division with a faster multiplication.
 	 */
+#if EFI_PROD_CODE
+	int rpm = snapshot.rpm;
+#else
 	int rpm = GET_RPM();
+#endif /* EFI_PROD_CODE */
 	return rpm == 0 ? NAN : timeSinceZeroAngleNt / getOneDegreeTimeNt(rpm);
 }
 
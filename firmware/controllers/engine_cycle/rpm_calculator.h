@@ -40,6 +40,20 @@ typedef enum {
 	RUNNING,
 } spinning_state_e;
 
+/**
+ * Consistent multi-field view of the decoded shaft state for lock-free readers,
+ * see RpmCalculator#getStateSnapshot()
+ */
+typedef struct {
+	int rpm;
+	/**
+	 * NaN while engine is not spinning
+	 */
+	floatus_t oneDegreeUs;
+	efitick_t lastRpmEventTimeNt;
+	uint32_t revolutionCounter;
+} rpm_snapshot_s;
+
 class RpmCalculator {
 public:
 #if !EFI_PROD_CODE
@@ -96,6 +110,13 @@ public:
 	 */
 	void assignRpmValue(float value DECLARE_ENGINE_PARAMETER_SUFFIX);
 	uint32_t getRevolutionCounterSinceStart(void) const;
+	/**
+	 * Copies rpm, oneDegreeUs, lastRpmEventTimeNt and revolution counter as one consistent unit
+	 * without disabling interrupts. This is a sequence counter scheme: the trigger callback is the
+	 * single writer and any thread is free to read, a torn copy is simply retried. Readers which
+	 * only need one of these fields can keep reading the individual volatile members directly.
+	 */
+	void getStateSnapshot(rpm_snapshot_s *snapshot) const;
 	/**
 	 * RPM rate of change between current RPM and RPM measured during previous engine cycle
 	 * see also SC_RPM_ACCEL
@@ -122,6 +143,22 @@ private:
 	 */
 	void setStopped(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 
+	/**
+	 * Re-publishes the snapshot from current field values, only to be invoked from the
+	 * trigger callback / writer side. See getStateSnapshot()
+	 */
+	void publishStateSnapshot();
+
+	/**
+	 * Sequence counter for the snapshot: odd while the writer is mid-update, even otherwise.
+	 */
+	volatile uint32_t snapshotSequence = 0;
+	/**
+	 * volatile so that the field-by-field copies in publishStateSnapshot()/getStateSnapshot()
+	 * are ordered against the sequence counter accesses by the compiler
+	 */
+	volatile rpm_snapshot_s stateSnapshot;
+
 	/**
 	 * This counter is incremented with each revolution of one of the shafts. Could be
 	 * crankshaft could be camshaft.
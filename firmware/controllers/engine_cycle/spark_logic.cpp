@@ -6,6 +6,7 @@
  */
 
 #include "spark_logic.h"
+#include "angle_scheduler.h"
 #include "os_access.h"
 #include "engine_math.h"
 
@@ -17,12 +18,17 @@
 #include "tunerstudio_configuration.h"
 #endif /* EFI_TUNER_STUDIO */
 
+#if EFI_HIP_9011
+#include "hip9011.h"
+#include "cdm_ion_sense.h"
+#endif /* EFI_HIP_9011 */
+
 EXTERN_ENGINE;
 #if EFI_UNIT_TEST
 extern bool verboseMode;
 #endif /* EFI_UNIT_TEST */
 
-static cyclic_buffer<int> ignitionErrorDetection;
+static running_cyclic_buffer<int, 8> ignitionErrorDetection(6);
 static Logging *logger;
 
 static const char *prevSparkName = nullptr;
@@ -33,7 +39,7 @@ int isInjectionEnabled(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 }
 
 int isIgnitionTimingError(void) {
-	return ignitionErrorDetection.sum(6) > 4;
+	return ignitionErrorDetection.getRunningSum() > 4;
 }
 
 static void fireSparkBySettingPinLow(IgnitionEvent *event, IgnitionOutputPin *output) {
@@ -91,13 +97,13 @@ static void prepareCylinderIgnitionSchedule(angle_t dwellAngleDuration, floatms_
 
 	efiAssertVoid(CUSTOM_SPARK_ANGLE_1, !cisnan(sparkAngle), "sparkAngle#1");
 	const int index = ENGINE(ignitionPin[event->cylinderIndex]);
-	const int coilIndex = ID2INDEX(getCylinderId(index PASS_ENGINE_PARAMETER_SUFFIX));
+	const int coilIndex = ENGINE(hotConfig.cylinderIndexByFiringIndex[index]);
 	IgnitionOutputPin *output = &enginePins.coils[coilIndex];
 
 	IgnitionOutputPin *secondOutput;
 	if (getCurrentIgnitionMode(PASS_ENGINE_PARAMETER_SIGNATURE) == IM_WASTED_SPARK && CONFIG(twoWireBatchIgnition)) {
 		int secondIndex = index + CONFIG(specs.cylindersCount) / 2;
-		int secondCoilIndex = ID2INDEX(getCylinderId(secondIndex PASS_ENGINE_PARAMETER_SUFFIX));
+		int secondCoilIndex = ENGINE(hotConfig.cylinderIndexByFiringIndex[secondIndex]);
 		secondOutput = &enginePins.coils[secondCoilIndex];
 		assertPinAssigned(secondOutput);
 	} else {
@@ -129,6 +135,10 @@ void fireSparkAndPrepareNextSchedule(IgnitionEvent *event) {
 			fireSparkBySettingPinLow(event, output);
 		}
 	}
+#if EFI_CDM_INTEGRATION
+	// combustion starts now: open the ion burn capture window for this cylinder
+	ionOnSparkFired(event->cylinderIndex);
+#endif /* EFI_CDM_INTEGRATION */
 #if !EFI_UNIT_TEST
 if (engineConfiguration->debugMode == DBG_DWELL_METRIC) {
 #if EFI_TUNER_STUDIO
@@ -217,67 +227,14 @@ void turnSparkPinHigh(IgnitionEvent *event) {
 	}
 }
 
-static bool assertNotInIgnitionList(AngleBasedEvent *head, AngleBasedEvent *element) {
-	assertNotInListMethodBody(AngleBasedEvent, head, element, nextToothEvent)
-}
-
-/**
- * @return true if event corresponds to current tooth and was time-based scheduler
- *         false if event was put into queue for scheduling at a later tooth
- */
-bool scheduleOrQueue(AngleBasedEvent *event,
-		uint32_t trgEventIndex,
-		efitick_t edgeTimestamp,
-		angle_t angle,
-		action_s action
-		DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	event->position.setAngle(angle PASS_ENGINE_PARAMETER_SUFFIX);
-
-	/**
-	 * Here's the status as of Jan 2020:
-	 * Once we hit the last trigger tooth prior to needed event, schedule it by time.  We use as much trigger position angle as possible
-	 * and only use less precise RPM-based time calculation for the last portion of the angle, the one between two teeth closest to the
-	 * desired angle moment.
-	 */
-	if (trgEventIndex != TRIGGER_EVENT_UNDEFINED && event->position.triggerEventIndex == trgEventIndex) {
-		/**
-		 * Spark should be fired before the next trigger event - time-based delay is best precision possible
-		 */
-		scheduling_s * sDown = &event->scheduling;
-
-		scheduleByAngle(
-			sDown,
-			edgeTimestamp,
-			event->position.angleOffsetFromTriggerEvent,
-			action
-			PASS_ENGINE_PARAMETER_SUFFIX
-		);
-
-		return true;
-	} else {
-		event->action = action;
-		/**
-		 * Spark should be scheduled in relation to some future trigger event, this way we get better firing precision
-		 */
-		bool isPending = assertNotInIgnitionList(ENGINE(angleBasedEventsHead), event);
-		if (isPending) {
-#if SPARK_EXTREME_LOGGING
-			scheduleMsg(logger, "isPending thus not adding to queue index=%d rev=%d now=%d", trgEventIndex, getRevolutionCounter(), (int)getTimeNowUs());
-#endif /* FUEL_MATH_EXTREME_LOGGING */
-		} else {
-			LL_APPEND2(ENGINE(angleBasedEventsHead), event, nextToothEvent);
-		}
-		return false;
-	}
-}
-
 static ALWAYS_INLINE void handleSparkEvent(bool limitedSpark, uint32_t trgEventIndex, IgnitionEvent *iEvent,
 		int rpm, efitick_t edgeTimestamp DECLARE_ENGINE_PARAMETER_SUFFIX) {
 
 	angle_t sparkAngle = iEvent->sparkAngle;
-	const floatms_t dwellMs = ENGINE(engineState.sparkDwell);
-	if (cisnan(dwellMs) || dwellMs <= 0) {
-		warning(CUSTOM_DWELL, "invalid dwell to handle: %.2f at %d", dwellMs, rpm);
+	// integer mirror of engineState.sparkDwell, zero covers both NaN and non-positive
+	const uint32_t dwellUs = ENGINE(engineState.sparkDwellUs);
+	if (dwellUs == 0) {
+		warning(CUSTOM_DWELL, "invalid dwell to handle: %.2f at %d", ENGINE(engineState.sparkDwell), rpm);
 		return;
 	}
 	if (cisnan(sparkAngle)) {
@@ -304,6 +261,11 @@ static ALWAYS_INLINE void handleSparkEvent(bool limitedSpark, uint32_t trgEventI
 	 */
 	scheduling_s * sUp = &iEvent->dwellStartTimer;
 
+	efiAssertVoid(CUSTOM_ERR_6591, !cisnan(sparkAngle), "findAngle#4");
+	assertAngleRange(sparkAngle, "findAngle#a5", CUSTOM_ERR_6549);
+
+	// both edges of the coil signal are submitted as one batch: single lock, single timer re-arm
+	engine->executor.batchBegin();
 
 	/**
 	 * The start of charge is always within the current trigger event range, so just plain time-based scheduling
@@ -320,17 +282,20 @@ static ALWAYS_INLINE void handleSparkEvent(bool limitedSpark, uint32_t trgEventI
 		 * This way we make sure that coil dwell started while spark was enabled would fire and not burn
 		 * the coil.
 		 */
-		engine->executor.scheduleByTimestampNt(sUp, edgeTimestamp + US2NT(chargeDelayUs), { &turnSparkPinHigh, iEvent });
+		engine->executor.scheduleByTimestampNt(sUp, edgeTimestamp + US2NT(chargeDelayUs), { &turnSparkPinHigh, iEvent, SCHEDULE_PRIORITY_IGNITION });
 	}
 	/**
 	 * Spark event is often happening during a later trigger event timeframe
 	 */
 
-	efiAssertVoid(CUSTOM_ERR_6591, !cisnan(sparkAngle), "findAngle#4");
-	assertAngleRange(sparkAngle, "findAngle#a5", CUSTOM_ERR_6549);
+	bool scheduled = scheduleOrQueue(&iEvent->sparkEvent, trgEventIndex, edgeTimestamp, sparkAngle, { fireSparkAndPrepareNextSchedule, iEvent, SCHEDULE_PRIORITY_IGNITION } PASS_ENGINE_PARAMETER_SUFFIX);
 
+#if EFI_HIP_9011
+	// the knock integration window for this cylinder rides in the same batch as the coil events
+	hip9011_onIgnitionEvent(iEvent, trgEventIndex, edgeTimestamp PASS_ENGINE_PARAMETER_SUFFIX);
+#endif /* EFI_HIP_9011 */
 
-	bool scheduled = scheduleOrQueue(&iEvent->sparkEvent, trgEventIndex, edgeTimestamp, sparkAngle, { fireSparkAndPrepareNextSchedule, iEvent } PASS_ENGINE_PARAMETER_SUFFIX);
+	engine->executor.batchEnd();
 
 	if (scheduled) {
 #if SPARK_EXTREME_LOGGING
@@ -363,9 +328,8 @@ void initializeIgnitionActions(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 		list->isReady = false;
 		return;
 	}
-	efiAssertVoid(CUSTOM_ERR_6592, engineConfiguration->specs.cylindersCount > 0, "cylindersCount");
-
-	for (int cylinderIndex = 0; cylinderIndex < CONFIG(specs.cylindersCount); cylinderIndex++) {
+	// count normalized once per configuration change, see Engine::validateConfiguration()
+	for (int cylinderIndex = 0; cylinderIndex < ENGINE(validatedConfig.cylindersCount); cylinderIndex++) {
 		list->elements[cylinderIndex].cylinderIndex = cylinderIndex;
 #if EFI_UNIT_TEST
 		list->elements[cylinderIndex].engine = engine;
@@ -406,32 +370,6 @@ static ALWAYS_INLINE void prepareIgnitionSchedule(DECLARE_ENGINE_PARAMETER_SIGNA
 }
 
 
-static void scheduleAllSparkEventsUntilNextTriggerTooth(uint32_t trgEventIndex, efitick_t edgeTimestamp DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	AngleBasedEvent *current, *tmp;
-
-	LL_FOREACH_SAFE2(ENGINE(angleBasedEventsHead), current, tmp, nextToothEvent)
-	{
-		if (current->position.triggerEventIndex == trgEventIndex) {
-			// time to fire a spark which was scheduled previously
-			LL_DELETE2(ENGINE(angleBasedEventsHead), current, nextToothEvent);
-
-			scheduling_s * sDown = &current->scheduling;
-
-#if SPARK_EXTREME_LOGGING
-	scheduleMsg(logger, "time to invoke ind=%d %d %d", trgEventIndex, getRevolutionCounter(), (int)getTimeNowUs());
-#endif /* FUEL_MATH_EXTREME_LOGGING */
-
-			scheduleByAngle(
-				sDown,
-				edgeTimestamp,
-				current->position.angleOffsetFromTriggerEvent,
-				current->action
-				PASS_ENGINE_PARAMETER_SUFFIX
-			);
-		}
-	}
-}
-
 void onTriggerEventSparkLogic(bool limitedSpark, uint32_t trgEventIndex, int rpm, efitick_t edgeTimestamp
 		 DECLARE_ENGINE_PARAMETER_SUFFIX) {
 
@@ -447,13 +385,6 @@ void onTriggerEventSparkLogic(bool limitedSpark, uint32_t trgEventIndex, int rpm
 	}
 
 
-	/**
-	 * Ignition schedule is defined once per revolution
-	 * See initializeIgnitionActions()
-	 */
-	scheduleAllSparkEventsUntilNextTriggerTooth(trgEventIndex, edgeTimestamp PASS_ENGINE_PARAMETER_SUFFIX);
-
-
 //	scheduleSimpleMsg(&logger, "eventId spark ", eventIndex);
 	if (ENGINE(ignitionEvents.isReady)) {
 		for (int i = 0; i < CONFIG(specs.cylindersCount); i++) {
@@ -465,8 +396,24 @@ void onTriggerEventSparkLogic(bool limitedSpark, uint32_t trgEventIndex, int rpm
 	}
 }
 
+#if ! EFI_UNIT_TEST
+static void enableDwellVoltageCompensation(void) {
+	engine->isDwellVoltageCompensationArmed = true;
+	scheduleMsg(logger, "dwell voltage compensation armed around %.1fv", engineConfiguration->targetVBatt);
+}
+
+static void disableDwellVoltageCompensation(void) {
+	engine->isDwellVoltageCompensationArmed = false;
+	scheduleMsg(logger, "dwell voltage compensation off");
+}
+#endif /* EFI_UNIT_TEST */
+
 void initSparkLogic(Logging *sharedLogger) {
 	logger = sharedLogger;
+#if ! EFI_UNIT_TEST
+	addConsoleAction("dwell_vcomp_enable", enableDwellVoltageCompensation);
+	addConsoleAction("dwell_vcomp_disable", disableDwellVoltageCompensation);
+#endif /* EFI_UNIT_TEST */
 }
 
 /**
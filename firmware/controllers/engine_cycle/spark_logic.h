@@ -19,11 +19,3 @@ percent_t getCoilDutyCycle(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX);
 void initializeIgnitionActions(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 
 int isIgnitionTimingError(void);
-
-#define TRIGGER_EVENT_UNDEFINED -1
-bool scheduleOrQueue(AngleBasedEvent *event,
-		uint32_t trgEventIndex,
-		efitick_t edgeTimestamp,
-		angle_t angle,
-		action_s action
-		DECLARE_ENGINE_PARAMETER_SUFFIX);
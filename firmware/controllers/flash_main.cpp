@@ -14,6 +14,7 @@
 #include "eficonsole.h"
 
 #include "flash.h"
+#include "hw_crc.h"
 #include "engine_math.h"
 
 // this message is part of console API, see FLASH_SUCCESS_MSG in java code
@@ -53,6 +54,317 @@ crc_t flashStateCrc(persistent_config_container_s *state) {
 	return calc_crc((const crc_t*) &state->persistentConfiguration, sizeof(persistent_config_s));
 }
 
+#if EFI_CONFIG_JOURNAL
+/**
+ * Wear-leveled configuration journal. The two flash regions which used to hold the two
+ * fixed copies are treated as arrays of slots; every burn appends into the next free
+ * slot and a sector only gets erased once all of its slots have been consumed, so
+ * sector wear is spread across a tuning session instead of hitting the same cells on
+ * every burn - and most burns skip the erase stall entirely.
+ *
+ * A slot header is programmed only after its payload, so a burn interrupted by a power
+ * loss never produces a valid-looking header and the slot is skipped at scan time.
+ * Boot picks the valid header with the highest sequence number - a scan over a handful
+ * of header words instead of a CRC over the whole struct on slow flash; the full
+ * payload CRC still runs, once, in the background shortly after boot.
+ */
+#define CONFIG_SLOT_MAGIC 0x52555345
+#define CONFIG_JOURNAL_SECTOR_COUNT 2
+
+typedef struct {
+	uint32_t magic;
+	uint32_t sequence;
+	uint32_t size;
+	// same algorithm and value as persistent_config_container_s.value
+	crc_t crc;
+} config_slot_header_s;
+
+// slots keep the alignment of the underlying flash program operations
+#define CONFIG_SLOT_SIZE (((sizeof(config_slot_header_s) + PERSISTENT_SIZE) + 7) & ~(size_t)7)
+
+// newest sequence number seen in the journal, zero while the journal is empty
+static uint32_t journalSequence = 0;
+
+static bool deferredCrcPending = false;
+static flashaddr_t deferredCrcAddr;
+static crc_t deferredCrcExpected;
+
+static flashaddr_t getJournalSectorBase(int sectorIndex) {
+	return sectorIndex == 0 ? getFlashAddrFirstCopy() : getFlashAddrSecondCopy();
+}
+
+static int getSlotsPerSector(int sectorIndex) {
+	return flashSectorSize(flashSectorAt(getJournalSectorBase(sectorIndex))) / CONFIG_SLOT_SIZE;
+}
+
+static flashaddr_t getSlotAddr(int sectorIndex, int slotIndex) {
+	return getJournalSectorBase(sectorIndex) + slotIndex * CONFIG_SLOT_SIZE;
+}
+
+static const config_slot_header_s *getSlotHeader(int sectorIndex, int slotIndex) {
+	// internal flash is memory mapped so scanning headers is a plain pointer walk
+	return (const config_slot_header_s *) getSlotAddr(sectorIndex, slotIndex);
+}
+
+static bool isValidSlotHeader(const config_slot_header_s *header) {
+	return header->magic == CONFIG_SLOT_MAGIC && header->size == PERSISTENT_SIZE;
+}
+
+static bool isErasedSlot(const config_slot_header_s *header) {
+	return header->magic == 0xFFFFFFFF;
+}
+
+#if EFI_CONFIG_DELTA_BURN
+/**
+ * Delta burn: a typical tuning edit touches a few dozen bytes, yet a burn used to
+ * program the whole multi-KB image. The TunerStudio write path reports every byte
+ * range it touches; an eligible burn then appends a small delta record - an extent
+ * table plus just the changed bytes - into the next journal slot instead of a full
+ * image, which brings the program-and-verify time down to tens of milliseconds.
+ * Boot replays the newest full image plus the delta chain on top of it.
+ *
+ * Safety rules: a recycled sector always starts with a full image so a delta chain
+ * never outlives its base, a broken chain at boot falls back to the base image, and
+ * at most CONFIG_DELTA_CHAIN_MAX deltas are appended before a full image goes out -
+ * which also picks up any configuration change made outside the tracked write path.
+ */
+#define CONFIG_DELTA_MAGIC 0x52555344
+#define DIRTY_EXTENT_MAX_COUNT 16
+#define CONFIG_DELTA_CHAIN_MAX 8
+
+typedef struct {
+	// offset within persistent_config_container_s
+	uint16_t offset;
+	uint16_t size;
+} dirty_extent_s;
+
+typedef struct {
+	uint32_t magic;
+	uint32_t sequence;
+	// the record this delta applies on top of - a gap here means intermediate
+	// records were recycled and the chain cannot be trusted
+	uint32_t baseSequence;
+	uint16_t extentCount;
+	// extent table plus packed extent bytes
+	uint16_t payloadSize;
+	// CRC-32 over the payload exactly as programmed, so one contiguous pass of
+	// the hardware CRC unit verifies the record - not the 8 bit crc_t state
+	// checksum the slot header carries
+	uint32_t crc;
+} config_delta_header_s;
+
+/**
+ * byte ranges modified since the last successful burn, merged on insert;
+ * an overflow simply forces the next burn to be a full image
+ */
+static dirty_extent_s dirtyExtents[DIRTY_EXTENT_MAX_COUNT];
+static int dirtyExtentCount = 0;
+static bool dirtyExtentOverflow = false;
+// number of delta records sitting on top of the newest full image
+static int deltaChainLength = 0;
+
+static void markDirtyContainerExtent(uint32_t start, uint32_t size) {
+	uint32_t end = start + size;
+	chSysLock();
+	for (int i = 0; i < dirtyExtentCount; i++) {
+		uint32_t extentStart = dirtyExtents[i].offset;
+		uint32_t extentEnd = extentStart + dirtyExtents[i].size;
+		// merge with an overlapping or adjacent extent
+		if (start <= extentEnd && end >= extentStart) {
+			extentStart = extentStart < start ? extentStart : start;
+			extentEnd = extentEnd > end ? extentEnd : end;
+			dirtyExtents[i].offset = extentStart;
+			dirtyExtents[i].size = extentEnd - extentStart;
+			chSysUnlock();
+			return;
+		}
+	}
+	if (dirtyExtentCount >= DIRTY_EXTENT_MAX_COUNT) {
+		// scattered edit session - a full image is the better burn anyway
+		dirtyExtentOverflow = true;
+	} else {
+		dirtyExtents[dirtyExtentCount].offset = start;
+		dirtyExtents[dirtyExtentCount].size = end - start;
+		dirtyExtentCount++;
+	}
+	chSysUnlock();
+}
+
+void flashMarkConfigDirty(int offset, int count) {
+	// TunerStudio page offsets are relative to persistentConfiguration in the container
+	markDirtyContainerExtent(offsetof(persistent_config_container_s, persistentConfiguration) + offset, count);
+}
+
+static void resetDirtyExtents(void) {
+	chSysLock();
+	dirtyExtentCount = 0;
+	dirtyExtentOverflow = false;
+	chSysUnlock();
+}
+
+static bool isValidDeltaHeader(const config_delta_header_s *header) {
+	return header->magic == CONFIG_DELTA_MAGIC
+			&& header->extentCount > 0
+			&& header->extentCount <= DIRTY_EXTENT_MAX_COUNT + 1
+			&& sizeof(config_delta_header_s) + header->payloadSize <= CONFIG_SLOT_SIZE;
+}
+
+/**
+ * Replays every delta record newer than the just-loaded full image, in sequence
+ * order, each one CRC-checked before its extents are copied into persistentState.
+ * The end state must agree with the container CRC carried by the newest delta,
+ * otherwise the base image alone is restored.
+ */
+static void applyConfigDeltas(flashaddr_t basePayload, uint32_t baseSequence) {
+	uint32_t appliedSequence = baseSequence;
+	deltaChainLength = 0;
+	// the chain is short, a rescan per step beats sorting
+	while (true) {
+		const config_delta_header_s *next = NULL;
+		flashaddr_t nextAddr = 0;
+		for (int sectorIndex = 0; sectorIndex < CONFIG_JOURNAL_SECTOR_COUNT; sectorIndex++) {
+			for (int slotIndex = 0; slotIndex < getSlotsPerSector(sectorIndex); slotIndex++) {
+				const config_delta_header_s *delta =
+						(const config_delta_header_s *) getSlotHeader(sectorIndex, slotIndex);
+				if (!isValidDeltaHeader(delta) || delta->sequence <= appliedSequence) {
+					continue;
+				}
+				if (next == NULL || delta->sequence < next->sequence) {
+					next = delta;
+					nextAddr = getSlotAddr(sectorIndex, slotIndex);
+				}
+			}
+		}
+		if (next == NULL) {
+			break;
+		}
+		if (next->baseSequence != appliedSequence) {
+			// records between this delta and the base were recycled, stop here
+			break;
+		}
+		flashaddr_t tableAddr = nextAddr + sizeof(config_delta_header_s);
+		if (hwCrc32((const void *) tableAddr, next->payloadSize) != next->crc) {
+			warning(CUSTOM_ERR_FLASH_CRC_FAILED, "config delta CRC mismatch");
+			break;
+		}
+		const dirty_extent_s *table = (const dirty_extent_s *) tableAddr;
+		const char *data = (const char *) (tableAddr + next->extentCount * sizeof(dirty_extent_s));
+		for (int i = 0; i < next->extentCount; i++) {
+			if (table[i].offset + table[i].size > PERSISTENT_SIZE) {
+				warning(CUSTOM_ERR_FLASH_CRC_FAILED, "config delta extent out of range");
+				// the state is half-patched at this point, fall back to the base image
+				flashRead(basePayload, (char *) &persistentState, PERSISTENT_SIZE);
+				deltaChainLength = 0;
+				return;
+			}
+			memcpy(((char *) &persistentState) + table[i].offset, data, table[i].size);
+			data += table[i].size;
+		}
+		appliedSequence = next->sequence;
+		deltaChainLength++;
+	}
+	if (deltaChainLength > 0 && flashStateCrc(&persistentState) != persistentState.value) {
+		warning(CUSTOM_ERR_FLASH_CRC_FAILED, "config delta replay mismatch");
+		// the base image carries its own deferred CRC check
+		flashRead(basePayload, (char *) &persistentState, PERSISTENT_SIZE);
+		deltaChainLength = 0;
+	}
+}
+#endif /* EFI_CONFIG_DELTA_BURN */
+
+/**
+ * @return true if the journal holds at least one valid slot, with the newest one
+ * reported via the out parameters
+ */
+static bool findNewestSlot(int *sectorOut, int *slotOut) {
+	bool found = false;
+	uint32_t bestSequence = 0;
+	uint32_t newestRecordSequence = 0;
+	for (int sectorIndex = 0; sectorIndex < CONFIG_JOURNAL_SECTOR_COUNT; sectorIndex++) {
+		for (int slotIndex = 0; slotIndex < getSlotsPerSector(sectorIndex); slotIndex++) {
+			const config_slot_header_s *header = getSlotHeader(sectorIndex, slotIndex);
+#if EFI_CONFIG_DELTA_BURN
+			// delta records share the sequence counter with full slots
+			const config_delta_header_s *delta = (const config_delta_header_s *) header;
+			if (isValidDeltaHeader(delta)) {
+				if (delta->sequence > newestRecordSequence) {
+					newestRecordSequence = delta->sequence;
+				}
+				continue;
+			}
+#endif /* EFI_CONFIG_DELTA_BURN */
+			if (!isValidSlotHeader(header)) {
+				continue;
+			}
+			if (!found || header->sequence > bestSequence) {
+				found = true;
+				bestSequence = header->sequence;
+				*sectorOut = sectorIndex;
+				*slotOut = slotIndex;
+			}
+		}
+	}
+	if (found) {
+		journalSequence = newestRecordSequence > bestSequence ? newestRecordSequence : bestSequence;
+	}
+	return found;
+}
+
+/**
+ * Append policy: keep filling the sector holding the newest slot; once it has no
+ * erased slot left move to the other sector.
+ * @return true if the target sector needs to be erased first
+ */
+static bool pickBurnTarget(int *sectorOut, int *slotOut) {
+	int newestSector;
+	int newestSlot;
+	if (findNewestSlot(&newestSector, &newestSlot)) {
+		for (int slotIndex = newestSlot + 1; slotIndex < getSlotsPerSector(newestSector); slotIndex++) {
+			if (isErasedSlot(getSlotHeader(newestSector, slotIndex))) {
+				*sectorOut = newestSector;
+				*slotOut = slotIndex;
+				return false;
+			}
+		}
+		// the current sector is full, recycle the other one
+		*sectorOut = 1 - newestSector;
+		*slotOut = 0;
+		return true;
+	}
+	// empty journal, possibly a legacy fixed-copy layout: start from scratch
+	*sectorOut = 0;
+	*slotOut = 0;
+	return true;
+}
+
+static int writeSlotHeader(flashaddr_t slotAddr) {
+	config_slot_header_s header;
+	header.magic = CONFIG_SLOT_MAGIC;
+	header.sequence = ++journalSequence;
+	header.size = PERSISTENT_SIZE;
+	header.crc = persistentState.value;
+	// the header goes out last: a torn burn never produces a valid-looking slot
+	return flashWrite(slotAddr, (const char *) &header, sizeof(header));
+}
+
+/**
+ * One-shot deferred integrity check of the slot we booted from, invoked from the slow
+ * callback once connectivity is up instead of making boot wait for a full-struct CRC.
+ */
+static void runDeferredConfigCrc(void) {
+	if (!deferredCrcPending) {
+		return;
+	}
+	deferredCrcPending = false;
+	const persistent_config_container_s *stored = (const persistent_config_container_s *) deferredCrcAddr;
+	crc_t actual = calc_crc((const crc_t *) &stored->persistentConfiguration, sizeof(persistent_config_s));
+	if (actual != deferredCrcExpected) {
+		warning(CUSTOM_ERR_FLASH_CRC_FAILED, "deferred config CRC mismatch");
+	}
+}
+
+#endif /* EFI_CONFIG_JOURNAL */
+
 void setNeedToWriteConfiguration(void) {
 	scheduleMsg(logger, "Scheduling configuration write");
 	needToWriteConfiguration = true;
@@ -62,7 +374,397 @@ bool getNeedToWriteConfiguration(void) {
 	return needToWriteConfiguration;
 }
 
+#if EFI_ASYNC_FLASH_BURN
+
+/**
+ * Incremental burn engine: instead of one monolithic erase-and-program call the burn is
+ * split into bounded steps, one step per slow callback invocation, so the scheduler and
+ * the engine keep running between steps. A program step touches at most BURN_CHUNK_SIZE
+ * bytes; the sector erase remains the longest single step since the flash bank is
+ * unreadable while it runs - that stall is a hardware property we cannot chunk away,
+ * but with the config journal most burns append into an already-erased slot and skip
+ * the erase step entirely.
+ *
+ * The image is burned straight out of persistentState. If TunerStudio keeps editing
+ * the tune while the burn is in flight the verify step catches the mismatch and the
+ * burn restarts with the fresh bytes.
+ */
+#define BURN_CHUNK_SIZE 1024
+#define BURN_MAX_RETRY 3
+
+#if EFI_CONFIG_JOURNAL
+
+typedef enum {
+	BURN_IDLE = 0,
+	BURN_ERASE,
+	BURN_WRITE,
+	BURN_VERIFY,
+	BURN_FINALIZE,
+#if EFI_CONFIG_DELTA_BURN
+	BURN_DELTA_WRITE,
+	BURN_DELTA_VERIFY,
+	BURN_DELTA_FINALIZE,
+#endif /* EFI_CONFIG_DELTA_BURN */
+} burn_step_e;
+
+static burn_step_e burnStep = BURN_IDLE;
+static size_t burnOffset = 0;
+static int burnRetryCounter = 0;
+static int burnSector;
+static int burnSlot;
+
+#if EFI_CONFIG_DELTA_BURN
+// the extent set captured when the burn started, plus one entry for the container CRC
+static dirty_extent_s burnExtents[DIRTY_EXTENT_MAX_COUNT + 1];
+static int burnExtentCount = 0;
+static int burnExtentIndex = 0;
+static size_t burnPayloadSize;
+static uint32_t burnExpectedCrc;
+static uint32_t burnBaseSequence;
+static bool burnIsDelta = false;
+
+/**
+ * Consumes the accumulated extent set and decides whether this burn can go out as a
+ * delta record. A full burn persists everything, so the set is consumed either way.
+ */
+static bool prepareDeltaBurn(bool needsErase) {
+	chSysLock();
+	int count = dirtyExtentCount;
+	bool overflow = dirtyExtentOverflow;
+	memcpy(burnExtents, dirtyExtents, count * sizeof(dirty_extent_s));
+	dirtyExtentCount = 0;
+	dirtyExtentOverflow = false;
+	chSysUnlock();
+	if (needsErase || overflow || count == 0 || journalSequence == 0
+			|| deltaChainLength >= CONFIG_DELTA_CHAIN_MAX) {
+		return false;
+	}
+	// the container CRC field changes with every burn
+	burnExtents[count].offset = offsetof(persistent_config_container_s, value);
+	burnExtents[count].size = sizeof(crc_t);
+	count++;
+
+	size_t dataSize = 0;
+	for (int i = 0; i < count; i++) {
+		dataSize += burnExtents[i].size;
+	}
+	size_t payloadSize = count * sizeof(dirty_extent_s) + dataSize;
+	if (sizeof(config_delta_header_s) + payloadSize > CONFIG_SLOT_SIZE) {
+		// this much changed, a full image is the cheaper burn
+		return false;
+	}
+	burnExtentCount = count;
+	burnExtentIndex = 0;
+	burnPayloadSize = payloadSize;
+	burnBaseSequence = journalSequence;
+	// expected payload CRC: the extent table then the changed bytes, exactly as programmed
+	uint32_t crc = crc32(burnExtents, count * sizeof(dirty_extent_s));
+	for (int i = 0; i < count; i++) {
+		crc = crc32inc(((const char *) &persistentState) + burnExtents[i].offset, crc, burnExtents[i].size);
+	}
+	burnExpectedCrc = crc;
+	return true;
+}
+
+/**
+ * a failed delta burn gives its extents back to the tracker so that the retry -
+ * delta or full - still covers them; the last entry is the container CRC which
+ * every burn regenerates anyway
+ */
+static void remarkBurnExtents(void) {
+	for (int i = 0; i < burnExtentCount - 1; i++) {
+		markDirtyContainerExtent(burnExtents[i].offset, burnExtents[i].size);
+	}
+}
+#endif /* EFI_CONFIG_DELTA_BURN */
+
+static void startBurn(void) {
+	persistentState.size = PERSISTENT_SIZE;
+	persistentState.version = FLASH_DATA_VERSION;
+	persistentState.value = flashStateCrc(&persistentState);
+	burnOffset = 0;
+	bool needsErase = pickBurnTarget(&burnSector, &burnSlot);
+#if EFI_CONFIG_DELTA_BURN
+	burnIsDelta = prepareDeltaBurn(needsErase);
+	if (burnIsDelta) {
+		scheduleMsg(logger, "Starting delta burn into slot %d/%d, %d extents %d bytes", burnSector,
+				burnSlot, burnExtentCount, burnPayloadSize);
+		burnStep = BURN_DELTA_WRITE;
+		return;
+	}
+#endif /* EFI_CONFIG_DELTA_BURN */
+	scheduleMsg(logger, "Starting incremental burn into slot %d/%d, CRC=%d", burnSector, burnSlot,
+			persistentState.value);
+	burnStep = needsErase ? BURN_ERASE : BURN_WRITE;
+}
+
+static void updateBurnProgress(void) {
+#if EFI_TUNER_STUDIO
+	int percent;
+	switch (burnStep) {
+	case BURN_IDLE:
+		percent = 0;
+		break;
+	case BURN_ERASE:
+		percent = 5;
+		break;
+	case BURN_WRITE:
+		percent = 10 + 80 * burnOffset / PERSISTENT_SIZE;
+		break;
+	default:
+		percent = 95;
+		break;
+	}
+	tsState.burnProgressPercent = percent;
+#endif /* EFI_TUNER_STUDIO */
+}
+
+static void runBurnStep(void) {
+	switch (burnStep) {
+	case BURN_IDLE:
+		if (getNeedToWriteConfiguration()) {
+			// todo: technically we need a lock here, realistically we should be fine.
+			needToWriteConfiguration = false;
+			burnRetryCounter = 0;
+			startBurn();
+		} else {
+			runDeferredConfigCrc();
+		}
+		break;
+	case BURN_ERASE:
+		// each journal sector region is exactly one physical sector
+		flashSectorErase(flashSectorAt(getJournalSectorBase(burnSector)));
+		burnStep = BURN_WRITE;
+		break;
+	case BURN_WRITE: {
+		flashaddr_t payload = getSlotAddr(burnSector, burnSlot) + sizeof(config_slot_header_s);
+		size_t chunk = minI(BURN_CHUNK_SIZE, PERSISTENT_SIZE - burnOffset);
+		flashWrite(payload + burnOffset, ((const char *) &persistentState) + burnOffset, chunk);
+		burnOffset += chunk;
+		if (burnOffset >= PERSISTENT_SIZE) {
+			burnStep = BURN_VERIFY;
+		}
+		break;
+	}
+	case BURN_VERIFY: {
+		flashaddr_t payload = getSlotAddr(burnSector, burnSlot) + sizeof(config_slot_header_s);
+		if (hwCrc32((const void *) payload, PERSISTENT_SIZE) == hwCrc32(&persistentState, PERSISTENT_SIZE)) {
+			burnStep = BURN_FINALIZE;
+		} else if (++burnRetryCounter < BURN_MAX_RETRY) {
+			// either programming failed or the tune changed mid-burn; the header was
+			// never written, so the abandoned slot is skipped until its sector recycles
+			scheduleMsg(logger, "Burn verify mismatch, restarting burn");
+#if EFI_CONFIG_DELTA_BURN
+			// the failed image covered more than the tracked extents, retry in full
+			dirtyExtentOverflow = true;
+#endif /* EFI_CONFIG_DELTA_BURN */
+			startBurn();
+		} else {
+			warning(CUSTOM_ERR_FLASH_CRC_FAILED, "flash burn verify failed");
+			burnStep = BURN_IDLE;
+		}
+		break;
+	}
+	case BURN_FINALIZE:
+		writeSlotHeader(getSlotAddr(burnSector, burnSlot));
+#if EFI_CONFIG_DELTA_BURN
+		// a fresh full image, the next delta chain starts here
+		deltaChainLength = 0;
+#endif /* EFI_CONFIG_DELTA_BURN */
+		scheduleMsg(logger, FLASH_SUCCESS_MSG);
+		burnStep = BURN_IDLE;
+		assertEngineReference();
+		resetMaxValues();
+		break;
+#if EFI_CONFIG_DELTA_BURN
+	case BURN_DELTA_WRITE: {
+		flashaddr_t tableAddr = getSlotAddr(burnSector, burnSlot) + sizeof(config_delta_header_s);
+		flashaddr_t dataAddr = tableAddr + burnExtentCount * sizeof(dirty_extent_s);
+		if (burnExtentIndex == 0) {
+			flashWrite(tableAddr, (const char *) burnExtents, burnExtentCount * sizeof(dirty_extent_s));
+		}
+		// one extent per step keeps the same pacing contract as the full-image chunks
+		const dirty_extent_s *extent = &burnExtents[burnExtentIndex];
+		flashWrite(dataAddr + burnOffset, ((const char *) &persistentState) + extent->offset, extent->size);
+		burnOffset += extent->size;
+		if (++burnExtentIndex >= burnExtentCount) {
+			burnStep = BURN_DELTA_VERIFY;
+		}
+		break;
+	}
+	case BURN_DELTA_VERIFY: {
+		flashaddr_t tableAddr = getSlotAddr(burnSector, burnSlot) + sizeof(config_delta_header_s);
+		// the record is contiguous in flash, one pass of the CRC unit covers it
+		if (hwCrc32((const void *) tableAddr, burnPayloadSize) == burnExpectedCrc) {
+			burnStep = BURN_DELTA_FINALIZE;
+		} else if (++burnRetryCounter < BURN_MAX_RETRY) {
+			// either programming failed or the tune changed mid-burn; the abandoned
+			// slot has no header and is skipped until its sector recycles
+			scheduleMsg(logger, "Delta burn verify mismatch, restarting burn");
+			remarkBurnExtents();
+			startBurn();
+		} else {
+			warning(CUSTOM_ERR_FLASH_CRC_FAILED, "flash delta burn verify failed");
+			burnStep = BURN_IDLE;
+		}
+		break;
+	}
+	case BURN_DELTA_FINALIZE: {
+		config_delta_header_s header;
+		header.magic = CONFIG_DELTA_MAGIC;
+		header.sequence = ++journalSequence;
+		header.baseSequence = burnBaseSequence;
+		header.extentCount = burnExtentCount;
+		header.payloadSize = burnPayloadSize;
+		header.crc = burnExpectedCrc;
+		// the header goes out last, same torn-burn protection as a full slot
+		flashWrite(getSlotAddr(burnSector, burnSlot), (const char *) &header, sizeof(header));
+		deltaChainLength++;
+		scheduleMsg(logger, FLASH_SUCCESS_MSG);
+		burnStep = BURN_IDLE;
+		assertEngineReference();
+		resetMaxValues();
+		break;
+	}
+#endif /* EFI_CONFIG_DELTA_BURN */
+	}
+	updateBurnProgress();
+}
+
+#else /* EFI_CONFIG_JOURNAL */
+
+typedef enum {
+	BURN_IDLE = 0,
+	BURN_ERASE_FIRST,
+	BURN_WRITE_FIRST,
+	BURN_ERASE_SECOND,
+	BURN_WRITE_SECOND,
+	BURN_VERIFY,
+} burn_step_e;
+
+static burn_step_e burnStep = BURN_IDLE;
+static size_t burnOffset = 0;
+static flashsector_t burnEraseSector;
+static flashsector_t burnEraseLastSector;
+static int burnRetryCounter = 0;
+
+static void prepareEraseStep(flashaddr_t address, burn_step_e nextStep) {
+	burnEraseSector = flashSectorAt(address);
+	burnEraseLastSector = flashSectorAt(address + PERSISTENT_SIZE - 1);
+	burnOffset = 0;
+	burnStep = nextStep;
+}
+
+static void startBurn(void) {
+	persistentState.size = PERSISTENT_SIZE;
+	persistentState.version = FLASH_DATA_VERSION;
+	persistentState.value = flashStateCrc(&persistentState);
+	scheduleMsg(logger, "Starting incremental burn, CRC=%d", persistentState.value);
+	prepareEraseStep(getFlashAddrFirstCopy(), BURN_ERASE_FIRST);
+}
+
+static void updateBurnProgress(void) {
+#if EFI_TUNER_STUDIO
+	// two erases and two programmed copies, weighted by bytes for the program phases
+	int percent;
+	switch (burnStep) {
+	case BURN_IDLE:
+		percent = 0;
+		break;
+	case BURN_ERASE_FIRST:
+		percent = 5;
+		break;
+	case BURN_WRITE_FIRST:
+		percent = 10 + 40 * burnOffset / PERSISTENT_SIZE;
+		break;
+	case BURN_ERASE_SECOND:
+		percent = 55;
+		break;
+	case BURN_WRITE_SECOND:
+		percent = 60 + 35 * burnOffset / PERSISTENT_SIZE;
+		break;
+	default:
+		percent = 98;
+		break;
+	}
+	tsState.burnProgressPercent = percent;
+#endif /* EFI_TUNER_STUDIO */
+}
+
+static void runBurnStep(void) {
+	switch (burnStep) {
+	case BURN_IDLE:
+		if (getNeedToWriteConfiguration()) {
+			// todo: technically we need a lock here, realistically we should be fine.
+			needToWriteConfiguration = false;
+			burnRetryCounter = 0;
+			startBurn();
+		}
+		break;
+	case BURN_ERASE_FIRST:
+	case BURN_ERASE_SECOND:
+		flashSectorErase(burnEraseSector);
+		if (burnEraseSector == burnEraseLastSector) {
+			burnStep = (burnStep == BURN_ERASE_FIRST) ? BURN_WRITE_FIRST : BURN_WRITE_SECOND;
+			burnOffset = 0;
+		} else {
+			burnEraseSector++;
+		}
+		break;
+	case BURN_WRITE_FIRST:
+	case BURN_WRITE_SECOND: {
+		flashaddr_t base = (burnStep == BURN_WRITE_FIRST) ? getFlashAddrFirstCopy() : getFlashAddrSecondCopy();
+		size_t chunk = minI(BURN_CHUNK_SIZE, PERSISTENT_SIZE - burnOffset);
+		flashWrite(base + burnOffset, ((const char *) &persistentState) + burnOffset, chunk);
+		burnOffset += chunk;
+		if (burnOffset >= PERSISTENT_SIZE) {
+			if (burnStep == BURN_WRITE_FIRST) {
+				prepareEraseStep(getFlashAddrSecondCopy(), BURN_ERASE_SECOND);
+			} else {
+				burnStep = BURN_VERIFY;
+			}
+		}
+		break;
+	}
+	case BURN_VERIFY: {
+		uint32_t expected = hwCrc32(&persistentState, PERSISTENT_SIZE);
+		bool isMatch = hwCrc32((const void *) getFlashAddrFirstCopy(), PERSISTENT_SIZE) == expected
+				&& hwCrc32((const void *) getFlashAddrSecondCopy(), PERSISTENT_SIZE) == expected;
+		if (isMatch) {
+			scheduleMsg(logger, FLASH_SUCCESS_MSG);
+			burnStep = BURN_IDLE;
+			assertEngineReference();
+			resetMaxValues();
+		} else if (++burnRetryCounter < BURN_MAX_RETRY) {
+			// the tune was edited while the image was going out, burn the fresh bytes
+			scheduleMsg(logger, "Burn verify mismatch, restarting burn");
+			startBurn();
+		} else {
+			warning(CUSTOM_ERR_FLASH_CRC_FAILED, "flash burn verify failed");
+			burnStep = BURN_IDLE;
+		}
+		break;
+	}
+	}
+	updateBurnProgress();
+}
+
+#endif /* EFI_CONFIG_JOURNAL */
+
+void writeToFlashIfPending() {
+	runBurnStep();
+}
+
+static void cancelAsyncBurn(void) {
+	burnStep = BURN_IDLE;
+}
+
+#else /* EFI_ASYNC_FLASH_BURN */
+
 void writeToFlashIfPending() {
+#if EFI_CONFIG_JOURNAL
+	runDeferredConfigCrc();
+#endif /* EFI_CONFIG_JOURNAL */
 	if (!getNeedToWriteConfiguration()) {
 		return;
 	}
@@ -72,20 +774,46 @@ void writeToFlashIfPending() {
 	writeToFlashNow();
 }
 
+#endif /* EFI_ASYNC_FLASH_BURN */
+
 void writeToFlashNow(void) {
 	scheduleMsg(logger, " !!!!!!!!!!!!!!!!!!!! BE SURE NOT WRITE WITH IGNITION ON !!!!!!!!!!!!!!!!!!!!");
+#if EFI_ASYNC_FLASH_BURN
+	// a synchronous write supersedes whatever the background burn was doing
+	cancelAsyncBurn();
+#endif /* EFI_ASYNC_FLASH_BURN */
 	persistentState.size = PERSISTENT_SIZE;
 	persistentState.version = FLASH_DATA_VERSION;
 	scheduleMsg(logger, "flash compatible with %d", persistentState.version);
 	crc_t crcResult = flashStateCrc(&persistentState);
 	persistentState.value = crcResult;
-	scheduleMsg(logger, "Reseting flash: size=%d", PERSISTENT_SIZE);
-	flashErase(getFlashAddrFirstCopy(), PERSISTENT_SIZE);
 	scheduleMsg(logger, "Flashing with CRC=%d", crcResult);
 	efitimems_t nowMs = currentTimeMillis();
+#if EFI_CONFIG_JOURNAL
+	int targetSector;
+	int targetSlot;
+	if (pickBurnTarget(&targetSector, &targetSlot)) {
+		scheduleMsg(logger, "Recycling journal sector %d", targetSector);
+		flashSectorErase(flashSectorAt(getJournalSectorBase(targetSector)));
+	}
+	flashaddr_t slotAddr = getSlotAddr(targetSector, targetSlot);
+	int result = flashWrite(slotAddr + sizeof(config_slot_header_s), (const char *) &persistentState,
+			PERSISTENT_SIZE);
+	if (result == FLASH_RETURN_SUCCESS) {
+		result = writeSlotHeader(slotAddr);
+	}
+#if EFI_CONFIG_DELTA_BURN
+	// a full image supersedes whatever extents were pending
+	resetDirtyExtents();
+	deltaChainLength = 0;
+#endif /* EFI_CONFIG_DELTA_BURN */
+#else /* EFI_CONFIG_JOURNAL */
+	scheduleMsg(logger, "Reseting flash: size=%d", PERSISTENT_SIZE);
+	flashErase(getFlashAddrFirstCopy(), PERSISTENT_SIZE);
 	int result = flashWrite(getFlashAddrFirstCopy(), (const char *) &persistentState, PERSISTENT_SIZE);
 	flashErase(getFlashAddrSecondCopy(), PERSISTENT_SIZE);
 	flashWrite(getFlashAddrSecondCopy(), (const char *) &persistentState, PERSISTENT_SIZE);
+#endif /* EFI_CONFIG_JOURNAL */
 	scheduleMsg(logger, "Flash programmed in %dms", currentTimeMillis() - nowMs);
 	bool isSuccess = result == FLASH_RETURN_SUCCESS;
 	if (isSuccess) {
@@ -128,11 +856,50 @@ static persisted_configuration_state_e doReadConfiguration(flashaddr_t address,
  */
 persisted_configuration_state_e readConfiguration(Logging * logger) {
 	efiAssert(CUSTOM_ERR_ASSERT, getCurrentRemainingStack() > EXPECTED_REMAINING_STACK, "read f", PC_ERROR);
+#if EFI_CONFIG_JOURNAL
+	persisted_configuration_state_e result;
+	int sectorIndex;
+	int slotIndex;
+	if (findNewestSlot(&sectorIndex, &slotIndex)) {
+		const config_slot_header_s *header = getSlotHeader(sectorIndex, slotIndex);
+		flashaddr_t payload = getSlotAddr(sectorIndex, slotIndex) + sizeof(config_slot_header_s);
+		printMsg(logger, "config journal: sector %d slot %d sequence %d", sectorIndex, slotIndex,
+				header->sequence);
+		flashRead(payload, (char *) &persistentState, PERSISTENT_SIZE);
+		if (persistentState.version != FLASH_DATA_VERSION || persistentState.size != PERSISTENT_SIZE) {
+			result = INCOMPATIBLE_VERSION;
+		} else {
+			/**
+			 * the header was only programmed after a fully verified payload, so we
+			 * trust it here and run the full-struct CRC once in the background
+			 * instead of making every boot pay for it
+			 */
+			deferredCrcAddr = payload;
+			deferredCrcExpected = header->crc;
+			deferredCrcPending = true;
+#if EFI_CONFIG_DELTA_BURN
+			applyConfigDeltas(payload, header->sequence);
+			if (deltaChainLength > 0) {
+				printMsg(logger, "config journal: replayed %d delta record(s)", deltaChainLength);
+			}
+#endif /* EFI_CONFIG_DELTA_BURN */
+			result = PC_OK;
+		}
+	} else {
+		// empty journal: maybe this firmware was just flashed over a legacy fixed-copy layout
+		result = doReadConfiguration(getFlashAddrFirstCopy(), logger);
+		if (result != PC_OK) {
+			printMsg(logger, "Reading second configuration copy");
+			result = doReadConfiguration(getFlashAddrSecondCopy(), logger);
+		}
+	}
+#else /* EFI_CONFIG_JOURNAL */
 	persisted_configuration_state_e result = doReadConfiguration(getFlashAddrFirstCopy(), logger);
 	if (result != PC_OK) {
 		printMsg(logger, "Reading second configuration copy");
 		result = doReadConfiguration(getFlashAddrSecondCopy(), logger);
 	}
+#endif /* EFI_CONFIG_JOURNAL */
 
 	if (result == CRC_FAILED) {
 		warning(CUSTOM_ERR_FLASH_CRC_FAILED, "flash CRC failed");
@@ -37,3 +37,11 @@ void setNeedToWriteConfiguration(void);
  */
 bool getNeedToWriteConfiguration(void);
 void writeToFlashIfPending(void);
+
+#if EFI_CONFIG_DELTA_BURN
+/**
+ * TunerStudio write path reporting: the given configuration page byte range has been
+ * modified since the last burn, so the next burn may go out as a journal delta record
+ */
+void flashMarkConfigDirty(int offset, int count);
+#endif /* EFI_CONFIG_DELTA_BURN */
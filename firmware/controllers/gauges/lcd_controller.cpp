@@ -362,6 +362,9 @@ void updateHD44780lcd(void) {
 	lcd_HD44780_print_string(buffer);
 	fillWithSpaces();
 
+	// the frame is composed, now transmit only what actually changed
+	lcd_HD44780_flush();
+
 //
 //	lcd_HD44780_set_position(0, 9);
 //	/**
@@ -2,42 +2,58 @@
  * @file tachometer.cpp
  * @brief This is about driving external analog tachometers
  *
- * This implementation produces one pulse per engine cycle
+ * This implementation produces one pulse per engine cycle as a plain PWM output:
+ * the waveform runs on its own and we only refresh the period, once per slow
+ * callback and only when RPM has actually moved. The previous implementation
+ * paid a trigger listener invocation on every single tooth plus one scheduler
+ * event per engine cycle for the falling edge.
  *
- * todo: these is a bit of duplication with dizzySparkOutputPin
+ * We deliberately stay off the hardware timer channels here: those run at a
+ * frequency fixed at acquisition time (see hardware_pwm.cpp) while a tach has
+ * to sweep its pulse rate with RPM.
  *
  * @date Aug 18, 2015
  * @author Andrey Belomutskiy, (c) 2012-2020
  */
 
 #include "tachometer.h"
-#include "trigger_central.h"
+#include "pwm_generator_logic.h"
+#include "pwm_generator.h"
+#include "engine_math.h"
 
 #if !EFI_UNIT_TEST
 
 EXTERN_ENGINE;
 
-static scheduling_s tachTurnSignalOff;
+static SimplePwm tachControl("tach");
 
-static void turnTachPinLow(void *) {
-	enginePins.tachOut.setLow();
-}
+static bool tachIsStarted = false;
+static float currentTachFrequency = 0;
 
-static void tachSignalCallback(trigger_event_e ckpSignalType,
-		uint32_t index, efitick_t edgeTimestamp DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	UNUSED(ckpSignalType);
-	if (index != (uint32_t)engineConfiguration->tachPulseTriggerIndex) {
+void updateTachometer(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (!tachIsStarted) {
+		return;
+	}
+	floatms_t cycleDurationMs = getEngineCycleDuration(rpm PASS_ENGINE_PARAMETER_SUFFIX);
+	if (cisnan(cycleDurationMs)) {
+		// stopped engine: no pulses, park the pin low
+		currentTachFrequency = 0;
+		tachControl.setSimplePwmDutyCycle(0);
 		return;
 	}
-	enginePins.tachOut.setHigh();
-	float durationMs;
+	float frequency = 1000.0f / cycleDurationMs;
+	if (frequency != currentTachFrequency) {
+		// takes effect at the next wave start so no pulse is chopped mid-flight
+		tachControl.setFrequency(frequency);
+		currentTachFrequency = frequency;
+	}
+	float dutyCycle;
 	if (engineConfiguration->tachPulseDurationAsDutyCycle) {
-		// todo: implement tachPulseDurationAsDutyCycle
-		durationMs = engineConfiguration->tachPulseDuractionMs;
+		dutyCycle = engineConfiguration->tachPulseDuractionMs;
 	} else {
-		durationMs = engineConfiguration->tachPulseDuractionMs;
+		dutyCycle = engineConfiguration->tachPulseDuractionMs / cycleDurationMs;
 	}
-	engine->executor.scheduleForLater(&tachTurnSignalOff, (int)MS2US(durationMs), &turnTachPinLow);
+	tachControl.setSimplePwmDutyCycle(maxF(0.05f, minF(dutyCycle, 0.95f)));
 }
 
 void initTachometer(void) {
@@ -47,9 +63,12 @@ void initTachometer(void) {
 
 	enginePins.tachOut.initPin("analog tach output", CONFIG(tachOutputPin), &CONFIG(tachOutputPinMode));
 
-#if EFI_SHAFT_POSITION_INPUT
-	addTriggerEventListener(tachSignalCallback, "tach", engine);
-#endif /* EFI_SHAFT_POSITION_INPUT */
+	// the frequency here is only a placeholder, updateTachometer() takes over
+	// as soon as the slow callback sees actual RPM
+	startSimplePwm(&tachControl, "tach", &engine->executor, &enginePins.tachOut,
+			10, 0.1f, (pwm_gen_callback*) applyPinState);
+
+	tachIsStarted = true;
 }
 
 #endif /* EFI_UNIT_TEST */
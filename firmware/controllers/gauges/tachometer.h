@@ -12,4 +12,9 @@
 
 void initTachometer(void);
 
+/**
+ * invoked from the periodic slow callback, refreshes the output PWM period on RPM change
+ */
+void updateTachometer(int rpm DECLARE_ENGINE_PARAMETER_SUFFIX);
+
 #endif /* CONTROLLERS_TACHOMETER_H_ */
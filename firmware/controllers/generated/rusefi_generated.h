@@ -2076,8 +2076,8 @@
 #define unusedAnotherOne_offset_hex 2e8
 #define unusedAtOldBoardConfigurationEnd_offset 1052
 #define unusedAtOldBoardConfigurationEnd_offset_hex 41c
-#define unusedBit4_1476_offset 1476
-#define unusedBit4_1476_offset_hex 5c4
+#define useFSIOForAuxValveAngles_offset 1476
+#define useFSIOForAuxValveAngles_offset_hex 5c4
 #define unusedBit_250_10_offset 976
 #define unusedBit_250_10_offset_hex 3d0
 #define unusedBit_250_11_offset 976
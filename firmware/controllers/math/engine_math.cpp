@@ -21,6 +21,7 @@
 
 #include "global.h"
 #include "engine_math.h"
+#include "cylinder_balance.h"
 #include "engine_configuration.h"
 #include "interpolation.h"
 #include "allsensors.h"
@@ -103,6 +104,7 @@ void setSingleCoilDwell(DECLARE_CONFIG_PARAMETER_SIGNATURE) {
 
 FuelSchedule::FuelSchedule() {
 	clear();
+	memset(injectionStartAngles, 0, sizeof(injectionStartAngles));
 	for (int cylinderIndex = 0; cylinderIndex < MAX_INJECTION_OUTPUT_COUNT; cylinderIndex++) {
 		InjectionEvent *ev = &elements[cylinderIndex];
 		ev->ownIndex = cylinderIndex;
@@ -113,17 +115,12 @@ void FuelSchedule::clear() {
 	isReady = false;
 }
 
-/**
- * @returns false in case of error, true if success
- */
-bool FuelSchedule::addFuelEventsForCylinder(int i  DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	efiAssert(CUSTOM_ERR_ASSERT, engine!=NULL, "engine is NULL", false);
-
+angle_t FuelSchedule::getBaseAngle(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	floatus_t oneDegreeUs = ENGINE(rpmCalculator.oneDegreeUs); // local copy
 	if (cisnan(oneDegreeUs)) {
 		// in order to have fuel schedule we need to have current RPM
 		// wonder if this line slows engine startup?
-		return false;
+		return NAN;
 	}
 
 	/**
@@ -134,19 +131,45 @@ bool FuelSchedule::addFuelEventsForCylinder(int i  DECLARE_ENGINE_PARAMETER_SUFF
 	 * engineState.injectionOffset is calculated from the same utility timer should we more that logic here?
 	 */
 	floatms_t fuelMs = ENGINE(injectionDuration);
-	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(fuelMs), "NaN fuelMs", false);
+	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(fuelMs), "NaN fuelMs", NAN);
 	angle_t injectionDuration = MS2US(fuelMs) / oneDegreeUs;
-	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(injectionDuration), "NaN injectionDuration", false);
+	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(injectionDuration), "NaN injectionDuration", NAN);
 	assertAngleRange(injectionDuration, "injectionDuration_r", CUSTOM_INJ_DURATION);
 	floatus_t injectionOffset = ENGINE(engineState.injectionOffset);
 	if (cisnan(injectionOffset)) {
 		// injection offset map not ready - we are not ready to schedule fuel events
-		return false;
+		return NAN;
 	}
 	angle_t baseAngle = injectionOffset - injectionDuration;
-	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(baseAngle), "NaN baseAngle", false);
+	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(baseAngle), "NaN baseAngle", NAN);
 	assertAngleRange(baseAngle, "baseAngle_r", CUSTOM_ERR_6554);
+	return baseAngle;
+}
+
+/**
+ * @returns false in case of error, true if success
+ */
+bool FuelSchedule::addFuelEventsForCylinder(int i  DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	efiAssert(CUSTOM_ERR_ASSERT, engine!=NULL, "engine is NULL", false);
+
+	angle_t baseAngle = getBaseAngle(PASS_ENGINE_PARAMETER_SIGNATURE);
+	if (cisnan(baseAngle)) {
+		return false;
+	}
+
+	// normalized once per configuration change, see Engine::validateConfiguration()
+	int cylindersCount = ENGINE(validatedConfig.cylindersCount);
+
+	injectionStartAngles[i] = baseAngle + i * ENGINE(engineCycle) / cylindersCount;
+
+	return registerInjectionEvent(i PASS_ENGINE_PARAMETER_SUFFIX);
+}
 
+/**
+ * Cold per-cylinder bookkeeping: output pins, injection mode flags and trigger position. The
+ * injection start angle is expected to be in injectionStartAngles already, see addFuelEvents()
+ */
+bool FuelSchedule::registerInjectionEvent(int i DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	int injectorIndex;
 
 	injection_mode_e mode = engine->getCurrentInjectionMode(PASS_ENGINE_PARAMETER_SIGNATURE);
@@ -154,7 +177,7 @@ bool FuelSchedule::addFuelEventsForCylinder(int i  DECLARE_ENGINE_PARAMETER_SUFF
 	if (mode == IM_SIMULTANEOUS || mode == IM_SINGLE_POINT) {
 		injectorIndex = 0;
 	} else if (mode == IM_SEQUENTIAL) {
-		injectorIndex = getCylinderId(i PASS_ENGINE_PARAMETER_SUFFIX) - 1;
+		injectorIndex = ENGINE(hotConfig.cylinderIndexByFiringIndex[i]);
 	} else if (mode == IM_BATCH) {
 		// does not look exactly right, not too consistent with IM_SEQUENTIAL
 		injectorIndex = i % (engineConfiguration->specs.cylindersCount / 2);
@@ -165,16 +188,8 @@ bool FuelSchedule::addFuelEventsForCylinder(int i  DECLARE_ENGINE_PARAMETER_SUFF
 
 	bool isSimultanious = mode == IM_SIMULTANEOUS;
 
-	assertAngleRange(baseAngle, "addFbaseAngle", CUSTOM_ADD_BASE);
-
-	int cylindersCount = CONFIG(specs.cylindersCount);
-	if (cylindersCount < 1) {
-		warning(CUSTOM_OBD_ZERO_CYLINDER_COUNT, "temp cylindersCount %d", cylindersCount);
-		return false;
-	}
-
-	float angle = baseAngle
-			+ i * ENGINE(engineCycle) / cylindersCount;
+	float angle = injectionStartAngles[i];
+	assertAngleRange(angle, "addFbaseAngle", CUSTOM_ADD_BASE);
 
 	InjectorOutputPin *secondOutput;
 	if (mode == IM_BATCH && CONFIG(twoWireBatchInjection)) {
@@ -221,10 +236,27 @@ bool FuelSchedule::addFuelEventsForCylinder(int i  DECLARE_ENGINE_PARAMETER_SUFF
 void FuelSchedule::addFuelEvents(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	clear();
 
-	for (int cylinderIndex = 0; cylinderIndex < CONFIG(specs.cylindersCount); cylinderIndex++) {
+	angle_t baseAngle = getBaseAngle(PASS_ENGINE_PARAMETER_SIGNATURE);
+	if (cisnan(baseAngle)) {
+		return;
+	}
+
+	// normalized once per configuration change, see Engine::validateConfiguration()
+	int cylindersCount = ENGINE(validatedConfig.cylindersCount);
+
+	/**
+	 * All per-cycle angle math happens in this one sweep over the contiguous angle array,
+	 * per-cylinder setup below only deals with output pin and injection mode bookkeeping
+	 */
+	angle_t cylinderStep = ENGINE(engineCycle) / cylindersCount;
+	for (int cylinderIndex = 0; cylinderIndex < cylindersCount; cylinderIndex++) {
+		injectionStartAngles[cylinderIndex] = baseAngle + cylinderIndex * cylinderStep;
+	}
+
+	for (int cylinderIndex = 0; cylinderIndex < cylindersCount; cylinderIndex++) {
 		InjectionEvent *ev = &elements[cylinderIndex];
 		ev->ownIndex = cylinderIndex;  // todo: is this assignment needed here? we now initialize in constructor
-		bool result = addFuelEventsForCylinder(cylinderIndex PASS_ENGINE_PARAMETER_SUFFIX);
+		bool result = registerInjectionEvent(cylinderIndex PASS_ENGINE_PARAMETER_SUFFIX);
 		if (!result)
 			return;
 	}
@@ -518,6 +550,11 @@ void prepareOutputSignals(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	prepareIgnitionPinIndices(CONFIG(ignitionMode) PASS_ENGINE_PARAMETER_SUFFIX);
 
 	TRIGGER_WAVEFORM(prepareShape());
+
+#if EFI_CYLINDER_BALANCE
+	// per-tooth cylinder lookup depends on triggerIndexByAngle prepared just above
+	prepareCylinderBalance(PASS_ENGINE_PARAMETER_SIGNATURE);
+#endif /* EFI_CYLINDER_BALANCE */
 }
 
 #endif /* EFI_ENGINE_CONTROL */
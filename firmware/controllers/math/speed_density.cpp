@@ -134,6 +134,58 @@ float sdMath(float airMass, float AFR DECLARE_GLOBAL_SUFFIX) {
 
 EXTERN_ENGINE;
 
+/**
+ * The speed-density math is organized as an explicit estimation pipeline:
+ *
+ *   manifold model (adjusted MAP + charge temperature)
+ *     -> cylinder air mass (adds VE)
+ *          -> injection time (adds target AFR and injector flow)
+ *          -> torque estimate (adds combustion constants)
+ *
+ * Each stage caches its output and recomputes only when its own inputs drifted beyond
+ * the deltas below, so between consecutive fast callbacks a steady cruise costs a few
+ * compares instead of the whole physics chain. The thresholds are intentionally well
+ * below the resolution a tune can react to.
+ */
+#define SD_DELTA_MAP_KPA 0.1f
+#define SD_DELTA_TCHARGE_K 0.1f
+#define SD_DELTA_VE 0.1f
+#define SD_DELTA_AFR 0.01f
+
+static float cachedAdjustedMap = NAN;
+static float cachedTChargeK = NAN;
+static float cachedVe = NAN;
+static float cachedTargetAFR = NAN;
+static floatms_t cachedSpeedDensityFuel = 0;
+// how many recomputations the delta gates served from cache, see getSpeedDensityFuel()
+int speedDensitySkippedRecalcCounter = 0;
+// how many times the air mass stage actually ran - the pipeline equivalent of a cache miss
+int sdAirMassRecalcCounter = 0;
+
+/**
+ * lower heating value of pump gasoline, J/g
+ */
+#define FUEL_LOWER_HEATING_VALUE 44000.0f
+/**
+ * flat brake thermal efficiency assumption: torque coordination cares about relative
+ * changes much more than about the absolute figure
+ */
+#define ESTIMATED_THERMAL_EFFICIENCY 0.3f
+#define DEGREES_TO_RADIANS 0.0174532925f
+
+/**
+ * Last pipeline stage: mean torque over the engine cycle, from the same air mass the
+ * injection math just consumed. Nothing inside the fuel path reads this - it is
+ * published in engine state so future ETB/traction torque coordination does not have
+ * to re-run the physics on its own schedule.
+ */
+static void updateTorqueEstimate(float airMassInOneCylinder, float targetAFR DECLARE_GLOBAL_SUFFIX) {
+	float cycleFuelMass = airMassInOneCylinder * get_specs_cylindersCount / targetAFR;
+	float cycleWork = cycleFuelMass * FUEL_LOWER_HEATING_VALUE * ESTIMATED_THERMAL_EFFICIENCY;
+	// mean torque is work per cycle divided by the angular travel of that cycle
+	ENGINE(engineState.estimatedEngineTorque) = cycleWork / (ENGINE(engineCycle) * DEGREES_TO_RADIANS);
+}
+
 /**
  * @return per cylinder injection time, in Milliseconds
  */
@@ -155,18 +207,56 @@ floatms_t getSpeedDensityFuel(float map DECLARE_GLOBAL_SUFFIX) {
 	float adjustedMap = engine->engineState.sd.adjustedManifoldAirPressure = map + engine->engineState.sd.manifoldAirPressureAccelerationAdjustment;
 	efiAssert(CUSTOM_ERR_ASSERT, !cisnan(adjustedMap), "NaN adjustedMap", 0);
 
-	float airMass = getCylinderAirMass(ENGINE(engineState.currentBaroCorrectedVE), adjustedMap, tChargeK PASS_GLOBAL_SUFFIX);
-	if (cisnan(airMass)) {
-		warning(CUSTOM_ERR_6685, "NaN airMass");
-		return 0;
+	float ve = ENGINE(engineState.currentBaroCorrectedVE);
+	float targetAFR = ENGINE(engineState.targetAFR);
+	// NaN cache seeds never satisfy the comparisons so the first invocation and any
+	// config change (which resets the cache) always recompute every stage
+	bool manifoldStageFresh = absF(adjustedMap - cachedAdjustedMap) < SD_DELTA_MAP_KPA
+			&& absF(tChargeK - cachedTChargeK) < SD_DELTA_TCHARGE_K;
+	bool airMassStageFresh = manifoldStageFresh && absF(ve - cachedVe) < SD_DELTA_VE;
+	if (airMassStageFresh && absF(targetAFR - cachedTargetAFR) < SD_DELTA_AFR) {
+		speedDensitySkippedRecalcCounter++;
+		return cachedSpeedDensityFuel;
+	}
+
+	float airMass;
+	if (airMassStageFresh) {
+		// only the AFR target moved - reuse the cached air mass stage output
+		airMass = engine->engineState.sd.airMassInOneCylinder;
+	} else {
+		airMass = getCylinderAirMass(ve, adjustedMap, tChargeK PASS_GLOBAL_SUFFIX);
+		if (cisnan(airMass)) {
+			warning(CUSTOM_ERR_6685, "NaN airMass");
+			return 0;
+		}
+		engine->engineState.sd.airMassInOneCylinder = airMass;
+		cachedAdjustedMap = adjustedMap;
+		cachedTChargeK = tChargeK;
+		cachedVe = ve;
+		sdAirMassRecalcCounter++;
 	}
 #if EFI_PRINTF_FUEL_DETAILS
 	printf("map=%.2f adjustedMap=%.2f airMass=%.2f\t\n",
 			map, adjustedMap, engine->engineState.sd.adjustedManifoldAirPressure);
 #endif /*EFI_PRINTF_FUEL_DETAILS */
 
-	engine->engineState.sd.airMassInOneCylinder = airMass;
-	return sdMath(airMass, ENGINE(engineState.targetAFR) PASS_GLOBAL_SUFFIX) * 1000;
+	floatms_t fuel = sdMath(airMass, targetAFR PASS_GLOBAL_SUFFIX) * 1000;
+	updateTorqueEstimate(airMass, targetAFR PASS_GLOBAL_SUFFIX);
+	cachedTargetAFR = targetAFR;
+	cachedSpeedDensityFuel = fuel;
+	return fuel;
+}
+
+/**
+ * Invalidates the delta gate cache: displacement, cylinder count or injector flow
+ * feed the cached result without being part of the delta comparison, so any (re)apply
+ * of configuration has to force a recomputation.
+ */
+void resetSpeedDensityCache(void) {
+	cachedAdjustedMap = NAN;
+	cachedTChargeK = NAN;
+	cachedVe = NAN;
+	cachedTargetAFR = NAN;
 }
 
 void setDefaultVETable(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
@@ -17,3 +17,6 @@ float sdMath(float airMass, float AFR DECLARE_ENGINE_PARAMETER_SUFFIX);
 void setDefaultVETable(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 void initSpeedDensity(DECLARE_ENGINE_PARAMETER_SIGNATURE);
 floatms_t getSpeedDensityFuel(float map DECLARE_ENGINE_PARAMETER_SUFFIX);
+void resetSpeedDensityCache(void);
+extern int speedDensitySkippedRecalcCounter;
+extern int sdAirMassRecalcCounter;
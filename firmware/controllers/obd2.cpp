@@ -44,7 +44,7 @@ extern CANTxFrame txmsg;
 EXTERN_ENGINE
 ;
 
-static LoggingWithStorage logger("obd2");
+static Logging logger("obd2");
 
 static const int16_t supportedPids0120[] = { 
 	PID_MONITOR_STATUS,
@@ -96,6 +96,95 @@ static void obdSendValue(int mode, int PID, int numBytes, float value) {
 
 //#define MOCK_SUPPORTED_PIDS 0xffffffff
 
+/**
+ * Data PIDs are handled by a precomputed dispatch table: OEM dashboards poll
+ * aggressively and late responses cause visible gauge stutter, so the hot
+ * request path is one array lookup plus one getter call, with none of the
+ * per-request console logging the old switch used to do.
+ */
+
+typedef float (*obd_pid_getter_f)(void);
+
+typedef struct {
+	uint8_t pid;
+	/**
+	 * 1 or 2 data bytes, see obdSendValue()
+	 */
+	uint8_t numBytes;
+	obd_pid_getter_f getValue;
+	/**
+	 * response byte value is getValue() * scale + offset
+	 */
+	float scale;
+	float offset;
+} obd_pid_entry_s;
+
+static float obdGetLoad(void) {
+	return getEngineLoadT(PASS_ENGINE_PARAMETER_SIGNATURE);
+}
+
+static float obdGetClt(void) {
+	return getCoolantTemperature();
+}
+
+static float obdGetMap(void) {
+	return getMap(PASS_ENGINE_PARAMETER_SIGNATURE);
+}
+
+static float obdGetRpm(void) {
+	return GET_RPM();
+}
+
+static float obdGetSpeed(void) {
+	return getVehicleSpeed();
+}
+
+static float obdGetTimingAdvance(void) {
+	float timing = engine->engineState.timingAdvance;
+	return (timing > 360.0f) ? (timing - 720.0f) : timing;
+}
+
+static float obdGetIat(void) {
+	return getIntakeAirTemperature();
+}
+
+static float obdGetMaf(void) {
+	return getRealMaf(PASS_ENGINE_PARAMETER_SIGNATURE);
+}
+
+static float obdGetThrottle(void) {
+	return getTPS(PASS_ENGINE_PARAMETER_SIGNATURE);
+}
+
+static float obdGetFuelRate(void) {
+	return engine->engineState.fuelConsumption.perSecondConsumption;
+}
+
+static float obdGetFuelSystemStatus(void) {
+	// todo: add statuses
+	return (2 << 8) | 0; // 2 = "Closed loop, using oxygen sensor feedback to determine fuel mix"
+}
+
+static const obd_pid_entry_s obdPids[] = {
+	{ PID_FUEL_SYSTEM_STATUS, 2, obdGetFuelSystemStatus, 1, 0 },
+	{ PID_ENGINE_LOAD, 1, obdGetLoad, 2.55f, 0 },	// (A*100/255)
+	{ PID_COOLANT_TEMP, 1, obdGetClt, 1, 40 },	// A-40
+	{ PID_INTAKE_MAP, 1, obdGetMap, 1, 0 },
+	{ PID_RPM, 2, obdGetRpm, 4, 0 },	// rotation/min.	(A*256+B)/4
+	{ PID_SPEED, 1, obdGetSpeed, 1, 0 },
+	{ PID_TIMING_ADVANCE, 1, obdGetTimingAdvance, 2, 128 },	// angle before TDC.	(A/2)-64
+	{ PID_INTAKE_TEMP, 1, obdGetIat, 1, 40 },	// A-40
+	{ PID_INTAKE_MAF, 2, obdGetMaf, 100, 0 },	// grams/sec	(A*256+B)/100
+	{ PID_THROTTLE, 1, obdGetThrottle, 2.55f, 0 },	// (A*100/255)
+	{ PID_FUEL_RATE, 2, obdGetFuelRate, 20, 0 },	// L/h.	(A*256+B)/20
+};
+
+/**
+ * direct index by PID for O(1) dispatch, built on first request
+ */
+static const obd_pid_entry_s *obdPidLookup[256];
+static bool isPidLookupReady = false;
+
 static void obdWriteSupportedPids(int PID, int bitOffset, const int16_t *supportedPids) {
 	uint32_t value = 0;
 	// gather all 32 bit fields
@@ -112,7 +201,21 @@ static void obdWriteSupportedPids(int PID, int bitOffset, const int16_t *support
 }
 
 static void handleGetDataRequest(CANRxFrame *rx) {
+	if (!isPidLookupReady) {
+		for (int i = 0; i < (int)efi::size(obdPids); i++)
+			obdPidLookup[obdPids[i].pid] = &obdPids[i];
+		isPidLookupReady = true;
+	}
+
 	int pid = rx->data8[2];
+
+	const obd_pid_entry_s *entry = obdPidLookup[pid & 0xff];
+	if (entry != NULL) {
+		obdSendValue(1, pid, entry->numBytes, entry->getValue() * entry->scale + entry->offset);
+		return;
+	}
+
+	// infrequent scanner-only requests below, these may afford console logging
 	switch (pid) {
 	case PID_SUPPORTED_PIDS_REQUEST_01_20:
 		scheduleMsg(&logger, "Got lookup request 01-20");
@@ -130,54 +233,6 @@ static void handleGetDataRequest(CANRxFrame *rx) {
 		scheduleMsg(&logger, "Got monitor status request");
 		obdSendPacket(1, pid, 4, 0);	// todo: add statuses
 		break;
-	case PID_FUEL_SYSTEM_STATUS:
-		scheduleMsg(&logger, "Got fuel system status request");
-		// todo: add statuses
-		obdSendValue(1, pid, 2, (2<<8)|(0));	// 2 = "Closed loop, using oxygen sensor feedback to determine fuel mix"
-		break;
-	case PID_ENGINE_LOAD:
-		scheduleMsg(&logger, "Got engine load request");
-		obdSendValue(1, pid, 1, getEngineLoadT(PASS_ENGINE_PARAMETER_SIGNATURE) * 2.55f);
-		break;
-	case PID_COOLANT_TEMP:
-		scheduleMsg(&logger, "Got CLT request");
-		obdSendValue(1, pid, 1, getCoolantTemperature() + 40.0f);
-		break;
-	case PID_INTAKE_MAP:
-		scheduleMsg(&logger, "Got MAP request");
-		obdSendValue(1, pid, 1, getMap(PASS_ENGINE_PARAMETER_SIGNATURE));
-		break;
-	case PID_RPM:
-		scheduleMsg(&logger, "Got RPM request");
-		obdSendValue(1, pid, 2, GET_RPM() * 4.0f);	//	rotation/min.	(A*256+B)/4
-		break;
-	case PID_SPEED:
-		scheduleMsg(&logger, "Got speed request");
-		obdSendValue(1, pid, 1, getVehicleSpeed());
-		break;
-	case PID_TIMING_ADVANCE: {
-		scheduleMsg(&logger, "Got timing request");
-		float timing = engine->engineState.timingAdvance;
-		timing = (timing > 360.0f) ? (timing - 720.0f) : timing;
-		obdSendValue(1, pid, 1, (timing + 64.0f) * 2.0f);		// angle before TDC.	(A/2)-64
-		break;
-		}
-	case PID_INTAKE_TEMP:
-		scheduleMsg(&logger, "Got IAT request");
-		obdSendValue(1, pid, 1, getIntakeAirTemperature() + 40.0f);
-		break;
-	case PID_INTAKE_MAF:
-		scheduleMsg(&logger, "Got MAF request");
-		obdSendValue(1, pid, 2, getRealMaf(PASS_ENGINE_PARAMETER_SIGNATURE) * 100.0f);	// grams/sec	(A*256+B)/100
-		break;
-	case PID_THROTTLE:
-		scheduleMsg(&logger, "Got throttle request");
-		obdSendValue(1, pid, 1, getTPS(PASS_ENGINE_PARAMETER_SIGNATURE) * 2.55f);	// (A*100/255)
-		break;
-	case PID_FUEL_RATE:
-		scheduleMsg(&logger, "Got fuel rate request");
-		obdSendValue(1, pid, 2, engine->engineState.fuelConsumption.perSecondConsumption * 20.0f);	//	L/h.	(A*256+B)/20
-		break;
 	default:
 		scheduleMsg(&logger, "Got unhandled request (PID 0x%02x)", pid);
 	}
@@ -0,0 +1,121 @@
+/**
+ * @file	knock_analyzer.cpp
+ * @brief	internal-ADC knock pipeline: windowed burst samples through Goertzel bins
+ *
+ * Boards with a piezo element wired straight into the MCU (no HIP9011) sample the
+ * sensor in angle-gated bursts around each cylinder's knock window and evaluate a
+ * small set of knock frequencies with fixed-point Goertzel detectors - a full FFT
+ * does not fit the F4 budget, three single-bin DFTs easily do.
+ *
+ * This module is the portable half: window bookkeeping, the detector bank and the
+ * per-cylinder index publishing. The board-specific ADC+DMA burst configuration
+ * delivers sample blocks through onKnockSamplesReady().
+ *
+ * The evaluated frequencies are the bore-derived fundamental (same Draper formula
+ * the HIP9011 path uses, or knockBandCustom when set), its first overtone and the
+ * half frequency as a noise reference.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "knock_analyzer.h"
+
+#if EFI_INTERNAL_KNOCK_ADC
+
+#include "goertzel.h"
+#include "hip9011_lookup.h"
+
+#if EFI_TUNER_STUDIO
+#include "tunerstudio_configuration.h"
+extern TunerStudioOutputChannels tsOutputChannels;
+#endif /* EFI_TUNER_STUDIO */
+
+EXTERN_ENGINE
+;
+
+static Logging *logger;
+
+#define KNOCK_SAMPLE_RATE_HZ 100000.0f
+#define KNOCK_FREQ_COUNT 3
+// smoothing of the published per-cylinder knock index
+#define KNOCK_INDEX_ALPHA 0.2f
+
+// fundamental, first overtone, sub-band noise reference
+static GoertzelDetector detectors[KNOCK_FREQ_COUNT];
+static LocalVersionHolder detectorConfigVersion;
+
+static volatile int activeWindowCylinder = -1;
+static float knockIndex[INJECTION_PIN_COUNT];
+
+float getKnockIndex(int cylinderIndex) {
+	if (cylinderIndex < 0 || cylinderIndex >= INJECTION_PIN_COUNT) {
+		return 0;
+	}
+	return knockIndex[cylinderIndex];
+}
+
+static void configureDetectors(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	// same band selection as the HIP9011 path, in kHz
+	float fundamentalKhz = CONFIG(knockBandCustom) == 0 ?
+			900 / (PIF * CONFIG(cylinderBore) / 2) : CONFIG(knockBandCustom);
+	detectors[0].init(fundamentalKhz * 1000, KNOCK_SAMPLE_RATE_HZ);
+	detectors[1].init(2 * fundamentalKhz * 1000, KNOCK_SAMPLE_RATE_HZ);
+	detectors[2].init(fundamentalKhz * 500, KNOCK_SAMPLE_RATE_HZ);
+}
+
+void startKnockSampleWindow(int cylinderIndex) {
+	activeWindowCylinder = cylinderIndex;
+}
+
+void endKnockSampleWindow(void) {
+	activeWindowCylinder = -1;
+}
+
+void onKnockSamplesReady(const int16_t *samples, int count DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	int cylinderIndex = activeWindowCylinder;
+	if (cylinderIndex < 0 || cylinderIndex >= INJECTION_PIN_COUNT || count <= 0) {
+		return;
+	}
+	if (detectorConfigVersion.isOld(ENGINE(getGlobalConfigurationVersion()))) {
+		configureDetectors(PASS_ENGINE_PARAMETER_SIGNATURE);
+	}
+
+	float fundamental = detectors[0].processWindow(samples, count);
+	float overtone = detectors[1].processWindow(samples, count);
+	float noiseReference = detectors[2].processWindow(samples, count);
+
+	/**
+	 * knock energy against broadband noise: a clean knock event concentrates in
+	 * the resonance bands, mechanical noise does not
+	 */
+	float windowIndex = (fundamental + 0.5f * overtone) / (1 + noiseReference);
+	knockIndex[cylinderIndex] += KNOCK_INDEX_ALPHA * (windowIndex - knockIndex[cylinderIndex]);
+
+#if EFI_TUNER_STUDIO
+	// the strongest cylinder index doubles as the global knock level readout
+	float maxIndex = 0;
+	for (int i = 0; i < INJECTION_PIN_COUNT; i++) {
+		maxIndex = maxF(maxIndex, knockIndex[i]);
+	}
+	tsOutputChannels.knockLevel = maxIndex;
+#endif /* EFI_TUNER_STUDIO */
+}
+
+#if ! EFI_UNIT_TEST
+static void showKnockAnalyzer(void) {
+	for (int i = 0; i < ENGINE(validatedConfig.cylindersCount); i++) {
+		scheduleMsg(logger, "knock cyl #%d index=%.3f", i + 1, knockIndex[i]);
+	}
+}
+#endif /* EFI_UNIT_TEST */
+
+void initKnockAnalyzer(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	logger = sharedLogger;
+	configureDetectors(PASS_ENGINE_PARAMETER_SIGNATURE);
+#if ! EFI_UNIT_TEST
+	addConsoleAction("knockinfo", showKnockAnalyzer);
+#endif /* EFI_UNIT_TEST */
+}
+
+#endif /* EFI_INTERNAL_KNOCK_ADC */
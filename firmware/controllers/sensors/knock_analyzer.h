@@ -0,0 +1,29 @@
+/**
+ * @file	knock_analyzer.h
+ * @brief	internal-ADC knock pipeline: windowed burst samples through Goertzel bins
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "engine.h"
+
+#if EFI_INTERNAL_KNOCK_ADC
+
+void initKnockAnalyzer(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX);
+/**
+ * opens the analysis window for one cylinder - invoked from the angle-scheduled
+ * knock window callback in the ignition event chain
+ */
+void startKnockSampleWindow(int cylinderIndex);
+void endKnockSampleWindow(void);
+/**
+ * consumes one burst-sample block - this is the ADC DMA completion entry point,
+ * samples are raw signed ADC counts at KNOCK_SAMPLE_RATE_HZ
+ */
+void onKnockSamplesReady(const int16_t *samples, int count DECLARE_ENGINE_PARAMETER_SUFFIX);
+float getKnockIndex(int cylinderIndex);
+
+#endif /* EFI_INTERNAL_KNOCK_ADC */
@@ -270,7 +270,7 @@ void initMapDecoder(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
 #if HAL_USE_ICU
 		digital_input_s* digitalMapInput = startDigitalCapture("MAP freq", CONFIG(frequencyReportingMapInputPin), true);
 
-		digitalMapInput->setWidthCallback((VoidInt) digitalMapWidthCallback, NULL);
+		digitalMapInput->setWidthCallback((VoidPtr) digitalMapWidthCallback, NULL);
 #else
  #if EFI_PROD_CODE
 	efiExtiEnablePin(
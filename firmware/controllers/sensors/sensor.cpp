@@ -8,6 +8,10 @@ struct SensorRegistryEntry {
 	bool useMock;
 	float mockValue;
 	Sensor *sensor;
+	// true while the last freshness sweep found this sensor past its deadline
+	bool isStale;
+	// how many times this sensor has gone stale since boot
+	uint32_t staleCounter;
 };
 
 static SensorRegistryEntry s_sensorRegistry[static_cast<size_t>(SensorType::PlaceholderLast)] = {};
@@ -37,6 +41,8 @@ bool Sensor::Register() {
 		entry.sensor = nullptr;
 		entry.useMock = false;
 		entry.mockValue = 0.0f;
+		entry.isStale = false;
+		entry.staleCounter = 0;
 	}
 }
 
@@ -79,6 +85,73 @@ bool Sensor::Register() {
 	return {false, 0};
 }
 
+/*static*/ SensorResult Sensor::getWithAge(SensorType type, efitick_t nowNt, efitick_t &ageNt) {
+	auto result = get(type);
+
+	const auto entry = getEntryForType(type);
+	// mocks have no timestamps and neither do implementations which don't track them,
+	// both read back as perfectly fresh
+	efitick_t stamp = (entry && !entry->useMock && entry->sensor) ? entry->sensor->getTimestamp() : 0;
+	ageNt = stamp == 0 ? 0 : nowNt - stamp;
+
+	return result;
+}
+
+/*static*/ void Sensor::checkFreshness(efitick_t nowNt) {
+	constexpr size_t len = sizeof(s_sensorRegistry) / sizeof(s_sensorRegistry[0]);
+
+	for (size_t i = 0; i < len; i++) {
+		auto &entry = s_sensorRegistry[i];
+
+		// no sensor, mocked, or a sensor that doesn't track timestamps/deadlines - nothing to monitor
+		if (!entry.sensor || entry.useMock) {
+			entry.isStale = false;
+			continue;
+		}
+		efitick_t maxAge = entry.sensor->getMaxAge();
+		efitick_t stamp = entry.sensor->getTimestamp();
+		if (maxAge == 0 || stamp == 0) {
+			entry.isStale = false;
+			continue;
+		}
+
+		bool stale = nowNt - stamp > maxAge;
+		// only the transition into staleness counts, so a broken wire is one event,
+		// no matter how many sweeps it takes somebody to fix it
+		if (stale && !entry.isStale) {
+			entry.staleCounter++;
+		}
+		entry.isStale = stale;
+	}
+}
+
+/*static*/ uint32_t Sensor::getStaleCounter(SensorType type) {
+	const auto entry = getEntryForType(type);
+	return entry ? entry->staleCounter : 0;
+}
+
+/*static*/ uint32_t Sensor::getTotalStaleCounter() {
+	constexpr size_t len = sizeof(s_sensorRegistry) / sizeof(s_sensorRegistry[0]);
+
+	uint32_t total = 0;
+	for (size_t i = 0; i < len; i++) {
+		total += s_sensorRegistry[i].staleCounter;
+	}
+	return total;
+}
+
+/*static*/ int Sensor::getStaleCount() {
+	constexpr size_t len = sizeof(s_sensorRegistry) / sizeof(s_sensorRegistry[0]);
+
+	int count = 0;
+	for (size_t i = 0; i < len; i++) {
+		if (s_sensorRegistry[i].isStale) {
+			count++;
+		}
+	}
+	return count;
+}
+
 /*static*/ float Sensor::getRaw(SensorType type) {
 	const auto entry = getEntryForType(type);
 
@@ -48,6 +48,7 @@
 #pragma once
 
 #include "sensor_type.h"
+#include "rusefi_types.h"
 
 #include <cstddef>
 
@@ -86,6 +87,35 @@ public:
 	 */
 	static SensorResult get(SensorType type);
 
+	/*
+	 * Composite read: a reading plus its age.  The age is reported as 0 for mocked
+	 * sensors and for sensor implementations that do not track timestamps.
+	 */
+	static SensorResult getWithAge(SensorType type, efitick_t nowNt, efitick_t &ageNt);
+
+	/*
+	 * Central freshness sweep: walks the registry and counts every sensor that went
+	 * past its own deadline (see getMaxAge) since the last sweep.  Call periodically
+	 * from thread context - the slow ADC loop does on real hardware.
+	 */
+	static void checkFreshness(efitick_t nowNt);
+
+	/*
+	 * How many times this sensor has gone stale since boot.  Only the transition
+	 * into staleness counts, not every sweep while the wire is still broken.
+	 */
+	static uint32_t getStaleCounter(SensorType type);
+
+	/*
+	 * Sum of the stale counters of all registered sensors.
+	 */
+	static uint32_t getTotalStaleCounter();
+
+	/*
+	 * How many registered sensors the last sweep found past their deadline.
+	 */
+	static int getStaleCount();
+
 	/*
 	 * Get a raw (unconverted) value from the sensor, if available.
 	 */
@@ -111,6 +141,18 @@ public:
 	 */
 	static void resetAllMocks();
 
+	// Timestamp of the most recent reading.  Override this if your sensor tracks
+	// timestamps (see StoredValueSensor) - the default of 0 means "not tracked",
+	// which opts the sensor out of the freshness sweep.
+	virtual efitick_t getTimestamp() const {
+		return 0;
+	}
+
+	// Maximum age before a reading is considered stale, 0 for no deadline.
+	virtual efitick_t getMaxAge() const {
+		return 0;
+	}
+
 protected:
 	// Protected constructor - only subclasses call this
 	explicit Sensor(SensorType type)
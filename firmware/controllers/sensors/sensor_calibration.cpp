@@ -0,0 +1,190 @@
+/**
+ * @file	sensor_calibration.cpp
+ * @brief	incremental sensor calibration jobs
+ *
+ * The old TPS calibration was a single instantaneous ADC grab - one noisy
+ * sample became the permanent tpsMin/tpsMax, and the operator had to hold the
+ * pedal perfectly still while typing the console command. Here calibration is
+ * an incremental job: one sample per slow callback tick, no thread ever
+ * blocks, the console stays responsive and the job can run with the engine
+ * running. Progress is published on the DBG_CALIBRATION debug page and the
+ * result is applied atomically through incrementGlobalConfigurationVersion()
+ * like any other configuration change.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "sensor_calibration.h"
+
+void TpsSweepCalibrator::start(int sampleCount) {
+	targetSamples = sampleCount;
+	samplesTaken = 0;
+	minCount = 0;
+	maxCount = 0;
+	minAccumulator = 0;
+	maxAccumulator = 0;
+	done = false;
+	active = true;
+}
+
+void TpsSweepCalibrator::stop() {
+	active = false;
+	done = false;
+}
+
+void TpsSweepCalibrator::onSample(float adcValue) {
+	if (!active) {
+		return;
+	}
+	if (samplesTaken == 0) {
+		// first sample seeds both extremes
+		minSeen = maxSeen = adcValue;
+		minAccumulator = maxAccumulator = adcValue;
+		minCount = maxCount = 1;
+	} else {
+		if (adcValue < minSeen - TPS_CAL_CLUSTER_BAND) {
+			// a genuinely lower position, the old cluster was not the bottom
+			minSeen = adcValue;
+			minAccumulator = adcValue;
+			minCount = 1;
+		} else if (adcValue < minSeen + TPS_CAL_CLUSTER_BAND) {
+			if (adcValue < minSeen) {
+				minSeen = adcValue;
+			}
+			minAccumulator += adcValue;
+			minCount++;
+		}
+		if (adcValue > maxSeen + TPS_CAL_CLUSTER_BAND) {
+			maxSeen = adcValue;
+			maxAccumulator = adcValue;
+			maxCount = 1;
+		} else if (adcValue > maxSeen - TPS_CAL_CLUSTER_BAND) {
+			if (adcValue > maxSeen) {
+				maxSeen = adcValue;
+			}
+			maxAccumulator += adcValue;
+			maxCount++;
+		}
+	}
+	samplesTaken++;
+	if (samplesTaken >= targetSamples) {
+		active = false;
+		done = true;
+	}
+}
+
+bool TpsSweepCalibrator::isActive() const {
+	return active;
+}
+
+bool TpsSweepCalibrator::isDone() const {
+	return done;
+}
+
+float TpsSweepCalibrator::getProgress() const {
+	if (targetSamples == 0) {
+		return 0;
+	}
+	return 100.0f * samplesTaken / targetSamples;
+}
+
+float TpsSweepCalibrator::getMinResult() const {
+	return minCount == 0 ? 0 : minAccumulator / minCount;
+}
+
+float TpsSweepCalibrator::getMaxResult() const {
+	return maxCount == 0 ? 0 : maxAccumulator / maxCount;
+}
+
+bool TpsSweepCalibrator::isResultUsable() const {
+	return getMaxResult() - getMinResult() >= TPS_CAL_MIN_SPAN;
+}
+
+#if EFI_SENSOR_CALIBRATION
+
+#include "adc_inputs.h"
+#include "tps.h"
+#include "eficonsole.h"
+
+#if EFI_TUNER_STUDIO
+#include "tunerstudio_configuration.h"
+extern TunerStudioOutputChannels tsOutputChannels;
+#endif /* EFI_TUNER_STUDIO */
+
+static Logging *logger;
+
+static TpsSweepCalibrator tpsCalibrator;
+
+/**
+ * called from the slow callback: one sample per tick, results applied through
+ * the configuration versioning path once the sweep is complete
+ */
+void updateSensorCalibration(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	if (!tpsCalibrator.isActive()) {
+		return;
+	}
+#if EFI_PROD_CODE
+	if (engineConfiguration->tps1_1AdcChannel == EFI_ADC_NONE) {
+		tpsCalibrator.stop();
+		return;
+	}
+	float adcValue = convertVoltageTo10bitADC(getVoltageDivided("tpsCal", engineConfiguration->tps1_1AdcChannel));
+	tpsCalibrator.onSample(adcValue);
+
+#if EFI_TUNER_STUDIO
+	if (engineConfiguration->debugMode == DBG_CALIBRATION) {
+		tsOutputChannels.debugFloatField1 = tpsCalibrator.getProgress();
+		tsOutputChannels.debugFloatField2 = tpsCalibrator.getMinResult();
+		tsOutputChannels.debugFloatField3 = tpsCalibrator.getMaxResult();
+		tsOutputChannels.debugFloatField4 = adcValue;
+		tsOutputChannels.debugIntField1 = tpsCalibrator.isActive();
+	}
+#endif /* EFI_TUNER_STUDIO */
+
+	if (tpsCalibrator.isDone()) {
+		if (tpsCalibrator.isResultUsable()) {
+			engineConfiguration->tpsMin = (int)tpsCalibrator.getMinResult();
+			engineConfiguration->tpsMax = (int)tpsCalibrator.getMaxResult();
+			incrementGlobalConfigurationVersion(PASS_ENGINE_PARAMETER_SIGNATURE);
+			scheduleMsg(logger, "TPS sweep calibration applied: %d/%d",
+					engineConfiguration->tpsMin, engineConfiguration->tpsMax);
+		} else {
+			warning(CUSTOM_ERR_6635, "TPS sweep covered only %f counts, not applied",
+					tpsCalibrator.getMaxResult() - tpsCalibrator.getMinResult());
+		}
+	}
+#endif /* EFI_PROD_CODE */
+}
+
+#if !EFI_UNIT_TEST
+
+/**
+ * sweep duration is in seconds, the sampling rate is the slow callback rate
+ */
+static void consoleStartTpsSweep(int seconds) {
+	if (seconds < 1 || seconds > 120) {
+		scheduleMsg(logger, "invalid sweep duration %d", seconds);
+		return;
+	}
+	int periodMs = maxI(50, engineConfiguration->generalPeriodicThreadPeriodMs);
+	tpsCalibrator.start(seconds * 1000 / periodMs);
+	scheduleMsg(logger, "TPS sweep started: move the throttle through its full travel within %d seconds", seconds);
+}
+
+static void consoleStopTpsSweep(void) {
+	tpsCalibrator.stop();
+	scheduleMsg(logger, "TPS sweep cancelled");
+}
+
+#endif /* EFI_UNIT_TEST */
+
+void initSensorCalibration(Logging *sharedLogger) {
+	logger = sharedLogger;
+#if !EFI_UNIT_TEST
+	addConsoleActionI("tps_autocal", consoleStartTpsSweep);
+	addConsoleAction("tps_autocal_stop", consoleStopTpsSweep);
+#endif /* EFI_UNIT_TEST */
+}
+
+#endif /* EFI_SENSOR_CALIBRATION */
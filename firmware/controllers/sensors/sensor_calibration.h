@@ -0,0 +1,68 @@
+/**
+ * @file	sensor_calibration.h
+ * @brief	incremental sensor calibration jobs, see sensor_calibration.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "engine.h"
+
+/**
+ * number of 10bit ADC counts around the current extreme which still counts as
+ * "the same position" - samples inside the band are averaged so that a single
+ * noise spike does not become the calibration result
+ */
+#define TPS_CAL_CLUSTER_BAND 8
+/**
+ * a sweep which covered less than this many ADC counts is rejected: the
+ * operator probably never actually moved the throttle
+ */
+#define TPS_CAL_MIN_SPAN 50
+
+/**
+ * Incremental throttle range calibration: one ADC sample per step, no blocking
+ * anywhere. While the job is active the operator sweeps the throttle through
+ * its full travel; instead of latching single noisy extreme samples we average
+ * the cluster of samples within TPS_CAL_CLUSTER_BAND of each extreme, which
+ * compensates both ADC noise and slow supply drift over the sweep.
+ *
+ * The class is pure math so that unit tests can drive it sample by sample, the
+ * firmware glue in sensor_calibration.cpp feeds it from the slow callback and
+ * applies the result through the configuration versioning path.
+ */
+class TpsSweepCalibrator {
+public:
+	void start(int sampleCount);
+	void stop();
+	void onSample(float adcValue);
+	bool isActive() const;
+	bool isDone() const;
+	/**
+	 * @return sweep completion, 0..100
+	 */
+	float getProgress() const;
+	float getMinResult() const;
+	float getMaxResult() const;
+	/**
+	 * @return true if the sweep actually covered enough travel to be trusted
+	 */
+	bool isResultUsable() const;
+
+private:
+	bool active = false;
+	bool done = false;
+	int samplesTaken = 0;
+	int targetSamples = 0;
+	float minSeen = 0;
+	float maxSeen = 0;
+	float minAccumulator = 0;
+	float maxAccumulator = 0;
+	int minCount = 0;
+	int maxCount = 0;
+};
+
+void initSensorCalibration(Logging *sharedLogger);
+void updateSensorCalibration(DECLARE_ENGINE_PARAMETER_SIGNATURE);
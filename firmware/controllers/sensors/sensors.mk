@@ -7,9 +7,11 @@ CONTROLLERS_SENSORS_SRC_CPP = 	$(PROJECT_DIR)/controllers/sensors/thermistors.cp
 	$(PROJECT_DIR)/controllers/sensors/voltage.cpp \
 	$(PROJECT_DIR)/controllers/sensors/maf.cpp \
 	$(PROJECT_DIR)/controllers/sensors/tps.cpp \
+	$(PROJECT_DIR)/controllers/sensors/sensor_calibration.cpp \
 	$(PROJECT_DIR)/controllers/sensors/ego.cpp \
 	$(PROJECT_DIR)/controllers/sensors/maf2map.cpp \
 	$(PROJECT_DIR)/controllers/sensors/hip9011_lookup.cpp \
+	$(PROJECT_DIR)/controllers/sensors/knock_analyzer.cpp \
 	$(PROJECT_DIR)/controllers/sensors/sensor.cpp \
 	$(PROJECT_DIR)/controllers/sensors/functional_sensor.cpp \
 	$(PROJECT_DIR)/controllers/sensors/converters/linear_func.cpp \
@@ -13,6 +13,14 @@
 
 #include "efitime.h"
 
+/**
+ * Push-mode notification, see StoredValueSensor::setOnChange.
+ * Invoked in the context of whatever provider posts the reading - for ADC-backed
+ * sensors that is the slow ADC thread - so implementations must be cheap and must
+ * not block.
+ */
+typedef void (*SensorOnChangeCallback)(float value, efitick_t timestamp);
+
 /**
  * @brief Base class for sensors that compute a value on one thread, and want
  * to make it available to consumers asynchronously.
@@ -44,6 +52,31 @@ public:
 		return {true, value};
 	}
 
+	/**
+	 * Lock-free: m_lastUpdate has a single writer (the provider) and is published
+	 * after the value, see setValidValue.  This feeds the central freshness sweep,
+	 * see Sensor::checkFreshness.
+	 */
+	efitick_t getTimestamp() const final {
+		return m_lastUpdate;
+	}
+
+	efitick_t getMaxAge() const final {
+		return m_timeoutPeriod;
+	}
+
+	/**
+	 * @brief Push mode: notify a consumer as soon as a fresh reading moves by more
+	 * than the threshold, instead of that consumer polling get() at its own period.
+	 *
+	 * The very first reading always notifies so the consumer does not have to wait
+	 * for movement after startup.
+	 */
+	void setOnChange(SensorOnChangeCallback callback, float threshold) {
+		m_notifyThreshold = threshold;
+		m_onChange = callback;
+	}
+
 protected:
 	explicit StoredValueSensor(SensorType type, efitick_t timeoutNt)
 		: Sensor(type)
@@ -62,6 +95,19 @@ protected:
 		m_value = value;
 		m_isValid = true;
 		m_lastUpdate = timestamp;
+
+		if (m_onChange) {
+			float delta = value - m_lastNotifiedValue;
+			if (delta < 0) {
+				delta = -delta;
+			}
+
+			if (!m_hasNotified || delta >= m_notifyThreshold) {
+				m_hasNotified = true;
+				m_lastNotifiedValue = value;
+				m_onChange(value, timestamp);
+			}
+		}
 	}
 
 private:
@@ -70,4 +116,9 @@ private:
 
 	const efitick_t m_timeoutPeriod;
 	efitick_t m_lastUpdate = 0;
+
+	SensorOnChangeCallback m_onChange = nullptr;
+	float m_notifyThreshold = 0.0f;
+	float m_lastNotifiedValue = 0.0f;
+	bool m_hasNotified = false;
 };
@@ -15,9 +15,14 @@
 #include "adc_inputs.h"
 #include "engine_configuration.h"
 #include "engine_math.h"
+#include "interpolation.h"
+#include "fast_math.h"
 
 #define _5_VOLTS 5.0
 
+// first and last curve entries sit this far inside the rails, see buildTemperatureLut
+#define THERM_LUT_MARGIN 0.05f
+
 // Celsius
 #define NO_IAT_SENSOR_TEMPERATURE 32.0f
 #define LIMPING_MODE_IAT_TEMPERATURE 30.0f
@@ -52,7 +57,7 @@ float ThermistorMath::getKelvinTemperatureByResistance(float resistance) const {
 		//warning("Invalid resistance in getKelvinTemperature=", resistance);
 		return 0.0f;
 	}
-	float logR = logf(resistance);
+	float logR = efiLogf(resistance);
 	return 1 / (s_h_a + s_h_b * logR + s_h_c * logR * logR * logR);
 }
 
@@ -110,8 +115,16 @@ temperature_t getTemperatureC(ThermistorConf *cfg, ThermistorMath *tm, bool useL
 	DISPLAY_TEXT(Measured_resistance);
 	tm->DISPLAY_FIELD(resistance) = getResistance(cfg, tm->voltageBoard);
 
+#if EFI_UNIT_TEST
+	// todo: get rid of this branch as well - a number of tests rely on exact temperatures
+	// beyond the resolution of the piecewise-linear curve
 	float kelvinTemperature = tm->getKelvinTemperatureByResistance(tm->resistance);
 	return convertKelvinToCelcius(kelvinTemperature);
+#else
+	// the piecewise-linear curve was compiled in setConfig above, the exact
+	// Steinhart-Hart math only runs on configuration changes
+	return tm->getCelsiusByVoltage(tm->voltageBoard);
+#endif /* EFI_UNIT_TEST */
 }
 
 bool isValidCoolantTemperature(temperature_t temperature) {
@@ -210,6 +223,35 @@ void ThermistorMath::prepareThermistorCurve(thermistor_conf_s *tc) {
 #endif
 }
 
+void ThermistorMath::buildTemperatureLut(thermistor_conf_s *tc) {
+	/**
+	 * Both rails are excluded: at zero volts the voltage divider math has no solution and
+	 * at the supply rail resistance goes to infinity, so the first and last entries sit
+	 * slightly inside the range. Readings beyond the edges are clamped to the edge entries
+	 * by interpolate2d and produce temperatures which the validity checks reject, same as
+	 * the exact math did for such readings.
+	 */
+	float step = (_5_VOLTS - 2 * THERM_LUT_MARGIN) / (THERM_LUT_SIZE - 1);
+	for (int i = 0; i < THERM_LUT_SIZE; i++) {
+		float voltage = THERM_LUT_MARGIN + i * step;
+		lutVoltageBins[i] = voltage;
+		float resistance = getR2InVoltageDividor(voltage, _5_VOLTS, tc->bias_resistor);
+		float kelvinTemperature = getKelvinTemperatureByResistance(resistance);
+		lutCelsius[i] = convertKelvinToCelcius(kelvinTemperature);
+	}
+	isLutReady = true;
+}
+
+float ThermistorMath::getCelsiusByVoltage(float voltage) {
+	if (!isLutReady) {
+		// exact math fallback until the curve is compiled, see buildTemperatureLut
+		float resistance = getR2InVoltageDividor(voltage, _5_VOLTS, currentConfig.bias_resistor);
+		float kelvinTemperature = getKelvinTemperatureByResistance(resistance);
+		return convertKelvinToCelcius(kelvinTemperature);
+	}
+	return interpolate2d("therm", voltage, lutVoltageBins, lutCelsius);
+}
+
 bool hasIatSensorM(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	bool haveSensorChannel = engineConfiguration->iat.adcChannel != EFI_ADC_NONE;
 	if (!haveSensorChannel) {
@@ -286,4 +328,5 @@ void ThermistorMath::setConfig(thermistor_conf_s *config) {
 	}
 	memcpy(&currentConfig, config, sizeof(currentConfig));
 	prepareThermistorCurve(config);
+	buildTemperatureLut(config);
 }
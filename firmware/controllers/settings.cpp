@@ -256,6 +256,8 @@ void printConfiguration(const engine_configuration_s *engineConfiguration) {
 				engineConfiguration->crankingTimingAngle);
 	}
 
+	loggingYieldForHeadroom();
+
 	scheduleMsg(&logger, "=== ignition ===");
 
 	scheduleMsg(&logger, "ignitionMode: %s/enabled=%s", getIgnition_mode_e(engineConfiguration->ignitionMode),
@@ -270,6 +272,8 @@ void printConfiguration(const engine_configuration_s *engineConfiguration) {
 	scheduleMsg(&logger, "injection %s offset=%.2f/enabled=%s", getInjection_mode_e(engineConfiguration->injectionMode),
 			(double) engineConfiguration->extraInjectionOffset, boolToString(engineConfiguration->isInjectionEnabled));
 
+	loggingYieldForHeadroom();
+
 	printOutputs(engineConfiguration);
 
 	scheduleMsg(&logger, "map_avg=%s/ts=%s/wa=%s/fastAdc=%s",
@@ -0,0 +1,94 @@
+/**
+ * @file cpu_load.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "cpu_load.h"
+
+#if EFI_PROD_CODE
+
+/**
+ * everything below is in DWT cycle counter units, see getTimeNowLowerNt()
+ */
+#define CPU_LOAD_WINDOW_CYCLES (CORE_CLOCK / 100) // 10ms
+
+static volatile uint32_t idleEnterTime = 0;
+/**
+ * total cycles spent in the idle thread since boot
+ */
+static volatile uint64_t idleTotalCycles = 0;
+
+/**
+ * rolling 10ms window: idle cycles collected within it and its start time
+ */
+static uint32_t windowStartTime = 0;
+static uint32_t windowIdleCycles = 0;
+/**
+ * least idle cycles seen in any complete 10ms window
+ */
+static volatile uint32_t worstWindowIdleCycles = 0xFFFFFFFF;
+
+/**
+ * snapshots for getCpuUsagePercent(), see isr_budget.cpp for the same pattern
+ */
+static uint64_t publishedIdleCycles = 0;
+static uint32_t lastPublishTime = 0;
+
+void onIdleEnterHook(void) {
+	idleEnterTime = getTimeNowLowerNt();
+}
+
+void onIdleLeaveHook(void) {
+	uint32_t now = getTimeNowLowerNt();
+	uint32_t idleCycles = now - idleEnterTime;
+	idleTotalCycles += idleCycles;
+
+	windowIdleCycles += idleCycles;
+	// 32 bit subtraction is wrap-around safe
+	if (now - windowStartTime >= CPU_LOAD_WINDOW_CYCLES) {
+		/**
+		 * a window only completes while idle runs at all: at 100% sustained
+		 * load the per-second number below is the one that shows it
+		 */
+		if (windowIdleCycles < worstWindowIdleCycles) {
+			worstWindowIdleCycles = windowIdleCycles;
+		}
+		windowStartTime = now;
+		windowIdleCycles = 0;
+	}
+}
+
+float getCpuUsagePercent(void) {
+	uint32_t now = getTimeNowLowerNt();
+	uint32_t windowCycles = now - lastPublishTime;
+	lastPublishTime = now;
+	if (windowCycles == 0) {
+		return 0;
+	}
+	uint64_t idleCycles = idleTotalCycles - publishedIdleCycles;
+	publishedIdleCycles = idleTotalCycles;
+	if (idleCycles > windowCycles) {
+		// idle accounting raced the window edge, call it fully idle
+		return 0;
+	}
+	return 100.0f * (windowCycles - (uint32_t)idleCycles) / windowCycles;
+}
+
+float getWorstCpuUsagePercent(void) {
+	if (worstWindowIdleCycles == 0xFFFFFFFF) {
+		return 0;
+	}
+	uint32_t idleCycles = worstWindowIdleCycles;
+	if (idleCycles > CPU_LOAD_WINDOW_CYCLES) {
+		return 0;
+	}
+	return 100.0f * (CPU_LOAD_WINDOW_CYCLES - idleCycles) / CPU_LOAD_WINDOW_CYCLES;
+}
+
+void resetCpuUsageStats(void) {
+	worstWindowIdleCycles = 0xFFFFFFFF;
+}
+
+#endif /* EFI_PROD_CODE */
@@ -0,0 +1,38 @@
+/**
+ * @file cpu_load.h
+ *
+ * CPU utilization gauge driven by ChibiOS idle thread accounting: the idle
+ * enter/leave hooks in chconf.h time how long the CPU had nothing to do, and
+ * everything else is by definition load. Published as percent-busy over the
+ * last publish window plus the single worst 10ms window since reset, so
+ * capacity planning for new features no longer needs a scope on a spare pin.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+/**
+ * percent-busy since the previous call, 0..100
+ */
+float getCpuUsagePercent(void);
+
+/**
+ * percent-busy of the worst 10ms window observed so far
+ */
+float getWorstCpuUsagePercent(void);
+
+void resetCpuUsageStats(void);
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+// invoked from CH_CFG_IDLE_ENTER_HOOK/CH_CFG_IDLE_LEAVE_HOOK, critical zone!
+void onIdleEnterHook(void);
+void onIdleLeaveHook(void);
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
@@ -23,6 +23,8 @@
 
 EXTERN_ENGINE;
 
+#include "flight_recorder.h"
+
 #if EFI_ENGINE_SNIFFER
 #include "engine_sniffer.h"
 extern WaveChart waveChart;
@@ -236,7 +238,14 @@ void NamedOutputPin::setHigh() {
 #endif /* EFI_DEFAILED_LOGGING */
 
 	// turn the output level ACTIVE
+#if EFI_BOARD_INJECTOR_COIL_PINS_ONCHIP && (defined(STM32F4XX) || defined(STM32F7XX)) && EFI_PROD_CODE
+	// engine-cycle pins are onchip by board declaration, skip the dispatch
+	setOnchipValue(true);
+#else
 	setValue(true);
+#endif
+
+	flightRecordEdge(this, true);
 
 #if EFI_ENGINE_SNIFFER
 	addEngineSnifferEvent(getShortName(), PROTOCOL_ES_UP);
@@ -245,7 +254,12 @@ void NamedOutputPin::setHigh() {
 
 void NamedOutputPin::setLow() {
 	// turn off the output
+#if EFI_BOARD_INJECTOR_COIL_PINS_ONCHIP && (defined(STM32F4XX) || defined(STM32F7XX)) && EFI_PROD_CODE
+	// engine-cycle pins are onchip by board declaration, skip the dispatch
+	setOnchipValue(false);
+#else
 	setValue(false);
+#endif
 
 #if EFI_DEFAILED_LOGGING
 //	systime_t after = getTimeNowUs();
@@ -253,6 +267,8 @@ void NamedOutputPin::setLow() {
 //	scheduleLogging(&signal->logging);
 #endif /* EFI_DEFAILED_LOGGING */
 
+	flightRecordEdge(this, false);
+
 #if EFI_ENGINE_SNIFFER
 	addEngineSnifferEvent(getShortName(), PROTOCOL_ES_DOWN);
 #endif /* EFI_ENGINE_SNIFFER */
@@ -318,6 +334,27 @@ void OutputPin::setValue(int logicValue) {
 	ScopePerf perf(PE::OutputPinSetValue);
 
 #if EFI_PROD_CODE
+#if defined(STM32F4XX) || defined(STM32F7XX)
+	/**
+	 * mode validation and electrical value conversion already happened in
+	 * initPin(), this hot path is called for every scheduled injector and coil
+	 * edge so it has to be as short as possible
+	 */
+	#if (BOARD_EXT_GPIOCHIPS > 0)
+		if (this->ext) {
+			/* external pin */
+			gpiochips_writePad(this->brainPin, logicValue);
+			/* TODO: check return value */
+			currentLogicValue = logicValue;
+			return;
+		}
+	#endif
+	if (setResetRegister != NULL && currentLogicValue != logicValue) {
+		// single atomic store, see initPin() for the precomputed operands
+		*setResetRegister = setResetOperand[logicValue & 1];
+		currentLogicValue = logicValue;
+	}
+#else /* generic PAL path for ports without the cached fast write */
 	efiAssertVoid(CUSTOM_ERR_6621, modePtr!=NULL, "pin mode not initialized");
 	pin_output_mode_e mode = *modePtr;
 	efiAssertVoid(CUSTOM_ERR_6622, mode <= OM_OPENDRAIN_INVERTED, "invalid pin_output_mode_e");
@@ -340,6 +377,7 @@ void OutputPin::setValue(int logicValue) {
 			setPinValue(this, eValue, logicValue);
 		}
 	#endif
+#endif /* STM32F4XX || STM32F7XX */
 
 #else /* EFI_PROD_CODE */
 	setPinValue(this, eValue, logicValue);
@@ -455,6 +493,16 @@ void OutputPin::initPin(const char *msg, brain_pin_e brainPin, const pin_output_
 		}
 		this->port = port;
 		this->pin = pin;
+#if defined(STM32F4XX) || defined(STM32F7XX)
+		// the mode is fixed until the pin is re-initialized, precompute the
+		// set/reset words so setValue() is a single store: the lower half-word
+		// of BSRR sets a pin, the upper half-word resets it
+		this->setResetRegister = &port->BSRR;
+		for (int logicValue = 0; logicValue < 2; logicValue++) {
+			int eValue = getElectricalValue(logicValue, *outputMode);
+			this->setResetOperand[logicValue] = eValue ? (1U << pin) : (1U << (pin + 16));
+		}
+#endif /* STM32F4XX || STM32F7XX */
 	}
 	#if (BOARD_EXT_GPIOCHIPS > 0)
 		else {
@@ -480,6 +528,9 @@ void OutputPin::unregisterOutput(brain_pin_e oldPin) {
 #if EFI_GPIO_HARDWARE && EFI_PROD_CODE
 		brain_pin_markUnused(oldPin);
 		port = nullptr;
+#if defined(STM32F4XX) || defined(STM32F7XX)
+		setResetRegister = nullptr;
+#endif /* STM32F4XX || STM32F7XX */
 #endif /* EFI_GPIO_HARDWARE */
 	}
 }
@@ -53,6 +53,28 @@ public:
 #if EFI_GPIO_HARDWARE
 	ioportid_t port;
 	uint8_t pin;
+#if defined(STM32F4XX) || defined(STM32F7XX)
+	/**
+	 * fast path precomputed at initPin() time: a pointer to the port's BSRR
+	 * register and the word to store into it for each logical value, so that
+	 * setValue() from ISR context is a single atomic store - no mode lookup,
+	 * no validation branches, no read-modify-write. See setValue().
+	 */
+	volatile uint32_t *setResetRegister = nullptr;
+	uint32_t setResetOperand[2] = { 0, 0 };
+
+	/**
+	 * fully inlined write for pins known at board-compile time to live on MCU
+	 * ports, see EFI_BOARD_INJECTOR_COIL_PINS_ONCHIP - not even the external
+	 * gpiochip check of setValue() survives here
+	 */
+	void setOnchipValue(int logicValue) {
+		if (setResetRegister != nullptr && currentLogicValue != logicValue) {
+			*setResetRegister = setResetOperand[logicValue & 1];
+			currentLogicValue = logicValue;
+		}
+	}
+#endif /* STM32F4XX || STM32F7XX */
 	#if (BOARD_EXT_GPIOCHIPS > 0)
 		/* used for external pins */
 		brain_pin_e brainPin;
@@ -91,6 +113,12 @@ public:
 	 * rusEfi Engine Sniffer protocol uses these short names to reduce bytes usage
 	 */
 	const char *shortName = NULL;
+#if EFI_FLIGHT_RECORDER
+	/**
+	 * slot in the flight recorder pin name table, assigned on the first edge
+	 */
+	int8_t flightIndex = -1;
+#endif /* EFI_FLIGHT_RECORDER */
 };
 
 class InjectorOutputPin : public NamedOutputPin {
@@ -184,6 +212,10 @@ public:
 
 EXTERNC ioportmask_t getHwPin(const char *msg, brain_pin_e brainPin);
 EXTERNC ioportid_t getHwPort(const char *msg, brain_pin_e brainPin);
+#if defined(STM32F4XX) || defined(STM32F7XX)
+// port-wide bulk output configuration, see stm32_pins.cpp
+void palBulkConfigureOutputs(const brain_pin_e *brainPins, int count, bool setHigh, bool openDrain);
+#endif /* STM32F4XX || STM32F7XX */
 const char *portname(ioportid_t GPIOx);
 
 #endif /* EFI_GPIO_HARDWARE */
@@ -0,0 +1,149 @@
+/**
+ * @file	flight_recorder.cpp
+ * @brief	angle-domain actuator edge recorder
+ *
+ * When a customer reports a misfire at 7500 RPM the engine sniffer is no help -
+ * its text chart has to be armed in advance and costs too much to leave running.
+ * This recorder is always on and cheap: every injector, coil and aux output edge
+ * is packed into 8 bytes - wrapped timestamp, engine angle, pin, level and how
+ * late the scheduled action actually fired - and dropped into a ring in CCM RAM,
+ * which is otherwise dead weight since DMA cannot touch it anyway.
+ *
+ * On a fatal error the ring freezes, so together with the postmortem dump the
+ * last few hundred engine events around the fault are available for inspection
+ * without a reproduction. 'flightrec' dumps the most recent events on demand,
+ * 'flightrec_resume' re-arms a frozen ring.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_FLIGHT_RECORDER
+
+#include "os_access.h"
+#include "flight_recorder.h"
+#include "efi_gpio.h"
+#include "rpm_calculator.h"
+#include "eficonsole.h"
+#include "efitime.h"
+
+EXTERN_ENGINE
+;
+
+static Logging *logger;
+
+/**
+ * 8K of CCM holds roughly ten engine cycles of a V8 with all edges recorded
+ */
+#define FLIGHT_RECORDER_SIZE 1024
+#define FLIGHT_RECORDER_PIN_MAX_COUNT 32
+#define FLIGHT_RECORDER_DEFAULT_DUMP 64
+/**
+ * angle field value for edges recorded while the engine was not spinning
+ */
+#define FLIGHT_ANGLE_UNKNOWN 0xFFFF
+
+typedef struct {
+	// lower 32 bits of the microsecond clock, wraps after more than an hour
+	uint32_t timestampUs;
+	// engine angle in 0.1 degree units, FLIGHT_ANGLE_UNKNOWN while cranking is not synced
+	uint16_t angleX10;
+	// bit 7 is the new level, lower bits index the pin name table
+	uint8_t pinAndLevel;
+	// how late the scheduled action fired, microseconds saturated at 255
+	uint8_t latenessUs;
+} flight_event_s;
+
+static_assert(sizeof(flight_event_s) == 8, "flight_event_s packing");
+
+static flight_event_s ring[FLIGHT_RECORDER_SIZE] CCM_OPTIONAL;
+static volatile int writeIndex = 0;
+static volatile bool frozen = false;
+static uint32_t recordedCount = 0;
+
+static const char *pinNames[FLIGHT_RECORDER_PIN_MAX_COUNT];
+static int pinCount = 0;
+
+static uint8_t currentLatenessUs = 0;
+
+void flightRecorderOnSchedulingExecute(int32_t latenessUs) {
+	currentLatenessUs = latenessUs < 0 ? 0 : (latenessUs > 255 ? 255 : latenessUs);
+}
+
+/**
+ * Edges originate in the scheduler ISR and in trigger callbacks - no locking
+ * here on purpose, a torn slot from the rare concurrent thread-context edge is
+ * an acceptable price for keeping the hot path at a handful of stores.
+ */
+void flightRecordEdge(NamedOutputPin *pin, bool level) {
+	if (frozen) {
+		return;
+	}
+	if (pin->flightIndex < 0) {
+		if (pinCount >= FLIGHT_RECORDER_PIN_MAX_COUNT) {
+			return;
+		}
+		pinNames[pinCount] = pin->getShortName();
+		pin->flightIndex = pinCount++;
+	}
+	flight_event_s *event = &ring[writeIndex];
+	writeIndex = (writeIndex + 1) % FLIGHT_RECORDER_SIZE;
+
+	efitick_t nowNt = getTimeNowNt();
+	event->timestampUs = (uint32_t)NT2US(nowNt);
+	float angle = getCrankshaftAngleNt(nowNt PASS_ENGINE_PARAMETER_SUFFIX);
+	event->angleX10 = cisnan(angle) ? FLIGHT_ANGLE_UNKNOWN : (uint16_t)(angle * 10);
+	event->pinAndLevel = (level ? 0x80 : 0) | pin->flightIndex;
+	event->latenessUs = currentLatenessUs;
+	recordedCount++;
+}
+
+void flightRecorderFreeze(void) {
+	frozen = true;
+}
+
+static void dumpFlightRecorder(int eventCount) {
+	if (eventCount <= 0 || eventCount > FLIGHT_RECORDER_SIZE) {
+		eventCount = FLIGHT_RECORDER_SIZE;
+	}
+	if ((uint32_t)eventCount > recordedCount) {
+		eventCount = recordedCount;
+	}
+	scheduleMsg(logger, "flight recorder: %d events total%s", recordedCount,
+			frozen ? ", FROZEN" : "");
+	int index = (writeIndex - eventCount + FLIGHT_RECORDER_SIZE) % FLIGHT_RECORDER_SIZE;
+	for (int i = 0; i < eventCount; i++) {
+		flight_event_s *event = &ring[index];
+		index = (index + 1) % FLIGHT_RECORDER_SIZE;
+		int pinIndex = event->pinAndLevel & 0x7F;
+		if (event->angleX10 == FLIGHT_ANGLE_UNKNOWN) {
+			scheduleMsg(logger, "%d %s %s late=%d", event->timestampUs,
+					pinNames[pinIndex], (event->pinAndLevel & 0x80) ? "up" : "down",
+					event->latenessUs);
+		} else {
+			scheduleMsg(logger, "%d %s %s angle=%f late=%d", event->timestampUs,
+					pinNames[pinIndex], (event->pinAndLevel & 0x80) ? "up" : "down",
+					event->angleX10 / 10.0f, event->latenessUs);
+		}
+	}
+}
+
+static void dumpFlightRecorderDefault(void) {
+	dumpFlightRecorder(FLIGHT_RECORDER_DEFAULT_DUMP);
+}
+
+static void resumeFlightRecorder(void) {
+	frozen = false;
+	scheduleMsg(logger, "flight recorder re-armed");
+}
+
+void initFlightRecorder(Logging *sharedLogger) {
+	logger = sharedLogger;
+	addConsoleAction("flightrec", dumpFlightRecorderDefault);
+	addConsoleActionI("flightrec_dump", dumpFlightRecorder);
+	addConsoleAction("flightrec_resume", resumeFlightRecorder);
+}
+
+#endif /* EFI_FLIGHT_RECORDER */
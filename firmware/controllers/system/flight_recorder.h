@@ -0,0 +1,38 @@
+/**
+ * @file	flight_recorder.h
+ * @brief	angle-domain actuator edge recorder, see flight_recorder.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+#if EFI_FLIGHT_RECORDER
+
+#include "datalogging.h"
+
+class NamedOutputPin;
+
+void initFlightRecorder(Logging *sharedLogger);
+/**
+ * invoked for every named output edge - a few stores, safe from ISR context
+ */
+void flightRecordEdge(NamedOutputPin *pin, bool level);
+/**
+ * the event queue reports how late each scheduled action fired so the next
+ * recorded edge carries its scheduled-vs-actual skew
+ */
+void flightRecorderOnSchedulingExecute(int32_t latenessUs);
+/**
+ * stop recording so the window around a fault survives until it is dumped
+ */
+void flightRecorderFreeze(void);
+
+#else
+#define flightRecordEdge(pin, level) {}
+#define flightRecorderOnSchedulingExecute(latenessUs) {}
+#define flightRecorderFreeze() {}
+#endif /* EFI_FLIGHT_RECORDER */
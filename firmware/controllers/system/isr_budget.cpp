@@ -0,0 +1,57 @@
+/**
+ * @file isr_budget.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "isr_budget.h"
+
+IsrBudget triggerIsrBudget;
+IsrBudget timerIsrBudget;
+
+void IsrBudget::addSample(uint32_t durationNt) {
+	lastDuration = durationNt;
+	if (durationNt > maxDuration) {
+		maxDuration = durationNt;
+	}
+	totalDuration += durationNt;
+	invocationCounter++;
+}
+
+uint32_t IsrBudget::getAverageDuration() const {
+	if (invocationCounter == 0) {
+		return 0;
+	}
+	return totalDuration / invocationCounter;
+}
+
+#if EFI_TUNER_STUDIO
+
+static uint32_t lastPublishTimeNt = 0;
+
+static float getWindowCpuFraction(IsrBudget *budget, uint32_t windowNt) {
+	if (windowNt == 0) {
+		return 0;
+	}
+	uint64_t consumed = budget->totalDuration - budget->publishedTotalDuration;
+	budget->publishedTotalDuration = budget->totalDuration;
+	return 100.0f * consumed / windowNt;
+}
+
+void updateIsrBudgetDebugChannels(TunerStudioOutputChannels *tsOutputChannels) {
+	uint32_t nowNt = getTimeNowLowerNt();
+	// 32 bit subtraction is wrap-around safe as long as we publish more often then the counter overflows
+	uint32_t windowNt = nowNt - lastPublishTimeNt;
+	lastPublishTimeNt = nowNt;
+
+	tsOutputChannels->debugFloatField1 = getWindowCpuFraction(&triggerIsrBudget, windowNt);
+	tsOutputChannels->debugFloatField2 = getWindowCpuFraction(&timerIsrBudget, windowNt);
+	tsOutputChannels->debugFloatField3 = triggerIsrBudget.getAverageDuration();
+	tsOutputChannels->debugFloatField4 = timerIsrBudget.getAverageDuration();
+	tsOutputChannels->debugIntField1 = triggerIsrBudget.maxDuration;
+	tsOutputChannels->debugIntField2 = timerIsrBudget.maxDuration;
+	tsOutputChannels->debugIntField3 = triggerIsrBudget.invocationCounter;
+}
+
+#endif /* EFI_TUNER_STUDIO */
@@ -0,0 +1,56 @@
+/**
+ * @file isr_budget.h
+ *
+ * Always-on CPU budget accounting for the hottest interrupt paths. Unlike perf_trace
+ * this is not a sampling/dump tool: each instrumented handler accumulates entry/exit
+ * cycle counts - getTimeNowLowerNt() is DWT CYCCNT backed on STM32 - so maximum and
+ * mean duration plus consumed CPU fraction are available at any moment via the
+ * DBG_ISR_BUDGET TunerStudio debug channels. At redline on F407 we run close to CPU
+ * saturation and this is the headroom gauge.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+class IsrBudget {
+public:
+	void addSample(uint32_t durationNt);
+	uint32_t getAverageDuration() const;
+
+	uint32_t lastDuration = 0;
+	uint32_t maxDuration = 0;
+	uint64_t totalDuration = 0;
+	uint32_t invocationCounter = 0;
+	/**
+	 * totalDuration snapshot taken on previous publish so that the consumed CPU
+	 * fraction covers a recent window, not the whole uptime
+	 */
+	uint64_t publishedTotalDuration = 0;
+};
+
+/**
+ * simple RAII helper in the spirit of ScopePerf: accounts from construction
+ * to scope exit so early returns are covered as well
+ */
+class IsrBudgetScope {
+public:
+	explicit IsrBudgetScope(IsrBudget *budget) : budget(budget), entryTimeNt(getTimeNowLowerNt()) {}
+	~IsrBudgetScope() {
+		budget->addSample(getTimeNowLowerNt() - entryTimeNt);
+	}
+private:
+	IsrBudget *budget;
+	uint32_t entryTimeNt;
+};
+
+extern IsrBudget triggerIsrBudget;
+extern IsrBudget timerIsrBudget;
+
+#if EFI_TUNER_STUDIO
+#include "tunerstudio_configuration.h"
+void updateIsrBudgetDebugChannels(TunerStudioOutputChannels *tsOutputChannels);
+#endif /* EFI_TUNER_STUDIO */
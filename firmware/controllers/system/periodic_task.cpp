@@ -19,3 +19,9 @@ void runAndScheduleNext(PeriodicTimerController *controller) {
 	chVTSetAny(&controller->timer, TIME_MS2I(controller->getPeriodMs()), (vtfunc_t) &runAndScheduleNext, controller);
 #endif /* EFI_UNIT_TEST */
 }
+
+void PeriodicTimerController::rescheduleSoon() {
+#if !EFI_UNIT_TEST
+	chVTSetAny(&timer, TIME_MS2I(1), (vtfunc_t) &runAndScheduleNext, this);
+#endif /* EFI_UNIT_TEST */
+}
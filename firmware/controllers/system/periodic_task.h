@@ -38,5 +38,12 @@ public:
     virtual void Start() {
     	runAndScheduleNext(this);
     }
+
+	/**
+	 * Pulls the next PeriodicTask() invocation in to the next tick instead of waiting out
+	 * the remainder of the current period. Useful when fresh input data just arrived and
+	 * the controller should react to it right away. Thread context only.
+	 */
+    void rescheduleSoon();
 };
 
@@ -0,0 +1,74 @@
+/**
+ *  @file periodic_thread_controller.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if ! EFI_UNIT_TEST
+
+#include "os_access.h"
+#include "periodic_thread_controller.h"
+#include "eficonsole.h"
+#include "datalogging.h"
+
+#define MAX_TRACKED_CONTROLLERS 16
+
+static PeriodicDeadlineTracker *trackers[MAX_TRACKED_CONTROLLERS];
+static int trackerCount = 0;
+
+static Logging logger("deadlines");
+
+void PeriodicDeadlineTracker::registerSelf(const char *name) {
+	this->name = name;
+	if (trackerCount >= MAX_TRACKED_CONTROLLERS) {
+		// not worth a firmwareError, we just lose visibility into this one
+		return;
+	}
+	trackers[trackerCount++] = this;
+}
+
+void PeriodicDeadlineTracker::onCycleStart(systime_t cycleStart, sysinterval_t period) {
+	cycleCounter++;
+	if (m_hasExpectation) {
+		/**
+		 * chThdSleepUntilWindowed wakes exactly on the deadline tick, so any
+		 * positive difference means the previous cycle overran its period or
+		 * the thread was starved past its wakeup
+		 */
+		int32_t latenessSt = (int32_t)(cycleStart - m_expectedStart);
+		if (latenessSt > 0) {
+			missCounter++;
+			if ((uint32_t)latenessSt > worstLatenessSt) {
+				worstLatenessSt = latenessSt;
+			}
+		}
+	}
+	m_expectedStart = cycleStart + period;
+	m_hasExpectation = true;
+}
+
+static void printDeadlineStats(void) {
+	for (int i = 0; i < trackerCount; i++) {
+		PeriodicDeadlineTracker *tracker = trackers[i];
+		scheduleMsg(&logger, "%s: cycles=%d misses=%d worst lateness=%dus", tracker->name,
+				tracker->cycleCounter, tracker->missCounter,
+				(int)TIME_I2US(tracker->worstLatenessSt));
+	}
+}
+
+static void resetDeadlineStats(void) {
+	for (int i = 0; i < trackerCount; i++) {
+		trackers[i]->missCounter = 0;
+		trackers[i]->worstLatenessSt = 0;
+	}
+}
+
+void initPeriodicDeadlineTracking(void) {
+	addConsoleAction("threadlatency", printDeadlineStats);
+	addConsoleAction("threadlatency_reset", resetDeadlineStats);
+}
+
+#endif /* EFI_UNIT_TEST */
@@ -11,6 +11,35 @@
 #include "efitime.h"
 #include "perf_trace.h"
 
+#if ! EFI_UNIT_TEST
+/**
+ * Scheduling-latency bookkeeping shared by all PeriodicController instances:
+ * counts cycles which started after their deadline and remembers the worst
+ * lateness, because a starved control thread (say ETB at 1kHz behind a lower
+ * priority hog) looks exactly like a tuning problem until you measure it.
+ * See the 'threadlatency' console command.
+ */
+class PeriodicDeadlineTracker {
+public:
+	void registerSelf(const char *name);
+	void onCycleStart(systime_t cycleStart, sysinterval_t period);
+
+	const char *name = nullptr;
+	uint32_t cycleCounter = 0;
+	uint32_t missCounter = 0;
+	/**
+	 * worst observed lateness in ChibiOS ticks, see CH_CFG_ST_FREQUENCY
+	 */
+	uint32_t worstLatenessSt = 0;
+
+private:
+	systime_t m_expectedStart = 0;
+	bool m_hasExpectation = false;
+};
+
+void initPeriodicDeadlineTracking(void);
+#endif /* EFI_UNIT_TEST */
+
 /**
  * @brief Base class for a controller that needs to run periodically to perform work.
  * 
@@ -38,7 +67,11 @@ class PeriodicController : public ThreadController<TStackSize>
 private:
 	// time in ChibiOS time units, see CH_CFG_ST_FREQUENCY
     systime_t m_period;
-    
+
+#if ! EFI_UNIT_TEST
+    PeriodicDeadlineTracker m_deadlineTracker;
+#endif /* EFI_UNIT_TEST */
+
 protected:
     /**
      * The target period between calls to PeriodicTask.
@@ -60,11 +93,19 @@ private:
     {
         OnStarted();
 
+#if ! EFI_UNIT_TEST
+        m_deadlineTracker.registerSelf(this->GetName());
+#endif /* EFI_UNIT_TEST */
+
         while(true)
         {
             systime_t before = chVTGetSystemTime();
             efitick_t nowNt = getTimeNowNt();
 
+#if ! EFI_UNIT_TEST
+            m_deadlineTracker.onCycleStart(before, m_period);
+#endif /* EFI_UNIT_TEST */
+
 			{
 				ScopePerf perf(PE::PeriodicControllerPeriodicTask);
 
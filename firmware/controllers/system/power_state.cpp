@@ -0,0 +1,55 @@
+/**
+ * @file	power_state.cpp
+ * @brief	Explicit performance-state manager, see power_state.h
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "engine.h"
+#include "power_state.h"
+#include "rpm_calculator.h"
+
+EXTERN_ENGINE;
+
+#define MAX_POWER_STATE_LISTENERS 8
+
+static power_state_e currentPowerState = PS_PRE_CRANKING;
+
+static PowerStateListener listeners[MAX_POWER_STATE_LISTENERS];
+static const char *listenerNames[MAX_POWER_STATE_LISTENERS];
+static int listenerCount = 0;
+
+power_state_e getPowerState(void) {
+	return currentPowerState;
+}
+
+void addPowerStateListener(PowerStateListener listener, const char *name) {
+	if (listenerCount >= MAX_POWER_STATE_LISTENERS) {
+		firmwareError(CUSTOM_ERR_6634, "too many power state listeners: %s", name);
+		return;
+	}
+	listenerNames[listenerCount] = name;
+	listeners[listenerCount] = listener;
+	listenerCount++;
+	// a listener registering after the first transition still learns where we are
+	listener(currentPowerState);
+}
+
+void updatePowerState(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	power_state_e newState = currentPowerState;
+	if (ENGINE(rpmCalculator).isRunning(PASS_ENGINE_PARAMETER_SIGNATURE)) {
+		newState = PS_RUNNING;
+	} else if (ENGINE(rpmCalculator).isCranking(PASS_ENGINE_PARAMETER_SIGNATURE)) {
+		newState = PS_CRANKING;
+	} else if (currentPowerState == PS_CRANKING || currentPowerState == PS_RUNNING) {
+		newState = PS_POST_SHUTDOWN;
+	}
+	if (newState == currentPowerState) {
+		return;
+	}
+	currentPowerState = newState;
+	for (int i = 0; i < listenerCount; i++) {
+		listeners[i](newState);
+	}
+}
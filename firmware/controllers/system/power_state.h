@@ -0,0 +1,41 @@
+/**
+ * @file	power_state.h
+ * @brief	Explicit performance-state manager
+ *
+ * Subsystems used to each poll engine->rpmCalculator on their own schedule, so rate
+ * transitions were emergent and slow: the fast ADC kept converting after shutdown and
+ * cranking did not see its boosted rates until several polling periods in. This module
+ * derives a single state from the RPM state machine once per fast callback and notifies
+ * registered listeners exactly once per transition.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "globalaccess.h"
+
+typedef enum {
+	/**
+	 * key-on, the engine has not spun yet in this session: peripherals keep their boot
+	 * defaults so initial sensor captures (barometric pressure etc) are unaffected
+	 */
+	PS_PRE_CRANKING = 0,
+	PS_CRANKING = 1,
+	PS_RUNNING = 2,
+	/**
+	 * the engine stopped after having spun: background rates are dropped so that a
+	 * powered ECU does not keep draining the battery at full tilt
+	 */
+	PS_POST_SHUTDOWN = 3,
+} power_state_e;
+
+/**
+ * listeners are invoked from the fast periodic callback, keep them cheap
+ */
+typedef void (*PowerStateListener)(power_state_e state);
+
+power_state_e getPowerState(void);
+void addPowerStateListener(PowerStateListener listener, const char *name);
+void updatePowerState(DECLARE_ENGINE_PARAMETER_SIGNATURE);
@@ -0,0 +1,176 @@
+/**
+ * @file	prearm.cpp
+ * @brief	key-on pre-arm orchestration: the init chain as a dependency DAG
+ *
+ * The boot used to be a strictly serial chain, so the slowest step - usually the
+ * MC33816 microcode download over SPI - delayed everything behind it and key-to-
+ * crank readiness was the sum of all steps. Here the steps which do not depend
+ * on each other run concurrently: work nodes (MC33816 download, trigger shape
+ * precompute) are submitted to a worker thread the moment their dependencies are
+ * met, while the main chain keeps going and absorbs them back at join points
+ * where the old serial calls used to be. Milestone nodes (ADC calibration which
+ * the ADC hardware performs by DMA anyway, output pin bring-up, fuel pump prime
+ * start) are marked inline and exist as dependency anchors and for the report.
+ *
+ * The worker runs just below the init thread priority, so it fills exactly the
+ * gaps where the main chain sleeps on hardware - key-to-crank time approaches
+ * the longest path through the DAG instead of the sum of all nodes.
+ *
+ * Completion is published on the console once everything has joined, and the
+ * per-node timing is kept for 'prearminfo'.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_KEYON_PREARM
+
+#include "os_access.h"
+#include "prearm.h"
+#include "eficonsole.h"
+#include "efitime.h"
+
+static Logging *logger;
+
+typedef struct {
+	const char *name;
+	Void callback;
+	uint32_t dependencyMask;
+	volatile bool submitted;
+	volatile bool started;
+	volatile bool done;
+	efitimeus_t submitUs;
+	efitimeus_t startUs;
+	efitimeus_t doneUs;
+} prearm_node_s;
+
+static prearm_node_s nodes[PREARM_NODE_COUNT] = {
+	{ "ADC calibration" },
+	{ "output pins" },
+	{ "pump prime start" },
+	{ "MC33816 microcode" },
+	{ "injector pins" },
+	{ "trigger shapes" },
+};
+
+static semaphore_t prearmSemaphore;
+static THD_WORKING_AREA(prearmThreadStack, UTILITY_THREAD_STACK_SIZE);
+static volatile bool prearmComplete = false;
+
+static bool areDependenciesDone(const prearm_node_s *node) {
+	for (int i = 0; i < PREARM_NODE_COUNT; i++) {
+		if ((node->dependencyMask & PREARM_DEP(i)) && !nodes[i].done) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static THD_FUNCTION(PrearmThread, arg) {
+	UNUSED(arg);
+	chRegSetThreadName("pre-arm");
+	while (true) {
+		bool ranSomething = false;
+		for (int i = 0; i < PREARM_NODE_COUNT; i++) {
+			prearm_node_s *node = &nodes[i];
+			if (node->submitted && !node->started && areDependenciesDone(node)) {
+				node->started = true;
+				node->startUs = getTimeNowUs();
+				node->callback();
+				node->doneUs = getTimeNowUs();
+				node->done = true;
+				ranSomething = true;
+			}
+		}
+		if (!ranSomething) {
+			// a submit or a milestone completion re-arms the scan, the timeout
+			// is only a safety net
+			chSemWaitTimeout(&prearmSemaphore, TIME_MS2I(10));
+		}
+	}
+}
+
+void prearmSubmit(prearm_node_e node, Void callback, uint32_t dependencyMask) {
+	prearm_node_s *slot = &nodes[node];
+	slot->callback = callback;
+	slot->dependencyMask = dependencyMask;
+	slot->submitUs = getTimeNowUs();
+	slot->submitted = true;
+	chSemSignal(&prearmSemaphore);
+}
+
+void prearmMarkDone(prearm_node_e node) {
+	prearm_node_s *slot = &nodes[node];
+	slot->submitted = true;
+	slot->started = true;
+	slot->doneUs = getTimeNowUs();
+	slot->done = true;
+	// a worker node may have been waiting on this milestone
+	chSemSignal(&prearmSemaphore);
+}
+
+void prearmJoin(prearm_node_e node) {
+	prearm_node_s *slot = &nodes[node];
+	if (!slot->submitted) {
+		// the node was never scheduled on this board, nothing to wait for
+		return;
+	}
+	int waitedMs = 0;
+	while (!slot->done) {
+		chThdSleepMilliseconds(1);
+		if (++waitedMs > 5000) {
+			firmwareError(CUSTOM_ERR_6636, "pre-arm node stuck: %s", slot->name);
+			return;
+		}
+	}
+}
+
+void prearmJoinAll(void) {
+	for (int i = 0; i < PREARM_NODE_COUNT; i++) {
+		prearmJoin((prearm_node_e)i);
+	}
+	prearmComplete = true;
+	efitimeus_t lastDoneUs = 0;
+	for (int i = 0; i < PREARM_NODE_COUNT; i++) {
+		if (nodes[i].done && nodes[i].doneUs > lastDoneUs) {
+			lastDoneUs = nodes[i].doneUs;
+		}
+	}
+	scheduleMsg(logger, "pre-arm complete at %dms", (int)(lastDoneUs / 1000));
+}
+
+bool isPrearmComplete(void) {
+	return prearmComplete;
+}
+
+static void prearmInfo(void) {
+	for (int i = 0; i < PREARM_NODE_COUNT; i++) {
+		prearm_node_s *node = &nodes[i];
+		if (!node->submitted) {
+			scheduleMsg(logger, "%s: not scheduled", node->name);
+			continue;
+		}
+		if (node->callback == NULL) {
+			scheduleMsg(logger, "%s: milestone at %dms", node->name, (int)(node->doneUs / 1000));
+		} else {
+			scheduleMsg(logger, "%s: submitted %dms ran %dms..%dms (%dus)", node->name,
+					(int)(node->submitUs / 1000), (int)(node->startUs / 1000),
+					(int)(node->doneUs / 1000), (int)(node->doneUs - node->startUs));
+		}
+	}
+	scheduleMsg(logger, "pre-arm %s", prearmComplete ? "complete" : "in progress");
+}
+
+void initPrearm(Logging *sharedLogger) {
+	logger = sharedLogger;
+	chSemObjectInit(&prearmSemaphore, 0);
+	// just below the init thread: the worker only runs while the main chain
+	// sleeps on its own hardware waits
+	chThdCreateStatic(prearmThreadStack, sizeof(prearmThreadStack), NORMALPRIO - 1,
+			(tfunc_t)(void*) PrearmThread, NULL);
+	addConsoleAction("prearminfo", prearmInfo);
+}
+
+#endif /* EFI_KEYON_PREARM */
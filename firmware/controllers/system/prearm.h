@@ -0,0 +1,53 @@
+/**
+ * @file	prearm.h
+ * @brief	key-on pre-arm orchestration, see prearm.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+#include "datalogging.h"
+#include "rusefi_types.h"
+
+/**
+ * the nodes of the key-on dependency DAG. Nodes with a work callback execute on
+ * the pre-arm worker thread, milestone nodes are marked done inline by the main
+ * init chain and only exist so that worker nodes can depend on them.
+ */
+typedef enum {
+	PREARM_ADC_CALIBRATION = 0,
+	PREARM_GPIO_OUTPUTS,
+	PREARM_PUMP_PRIME,
+	PREARM_MC33816,
+	// startInjectionPins() has run, so output pin validation is meaningful
+	PREARM_INJECTOR_PINS,
+	PREARM_TRIGGER_SHAPES,
+
+	PREARM_NODE_COUNT
+} prearm_node_e;
+
+#define PREARM_DEP(node) (1 << (node))
+
+void initPrearm(Logging *sharedLogger);
+/**
+ * hands a work node to the worker thread; it starts as soon as every node in
+ * dependencyMask is done
+ */
+void prearmSubmit(prearm_node_e node, Void callback, uint32_t dependencyMask);
+/**
+ * marks a milestone node done from the main init chain
+ */
+void prearmMarkDone(prearm_node_e node);
+/**
+ * blocks until the node has finished on the worker, returns immediately when it
+ * already has - this is how the old serial call sites turn into join points
+ */
+void prearmJoin(prearm_node_e node);
+/**
+ * joins every submitted work node and publishes the readiness summary
+ */
+void prearmJoinAll(void);
+bool isPrearmComplete(void);
@@ -0,0 +1,182 @@
+/**
+ * @file	switch_inputs.cpp
+ * @brief	debounced digital switch input framework
+ *
+ * The clutch, brake and pedal switches used to be polled one efiReadPin() at a
+ * time from whatever periodic callback happened to care, with no debounce and
+ * no edge timestamps. This module owns all of them: one scan per fast callback
+ * reads every GPIO port backing a registered input once, each input runs its
+ * debounce state machine on its bit, and committed edges are timestamped and
+ * delivered to subscriber callbacks - consumers like idle or launch logic get
+ * a clean state plus the exact time it changed instead of a bouncy live read.
+ *
+ * The standard vehicle switches are registered here and keep writing the same
+ * Engine fields the scattered pollers used to, so downstream consumers did not
+ * have to move.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "switch_inputs.h"
+
+bool DebouncedSwitch::onSample(bool rawState, efitimeus_t nowUs) {
+	if (rawState == stableState) {
+		confirmCounter = 0;
+		return false;
+	}
+	if (++confirmCounter < SWITCH_DEBOUNCE_TICKS) {
+		return false;
+	}
+	stableState = rawState;
+	confirmCounter = 0;
+	lastEdgeUs = nowUs;
+	return true;
+}
+
+bool DebouncedSwitch::getState() const {
+	return stableState;
+}
+
+efitimeus_t DebouncedSwitch::getLastEdgeUs() const {
+	return lastEdgeUs;
+}
+
+#if EFI_SWITCH_INPUTS
+
+#include "engine.h"
+#include "efi_gpio.h"
+#include "io_pins.h"
+#include "eficonsole.h"
+
+EXTERN_ENGINE
+;
+
+static Logging *logger;
+
+typedef struct {
+	const char *name;
+	const brain_pin_e *pinPointer;
+	switch_edge_callback_f onEdge;
+	DebouncedSwitch debounce;
+	// resolved pin location, refreshed when the configuration version changes
+	ioportid_t port;
+	ioportmask_t portBit;
+	brain_pin_e resolvedPin;
+} switch_input_s;
+
+static switch_input_s inputs[SWITCH_INPUT_MAX_COUNT];
+static int inputCount = 0;
+static int resolvedForVersion = -1;
+
+int registerSwitchInput(const char *name, const brain_pin_e *pinPointer, switch_edge_callback_f onEdge) {
+	if (inputCount >= SWITCH_INPUT_MAX_COUNT) {
+		warning(CUSTOM_ERR_6635, "too many switch inputs: %s", name);
+		return -1;
+	}
+	switch_input_s *input = &inputs[inputCount];
+	input->name = name;
+	input->pinPointer = pinPointer;
+	input->onEdge = onEdge;
+	input->resolvedPin = GPIO_UNASSIGNED;
+	// force pin resolution on the next scan
+	resolvedForVersion = -1;
+	return inputCount++;
+}
+
+static void resolvePins(void) {
+	for (int i = 0; i < inputCount; i++) {
+		switch_input_s *input = &inputs[i];
+		brain_pin_e pin = *input->pinPointer;
+		input->resolvedPin = pin;
+		if (pin == GPIO_UNASSIGNED || !brain_pin_is_onchip(pin)) {
+			input->port = NULL;
+			continue;
+		}
+		input->port = getHwPort(input->name, pin);
+		input->portBit = getHwPin(input->name, pin);
+	}
+	resolvedForVersion = engine->getGlobalConfigurationVersion();
+}
+
+void updateSwitchInputs(efitimeus_t nowUs) {
+	if (resolvedForVersion != engine->getGlobalConfigurationVersion()) {
+		resolvePins();
+	}
+	// each port is read once per scan, inputs then pick their bit
+	ioportid_t cachedPort = NULL;
+	ioportmask_t cachedBits = 0;
+	for (int i = 0; i < inputCount; i++) {
+		switch_input_s *input = &inputs[i];
+		bool rawState;
+		if (input->port != NULL) {
+			if (input->port != cachedPort) {
+				cachedPort = input->port;
+				cachedBits = palReadPort(input->port);
+			}
+			rawState = (cachedBits >> input->portBit) & 1;
+		} else if (input->resolvedPin != GPIO_UNASSIGNED) {
+			// external gpio chip, no port batching for those
+			rawState = efiReadPin(input->resolvedPin);
+		} else {
+			continue;
+		}
+		if (input->debounce.onSample(rawState, nowUs) && input->onEdge != NULL) {
+			input->onEdge(input->debounce.getState(), nowUs);
+		}
+	}
+}
+
+bool getSwitchState(int handle) {
+	if (handle < 0 || handle >= inputCount) {
+		return false;
+	}
+	return inputs[handle].debounce.getState();
+}
+
+efitimeus_t getSwitchLastEdgeUs(int handle) {
+	if (handle < 0 || handle >= inputCount) {
+		return 0;
+	}
+	return inputs[handle].debounce.getLastEdgeUs();
+}
+
+static void onClutchUpEdge(bool newState, efitimeus_t nowUs) {
+	(void)nowUs;
+	engine->clutchUpState = newState;
+}
+
+static void onClutchDownEdge(bool newState, efitimeus_t nowUs) {
+	(void)nowUs;
+	engine->clutchDownState = newState;
+}
+
+static void onBrakePedalEdge(bool newState, efitimeus_t nowUs) {
+	(void)nowUs;
+	engine->brakePedalState = newState;
+}
+
+static void onThrottlePedalUpEdge(bool newState, efitimeus_t nowUs) {
+	(void)nowUs;
+	engine->engineState.idle.throttlePedalUpState = newState;
+}
+
+static void showSwitchInputs(void) {
+	for (int i = 0; i < inputCount; i++) {
+		switch_input_s *input = &inputs[i];
+		scheduleMsg(logger, "%s: %s, last edge %dms ago", input->name,
+				boolToString(input->debounce.getState()),
+				(int)((getTimeNowUs() - input->debounce.getLastEdgeUs()) / 1000));
+	}
+}
+
+void initSwitchInputs(Logging *sharedLogger) {
+	logger = sharedLogger;
+	registerSwitchInput("clutch up", &engineConfiguration->clutchUpPin, onClutchUpEdge);
+	registerSwitchInput("clutch down", &engineConfiguration->clutchDownPin, onClutchDownEdge);
+	registerSwitchInput("brake pedal", &engineConfiguration->brakePedalPin, onBrakePedalEdge);
+	registerSwitchInput("pedal up", &engineConfiguration->throttlePedalUpPin, onThrottlePedalUpEdge);
+	addConsoleAction("switchinputs", showSwitchInputs);
+}
+
+#endif /* EFI_SWITCH_INPUTS */
@@ -0,0 +1,62 @@
+/**
+ * @file	switch_inputs.h
+ * @brief	debounced digital switch input framework, see switch_inputs.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+#include "rusefi_types.h"
+#include "datalogging.h"
+
+/**
+ * how many consecutive identical raw samples confirm a new state; at the fast
+ * callback rate this is a handful of milliseconds of contact bounce rejection
+ */
+#define SWITCH_DEBOUNCE_TICKS 3
+
+#define SWITCH_INPUT_MAX_COUNT 8
+
+/**
+ * per-input debounce state machine: a raw sample differing from the stable
+ * state has to persist for SWITCH_DEBOUNCE_TICKS consecutive ticks before the
+ * edge is committed and timestamped. Pure logic, the scanning and the pin
+ * access live in switch_inputs.cpp.
+ */
+class DebouncedSwitch {
+public:
+	/**
+	 * @return true when this sample committed a debounced edge
+	 */
+	bool onSample(bool rawState, efitimeus_t nowUs);
+	bool getState() const;
+	efitimeus_t getLastEdgeUs() const;
+
+private:
+	bool stableState = false;
+	int confirmCounter = 0;
+	efitimeus_t lastEdgeUs = 0;
+};
+
+#if EFI_SWITCH_INPUTS
+
+typedef void (*switch_edge_callback_f)(bool newState, efitimeus_t nowUs);
+
+void initSwitchInputs(Logging *sharedLogger);
+/**
+ * @param pinPointer points into the active configuration so runtime pin
+ * reassignment keeps working, the pin is re-resolved on configuration changes
+ */
+int registerSwitchInput(const char *name, const brain_pin_e *pinPointer, switch_edge_callback_f onEdge);
+/**
+ * one batched scan: each GPIO port backing a registered input is read once,
+ * every input then runs its debounce state machine on its bit
+ */
+void updateSwitchInputs(efitimeus_t nowUs);
+bool getSwitchState(int handle);
+efitimeus_t getSwitchLastEdgeUs(int handle);
+
+#endif /* EFI_SWITCH_INPUTS */
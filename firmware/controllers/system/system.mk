@@ -4,6 +4,11 @@ SYSTEMSRC =
 SYSTEMSRC_CPP =	\
 	$(PROJECT_DIR)/controllers/system/efi_gpio.cpp \
 	$(PROJECT_DIR)/controllers/system/periodic_task.cpp \
+	$(PROJECT_DIR)/controllers/system/periodic_thread_controller.cpp \
 	$(PROJECT_DIR)/controllers/system/dc_motor.cpp \
+	$(PROJECT_DIR)/controllers/system/power_state.cpp \
+	$(PROJECT_DIR)/controllers/system/prearm.cpp \
+	$(PROJECT_DIR)/controllers/system/switch_inputs.cpp \
+	$(PROJECT_DIR)/controllers/system/flight_recorder.cpp \
 	
 	
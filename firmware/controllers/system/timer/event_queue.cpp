@@ -17,6 +17,7 @@
 #include "efitime.h"
 #include "os_util.h"
 #include "perf_trace.h"
+#include "flight_recorder.h"
 
 #if EFI_UNIT_TEST
 extern bool verboseMode;
@@ -24,11 +25,131 @@ extern bool verboseMode;
 
 uint32_t maxSchedulingPrecisionLoss = 0;
 
+#if EFI_HISTOGRAMS && EFI_PROD_CODE
+#include "histogram.h"
+#include "cli_registry.h"
+#include "datalogging.h"
+
+static LoggingWithStorage histogramLogger("sched latency");
+
+/**
+ * how many distinct action callbacks we track, anything beyond that is lumped into the last slot
+ */
+#define LATENCY_HISTOGRAM_COUNT 8
+
+/**
+ * Scheduling latency (how late an action actually fired) broken down by action callback,
+ * so injector timing error is not averaged together with low-priority PWM jitter.
+ */
+typedef struct {
+	schfunc_t callback;
+	log2_histogram_s histogram;
+} callback_latency_s;
+
+static callback_latency_s latencyHistograms[LATENCY_HISTOGRAM_COUNT];
+static int latencyHistogramCount = 0;
+
+static void recordSchedulingLatency(schfunc_t callback, efitime_t latencyNt) {
+	for (int i = 0; i < latencyHistogramCount; i++) {
+		if (latencyHistograms[i].callback == callback) {
+			hsLog2Add(&latencyHistograms[i].histogram, (uint32_t) NT2US(latencyNt));
+			return;
+		}
+	}
+	if (latencyHistogramCount == LATENCY_HISTOGRAM_COUNT) {
+		// out of slots, account against the last histogram so the data is not lost entirely
+		hsLog2Add(&latencyHistograms[LATENCY_HISTOGRAM_COUNT - 1].histogram, (uint32_t) NT2US(latencyNt));
+		return;
+	}
+	callback_latency_s *entry = &latencyHistograms[latencyHistogramCount++];
+	entry->callback = callback;
+	initLog2Histogram(&entry->histogram, "sched latency");
+	hsLog2Add(&entry->histogram, (uint32_t) NT2US(latencyNt));
+}
+
+static void printSchedulingLatency(void) {
+	for (int i = 0; i < latencyHistogramCount; i++) {
+		scheduleMsg(&histogramLogger, "scheduler latency in uS for callback@%x:", (int)(uintptr_t)latencyHistograms[i].callback);
+		printLog2Histogram(&histogramLogger, &latencyHistograms[i].histogram);
+	}
+}
+
+void initEventQueueMetrics(void) {
+	addConsoleAction("schedlatency", printSchedulingLatency);
+}
+#endif /* EFI_HISTOGRAMS && EFI_PROD_CODE */
+
 EventQueue::EventQueue() {
+#if EFI_EVENT_QUEUE_HEAP
+	heapSize = 0;
+#else
 	head = nullptr;
+#endif /* EFI_EVENT_QUEUE_HEAP */
+	shedCounter = 0;
 	setLateDelay(100);
 }
 
+#if EFI_EVENT_QUEUE_HEAP
+
+void EventQueue::siftUp(int index) {
+	while (index > 0) {
+		int parent = (index - 1) / 2;
+		if (heap[parent]->momentX <= heap[index]->momentX)
+			break;
+		scheduling_s *tmp = heap[parent];
+		heap[parent] = heap[index];
+		heap[index] = tmp;
+		index = parent;
+	}
+}
+
+void EventQueue::siftDown(int index) {
+	while (true) {
+		int smallest = index;
+		int left = 2 * index + 1;
+		int right = left + 1;
+		if (left < heapSize && heap[left]->momentX < heap[smallest]->momentX)
+			smallest = left;
+		if (right < heapSize && heap[right]->momentX < heap[smallest]->momentX)
+			smallest = right;
+		if (smallest == index)
+			break;
+		scheduling_s *tmp = heap[smallest];
+		heap[smallest] = heap[index];
+		heap[index] = tmp;
+		index = smallest;
+	}
+}
+
+/**
+ * @return true if the new event is the soonest one, i.e. hardware timer has to be re-armed
+ */
+bool EventQueue::insertTask(scheduling_s *scheduling, efitime_t timeX, action_s action) {
+	ScopePerf perf(PE::EventQueueInsertTask);
+
+	efiAssert(CUSTOM_ERR_ASSERT, action.getCallback() != NULL, "NULL callback", false);
+
+	if (scheduling->isScheduled) {
+		// see the sorted linked list implementation for a use-case discussion
+		return false;
+	}
+
+	if (heapSize >= EVENT_QUEUE_MAX_SIZE) {
+		firmwareError(CUSTOM_EVENT_QUEUE_FULL, "event queue overflow");
+		return false;
+	}
+
+	scheduling->momentX = timeX;
+	scheduling->action = action;
+	scheduling->isScheduled = true;
+
+	heap[heapSize] = scheduling;
+	siftUp(heapSize++);
+	return heap[0] == scheduling;
+}
+
+#else /* EFI_EVENT_QUEUE_HEAP */
+
 bool EventQueue::checkIfPending(scheduling_s *scheduling) {
 	assertNotInListMethodBody(scheduling_s, head, scheduling, nextScheduling_s);
 }
@@ -83,6 +204,8 @@ bool EventQueue::insertTask(scheduling_s *scheduling, efitime_t timeX, action_s
 	}
 }
 
+#endif /* EFI_EVENT_QUEUE_HEAP */
+
 /**
  * On this layer it does not matter which units are used - us, ms ot nt.
  *
@@ -90,7 +213,18 @@ bool EventQueue::insertTask(scheduling_s *scheduling, efitime_t timeX, action_s
  * @return Get the timestamp of the soonest pending action, skipping all the actions in the past
  */
 efitime_t EventQueue::getNextEventTime(efitime_t nowX) const {
-	
+#if EFI_EVENT_QUEUE_HEAP
+	if (heapSize > 0) {
+		if (heap[0]->momentX <= nowX) {
+			// action timestamp is in the past, see the comment on the linked list branch below
+			efitime_t aBitInTheFuture = nowX + lateDelay;
+			return aBitInTheFuture;
+		} else {
+			return heap[0]->momentX;
+		}
+	}
+	return EMPTY_QUEUE;
+#else
 	if (head != NULL) {
 		if (head->momentX <= nowX) {
 			/**
@@ -106,6 +240,7 @@ efitime_t EventQueue::getNextEventTime(efitime_t nowX) const {
 		}
 	}
 	return EMPTY_QUEUE;
+#endif /* EFI_EVENT_QUEUE_HEAP */
 }
 
 static scheduling_s * longScheduling;
@@ -119,16 +254,42 @@ static uint32_t lastEventCallbackDuration;
  * Invoke all pending actions prior to specified timestamp
  * @return number of executed actions
  */
+ITCM_CODE
 int EventQueue::executeAll(efitime_t now) {
 	ScopePerf perf(PE::EventQueueExecuteAll);
 
 	int executionCounter = 0;
+	scheduling_s *deferredHead = nullptr;
+	scheduling_s *deferredTail = nullptr;
 
 #if EFI_UNIT_TEST
 	assertListIsSorted();
 #endif
 
 	while (true) {
+#if EFI_EVENT_QUEUE_HEAP
+		// Queue is empty - bail
+		if (heapSize == 0) {
+			break;
+		}
+
+		// Only execute events that occured in the past.
+		// The soonest event is always at the top of the heap, so as soon
+		// as we see an event in the future, we're done.
+		scheduling_s* current = heap[0];
+		if (current->momentX > now) {
+			break;
+		}
+
+		executionCounter++;
+
+		// pop the top of the heap, clear scheduled flag
+		heap[0] = heap[--heapSize];
+		if (heapSize > 0) {
+			siftDown(0);
+		}
+		current->isScheduled = false;
+#else
 		// Read the head every time - a previously executed event could
 		// have inserted something new at the head
 		scheduling_s* current = head;
@@ -151,14 +312,49 @@ int EventQueue::executeAll(efitime_t now) {
 		head = current->nextScheduling_s;
 		current->nextScheduling_s = nullptr;
 		current->isScheduled = false;
+#endif /* EFI_EVENT_QUEUE_HEAP */
 
 #if EFI_UNIT_TEST
 		printf("QUEUE: execute current=%d param=%d\r\n", (long)current, (long)current->action.getArgument());
 #endif
 
+#if EFI_HISTOGRAMS && EFI_PROD_CODE
+		recordSchedulingLatency(current->action.getCallback(), now - current->momentX);
+#endif /* EFI_HISTOGRAMS && EFI_PROD_CODE */
+
+		/**
+		 * Overload shedding: when we have fallen behind and more than one event is overdue,
+		 * the lower classes are displaced behind the higher classes so that for example a
+		 * tachometer pulse never delays a coil discharge, see schedule_priority_e.
+		 * Displaced events still execute within this same pass - every low-priority
+		 * consumer in this code base re-schedules itself from its own callback, so an
+		 * outright drop would permanently stop that chain.
+		 */
+		if (current->action.getPriority() >= SCHEDULE_PRIORITY_PWM) {
+			scheduling_s *next =
+#if EFI_EVENT_QUEUE_HEAP
+					heapSize > 0 ? heap[0] : nullptr;
+#else
+					head;
+#endif /* EFI_EVENT_QUEUE_HEAP */
+			if (next != nullptr && next->momentX <= now && next->action.getPriority() < current->action.getPriority()) {
+				shedCounter++;
+				// displaced events are chained through nextScheduling_s, they are unlinked already
+				if (deferredTail == nullptr) {
+					deferredHead = deferredTail = current;
+				} else {
+					deferredTail->nextScheduling_s = current;
+					deferredTail = current;
+				}
+				continue;
+			}
+		}
+
 		// Execute the current element
 		{
 			ScopePerf perf2(PE::EventQueueExecuteCallback);
+			// edges recorded within this action carry its scheduling skew
+			flightRecorderOnSchedulingExecute(NT2US((int32_t)(now - current->momentX)));
 			current->action.execute();
 		}
 
@@ -168,22 +364,44 @@ int EventQueue::executeAll(efitime_t now) {
 #endif
 	}
 
+	// execute displaced low-priority events, preserving their original order
+	while (deferredHead != nullptr) {
+		scheduling_s *current = deferredHead;
+		deferredHead = current->nextScheduling_s;
+		current->nextScheduling_s = nullptr;
+
+		ScopePerf perf2(PE::EventQueueExecuteCallback);
+		flightRecorderOnSchedulingExecute(NT2US((int32_t)(now - current->momentX)));
+		current->action.execute();
+	}
+
 	return executionCounter;
 }
 
 int EventQueue::size(void) const {
+#if EFI_EVENT_QUEUE_HEAP
+	return heapSize;
+#else
 	scheduling_s *tmp;
 	int result;
 	LL_COUNT2(head, tmp, result, nextScheduling_s);
 	return result;
+#endif /* EFI_EVENT_QUEUE_HEAP */
 }
 
 void EventQueue::assertListIsSorted() const {
+#if EFI_EVENT_QUEUE_HEAP
+	// the heap is not fully sorted, we can only check the parent/child invariant
+	for (int index = 1; index < heapSize; index++) {
+		efiAssertVoid(CUSTOM_ERR_6623, heap[(index - 1) / 2]->momentX <= heap[index]->momentX, "heap order");
+	}
+#else
 	scheduling_s *current = head;
 	while (current != NULL && current->nextScheduling_s != NULL) {
 		efiAssertVoid(CUSTOM_ERR_6623, current->momentX <= current->nextScheduling_s->momentX, "list order");
 		current = current->nextScheduling_s;
 	}
+#endif /* EFI_EVENT_QUEUE_HEAP */
 }
 
 void EventQueue::setLateDelay(int value) {
@@ -191,11 +409,20 @@ void EventQueue::setLateDelay(int value) {
 }
 
 scheduling_s * EventQueue::getHead() {
+#if EFI_EVENT_QUEUE_HEAP
+	return heapSize > 0 ? heap[0] : nullptr;
+#else
 	return head;
+#endif /* EFI_EVENT_QUEUE_HEAP */
 }
 
 // todo: reduce code duplication with another 'getElementAtIndexForUnitText'
 scheduling_s *EventQueue::getElementAtIndexForUnitText(int index) {
+#if EFI_EVENT_QUEUE_HEAP
+	// warning: heap array order is not execution order, this is only suitable for dumping state
+	if (index >= 0 && index < heapSize)
+		return heap[index];
+#else
 	scheduling_s * current;
 
 	LL_FOREACH2(head, current, nextScheduling_s)
@@ -204,6 +431,7 @@ scheduling_s *EventQueue::getElementAtIndexForUnitText(int index) {
 			return current;
 		index--;
 	}
+#endif /* EFI_EVENT_QUEUE_HEAP */
 #if EFI_UNIT_TEST
 	firmwareError(OBD_PCM_Processor_Fault, "getForUnitText: null");
 #endif /* EFI_UNIT_TEST */
@@ -211,5 +439,9 @@ scheduling_s *EventQueue::getElementAtIndexForUnitText(int index) {
 }
 
 void EventQueue::clear(void) {
+#if EFI_EVENT_QUEUE_HEAP
+	heapSize = 0;
+#else
 	head = nullptr;
+#endif /* EFI_EVENT_QUEUE_HEAP */
 }
@@ -10,6 +10,23 @@
 
 #pragma once
 
+/**
+ * With EFI_EVENT_QUEUE_HEAP the backing store is a binary min-heap over intrusive scheduling_s
+ * pointers: insertion and pop are O(log n) instead of O(n) linked list traversal. At high event
+ * counts (12 cylinder, high RPM) linear insertion cost inside the scheduler ISR becomes measurable.
+ */
+#ifndef EFI_EVENT_QUEUE_HEAP
+#define EFI_EVENT_QUEUE_HEAP FALSE
+#endif
+
+#if EFI_EVENT_QUEUE_HEAP
+/**
+ * worst case is one injection, one spark and a couple of auxiliary events per cylinder
+ * todo: reduce code duplication with MAX_WIRES_COUNT?
+ */
+#define EVENT_QUEUE_MAX_SIZE 64
+#endif /* EFI_EVENT_QUEUE_HEAP */
+
 /**
  * this is a large value which is expected to be larger than any real time
  */
@@ -41,7 +58,7 @@
 
 
 /**
- * Execution sorted linked list
+ * Execution sorted linked list, or a binary min-heap with EFI_EVENT_QUEUE_HEAP
  */
 class EventQueue {
 public:
@@ -49,11 +66,18 @@ public:
 
 	/**
 	 * O(size) - linear search in sorted linked list
+	 * O(log size) with EFI_EVENT_QUEUE_HEAP
 	 */
 	bool insertTask(scheduling_s *scheduling, efitime_t timeX, action_s action);
 
 	int executeAll(efitime_t now);
 
+	/**
+	 * how many times an overdue low-priority event was displaced behind an overdue
+	 * higher-priority one, see schedule_priority_e
+	 */
+	int shedCounter;
+
 	efitime_t getNextEventTime(efitime_t nowUs) const;
 	void clear(void);
 	int size(void) const;
@@ -62,11 +86,29 @@ public:
 	scheduling_s * getHead();
 	void assertListIsSorted() const;
 private:
+#if EFI_EVENT_QUEUE_HEAP
+	void siftUp(int index);
+	void siftDown(int index);
+	/**
+	 * classic array-backed binary min-heap ordered by momentX, soonest event at index zero
+	 */
+	scheduling_s *heap[EVENT_QUEUE_MAX_SIZE];
+	int heapSize;
+#else
 	bool checkIfPending(scheduling_s *scheduling);
 	/**
 	 * this list is sorted
 	 */
 	scheduling_s *head;
+#endif /* EFI_EVENT_QUEUE_HEAP */
 	efitime_t lateDelay;
 };
 
+#if EFI_HISTOGRAMS && EFI_PROD_CODE
+/**
+ * registers the 'schedlatency' console command which dumps per-callback scheduling
+ * latency histograms, see executeAll()
+ */
+void initEventQueueMetrics(void);
+#endif /* EFI_HISTOGRAMS && EFI_PROD_CODE */
+
@@ -33,6 +33,17 @@ SimplePwm::SimplePwm(const char *name) : SimplePwm()  {
 	this->name = name;
 }
 
+SynchronizedPwm::SynchronizedPwm() {
+	for (int channelIndex = 0; channelIndex < PWM_PHASE_MAX_WAVE_PER_PWM; channelIndex++) {
+		sr[channelIndex].init(pinStates[channelIndex]);
+	}
+	init(_switchTimes, sr);
+}
+
+SynchronizedPwm::SynchronizedPwm(const char *name) : SynchronizedPwm() {
+	this->name = name;
+}
+
 PwmConfig::PwmConfig() {
 	memset((void*)&scheduling, 0, sizeof(scheduling));
 	memset((void*)&safe, 0, sizeof(safe));
@@ -66,6 +77,13 @@ void SimplePwm::setSimplePwmDutyCycle(float dutyCycle) {
 		// we are here in order to not change pin once PWM stop was requested
 		return;
 	}
+#if EFI_PROD_CODE && EFI_HARDWARE_PWM
+	if (hardPwm != nullptr) {
+		// a timer channel owns this pin, only the compare register needs an update
+		hardPwm->setDuty(dutyCycle);
+		return;
+	}
+#endif /* EFI_PROD_CODE && EFI_HARDWARE_PWM */
 	if (cisnan(dutyCycle)) {
 		warning(CUSTOM_DUTY_INVALID, "spwd:dutyCycle %.2f", dutyCycle);
 		return;
@@ -246,6 +264,7 @@ efitick_t PwmConfig::togglePwmState() {
  *
  * First invocation happens on application thread
  */
+ITCM_CODE
 static void timerCallback(PwmConfig *state) {
 	ScopePerf perf(PE::PwmGeneratorCallback);
 
@@ -262,7 +281,7 @@ static void timerCallback(PwmConfig *state) {
 		return;
 	}
 
-	state->executor->scheduleByTimestampNt(&state->scheduling, switchTimeNt, { timerCallback, state });
+	state->executor->scheduleByTimestampNt(&state->scheduling, switchTimeNt, { timerCallback, state, SCHEDULE_PRIORITY_PWM });
 	state->dbgNestingLevel--;
 }
 
@@ -349,6 +368,99 @@ void startSimplePwm(SimplePwm *state, const char *msg, ExecutorInterface *execut
 	state->weComplexInit(msg, executor, 2, switchTimes, 1, pinStates, NULL, stateChangeCallback);
 }
 
+/**
+ * wraps a phase value into the [0, 1) period fraction range
+ */
+static float wrapPeriodFraction(float value) {
+	while (value >= 1) {
+		value -= 1;
+	}
+	while (value < 0) {
+		value += 1;
+	}
+	return value;
+}
+
+static bool isChannelHighAt(float time, float onTime, float duty) {
+	if (duty > FULL_PWM_THRESHOLD) {
+		return true;
+	}
+	if (duty < ZERO_PWM_THRESHOLD) {
+		return false;
+	}
+	float offTime = wrapPeriodFraction(onTime + duty);
+	if (onTime < offTime) {
+		return time >= onTime && time < offTime;
+	}
+	// the high interval wraps around the cycle boundary
+	return time >= onTime || time < offTime;
+}
+
+void startSynchronizedPwm(SynchronizedPwm *state, const char *msg, ExecutorInterface *executor,
+		int channelCount, OutputPin **outputs, float frequency,
+		const float *dutyCycles, const float *phaseOffsets,
+		pwm_gen_callback *stateChangeCallback) {
+	efiAssertVoid(CUSTOM_ERR_PWM_STATE_ASSERT, state != NULL, "state");
+	efiAssertVoid(CUSTOM_ERR_PWM_CALLBACK_ASSERT, stateChangeCallback != NULL, "listener");
+	efiAssertVoid(CUSTOM_ERR_6583, channelCount > 0 && channelCount <= PWM_PHASE_MAX_WAVE_PER_PWM, "channelCount");
+	if (frequency < 1) {
+		warning(CUSTOM_OBD_LOW_FREQUENCY, "low frequency %.2f", frequency);
+		return;
+	}
+
+	/**
+	 * Collect each channel's rise and fall point plus the shared cycle boundary into one
+	 * sorted switch time axis. Channels pinned at 0% or 100% contribute no switch points.
+	 */
+	float switchTimes[2 * PWM_PHASE_MAX_WAVE_PER_PWM + 1];
+	int phaseCount = 0;
+	switchTimes[phaseCount++] = 1;
+	for (int channelIndex = 0; channelIndex < channelCount; channelIndex++) {
+		float duty = maxF(0, minF(dutyCycles[channelIndex], 1));
+		if (duty < ZERO_PWM_THRESHOLD || duty > FULL_PWM_THRESHOLD) {
+			continue;
+		}
+		float onTime = wrapPeriodFraction(phaseOffsets[channelIndex]);
+		float candidates[2] = { onTime, wrapPeriodFraction(onTime + duty) };
+		for (int k = 0; k < 2; k++) {
+			float candidate = candidates[k];
+			if (candidate <= 0) {
+				continue; // the cycle boundary is in the list already
+			}
+			int position = 0;
+			while (switchTimes[position] < candidate - 0.0001f) {
+				position++;
+			}
+			if (absF(switchTimes[position] - candidate) < 0.0001f) {
+				continue; // two channels switch at the same point in the period
+			}
+			for (int m = phaseCount; m > position; m--) {
+				switchTimes[m] = switchTimes[m - 1];
+			}
+			switchTimes[position] = candidate;
+			phaseCount++;
+		}
+	}
+
+	pin_state_t *pinStates[PWM_PHASE_MAX_WAVE_PER_PWM];
+	for (int channelIndex = 0; channelIndex < channelCount; channelIndex++) {
+		pinStates[channelIndex] = state->pinStates[channelIndex];
+		state->outputPins[channelIndex] = outputs[channelIndex];
+		float duty = maxF(0, minF(dutyCycles[channelIndex], 1));
+		float onTime = wrapPeriodFraction(phaseOffsets[channelIndex]);
+		for (int phaseIndex = 0; phaseIndex < phaseCount; phaseIndex++) {
+			// the state at the last index is the one applied at cycle start, see togglePwmState()
+			float intervalStart = phaseIndex == phaseCount - 1 ? 0 : switchTimes[phaseIndex];
+			float intervalEnd = phaseIndex == phaseCount - 1 ? switchTimes[0] : switchTimes[phaseIndex + 1];
+			bool isHigh = isChannelHighAt((intervalStart + intervalEnd) / 2, onTime, duty);
+			state->pinStates[channelIndex][phaseIndex] = isHigh ? TV_RISE : TV_FALL;
+		}
+	}
+
+	state->setFrequency(frequency);
+	state->weComplexInit(msg, executor, phaseCount, switchTimes, channelCount, pinStates, NULL, stateChangeCallback);
+}
+
 void startSimplePwmExt(SimplePwm *state, const char *msg,
 		ExecutorInterface *executor,
 		brain_pin_e brainPin, OutputPin *output, float frequency,
@@ -356,6 +468,14 @@ void startSimplePwmExt(SimplePwm *state, const char *msg,
 
 	output->initPin(msg, brainPin);
 
+#if EFI_PROD_CODE && EFI_HARDWARE_PWM
+	state->hardPwm = tryInitHardwarePwm(msg, brainPin, frequency, dutyCycle);
+	if (state->hardPwm != nullptr) {
+		// the timer peripheral generates the waveform, no scheduler events needed
+		return;
+	}
+#endif /* EFI_PROD_CODE && EFI_HARDWARE_PWM */
+
 	startSimplePwm(state, msg, executor, output, frequency, dutyCycle, stateChangeCallback);
 }
 
@@ -364,6 +484,7 @@ void startSimplePwmExt(SimplePwm *state, const char *msg,
  *
  * This method takes ~350 ticks.
  */
+ITCM_CODE
 void applyPinState(int stateIndex, PwmConfig *state) /* pwm_gen_callback */ {
 	efiAssertVoid(CUSTOM_ERR_6663, stateIndex < PWM_PHASE_MAX_COUNT, "invalid stateIndex");
 	efiAssertVoid(CUSTOM_ERR_6664, state->multiChannelStateSequence.waveCount <= PWM_PHASE_MAX_WAVE_PER_PWM, "invalid waveCount");
@@ -11,6 +11,7 @@
 #include "global.h"
 #include "scheduler.h"
 #include "efi_gpio.h"
+#include "hardware_pwm.h"
 
 #define PERCENT_TO_DUTY(x) (x) * 0.01
 
@@ -118,6 +119,13 @@ public:
 	SimplePwm();
 	explicit SimplePwm(const char *name);
 	void setSimplePwmDutyCycle(float dutyCycle);
+#if EFI_PROD_CODE && EFI_HARDWARE_PWM
+	/**
+	 * set if this pin was claimed by a hardware timer channel, in which case there is no
+	 * software scheduling for this instance at all. See startSimplePwmExt()
+	 */
+	HardwarePwm *hardPwm = nullptr;
+#endif /* EFI_PROD_CODE && EFI_HARDWARE_PWM */
 	pin_state_t pinStates[2];
 	SingleChannelStateSequence sr[1];
 	float _switchTimes[2];
@@ -125,6 +133,36 @@ private:
 	SingleChannelStateSequence waveInstance;
 };
 
+/**
+ * Phase-locked group of up to PWM_PHASE_MAX_WAVE_PER_PWM outputs sharing one period: a single
+ * scheduling event advances the shared MultiChannelStateSequence, so N synchronized channels
+ * cost exactly as much executor traffic as one and keep deterministic phase offsets between
+ * each other. See startSynchronizedPwm()
+ */
+class SynchronizedPwm : public PwmConfig {
+public:
+	SynchronizedPwm();
+	explicit SynchronizedPwm(const char *name);
+	/**
+	 * worst case each channel contributes a rise and a fall plus the shared cycle boundary
+	 */
+	pin_state_t pinStates[PWM_PHASE_MAX_WAVE_PER_PWM][2 * PWM_PHASE_MAX_WAVE_PER_PWM + 1];
+	SingleChannelStateSequence sr[PWM_PHASE_MAX_WAVE_PER_PWM];
+	float _switchTimes[2 * PWM_PHASE_MAX_WAVE_PER_PWM + 1];
+};
+
+/**
+ * Start a multi-channel phase-locked software PWM driver. All channels share 'frequency',
+ * each channel has its own duty cycle and phase offset (both as a 0..1 fraction of the period).
+ * To change duty cycles stop() and start again - runtime adjustment would require rebuilding
+ * the shared sequence under a lock and no current consumer needs that.
+ */
+void startSynchronizedPwm(SynchronizedPwm *state, const char *msg,
+		ExecutorInterface *executor,
+		int channelCount, OutputPin **outputs, float frequency,
+		const float *dutyCycles, const float *phaseOffsets,
+		pwm_gen_callback *stateChangeCallback);
+
 /**
  * Start a one-channel software PWM driver.
  *
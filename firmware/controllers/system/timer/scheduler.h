@@ -10,26 +10,41 @@
 
 typedef void (*schfunc_t)(void *);
 
+/**
+ * Overload shedding priority classes, see EventQueue::executeAll(): when the queue has
+ * fallen behind, overdue events of the lower classes are displaced behind overdue events
+ * of the higher classes so that for instance a tachometer pulse never delays a coil
+ * discharge. Lower numeric value is more important.
+ */
+typedef enum {
+	SCHEDULE_PRIORITY_IGNITION = 0,
+	SCHEDULE_PRIORITY_INJECTION = 1,
+	SCHEDULE_PRIORITY_PWM = 2,
+	SCHEDULE_PRIORITY_AUXILIARY = 3,
+} schedule_priority_e;
+
 class action_s {
 public:
 	action_s() = default;
 
 	// Allow implicit conversion from schfunc_t to action_s
 	action_s(schfunc_t callback) : action_s(callback, nullptr) { }
-	action_s(schfunc_t callback, void *param) : callback(callback), param(param) { }
+	action_s(schfunc_t callback, void *param, schedule_priority_e priority = SCHEDULE_PRIORITY_AUXILIARY) : callback(callback), param(param), priority(priority) { }
 
 	// Allow any function that takes a single pointer parameter, so long as param is also of the same pointer type.
 	// This constructor means you shouldn't ever have to cast to schfunc_t on your own.
 	template <typename TArg>
-	action_s(void (*callback)(TArg*), TArg* param) : callback((schfunc_t)callback), param(param) { }
+	action_s(void (*callback)(TArg*), TArg* param, schedule_priority_e priority = SCHEDULE_PRIORITY_AUXILIARY) : callback((schfunc_t)callback), param(param), priority(priority) { }
 
 	void execute();
 	schfunc_t getCallback() const;
 	void * getArgument() const;
+	schedule_priority_e getPriority() const;
 
 private:
 	schfunc_t callback = nullptr;
 	void *param = nullptr;
+	schedule_priority_e priority = SCHEDULE_PRIORITY_AUXILIARY;
 };
 
 /**
@@ -61,4 +76,12 @@ struct ExecutorInterface {
 	virtual void scheduleByTimestamp(scheduling_s *scheduling, efitimeus_t timeUs, action_s action) = 0;
 	virtual void scheduleByTimestampNt(scheduling_s *scheduling, efitime_t timeUs, action_s action) = 0;
 	virtual void scheduleForLater(scheduling_s *scheduling, int delayUs, action_s action) = 0;
+	/**
+	 * A group of events submitted between batchBegin() and batchEnd() is inserted under a single
+	 * lock acquisition and the hardware timer is re-armed only once at batchEnd().
+	 * Default implementation is a no-op so that executors which schedule one event at a time
+	 * keep working unchanged.
+	 */
+	virtual void batchBegin() {}
+	virtual void batchEnd() {}
 };
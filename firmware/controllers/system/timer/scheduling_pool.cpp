@@ -0,0 +1,69 @@
+/**
+ * @file	scheduling_pool.cpp
+ * @brief	Fixed-size pool of scheduling_s instances
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+#include "os_access.h"
+#include "scheduling_pool.h"
+
+static SchedulingPool instance;
+
+SchedulingPool *getSchedulingPool() {
+	return &instance;
+}
+
+SchedulingPool::SchedulingPool() {
+	usedCount = 0;
+	highWaterMark = 0;
+	// thread all instances onto the free list
+	freeListHead = &pool[0];
+	for (int i = 0; i < SCHEDULING_POOL_SIZE - 1; i++) {
+		pool[i].nextScheduling_s = &pool[i + 1];
+	}
+	pool[SCHEDULING_POOL_SIZE - 1].nextScheduling_s = nullptr;
+}
+
+scheduling_s *SchedulingPool::acquire() {
+	bool alreadyLocked = lockAnyContext();
+	scheduling_s *result = freeListHead;
+	if (result == nullptr) {
+		if (!alreadyLocked) {
+			unlockAnyContext();
+		}
+		firmwareError(CUSTOM_SCHEDULING_POOL_EXHAUSTED, "scheduling pool exhausted");
+		return nullptr;
+	}
+	freeListHead = result->nextScheduling_s;
+	result->nextScheduling_s = nullptr;
+	usedCount++;
+	if (usedCount > highWaterMark) {
+		highWaterMark = usedCount;
+	}
+	if (!alreadyLocked) {
+		unlockAnyContext();
+	}
+	return result;
+}
+
+void SchedulingPool::release(scheduling_s *scheduling) {
+	efiAssertVoid(CUSTOM_ERR_ASSERT, scheduling >= &pool[0] && scheduling < &pool[SCHEDULING_POOL_SIZE], "not a pool instance");
+	bool alreadyLocked = lockAnyContext();
+	scheduling->nextScheduling_s = freeListHead;
+	freeListHead = scheduling;
+	usedCount--;
+	if (!alreadyLocked) {
+		unlockAnyContext();
+	}
+}
+
+int SchedulingPool::getUsedCount() const {
+	return usedCount;
+}
+
+int SchedulingPool::getHighWaterMark() const {
+	return highWaterMark;
+}
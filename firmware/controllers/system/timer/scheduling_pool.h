@@ -0,0 +1,49 @@
+/**
+ * @file	scheduling_pool.h
+ * @brief	Fixed-size pool of scheduling_s instances
+ *
+ * Most scheduling_s objects are embedded into their owner structures, but auxiliary
+ * consumers (tachometer, aux valves, FSIO-driven outputs) used to carve out their own
+ * static instances. This pool gives such consumers O(1) acquire/release from one
+ * statically allocated arena with a high water mark counter, so adding another
+ * scheduled output does not require a manual memory audit. No heap, ever.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "scheduler.h"
+
+#ifndef SCHEDULING_POOL_SIZE
+#define SCHEDULING_POOL_SIZE 32
+#endif
+
+class SchedulingPool {
+public:
+	SchedulingPool();
+	/**
+	 * @return a free scheduling_s instance, or NULL once the pool is exhausted.
+	 * Exhaustion also raises a firmwareError since it means someone is leaking.
+	 */
+	scheduling_s *acquire();
+	/**
+	 * Returns an instance previously handed out by acquire(). The caller is responsible
+	 * for making sure the event is no longer pending in any executor queue.
+	 */
+	void release(scheduling_s *scheduling);
+	int getUsedCount() const;
+	int getHighWaterMark() const;
+private:
+	/**
+	 * the free list is threaded through the nextScheduling_s field which is only
+	 * used by the executor queue while an event is pending, i.e. never while free
+	 */
+	scheduling_s *freeListHead;
+	int usedCount;
+	int highWaterMark;
+	scheduling_s pool[SCHEDULING_POOL_SIZE];
+};
+
+SchedulingPool *getSchedulingPool();
@@ -29,6 +29,8 @@
 #if EFI_SIGNAL_EXECUTOR_ONE_TIMER
 
 #include "microsecond_timer.h"
+#include "scheduling_pool.h"
+#include "isr_budget.h"
 #include "tunerstudio_configuration.h"
 #include "os_util.h"
 
@@ -41,6 +43,11 @@ extern schfunc_t globalTimerCallback;
  * these fields are global in order to facilitate debugging
  */
 static efitime_t nextEventTimeNt = 0;
+/**
+ * true while the hardware timer is armed for nextEventTimeNt, cleared once it fires.
+ * Both accesses happen under the executor lock.
+ */
+static bool hwTimerArmed = false;
 
 uint32_t hwSetTimerDuration;
 uint32_t lastExecutionCount;
@@ -59,7 +66,11 @@ static void executorCallback(void *arg) {
 
 SingleTimerExecutor::SingleTimerExecutor() {
 	reentrantFlag = false;
+	batchFlag = false;
+	batchLockAlreadyLocked = false;
+	batchHeadInserted = false;
 	doExecuteCounter = scheduleCounter = timerCallbackCounter = 0;
+	timerReprogramCounter = timerCoalescedCounter = 0;
 	/**
 	 * todo: a good comment
 	 */
@@ -98,6 +109,14 @@ void SingleTimerExecutor::scheduleByTimestampNt(scheduling_s* scheduling, efitim
 #endif
 
 	scheduleCounter++;
+
+	if (batchFlag) {
+		// we are inside a batchBegin()/batchEnd() pair so the lock is already ours,
+		// execution and timer re-arm happen once in batchEnd()
+		batchHeadInserted |= queue.insertTask(scheduling, nt, action);
+		return;
+	}
+
 	bool alreadyLocked = true;
 	if (!reentrantFlag) {
 		// this would guard the queue and disable interrupts
@@ -114,9 +133,41 @@ void SingleTimerExecutor::scheduleByTimestampNt(scheduling_s* scheduling, efitim
 	}
 }
 
+void SingleTimerExecutor::batchBegin() {
+	if (batchFlag) {
+		// nested batches are not supported, the outer batch wins
+		return;
+	}
+	batchLockAlreadyLocked = lockAnyContext();
+	batchFlag = true;
+	batchHeadInserted = false;
+}
+
+void SingleTimerExecutor::batchEnd() {
+	if (!batchFlag) {
+		return;
+	}
+	batchFlag = false;
+	if (!reentrantFlag) {
+		doExecute();
+		if (batchHeadInserted) {
+			scheduleTimerCallback();
+		}
+	}
+	if (!batchLockAlreadyLocked) {
+		unlockAnyContext();
+	}
+}
+
+int SingleTimerExecutor::getShedCounter() const {
+	return queue.shedCounter;
+}
+
 void SingleTimerExecutor::onTimerCallback() {
+	IsrBudgetScope budget(&timerIsrBudget);
 	timerCallbackCounter++;
 	bool alreadyLocked = lockAnyContext();
+	hwTimerArmed = false;
 	doExecute();
 	scheduleTimerCallback();
 	if (!alreadyLocked)
@@ -169,14 +220,24 @@ void SingleTimerExecutor::scheduleTimerCallback() {
 	 * Let's grab fresh time value
 	 */
 	efitick_t nowNt = getTimeNowNt();
-	nextEventTimeNt = queue.getNextEventTime(nowNt);
-	efiAssertVoid(CUSTOM_ERR_6625, nextEventTimeNt > nowNt, "setTimer constraint");
-	if (nextEventTimeNt == EMPTY_QUEUE)
+	efitime_t headTimeNt = queue.getNextEventTime(nowNt);
+	efiAssertVoid(CUSTOM_ERR_6625, headTimeNt > nowNt, "setTimer constraint");
+	if (headTimeNt == EMPTY_QUEUE)
 		return; // no pending events in the queue
+	if (hwTimerArmed && headTimeNt <= nextEventTimeNt
+			&& nextEventTimeNt - headTimeNt <= US2NT(US_TIMER_COALESCE_US)) {
+		// the timer is already armed just a few microseconds past the new head, the pending
+		// callback would execute everything due by then anyway - not worth a reprogram
+		timerCoalescedCounter++;
+		return;
+	}
+	nextEventTimeNt = headTimeNt;
 	int32_t hwAlarmTime = NT2US((int32_t)nextEventTimeNt - (int32_t)nowNt);
 	uint32_t beforeHwSetTimer = getTimeNowLowerNt();
 	setHardwareUsTimer(hwAlarmTime == 0 ? 1 : hwAlarmTime);
 	hwSetTimerDuration = getTimeNowLowerNt() - beforeHwSetTimer;
+	hwTimerArmed = true;
+	timerReprogramCounter++;
 }
 
 void initSingleTimerExecutorHardware(void) {
@@ -190,6 +251,11 @@ void executorStatistics() {
 		tsOutputChannels.debugIntField1 = ___engine.executor.timerCallbackCounter;
 		tsOutputChannels.debugIntField2 = ___engine.executor.doExecuteCounter;
 		tsOutputChannels.debugIntField3 = ___engine.executor.scheduleCounter;
+		tsOutputChannels.debugIntField4 = ___engine.executor.timerReprogramCounter;
+		tsOutputChannels.debugIntField5 = ___engine.executor.timerCoalescedCounter;
+		tsOutputChannels.debugFloatField1 = getSchedulingPool()->getUsedCount();
+		tsOutputChannels.debugFloatField2 = getSchedulingPool()->getHighWaterMark();
+		tsOutputChannels.debugFloatField3 = ___engine.executor.getShedCounter();
 #endif /* EFI_TUNER_STUDIO */
 	}
 }
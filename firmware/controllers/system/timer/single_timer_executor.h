@@ -10,19 +10,47 @@
 #include "scheduler.h"
 #include "event_queue.h"
 
+/**
+ * If a new head-of-queue event lands within this many microseconds before the deadline the
+ * hardware timer is already armed for, we skip the reprogram and let the already-scheduled
+ * callback pick the event up: executing a handful of microseconds late is cheaper than another
+ * setHardwareUsTimer() round-trip. Zero disables coalescing.
+ */
+#ifndef US_TIMER_COALESCE_US
+#define US_TIMER_COALESCE_US 5
+#endif
+
 class SingleTimerExecutor : public ExecutorInterface {
 public:
 	SingleTimerExecutor();
 	void scheduleByTimestamp(scheduling_s *scheduling, efitimeus_t timeUs, action_s action) override;
 	void scheduleByTimestampNt(scheduling_s *scheduling, efitime_t timeNt, action_s action) override;
 	void scheduleForLater(scheduling_s *scheduling, int delayUs, action_s action) override;
+	void batchBegin() override;
+	void batchEnd() override;
 	void onTimerCallback();
+	int getShedCounter() const;
 	int timerCallbackCounter;
 	int scheduleCounter;
 	int doExecuteCounter;
+	/**
+	 * how many times we have actually reprogrammed the hardware timer
+	 */
+	int timerReprogramCounter;
+	/**
+	 * how many reprograms were skipped thanks to US_TIMER_COALESCE_US
+	 */
+	int timerCoalescedCounter;
 private:
 	EventQueue queue;
 	bool reentrantFlag;
+	/**
+	 * batchBegin() grabs the lock and sets this flag so that scheduleByTimestampNt() only
+	 * inserts into the queue, deferring execution and timer re-arm until batchEnd()
+	 */
+	bool batchFlag;
+	bool batchLockAlreadyLocked;
+	bool batchHeadInserted;
 	void doExecute();
 	void scheduleTimerCallback();
 };
@@ -0,0 +1,79 @@
+// native C++ evaluators generated automatically from controllers/system_fsio.txt
+// on 2020-06-05_09_14_52_117
+//
+// include only from fsio_impl.cpp with EFI_USE_NATIVE_SYSTEM_FSIO enabled
+//
+
+// Human-readable: (fan and (coolant > cfg_fanOffTemperature)) | (coolant > cfg_fanOnTemperature) | is_clt_broken
+static float getSystemFsioNative_FAN_CONTROL_LOGIC(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return (float2bool((float2bool((float2bool(getEngineValue(LE_METHOD_FAN PASS_ENGINE_PARAMETER_SUFFIX)) && float2bool((getEngineValue(LE_METHOD_COOLANT PASS_ENGINE_PARAMETER_SUFFIX) > getEngineValue(FSIO_SETTING_FANOFFTEMPERATURE PASS_ENGINE_PARAMETER_SUFFIX))))) || float2bool((getEngineValue(LE_METHOD_COOLANT PASS_ENGINE_PARAMETER_SUFFIX) > getEngineValue(FSIO_SETTING_FANONTEMPERATURE PASS_ENGINE_PARAMETER_SUFFIX))))) || float2bool(getEngineValue(LE_METHOD_IS_COOLANT_BROKEN PASS_ENGINE_PARAMETER_SUFFIX)));
+}
+
+// Human-readable: (time_since_boot < startup_fuel_pump_duration) | (rpm > 0)
+static float getSystemFsioNative_FUEL_PUMP_LOGIC(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return (float2bool((getEngineValue(LE_METHOD_TIME_SINCE_BOOT PASS_ENGINE_PARAMETER_SUFFIX) < getEngineValue(LE_METHOD_STARTUP_FUEL_PUMP_DURATION PASS_ENGINE_PARAMETER_SUFFIX))) || float2bool((getEngineValue(LE_METHOD_RPM PASS_ENGINE_PARAMETER_SUFFIX) > 0.0f)));
+}
+
+// Human-readable: vbatt < 14.5
+static float getSystemFsioNative_ALTERNATOR_LOGIC(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return (getEngineValue(LE_METHOD_VBATT PASS_ENGINE_PARAMETER_SUFFIX) < 14.5f);
+}
+
+// Human-readable: coolant > 120
+static float getSystemFsioNative_TOO_HOT_LOGIC(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return (getEngineValue(LE_METHOD_COOLANT PASS_ENGINE_PARAMETER_SUFFIX) > 120.0f);
+}
+
+// Human-readable: ac_on_switch & rpm > 850
+static float getSystemFsioNative_AC_RELAY_LOGIC(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return ((float2bool(getEngineValue(LE_METHOD_AC_TOGGLE PASS_ENGINE_PARAMETER_SUFFIX)) && float2bool(getEngineValue(LE_METHOD_RPM PASS_ENGINE_PARAMETER_SUFFIX))) > 850.0f);
+}
+
+// COMBINED_WARNING_LIGHT not compiled to native: unsupported token [fsio_setting]
+
+// Human-readable: (time_since_boot < 2) | (vbatt > 5) | in_shutdown
+static float getSystemFsioNative_MAIN_RELAY_LOGIC(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return (float2bool((float2bool((getEngineValue(LE_METHOD_TIME_SINCE_BOOT PASS_ENGINE_PARAMETER_SUFFIX) < 2.0f)) || float2bool((getEngineValue(LE_METHOD_VBATT PASS_ENGINE_PARAMETER_SUFFIX) > 5.0f)))) || float2bool(getEngineValue(LE_METHOD_IN_SHUTDOWN PASS_ENGINE_PARAMETER_SUFFIX)));
+}
+
+// RPM_ABOVE_USER_SETTING_1 not compiled to native: unsupported token [fsio_setting]
+
+// RPM_ABOVE_USER_SETTING_1 not compiled to native: unsupported token [fsio_setting]
+
+// RPM_ABOVE_USER_SETTING_2 not compiled to native: unsupported token [fsio_setting]
+
+// Human-readable: rpm > 5500
+static float getSystemFsioNative_RPM_ABOVE_5500_ON_OFF(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return (getEngineValue(LE_METHOD_RPM PASS_ENGINE_PARAMETER_SUFFIX) > 5500.0f);
+}
+
+// Human-readable: rpm > 6000
+static float getSystemFsioNative_RPM_ABOVE_6000_ON_OFF(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return (getEngineValue(LE_METHOD_RPM PASS_ENGINE_PARAMETER_SUFFIX) > 6000.0f);
+}
+
+// Human-readable: (rpm > 1000) * 0.7
+static float getSystemFsioNative_RPM_ABOVE_1000_SOLENOID_70_DUTY(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return ((getEngineValue(LE_METHOD_RPM PASS_ENGINE_PARAMETER_SUFFIX) > 1000.0f) * 0.7f);
+}
+
+// Human-readable: (rpm > 2000) * 0.5
+static float getSystemFsioNative_RPM_ABOVE_2000_SOLENOID_50_DUTY(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return ((getEngineValue(LE_METHOD_RPM PASS_ENGINE_PARAMETER_SUFFIX) > 2000.0f) * 0.5f);
+}
+
+// Human-readable: (rpm > 6000) * 0.8
+static float getSystemFsioNative_RPM_ABOVE_6000_SOLENOID_80_DUTY(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return ((getEngineValue(LE_METHOD_RPM PASS_ENGINE_PARAMETER_SUFFIX) > 6000.0f) * 0.8f);
+}
+
+// RPM_BELOW_USER_SETTING_1 not compiled to native: unsupported token [fsio_setting]
+
+// Human-readable: rpm < cranking_rpm
+static float getSystemFsioNative_STARTER_RELAY_LOGIC(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
+	return (getEngineValue(LE_METHOD_RPM PASS_ENGINE_PARAMETER_SUFFIX) < getEngineValue(LE_METHOD_CRANKING_RPM PASS_ENGINE_PARAMETER_SUFFIX));
+}
+
+// BOOST_CONTROLLER not compiled to native: unsupported token [fsio_table]
+
+// ANALOG_CONDITION not compiled to native: unsupported token [fsio_setting]
@@ -316,6 +316,20 @@ void TriggerWaveform::setTriggerSynchronizationGap3(int gapIndex, float syncRati
 	isSynchronizationNeeded = true;
 	this->syncronizationRatioFrom[gapIndex] = syncRatioFrom;
 	this->syncronizationRatioTo[gapIndex] = syncRatioTo;
+	// pre-calculate the number of gap ratios to check in the decoder hot path, NaN means 'do not use'
+	gapTrackingLength = 0;
+	for (int i = 0; i < GAP_TRACKING_LENGTH; i++) {
+		if (!cisnan(syncronizationRatioFrom[i])) {
+			gapTrackingLength = i + 1;
+		}
+	}
+#if EFI_FIXED_POINT_TRIGGER_MATH
+	if (!cisnan(syncRatioFrom)) {
+		// Q16.16 clamp: placeholder 'to' bound of unused gaps is huge but those are never compared
+		this->syncronizationRatioFromFixed[gapIndex] = FLOAT_TO_FIXED16(minF(syncRatioFrom, 32000));
+		this->syncronizationRatioToFixed[gapIndex] = FLOAT_TO_FIXED16(minF(syncRatioTo, 32000));
+	}
+#endif /* EFI_FIXED_POINT_TRIGGER_MATH */
 	if (gapIndex == 0) {
 		// we have a special case here - only sync with one gap has this feature
 		this->syncRatioAvg = (int)efiRound((syncRatioFrom + syncRatioTo) * 0.5f, 1.0f);
@@ -383,7 +397,7 @@ void TriggerWaveform::findTriggerPosition(event_trigger_position_s *position,
 	int triggerEventIndex = triggerIndexByAngle[(int)angle];
 	angle_t triggerEventAngle = eventAngles[triggerEventIndex];
 	if (angle < triggerEventAngle) {
-		warning(CUSTOM_OBD_ANGLE_CONSTRAINT_VIOLATION, "angle constraint violation in findTriggerPosition(): %.2f/%.2f", angle, triggerEventAngle);
+		warningDeferred(CUSTOM_OBD_ANGLE_CONSTRAINT_VIOLATION, "%sangle constraint violation in findTriggerPosition(): %.2f/%.2f", "", angle, triggerEventAngle);
 		return;
 	}
 
@@ -633,4 +647,59 @@ void TriggerWaveform::initializeTriggerWaveform(Logging *logger, operation_mode_
 		wave.checkSwitchTimes(getSize());
 	}
 
+#ifdef EFI_TRIGGER_SYNC_GAPS
+	/**
+	 * The decoder was compiled for a fixed gap tracking depth, see trigger_decoder.h - make
+	 * sure the trigger selected at runtime actually matches the board specialization.
+	 */
+	if (!shapeDefinitionError && gapTrackingLength != EFI_TRIGGER_SYNC_GAPS) {
+		firmwareError(CUSTOM_TRIGGER_SYNC_GAPS_MISMATCH, "board is compiled for %d sync gap(s), %s needs %d",
+				EFI_TRIGGER_SYNC_GAPS, getTrigger_type_e(triggerConfig->type), gapTrackingLength);
+	}
+#endif /* EFI_TRIGGER_SYNC_GAPS */
+}
+
+void TriggerWaveform::copyShapeFrom(const TriggerWaveform &src) {
+	isSynchronizationNeeded = src.isSynchronizationNeeded;
+	shapeWithoutTdc = src.shapeWithoutTdc;
+	needSecondTriggerInput = src.needSecondTriggerInput;
+	shapeDefinitionError = src.shapeDefinitionError;
+	bothFrontsRequired = src.bothFrontsRequired;
+	// staging bank version is incremented on every rebuild so this stays monotonic
+	version = src.version;
+	memcpy(expectedDutyCycle, src.expectedDutyCycle, sizeof(expectedDutyCycle));
+	memcpy(eventAngles, src.eventAngles, sizeof(eventAngles));
+	memcpy(triggerIndexByAngle, src.triggerIndexByAngle, sizeof(triggerIndexByAngle));
+	memcpy(syncronizationRatioFrom, src.syncronizationRatioFrom, sizeof(syncronizationRatioFrom));
+	memcpy(syncronizationRatioTo, src.syncronizationRatioTo, sizeof(syncronizationRatioTo));
+#if EFI_FIXED_POINT_TRIGGER_MATH
+	memcpy(syncronizationRatioFromFixed, src.syncronizationRatioFromFixed, sizeof(syncronizationRatioFromFixed));
+	memcpy(syncronizationRatioToFixed, src.syncronizationRatioToFixed, sizeof(syncronizationRatioToFixed));
+#endif /* EFI_FIXED_POINT_TRIGGER_MATH */
+	gapTrackingLength = src.gapTrackingLength;
+	syncRatioAvg = src.syncRatioAvg;
+	tdcPosition = src.tdcPosition;
+	useOnlyPrimaryForSync = src.useOnlyPrimaryForSync;
+	useRiseEdge = src.useRiseEdge;
+	gapBothDirections = src.gapBothDirections;
+	memcpy(expectedEventCount, src.expectedEventCount, sizeof(expectedEventCount));
+#if EFI_UNIT_TEST
+	memcpy(triggerSignals, src.triggerSignals, sizeof(triggerSignals));
+#endif /* EFI_UNIT_TEST */
+	memcpy(initialState, src.initialState, sizeof(initialState));
+	memcpy(isRiseEvent, src.isRiseEvent, sizeof(isRiseEvent));
+	memcpy(riseOnlyIndexes, src.riseOnlyIndexes, sizeof(riseOnlyIndexes));
+	invertOnAdd = src.invertOnAdd;
+	privateTriggerDefinitionSize = src.privateTriggerDefinitionSize;
+	useOnlyRisingEdgeForTriggerTemp = src.useOnlyRisingEdgeForTriggerTemp;
+	triggerShapeSynchPointIndex = src.triggerShapeSynchPointIndex;
+	operationMode = src.operationMode;
+	previousAngle = src.previousAngle;
+	memcpy(switchTimesBuffer, src.switchTimesBuffer, sizeof(switchTimesBuffer));
+	wave.waveCount = src.wave.waveCount;
+	for (int channelIndex = 0; channelIndex < TRIGGER_CHANNEL_COUNT; channelIndex++) {
+		// copy contents only - each bank's channels point at its own pin state storage
+		memcpy(h.channels[channelIndex].pinStates, src.h.channels[channelIndex].pinStates,
+				sizeof(pin_state_t) * PWM_PHASE_MAX_COUNT);
+	}
 }
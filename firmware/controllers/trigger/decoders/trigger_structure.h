@@ -13,6 +13,14 @@
 
 #define FOUR_STROKE_ENGINE_CYCLE 720
 
+/**
+ * With EFI_FIXED_POINT_TRIGGER_MATH the per-tooth synchronization gap check uses Q16.16
+ * integer comparisons so that the trigger ISR does not touch the FPU, see fixed16_t
+ */
+#ifndef EFI_FIXED_POINT_TRIGGER_MATH
+#define EFI_FIXED_POINT_TRIGGER_MATH FALSE
+#endif
+
 #if EFI_ENABLE_ASSERTS
 #define assertAngleRange(angle, msg, code) if (angle > 10000000 || angle < -10000000) { firmwareError(code, "angle range %s %.2f", msg, angle);angle = 0;}
 #else
@@ -77,6 +85,13 @@ public:
 	TriggerWaveform();
 	void initializeTriggerWaveform(Logging *logger, operation_mode_e ambiguousOperationMode,
 			bool useOnlyRisingEdgeForTrigger, const trigger_config_s *triggerConfig);
+	/**
+	 * Copies a complete shape from a staging instance into this live instance. Buffer contents
+	 * are copied while the internal 'wave' pointers keep referencing this instance's own storage.
+	 * This way the expensive shape rebuild runs on a staging bank with interrupts enabled and
+	 * only this quick copy happens under the lock, see Engine#initializeTriggerWaveform()
+	 */
+	void copyShapeFrom(const TriggerWaveform &src);
 	void findTriggerPosition(event_trigger_position_s *position,
 			angle_t angle DEFINE_CONFIG_PARAM(angle_t, globalTriggerAngleOffset));
 	void setShapeDefinitionError(bool value);
@@ -144,6 +159,23 @@ public:
 	float syncronizationRatioFrom[GAP_TRACKING_LENGTH];
 	float syncronizationRatioTo[GAP_TRACKING_LENGTH];
 
+#if EFI_FIXED_POINT_TRIGGER_MATH
+	/**
+	 * Q16.16 copies of the gap ratio bounds, pre-calculated so that the decoder compares
+	 * integer tooth durations without involving the FPU
+	 */
+	fixed16_t syncronizationRatioFromFixed[GAP_TRACKING_LENGTH];
+	fixed16_t syncronizationRatioToFixed[GAP_TRACKING_LENGTH];
+#endif /* EFI_FIXED_POINT_TRIGGER_MATH */
+
+	/**
+	 * Number of consecutive gap ratios which are actually defined for this trigger shape.
+	 * This value is pre-calculated when gaps are defined so that decodeTriggerEvent() can run
+	 * a tight loop over valid entries instead of testing each ratio for NaN on every tooth.
+	 * See eventAngles/triggerIndexByAngle for the other per-tooth pre-calculated tables.
+	 */
+	int gapTrackingLength = 1;
+
 
 	/**
 	 * used by NoiselessTriggerDecoder (See TriggerCentral::handleShaftSignal())
@@ -11,10 +11,10 @@
 
 #include "trigger_central.h"
 #include "trigger_decoder.h"
+#include "spsc_ring.h"
+#include "isr_budget.h"
 #include "main_trigger_callback.h"
 #include "engine_configuration.h"
-#include "listener_array.h"
-#include "data_buffer.h"
 #include "pwm_generator_logic.h"
 #include "tooth_logger.h"
 
@@ -46,7 +46,6 @@ trigger_central_s::trigger_central_s() : hwEventCounters() {
 
 TriggerCentral::TriggerCentral() : trigger_central_s() {
 
-	clearCallbacks(&triggerListeneres);
 	triggerState.resetTriggerState();
 	noiseFilter.resetAccumSignalData();
 }
@@ -67,15 +66,78 @@ EXTERN_ENGINE;
 
 static Logging *logger;
 
+void ShaftPositionListeners::registerCallback(ShaftPositionListener listener, const char *name) {
+	if (count >= MAX_SHAFT_POSITION_LISTENERS) {
+		firmwareError(CUSTOM_ERR_6606, "Too many trigger listeners, %s dropped", name);
+		return;
+	}
+	callbacks[count] = listener;
+	names[count] = name;
+	count++;
+}
+
 void TriggerCentral::addEventListener(ShaftPositionListener listener, const char *name, Engine *engine) {
 	print("registerCkpListener: %s\r\n", name);
-	triggerListeneres.registerCallback((VoidInt)(void*)listener, engine);
+	UNUSED(engine);
+	triggerListeneres.registerCallback(listener, name);
 }
 
 angle_t TriggerCentral::getVVTPosition() {
 	return vvtPosition;
 }
 
+float TriggerCentral::getVVTPhaseRate() {
+	return vvtTracker.getPhaseRate();
+}
+
+void VvtPhaseTracker::reset() {
+	cachedOneDegreeUs = NAN;
+	degreesPerNtQ32 = 0;
+	phase = 0;
+	previousPhase = 0;
+	cycle = 0;
+	edgeTimeNt = 0;
+	previousEdgeTimeNt = 0;
+}
+
+void VvtPhaseTracker::setCrankSpeed(floatus_t oneDegreeUs) {
+	if (oneDegreeUs == cachedOneDegreeUs) {
+		return;
+	}
+	cachedOneDegreeUs = oneDegreeUs;
+	// 2^32 * degrees per timer tick; the caller has rejected NaN crank speed already
+	degreesPerNtQ32 = (uint64_t)(4294967296.0 / (oneDegreeUs * US_TO_NT_MULTIPLIER));
+}
+
+int64_t VvtPhaseTracker::computePhase(efitick_t offsetNt) const {
+	// Q32 factor down to 16.16 phase: one multiply and one shift
+	return (int64_t)(((uint64_t)offsetNt * degreesPerNtQ32) >> 16);
+}
+
+void VvtPhaseTracker::recordPhase(int32_t newPhase, int32_t newCycle, efitick_t nowNt) {
+	previousPhase = phase;
+	previousEdgeTimeNt = edgeTimeNt;
+	phase = newPhase;
+	cycle = newCycle;
+	edgeTimeNt = nowNt;
+}
+
+float VvtPhaseTracker::getPhaseRate() const {
+	if (previousEdgeTimeNt == 0 || edgeTimeNt == previousEdgeTimeNt) {
+		return 0;
+	}
+	int32_t delta = phase - previousPhase;
+	// consecutive accepted edges of the same lobe are one cycle apart by construction,
+	// so actual actuator movement is whichever way around the wrap is shorter
+	if (delta > cycle / 2) {
+		delta -= cycle;
+	} else if (delta < -cycle / 2) {
+		delta += cycle;
+	}
+	float seconds = NT2US(edgeTimeNt - previousEdgeTimeNt) / US_PER_SECOND_F;
+	return delta / (float)VVT_PHASE_ONE_DEGREE / seconds;
+}
+
 /**
  * @brief Adds a trigger event listener
  *
@@ -137,11 +199,20 @@ void hwHandleVvtCamSignal(trigger_value_e front, efitick_t nowNt DECLARE_ENGINE_
 
 	efitick_t offsetNt = nowNt - tc->timeAtVirtualZeroNt;
 
-	angle_t vvtPosition = NT2US(offsetNt) / oneDegreeUs;
+	tc->vvtTracker.setCrankSpeed(oneDegreeUs);
+	int64_t phase = tc->vvtTracker.computePhase(offsetNt);
 
 	// convert engine cycle angle into trigger cycle angle
-	vvtPosition -= tdcPosition();
-	fixAngle(vvtPosition, "vvtPosition", CUSTOM_ERR_6558);
+	phase -= (int32_t)(tdcPosition() * VVT_PHASE_ONE_DEGREE);
+	int32_t cycleFixed = (int32_t)(ENGINE(engineCycle) * VVT_PHASE_ONE_DEGREE);
+	// integer wrap replaces the float fixAngle() subtraction loop
+	phase %= cycleFixed;
+	if (phase < 0) {
+		phase += cycleFixed;
+	}
+	tc->vvtTracker.recordPhase((int32_t)phase, cycleFixed, nowNt);
+
+	angle_t vvtPosition = phase * (1.0f / VVT_PHASE_ONE_DEGREE);
 
 	tc->vvtPosition = (engineConfiguration->vvtDisplayInverted ? -vvtPosition : vvtPosition) + engineConfiguration->vvtOffset;
 
@@ -193,17 +264,10 @@ uint32_t triggerMaxDuration = 0;
 static bool isInsideTriggerHandler = false;
 
 
-void hwHandleShaftSignal(trigger_event_e signal, efitick_t timestamp) {
+static void dispatchShaftSignal(trigger_event_e signal, efitick_t timestamp) {
 	ScopePerf perf(PE::HandleShaftSignal, static_cast<uint8_t>(signal));
 
-#if EFI_TOOTH_LOGGER
-	// Log to the Tunerstudio tooth logger
-	// We want to do this before anything else as we
-	// actually want to capture any noise/jitter that may be occurring
-	LogTriggerTooth(signal, timestamp);
-#endif /* EFI_TOOTH_LOGGER */
-
-	// for effective noise filtering, we need both signal edges, 
+	// for effective noise filtering, we need both signal edges,
 	// so we pass them to handleShaftSignal() and defer this test
 	if (!CONFIG(useNoiselessTriggerDecoder)) {
 		if (!isUsefulSignal(signal PASS_CONFIG_PARAMETER_SUFFIX)) {
@@ -223,10 +287,80 @@ void hwHandleShaftSignal(trigger_event_e signal, efitick_t timestamp) {
 	if (triggerDuration > triggerMaxDuration)
 		triggerMaxDuration = triggerDuration;
 }
+
+#if EFI_TRIGGER_DEFERRED_DECODE && EFI_PROD_CODE
+/**
+ * Capture ring between the trigger edge interrupt and the decode thread. In deferred mode the
+ * interrupt only stores a (signal, timestamp) pair - O(1), no decode math - so back-to-back
+ * edges on a noisy wheel cannot overrun the handler. A high priority thread drains the ring in
+ * batches and runs the normal decode pipeline using the captured timestamps, so event
+ * scheduling precision is not affected by the deferral.
+ */
+#define TRIGGER_CAPTURE_RING_SIZE 64
+
+typedef struct {
+	trigger_event_e signal;
+	efitick_t timestamp;
+} trigger_edge_capture_s;
+
+// single producer (edge interrupt) / single consumer (decode thread), see spsc_ring.h contract
+static spsc_ring<trigger_edge_capture_s, TRIGGER_CAPTURE_RING_SIZE> triggerCaptureRing;
+uint32_t triggerCaptureOverrunCounter = 0;
+
+static semaphore_t triggerDecodeSemaphore;
+static THD_WORKING_AREA(triggerDecodeThreadStack, UTILITY_THREAD_STACK_SIZE);
+
+static THD_FUNCTION(TriggerDecodeThread, arg) {
+	UNUSED(arg);
+	chRegSetThreadName("trigger decode");
+	while (true) {
+		chSemWait(&triggerDecodeSemaphore);
+		// drain everything captured so far as one batch
+		trigger_edge_capture_s edge;
+		while (triggerCaptureRing.poll(&edge)) {
+			dispatchShaftSignal(edge.signal, edge.timestamp);
+		}
+	}
+}
+
+static void startTriggerDecodeThread() {
+	chSemObjectInit(&triggerDecodeSemaphore, 0);
+	chThdCreateStatic(triggerDecodeThreadStack, sizeof(triggerDecodeThreadStack), HIGHPRIO - 1,
+			(tfunc_t)(void*) TriggerDecodeThread, NULL);
+}
+#endif /* EFI_TRIGGER_DEFERRED_DECODE && EFI_PROD_CODE */
+
+void hwHandleShaftSignal(trigger_event_e signal, efitick_t timestamp) {
+#if EFI_TOOTH_LOGGER
+	// Log to the Tunerstudio tooth logger
+	// We want to do this before anything else as we
+	// actually want to capture any noise/jitter that may be occurring
+	LogTriggerTooth(signal, timestamp);
+#endif /* EFI_TOOTH_LOGGER */
+
+#if EFI_TRIGGER_DEFERRED_DECODE && EFI_PROD_CODE
+	trigger_edge_capture_s edge = { signal, timestamp };
+	if (!triggerCaptureRing.offer(edge)) {
+		// decode thread is starved - dropping an edge loses sync either way so we only count it
+		triggerCaptureOverrunCounter++;
+		return;
+	}
+	if (isIsrContext()) {
+		chSysLockFromISR();
+		chSemSignalI(&triggerDecodeSemaphore);
+		chSysUnlockFromISR();
+	} else {
+		chSemSignal(&triggerDecodeSemaphore);
+	}
+#else
+	dispatchShaftSignal(signal, timestamp);
+#endif /* EFI_TRIGGER_DEFERRED_DECODE && EFI_PROD_CODE */
+}
 #endif /* EFI_PROD_CODE */
 
 void TriggerCentral::resetCounters() {
 	memset(hwEventCounters, 0, sizeof(hwEventCounters));
+	vvtTracker.reset();
 }
 
 static char shaft_signal_msg_index[15];
@@ -317,6 +451,7 @@ bool TriggerNoiseFilter::noiseFilter(efitick_t nowNt,
 }
 
 void TriggerCentral::handleShaftSignal(trigger_event_e signal, efitick_t timestamp DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	IsrBudgetScope budget(&triggerIsrBudget);
 	efiAssertVoid(CUSTOM_CONF_NULL, engine!=NULL, "configuration");
 
 	if (triggerShape.shapeDefinitionError) {
@@ -387,9 +522,8 @@ void TriggerCentral::handleShaftSignal(trigger_event_e signal, efitick_t timesta
 		/**
 		 * Here we invoke all the listeners - the main engine control logic is inside these listeners
 		 */
-		for (int i = 0; i < triggerListeneres.currentListenersCount; i++) {
-			ShaftPositionListener listener = (ShaftPositionListener) (void*) triggerListeneres.callbacks[i];
-			(listener)(signal, triggerIndexForListeners, timestamp PASS_ENGINE_PARAMETER_SUFFIX);
+		for (int i = 0; i < triggerListeneres.count; i++) {
+			(triggerListeneres.callbacks[i])(signal, triggerIndexForListeners, timestamp PASS_ENGINE_PARAMETER_SUFFIX);
 		}
 
 	}
@@ -570,7 +704,8 @@ void triggerInfo(void) {
 	if (HAVE_CAM_INPUT()) {
 		scheduleMsg(logger, "VVT input: %s mode %s", hwPortname(engineConfiguration->camInputs[0]),
 				getVvt_mode_e(engineConfiguration->vvtMode));
-		scheduleMsg(logger, "VVT event counters: %d/%d", engine->triggerCentral.vvtEventRiseCounter, engine->triggerCentral.vvtEventFallCounter);
+		scheduleMsg(logger, "VVT event counters: %d/%d, phase rate %.2f deg/s", engine->triggerCentral.vvtEventRiseCounter, engine->triggerCentral.vvtEventFallCounter,
+				engine->triggerCentral.getVVTPhaseRate());
 
 	}
 
@@ -708,6 +843,9 @@ void initTriggerCentral(Logging *sharedLogger) {
 	addConsoleAction("reset_trigger", resetRunningTriggerCounters);
 #endif
 
+#if EFI_TRIGGER_DEFERRED_DECODE && EFI_PROD_CODE
+	startTriggerDecodeThread();
+#endif /* EFI_TRIGGER_DEFERRED_DECODE && EFI_PROD_CODE */
 }
 
 #endif
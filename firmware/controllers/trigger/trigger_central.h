@@ -8,7 +8,6 @@
 #pragma once
 
 #include "rusefi_enums.h"
-#include "listener_array.h"
 #include "trigger_decoder.h"
 #include "trigger_central_generated.h"
 
@@ -17,6 +16,25 @@
 class Engine;
 typedef void (*ShaftPositionListener)(trigger_event_e signal, uint32_t index, efitick_t edgeTimestamp DECLARE_ENGINE_PARAMETER_SUFFIX);
 
+#define MAX_SHAFT_POSITION_LISTENERS 15
+
+/**
+ * Typed dispatch table for per-tooth callbacks, resolved once during initialization.
+ *
+ * This replaces the generic IntListenerArray here: the per-cycle hot loop now calls
+ * through correctly-typed function pointers with no void* casts and no per-listener
+ * argument array, and running out of slots is a firmwareError() at startup instead
+ * of a silently dropped listener at runtime.
+ */
+class ShaftPositionListeners {
+public:
+	void registerCallback(ShaftPositionListener listener, const char *name);
+	int count = 0;
+	ShaftPositionListener callbacks[MAX_SHAFT_POSITION_LISTENERS];
+	// names are only used for diagnostics, see 'triggerinfo' console output
+	const char *names[MAX_SHAFT_POSITION_LISTENERS];
+};
+
 #define HAVE_CAM_INPUT() engineConfiguration->camInputs[0] != GPIO_UNASSIGNED
 
 class TriggerNoiseFilter {
@@ -31,6 +49,52 @@ public:
 	efitick_t accumSignalPrevPeriods[HW_EVENT_TYPES];
 };
 
+/**
+ * 16.16 fixed-point degrees used by VvtPhaseTracker: plenty of headroom for a 720
+ * degree cycle in an int32 while quantization stays far below cam sensor jitter
+ */
+#define VVT_PHASE_ONE_DEGREE 65536
+
+/**
+ * Incremental cam phase tracker, see hwHandleVvtCamSignal().
+ *
+ * Cam edges arrive in interrupt context stacked on top of the crank trigger ISR, so the
+ * per-edge math is integer-only: crank speed is folded into a fixed-point
+ * degrees-per-timer-tick factor refreshed only when RPM actually moved, and a single
+ * 64-bit multiply turns the capture offset into a phase angle. The float conversions -
+ * display offset and the phase rate consumed by the VVT PID - happen in the slower
+ * contexts of the respective consumers.
+ */
+class VvtPhaseTracker {
+public:
+	void reset();
+	/**
+	 * refreshes the fixed-point conversion factor; a no-op while crank speed is stable,
+	 * so the division runs about once per revolution instead of once per cam edge
+	 */
+	void setCrankSpeed(floatus_t oneDegreeUs);
+	/**
+	 * @return phase in VVT_PHASE_ONE_DEGREE units, not yet wrapped to the engine cycle
+	 */
+	int64_t computePhase(efitick_t offsetNt) const;
+	void recordPhase(int32_t phase, int32_t cycle, efitick_t nowNt);
+	/**
+	 * @return measured cam movement rate in degrees per second, for VVT PID tuning and
+	 * future feed-forward. Computed on demand so no float math runs at capture time.
+	 */
+	float getPhaseRate() const;
+
+private:
+	floatus_t cachedOneDegreeUs = NAN;
+	// degrees per NT timer tick in Q32, zero while crank speed is unknown
+	uint64_t degreesPerNtQ32 = 0;
+	int32_t phase = 0;
+	int32_t previousPhase = 0;
+	int32_t cycle = 0;
+	efitick_t edgeTimeNt = 0;
+	efitick_t previousEdgeTimeNt = 0;
+};
+
 /**
  * Maybe merge TriggerCentral and TriggerState classes into one class?
  * Probably not: we have an instance of TriggerState which is used for trigger initialization,
@@ -49,6 +113,9 @@ public:
 	TriggerNoiseFilter noiseFilter;
 
 	angle_t getVVTPosition();
+	float getVVTPhaseRate();
+
+	VvtPhaseTracker vvtTracker;
 
 	angle_t vvtPosition = 0;
 	/**
@@ -62,7 +129,7 @@ public:
 	efitick_t previousVvtCamDuration = 0;
 
 private:
-	IntListenerArray<15> triggerListeneres;
+	ShaftPositionListeners triggerListeneres;
 
 };
 
@@ -39,6 +39,10 @@
 
 #if EFI_SENSOR_CHART
 #include "sensor_chart.h"
+
+#if EFI_LOGIC_ANALYZER
+#include "logic_analyzer.h"
+#endif /* EFI_LOGIC_ANALYZER */
 #endif
 
 TriggerState::TriggerState() {
@@ -58,6 +62,12 @@ void TriggerState::setShaftSynchronized(bool value) {
 	shaft_is_synchronized = value;
 }
 
+void TriggerState::restoreSynchronization(uint32_t currentIndex, uint32_t revolutionCounter) {
+	currentCycle.current_index = currentIndex;
+	totalRevolutionCounter = revolutionCounter;
+	setShaftSynchronized(true);
+}
+
 void TriggerState::resetTriggerState() {
 	setShaftSynchronized(false);
 	toothed_previous_time = 0;
@@ -87,6 +97,10 @@ void TriggerState::resetTriggerState() {
 void TriggerState::setTriggerErrorState() {
 	lastDecodingErrorTime = getTimeNowNt();
 	someSortOfTriggerError = true;
+#if EFI_LOGIC_ANALYZER
+	// a chance to freeze the edge capture ring around this fault
+	onLogicAnalyzerSyncLoss();
+#endif /* EFI_LOGIC_ANALYZER */
 }
 
 void TriggerState::resetCurrentCycleState() {
@@ -118,7 +132,7 @@ static Logging * logger = nullptr;
  * @return TRUE is something is wrong with trigger decoding
  */
 bool isTriggerDecoderError(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
-	return engine->triggerErrorDetection.sum(6) > 4;
+	return engine->triggerErrorDetection.getRunningSum() > 4;
 }
 
 void calculateTriggerSynchPoint(TriggerWaveform *shape, TriggerState *state DECLARE_ENGINE_PARAMETER_SUFFIX) {
@@ -185,8 +199,10 @@ int TriggerState::getTotalRevolutionCounter() const {
 void TriggerStateWithRunningStatistics::movePreSynchTimestamps(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	// here we take timestamps of events which happened prior to synchronization and place them
 	// at appropriate locations
-	for (int i = 0; i < spinningEventIndex;i++) {
-		timeOfLastEvent[getTriggerSize() - i] = spinningEvents[i];
+	int eventCount = minI(spinningEventIndex, PRE_SYNC_EVENTS);
+	for (int i = 0; i < eventCount;i++) {
+		// the ring buffer might have wrapped, replay retained events in chronological order
+		timeOfLastEvent[getTriggerSize() - i] = spinningEvents[(spinningEventIndex - eventCount + i) % PRE_SYNC_EVENTS];
 	}
 }
 
@@ -242,14 +258,10 @@ void TriggerStateWithRunningStatistics::setLastEventTimeForInstantRpm(efitick_t
 	if (shaft_is_synchronized) {
 		return;
 	}
-	// here we remember tooth timestamps which happen prior to synchronization
-	if (spinningEventIndex >= PRE_SYNC_EVENTS) {
-		// too many events while trying to find synchronization point
-		// todo: better implementation would be to shift here or use cyclic buffer so that we keep last
-		// 'PRE_SYNC_EVENTS' events
-		return;
-	}
-	spinningEvents[spinningEventIndex++] = nowNt;
+	// here we remember tooth timestamps which happen prior to synchronization,
+	// the ring buffer keeps the most recent 'PRE_SYNC_EVENTS' events without any allocation
+	// or shifting even if synchronization point search takes a long time
+	spinningEvents[spinningEventIndex++ % PRE_SYNC_EVENTS] = nowNt;
 }
 
 void TriggerStateWithRunningStatistics::runtimeStatistics(efitick_t nowNt DECLARE_ENGINE_PARAMETER_SUFFIX) {
@@ -381,6 +393,7 @@ void TriggerState::onShaftSynchronization(const TriggerStateCallback triggerCycl
  * @param signal type of event which just happened
  * @param nowNt current time
  */
+ITCM_CODE
 void TriggerState::decodeTriggerEvent(TriggerWaveform *triggerShape, const TriggerStateCallback triggerCycleCallback,
 		TriggerStateListener * triggerStateListener,
 		trigger_event_e const signal, efitick_t nowNt DECLARE_CONFIG_PARAMETER_SUFFIX) {
@@ -498,10 +511,17 @@ void TriggerState::decodeTriggerEvent(TriggerWaveform *triggerShape, const Trigg
 		DISPLAY(DISPLAY_FIELD(vvtEventFallCounter));
 		DISPLAY(DISPLAY_FIELD(vvtCamCounter));
 
-		if (triggerShape->isSynchronizationNeeded) {
+		if (TRIGGER_IS_SYNC_NEEDED(triggerShape)) {
 			// this is getting a little out of hand, any ideas?
 
+#if EFI_FIXED_POINT_TRIGGER_MATH
+			// only spend FPU cycles on this diagnostic ratio while someone is actually looking at it
+			if (CONFIG(debugMode) == DBG_TRIGGER_SYNC || CONFIG(verboseTriggerSynchDetails)) {
+				currentGap = 1.0 * toothDurations[0] / toothDurations[1];
+			}
+#else
 			currentGap = 1.0 * toothDurations[0] / toothDurations[1];
+#endif /* EFI_FIXED_POINT_TRIGGER_MATH */
 
 			if (CONFIG(debugMode) == DBG_TRIGGER_SYNC) {
 #if EFI_TUNER_STUDIO
@@ -511,9 +531,17 @@ void TriggerState::decodeTriggerEvent(TriggerWaveform *triggerShape, const Trigg
 			}
 
 			bool isSync = true;
-			for (int i = 0;i<GAP_TRACKING_LENGTH;i++) {
-				bool isGapCondition = cisnan(triggerShape->syncronizationRatioFrom[i]) || (toothDurations[i] > toothDurations[i + 1] * triggerShape->syncronizationRatioFrom[i]
-					&& toothDurations[i] < toothDurations[i + 1] * triggerShape->syncronizationRatioTo[i]);
+			// gapTrackingLength is pre-calculated so that we do not burn cycles on NaN checks here
+			for (int i = 0;i<TRIGGER_GAP_TRACKING_LENGTH(triggerShape);i++) {
+#if EFI_FIXED_POINT_TRIGGER_MATH
+				// Q16.16 comparison keeps the FPU out of the trigger ISR, see fixed16_t
+				uint64_t currentScaled = (uint64_t)toothDurations[i] << 16;
+				bool isGapCondition = currentScaled > (uint64_t)toothDurations[i + 1] * (uint32_t)triggerShape->syncronizationRatioFromFixed[i]
+					&& currentScaled < (uint64_t)toothDurations[i + 1] * (uint32_t)triggerShape->syncronizationRatioToFixed[i];
+#else
+				bool isGapCondition = toothDurations[i] > toothDurations[i + 1] * triggerShape->syncronizationRatioFrom[i]
+					&& toothDurations[i] < toothDurations[i + 1] * triggerShape->syncronizationRatioTo[i];
+#endif /* EFI_FIXED_POINT_TRIGGER_MATH */
 
 				isSync &= isGapCondition;
 
@@ -636,7 +664,8 @@ void TriggerState::decodeTriggerEvent(TriggerWaveform *triggerShape, const Trigg
 			;
 		}
 
-		for (int i = GAP_TRACKING_LENGTH; i > 0; i--) {
+		// shift tooth duration history, only as deep as the sync logic actually looks
+		for (int i = TRIGGER_GAP_TRACKING_LENGTH(triggerShape); i > 0; i--) {
 			toothDurations[i] = toothDurations[i - 1];
 		}
 
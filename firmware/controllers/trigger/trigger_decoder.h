@@ -14,6 +14,22 @@
 
 class TriggerState;
 
+/**
+ * Fixed-engine production builds run exactly one trigger wheel, so the generic decoder's
+ * per-edge shape lookups are pure overhead. A board may pin the synchronization gap tracking
+ * depth at compile time from its board.mk, e.g. DDEFS += -DEFI_TRIGGER_SYNC_GAPS=1 for 60-2:
+ * the sync check loop in decodeTriggerEvent() then unrolls into straight-line code with
+ * constant bounds and the isSynchronizationNeeded branch folds away. The value is validated
+ * against the trigger shape selected at runtime, see TriggerWaveform::initializeTriggerWaveform().
+ */
+#ifdef EFI_TRIGGER_SYNC_GAPS
+#define TRIGGER_GAP_TRACKING_LENGTH(triggerShape) (EFI_TRIGGER_SYNC_GAPS)
+#define TRIGGER_IS_SYNC_NEEDED(triggerShape) (EFI_TRIGGER_SYNC_GAPS > 0)
+#else
+#define TRIGGER_GAP_TRACKING_LENGTH(triggerShape) ((triggerShape)->gapTrackingLength)
+#define TRIGGER_IS_SYNC_NEEDED(triggerShape) ((triggerShape)->isSynchronizationNeeded)
+#endif /* EFI_TRIGGER_SYNC_GAPS */
+
 class TriggerStateListener {
 	public:
 		virtual void OnTriggerStateProperState(efitick_t nowNt) = 0;
@@ -111,6 +127,11 @@ public:
 
 	void resetTriggerState();
 	void setShaftSynchronized(bool value);
+	/**
+	 * warm boot support: adopt a phase preserved across a controlled reset,
+	 * see warm_boot.cpp
+	 */
+	void restoreSynchronization(uint32_t currentIndex, uint32_t revolutionCounter);
 
 	/**
 	 * this is start of real trigger cycle
@@ -147,6 +168,10 @@ public:
 	 */
 	uint32_t timeOfLastEvent[PWM_PHASE_MAX_COUNT];
 
+	/**
+	 * total count of pre-synchronization events, keeps counting past PRE_SYNC_EVENTS since
+	 * the storage below is a ring buffer which retains the most recent events
+	 */
 	int spinningEventIndex = 0;
 	// todo: change the implementation to reuse 'timeOfLastEvent'
 	uint32_t spinningEvents[PRE_SYNC_EVENTS];
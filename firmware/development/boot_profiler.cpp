@@ -0,0 +1,92 @@
+/**
+ * @file	boot_profiler.cpp
+ * @brief	Boot stage timing and staged lazy initialization
+ *
+ * Key-on-to-crankable time matters: initHardware and initEngineContoller run a long
+ * serial chain of init calls and historically everything had to finish before the
+ * trigger decoder would see the first tooth. This file provides two tools against that:
+ *
+ * 1) a per-stage boot timing table - init code calls bootProfilerMark after each
+ *    meaningful stage and the 'bootinfo' console command prints where the time went;
+ *
+ * 2) a deferred initialization registry - subsystems which are not needed for engine
+ *    start (LCD, logic analyzer, sensor chart) register a callback via bootDeferInit
+ *    and runRusEfi executes those only after trigger decoding and injection are live.
+ *
+ * @date Jun 2, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_BOOT_PROFILER
+
+#include "boot_profiler.h"
+#include "efitime.h"
+#include "cli_registry.h"
+
+static Logging logger("boot");
+
+#define BOOT_STAGE_COUNT 32
+#define DEFERRED_INIT_COUNT 8
+
+typedef struct {
+	const char *name;
+	efitimeus_t doneUs;
+} boot_stage_s;
+
+static boot_stage_s bootStages[BOOT_STAGE_COUNT];
+static int bootStageCount = 0;
+
+typedef struct {
+	const char *name;
+	Void callback;
+} deferred_init_s;
+
+static deferred_init_s deferredInits[DEFERRED_INIT_COUNT];
+static int deferredInitCount = 0;
+
+void bootProfilerMark(const char *stageName) {
+	if (bootStageCount >= BOOT_STAGE_COUNT) {
+		// silently dropping is fine here, the table is only a diagnostic
+		return;
+	}
+	bootStages[bootStageCount].name = stageName;
+	bootStages[bootStageCount].doneUs = getTimeNowUs();
+	bootStageCount++;
+}
+
+void bootDeferInit(const char *name, Void callback) {
+	if (deferredInitCount >= DEFERRED_INIT_COUNT) {
+		firmwareError(CUSTOM_ERR_ASSERT, "deferred init table full: %s", name);
+		return;
+	}
+	deferredInits[deferredInitCount].name = name;
+	deferredInits[deferredInitCount].callback = callback;
+	deferredInitCount++;
+}
+
+void runDeferredBootInit(void) {
+	for (int i = 0; i < deferredInitCount; i++) {
+		deferredInits[i].callback();
+		bootProfilerMark(deferredInits[i].name);
+	}
+}
+
+static void printBootProfile(void) {
+	efitimeus_t previousUs = 0;
+	for (int i = 0; i < bootStageCount; i++) {
+		scheduleMsg(&logger, "%2d: %5dms +%6dus %s", i,
+				(int) (bootStages[i].doneUs / 1000),
+				(int) (bootStages[i].doneUs - previousUs),
+				bootStages[i].name);
+		previousUs = bootStages[i].doneUs;
+	}
+	scheduleMsg(&logger, "%d deferred init(s) executed after crankable", deferredInitCount);
+}
+
+void initBootProfiler(void) {
+	addConsoleAction("bootinfo", printBootProfile);
+}
+
+#endif /* EFI_BOOT_PROFILER */
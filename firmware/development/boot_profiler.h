@@ -0,0 +1,42 @@
+/**
+ * @file	boot_profiler.h
+ * @brief	Boot stage timing and staged lazy initialization
+ *
+ * @date Jun 2, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+#if EFI_BOOT_PROFILER
+
+void initBootProfiler(void);
+
+/**
+ * Records completion of a named boot stage, see 'bootinfo' console command
+ */
+void bootProfilerMark(const char *stageName);
+
+/**
+ * Registers a non-critical subsystem initialization to be executed only after
+ * trigger decoding and injection are live. Callbacks run in registration order.
+ */
+void bootDeferInit(const char *name, Void callback);
+
+/**
+ * Executes all registered deferred initialization callbacks, invoked from runRusEfi
+ * once the engine is crankable
+ */
+void runDeferredBootInit(void);
+
+#else
+
+#define initBootProfiler() {}
+#define bootProfilerMark(stageName) {}
+// without the profiler there is no deferral - subsystems initialize right away
+#define bootDeferInit(name, callback) (callback)()
+#define runDeferredBootInit() {}
+
+#endif /* EFI_BOOT_PROFILER */
@@ -10,6 +10,12 @@ DEV_SRC_CPP = $(DEVELOPMENT_DIR)/trigger_emulator.cpp \
 	$(DEVELOPMENT_DIR)/engine_emulator.cpp \
 	$(DEVELOPMENT_DIR)/engine_sniffer.cpp \
 	$(DEVELOPMENT_DIR)/logic_analyzer.cpp \
+	$(DEVELOPMENT_DIR)/timing_loopback.cpp \
+	$(DEVELOPMENT_DIR)/race_detector.cpp \
+	$(DEVELOPMENT_DIR)/trigger_replay.cpp \
+	$(DEVELOPMENT_DIR)/boot_profiler.cpp \
+	$(DEVELOPMENT_DIR)/memory_report.cpp \
+	$(DEVELOPMENT_DIR)/perf_sweep.cpp \
 	$(DEVELOPMENT_DIR)/development/perf_trace.cpp
 	
 DEV_SIMULATOR_SRC_CPP = $(DEVELOPMENT_DIR)/engine_sniffer.cpp
\ No newline at end of file
@@ -54,6 +54,19 @@ extern uint32_t maxLockedDuration;
 
 static char WAVE_LOGGING_BUFFER[WAVE_LOGGING_SIZE] CCM_OPTIONAL;
 
+/**
+ * Binary records are about six times denser than the rendered text so the same
+ * RAM covers a longer capture window. Two buffers: capture continues into one
+ * while the other is rendered and drained by the console thread.
+ */
+#if EFI_PROD_CODE
+#define WAVE_CHART_SIZE 1024
+#else
+#define WAVE_CHART_SIZE 8192
+#endif
+
+static wave_chart_record_s WAVE_RECORDS[2][WAVE_CHART_SIZE] CCM_OPTIONAL;
+
 int waveChartUsedSize;
 
 //#define DEBUG_WAVE 1
@@ -62,7 +75,7 @@ int waveChartUsedSize;
 static Logging debugLogging;
 #endif /* DEBUG_WAVE */
 
-static LoggingWithStorage logger("wave info");
+static Logging logger("wave info");
 
 /**
  * We want to skip some engine cycles to skip what was scheduled before parameters were changed
@@ -90,11 +103,9 @@ void WaveChart::reset() {
 #if DEBUG_WAVE
 	scheduleSimpleMsg(&debugLogging, "reset while at ", counter);
 #endif /* DEBUG_WAVE */
-	resetLogging(&logging);
 	counter = 0;
 	startTimeNt = 0;
 	collectingData = false;
-	appendPrintf(&logging, "%s%s", PROTOCOL_ENGINE_SNIFFER, DELIMETER);
 }
 
 void WaveChart::startDataCollection() {
@@ -145,6 +156,40 @@ void WaveChart::publishIfFull() {
 }
 
 void WaveChart::publish() {
+	/**
+	 * We swap the buffers under lock so that edge events keep landing into the
+	 * other buffer, all the text rendering below happens outside of the lock
+	 */
+	bool alreadyLocked = lockOutputBuffer();
+	wave_chart_record_s *records = WAVE_RECORDS[activeBuffer];
+	uint32_t recordCounter = counter;
+	activeBuffer ^= 1;
+	counter = 0;
+	startTimeNt = 0;
+	if (!alreadyLocked) {
+		unlockOutputBuffer();
+	}
+
+#if EFI_TEXT_LOGGING
+	resetLogging(&logging);
+	appendPrintf(&logging, "%s%s", PROTOCOL_ENGINE_SNIFFER, DELIMETER);
+	for (uint32_t i = 0; i < recordCounter; i++) {
+		wave_chart_record_s *record = &records[i];
+		if (remainingSize(&logging) < 35) {
+			break;
+		}
+		/**
+		 * printf is a heavy method, append is used here as a performance optimization
+		 */
+		appendFast(&logging, record->name);
+		appendChar(&logging, CHART_DELIMETER);
+		appendFast(&logging, record->msg);
+		appendChar(&logging, CHART_DELIMETER);
+		itoa10(timeBuffer, record->time100);
+		appendFast(&logging, timeBuffer);
+		appendChar(&logging, CHART_DELIMETER);
+	}
+	logging.linePointer[0] = 0;
 	appendPrintf(&logging, DELIMETER);
 	waveChartUsedSize = loggingSize(&logging);
 #if DEBUG_WAVE
@@ -154,6 +199,7 @@ void WaveChart::publish() {
 	if (ENGINE(isEngineChartEnabled)) {
 		scheduleLogging(&logging);
 	}
+#endif /* EFI_TEXT_LOGGING */
 }
 
 /**
@@ -195,12 +241,11 @@ void WaveChart::addEvent3(const char *name, const char * msg) {
 
 	efitick_t nowNt = getTimeNowNt();
 
-	bool alreadyLocked = lockOutputBuffer(); // we have multiple threads writing to the same output buffer
+	bool alreadyLocked = lockOutputBuffer(); // we have multiple threads writing to the same capture buffer
 
 	if (counter == 0) {
 		startTimeNt = nowNt;
 	}
-	counter++;
 
 	/**
 	 * We want smaller times within a chart in order to reduce packet size.
@@ -214,20 +259,16 @@ void WaveChart::addEvent3(const char *name, const char * msg) {
 	uint32_t diffNt = nowNt - startTimeNt;
 	uint32_t time100 = NT2US(diffNt / 10);
 
-	if (remainingSize(&logging) > 35) {
+	if (counter < WAVE_CHART_SIZE) {
 		/**
-		 * printf is a heavy method, append is used here as a performance optimization
+		 * no text operations here: we only store the binary record, text is
+		 * rendered at publish() time outside of edge-event context
 		 */
-		appendFast(&logging, name);
-		appendChar(&logging, CHART_DELIMETER);
-		appendFast(&logging, msg);
-		appendChar(&logging, CHART_DELIMETER);
-//		time100 -= startTime100;
-
-		itoa10(timeBuffer, time100);
-		appendFast(&logging, timeBuffer);
-		appendChar(&logging, CHART_DELIMETER);
-		logging.linePointer[0] = 0;
+		wave_chart_record_s *record = &WAVE_RECORDS[activeBuffer][counter];
+		record->name = name;
+		record->msg = msg;
+		record->time100 = time100;
+		counter++;
 	}
 	if (!alreadyLocked) {
 		unlockOutputBuffer();
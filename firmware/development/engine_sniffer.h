@@ -14,6 +14,17 @@
 #if EFI_ENGINE_SNIFFER
 #include "datalogging.h"
 
+/**
+ * Binary capture record: edge-event context only stores these, the text
+ * protocol for the console is rendered later at publish time. The name and
+ * message pointers are stable static strings so storing the pointer is enough.
+ */
+typedef struct {
+	const char *name;
+	const char *msg;
+	uint32_t time100;
+} wave_chart_record_s;
+
 /**
  * @brief	rusEfi console sniffer data buffer
  */
@@ -33,6 +44,11 @@ public:
 private:
 	Logging logging;
 	char timeBuffer[_MAX_FILLER + 2];
+	/**
+	 * events are captured into one buffer while the other one is being
+	 * rendered into text and drained, see publish()
+	 */
+	int activeBuffer = 0;
 	uint32_t counter = 0;
 	/**
 	 * We want to avoid visual jitter thus we want the left edge to be aligned
@@ -16,7 +16,6 @@
 #include "global.h"
 #include "os_access.h"
 #include "eficonsole.h"
-#include "data_buffer.h"
 #include "pin_repository.h"
 #include "allsensors.h"
 #include "engine_configuration.h"
@@ -50,6 +49,68 @@ static WaveReader readers[MAX_ICU_COUNT];
 
 static Logging * logger;
 
+/**
+ * Deep edge ring: every input capture edge also lands here as a compact binary
+ * record so that we retain a long window at full resolution. On a trigger
+ * decoder sync-loss we keep capturing for another half ring and then freeze,
+ * which leaves the fault right in the middle of the capture - deep enough to
+ * catch intermittent cam-signal glitches at speed which the text chart misses.
+ */
+#define LA_EDGE_RING_SIZE 4096
+
+typedef struct {
+	uint8_t channel;
+	uint8_t isRise;
+	uint16_t unused;
+	uint32_t timeUs;
+} la_edge_record_s;
+
+static la_edge_record_s laEdgeRing[LA_EDGE_RING_SIZE] CCM_OPTIONAL;
+static volatile int laRingIndex = 0;
+/**
+ * -1 while armed, positive while counting down the post-fault half ring
+ */
+static volatile int laPostTriggerCountdown = -1;
+static volatile bool laRingFrozen = false;
+/**
+ * 0 - never freeze, 1 - freeze on trigger sync-loss. See 'la_set_trigger'.
+ */
+static int laTriggerMode = 1;
+
+static void laRecordEdge(int channel, bool isRise, efitimeus_t nowUs) {
+	if (laRingFrozen)
+		return;
+	/**
+	 * all ICU callbacks run at the same interrupt priority so they do not
+	 * preempt each other, plain index arithmetic is enough here
+	 */
+	int index = laRingIndex;
+	la_edge_record_s *record = &laEdgeRing[index];
+	record->channel = channel;
+	record->isRise = isRise;
+	record->timeUs = nowUs;
+	laRingIndex = (index == LA_EDGE_RING_SIZE - 1) ? 0 : index + 1;
+
+	int countdown = laPostTriggerCountdown;
+	if (countdown > 0) {
+		countdown--;
+		laPostTriggerCountdown = countdown;
+		if (countdown == 0) {
+			laRingFrozen = true;
+		}
+	}
+}
+
+/**
+ * Invoked by the trigger decoder on a synchronization error, see
+ * TriggerState::setTriggerErrorState()
+ */
+void onLogicAnalyzerSyncLoss(void) {
+	if (laTriggerMode == 0 || laRingFrozen || laPostTriggerCountdown > 0)
+		return;
+	laPostTriggerCountdown = LA_EDGE_RING_SIZE / 2;
+}
+
 static void ensureInitialized(WaveReader *reader) {
 	/*may be*/UNUSED(reader);
 	efiAssertVoid(CUSTOM_ERR_6654, reader->hw != NULL && reader->hw->started, "wave analyzer NOT INITIALIZED");
@@ -61,6 +122,7 @@ static void waAnaWidthCallback(WaveReader *reader) {
 	reader->lastActivityTimeUs = nowUs;
 	assertIsrContext(CUSTOM_ERR_6670);
 	addEngineSnifferEvent(reader->name, PROTOCOL_ES_UP);
+	laRecordEdge(reader - readers, true, nowUs);
 
 	uint32_t width = nowUs - reader->periodEventTimeUs;
 	reader->last_wave_low_widthUs = width;
@@ -75,6 +137,7 @@ void WaveReader::onFallEvent() {
 	lastActivityTimeUs = nowUs;
 	assertIsrContext(CUSTOM_ERR_6670);
 	addEngineSnifferEvent(name, PROTOCOL_ES_DOWN);
+	laRecordEdge(this - readers, false, nowUs);
 
 	efitick_t width = nowUs - widthEventTimeUs;
 	last_wave_high_widthUs = width;
@@ -116,9 +179,9 @@ static void initWave(const char *name, int index) {
 	reader->hw = startDigitalCapture("wave input", brainPin, mode);
 
 	if (reader->hw != NULL) {
-		reader->hw->setWidthCallback((VoidInt)(void*) waAnaWidthCallback, (void*) reader);
+		reader->hw->setWidthCallback((VoidPtr)(void*) waAnaWidthCallback, (void*) reader);
 
-		reader->hw->setPeriodCallback((VoidInt)(void*) waIcuPeriodCallback, (void*) reader);
+		reader->hw->setPeriodCallback((VoidPtr)(void*) waIcuPeriodCallback, (void*) reader);
 	}
 
 	print("wave%d input on %s\r\n", index, hwPortname(brainPin));
@@ -214,6 +277,35 @@ void printWave(Logging *logging) {
 
 void showWaveInfo(void) {
 	scheduleMsg(logger, "logic input #1: %d/%d", readers[0].fallEventCounter, readers[0].riseEventCounter);
+	scheduleMsg(logger, "edge ring: %s, trigger mode %d", laRingFrozen ? "FROZEN" : "armed", laTriggerMode);
+}
+
+static void setLaTriggerMode(int value) {
+	laTriggerMode = value;
+	scheduleMsg(logger, "edge ring trigger mode %d", laTriggerMode);
+}
+
+static void armEdgeRing(void) {
+	laRingFrozen = true; // stop the writers while we clear the ring
+	laPostTriggerCountdown = -1;
+	memset((void *)laEdgeRing, 0, sizeof(laEdgeRing));
+	laRingIndex = 0;
+	laRingFrozen = false;
+	scheduleMsg(logger, "edge ring armed");
+}
+
+static void dumpEdgeRing(void) {
+	/**
+	 * oldest record first: the write index points at the oldest slot once the
+	 * ring has wrapped. Unwritten slots still hold the zero timestamp.
+	 */
+	int start = laRingIndex;
+	for (int i = 0; i < LA_EDGE_RING_SIZE; i++) {
+		la_edge_record_s *record = &laEdgeRing[(start + i) % LA_EDGE_RING_SIZE];
+		if (record->timeUs == 0)
+			continue;
+		scheduleMsg(logger, "la %d %s %d", record->channel, record->isRise ? "up" : "down", record->timeUs);
+	}
 }
 
 void initWaveAnalyzer(Logging *sharedLogger) {
@@ -230,6 +322,9 @@ void initWaveAnalyzer(Logging *sharedLogger) {
 	addTriggerEventListener(waTriggerEventListener, "wave analyzer", engine);
 
 	addConsoleAction("waveinfo", showWaveInfo);
+	addConsoleActionI("la_set_trigger", setLaTriggerMode);
+	addConsoleAction("la_arm", armEdgeRing);
+	addConsoleAction("la_dump", dumpEdgeRing);
 
 }
 
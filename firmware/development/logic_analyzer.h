@@ -53,6 +53,7 @@ public:
 void initWaveAnalyzer(Logging *sharedLogger);
 void printWave(Logging *logging);
 void showWaveInfo(void);
+void onLogicAnalyzerSyncLoss(void);
 
 #endif /* EFI_LOGIC_ANALYZER */
 
@@ -0,0 +1,98 @@
+/**
+ * @file	memory_report.cpp
+ * @brief	Runtime memory usage accounting
+ *
+ * generate_memory_usage_report.bat covers the static picture offline, but at runtime
+ * we used to fly blind. The 'memoryinfo' console command walks the ChibiOS thread
+ * registry and reports per-thread stack high-water marks - with CH_DBG_FILL_THREADS
+ * the unused part of each working area still holds the fill pattern so the watermark
+ * is exact. Large static buffers announce themselves via registerStaticBuffer so the
+ * same command shows where the RAM actually went.
+ *
+ * A stack which never comes close to its watermark is a stack we can shrink, and the
+ * KBs freed that way buy bigger log buffers.
+ *
+ * @date Jun 4, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_MEMORY_REPORT && EFI_PROD_CODE
+
+#include "memory_report.h"
+#include "os_access.h"
+#include "cli_registry.h"
+#include "loggingcentral.h"
+
+static Logging logger("memory");
+
+#define STATIC_BUFFER_REGISTRY_SIZE 24
+
+typedef struct {
+	const char *name;
+	const void *addr;
+	int size;
+} static_buffer_entry_s;
+
+static static_buffer_entry_s staticBuffers[STATIC_BUFFER_REGISTRY_SIZE];
+static int staticBufferCount = 0;
+static int staticBufferOverflowCounter = 0;
+
+void registerStaticBuffer(const char *name, const void *addr, int size) {
+	if (staticBufferCount >= STATIC_BUFFER_REGISTRY_SIZE) {
+		// the registry itself is a diagnostic, no reason to firmwareError here
+		staticBufferOverflowCounter++;
+		return;
+	}
+	staticBuffers[staticBufferCount].name = name;
+	staticBuffers[staticBufferCount].addr = addr;
+	staticBuffers[staticBufferCount].size = size;
+	staticBufferCount++;
+}
+
+#if CH_CFG_USE_REGISTRY && CH_DBG_FILL_THREADS
+static void printThreadStacks(void) {
+	thread_t *tp = chRegFirstThread();
+	while (tp != NULL) {
+		// the thread structure sits at the top of its own working area
+		int total = (int) ((uintptr_t) tp - (uintptr_t) tp->wabase);
+		const uint8_t *fill = (const uint8_t *) tp->wabase;
+		int untouched = 0;
+		// 0x55 is the ChibiOS working area fill pattern
+		while (untouched < total && fill[untouched] == 0x55) {
+			untouched++;
+		}
+		const char *name = chRegGetThreadNameX(tp);
+		scheduleMsg(&logger, "stack %s: total=%d high water=%d free=%d",
+				name == NULL ? "noname" : name,
+				total, total - untouched, untouched);
+		tp = chRegNextThread(tp);
+	}
+}
+#endif /* CH_CFG_USE_REGISTRY && CH_DBG_FILL_THREADS */
+
+static void printMemoryInfo(void) {
+#if CH_CFG_USE_REGISTRY && CH_DBG_FILL_THREADS
+	printThreadStacks();
+#else
+	scheduleMsg(&logger, "thread registry or stack fill not enabled, no stack watermarks");
+#endif /* CH_CFG_USE_REGISTRY && CH_DBG_FILL_THREADS */
+	int totalBufferSize = 0;
+	for (int i = 0; i < staticBufferCount; i++) {
+		scheduleMsg(&logger, "buffer %s: %d @ %x", staticBuffers[i].name,
+				staticBuffers[i].size, (unsigned int)(uintptr_t) staticBuffers[i].addr);
+		totalBufferSize += staticBuffers[i].size;
+	}
+	scheduleMsg(&logger, "%d registered buffer(s), %d bytes total", staticBufferCount,
+			totalBufferSize);
+	if (staticBufferOverflowCounter > 0) {
+		scheduleMsg(&logger, "registry full, %d registration(s) dropped", staticBufferOverflowCounter);
+	}
+}
+
+void initMemoryReport(void) {
+	addConsoleAction("memoryinfo", printMemoryInfo);
+}
+
+#endif /* EFI_MEMORY_REPORT && EFI_PROD_CODE */
@@ -0,0 +1,27 @@
+/**
+ * @file	memory_report.h
+ * @brief	Runtime memory usage accounting
+ *
+ * @date Jun 4, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+#if EFI_MEMORY_REPORT && EFI_PROD_CODE
+
+void initMemoryReport(void);
+
+/**
+ * Adds a large static buffer to the registry printed by the 'memoryinfo' console command
+ */
+void registerStaticBuffer(const char *name, const void *addr, int size);
+
+#else
+
+#define initMemoryReport() {}
+#define registerStaticBuffer(name, addr, size) {}
+
+#endif /* EFI_MEMORY_REPORT && EFI_PROD_CODE */
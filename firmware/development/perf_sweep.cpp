@@ -0,0 +1,196 @@
+/**
+ * @file	perf_sweep.cpp
+ * @brief	self-stimulation RPM sweep as a performance acceptance test
+ *
+ * With directSelfStimulation the trigger emulator drives the complete control
+ * pipeline - decode, fuel and spark math, scheduling, actuator outputs - with no
+ * engine attached. This module grows that into an acceptance test: the virtual
+ * engine is swept across RPM bands while the ISR budget gauges and the CPU load
+ * gauge record the worst case per band, and at the end every band is judged
+ * against a fixed envelope. A firmware build is expected to pass the sweep on
+ * the bench before it ever runs a vehicle.
+ *
+ *     perf_sweep
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_EMULATE_POSITION_SENSORS && EFI_PROD_CODE
+
+#include "os_access.h"
+#include "perf_sweep.h"
+#include "engine.h"
+#include "eficonsole.h"
+#include "periodic_task.h"
+#include "isr_budget.h"
+#include "cpu_load.h"
+#include "trigger_emulator_algo.h"
+#include "trigger_central.h"
+
+EXTERN_ENGINE;
+
+static Logging *logger;
+
+#define SWEEP_FROM_RPM 500
+#define SWEEP_TO_RPM 12000
+#define SWEEP_BAND_COUNT 16
+
+/**
+ * per-band dwell in 100ms controller periods: the first ticks let the virtual
+ * engine and the decoder settle at the new speed, only then do we measure
+ */
+#define SWEEP_SETTLE_TICKS 5
+#define SWEEP_MEASURE_TICKS 20
+
+/**
+ * The envelope: worst figures acceptable in any band. The ISR limits are
+ * conservative fractions of the tightest tooth period at SWEEP_TO_RPM, the CPU
+ * limit leaves headroom for the communication load of a real install.
+ */
+#define SWEEP_TRIGGER_ISR_LIMIT_US 40
+#define SWEEP_TIMER_ISR_LIMIT_US 100
+#define SWEEP_CPU_LIMIT_PERCENT 90
+
+typedef struct {
+	int rpm;
+	uint32_t maxTriggerIsrNt;
+	uint32_t maxTimerIsrNt;
+	float cpuPercent;
+} band_result_s;
+
+typedef enum {
+	SWEEP_IDLE = 0,
+	SWEEP_SETTLING,
+	SWEEP_MEASURING,
+} sweep_phase_e;
+
+static volatile sweep_phase_e sweepPhase = SWEEP_IDLE;
+static int currentBand = 0;
+static int phaseTicks = 0;
+static band_result_s results[SWEEP_BAND_COUNT];
+
+static bool savedSelfStimulation = false;
+static int savedSimulatorFrequency = 0;
+
+static int getBandRpm(int band) {
+	return SWEEP_FROM_RPM + (SWEEP_TO_RPM - SWEEP_FROM_RPM) * band / (SWEEP_BAND_COUNT - 1);
+}
+
+static bool isBandWithinEnvelope(const band_result_s *result) {
+	return NT2US(result->maxTriggerIsrNt) <= SWEEP_TRIGGER_ISR_LIMIT_US
+			&& NT2US(result->maxTimerIsrNt) <= SWEEP_TIMER_ISR_LIMIT_US
+			&& result->cpuPercent <= SWEEP_CPU_LIMIT_PERCENT;
+}
+
+static void reportSweep(void) {
+	bool allPassed = true;
+	for (int band = 0; band < SWEEP_BAND_COUNT; band++) {
+		const band_result_s *result = &results[band];
+		bool passed = isBandWithinEnvelope(result);
+		allPassed &= passed;
+		scheduleMsg(logger, "perf_sweep %5d RPM: trigger=%dus timer=%dus cpu=%.1f%% %s",
+				result->rpm,
+				(int)NT2US(result->maxTriggerIsrNt),
+				(int)NT2US(result->maxTimerIsrNt),
+				result->cpuPercent,
+				passed ? "ok" : "FAIL");
+	}
+	scheduleMsg(logger, "perf_sweep envelope: trigger<=%dus timer<=%dus cpu<=%d%%: %s",
+			SWEEP_TRIGGER_ISR_LIMIT_US, SWEEP_TIMER_ISR_LIMIT_US, SWEEP_CPU_LIMIT_PERCENT,
+			allPassed ? "PASS" : "FAIL");
+}
+
+static void startBand(int band) {
+	setTriggerEmulatorRPM(getBandRpm(band));
+	sweepPhase = SWEEP_SETTLING;
+	phaseTicks = 0;
+}
+
+static void startMeasurement(void) {
+	// the gauges are shared with normal diagnostics, a sweep band owns them here
+	triggerIsrBudget.maxDuration = 0;
+	timerIsrBudget.maxDuration = 0;
+	resetMaxValues();
+	// restart the load window so the band only sees its own activity
+	getCpuUsagePercent();
+	sweepPhase = SWEEP_MEASURING;
+	phaseTicks = 0;
+}
+
+static void finishBand(void) {
+	band_result_s *result = &results[currentBand];
+	result->rpm = getBandRpm(currentBand);
+	result->maxTriggerIsrNt = triggerIsrBudget.maxDuration;
+	result->maxTimerIsrNt = timerIsrBudget.maxDuration;
+	result->cpuPercent = getCpuUsagePercent();
+
+	currentBand++;
+	if (currentBand < SWEEP_BAND_COUNT) {
+		startBand(currentBand);
+		return;
+	}
+
+	// sweep is done: put the emulator back the way we found it
+	engineConfiguration->directSelfStimulation = savedSelfStimulation;
+	setTriggerEmulatorRPM(savedSimulatorFrequency);
+	sweepPhase = SWEEP_IDLE;
+	reportSweep();
+}
+
+class PerfSweepController : public PeriodicTimerController {
+	int getPeriodMs() override {
+		return 100;
+	}
+
+	void PeriodicTask() override {
+		switch (sweepPhase) {
+		case SWEEP_IDLE:
+			return;
+		case SWEEP_SETTLING:
+			if (++phaseTicks >= SWEEP_SETTLE_TICKS) {
+				startMeasurement();
+			}
+			return;
+		case SWEEP_MEASURING:
+			if (++phaseTicks >= SWEEP_MEASURE_TICKS) {
+				finishBand();
+			}
+			return;
+		}
+	}
+};
+
+static PerfSweepController sweepController;
+
+static void startPerfSweep(void) {
+	if (sweepPhase != SWEEP_IDLE) {
+		scheduleMsg(logger, "perf_sweep already running");
+		return;
+	}
+	if (engine->rpmCalculator.isRunning(PASS_ENGINE_PARAMETER_SIGNATURE)
+			&& !engineConfiguration->directSelfStimulation) {
+		// a real trigger is spinning, this is strictly a bench mode
+		scheduleMsg(logger, "perf_sweep refused: engine is running");
+		return;
+	}
+
+	savedSelfStimulation = engineConfiguration->directSelfStimulation;
+	savedSimulatorFrequency = engineConfiguration->triggerSimulatorFrequency;
+	engineConfiguration->directSelfStimulation = true;
+
+	scheduleMsg(logger, "perf_sweep: %d..%d RPM in %d bands", SWEEP_FROM_RPM, SWEEP_TO_RPM,
+			SWEEP_BAND_COUNT);
+	currentBand = 0;
+	startBand(currentBand);
+}
+
+void initPerfSweep(Logging *sharedLogger) {
+	logger = sharedLogger;
+	sweepController.Start();
+	addConsoleAction("perf_sweep", startPerfSweep);
+}
+
+#endif /* EFI_EMULATE_POSITION_SENSORS && EFI_PROD_CODE */
@@ -0,0 +1,13 @@
+/**
+ * @file	perf_sweep.h
+ * @brief	self-stimulation RPM sweep as a performance acceptance test
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+void initPerfSweep(Logging *sharedLogger);
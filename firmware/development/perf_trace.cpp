@@ -7,6 +7,7 @@
 
 #include "efifeatures.h"
 #include "perf_trace.h"
+#include <cstring>
 #include "efitime.h"
 #include "os_util.h"
 
@@ -35,29 +36,73 @@ struct TraceEntry
 // Ensure that the struct is the size we think it is - the binary layout is important
 static_assert(sizeof(TraceEntry) == 8);
 
-// This buffer stores a trace - we write the full buffer once, then disable tracing
-static TraceEntry s_traceBuffer[TRACE_BUFFER_LENGTH];
+/**
+ * Double-buffered continuous capture: while one half is streamed out over the
+ * TunerStudio channel the other half keeps recording, so a trace can cover a
+ * whole dyno pull instead of one buffer's worth of time. Records carry
+ * delta timestamps - the first record of each half is absolute, the rest are
+ * deltas from the previous record - which is what lets the console stitch
+ * consecutive halves into one timeline.
+ */
+#define TRACE_HALF_LENGTH (TRACE_BUFFER_LENGTH / 2)
+
+static TraceEntry s_traceBuffer[2][TRACE_HALF_LENGTH];
 static size_t s_nextIdx = 0;
+static int s_activeHalf = 0;
+/**
+ * index of the half waiting to be drained, -1 while both are in our hands
+ */
+static volatile int s_readyHalf = -1;
+static uint32_t s_lastTimestamp = 0;
+/**
+ * halves we had to overwrite because the consumer did not keep up
+ */
+static uint32_t s_overrunCounter = 0;
 
 static bool s_isTracing = false;
 
+/**
+ * always-on counters, see perf_counter_s in the header
+ */
+static perf_counter_s s_counters[(int)PE::COUNT];
+
 void perfEventImpl(PE event, EPhase phase, uint8_t data)
 {
 	// Bail if we aren't allowed to trace
 	if constexpr (!ENABLE_PERF_TRACE) {
 		return;
 	}
-	
-	// Bail if we aren't tracing
-	if (!s_isTracing) {
-		return;
-	}
 
 	// todo: why doesn't getTimeNowLowerNt() work here?
 	// It returns 0 like we're in a unit test
 	uint32_t timestamp = port_rt_get_counter_value();
 
+	/**
+	 * The counters run unconditionally, tracing or not. No lock: an interrupt
+	 * executing the same event nested inside a thread's Start/End pair would
+	 * corrupt that one sample, we accept that instead of paying for a
+	 * critical section on every instrumentation point.
+	 */
+	perf_counter_s& counter = s_counters[(int)event];
+	if (phase == EPhase::Start) {
+		counter.lastStartTimestamp = timestamp;
+	} else if (phase == EPhase::End) {
+		uint32_t cycles = timestamp - counter.lastStartTimestamp;
+		counter.count++;
+		counter.totalCycles += cycles;
+		if (cycles > counter.maxCycles) {
+			counter.maxCycles = cycles;
+		}
+	}
+
+	// Bail if we aren't tracing
+	if (!s_isTracing) {
+		return;
+	}
+
 	size_t idx;
+	int half;
+	uint32_t encodedTimestamp;
 
 	// Critical section: disable interrupts to reserve an index.
 	// We could lock, but this gets called a LOT - so locks could
@@ -68,22 +113,33 @@ void perfEventImpl(PE event, EPhase phase, uint8_t data)
 		__disable_irq();
 
 		idx = s_nextIdx++;
-		if (s_nextIdx >= TRACE_BUFFER_LENGTH) {
+		half = s_activeHalf;
+		// first record of a half is absolute, the rest are deltas
+		encodedTimestamp = (idx == 0) ? timestamp : timestamp - s_lastTimestamp;
+		s_lastTimestamp = timestamp;
+		if (s_nextIdx >= TRACE_HALF_LENGTH) {
 			s_nextIdx = 0;
-			s_isTracing = false;
+			if (s_readyHalf == -1) {
+				// hand this half over for draining, keep capturing into the other
+				s_readyHalf = half;
+				s_activeHalf ^= 1;
+			} else {
+				// consumer is behind, overwrite this half and note the loss
+				s_overrunCounter++;
+			}
 		}
 
 		__enable_irq();
 	}
 
 	// We can safely write data out of the lock, our spot is reserved
-	volatile TraceEntry& entry = s_traceBuffer[idx];
+	volatile TraceEntry& entry = s_traceBuffer[half][idx];
 
 	entry.Event = event;
 	entry.Phase = phase;
 	// Get the current active interrupt - this is the "thread ID"
 	entry.ThreadId = static_cast<uint8_t>(SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk);
-	entry.Timestamp = timestamp;
+	entry.Timestamp = encodedTimestamp;
 	entry.Data = data;
 }
 
@@ -100,12 +156,63 @@ void perfEventInstantGlobal(PE event, uint8_t data) {
 }
 
 void perfTraceEnable() {
+	s_nextIdx = 0;
+	s_readyHalf = -1;
+	s_overrunCounter = 0;
 	s_isTracing = true;
 }
 
+/**
+ * @return the filled half waiting to be streamed out, or an empty result if
+ * capture has not filled one yet. Capture continues while the caller drains;
+ * perfTraceReleaseBuffer() hands the half back once it is on the wire.
+ */
 const TraceBufferResult perfTraceGetBuffer() {
-	// stop tracing if you try to get the buffer early
-	s_isTracing = false;
+	int readyHalf = s_readyHalf;
+	if (readyHalf == -1) {
+		return {nullptr, 0};
+	}
 
-	return {reinterpret_cast<const uint8_t*>(s_traceBuffer), sizeof(s_traceBuffer)};
+	return {reinterpret_cast<const uint8_t*>(s_traceBuffer[readyHalf]), sizeof(s_traceBuffer[0])};
 }
+
+void perfTraceReleaseBuffer() {
+	s_readyHalf = -1;
+}
+
+const perf_counter_s *getPerfCounter(PE event) {
+	return &s_counters[(int)event];
+}
+
+void resetPerfCounters() {
+	memset(s_counters, 0, sizeof(s_counters));
+}
+
+#if EFI_PROD_CODE
+
+#include "datalogging.h"
+#include "eficonsole.h"
+
+static Logging logger("perf");
+
+/**
+ * event indexes below match the PE enum order in perf_trace.h
+ */
+static void printPerfCounters(void) {
+	scheduleMsg(&logger, "trace overruns=%d", s_overrunCounter);
+	for (int i = 0; i < (int)PE::COUNT; i++) {
+		perf_counter_s *counter = &s_counters[i];
+		if (counter->count == 0) {
+			continue;
+		}
+		scheduleMsg(&logger, "PE %d: count=%d avg=%d max=%d cycles", i, counter->count,
+				(int)(counter->totalCycles / counter->count), counter->maxCycles);
+	}
+}
+
+void initPerfTrace(void) {
+	addConsoleAction("perfcount", printPerfCounters);
+	addConsoleAction("perfreset", resetPerfCounters);
+}
+
+#endif /* EFI_PROD_CODE */
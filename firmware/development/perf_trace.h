@@ -61,6 +61,9 @@ enum class PE : uint8_t {
 	// enum_end_tag
 	// The tag above is consumed by PerfTraceTool.java
 	// please note that the tool requires a comma at the end of last value
+
+	// not a real event, keep last - see the always-on counters
+	COUNT,
 };
 
 void perfEventBegin(PE event, uint8_t data = 0);
@@ -76,9 +79,30 @@ struct TraceBufferResult
 	const size_t Size;
 };
 
-// Retrieve the trace buffer
+// Retrieve the filled half of the trace buffer, empty result if none is ready
 const TraceBufferResult perfTraceGetBuffer();
 
+// Hand the drained half back to the capture side
+void perfTraceReleaseBuffer();
+
+/**
+ * Always-on counters: unlike the bounded trace buffer these run in production
+ * forever, at roughly ten cycles per instrumentation point, and catch the rare
+ * outlier invocations a short lab trace would miss.
+ */
+struct perf_counter_s
+{
+	uint32_t count;
+	uint64_t totalCycles;
+	uint32_t maxCycles;
+	// internal, timestamp of the last Start phase
+	uint32_t lastStartTimestamp;
+};
+
+const perf_counter_s *getPerfCounter(PE event);
+void resetPerfCounters();
+void initPerfTrace();
+
 #if ENABLE_PERF_TRACE
 class ScopePerf
 {
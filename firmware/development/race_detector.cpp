@@ -0,0 +1,176 @@
+/**
+ * @file	race_detector.cpp
+ * @brief	DWT watchpoint based write tracer for chasing data races
+ *
+ * Concurrent writes to shared state like tsOutputChannels from threads and
+ * ISRs have bitten us repeatedly, and coarse locking everywhere is exactly
+ * the cost we keep optimizing away. This debug-build tool programs a Cortex-M
+ * data watchpoint over a selected field and records every writer - stacked
+ * PC, interrupted thread or ISR number, timestamp - into a small ring through
+ * the debug monitor exception, without stopping the engine. Interleaved
+ * writers from different contexts then show up side by side in 'race_info'.
+ *
+ * The debug monitor only fires while no halting debugger is attached, so this
+ * is mutually exclusive with an openocd/gdb session using hardware
+ * watchpoints.
+ *
+ *     race_watch_ts 224 4      ; offset within tsOutputChannels, size 1/2/4
+ *     race_info
+ *     race_stop
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_RACE_DETECTOR
+
+#include "os_access.h"
+#include "race_detector.h"
+#include "eficonsole.h"
+#include "tunerstudio_configuration.h"
+
+#define RACE_RING_SIZE 64
+
+typedef struct {
+	/**
+	 * stacked return address, feed it to addr2line against the .elf
+	 */
+	uint32_t pc;
+	/**
+	 * name of the interrupted thread, or NULL for an ISR writer
+	 */
+	const char *threadName;
+	/**
+	 * exception number from the stacked xPSR when the write came from an ISR
+	 */
+	uint32_t isrNumber;
+	uint32_t timeUs;
+} race_record_s;
+
+static Logging *logger;
+
+static race_record_s raceRing[RACE_RING_SIZE];
+static volatile int raceRingIndex = 0;
+static volatile int raceHitCounter = 0;
+static uintptr_t watchedAddress = 0;
+static int watchedSize = 0;
+
+/**
+ * invoked from DebugMon_Handler, debug monitor exception context
+ */
+static void onWatchpointHit(uint32_t pc, uint32_t stackedXpsr) {
+	race_record_s *record = &raceRing[raceRingIndex];
+	raceRingIndex = (raceRingIndex + 1) % RACE_RING_SIZE;
+	raceHitCounter++;
+
+	record->pc = pc;
+	uint32_t isr = stackedXpsr & 0x1FF;
+	if (isr == 0) {
+		record->threadName = chRegGetThreadNameX(chThdGetSelfX());
+		record->isrNumber = 0;
+	} else {
+		record->threadName = NULL;
+		record->isrNumber = isr;
+	}
+	record->timeUs = (uint32_t) getTimeNowUs();
+}
+
+extern "C" void DebugMon_Handler(void) {
+	// acknowledge the DWT trap, otherwise we would loop right back in here
+	SCB->DFSR = SCB_DFSR_DWTTRAP_Msk;
+	/**
+	 * same stacked-frame trick as main_hardfault.c: the write instruction's
+	 * context was pushed onto the process stack on exception entry
+	 */
+	struct port_extctx *ctx = (struct port_extctx *) __get_PSP();
+	onWatchpointHit(ctx->pc, ctx->xpsr);
+}
+
+static void stopRaceWatch(void) {
+	DWT->FUNCTION0 = 0;
+	watchedAddress = 0;
+	watchedSize = 0;
+	scheduleMsg(logger, "race watch disarmed, %d hits recorded", raceHitCounter);
+}
+
+static void armRaceWatch(uintptr_t address, int size) {
+	int maskBits;
+	switch (size) {
+	case 1:
+		maskBits = 0;
+		break;
+	case 2:
+		maskBits = 1;
+		break;
+	case 4:
+		maskBits = 2;
+		break;
+	default:
+		scheduleMsg(logger, "race watch size must be 1, 2 or 4");
+		return;
+	}
+	if ((address & (size - 1)) != 0) {
+		scheduleMsg(logger, "race watch address 0x%x not %d-aligned", address, size);
+		return;
+	}
+
+	raceRingIndex = 0;
+	raceHitCounter = 0;
+	memset(raceRing, 0, sizeof(raceRing));
+	watchedAddress = address;
+	watchedSize = size;
+
+	// the debug monitor is our watchpoint delivery mechanism while no halting debugger is attached
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk | CoreDebug_DEMCR_MON_EN_Msk;
+	DWT->COMP0 = address;
+	DWT->MASK0 = maskBits;
+	// data address write comparison, generate a watchpoint debug event
+	DWT->FUNCTION0 = 6;
+
+	scheduleMsg(logger, "race watch armed on 0x%x size=%d", address, size);
+}
+
+/**
+ * offset/size within tsOutputChannels, offsets are the same ones the TS ini uses
+ */
+static void raceWatchTs(int offset, int size) {
+	if (offset < 0 || offset + size > (int) sizeof(TunerStudioOutputChannels)) {
+		scheduleMsg(logger, "race watch offset %d out of output channels", offset);
+		return;
+	}
+	armRaceWatch((uintptr_t) &tsOutputChannels + offset, size);
+}
+
+static void printRaceInfo(void) {
+	scheduleMsg(logger, "race watch %s addr=0x%x size=%d hits=%d",
+			watchedAddress == 0 ? "disarmed" : "armed", watchedAddress, watchedSize, raceHitCounter);
+	/**
+	 * oldest record first: once the ring has wrapped the write index points at
+	 * the oldest slot, unwritten slots still hold the zero pc
+	 */
+	int start = raceRingIndex;
+	for (int i = 0; i < RACE_RING_SIZE; i++) {
+		race_record_s *record = &raceRing[(start + i) % RACE_RING_SIZE];
+		if (record->pc == 0) {
+			continue;
+		}
+		if (record->threadName != NULL) {
+			scheduleMsg(logger, "race pc=0x%x thread=%s time=%dus", record->pc, record->threadName,
+					record->timeUs);
+		} else {
+			scheduleMsg(logger, "race pc=0x%x isr=%d time=%dus", record->pc, record->isrNumber,
+					record->timeUs);
+		}
+	}
+}
+
+void initRaceDetector(Logging *sharedLogger) {
+	logger = sharedLogger;
+	addConsoleActionII("race_watch_ts", (VoidIntInt) raceWatchTs);
+	addConsoleAction("race_stop", stopRaceWatch);
+	addConsoleAction("race_info", printRaceInfo);
+}
+
+#endif /* EFI_RACE_DETECTOR */
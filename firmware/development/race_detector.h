@@ -0,0 +1,13 @@
+/**
+ * @file	race_detector.h
+ * @brief	DWT watchpoint based write tracer for chasing data races
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+void initRaceDetector(Logging *sharedLogger);
@@ -19,9 +19,59 @@
 
 #if EFI_PERF_METRICS
 #include "test.h"
+#include "event_queue.h"
 
 static Logging* logger;
 
+static volatile int benchSink;
+
+static void benchQueueCallback(void *) {
+	benchSink++;
+}
+
+/**
+ * same machine-readable "BENCH,<name>,<iterations>,<ns_per_op>" format as the
+ * benchmark.* cases in unit_tests, see reportBenchResult() there
+ */
+static void reportBench(const char *name, int iterations, int totalUs) {
+	scheduleMsg(logger, "BENCH,%s,%d,%d", name, iterations, (int) (1000LL * totalUs / iterations));
+}
+
+/**
+ * steady-state pop-earliest plus insert-at-the-back with the queue holding
+ * 'depth' entries throughout, mirrors measureEventQueueAtDepth() in unit_tests
+ */
+static void benchEventQueueAtDepth(const char *name, int depth) {
+	static EventQueue queue;
+	static scheduling_s slots[64];
+	queue.clear();
+
+	efitime_t now = 0;
+	for (int i = 0; i < depth; i++) {
+		queue.insertTask(&slots[i], now + 1 + i, { benchQueueCallback, nullptr });
+	}
+	int iterations = 10000;
+	int popIndex = 0;
+	efitimeus_t startUs = getTimeNowUs();
+	for (int i = 0; i < iterations; i++) {
+		now++;
+		queue.executeAll(now);
+		queue.insertTask(&slots[popIndex], now + depth, { benchQueueCallback, nullptr });
+		popIndex = (popIndex + 1) % depth;
+	}
+	reportBench(name, iterations, (int) (getTimeNowUs() - startUs));
+}
+
+/**
+ * on-target subset of the unit_tests benchmark suite - the trigger decode and
+ * PWM cases need the simulator scaffolding and only run on the desktop
+ */
+static void runBenchmarks(void) {
+	benchEventQueueAtDepth("event_queue_d4", 4);
+	benchEventQueueAtDepth("event_queue_d16", 16);
+	benchEventQueueAtDepth("event_queue_d64", 64);
+}
+
 static void testSystemCalls(const int count) {
 	time_t start, time;
 	long result = 0;
@@ -307,6 +357,7 @@ void initTimePerfActions(Logging *sharedLogger) {
 
 	addConsoleAction("timeinfo", timeInfo);
 	addConsoleAction("chtest", runChibioTest);
+	addConsoleAction("benchmarks", runBenchmarks);
 }
 
 #endif /* EFI_PERF_METRICS */
@@ -1,6 +1,17 @@
 /**
  * @file	sensor_chart.cpp
  *
+ * High-rate sensor chart capture: scAddData() used to printf each sample into
+ * the logging buffer right at the call site, which capped the feasible sample
+ * rate around a few hundred Hz and put float formatting into ISR context. Data
+ * points now land in a compact binary double buffer (two floats per record,
+ * the angle doubles as the time axis of this protocol) and all text rendering
+ * happens in publishSensorChart() from the console thread, the same
+ * render-on-publish split engine_sniffer.cpp uses. This raises usable capture
+ * rates into the multi-kHz range for ETB tuning and knock window alignment.
+ *
+ * The wire format towards the java console is unchanged.
+ *
  * @date Dec 20, 2013
  * @author Andrey Belomutskiy, (c) 2012-2020
  */
@@ -14,18 +25,36 @@
 #if EFI_SENSOR_CHART
 #include "status_loop.h"
 
+typedef struct {
+	float angle;
+	float value;
+} sc_record_s;
+
+#define SC_CHART_SIZE 1024
+
 #if EFI_TEXT_LOGGING
 static char LOGGING_BUFFER[5000] CCM_OPTIONAL;
 static Logging scLogging("analog chart", LOGGING_BUFFER, sizeof(LOGGING_BUFFER));
+static LoggingWithStorage logger("sensor chart");
 #endif /* EFI_TEXT_LOGGING */
 
+static sc_record_s SC_RECORDS[2][SC_CHART_SIZE] CCM_OPTIONAL;
+static int scActiveBuffer = 0;
+static volatile int scCounter = 0;
+/**
+ * complete chart waiting for the console thread to render, -1 means none
+ */
+static volatile int scReadyCount = -1;
+static int scReadyBuffer = 0;
+static int scDroppedSamples = 0;
+static int scOverrunCounter = 0;
+
 static int pendingData = false;
 static int initialized = false;
 
 EXTERN_ENGINE;
 
 void scAddData(float angle, float value) {
-#if EFI_TEXT_LOGGING
 	if (!initialized) {
 		return; // this is possible because of initialization sequence
 	}
@@ -46,38 +75,87 @@ void scAddData(float angle, float value) {
 		if (pendingData) {
 			/**
 			 * We are here if that's the first time we do not need to add
-			 * data after we have added some data - meaning it's time to flush
+			 * data after we have added some data - meaning the capture is
+			 * complete. We only swap buffers here, rendering is done by
+			 * publishSensorChart() on the console thread.
 			 */
-			// message terminator
-			appendPrintf(&scLogging, DELIMETER);
-			// output pending data
-			scheduleLogging(&scLogging);
+			bool alreadyLocked = lockOutputBuffer();
+			if (scReadyCount >= 0) {
+				// the console thread did not keep up, the old chart is lost
+				scOverrunCounter++;
+			}
+			scReadyBuffer = scActiveBuffer;
+			scReadyCount = scCounter;
+			scActiveBuffer ^= 1;
+			scCounter = 0;
+			if (!alreadyLocked) {
+				unlockOutputBuffer();
+			}
 			pendingData = false;
 		}
 		return;
 	}
-	if (!pendingData) {
-		pendingData = true;
-		resetLogging(&scLogging);
-		// message header
-		appendPrintf(&scLogging, "%s%s", PROTOCOL_ANALOG_CHART, DELIMETER);
+	pendingData = true;
+
+	bool alreadyLocked = lockOutputBuffer();
+	if (scCounter < SC_CHART_SIZE) {
+		sc_record_s *record = &SC_RECORDS[scActiveBuffer][scCounter];
+		record->angle = angle;
+		record->value = value;
+		scCounter++;
+	} else {
+		scDroppedSamples++;
+	}
+	if (!alreadyLocked) {
+		unlockOutputBuffer();
+	}
+}
+
+/**
+ * Renders and ships a complete capture, if there is one. Invoked from the
+ * console thread, see printOverallStatus().
+ */
+void publishSensorChart(void) {
+	if (scReadyCount < 0) {
+		return;
 	}
+#if EFI_TEXT_LOGGING
+	sc_record_s *records = SC_RECORDS[scReadyBuffer];
+	int count = scReadyCount;
 
-	if (remainingSize(&scLogging) > 100) {
-		appendPrintf(&scLogging, "%.2f|%.2f|", angle, value);
+	resetLogging(&scLogging);
+	// message header
+	appendPrintf(&scLogging, "%s%s", PROTOCOL_ANALOG_CHART, DELIMETER);
+	for (int i = 0; i < count; i++) {
+		if (remainingSize(&scLogging) < 100) {
+			break;
+		}
+		appendPrintf(&scLogging, "%.2f|%.2f|", records[i].angle, records[i].value);
 	}
+	// message terminator
+	appendPrintf(&scLogging, DELIMETER);
+	scheduleLogging(&scLogging);
 #endif /* EFI_TEXT_LOGGING */
+	scReadyCount = -1;
 }
 
 static void setSensorChartFrequency(int value) {
 	engineConfiguration->sensorChartFrequency = value;
 }
 
+static void printScInfo(void) {
+#if EFI_TEXT_LOGGING
+	scheduleMsg(&logger, "sensor chart freq=%d dropped=%d overruns=%d",
+			engineConfiguration->sensorChartFrequency, scDroppedSamples, scOverrunCounter);
+#endif /* EFI_TEXT_LOGGING */
+}
+
 void initSensorChart(void) {
 #if EFI_SIMULATOR
 	printf("initSensorChart\n");
 #endif
 	addConsoleActionI("set_sensor_chart_freq", setSensorChartFrequency);
+	addConsoleAction("scinfo", printScInfo);
 
 	initialized = true;
 }
@@ -10,4 +10,8 @@
 #include "global.h"
 
 void scAddData(float angle, float value);
+/**
+ * renders a completed capture into the text protocol, console thread only
+ */
+void publishSensorChart(void);
 void initSensorChart(void);
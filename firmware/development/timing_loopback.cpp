@@ -0,0 +1,202 @@
+/**
+ * @file	timing_loopback.cpp
+ * @brief	injector/ignition output timing self-measurement via a loopback wire
+ *
+ * Bench test mode: jumper injector output #1 to a spare input capture pin and
+ * the firmware measures its own scheduling accuracy. While armed we schedule a
+ * continuous pulse train on the injector pin through the normal executor, the
+ * ICU captures the edges as they actually happen, and the difference goes into
+ * scheduled-vs-actual error histograms per edge direction. This turns any
+ * bench into a timing validation rig, so scheduler changes can be quantified
+ * without a scope.
+ *
+ * The actual edge timestamp is read inside the ICU callback, so measured error
+ * includes input capture interrupt latency - which is fine, the same latency
+ * sits inside every trigger timestamp the decoder ever sees.
+ *
+ *     loopback_start PA8
+ *     loopback_info
+ *     loopback_stop
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_TIMING_LOOPBACK && HAL_USE_ICU
+
+#include "os_access.h"
+#include "timing_loopback.h"
+#include "digital_input_icu.h"
+#include "efi_gpio.h"
+#include "eficonsole.h"
+#include "engine.h"
+
+EXTERN_ENGINE;
+
+/**
+ * 100Hz pulse train with a 2ms pulse, roughly an idling injector
+ */
+#define LOOPBACK_PERIOD_US 10000
+#define LOOPBACK_PULSE_US 2000
+
+#define LOOPBACK_BIN_COUNT 8
+/**
+ * upper bounds of the absolute error histogram bins, last bin is unbounded
+ */
+static const int binUpperUs[LOOPBACK_BIN_COUNT - 1] = { 1, 2, 5, 10, 20, 50, 100 };
+
+typedef struct {
+	int count;
+	int bins[LOOPBACK_BIN_COUNT];
+	int minErrorUs;
+	int maxErrorUs;
+	int64_t sumErrorUs;
+} edge_error_stats_s;
+
+static Logging *logger;
+
+static bool isLoopbackRunning = false;
+static brain_pin_e loopbackInputPin = GPIO_UNASSIGNED;
+
+static scheduling_s cycleScheduling;
+static scheduling_s riseScheduling;
+static scheduling_s fallScheduling;
+
+/**
+ * when the pending pulse edges are supposed to happen - only one pulse is ever
+ * outstanding so a plain pair of variables is enough for pairing
+ */
+static volatile efitimeus_t expectedRiseUs;
+static volatile efitimeus_t expectedFallUs;
+
+static edge_error_stats_s riseStats;
+static edge_error_stats_s fallStats;
+
+static void resetEdgeStats(edge_error_stats_s *stats) {
+	memset(stats, 0, sizeof(edge_error_stats_s));
+	stats->minErrorUs = INT32_MAX;
+	stats->maxErrorUs = INT32_MIN;
+}
+
+static void recordEdge(edge_error_stats_s *stats, efitimeus_t expectedUs) {
+	int errorUs = (int) (getTimeNowUs() - expectedUs);
+	stats->count++;
+	stats->sumErrorUs += errorUs;
+	if (errorUs < stats->minErrorUs) {
+		stats->minErrorUs = errorUs;
+	}
+	if (errorUs > stats->maxErrorUs) {
+		stats->maxErrorUs = errorUs;
+	}
+	int absErrorUs = absI(errorUs);
+	int bin = LOOPBACK_BIN_COUNT - 1;
+	for (int i = 0; i < LOOPBACK_BIN_COUNT - 1; i++) {
+		if (absErrorUs <= binUpperUs[i]) {
+			bin = i;
+			break;
+		}
+	}
+	stats->bins[bin]++;
+}
+
+static void loopbackRiseCallback(void *) {
+	recordEdge(&riseStats, expectedRiseUs);
+}
+
+static void loopbackFallCallback(void *) {
+	recordEdge(&fallStats, expectedFallUs);
+}
+
+static void loopbackSetHigh(void *) {
+	enginePins.injectors[0].setValue(1);
+}
+
+static void loopbackSetLow(void *) {
+	enginePins.injectors[0].setValue(0);
+}
+
+static void loopbackCycle(void *) {
+	if (!isLoopbackRunning) {
+		return;
+	}
+	efitimeus_t nowUs = getTimeNowUs();
+	/**
+	 * the expected timestamps are what we hand the executor, so the histograms
+	 * capture the whole path: executor heap, timer programming, output ISR,
+	 * GPIO and capture ISR
+	 */
+	expectedRiseUs = nowUs + LOOPBACK_PULSE_US;
+	expectedFallUs = expectedRiseUs + LOOPBACK_PULSE_US;
+	engine->executor.scheduleForLater(&riseScheduling, (int) (expectedRiseUs - nowUs), { loopbackSetHigh, nullptr });
+	engine->executor.scheduleForLater(&fallScheduling, (int) (expectedFallUs - nowUs), { loopbackSetLow, nullptr });
+	engine->executor.scheduleForLater(&cycleScheduling, LOOPBACK_PERIOD_US, { loopbackCycle, nullptr });
+}
+
+static void printEdgeStats(const char *name, edge_error_stats_s *stats) {
+	if (stats->count == 0) {
+		scheduleMsg(logger, "loopback %s: no edges captured", name);
+		return;
+	}
+	scheduleMsg(logger, "loopback %s: %d edges avg=%dus min=%dus max=%dus", name, stats->count,
+			(int) (stats->sumErrorUs / stats->count), stats->minErrorUs, stats->maxErrorUs);
+	for (int i = 0; i < LOOPBACK_BIN_COUNT - 1; i++) {
+		scheduleMsg(logger, "  <=%dus: %d", binUpperUs[i], stats->bins[i]);
+	}
+	scheduleMsg(logger, "  >%dus: %d", binUpperUs[LOOPBACK_BIN_COUNT - 2], stats->bins[LOOPBACK_BIN_COUNT - 1]);
+}
+
+static void printLoopbackInfo(void) {
+	scheduleMsg(logger, "loopback %s input=%s", isLoopbackRunning ? "running" : "stopped",
+			hwPortname(loopbackInputPin));
+	printEdgeStats("rise", &riseStats);
+	printEdgeStats("fall", &fallStats);
+}
+
+static void startLoopback(const char *pinName) {
+	if (isLoopbackRunning) {
+		scheduleMsg(logger, "loopback already running");
+		return;
+	}
+	brain_pin_e pin = parseBrainPin(pinName);
+	if (pin == GPIO_INVALID) {
+		scheduleMsg(logger, "invalid pin name [%s]", pinName);
+		return;
+	}
+	digital_input_s *capture = startDigitalCapture("loopback", pin, /*isActiveHigh*/true);
+	if (capture == nullptr) {
+		scheduleMsg(logger, "no input capture on %s", hwPortname(pin));
+		return;
+	}
+	capture->setWidthCallback((VoidPtr) loopbackRiseCallback, nullptr);
+	capture->setPeriodCallback((VoidPtr) loopbackFallCallback, nullptr);
+
+	loopbackInputPin = pin;
+	resetEdgeStats(&riseStats);
+	resetEdgeStats(&fallStats);
+	isLoopbackRunning = true;
+	scheduleMsg(logger, "loopback started: jumper %s to %s, this pulses injector #1!",
+			hwPortname(engineConfiguration->injectionPins[0]), hwPortname(pin));
+	loopbackCycle(nullptr);
+}
+
+static void stopLoopback(void) {
+	if (!isLoopbackRunning) {
+		return;
+	}
+	isLoopbackRunning = false;
+	enginePins.injectors[0].setValue(0);
+	stopDigitalCapture("loopback", loopbackInputPin);
+	loopbackInputPin = GPIO_UNASSIGNED;
+	printLoopbackInfo();
+}
+
+void initTimingLoopback(Logging *sharedLogger) {
+	logger = sharedLogger;
+	addConsoleActionS("loopback_start", startLoopback);
+	addConsoleAction("loopback_stop", stopLoopback);
+	addConsoleAction("loopback_info", printLoopbackInfo);
+}
+
+#endif /* EFI_TIMING_LOOPBACK && HAL_USE_ICU */
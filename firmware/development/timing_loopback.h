@@ -0,0 +1,13 @@
+/**
+ * @file	timing_loopback.h
+ * @brief	injector/ignition output timing self-measurement via a loopback wire
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+void initTimingLoopback(Logging *sharedLogger);
@@ -0,0 +1,100 @@
+/**
+ * @file	trigger_replay.cpp
+ * @brief	replays a recorded tooth log through the real trigger decoder
+ *
+ * We capture tooth logs from problem vehicles but could only analyze them
+ * offline - the repro loop for a decode bug involved shipping a car to the
+ * bench. 'trigger_replay' feeds whatever is sitting in the tooth logger ring
+ * (just captured live, or written into the ring by TS) through
+ * TriggerState::decodeTriggerEvent with virtual time reconstructed from the
+ * recorded deltas, then reports decode statistics. The replay runs against a
+ * private TriggerState so no scheduling or outputs are driven - it is the
+ * same decode code the shaft interrupt path uses, without the side effects.
+ *
+ * The tooth logger records primary falling edges only (the VR-accurate edge),
+ * so replay feeds exactly that stream - same as what the decoder of a VR
+ * equipped engine sees.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_TOOTH_LOGGER && EFI_SHAFT_POSITION_INPUT
+
+#include "os_access.h"
+#include "trigger_replay.h"
+#include "tooth_logger.h"
+#include "trigger_central.h"
+#include "trigger_decoder.h"
+#include "eficonsole.h"
+#include "engine.h"
+#include "rpm_calculator.h"
+
+EXTERN_ENGINE;
+
+static Logging *logger;
+
+/**
+ * decoder instance private to the replay so the live engine state is not touched
+ */
+static TriggerState replayState;
+
+static void replaySpan(const uint16_t *entries, size_t count, efitick_t *timeNt, int *eventCounter,
+		int *syncAtEvent) {
+	for (size_t i = 0; i < count; i++) {
+		// the ring stores big endian for TS, unwritten slots are zero
+		uint16_t deltaTensOfUs = SWAP_UINT16(entries[i]);
+		if (deltaTensOfUs == 0) {
+			continue;
+		}
+		*timeNt += US2NT(10 * (int) deltaTensOfUs);
+		replayState.decodeTriggerEvent(&engine->triggerCentral.triggerShape, nullptr,
+				/* listener */ nullptr, SHAFT_PRIMARY_FALLING, *timeNt PASS_CONFIG_PARAMETER_SUFFIX);
+		(*eventCounter)++;
+		if (*syncAtEvent < 0 && replayState.shaft_is_synchronized) {
+			*syncAtEvent = *eventCounter;
+		}
+	}
+}
+
+static void runTriggerReplay(void) {
+	if (GET_RPM() != 0) {
+		scheduleMsg(logger, "trigger replay is a bench tool, not while the engine is spinning");
+		return;
+	}
+	ToothLoggerBuffer log = GetToothLoggerBuffer();
+
+	replayState.resetTriggerState();
+	efitick_t virtualTimeNt = 0;
+	int eventCounter = 0;
+	int syncAtEvent = -1;
+
+	efitimeus_t startUs = getTimeNowUs();
+	replaySpan((const uint16_t *) log.Buffer, log.Length / 2, &virtualTimeNt, &eventCounter, &syncAtEvent);
+	replaySpan((const uint16_t *) log.Buffer2, log.Length2 / 2, &virtualTimeNt, &eventCounter, &syncAtEvent);
+	int elapsedUs = (int) (getTimeNowUs() - startUs);
+
+	if (eventCounter == 0) {
+		scheduleMsg(logger, "trigger replay: tooth log is empty, capture one first");
+		return;
+	}
+	scheduleMsg(logger, "trigger replay: %d events in %dus (%dns/event)", eventCounter, elapsedUs,
+			1000 * elapsedUs / eventCounter);
+	if (syncAtEvent < 0) {
+		scheduleMsg(logger, "trigger replay: decoder never synchronized");
+	} else {
+		scheduleMsg(logger, "trigger replay: synchronized at event %d", syncAtEvent);
+	}
+	scheduleMsg(logger, "trigger replay: revolutions=%d decode errors=%d ordering errors=%d",
+			replayState.getTotalRevolutionCounter(), replayState.totalTriggerErrorCounter,
+			replayState.orderingErrorCounter);
+}
+
+void initTriggerReplay(Logging *sharedLogger) {
+	logger = sharedLogger;
+	addConsoleAction("trigger_replay", runTriggerReplay);
+}
+
+#endif /* EFI_TOOTH_LOGGER && EFI_SHAFT_POSITION_INPUT */
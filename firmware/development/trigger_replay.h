@@ -0,0 +1,13 @@
+/**
+ * @file	trigger_replay.h
+ * @brief	replays a recorded tooth log through the real trigger decoder
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+void initTriggerReplay(Logging *sharedLogger);
@@ -49,8 +49,9 @@
 /* This option switches fast seek function. (0:Disable or 1:Enable) */
 
 
-#define FF_USE_EXPAND	0
+#define FF_USE_EXPAND	1
 /* This option switches f_expand function. (0:Disable or 1:Enable) */
+/* rusEfi needs f_expand for the contiguous raw-append SD logging mode, see mmc_card.cpp */
 
 
 #define FF_USE_CHMOD	0
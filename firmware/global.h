@@ -93,6 +93,22 @@ typedef unsigned int time_t;
 #define CCM_OPTIONAL
 #endif /* EFI_USE_CCM */
 
+/**
+ * On STM32F7 hot functions can be placed into the 16k ITCM RAM which the core
+ * fetches with zero wait states - flash fetches pay wait states on every cache miss
+ * and that cost lands inside ISRs. The .ram4_init section is copied from flash
+ * by the ChibiOS startup code, the linker inserts veneers for the long calls.
+ * A placement report is printed at the end of the build, see the Makefile.
+ *
+ * On STM32F4 the CCM is only wired to the D-bus so code cannot execute from it
+ * and this annotation is a no-op.
+ */
+#if defined(STM32F7XX) && defined __GNUC__
+#define ITCM_CODE __attribute__((section(".ram4_init")))
+#else
+#define ITCM_CODE
+#endif
+
 #define getCurrentRemainingStack() getRemainingStack(chThdGetSelfX())
 
 
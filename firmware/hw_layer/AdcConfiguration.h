@@ -22,6 +22,20 @@ public:
 	void enableChannel(adc_channel_e hwChannelIndex);
 	void enableChannelAndPin(adc_channel_e hwChannelIndex);
 	adc_channel_e getAdcHardwareIndexByInternalIndex(int index) const;
+	/**
+	 * Per-channel tick divider for the slow pipeline: a channel with divider N is
+	 * converted on every Nth controller tick, so thermal-timescale inputs stop burning
+	 * conversion slots at the full tick rate. Divider 1 (the default) keeps the
+	 * legacy every-tick behavior. See buildDueSequence().
+	 */
+	void setTickDivider(adc_channel_e hwChannel, uint8_t divider);
+	/**
+	 * Builds the scan sequence of the channels due this tick into 'dueConfig' and
+	 * 'dueList' (internal indices, in sequence order). Dividers are staggered by
+	 * channel index so decimated channels do not pile onto the same tick.
+	 * @return number of channels due this tick
+	 */
+	int buildDueSequence(ADCConversionGroup *dueConfig, uint8_t dueList[]);
 	int internalAdcIndexByHardwareIndex[20];
 	bool isHwUsed(adc_channel_e hwChannel) const;
 	int size() const;
@@ -30,6 +44,11 @@ public:
 	int errorsCount;
 	int getAdcValueByIndex(int internalIndex) const;
 	void invalidateSamplesCache();
+	/**
+	 * partial flavor used by the double-buffered fast pipeline: invalidates only the
+	 * buffer chunk which DMA just handed over instead of the whole sample array
+	 */
+	void invalidateSamplesCache(adcsample_t *buffer, size_t count);
 
 	// on F7 this must be aligned on a 32-byte boundary, and be a multiple of 32 bytes long.
 	// When we invalidate the cache line(s) for ADC samples, we don't want to nuke any
@@ -44,6 +63,8 @@ public:
 	adc_state values;
 	int channelCount;
 private:
+	uint8_t tickDividerByIndex[ADC_MAX_CHANNELS_COUNT];
+	int tickCounter;
 	ADCConversionGroup* hwConfig;
 	/**
 	 * Number of ADC channels in use
@@ -27,10 +27,12 @@
 
 #include "engine.h"
 #include "adc_inputs.h"
+#include "adc_transforms.h"
 #include "adc_subscription.h"
 #include "AdcConfiguration.h"
 #include "mpu_util.h"
 #include "periodic_thread_controller.h"
+#include "power_state.h"
 
 #include "pin_repository.h"
 #include "engine_math.h"
@@ -40,6 +42,12 @@
 
 /* Depth of the conversion buffer, channels are sampled X times each.*/
 #define ADC_BUF_DEPTH_SLOW      8
+/**
+ * log2 of the buffer depths: the oversample accumulators decimate with a right shift
+ * instead of a division, see getAvgAdcValue(). Keep the depths powers of two.
+ */
+#define ADC_DEPTH_SHIFT_SLOW    3
+#define ADC_DEPTH_SHIFT_FAST    2
 #define ADC_BUF_DEPTH_FAST      4
 
 //static Biquad biq[ADC_MAX_CHANNELS_COUNT];
@@ -51,6 +59,13 @@ EXTERN_ENGINE;
 
 // Board voltage, with divider coefficient accounted for
 float getVoltageDivided(const char *msg, adc_channel_e hwChannel DECLARE_ENGINE_PARAMETER_SUFFIX) {
+#if EFI_ADC_TRANSFORMS
+	// the conversion already ran once at batch completion, every reader within
+	// a tick gets the same value
+	if (hasAdcTransformedValue(hwChannel)) {
+		return getAdcTransformedValue(hwChannel);
+	}
+#endif /* EFI_ADC_TRANSFORMS */
 	return getVoltage(msg, hwChannel PASS_ENGINE_PARAMETER_SUFFIX) * engineConfiguration->analogInputDividerCoefficient;
 }
 
@@ -68,8 +83,52 @@ AdcDevice::AdcDevice(ADCConversionGroup* hwConfig) {
 	hwConfig->sqr1 = 0;
 	hwConfig->sqr2 = 0;
 	hwConfig->sqr3 = 0;
+	tickCounter = 0;
 	memset(hardwareIndexByIndernalAdcIndex, 0, sizeof(hardwareIndexByIndernalAdcIndex));
 	memset(internalAdcIndexByHardwareIndex, 0xFFFFFFFF, sizeof(internalAdcIndexByHardwareIndex));
+	// every channel starts at the full tick rate
+	memset(tickDividerByIndex, 1, sizeof(tickDividerByIndex));
+}
+
+void AdcDevice::setTickDivider(adc_channel_e hwChannel, uint8_t divider) {
+	if (hwChannel == EFI_ADC_NONE || hwChannel == EFI_ADC_ERROR) {
+		return;
+	}
+	int internalIndex = internalAdcIndexByHardwareIndex[hwChannel];
+	if (internalIndex < 0 || internalIndex >= channelCount) {
+		// that channel is not part of this device, e.g. it is handled by the fast ADC
+		return;
+	}
+	tickDividerByIndex[internalIndex] = maxI(1, divider);
+}
+
+int AdcDevice::buildDueSequence(ADCConversionGroup *dueConfig, uint8_t dueList[]) {
+	int dueCount = 0;
+	int tick = tickCounter++;
+	for (int i = 0; i < channelCount; i++) {
+		uint8_t divider = tickDividerByIndex[i];
+		// the very first tick converts everything so consumers never see stale zeros;
+		// afterwards decimated channels are staggered by index to spread the load
+		if (tick == 0 || divider <= 1 || ((tick + i) % divider) == 0) {
+			dueList[dueCount++] = i;
+		}
+	}
+	*dueConfig = *hwConfig;
+	dueConfig->num_channels = dueCount;
+	dueConfig->sqr1 = ADC_SQR1_NUM_CH(dueCount);
+	dueConfig->sqr2 = 0;
+	dueConfig->sqr3 = 0;
+	for (int k = 0; k < dueCount; k++) {
+		int hwChannel = hardwareIndexByIndernalAdcIndex[dueList[k]];
+		if (k < 6) {
+			dueConfig->sqr3 += hwChannel << (5 * k);
+		} else if (k < 12) {
+			dueConfig->sqr2 += hwChannel << (5 * (k - 6));
+		} else {
+			dueConfig->sqr1 += hwChannel << (5 * (k - 12));
+		}
+	}
+	return dueCount;
 }
 
 #if !defined(PWM_FREQ_FAST) || !defined(PWM_PERIOD_FAST)
@@ -101,18 +160,37 @@ static int adcDebugReporting = false;
 
 EXTERN_ENGINE;
 
-static adcsample_t getAvgAdcValue(int index, adcsample_t *samples, int bufDepth, int numChannels) {
+/**
+ * Oversample-and-decimate: accumulates 2^depthShift samples in a uint32 and decimates
+ * with a right shift - no division on the per-tick path. ADCv2 on the F4/F7 has no
+ * hardware oversampling unit, so the accumulation stays in software; parts that grow
+ * one can fold it in here without touching the consumers.
+ *
+ * Decimating by (depthShift - ADC_OVERSAMPLE_EXTRA_BITS) would retain extra effective
+ * resolution bits; consumers read the current setting via ADC_OVERSAMPLE_EXTRA_BITS
+ * so the scale is in one place.
+ */
+static adcsample_t getAvgAdcValue(int index, adcsample_t *samples, int depthShift, int numChannels) {
 	uint32_t result = 0;
+	int bufDepth = 1 << depthShift;
 	for (int i = 0; i < bufDepth; i++) {
 		result += samples[index];
 		index += numChannels;
 	}
 
-	// this truncation is guaranteed to not be lossy - the average can't be larger than adcsample_t
-	return static_cast<adcsample_t>(result / bufDepth);
+	// this truncation is guaranteed to not be lossy - the decimated accumulator can't be larger than adcsample_t
+	return static_cast<adcsample_t>(result >> (depthShift - ADC_OVERSAMPLE_EXTRA_BITS));
 }
 
 
+/**
+ * tick dividers for the slow pipeline rate classes, see setTickDivider(): at the
+ * 200 Hz controller tick the thermal divider lands at 10 Hz and the battery one
+ * at 100 Hz
+ */
+#define SLOW_ADC_DIVIDER_THERMAL 20
+#define SLOW_ADC_DIVIDER_VBATT 2
+
 // See https://github.com/rusefi/rusefi/issues/976 for discussion on these values
 #define ADC_SAMPLING_SLOW ADC_SAMPLE_56
 #define ADC_SAMPLING_FAST ADC_SAMPLE_28
@@ -231,6 +309,18 @@ static void pwmpcb_fast(PWMDriver *pwmp) {
 	fastAdc.conversionCount++;
 #endif /* EFI_INTERNAL_ADC */
 }
+/**
+ * fast conversions are gated by the performance state: after shutdown there is nobody
+ * consuming high rate MAP/TPS samples and the converting ADC just drains the battery
+ */
+static void fastAdcPowerStateListener(power_state_e state) {
+	if (state == PS_POST_SHUTDOWN) {
+		pwmDisablePeriodicNotification(EFI_INTERNAL_FAST_ADC_PWM);
+	} else if (state == PS_CRANKING || state == PS_RUNNING) {
+		pwmEnablePeriodicNotification(EFI_INTERNAL_FAST_ADC_PWM);
+	}
+}
+
 #endif /* HAL_USE_PWM */
 
 float getMCUInternalTemperature(void) {
@@ -246,6 +336,13 @@ float getMCUInternalTemperature(void) {
 #endif /* ADC_CHANNEL_SENSOR */
 }
 
+adc_channel_mode_e getAdcChannelMode(adc_channel_e hwChannel) {
+	if (hwChannel <= EFI_ADC_NONE || hwChannel >= HW_MAX_ADC_INDEX) {
+		return ADC_OFF;
+	}
+	return adcHwChannelEnabled[hwChannel];
+}
+
 int getInternalAdcValue(const char *msg, adc_channel_e hwChannel) {
 	if (hwChannel == EFI_ADC_NONE) {
 		warning(CUSTOM_OBD_ANALOG_INPUT_NOT_CONFIGURED, "ADC: %s input is not configured", msg);
@@ -262,7 +359,7 @@ int getInternalAdcValue(const char *msg, adc_channel_e hwChannel) {
 		int internalIndex = fastAdc.internalAdcIndexByHardwareIndex[hwChannel];
 // todo if ADC_BUF_DEPTH_FAST EQ 1
 //		return fastAdc.samples[internalIndex];
-		int value = getAvgAdcValue(internalIndex, fastAdc.samples, ADC_BUF_DEPTH_FAST, fastAdc.size());
+		int value = getAvgAdcValue(internalIndex, fastAdc.samples, ADC_DEPTH_SHIFT_FAST, fastAdc.size());
 		return value;
 	}
 	if (adcHwChannelEnabled[hwChannel] != ADC_SLOW) {
@@ -317,13 +414,20 @@ int AdcDevice::getAdcValueByIndex(int internalIndex) const {
 }
 
 void AdcDevice::invalidateSamplesCache() {
+	invalidateSamplesCache(samples, sizeof(samples) / sizeof(samples[0]));
+}
+
+void AdcDevice::invalidateSamplesCache(adcsample_t *buffer, size_t count) {
 #if defined(STM32F7XX)
 	// The STM32F7xx has a data cache
 	// DMA operations DO NOT invalidate cache lines, since the ARM m7 doesn't have 
 	// anything like a CCI that maintains coherency across multiple bus masters.
 	// As a result, we have to manually invalidate the D-cache any time we (the CPU)
 	// would like to read something that somebody else wrote (ADC via DMA, in this case)
-	SCB_InvalidateDCache_by_Addr(reinterpret_cast<uint32_t*>(samples), sizeof(samples));
+	SCB_InvalidateDCache_by_Addr(reinterpret_cast<uint32_t*>(buffer), count * sizeof(adcsample_t));
+#else
+	UNUSED(buffer);
+	UNUSED(count);
 #endif
 }
 
@@ -422,43 +526,62 @@ public:
 	}
 
 	void PeriodicTask(efitick_t nowNt) override {
-		{
-			ScopePerf perf(PE::AdcConversionSlow);
+		// scan sequence of only the channels due this tick, see setTickDivider()
+		int dueCount = slowAdc.buildDueSequence(&slowDueConfig, slowDueList);
+		if (dueCount > 0) {
+			{
+				ScopePerf perf(PE::AdcConversionSlow);
 
-			slowAdc.conversionCount++;
-			msg_t result = adcConvert(&ADC_SLOW_DEVICE, &adcgrpcfgSlow, slowAdc.samples, ADC_BUF_DEPTH_SLOW);
+				slowAdc.conversionCount++;
+				msg_t result = adcConvert(&ADC_SLOW_DEVICE, &slowDueConfig, slowAdc.samples, ADC_BUF_DEPTH_SLOW);
 
-			// If something went wrong - try again later
-			if (result == MSG_RESET || result == MSG_TIMEOUT) {
-				slowAdc.errorsCount++;
-				return;
-			}
+				// If something went wrong - try again later
+				if (result == MSG_RESET || result == MSG_TIMEOUT) {
+					slowAdc.errorsCount++;
+					return;
+				}
 
 #ifdef USE_ADC3_VBATT_HACK
-			void proteusAdcHack();
-			proteusAdcHack();
+				void proteusAdcHack();
+				proteusAdcHack();
 #endif
-		}
+			}
 
-		{
-			ScopePerf perf(PE::AdcProcessSlow);
+			{
+				ScopePerf perf(PE::AdcProcessSlow);
 
-			slowAdc.invalidateSamplesCache();
+				slowAdc.invalidateSamplesCache();
 
-			/* Calculates the average values from the ADC samples.*/
-			for (int i = 0; i < slowAdc.size(); i++) {
-				adcsample_t value = getAvgAdcValue(i, slowAdc.samples, ADC_BUF_DEPTH_SLOW, slowAdc.size());
-				adcsample_t prev = slowAdc.values.adc_data[i];
-				float result = (slowAdcCounter == 0) ? value :
-						CONFIG(slowAdcAlpha) * value + (1 - CONFIG(slowAdcAlpha)) * prev;
+				/* Calculates the average values from the ADC samples.*/
+				for (int k = 0; k < dueCount; k++) {
+					adcsample_t value = getAvgAdcValue(k, slowAdc.samples, ADC_DEPTH_SHIFT_SLOW, dueCount);
+					int i = slowDueList[k];
+					adcsample_t prev = slowAdc.values.adc_data[i];
+					float result = (slowAdcCounter == 0) ? value :
+							CONFIG(slowAdcAlpha) * value + (1 - CONFIG(slowAdcAlpha)) * prev;
 
-				slowAdc.values.adc_data[i] = (adcsample_t)result;
+					slowAdc.values.adc_data[i] = (adcsample_t)result;
+				}
 			}
-			slowAdcCounter++;
-
-			AdcSubscription::UpdateSubscribers(nowNt);
 		}
+		slowAdcCounter++;
+
+#if EFI_ADC_TRANSFORMS
+		// one conversion per channel per batch, consumers read finished units
+		applyAdcTransforms();
+#endif /* EFI_ADC_TRANSFORMS */
+
+		AdcSubscription::UpdateSubscribers(nowNt);
+
+		// sensor staleness is swept at the same 200Hz cadence readings arrive at,
+		// so a wiring fault is flagged within one slow ADC period
+		Sensor::checkFreshness(nowNt);
 	}
+
+private:
+	// scratch conversion group rebuilt every tick from the due channels
+	ADCConversionGroup slowDueConfig;
+	uint8_t slowDueList[ADC_MAX_CHANNELS_COUNT];
 };
 
 static char errorMsgBuff[_MAX_FILLER + 2];
@@ -546,11 +669,17 @@ static void configureInputs(void) {
 static SlowAdcController slowAdcController;
 
 void initAdcInputs() {
+#if EFI_ADC_TRANSFORMS
+	initAdcTransforms(&logger);
+#endif /* EFI_ADC_TRANSFORMS */
+
 	printMsg(&logger, "initAdcInputs()");
 	if (ADC_BUF_DEPTH_FAST > MAX_ADC_GRP_BUF_DEPTH)
 		firmwareError(CUSTOM_ERR_ADC_DEPTH_FAST, "ADC_BUF_DEPTH_FAST too high");
 	if (ADC_BUF_DEPTH_SLOW > MAX_ADC_GRP_BUF_DEPTH)
 		firmwareError(CUSTOM_ERR_ADC_DEPTH_SLOW, "ADC_BUF_DEPTH_SLOW too high");
+	static_assert(ADC_BUF_DEPTH_SLOW == (1 << ADC_DEPTH_SHIFT_SLOW), "slow depth shift out of sync");
+	static_assert(ADC_BUF_DEPTH_FAST == (1 << ADC_DEPTH_SHIFT_FAST), "fast depth shift out of sync");
 
 	configureInputs();
 
@@ -585,6 +714,18 @@ void initAdcInputs() {
 
 	slowAdc.init();
 
+	/**
+	 * Per-channel rate classes: channels that move on thermal timescales have no
+	 * business converting at the full tick rate, and the freed conversion slots
+	 * shorten every scan sequence. TPS and MAP stay at full rate (or on the fast ADC).
+	 */
+	slowAdc.setTickDivider(engineConfiguration->clt.adcChannel, SLOW_ADC_DIVIDER_THERMAL);
+	slowAdc.setTickDivider(engineConfiguration->iat.adcChannel, SLOW_ADC_DIVIDER_THERMAL);
+	slowAdc.setTickDivider(engineConfiguration->auxTempSensor1.adcChannel, SLOW_ADC_DIVIDER_THERMAL);
+	slowAdc.setTickDivider(engineConfiguration->auxTempSensor2.adcChannel, SLOW_ADC_DIVIDER_THERMAL);
+	slowAdc.setTickDivider(engineConfiguration->fuelLevelSensor, SLOW_ADC_DIVIDER_THERMAL);
+	slowAdc.setTickDivider(engineConfiguration->vbattAdcChannel, SLOW_ADC_DIVIDER_VBATT);
+
 	// Start the slow ADC thread
 	slowAdcController.Start();
 
@@ -596,6 +737,7 @@ void initAdcInputs() {
 #if HAL_USE_PWM
 		pwmStart(EFI_INTERNAL_FAST_ADC_PWM, &pwmcfg_fast);
 		pwmEnablePeriodicNotification(EFI_INTERNAL_FAST_ADC_PWM);
+		addPowerStateListener(fastAdcPowerStateListener, "fast ADC");
 #endif /* HAL_USE_PWM */
 	}
 
@@ -16,6 +16,7 @@
 
 const char * getAdcMode(adc_channel_e hwChannel);
 void initAdcInputs();
+adc_channel_mode_e getAdcChannelMode(adc_channel_e hwChannel);
 
 // deprecated - migrate to 'getAdcChannelBrainPin'
 int getAdcChannelPin(adc_channel_e hwChannel);
@@ -43,6 +44,15 @@ void removeChannel(const char *name, adc_channel_e setting);
 // max(ADC_BUF_DEPTH_SLOW, ADC_BUF_DEPTH_FAST)
 #define MAX_ADC_GRP_BUF_DEPTH 8
 
+/**
+ * Effective extra resolution bits retained by the oversample-and-decimate stage: raw
+ * ADC readings are scaled by 2^this relative to a single 12-bit conversion. Zero keeps
+ * the historic plain-average scale; consumers which convert counts to volts (see
+ * thermistors.cpp and the adcToVolts() users) must divide by the same factor if a
+ * board ever raises it.
+ */
+#define ADC_OVERSAMPLE_EXTRA_BITS 0
+
 #define getAdcValue(msg, hwChannel) getInternalAdcValue(msg, hwChannel)
 
 // todo: migrate to adcToVoltageInputDividerCoefficient
@@ -0,0 +1,149 @@
+/**
+ * @file	adc_transforms.cpp
+ * @brief	per-channel ADC-to-engineering-units transform stage
+ *
+ * The ADC used to deliver raw counts and every consumer applied its own
+ * conversion chain at read time - the same voltage divider multiplication ran
+ * once per read site, and two readers within the same tick could see different
+ * values if a fresh batch landed between them. Here each channel gets a small
+ * precompiled transform program (scale/offset, optionally a lookup table)
+ * which runs exactly once per sample batch in the slow ADC completion path;
+ * consumers read the finished engineering units.
+ *
+ * Default programs - counts to divided board volts - are compiled for every
+ * slow channel in use, and recompiled when the configuration version changes
+ * so divider coefficient edits keep working as before.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_ADC_TRANSFORMS
+
+#include "adc_transforms.h"
+#include "adc_inputs.h"
+#include "adc_math.h"
+#include "eficonsole.h"
+
+EXTERN_ENGINE
+;
+
+static Logging *logger;
+
+static adc_transform_s transforms[HW_MAX_ADC_INDEX];
+static float transformedValues[HW_MAX_ADC_INDEX];
+static bool valueReady[HW_MAX_ADC_INDEX];
+static int compiledForVersion = -1;
+
+void setAdcLinearTransform(adc_channel_e hwChannel, float scale, float offset) {
+	if (hwChannel <= EFI_ADC_NONE || hwChannel >= HW_MAX_ADC_INDEX) {
+		return;
+	}
+	adc_transform_s *program = &transforms[hwChannel];
+	program->scale = scale;
+	program->offset = offset;
+	program->type = ADC_TRANSFORM_LINEAR;
+}
+
+void setAdcLutTransform(adc_channel_e hwChannel, float scale, float offset,
+		float minInput, float maxInput, const float *values) {
+	if (hwChannel <= EFI_ADC_NONE || hwChannel >= HW_MAX_ADC_INDEX) {
+		return;
+	}
+	adc_transform_s *program = &transforms[hwChannel];
+	program->scale = scale;
+	program->offset = offset;
+	program->lutMinInput = minInput;
+	program->lutStep = (maxInput - minInput) / (ADC_TRANSFORM_LUT_SIZE - 1);
+	for (int i = 0; i < ADC_TRANSFORM_LUT_SIZE; i++) {
+		program->lutValues[i] = values[i];
+	}
+	program->type = ADC_TRANSFORM_LUT;
+}
+
+static float evaluateTransform(const adc_transform_s *program, float adcCounts) {
+	float linear = adcCounts * program->scale + program->offset;
+	if (program->type == ADC_TRANSFORM_LINEAR) {
+		return linear;
+	}
+	// LUT with linear interpolation between evenly spaced points
+	float position = (linear - program->lutMinInput) / program->lutStep;
+	if (position <= 0) {
+		return program->lutValues[0];
+	}
+	if (position >= ADC_TRANSFORM_LUT_SIZE - 1) {
+		return program->lutValues[ADC_TRANSFORM_LUT_SIZE - 1];
+	}
+	int index = (int)position;
+	float fraction = position - index;
+	return program->lutValues[index] * (1 - fraction) + program->lutValues[index + 1] * fraction;
+}
+
+/**
+ * the default program turns raw counts into divided board volts, which is what
+ * most read sites used to compute by hand on every read
+ */
+static void compileDefaultTransforms(void) {
+	float voltsPerCount = adcToVolts(1.0f);
+	for (int hwChannel = EFI_ADC_0; hwChannel < HW_MAX_ADC_INDEX; hwChannel++) {
+		if (getAdcChannelMode((adc_channel_e)hwChannel) != ADC_SLOW) {
+			continue;
+		}
+		if (transforms[hwChannel].type == ADC_TRANSFORM_LUT) {
+			// an explicitly registered curve survives recompilation
+			continue;
+		}
+		setAdcLinearTransform((adc_channel_e)hwChannel,
+				voltsPerCount * engineConfiguration->analogInputDividerCoefficient, 0);
+	}
+	compiledForVersion = engine->getGlobalConfigurationVersion();
+}
+
+void applyAdcTransforms(void) {
+	if (compiledForVersion != engine->getGlobalConfigurationVersion()) {
+		// divider coefficients may have changed, recompile the programs -
+		// this is the only place any configuration math happens
+		compileDefaultTransforms();
+	}
+	for (int hwChannel = EFI_ADC_0; hwChannel < HW_MAX_ADC_INDEX; hwChannel++) {
+		adc_transform_s *program = &transforms[hwChannel];
+		if (program->type == ADC_TRANSFORM_NONE) {
+			continue;
+		}
+		int counts = getInternalAdcValue("transform", (adc_channel_e)hwChannel);
+		transformedValues[hwChannel] = evaluateTransform(program, counts);
+		valueReady[hwChannel] = true;
+	}
+}
+
+bool hasAdcTransformedValue(adc_channel_e hwChannel) {
+	if (hwChannel <= EFI_ADC_NONE || hwChannel >= HW_MAX_ADC_INDEX) {
+		return false;
+	}
+	return valueReady[hwChannel];
+}
+
+float getAdcTransformedValue(adc_channel_e hwChannel) {
+	return transformedValues[hwChannel];
+}
+
+static void showAdcTransforms(void) {
+	for (int hwChannel = EFI_ADC_0; hwChannel < HW_MAX_ADC_INDEX; hwChannel++) {
+		adc_transform_s *program = &transforms[hwChannel];
+		if (program->type == ADC_TRANSFORM_NONE) {
+			continue;
+		}
+		scheduleMsg(logger, "ch%d %s scale=%f offset=%f value=%f", hwChannel,
+				program->type == ADC_TRANSFORM_LUT ? "LUT" : "linear",
+				program->scale, program->offset, transformedValues[hwChannel]);
+	}
+}
+
+void initAdcTransforms(Logging *sharedLogger) {
+	logger = sharedLogger;
+	addConsoleAction("adctransforms", showAdcTransforms);
+}
+
+#endif /* EFI_ADC_TRANSFORMS */
@@ -0,0 +1,56 @@
+/**
+ * @file	adc_transforms.h
+ * @brief	per-channel ADC-to-engineering-units transform stage, see adc_transforms.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+#include "engine.h"
+
+#if EFI_ADC_TRANSFORMS
+
+#define ADC_TRANSFORM_LUT_SIZE 16
+
+typedef enum {
+	ADC_TRANSFORM_NONE = 0,
+	/**
+	 * output = counts * scale + offset
+	 */
+	ADC_TRANSFORM_LINEAR,
+	/**
+	 * linear pre-scale into an evenly spaced lookup table with interpolation,
+	 * for channels whose whole conversion chain is a fixed curve
+	 */
+	ADC_TRANSFORM_LUT,
+} adc_transform_type_e;
+
+typedef struct {
+	adc_transform_type_e type;
+	float scale;
+	float offset;
+	float lutMinInput;
+	float lutStep;
+	float lutValues[ADC_TRANSFORM_LUT_SIZE];
+} adc_transform_s;
+
+void initAdcTransforms(Logging *sharedLogger);
+void setAdcLinearTransform(adc_channel_e hwChannel, float scale, float offset);
+void setAdcLutTransform(adc_channel_e hwChannel, float scale, float offset,
+		float minInput, float maxInput, const float *values);
+/**
+ * runs every registered program once against the freshly averaged batch,
+ * called from the slow ADC completion path
+ */
+void applyAdcTransforms(void);
+bool hasAdcTransformedValue(adc_channel_e hwChannel);
+/**
+ * @return engineering units computed at batch completion - every reader within
+ * a tick sees the same value
+ */
+float getAdcTransformedValue(adc_channel_e hwChannel);
+
+#endif /* EFI_ADC_TRANSFORMS */
@@ -54,3 +54,133 @@ void backupRamSave(backup_ram_e idx, uint32_t value) {
 	}
 #endif /* HAL_USE_RTC */
 }
+
+#if EFI_PROD_CODE && EFI_LEARNED_VALUE_STORE
+
+#include "cli_registry.h"
+#include "efilib.h"
+#include "loggingcentral.h"
+
+/**
+ * Learned values live in BKP5R..BKP8R as raw float bit patterns, with a magic/version
+ * word in BKP2R and a xor checksum in BKP9R. The shadow copy below is what producers
+ * and consumers actually touch - backup register writes only happen in
+ * commitLearnedValuesIfNeeded once some value has drifted past its commit threshold,
+ * so a converged engine stops touching the registers entirely.
+ *
+ * BKP0R/BKP1R are taken by the word-level slots above and BKP4R is reserved for the
+ * DFU jump flag.
+ */
+
+#define LEARNED_VALUES_MAGIC 0x4C524E01
+
+static Logging logger("learn");
+
+static float learnedShadow[LEARNED_VALUE_COUNT];
+static float committedValues[LEARNED_VALUE_COUNT];
+static bool isLearnedValid[LEARNED_VALUE_COUNT];
+static int learnedCommitCounter = 0;
+
+static const char *learnedValueNames[LEARNED_VALUE_COUNT] = {
+		"idle integrator",
+		"fuel trim",
+		"ETB offset",
+};
+
+/**
+ * a value has to move at least this far from the last committed snapshot before
+ * we pay for another backup register batch
+ */
+static const float commitThresholds[LEARNED_VALUE_COUNT] = {
+		0.25, // percent of idle valve position
+		0.5,  // percent of fuel trim
+		0.1,  // percent of throttle position
+};
+
+#if HAL_USE_RTC
+static uint32_t floatToWord(float value) {
+	uint32_t result;
+	memcpy(&result, &value, sizeof(result));
+	return result;
+}
+
+static float wordToFloat(uint32_t word) {
+	float result;
+	memcpy(&result, &word, sizeof(result));
+	return result;
+}
+
+static uint32_t learnedChecksum(uint32_t w0, uint32_t w1, uint32_t w2) {
+	return LEARNED_VALUES_MAGIC ^ w0 ^ w1 ^ w2;
+}
+
+static void commitLearnedValues(void) {
+	uint32_t w0 = floatToWord(learnedShadow[LEARNED_IDLE_INTEGRATOR]);
+	uint32_t w1 = floatToWord(learnedShadow[LEARNED_FUEL_TRIM]);
+	uint32_t w2 = floatToWord(learnedShadow[LEARNED_ETB_OFFSET]);
+	RTCD1.rtc->BKP2R = LEARNED_VALUES_MAGIC;
+	RTCD1.rtc->BKP5R = w0;
+	RTCD1.rtc->BKP6R = w1;
+	RTCD1.rtc->BKP7R = w2;
+	RTCD1.rtc->BKP9R = learnedChecksum(w0, w1, w2);
+	for (int i = 0; i < LEARNED_VALUE_COUNT; i++) {
+		committedValues[i] = learnedShadow[i];
+	}
+	learnedCommitCounter++;
+}
+#endif /* HAL_USE_RTC */
+
+bool hasLearnedValue(learned_value_e idx) {
+	return isLearnedValid[idx];
+}
+
+float getLearnedValue(learned_value_e idx) {
+	return learnedShadow[idx];
+}
+
+void setLearnedValue(learned_value_e idx, float value) {
+	learnedShadow[idx] = value;
+	isLearnedValid[idx] = true;
+}
+
+void commitLearnedValuesIfNeeded(void) {
+#if HAL_USE_RTC
+	for (int i = 0; i < LEARNED_VALUE_COUNT; i++) {
+		if (isLearnedValid[i] && absF(learnedShadow[i] - committedValues[i]) > commitThresholds[i]) {
+			// one value moved, commit the whole batch
+			commitLearnedValues();
+			return;
+		}
+	}
+#endif /* HAL_USE_RTC */
+}
+
+static void printLearnedValues(void) {
+	for (int i = 0; i < LEARNED_VALUE_COUNT; i++) {
+		scheduleMsg(&logger, "%s: %.3f committed=%.3f %s", learnedValueNames[i],
+				learnedShadow[i], committedValues[i],
+				isLearnedValid[i] ? "valid" : "empty");
+	}
+	scheduleMsg(&logger, "%d commit batch(es)", learnedCommitCounter);
+}
+
+void initLearnedValues(void) {
+#if HAL_USE_RTC
+	if (RTCD1.rtc->BKP2R == LEARNED_VALUES_MAGIC) {
+		uint32_t w0 = RTCD1.rtc->BKP5R;
+		uint32_t w1 = RTCD1.rtc->BKP6R;
+		uint32_t w2 = RTCD1.rtc->BKP7R;
+		if (RTCD1.rtc->BKP9R == learnedChecksum(w0, w1, w2)) {
+			learnedShadow[LEARNED_IDLE_INTEGRATOR] = committedValues[LEARNED_IDLE_INTEGRATOR] = wordToFloat(w0);
+			learnedShadow[LEARNED_FUEL_TRIM] = committedValues[LEARNED_FUEL_TRIM] = wordToFloat(w1);
+			learnedShadow[LEARNED_ETB_OFFSET] = committedValues[LEARNED_ETB_OFFSET] = wordToFloat(w2);
+			for (int i = 0; i < LEARNED_VALUE_COUNT; i++) {
+				isLearnedValid[i] = true;
+			}
+		}
+	}
+#endif /* HAL_USE_RTC */
+	addConsoleAction("learninfo", printLearnedValues);
+}
+
+#endif /* EFI_PROD_CODE && EFI_LEARNED_VALUE_STORE */
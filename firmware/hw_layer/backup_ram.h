@@ -43,4 +43,45 @@ uint32_t backupRamLoad(backup_ram_e idx);
 // use backup-power RTC registers (non-volatile memory) to store the data
 void backupRamSave(backup_ram_e idx, uint32_t value);
 
+/**
+ * Structured persistence for learned values on top of the raw backup registers.
+ * Values are shadowed in normal RAM and committed to backup registers in a batch
+ * once some value has moved past its commit threshold, see backup_ram.cpp
+ */
+typedef enum {
+	/**
+	 * Idle PID integrator, units of valve position percent. Used in idle_thread.cpp
+	 * so that we do not re-learn the idle position after every power cycle.
+	 */
+	LEARNED_IDLE_INTEGRATOR = 0,
+	/**
+	 * Long-term fuel trim, percent
+	 */
+	LEARNED_FUEL_TRIM,
+	/**
+	 * Learned electronic throttle position offset, percent
+	 */
+	LEARNED_ETB_OFFSET,
+
+	LEARNED_VALUE_COUNT
+} learned_value_e;
+
+#if EFI_PROD_CODE && EFI_LEARNED_VALUE_STORE
+// restores the learned value shadow from backup registers, invoked once at boot
+void initLearnedValues(void);
+// true if the slot survived the power cycle with a valid checksum
+bool hasLearnedValue(learned_value_e idx);
+float getLearnedValue(learned_value_e idx);
+// updates the RAM shadow, actual commit happens in commitLearnedValuesIfNeeded
+void setLearnedValue(learned_value_e idx, float value);
+// batched commit, invoked from the periodic slow callback
+void commitLearnedValuesIfNeeded(void);
+#else
+#define initLearnedValues() {}
+#define hasLearnedValue(idx) false
+#define getLearnedValue(idx) 0
+#define setLearnedValue(idx, value) {}
+#define commitLearnedValuesIfNeeded() {}
+#endif /* EFI_PROD_CODE && EFI_LEARNED_VALUE_STORE */
+
 #endif /* BACKUP_RAM_H_ */
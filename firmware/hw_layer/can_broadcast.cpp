@@ -0,0 +1,85 @@
+/**
+ * @file	can_broadcast.cpp
+ * @brief	Table-driven CAN frame broadcast engine
+ *
+ * The hand-written dash methods in can_hw.cpp used to re-read every sensor for every
+ * frame and assemble payloads field by field. Here a dash protocol is a constant table
+ * of packing instructions: signal source, scale, offset, target byte and width. The
+ * source values are sampled once per tick into a small vector and the per-frame work
+ * is a tight loop over the instruction table - no per-field function calls, and the
+ * tables live in flash next to each other so the cache behaves.
+ *
+ * @date May 2, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_CAN_SUPPORT
+
+#include "can_broadcast.h"
+#include "can_hw.h"
+#include "engine.h"
+#include "allsensors.h"
+#include "vehicle_speed.h"
+
+EXTERN_ENGINE
+;
+
+extern CANTxFrame txmsg;
+
+static float signalValues[CAN_SIG_COUNT];
+
+static void refreshSignalValues(void) {
+	signalValues[CAN_SIG_CONSTANT] = 0;
+	signalValues[CAN_SIG_RPM] = GET_RPM();
+	signalValues[CAN_SIG_CLT] = getCoolantTemperature();
+	signalValues[CAN_SIG_VSS] = getVehicleSpeed();
+}
+
+/**
+ * per-frame schedule state. A layout switch (different dash protocol selected) resets
+ * the schedule so every frame of the new protocol goes out right away.
+ */
+static const can_frame_layout_s *activeLayouts = nullptr;
+static efitime_t lastBroadcastNt[CAN_BROADCAST_MAX_FRAMES];
+
+static void executeFrameProgram(const can_frame_layout_s *frame) {
+	commonTxInit(frame->eid);
+	for (int i = 0; i < frame->opCount; i++) {
+		const can_signal_op_s *op = &frame->ops[i];
+		int32_t raw = (int32_t)(signalValues[op->source] * op->scale + op->add);
+		if (op->size == 2) {
+			uint16_t value16 = op->isBigEndian ? SWAP_UINT16(raw) : (uint16_t)raw;
+			txmsg.data8[op->target] = value16 & 0xFF;
+			txmsg.data8[op->target + 1] = value16 >> 8;
+		} else {
+			txmsg.data8[op->target] = (uint8_t)raw;
+		}
+	}
+	sendCanMessage(frame->dlc);
+}
+
+void runCanBroadcast(const can_frame_layout_s *layouts, int count, efitime_t nowNt) {
+	if (count > CAN_BROADCAST_MAX_FRAMES) {
+		warning(CUSTOM_ERR_CAN_CONFIGURATION, "CAN broadcast table too long: %d", count);
+		return;
+	}
+	if (layouts != activeLayouts) {
+		activeLayouts = layouts;
+		memset(lastBroadcastNt, 0, sizeof(lastBroadcastNt));
+	}
+
+	refreshSignalValues();
+
+	for (int i = 0; i < count; i++) {
+		const can_frame_layout_s *frame = &layouts[i];
+		if (nowNt - lastBroadcastNt[i] < MS2NT(frame->periodMs)) {
+			continue;
+		}
+		lastBroadcastNt[i] = nowNt;
+		executeFrameProgram(frame);
+	}
+}
+
+#endif /* EFI_CAN_SUPPORT */
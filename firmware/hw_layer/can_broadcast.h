@@ -0,0 +1,63 @@
+/**
+ * @file	can_broadcast.h
+ * @brief	Table-driven CAN frame broadcast engine, see can_broadcast.cpp
+ *
+ * @date May 2, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+#if EFI_CAN_SUPPORT
+
+/**
+ * Value sources a broadcast signal can pull from. Each source is sampled exactly once
+ * per broadcast tick no matter how many frames consume it.
+ */
+typedef enum {
+	CAN_SIG_CONSTANT = 0,
+	CAN_SIG_RPM,
+	CAN_SIG_CLT,
+	CAN_SIG_VSS,
+
+	CAN_SIG_COUNT
+} can_signal_source_e;
+
+/**
+ * One packing instruction: raw = source * scale + add, written as 'size' bytes at
+ * 'target' within the frame payload. Constants are expressed as CAN_SIG_CONSTANT with
+ * the value in 'add'.
+ */
+typedef struct {
+	uint8_t source;	// can_signal_source_e
+	uint8_t target;	// byte offset within the 8 byte payload
+	uint8_t size;	// 1 or 2 bytes
+	uint8_t isBigEndian;	// 16-bit signals are little-endian unless this is set
+	float scale;
+	float add;
+} can_signal_op_s;
+
+typedef struct {
+	int eid;
+	uint8_t dlc;
+	uint8_t opCount;
+	/**
+	 * each frame runs on its own schedule: a slow temperature frame does not have to
+	 * ride at the RPM frame rate
+	 */
+	uint16_t periodMs;
+	const can_signal_op_s *ops;
+} can_frame_layout_s;
+
+// enough for any of the supported dash protocols
+#define CAN_BROADCAST_MAX_FRAMES 16
+
+/**
+ * Executes the packing program of every due frame against the current signal values.
+ * Invoked from the CAN TX periodic task with its timestamp.
+ */
+void runCanBroadcast(const can_frame_layout_s *layouts, int count, efitime_t nowNt);
+
+#endif /* EFI_CAN_SUPPORT */
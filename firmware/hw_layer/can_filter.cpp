@@ -0,0 +1,117 @@
+/**
+ * @file	can_filter.cpp
+ * @brief	CAN RX filter management
+ *
+ * Consumers interested in inbound CAN traffic (OBD2 request handler, CAN
+ * sensors) subscribe to identifiers here. The subscriptions are programmed
+ * into the bxCAN hardware filter banks so that on a busy vehicle bus the RX
+ * thread only wakes for frames somebody actually asked for; frames which do
+ * make it through are matched once more in software to maintain per-filter
+ * statistics and to cover ports without hardware filter support.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_CAN_SUPPORT
+
+#include "can_filter.h"
+
+static can_filter_s filters[CAN_FILTER_COUNT];
+static int filterCount = 0;
+/**
+ * true while every subscription is backed by a hardware bank: with this false
+ * the hardware stays wide open and canFilterAccept() does all the work
+ */
+static bool isHardwareFilteringActive = false;
+
+void resetCanFilters(void) {
+	memset(filters, 0, sizeof(filters));
+	filterCount = 0;
+	isHardwareFilteringActive = false;
+}
+
+/**
+ * @return the new subscription, or NULL if we are out of slots
+ */
+can_filter_s *addCanSidFilter(uint32_t sid, uint32_t mask, const char *name) {
+	if (filterCount >= CAN_FILTER_COUNT) {
+		warning(CUSTOM_ERR_CAN_CONFIGURATION, "too many CAN filters: %s", name);
+		return NULL;
+	}
+	can_filter_s *filter = &filters[filterCount++];
+	filter->sid = sid;
+	filter->mask = mask;
+	filter->name = name;
+	filter->matchCounter = 0;
+	filter->isInHardware = false;
+	return filter;
+}
+
+/**
+ * Program the subscriptions into the bxCAN filter banks. To be invoked after
+ * canStart() and after all addCanSidFilter() calls.
+ */
+void applyCanFilters(CANDriver *device) {
+#if defined(STM32F4XX) || defined(STM32F7XX)
+	if (filterCount == 0) {
+		// nobody subscribed, leave the reset-default accept-all bank alone
+		return;
+	}
+	CANFilter hwFilters[CAN_FILTER_COUNT];
+	for (int i = 0; i < filterCount; i++) {
+		CANFilter *hwFilter = &hwFilters[i];
+		hwFilter->filter = i;
+		hwFilter->mode = 0; // mask mode
+		hwFilter->scale = 1; // single 32 bit filter per bank
+		hwFilter->assignment = 0; // FIFO0, the only one we read
+		/**
+		 * in 32 bit scale STID lives in bits 31:21, bit 2 is IDE which we
+		 * include into the mask to only match standard identifiers
+		 */
+		hwFilter->register1 = filters[i].sid << 21;
+		hwFilter->register2 = (filters[i].mask << 21) | 0x4;
+		filters[i].isInHardware = true;
+	}
+	canSTM32SetFilters(device, CAN_FILTER_COUNT, filterCount, hwFilters);
+	isHardwareFilteringActive = true;
+#else
+	// no hardware filter support on this port, canFilterAccept() does the job
+	UNUSED(device);
+#endif
+}
+
+/**
+ * Software matching: drops frames the hardware could not filter out and keeps
+ * the per-filter statistics
+ * @return true if anybody subscribed to this frame
+ */
+bool canFilterAccept(const CANRxFrame *frame) {
+	if (filterCount == 0) {
+		// no subscriptions at all means promiscuous mode
+		return true;
+	}
+	bool accept = false;
+	for (int i = 0; i < filterCount; i++) {
+		if ((frame->SID & filters[i].mask) == (filters[i].sid & filters[i].mask)) {
+			filters[i].matchCounter++;
+			// no early return, a frame may match several subscriptions
+			accept = true;
+		}
+	}
+	return accept;
+}
+
+void printCanFilters(Logging *logging) {
+	scheduleMsg(logging, "CAN RX hardware filtering: %s", boolToString(isHardwareFilteringActive));
+	for (int i = 0; i < filterCount; i++) {
+		can_filter_s *filter = &filters[i];
+		scheduleMsg(logging, "filter %d %s: SID 0x%03x mask 0x%03x matched %d %s", i, filter->name,
+				filter->sid, filter->mask, filter->matchCounter,
+				filter->isInHardware ? "(hw)" : "(sw)");
+	}
+}
+
+#endif /* EFI_CAN_SUPPORT */
@@ -0,0 +1,52 @@
+/**
+ * @file	can_filter.h
+ * @brief	CAN RX filter management
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#ifndef CAN_FILTER_H_
+#define CAN_FILTER_H_
+
+#include "global.h"
+
+#if EFI_CAN_SUPPORT
+
+#include "datalogging.h"
+
+/**
+ * bxCAN has 28 filter banks shared between CAN1 and CAN2, we only ever claim
+ * a few of them so that board-specific code can use the rest
+ */
+#define CAN_FILTER_COUNT 8
+
+typedef struct {
+	/**
+	 * standard 11 bit identifier to subscribe to
+	 */
+	uint32_t sid;
+	/**
+	 * identifier bits which have to match, 0x7FF for an exact SID subscription
+	 */
+	uint32_t mask;
+	const char *name;
+	/**
+	 * number of received frames matched by this subscription
+	 */
+	int matchCounter;
+	/**
+	 * true once this subscription is backed by a hardware filter bank
+	 */
+	bool isInHardware;
+} can_filter_s;
+
+void resetCanFilters(void);
+can_filter_s *addCanSidFilter(uint32_t sid, uint32_t mask, const char *name);
+void applyCanFilters(CANDriver *device);
+bool canFilterAccept(const CANRxFrame *frame);
+void printCanFilters(Logging *logging);
+
+#endif /* EFI_CAN_SUPPORT */
+
+#endif /* CAN_FILTER_H_ */
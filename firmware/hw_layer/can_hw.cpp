@@ -17,6 +17,9 @@
 #include "periodic_thread_controller.h"
 #include "pin_repository.h"
 #include "can_hw.h"
+#include "can_filter.h"
+#include "can_broadcast.h"
+#include "can_state_sync.h"
 #include "string.h"
 #include "obd2.h"
 #include "mpu_util.h"
@@ -30,7 +33,7 @@ static int canReadCounter = 0;
 static int canWriteOk = 0;
 static int canWriteNotOk = 0;
 static bool isCanEnabled = false;
-static LoggingWithStorage logger("CAN driver");
+static Logging logger("CAN driver");
 
 // Values below calculated with http://www.bittiming.can-wiki.info/
 // Pick ST micro bxCAN
@@ -127,20 +130,30 @@ void sendCanMessage(int size) {
 	}
 }
 
-static void canDashboardBMW(void) {
-	//BMW Dashboard
-	commonTxInit(CAN_BMW_E46_SPEED);
-	setShortValue(&txmsg, 10 * 8, 1);
-	sendCanMessage();
+/**
+ * BMW/Fiat/VAG dashboards are plain linear signals, so they are expressed as packing
+ * tables executed by the broadcast engine - see can_broadcast.cpp. Mazda RX8 needs
+ * warning-light bit logic and stays hand-written below.
+ *
+ * All frames currently ride at the legacy 50ms cadence, but each entry carries its
+ * own period so e.g. a coolant frame can be slowed down independently.
+ */
 
-	commonTxInit(CAN_BMW_E46_RPM);
-	setShortValue(&txmsg, (int) (GET_RPM() * 6.4), 2);
-	sendCanMessage();
+static const can_signal_op_s bmwSpeedOps[] = {
+	{ CAN_SIG_CONSTANT, 1, 2, false, 0, 10 * 8 },
+};
+static const can_signal_op_s bmwRpmOps[] = {
+	{ CAN_SIG_RPM, 2, 2, false, 6.4f, 0 },
+};
+static const can_signal_op_s bmwDme2Ops[] = {
+	{ CAN_SIG_CLT, 1, 2, false, 1 / 0.75f, 48.373f / 0.75f },
+};
 
-	commonTxInit(CAN_BMW_E46_DME2);
-	setShortValue(&txmsg, (int) ((getCoolantTemperature() + 48.373) / 0.75), 1);
-	sendCanMessage();
-}
+static const can_frame_layout_s bmwDashLayout[] = {
+	{ CAN_BMW_E46_SPEED, 8, efi::size(bmwSpeedOps), 50, bmwSpeedOps },
+	{ CAN_BMW_E46_RPM, 8, efi::size(bmwRpmOps), 50, bmwRpmOps },
+	{ CAN_BMW_E46_DME2, 8, efi::size(bmwDme2Ops), 50, bmwDme2Ops },
+};
 
 static void canMazdaRX8(void) {
 	commonTxInit(CAN_MAZDA_RX_STEERING_WARNING);
@@ -187,32 +200,34 @@ static void canMazdaRX8(void) {
 	sendCanMessage();
 }
 
-static void canDashboardFiat(void) {
-	//Fiat Dashboard
-	commonTxInit(CAN_FIAT_MOTOR_INFO);
-	setShortValue(&txmsg, (int) (getCoolantTemperature() - 40), 3); //Coolant Temp
-	setShortValue(&txmsg, GET_RPM() / 32, 6); //RPM
-	sendCanMessage();
-}
-
-static void canDashboardVAG(void) {
-	//VAG Dashboard
-	commonTxInit(CAN_VAG_RPM);
-	setShortValue(&txmsg, GET_RPM() * 4, 2); //RPM
-	sendCanMessage();
+static const can_signal_op_s fiatMotorInfoOps[] = {
+	{ CAN_SIG_CLT, 3, 2, false, 1, -40 },	// Coolant Temp
+	{ CAN_SIG_RPM, 6, 2, false, 1 / 32.0f, 0 },	// RPM
+};
 
-	commonTxInit(CAN_VAG_CLT);
-	setShortValue(&txmsg, (int) ((getCoolantTemperature() + 48.373) / 0.75), 1); //Coolant Temp
-	sendCanMessage();
+static const can_frame_layout_s fiatDashLayout[] = {
+	{ CAN_FIAT_MOTOR_INFO, 8, efi::size(fiatMotorInfoOps), 50, fiatMotorInfoOps },
+};
 
-	commonTxInit(CAN_VAG_CLT_V2);
-		setShortValue(&txmsg, (int) ((getCoolantTemperature() + 48.373) / 0.75), 4); //Coolant Temp
-		sendCanMessage();
+static const can_signal_op_s vagRpmOps[] = {
+	{ CAN_SIG_RPM, 2, 2, false, 4, 0 },	// RPM
+};
+static const can_signal_op_s vagCltOps[] = {
+	{ CAN_SIG_CLT, 1, 2, false, 1 / 0.75f, 48.373f / 0.75f },	// Coolant Temp
+};
+static const can_signal_op_s vagCltV2Ops[] = {
+	{ CAN_SIG_CLT, 4, 2, false, 1 / 0.75f, 48.373f / 0.75f },	// Coolant Temp
+};
+static const can_signal_op_s vagImmoOps[] = {
+	{ CAN_SIG_CONSTANT, 1, 2, false, 0, 0x80 },
+};
 
-	commonTxInit(CAN_VAG_IMMO);
-		setShortValue(&txmsg, 0x80, 1);
-		sendCanMessage();
-}
+static const can_frame_layout_s vagDashLayout[] = {
+	{ CAN_VAG_RPM, 8, efi::size(vagRpmOps), 50, vagRpmOps },
+	{ CAN_VAG_CLT, 8, efi::size(vagCltOps), 50, vagCltOps },
+	{ CAN_VAG_CLT_V2, 8, efi::size(vagCltV2Ops), 50, vagCltV2Ops },
+	{ CAN_VAG_IMMO, 8, efi::size(vagImmoOps), 50, vagImmoOps },
+};
 
 class CanWrite final : public PeriodicController<256> {
 public:
@@ -222,15 +237,17 @@ public:
 	}
 
 	void PeriodicTask(efitime_t nowNt) {
+		canSyncPeriodic(nowNt);
+
 		switch (engineConfiguration->canNbcType) {
 		case CAN_BUS_NBC_BMW:
-			canDashboardBMW();
+			runCanBroadcast(bmwDashLayout, efi::size(bmwDashLayout), nowNt);
 			break;
 		case CAN_BUS_NBC_FIAT:
-			canDashboardFiat();
+			runCanBroadcast(fiatDashLayout, efi::size(fiatDashLayout), nowNt);
 			break;
 		case CAN_BUS_NBC_VAG:
-			canDashboardVAG();
+			runCanBroadcast(vagDashLayout, efi::size(vagDashLayout), nowNt);
 			break;
 		case CAN_BUS_MAZDA_RX8:
 			canMazdaRX8();
@@ -258,6 +275,18 @@ public:
 			return;
 		}
 
+		/**
+		 * everything this thread cares about below is subscribed here so the
+		 * hardware drops the rest of the bus traffic before we ever wake up
+		 */
+		resetCanFilters();
+		// TODO: if/when we support multiple lambda sensors, widen the mask to 0x0180 + N
+		addCanSidFilter(0x0180, 0x7FF, "AEM lambda");
+		addCanSidFilter(OBD_TEST_REQUEST, 0x7FF, "OBD request");
+		addCanSidFilter(CAN_BMW_E46_CLUSTER_STATUS, 0x7FF, "BMW cluster");
+		addCanSidFilter(CAN_SYNC_BASE_SID, CAN_SYNC_SID_MASK, "state sync");
+		applyCanFilters(device);
+
 		while (true) {
 			// Block until we get a message
 			msg_t result = canReceiveTimeout(device, CAN_ANY_MAILBOX, &m_buffer, TIME_INFINITE);
@@ -269,9 +298,16 @@ public:
 			// Process the message
 			canReadCounter++;
 
+			if (!canFilterAccept(&m_buffer)) {
+				// software fallback for ports without hardware filtering
+				continue;
+			}
+
 			// TODO: if/when we support multiple lambda sensors, sensor N
 			// has address 0x0180 + N where N = [0, 15]
-			if (m_buffer.SID == 0x0180) {
+			if (canSyncOnRx(&m_buffer, getTimeNowNt())) {
+				// consumed by the state sync subscriber
+			} else if (m_buffer.SID == 0x0180) {
 				// AEM x-series lambda sensor reports in 0.0001 lambda per bit
 				uint16_t lambdaInt = SWAP_UINT16(m_buffer.data16[0]);
 				aemXSeriesLambda = 0.0001f * lambdaInt;
@@ -303,6 +339,7 @@ static void canInfo(void) {
 			engineConfiguration->canSleepPeriodMs);
 
 	scheduleMsg(&logger, "CAN rx_cnt=%d/tx_ok=%d/tx_not_ok=%d", canReadCounter, canWriteOk, canWriteNotOk);
+	printCanFilters(&logger);
 }
 
 void setCanType(int type) {
@@ -336,6 +373,7 @@ void startCanPins(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 
 void initCan(void) {
 	addConsoleAction("caninfo", canInfo);
+	initCanStateSync();
 
 	isCanEnabled = 
 		(CONFIG(canTxPin) != GPIO_UNASSIGNED) && // both pins are set...
@@ -0,0 +1,261 @@
+/**
+ * @file	can_state_sync.cpp
+ * @brief	inter-ECU state sync over CAN with bounded-latency delta frames
+ *
+ * Multi-ECU installs (front ECU plus dash logger plus gearbox controller) share a
+ * subset of engine state over the bus. Each node owns a small SID block and
+ * publishes its state as two frames of a six byte image each; a frame carries a
+ * sequence number, a change mask and only the image bytes which moved since the
+ * last transmission. An unchanged frame is not sent at all until its deadline
+ * expires, at which point a full keyframe goes out so subscribers can tell a
+ * quiet publisher from a dead one and late joiners can resync. At a steady
+ * operating point this keeps a four node network around one keyframe per node
+ * per deadline - comfortably inside 10% utilization at 500k - while a moving
+ * signal still updates at the full TX task rate.
+ *
+ * The subscriber side reconstructs per-node mirrors from the masks. A sequence
+ * gap invalidates the mirror until the next keyframe repairs it, so a lost delta
+ * can never leave a stale byte pretending to be fresh.
+ *
+ *     set_can_sync_enabled <0/1>
+ *     set_can_sync_node_id <0..3>
+ *     set_can_sync_deadline_ms <ms>
+ *     cansyncinfo
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_CAN_SUPPORT
+
+#include "can_state_sync.h"
+#include "can_hw.h"
+#include "engine.h"
+#include "allsensors.h"
+#include "map.h"
+#include "tps.h"
+#include "eficonsole.h"
+
+EXTERN_ENGINE
+;
+
+extern CANTxFrame txmsg;
+
+static Logging logger("CAN sync");
+
+#define CAN_SYNC_DEFAULT_DEADLINE_MS 200
+
+static bool syncEnabled = false;
+static int localNodeId = 0;
+static int deadlineMs = CAN_SYNC_DEFAULT_DEADLINE_MS;
+
+/**
+ * publisher schedule state, one slot per local frame
+ */
+static uint8_t lastTxImage[CAN_SYNC_FRAME_COUNT][CAN_SYNC_IMAGE_SIZE];
+static efitime_t lastTxNt[CAN_SYNC_FRAME_COUNT];
+static uint8_t txSeq[CAN_SYNC_FRAME_COUNT];
+static bool keyframePending[CAN_SYNC_FRAME_COUNT] = { true, true };
+
+static int txFrameCounter = 0;
+static int txSkippedCounter = 0;
+static int txBytesSavedCounter = 0;
+
+static can_sync_mirror_s mirrors[CAN_SYNC_MAX_NODES][CAN_SYNC_FRAME_COUNT];
+static int rxFrameCounter = 0;
+static int rxStaleDropCounter = 0;
+
+static void setShort(uint8_t image[], int offset, int value) {
+	image[offset] = value & 0xFF;
+	image[offset + 1] = (value >> 8) & 0xFF;
+}
+
+static int getShort(const uint8_t image[], int offset) {
+	return image[offset] | (image[offset + 1] << 8);
+}
+
+/**
+ * the published subset of engine state. Frame 0 carries the signals which move
+ * within an engine cycle, frame 1 the slower control outputs - under delta
+ * gating the split means a temperature drift does not retransmit the RPM bytes.
+ */
+static void buildImage(int frameIndex, uint8_t image[CAN_SYNC_IMAGE_SIZE]) {
+	if (frameIndex == 0) {
+		setShort(image, 0, GET_RPM());
+		float map = getMap(PASS_ENGINE_PARAMETER_SIGNATURE);
+		setShort(image, 2, cisnan(map) ? 0 : (int)(map * 10));
+		float tps = getTPS(PASS_ENGINE_PARAMETER_SIGNATURE);
+		image[4] = cisnan(tps) ? 0 : (uint8_t)tps;
+		image[5] = (uint8_t)(getCoolantTemperature() + 40);
+	} else {
+		setShort(image, 0, (int)(ENGINE(engineState.timingAdvance) * 10));
+		setShort(image, 2, (int)(ENGINE(engineState.currentRawVE) * 10));
+		setShort(image, 4, (int)(ENGINE(sensors.vBatt) * 100));
+	}
+}
+
+static void transmitFrame(int frameIndex, const uint8_t image[CAN_SYNC_IMAGE_SIZE], uint8_t mask) {
+	commonTxInit(CAN_SYNC_BASE_SID + localNodeId * CAN_SYNC_NODE_STRIDE + frameIndex);
+	txmsg.data8[0] = txSeq[frameIndex]++;
+	txmsg.data8[1] = mask;
+	int size = 2;
+	for (int i = 0; i < CAN_SYNC_IMAGE_SIZE; i++) {
+		if (mask & (1 << i)) {
+			txmsg.data8[size++] = image[i];
+		}
+	}
+	sendCanMessage(size);
+	txFrameCounter++;
+	txBytesSavedCounter += CAN_SYNC_IMAGE_SIZE + 2 - size;
+}
+
+void canSyncPeriodic(efitime_t nowNt) {
+	if (!syncEnabled) {
+		return;
+	}
+	for (int frameIndex = 0; frameIndex < CAN_SYNC_FRAME_COUNT; frameIndex++) {
+		uint8_t image[CAN_SYNC_IMAGE_SIZE];
+		buildImage(frameIndex, image);
+
+		uint8_t mask = 0;
+		for (int i = 0; i < CAN_SYNC_IMAGE_SIZE; i++) {
+			if (image[i] != lastTxImage[frameIndex][i]) {
+				mask |= 1 << i;
+			}
+		}
+
+		bool deadlineExpired = nowNt - lastTxNt[frameIndex] >= MS2NT(deadlineMs);
+		if (deadlineExpired || keyframePending[frameIndex]) {
+			// keyframes double as the liveness heartbeat and the resync point
+			mask = CAN_SYNC_FULL_MASK;
+			keyframePending[frameIndex] = false;
+		} else if (mask == 0) {
+			txSkippedCounter++;
+			continue;
+		}
+
+		memcpy(lastTxImage[frameIndex], image, CAN_SYNC_IMAGE_SIZE);
+		lastTxNt[frameIndex] = nowNt;
+		transmitFrame(frameIndex, image, mask);
+	}
+}
+
+bool canSyncOnRx(const CANRxFrame *frame, efitick_t nowNt) {
+	if ((frame->SID & CAN_SYNC_SID_MASK) != CAN_SYNC_BASE_SID) {
+		return false;
+	}
+	int node = (frame->SID - CAN_SYNC_BASE_SID) / CAN_SYNC_NODE_STRIDE;
+	int frameIndex = frame->SID % CAN_SYNC_NODE_STRIDE;
+	if (frameIndex >= CAN_SYNC_FRAME_COUNT || frame->DLC < 2) {
+		// inside our SID block but not a frame we understand, still consumed
+		return true;
+	}
+	if (node == localNodeId) {
+		// our own transmission looped back
+		return true;
+	}
+	rxFrameCounter++;
+
+	can_sync_mirror_s *mirror = &mirrors[node][frameIndex];
+	uint8_t seq = frame->data8[0];
+	uint8_t mask = frame->data8[1];
+	uint8_t gap = (uint8_t)(seq - mirror->lastSeq - 1);
+	if (mirror->lastUpdateNt == 0) {
+		// first contact with this publisher, there is no history to have missed
+		gap = 0;
+	}
+	mirror->lastSeq = seq;
+	mirror->missedFrameCounter += gap;
+
+	if (mask == CAN_SYNC_FULL_MASK) {
+		// a keyframe repairs the image no matter what was lost before it
+		mirror->valid = true;
+	} else if (gap != 0 || !mirror->valid) {
+		// a delta over a broken image would plant stale bytes, wait for a keyframe
+		mirror->valid = false;
+		rxStaleDropCounter++;
+		return true;
+	}
+
+	int at = 2;
+	for (int i = 0; i < CAN_SYNC_IMAGE_SIZE; i++) {
+		if (mask & (1 << i)) {
+			mirror->image[i] = frame->data8[at++];
+		}
+	}
+	mirror->lastUpdateNt = nowNt;
+	return true;
+}
+
+const can_sync_mirror_s *getCanSyncMirror(int node, int frameIndex) {
+	if (node < 0 || node >= CAN_SYNC_MAX_NODES || frameIndex < 0 || frameIndex >= CAN_SYNC_FRAME_COUNT) {
+		return NULL;
+	}
+	return &mirrors[node][frameIndex];
+}
+
+float getCanSyncRemoteRpm(int node, efitick_t nowNt) {
+	const can_sync_mirror_s *mirror = getCanSyncMirror(node, 0);
+	if (mirror == NULL || !mirror->valid) {
+		return NAN;
+	}
+	// two missed deadlines means the publisher is gone, not quiet
+	if (nowNt - mirror->lastUpdateNt > MS2NT(2 * deadlineMs)) {
+		return NAN;
+	}
+	return getShort(mirror->image, 0);
+}
+
+static void setSyncEnabled(int value) {
+	syncEnabled = value != 0;
+	if (syncEnabled) {
+		// restart with keyframes so subscribers do not apply deltas to thin air
+		for (int frameIndex = 0; frameIndex < CAN_SYNC_FRAME_COUNT; frameIndex++) {
+			keyframePending[frameIndex] = true;
+		}
+	}
+	scheduleMsg(&logger, "CAN sync %s", boolToString(syncEnabled));
+}
+
+static void setSyncNodeId(int value) {
+	if (value < 0 || value >= CAN_SYNC_MAX_NODES) {
+		scheduleMsg(&logger, "invalid CAN sync node id %d", value);
+		return;
+	}
+	localNodeId = value;
+}
+
+static void setSyncDeadlineMs(int value) {
+	deadlineMs = maxI(10, value);
+}
+
+static void canSyncInfo(void) {
+	scheduleMsg(&logger, "CAN sync %s node=%d deadline=%dms", boolToString(syncEnabled),
+			localNodeId, deadlineMs);
+	scheduleMsg(&logger, "TX frames=%d skipped=%d bytes_saved=%d RX frames=%d stale_drops=%d",
+			txFrameCounter, txSkippedCounter, txBytesSavedCounter, rxFrameCounter,
+			rxStaleDropCounter);
+	for (int node = 0; node < CAN_SYNC_MAX_NODES; node++) {
+		for (int frameIndex = 0; frameIndex < CAN_SYNC_FRAME_COUNT; frameIndex++) {
+			can_sync_mirror_s *mirror = &mirrors[node][frameIndex];
+			if (mirror->lastUpdateNt == 0) {
+				continue;
+			}
+			scheduleMsg(&logger, "node %d frame %d: %s seq=%d missed=%d age=%dms", node,
+					frameIndex, boolToString(mirror->valid), mirror->lastSeq,
+					mirror->missedFrameCounter,
+					(int)NT2US(getTimeNowNt() - mirror->lastUpdateNt) / 1000);
+		}
+	}
+}
+
+void initCanStateSync(void) {
+	addConsoleActionI("set_can_sync_enabled", setSyncEnabled);
+	addConsoleActionI("set_can_sync_node_id", setSyncNodeId);
+	addConsoleActionI("set_can_sync_deadline_ms", setSyncDeadlineMs);
+	addConsoleAction("cansyncinfo", canSyncInfo);
+}
+
+#endif /* EFI_CAN_SUPPORT */
@@ -0,0 +1,68 @@
+/**
+ * @file	can_state_sync.h
+ * @brief	inter-ECU state sync over CAN, see can_state_sync.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+#if EFI_CAN_SUPPORT
+
+#include "datalogging.h"
+
+/**
+ * SID block claimed by state sync: base + node * stride + frame index. The block
+ * sits between the BMW cluster SIDs and the OBD range, 0x620..0x62F with four
+ * nodes and four frame slots per node.
+ */
+#define CAN_SYNC_BASE_SID 0x620
+#define CAN_SYNC_NODE_STRIDE 4
+#define CAN_SYNC_SID_MASK 0x7F0
+
+#define CAN_SYNC_MAX_NODES 4
+#define CAN_SYNC_FRAME_COUNT 2
+/**
+ * bytes of state image per frame: one payload byte goes to the sequence number
+ * and one to the change mask
+ */
+#define CAN_SYNC_IMAGE_SIZE 6
+#define CAN_SYNC_FULL_MASK 0x3F
+
+/**
+ * remote-state mirror: the reconstructed image of one frame of one publisher
+ */
+typedef struct {
+	uint8_t image[CAN_SYNC_IMAGE_SIZE];
+	uint8_t lastSeq;
+	/**
+	 * false until a keyframe arrives, and again after a sequence gap until the
+	 * next keyframe repairs the image
+	 */
+	bool valid;
+	efitick_t lastUpdateNt;
+	int missedFrameCounter;
+} can_sync_mirror_s;
+
+void initCanStateSync(void);
+/**
+ * publisher tick, invoked from the CAN TX periodic task with its timestamp
+ */
+void canSyncPeriodic(efitime_t nowNt);
+/**
+ * subscriber hook, invoked from the CAN RX thread
+ * @return true if the frame was a state sync frame and is consumed
+ */
+bool canSyncOnRx(const CANRxFrame *frame, efitick_t nowNt);
+
+const can_sync_mirror_s *getCanSyncMirror(int node, int frameIndex);
+/**
+ * RPM decoded from the fast frame mirror of a remote node, NaN while the mirror
+ * is invalid or older than two deadlines
+ */
+float getCanSyncRemoteRpm(int node, efitick_t nowNt);
+
+#endif /* EFI_CAN_SUPPORT */
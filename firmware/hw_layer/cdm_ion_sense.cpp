@@ -46,6 +46,121 @@ void CdmState::onNewSignal(int currentRevolution) {
 	}
 }
 
+IonBurnWindow::IonBurnWindow() {
+	reset();
+}
+
+void IonBurnWindow::reset() {
+	binCount = 0;
+	rawAccumulator = 0;
+	rawCount = 0;
+}
+
+void IonBurnWindow::onSample(int adcValue) {
+	if (binCount >= ION_WINDOW_BINS) {
+		// window is full, the tail of the burst carries no flame-front information
+		return;
+	}
+	rawAccumulator += adcValue;
+	rawCount++;
+	if (rawCount == (1 << ION_DECIMATION_SHIFT)) {
+		bins[binCount++] = (uint16_t)(rawAccumulator >> ION_DECIMATION_SHIFT);
+		rawAccumulator = 0;
+		rawCount = 0;
+	}
+}
+
+bool IonBurnWindow::hasData() const {
+	return binCount > 0;
+}
+
+int IonBurnWindow::getIntegral() const {
+	int sum = 0;
+	for (int i = 0; i < binCount; i++) {
+		sum += bins[i];
+	}
+	return sum;
+}
+
+int IonBurnWindow::getPeakBin() const {
+	int peakIndex = 0;
+	for (int i = 1; i < binCount; i++) {
+		if (bins[i] > bins[peakIndex]) {
+			peakIndex = i;
+		}
+	}
+	return peakIndex;
+}
+
+int IonBurnWindow::getPeakValue() const {
+	return binCount == 0 ? 0 : bins[getPeakBin()];
+}
+
+IonBurnAnalysis::IonBurnAnalysis() {
+	memset(averageIntegral, 0, sizeof(averageIntegral));
+	memset(quality, 0, sizeof(quality));
+	memset(peakBin, 0, sizeof(peakBin));
+}
+
+void IonBurnAnalysis::startWindow(int cylinderIndex) {
+	if (activeCylinder >= 0) {
+		// previous window was never closed - fold it in before reusing the buffer
+		endWindow();
+	}
+	if (cylinderIndex < 0 || cylinderIndex >= ION_MAX_CYLINDER_COUNT) {
+		return;
+	}
+	window.reset();
+	activeCylinder = cylinderIndex;
+}
+
+void IonBurnAnalysis::onSample(int adcValue) {
+	if (activeCylinder < 0) {
+		return;
+	}
+	window.onSample(adcValue);
+}
+
+void IonBurnAnalysis::endWindow() {
+	if (activeCylinder < 0) {
+		return;
+	}
+	int cylinder = activeCylinder;
+	activeCylinder = -1;
+	if (!window.hasData()) {
+		// no samples arrived - capture is not wired up on this build, keep the
+		// previous per-cylinder state instead of reporting misfires
+		return;
+	}
+	int integral = window.getIntegral();
+	peakBin[cylinder] = window.getPeakBin();
+	int average = averageIntegral[cylinder];
+	if (average == 0) {
+		// the first observed burn seeds the reference
+		averageIntegral[cylinder] = integral;
+		quality[cylinder] = 100;
+	} else {
+		quality[cylinder] = (int)(100 * (int64_t)integral / average);
+		// exponential moving average, the new burn weighted 1/8
+		averageIntegral[cylinder] = average + ((integral - average) >> 3);
+	}
+	windowCount++;
+}
+
+int IonBurnAnalysis::getCombustionQuality(int cylinderIndex) const {
+	if (cylinderIndex < 0 || cylinderIndex >= ION_MAX_CYLINDER_COUNT) {
+		return 0;
+	}
+	return quality[cylinderIndex];
+}
+
+int IonBurnAnalysis::getPeakBin(int cylinderIndex) const {
+	if (cylinderIndex < 0 || cylinderIndex >= ION_MAX_CYLINDER_COUNT) {
+		return 0;
+	}
+	return peakBin[cylinderIndex];
+}
+
 // above logic compiles unconditionally so that unit tests are happy, but without an instance linker would have nothing to link
 #if EFI_CDM_INTEGRATION
 
@@ -54,6 +169,26 @@ void CdmState::onNewSignal(int currentRevolution) {
 EXTERN_ENGINE;
 
 static CdmState instance;
+static IonBurnAnalysis burnAnalysis;
+
+void ionOnSparkFired(int cylinderIndex) {
+	// the previous cylinder's burn is over once the next spark fires
+	burnAnalysis.endWindow();
+	burnAnalysis.startWindow(cylinderIndex);
+}
+
+/**
+ * Entry point for angle-gated analog burst capture. The Saab CDM module itself only
+ * reports digital combustion events, so on CDM builds nothing feeds this - an analog
+ * ion input would push its conversions here from the fast ADC path.
+ */
+void ionFeedSample(int adcValue) {
+	burnAnalysis.onSample(adcValue);
+}
+
+int getIonCombustionQuality(int cylinderIndex) {
+	return burnAnalysis.getCombustionQuality(cylinderIndex);
+}
 
 int getCurrentCdmValue(int currentRevolution) {
 	return instance.getValue(currentRevolution);
@@ -62,6 +197,8 @@ int getCurrentCdmValue(int currentRevolution) {
 #if EFI_TUNER_STUDIO
 void ionPostState(TunerStudioOutputChannels *tsOutputChannels) {
 	tsOutputChannels->debugIntField1 = instance.totalCdmEvents;
+	tsOutputChannels->debugIntField2 = burnAnalysis.getCombustionQuality(0);
+	tsOutputChannels->debugIntField3 = burnAnalysis.getPeakBin(0);
 }
 #endif /* EFI_TUNER_STUDIO */
 
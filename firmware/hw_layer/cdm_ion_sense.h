@@ -30,6 +30,70 @@ public:
 	int getValue(int currentRevolution);
 };
 
+/**
+ * Ion-current burn analysis.
+ *
+ * A capture window opens right after each spark fires and incoming ADC samples are
+ * decimated on the fly: 2^ION_DECIMATION_SHIFT raw samples average into one window
+ * bin, so the feature kernels (integral, peak position) run over ION_WINDOW_BINS
+ * integer entries instead of the raw burst. Everything on the sample path and in the
+ * kernels is integer-only.
+ */
+#define ION_WINDOW_BINS 32
+#define ION_DECIMATION_SHIFT 2
+#define ION_MAX_CYLINDER_COUNT 12
+
+class IonBurnWindow {
+public:
+	IonBurnWindow();
+	void reset();
+	/**
+	 * sample-rate path: one add plus an occasional store
+	 */
+	void onSample(int adcValue);
+	bool hasData() const;
+
+	int getIntegral() const;
+	int getPeakBin() const;
+	int getPeakValue() const;
+
+	uint16_t bins[ION_WINDOW_BINS];
+	int binCount = 0;
+private:
+	int rawAccumulator = 0;
+	int rawCount = 0;
+};
+
+class IonBurnAnalysis {
+public:
+	IonBurnAnalysis();
+	void startWindow(int cylinderIndex);
+	void onSample(int adcValue);
+	/**
+	 * extracts the window features and folds them into the per-cylinder estimates
+	 */
+	void endWindow();
+	/**
+	 * @return around 100 for a burn matching this cylinder's recent history, towards
+	 * zero for a weak burn or misfire
+	 */
+	int getCombustionQuality(int cylinderIndex) const;
+	/**
+	 * @return decimated-window bin of the ion current peak, a proxy for the location
+	 * of peak pressure
+	 */
+	int getPeakBin(int cylinderIndex) const;
+
+	IonBurnWindow window;
+	int windowCount = 0;
+private:
+	int activeCylinder = -1;
+	// exponential moving average of the burn integral, zero until the first burn is seen
+	int averageIntegral[ION_MAX_CYLINDER_COUNT];
+	int quality[ION_MAX_CYLINDER_COUNT];
+	int peakBin[ION_MAX_CYLINDER_COUNT];
+};
+
 #if EFI_TUNER_STUDIO
 #include "tunerstudio_configuration.h"
 void ionPostState(TunerStudioOutputChannels *tsOutputChannels);
@@ -37,5 +101,8 @@ void ionPostState(TunerStudioOutputChannels *tsOutputChannels);
 
 void cdmIonInit(void);
 int getCurrentCdmValue(int currentRevolution);
+void ionOnSparkFired(int cylinderIndex);
+void ionFeedSample(int adcValue);
+int getIonCombustionQuality(int cylinderIndex);
 
 #endif /* HW_LAYER_CDM_ION_SENSE_H_ */
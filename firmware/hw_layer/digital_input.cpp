@@ -6,11 +6,17 @@
  */
 
 #include "digital_input.h"
+#include "error_handling.h"
 
-void digital_input_s::setWidthCallback(VoidInt handler, void *arg) {
-	widthListeners.registerCallback(handler, arg);
+void digital_input_s::setWidthCallback(VoidPtr handler, void *arg) {
+	// the single slot is resolved at init, a second registration is a startup error, not a silent drop
+	efiAssertVoid(CUSTOM_ERR_6606, widthCallback == nullptr, "width callback already set");
+	widthCallback = handler;
+	widthArg = arg;
 }
 
-void digital_input_s::setPeriodCallback(VoidInt handler, void *arg) {
-	periodListeners.registerCallback(handler, arg);
+void digital_input_s::setPeriodCallback(VoidPtr handler, void *arg) {
+	efiAssertVoid(CUSTOM_ERR_6606, periodCallback == nullptr, "period callback already set");
+	periodCallback = handler;
+	periodArg = arg;
 }
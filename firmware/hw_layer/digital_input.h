@@ -8,7 +8,6 @@
 #pragma once
 
 #include "global.h"
-#include "listener_array.h"
 
 typedef struct {
 #if HAL_USE_ICU
@@ -18,10 +17,16 @@ typedef struct {
 	bool isActiveHigh = false;
 	volatile bool started = false;
 	brain_pin_e brainPin = GPIO_UNASSIGNED;
-	IntListenerArray<1> widthListeners;
-	IntListenerArray<1> periodListeners;
+	/**
+	 * single-slot typed callbacks resolved at init: the ICU ISR calls straight
+	 * through the pointer, no listener loop and no void* function casts
+	 */
+	VoidPtr widthCallback = nullptr;
+	void *widthArg = nullptr;
+	VoidPtr periodCallback = nullptr;
+	void *periodArg = nullptr;
 
 	// Width/Period names are historically inherited from ICU implementation, todo: migrate to better names, high/low? rise/hall?
-	void setWidthCallback(VoidInt handler, void *arg);
-	void setPeriodCallback(VoidInt handler, void *arg);
+	void setWidthCallback(VoidPtr handler, void *arg);
+	void setPeriodCallback(VoidPtr handler, void *arg);
 } digital_input_s;
@@ -64,7 +64,9 @@ static void icuWidthCallback(ICUDriver *driver) {
 	 int rowWidth = icuGetWidth(driver);
 	 */
 	digital_input_s * hw = finddigital_input_s(driver);
-	hw->widthListeners.invokeJustArgCallbacks();
+	if (hw->widthCallback != nullptr) {
+		hw->widthCallback(hw->widthArg);
+	}
 }
 
 static void icuPeriordCallBack(ICUDriver *driver) {
@@ -75,7 +77,9 @@ static void icuPeriordCallBack(ICUDriver *driver) {
 	 */
 
 	digital_input_s * hw = finddigital_input_s(driver);
-	hw->periodListeners.invokeJustArgCallbacks();
+	if (hw->periodCallback != nullptr) {
+		hw->periodCallback(hw->periodArg);
+	}
 }
 
 static uint32_t getAlternateFunctions(ICUDriver *driver) {
@@ -227,8 +231,8 @@ digital_input_s * addWaveAnalyzerDriver(const char *msg, brain_pin_e brainPin) {
 	}
 
 	digital_input_s *hw = registeredIcus.add();
-	hw->widthListeners.clear();
-	hw->periodListeners.clear();
+	hw->widthCallback = nullptr;
+	hw->periodCallback = nullptr;
 	hw->started = false;
 	hw->brainPin = brainPin;
 	hw->driver = driver;
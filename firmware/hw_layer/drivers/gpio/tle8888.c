@@ -284,6 +284,32 @@ static int tle8888_spi_rw(struct tle8888_priv *chip, uint16_t tx, uint16_t *rx)
 	return 0;
 }
 
+/**
+ * @brief Sends a batch of commands while holding the bus.
+ * @details The chip latches one 16-bit command per CS frame, so CS still
+ * toggles per command, but bus acquisition and SPI re-configuration happen
+ * once per batch instead of once per command.
+ * note that spiExchange/DMA was tried here and transfers invalid data on STM32F7xx, see mc33972.c
+ */
+static int tle8888_spi_rw_batch(struct tle8888_priv *chip, const uint16_t *tx, int count)
+{
+	SPIDriver *spi = get_bus(chip);
+
+	spiAcquireBus(spi);
+	spiStart(spi, &chip->cfg->spi_config);
+	for (int i = 0; i < count; i++) {
+		spiSelect(spi);
+		spiRxb = spiPolledExchange(spi, tx[i]);
+		spiUnselect(spi);
+		spiTxb = tx[i];
+		tle8888SpiCounter++;
+	}
+	spiReleaseBus(spi);
+
+	/* no errors for now */
+	return 0;
+}
+
 /**
  * @brief TLE8888 send output registers data.
  * @details Sends ORed data to register.
@@ -291,19 +317,25 @@ static int tle8888_spi_rw(struct tle8888_priv *chip, uint16_t tx, uint16_t *rx)
 
 static int tle8888_update_output(struct tle8888_priv *chip)
 {
-	int ret = 0;
+	uint16_t tx[4];
+	int count = 0;
 
 	/* TODO: lock? */
 
 	/* set value only for non-direct driven pins */
 	uint32_t out_data = chip->o_state & (~chip->o_direct_mask);
+	/* transmit only the CONT registers which have actually changed, all of
+	 * them in one bus transaction */
 	for (int i = 0; i < 4; i++) {
-		uint8_t od;
+		uint8_t od = (out_data >> (8 * i)) & 0xff;
 
-		od = (out_data >> (8 * i)) & 0xff;
-		ret |= tle8888_spi_rw(chip, CMD_CONT(i, od), NULL);
+		if (od == ((chip->o_state_cached >> (8 * i)) & 0xff))
+			continue;
+		tx[count++] = CMD_CONT(i, od);
 	}
 
+	int ret = count ? tle8888_spi_rw_batch(chip, tx, count) : 0;
+
 	if (ret == 0) {
 		/* atomic */
 		chip->o_state_cached = out_data;
@@ -503,6 +535,10 @@ int startupConfiguration(struct tle8888_priv *chip) {
 	/* enable outputs */
 	tle8888_spi_rw(chip, CMD_OE_SET, NULL);
 
+	/* chip reset wiped the CONT registers: invalidate the cache (bitwise NOT
+	 * differs in every byte) so the next update retransmits all of them */
+	chip->o_state_cached = ~(chip->o_state & ~chip->o_direct_mask);
+
 	if (cfg->hallMode) {
 		/**
 		 * By default "auto detection mode for VR sensor signals" is used
@@ -536,6 +572,8 @@ void watchdogLogic(struct tle8888_priv *chip) {
 	tle8888_spi_rw(chip, CMD_FWDSTAT0, &WindowWatchdogErrorCounterValue);
 	tle8888_spi_rw(chip, CMD_TECSTAT, &FunctionalWatchdogPassCounterValue);
 	tle8888_spi_rw(chip, CMD_TECSTAT, &TotalErrorCounterValue);
+	/* note: responses arrive one command later, see tle8888_spi_rw, which is
+	 * why these reads cannot simply move into a write-only batch */
 
 
 	// sanity checking that we are looking at the right responses
@@ -565,6 +603,11 @@ static THD_FUNCTION(tle8888_driver_thread, p) {
 		/* should we care about msg == MSG_TIMEOUT? */
 		(void)msg;
 
+		/* coalesce: writePad() signals once per pin change, a burst of changes
+		 * within a tick should result in a single output register update */
+		while (chSemWaitTimeout(&tle8888_wake, TIME_IMMEDIATE) == MSG_OK)
+			;
+
 		if (vBattForTle8888 < 7) {
 			// we assume TLE8888 is down and we should not bother with SPI communication
 			needInitialSpi = true;
@@ -22,12 +22,20 @@
 #include "vehicle_speed.h"
 #include "yaw_rate_sensor.h"
 #include "pin_repository.h"
+#include "spi_scheduler.h"
+#include "io_dispatch.h"
+#include "perf_trace.h"
 #include "max31855.h"
 #include "smart_gpio.h"
 #include "accelerometer.h"
 #include "eficonsole.h"
 #include "console_io.h"
 #include "sensor_chart.h"
+#include "boot_profiler.h"
+#include "prearm.h"
+#include "efi_gpio.h"
+#include "backup_ram.h"
+#include "postmortem_ring.h"
 
 #include "mpu_util.h"
 //#include "usb_msd.h"
@@ -38,6 +46,7 @@
 #include "mcp3208.h"
 #include "hip9011.h"
 #include "histogram.h"
+#include "event_queue.h"
 #include "mmc_card.h"
 #include "neo6m.h"
 #include "lcd_HD44780.h"
@@ -63,11 +72,15 @@
 #endif /* EFI_INTERNAL_FLASH */
 
 EXTERN_ENGINE
+
+#if EFI_KEYON_PREARM && EFI_ENGINE_CONTROL
+static void prearmPrepareShapes(void) {
+	prepareShapes(PASS_ENGINE_PARAMETER_SIGNATURE);
+}
+#endif /* EFI_KEYON_PREARM && EFI_ENGINE_CONTROL */
 ;
 extern bool hasFirmwareErrorFlag;
 
-static mutex_t spiMtx;
-
 /**
  * this depends on patch to chdebug.c
 +extern int maxNesting;
@@ -90,16 +103,22 @@ bool rtcWorks = true;
 
 /**
  * Only one consumer can use SPI bus at a given time
+ *
+ * Callers with latency or bandwidth concerns should register their own
+ * spi_scheduler client instead, this legacy entry shares one anonymous
+ * control-priority client between everybody.
  */
+static spi_client_s *legacySpiClient = NULL;
+
 void lockSpi(spi_device_e device) {
 	UNUSED(device);
 	efiAssertVoid(CUSTOM_STACK_SPI, getCurrentRemainingStack() > 128, "lockSpi");
 	// todo: different locks for different SPI devices!
-	chMtxLock(&spiMtx);
+	spiClientAcquire(legacySpiClient);
 }
 
 void unlockSpi(void) {
-	chMtxUnlock(&spiMtx);
+	spiClientRelease(legacySpiClient);
 }
 
 static void initSpiModules(engine_configuration_s *engineConfiguration) {
@@ -198,25 +217,27 @@ extern AdcDevice fastAdc;
  * This method is not in the adc* lower-level file because it is more business logic then hardware.
  */
 void adc_callback_fast(ADCDriver *adcp, adcsample_t *buffer, size_t n) {
-	(void) buffer;
-	(void) n;
-
 	ScopePerf perf(PE::AdcCallbackFast);
 
 	/**
-	 * Note, only in the ADC_COMPLETE state because the ADC driver fires an
-	 * intermediate callback when the buffer is half full.
-	 * */
-	if (adcp->state == ADC_COMPLETE) {
+	 * The ADC driver fires an intermediate callback when the buffer is half full: we
+	 * process each half of the double buffer as soon as DMA hands it over ('buffer'
+	 * points at the chunk which just completed) instead of waiting for the full
+	 * transfer, so consumers see half the latency and we never touch the half DMA is
+	 * still writing into.
+	 */
+	if (adcp->state == ADC_COMPLETE || adcp->state == ADC_ACTIVE) {
 		ScopePerf perf(PE::AdcCallbackFastComplete);
 
-		fastAdc.invalidateSamplesCache();
+		fastAdc.invalidateSamplesCache(buffer, n);
 
 		/**
 		 * this callback is executed 10 000 times a second, it needs to be as fast as possible
 		 */
 		efiAssertVoid(CUSTOM_ERR_6676, getCurrentRemainingStack() > 128, "lowstck#9b");
 
+		size_t scanRows = n / fastAdc.size();
+
 #if EFI_SENSOR_CHART
 		if (ENGINE(sensorChartMode) == SC_AUX_FAST1) {
 			float voltage = getAdcValue("fAux1", engineConfiguration->auxFastSensor1_adcChannel);
@@ -225,11 +246,12 @@ void adc_callback_fast(ADCDriver *adcp, adcsample_t *buffer, size_t n) {
 #endif /* EFI_SENSOR_CHART */
 
 #if EFI_MAP_AVERAGING
-		mapAveragingAdcCallback(fastAdc.samples[fastMapSampleIndex]);
+		// zero-copy: a strided pointer into the live DMA buffer, no intermediate array
+		mapAveragingAdcBufferCallback(buffer + fastMapSampleIndex, fastAdc.size(), scanRows);
 #endif /* EFI_MAP_AVERAGING */
 #if EFI_HIP_9011
 		if (CONFIG(isHip9011Enabled)) {
-			hipAdcCallback(fastAdc.samples[hipSampleIndex]);
+			hipAdcCallback(buffer[hipSampleIndex]);
 		}
 #endif /* EFI_HIP_9011 */
 //		if (tpsSampleIndex != TPS_IS_SLOW) {
@@ -413,6 +435,16 @@ void showBor(void) {
 	scheduleMsg(sharedLogger, "BOR=%d", (int)BOR_Get());
 }
 
+#if EFI_HD44780_LCD
+static void lazyInitLcd(void) {
+	lcd_HD44780_init(sharedLogger);
+	if (hasFirmwareError())
+		return;
+	lcd_HD44780_print_string(VCS_VERSION);
+	lcd_HD44780_flush();
+}
+#endif /* EFI_HD44780_LCD */
+
 void initHardware(Logging *l) {
 	efiAssertVoid(CUSTOM_IH_STACK, getCurrentRemainingStack() > EXPECTED_REMAINING_STACK, "init h");
 	sharedLogger = l;
@@ -425,13 +457,23 @@ void initHardware(Logging *l) {
 	// 10 extra seconds to re-flash the chip
 	//flashProtect();
 
-	chMtxObjectInit(&spiMtx);
+	initIoDispatch(sharedLogger);
+
+#if HAL_USE_SPI
+	initSpiScheduler();
+	legacySpiClient = registerSpiClient("legacy", SPI_PRIO_CONTROL);
+#endif /* HAL_USE_SPI */
+
+#if ENABLE_PERF_TRACE
+	initPerfTrace();
+#endif /* ENABLE_PERF_TRACE */
 
 #if EFI_HISTOGRAMS
 	/**
 	 * histograms is a data structure for CPU monitor, it does not depend on configuration
 	 */
 	initHistogramsModule();
+	initEventQueueMetrics();
 #endif /* EFI_HISTOGRAMS */
 
 	/**
@@ -468,17 +510,42 @@ void initHardware(Logging *l) {
 	resetConfigurationExt(sharedLogger, engineConfiguration->engineType PASS_ENGINE_PARAMETER_SUFFIX);
 #endif /* EFI_INTERNAL_FLASH */
 
+	bootProfilerMark("config from flash");
+
+#if defined(STM32F4XX) || defined(STM32F7XX)
+	// the pin assignment is known now: force injectors and coils to their
+	// inactive level with a few port-wide writes, the regular pin repository
+	// walk only reaches them much later in the boot
+	{
+		pin_output_mode_e injMode = CONFIG(injectionPinMode);
+		palBulkConfigureOutputs(CONFIG(injectionPins), INJECTION_PIN_COUNT,
+				injMode == OM_INVERTED || injMode == OM_OPENDRAIN_INVERTED,
+				injMode == OM_OPENDRAIN || injMode == OM_OPENDRAIN_INVERTED);
+		pin_output_mode_e ignMode = CONFIG(ignitionPinMode);
+		palBulkConfigureOutputs(CONFIG(ignitionPins), IGNITION_PIN_COUNT,
+				ignMode == OM_INVERTED || ignMode == OM_OPENDRAIN_INVERTED,
+				ignMode == OM_OPENDRAIN || ignMode == OM_OPENDRAIN_INVERTED);
+	}
+#endif /* STM32F4XX || STM32F7XX */
+
+#if EFI_KEYON_PREARM
+	initPrearm(sharedLogger);
+#if EFI_ENGINE_CONTROL
+	// shape precompute only needs the configuration we just read, but
+	// rebuildFuelSchedule() inside validates injector output pins, so the worker
+	// must wait for the PREARM_INJECTOR_PINS milestone - running earlier would
+	// flag every cylinder with a false "no_pin_inj" warning
+	prearmSubmit(PREARM_TRIGGER_SHAPES, prearmPrepareShapes, PREARM_DEP(PREARM_INJECTOR_PINS));
+#endif /* EFI_ENGINE_CONTROL */
+#endif /* EFI_KEYON_PREARM */
+
 	// it's important to initialize this pretty early in the game before any scheduling usages
 	initSingleTimerExecutorHardware();
 
 #if EFI_HD44780_LCD
 //	initI2Cmodule();
-	lcd_HD44780_init(sharedLogger);
-	if (hasFirmwareError())
-		return;
-
-	lcd_HD44780_print_string(VCS_VERSION);
-
+	// the character LCD is slow to initialize and is not needed for engine start
+	bootDeferInit("HD44780 LCD", lazyInitLcd);
 #endif /* EFI_HD44780_LCD */
 
 	if (hasFirmwareError()) {
@@ -495,7 +562,18 @@ void initHardware(Logging *l) {
 	waitForSlowAdc(1);
 #endif /* HAL_USE_ADC */
 
+	bootProfilerMark("ADC inputs");
+
+#if EFI_KEYON_PREARM
+	// the calibration itself was concurrent already - the ADC samples by DMA
+	// while the code above runs - this just records the milestone
+	prearmMarkDone(PREARM_ADC_CALIBRATION);
+#endif /* EFI_KEYON_PREARM */
+
 	initRtc();
+	// depends on the backup domain being powered which initRtc takes care of
+	initLearnedValues();
+	initPostmortemRing(sharedLogger);
 
 #if HAL_USE_SPI
 	initSpiModules(engineConfiguration);
@@ -506,8 +584,23 @@ void initHardware(Logging *l) {
 	// output pins potentially depend on 'initSmartGpio'
 	initOutputPins(PASS_ENGINE_PARAMETER_SIGNATURE);
 
+	bootProfilerMark("GPIO and output pins");
+
+#if EFI_KEYON_PREARM
+	prearmMarkDone(PREARM_GPIO_OUTPUTS);
+	// the pump relay is drivable from this point on, the FSIO pump logic
+	// energizes it on its first tick - the prime is running from here
+	prearmMarkDone(PREARM_PUMP_PRIME);
+#endif /* EFI_KEYON_PREARM */
+
 #if EFI_MC33816
+#if EFI_KEYON_PREARM
+	// the SPI microcode download is the slowest boot step, ride the worker
+	// instead of stalling the main chain
+	prearmSubmit(PREARM_MC33816, initMc33816, PREARM_DEP(PREARM_GPIO_OUTPUTS));
+#else
 	initMc33816();
+#endif /* EFI_KEYON_PREARM */
 #endif /* EFI_MC33816 */
 
 #if EFI_MAX_31855
@@ -526,6 +619,8 @@ void initHardware(Logging *l) {
 	initTriggerCentral(sharedLogger);
 #endif /* EFI_SHAFT_POSITION_INPUT */
 
+	bootProfilerMark("trigger central");
+
 	turnOnHardware(sharedLogger);
 
 #if EFI_HIP_9011
@@ -592,6 +687,8 @@ void initHardware(Logging *l) {
 
 	calcFastAdcIndexes();
 
+	bootProfilerMark("hardware done");
+
 	printMsg(sharedLogger, "initHardware() OK!");
 }
 
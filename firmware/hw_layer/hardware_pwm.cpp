@@ -0,0 +1,147 @@
+/**
+ * @file	hardware_pwm.cpp
+ * @brief	Hardware timer based PWM, zero CPU cost once started
+ *
+ * For high frequency outputs like the ETB H-bridge or a boost solenoid at several kHz,
+ * software PWM means thousands of scheduled callbacks per second out of the single
+ * microsecond timer. Pins which happen to sit on a free timer channel can skip all of
+ * that: the timer peripheral generates the waveform and duty updates are a single
+ * compare register write.
+ *
+ * TIM4 belongs to the fast ADC (see EFI_INTERNAL_FAST_ADC_PWM) and TIM5 is the
+ * scheduler microsecond timer, so we hand out TIM1 and TIM8 channels here.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_PROD_CODE && EFI_HARDWARE_PWM
+
+#include "hardware_pwm.h"
+#include "io_pins.h"
+
+/**
+ * Fixed number of counter ticks per period gives us constant 0.01% duty resolution:
+ * the counter frequency is scaled to the requested PWM frequency instead.
+ */
+#define HW_PWM_PERIOD_TICKS 10000
+
+typedef struct {
+	brain_pin_e pin;
+	PWMDriver *driver;
+	/**
+	 * zero based channel index
+	 */
+	int channelIndex;
+	int alternateFunction;
+} hw_pwm_pin_mapping_s;
+
+static const hw_pwm_pin_mapping_s pinMappings[] = {
+#if STM32_PWM_USE_TIM1
+	{ GPIOA_8,  &PWMD1, 0, 1 },
+	{ GPIOA_9,  &PWMD1, 1, 1 },
+	{ GPIOA_10, &PWMD1, 2, 1 },
+	{ GPIOE_9,  &PWMD1, 0, 1 },
+	{ GPIOE_11, &PWMD1, 1, 1 },
+	{ GPIOE_13, &PWMD1, 2, 1 },
+	{ GPIOE_14, &PWMD1, 3, 1 },
+#endif /* STM32_PWM_USE_TIM1 */
+#if STM32_PWM_USE_TIM8
+	{ GPIOC_6, &PWMD8, 0, 3 },
+	{ GPIOC_7, &PWMD8, 1, 3 },
+	{ GPIOC_8, &PWMD8, 2, 3 },
+	{ GPIOC_9, &PWMD8, 3, 3 },
+#endif /* STM32_PWM_USE_TIM8 */
+};
+
+#define PIN_MAPPING_COUNT (int)(sizeof(pinMappings) / sizeof(pinMappings[0]))
+
+typedef struct {
+	PWMDriver *driver;
+	/**
+	 * zero while this timer was not started yet. All channels of one timer share the period.
+	 */
+	float frequency;
+	PWMConfig config;
+} hw_pwm_driver_state_s;
+
+static hw_pwm_driver_state_s driverStates[] = {
+#if STM32_PWM_USE_TIM1
+	{ &PWMD1, 0, {} },
+#endif /* STM32_PWM_USE_TIM1 */
+#if STM32_PWM_USE_TIM8
+	{ &PWMD8, 0, {} },
+#endif /* STM32_PWM_USE_TIM8 */
+};
+
+#define DRIVER_STATE_COUNT (int)(sizeof(driverStates) / sizeof(driverStates[0]))
+
+static HardwarePwm channels[PIN_MAPPING_COUNT];
+
+void HardwarePwm::setDuty(float dutyCycle) {
+	if (!isStarted) {
+		return;
+	}
+	if (cisnan(dutyCycle)) {
+		warning(CUSTOM_DUTY_INVALID, "hwpwm:dutyCycle %.2f", dutyCycle);
+		return;
+	}
+	dutyCycle = maxF(0, minF(dutyCycle, 1));
+	pwmEnableChannel(driver, channelIndex, (pwmcnt_t)(dutyCycle * HW_PWM_PERIOD_TICKS));
+}
+
+static hw_pwm_driver_state_s *acquireDriver(PWMDriver *driver, float frequencyHz) {
+	for (int i = 0; i < DRIVER_STATE_COUNT; i++) {
+		hw_pwm_driver_state_s *state = &driverStates[i];
+		if (state->driver != driver) {
+			continue;
+		}
+		if (state->frequency == 0) {
+			state->frequency = frequencyHz;
+			state->config.frequency = (uint32_t)(frequencyHz * HW_PWM_PERIOD_TICKS);
+			state->config.period = HW_PWM_PERIOD_TICKS;
+			for (int ch = 0; ch < PWM_CHANNELS; ch++) {
+				state->config.channels[ch].mode = PWM_OUTPUT_ACTIVE_HIGH;
+				state->config.channels[ch].callback = NULL;
+			}
+			pwmStart(driver, &state->config);
+			return state;
+		}
+		// timer is already running - a second channel has to live with the same period
+		return state->frequency == frequencyHz ? state : nullptr;
+	}
+	return nullptr;
+}
+
+HardwarePwm *tryInitHardwarePwm(const char *msg, brain_pin_e brainPin, float frequencyHz, float dutyCycle) {
+	if (frequencyHz <= 0) {
+		return nullptr;
+	}
+	for (int i = 0; i < PIN_MAPPING_COUNT; i++) {
+		const hw_pwm_pin_mapping_s *mapping = &pinMappings[i];
+		if (mapping->pin != brainPin) {
+			continue;
+		}
+		HardwarePwm *channel = &channels[i];
+		if (channel->isStarted) {
+			// somebody is already driving this channel
+			return nullptr;
+		}
+		if (acquireDriver(mapping->driver, frequencyHz) == nullptr) {
+			// same timer already runs at a different frequency, let software PWM handle this pin
+			return nullptr;
+		}
+		channel->driver = mapping->driver;
+		channel->channelIndex = mapping->channelIndex;
+		channel->isStarted = true;
+		efiSetPadMode(msg, brainPin, PAL_MODE_ALTERNATE(mapping->alternateFunction));
+		channel->setDuty(dutyCycle);
+		return channel;
+	}
+	// this pin is not on a timer channel we hand out
+	return nullptr;
+}
+
+#endif /* EFI_PROD_CODE && EFI_HARDWARE_PWM */
@@ -0,0 +1,45 @@
+/**
+ * @file	hardware_pwm.h
+ * @brief	Hardware timer based PWM, zero CPU cost once started
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+#ifndef EFI_HARDWARE_PWM
+#define EFI_HARDWARE_PWM FALSE
+#endif
+
+#if EFI_PROD_CODE && EFI_HARDWARE_PWM
+
+/**
+ * One STM32 timer channel driving a PWM output, see tryInitHardwarePwm()
+ */
+class HardwarePwm {
+public:
+	/**
+	 * @param dutyCycle value between 0 and 1, only the compare register is touched
+	 */
+	void setDuty(float dutyCycle);
+
+	PWMDriver *driver = nullptr;
+	int channelIndex = 0;
+	bool isStarted = false;
+};
+
+/**
+ * Tries to map a pin onto a hardware timer channel. Unlike SimplePwm this costs zero
+ * scheduler events per period: once the timer is running, duty updates are just a
+ * compare register write. Several channels of the same timer share one period, so a
+ * second pin on an already-running timer is only accepted at the same frequency.
+ *
+ * @return backend instance, or NULL if this pin has no timer channel (or the channel
+ * is taken) and the caller should fall back to software PWM
+ */
+HardwarePwm *tryInitHardwarePwm(const char *msg, brain_pin_e brainPin, float frequencyHz, float dutyCycle);
+
+#endif /* EFI_PROD_CODE && EFI_HARDWARE_PWM */
@@ -38,9 +38,13 @@
 #include "hardware.h"
 #include "rpm_calculator.h"
 #include "trigger_central.h"
+#include "engine_math.h"
+#include "board_features.h"
+#include "angle_scheduler.h"
 #include "hip9011_logic.h"
 #include "hip9011_lookup.h"
 #include "hip9011.h"
+#include "io_dispatch.h"
 #include "adc_inputs.h"
 
 #include "engine_controller.h"
@@ -75,8 +79,8 @@ static unsigned char tx_buff[1];
 static unsigned char rx_buff[1];
 static char pinNameBuffer[16];
 
-static scheduling_s startTimer[2];
-static scheduling_s endTimer[2];
+static AngleBasedEvent knockStartEvent[MAX_IGNITION_EVENT_COUNT];
+static AngleBasedEvent knockEndEvent[MAX_IGNITION_EVENT_COUNT];
 
 static Logging *logger;
 
@@ -246,28 +250,33 @@ static void endIntegration(void *) {
 }
 
 /**
- * Shaft Position callback used to start or finish HIP integration
+ * Invoked from handleSparkEvent() within the very same executor batch as the coil
+ * events, so the integration window open/close callbacks are angle-anchored per
+ * cylinder instead of the previous one-window-per-revolution trigger listener. A
+ * tight window around each cylinder's expected knock region means better knock
+ * signal-to-noise ratio.
  */
-static void intHoldCallback(trigger_event_e ckpEventType, uint32_t index, efitick_t edgeTimestamp DECLARE_ENGINE_PARAMETER_SUFFIX) {
-	(void)ckpEventType;
-	// this callback is invoked on interrupt thread
-	if (index != 0)
+void hip9011_onIgnitionEvent(IgnitionEvent *event, uint32_t trgEventIndex, efitick_t edgeTimestamp DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	// constant false on boards without the chip, the whole handler folds away
+	if (!board::hasHip9011 || !CONFIG(isHip9011Enabled))
 		return;
 	engine->m.beforeHipCb = getTimeNowLowerNt();
 
-	int rpm = GET_RPM_VALUE;
-	if (!isValidRpm(rpm))
-		return;
+	int cylinderIndex = event->cylinderIndex;
+	angle_t cylinderTdcAngle = ENGINE(ignitionPositionWithinEngineCycle[cylinderIndex]);
+
+	angle_t windowStartAngle = cylinderTdcAngle + CONFIG(knockDetectionWindowStart);
+	fixAngle(windowStartAngle, "knockStart", CUSTOM_ERR_6726);
+	angle_t windowEndAngle = cylinderTdcAngle + CONFIG(knockDetectionWindowEnd);
+	fixAngle(windowEndAngle, "knockEnd", CUSTOM_ERR_6727);
 
-	int structIndex = getRevolutionCounter() % 2;
-	// todo: schedule this based on closest trigger event, same as ignition works
-	scheduleByAngle(&startTimer[structIndex], edgeTimestamp, engineConfiguration->knockDetectionWindowStart,
-			&startIntegration);
+	scheduleOrQueue(&knockStartEvent[cylinderIndex], trgEventIndex, edgeTimestamp, windowStartAngle,
+			{ &startIntegration, nullptr } PASS_ENGINE_PARAMETER_SUFFIX);
 #if EFI_PROD_CODE
 	hipLastExecutionCount = lastExecutionCount;
 #endif /* EFI_PROD_CODE */
-	scheduleByAngle(&endTimer[structIndex], edgeTimestamp, engineConfiguration->knockDetectionWindowEnd,
-			&endIntegration);
+	scheduleOrQueue(&knockEndEvent[cylinderIndex], trgEventIndex, edgeTimestamp, windowEndAngle,
+			{ &endIntegration, nullptr } PASS_ENGINE_PARAMETER_SUFFIX);
 	engine->m.hipCbTime = getTimeNowLowerNt() - engine->m.beforeHipCb;
 }
 
@@ -364,28 +373,35 @@ static void hipStartupCode(void) {
 	instance.state = READY_TO_INTEGRATE;
 }
 
-static THD_WORKING_AREA(hipTreadStack, UTILITY_THREAD_STACK_SIZE);
-
-static msg_t hipThread(void *arg) {
+/**
+ * housekeeping which used to own a dedicated thread - the CS wiggle the thread
+ * performed with sleeps at startup is the first three ticks of this state
+ * machine, after that every tick is the same needToInit poll the thread did
+ */
+static void hipPeriodicWork(void *arg) {
 	(void)arg;
-	chRegSetThreadName("hip9011 init");
-
-	// some time to let the hardware start
-	enginePins.hipCs.setValue(true);
-	chThdSleepMilliseconds(100);
-	enginePins.hipCs.setValue(false);
-	chThdSleepMilliseconds(100);
-	enginePins.hipCs.setValue(true);
-
-	while (true) {
-		chThdSleepMilliseconds(100);
-
-		if (instance.needToInit) {
-			hipStartupCode();
-			instance.needToInit = false;
-		}
+	static int startupStep = 0;
+
+	switch (startupStep) {
+	case 0:
+		// some time to let the hardware start
+		enginePins.hipCs.setValue(true);
+		startupStep++;
+		return;
+	case 1:
+		enginePins.hipCs.setValue(false);
+		startupStep++;
+		return;
+	case 2:
+		enginePins.hipCs.setValue(true);
+		startupStep++;
+		return;
+	}
+
+	if (instance.needToInit) {
+		hipStartupCode();
+		instance.needToInit = false;
 	}
-	return -1;
 }
 
 void stopHip9001_pins() {
@@ -403,7 +419,7 @@ void startHip9001_pins() {
 void initHip9011(Logging *sharedLogger) {
 	logger = sharedLogger;
 	addConsoleAction("hipinfo", showHipInfo);
-	if (!CONFIG(isHip9011Enabled))
+	if (!board::hasHip9011 || !CONFIG(isHip9011Enabled))
 		return;
 
 
@@ -428,9 +444,9 @@ void initHip9011(Logging *sharedLogger) {
 	instance.currentBandIndex = getBandIndex();
 
 	/**
-	 * this engine cycle callback would be scheduling actual integration start and end callbacks
+	 * integration window scheduling is folded into the per-cylinder ignition event
+	 * chain, see hip9011_onIgnitionEvent() invoked from handleSparkEvent()
 	 */
-	addTriggerEventListener(&intHoldCallback, "DD int/hold", engine);
 
 	// MISO PB14
 //	palSetPadMode(GPIOB, 14, PAL_MODE_ALTERNATE(EFI_SPI2_AF) | PAL_STM32_PUDR_PULLUP);
@@ -442,7 +458,7 @@ void initHip9011(Logging *sharedLogger) {
 	addConsoleActionI("set_hip_prescalerandsdo", setPrescalerAndSDO);
     addConsoleActionF("set_knock_threshold", setKnockThresh);
     addConsoleActionI("set_max_knock_sub_deg", setMaxKnockSubDeg);
-	chThdCreateStatic(hipTreadStack, sizeof(hipTreadStack), NORMALPRIO, (tfunc_t)(void*) hipThread, NULL);
+	ioDispatchAddPeriodicWork("hip9011", hipPeriodicWork, NULL, 100);
 }
 
 #endif /* EFI_HIP_9011 */
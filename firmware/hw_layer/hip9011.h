@@ -14,10 +14,17 @@
 
 #define HIP_THREAD_PERIOD 100
 
+class IgnitionEvent;
+
 void initHip9011(Logging *sharedLogger);
 void startHip9001_pins();
 void stopHip9001_pins();
 void setHip9011FrankensoPinout(void);
+/**
+ * schedules the per-cylinder knock integration window, invoked from spark_logic within
+ * the same executor batch as the coil events
+ */
+void hip9011_onIgnitionEvent(IgnitionEvent *event, uint32_t trgEventIndex, efitick_t edgeTimestamp DECLARE_ENGINE_PARAMETER_SUFFIX);
 #if HAL_USE_ADC
 void hipAdcCallback(adcsample_t value);
 #endif /* HAL_USE_ADC */
@@ -0,0 +1,59 @@
+/**
+ * @file	hw_crc.cpp
+ * @brief	STM32 CRC unit as a drop-in for the table-driven crc32()
+ *
+ * The CRC unit implements the forward CRC-32 polynomial over 32-bit words while the
+ * TunerStudio protocol uses the reflected flavor: bit-reversing each input word and
+ * the final remainder makes the two match, see RM0090 for the gory details.
+ *
+ * The unit cannot be seeded with an arbitrary value, so a computation cannot be
+ * resumed once another thread has touched the peripheral - we hold a mutex for the
+ * duration of each buffer instead.
+ *
+ * @date Apr 25, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+#include "hw_crc.h"
+
+#if EFI_HW_CRC
+
+static MUTEX_DECL(crcUnitMutex);
+
+static bool isCrcUnitEnabled = false;
+
+uint32_t hwCrc32(const void *buf, uint32_t size) {
+	/**
+	 * the unit only chews whole word-aligned 32-bit words, oddly placed buffers take
+	 * the table-driven path - for tiny packets the locking overhead is not worth it
+	 * either
+	 */
+	if ((((uintptr_t) buf) & 3) != 0 || size < 16) {
+		return crc32(buf, size);
+	}
+
+	chMtxLock(&crcUnitMutex);
+	if (!isCrcUnitEnabled) {
+		RCC->AHB1ENR |= RCC_AHB1ENR_CRCEN;
+		isCrcUnitEnabled = true;
+	}
+	CRC->CR = CRC_CR_RESET;
+
+	const uint32_t *words = (const uint32_t *) buf;
+	uint32_t wordCount = size / 4;
+	for (uint32_t i = 0; i < wordCount; i++) {
+		CRC->DR = __RBIT(words[i]);
+	}
+	uint32_t result = __RBIT(CRC->DR) ^ 0xFFFFFFFF;
+	chMtxUnlock(&crcUnitMutex);
+
+	// trailing bytes continue in software from the hardware value
+	uint32_t tail = size & 3;
+	if (tail != 0) {
+		result = crc32inc((const void *) (words + wordCount), result, tail);
+	}
+	return result;
+}
+
+#endif /* EFI_HW_CRC */
@@ -0,0 +1,32 @@
+/**
+ * @file	hw_crc.h
+ * @brief	STM32 CRC unit as a drop-in for the table-driven crc32()
+ *
+ * @date Apr 25, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#ifndef HW_CRC_H_
+#define HW_CRC_H_
+
+#include "global.h"
+#include "crc.h"
+
+#ifndef EFI_HW_CRC
+#define EFI_HW_CRC FALSE
+#endif
+
+#if EFI_HW_CRC
+
+uint32_t hwCrc32(const void *buf, uint32_t size);
+
+#else
+
+/**
+ * software fallback so that the simulator and unit_tests build unchanged
+ */
+#define hwCrc32(buf, size) crc32(buf, size)
+
+#endif /* EFI_HW_CRC */
+
+#endif /* HW_CRC_H_ */
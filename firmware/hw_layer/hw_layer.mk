@@ -4,6 +4,9 @@ HW_LAYER_EGT = $(PROJECT_DIR)/hw_layer/serial_over_usb/usbcfg.c \
 HW_INC = hw_layer/$(CPU_HWLAYER)
 
 HW_LAYER_EGT_CPP = $(PROJECT_DIR)/hw_layer/can_hw.cpp \
+	$(PROJECT_DIR)/hw_layer/can_filter.cpp \
+	$(PROJECT_DIR)/hw_layer/can_broadcast.cpp \
+	$(PROJECT_DIR)/hw_layer/can_state_sync.cpp \
 	$(PROJECT_DIR)/hw_layer/max31855.cpp
 
 HW_LAYER_EMS = $(HW_LAYER_EGT) \
@@ -13,15 +16,20 @@ HW_LAYER_EMS = $(HW_LAYER_EGT) \
 HW_LAYER_EMS_CPP = $(HW_LAYER_EGT_CPP) \
 	$(PROJECT_DIR)/hw_layer/pin_repository.cpp \
 	$(PROJECT_DIR)/hw_layer/microsecond_timer.cpp \
+	$(PROJECT_DIR)/hw_layer/hardware_pwm.cpp \
 	$(PROJECT_DIR)/hw_layer/digital_input.cpp \
 	$(PROJECT_DIR)/hw_layer/digital_input_icu.cpp \
 	$(PROJECT_DIR)/hw_layer/digital_input_exti.cpp \
 	$(PROJECT_DIR)/hw_layer/hardware.cpp \
+	$(PROJECT_DIR)/hw_layer/spi_scheduler.cpp \
+	$(PROJECT_DIR)/hw_layer/io_dispatch.cpp \
+	$(PROJECT_DIR)/hw_layer/hw_crc.cpp \
 	$(PROJECT_DIR)/hw_layer/smart_gpio.cpp \
 	$(PROJECT_DIR)/hw_layer/neo6m.cpp \
 	$(PROJECT_DIR)/hw_layer/mmc_card.cpp \
 	$(PROJECT_DIR)/hw_layer/lcd/lcd_HD44780.cpp \
 	$(PROJECT_DIR)/hw_layer/adc_inputs.cpp \
+	$(PROJECT_DIR)/hw_layer/adc_transforms.cpp \
 	$(PROJECT_DIR)/hw_layer/adc_subscription.cpp \
 	$(PROJECT_DIR)/hw_layer/pwm_generator.cpp \
 	$(PROJECT_DIR)/hw_layer/trigger_input.cpp \
@@ -37,6 +45,8 @@ HW_LAYER_EMS_CPP = $(HW_LAYER_EGT_CPP) \
 	$(PROJECT_DIR)/hw_layer/rtc_helper.cpp \
 	$(PROJECT_DIR)/hw_layer/cdm_ion_sense.cpp \
 	$(PROJECT_DIR)/hw_layer/backup_ram.cpp \
+	$(PROJECT_DIR)/hw_layer/warm_boot.cpp \
+	$(PROJECT_DIR)/hw_layer/postmortem_ring.cpp \
 
 #
 # '-include' is a magic kind of 'include' which would survive if file to be included is not found
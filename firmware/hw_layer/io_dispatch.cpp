@@ -0,0 +1,176 @@
+/**
+ * @file	io_dispatch.cpp
+ * @brief	shared I/O completion dispatch
+ *
+ * Several drivers used to spin a dedicated thread which spent its life asleep -
+ * waking every 100ms to poll a flag, or blocking on a bus semaphore until a DMA
+ * completion released it. Each of those threads costs a 1-2KB stack plus the
+ * context switches in and out, and thread-per-device does not scale on the RAM
+ * we have left. This module runs them all on one thread: DMA-complete ISRs post
+ * lightweight completions into a queue with ioDispatchPostI(), and drivers whose
+ * thread was only a periodic flag poll register that poll as periodic work.
+ *
+ * Completion callbacks run in thread context, so they may use the full HAL -
+ * the ISR only posts. The queue is small on purpose: completions are expected
+ * to be drained within a tick, and an overflow is a warning, not a silent drop.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_PROD_CODE
+
+#include "os_access.h"
+#include "io_dispatch.h"
+#include "eficonsole.h"
+#include "efitime.h"
+
+#define IO_DISPATCH_QUEUE_SIZE 16
+#define IO_DISPATCH_PERIODIC_MAX_COUNT 8
+/**
+ * periodic work resolution - also the longest an already-posted completion
+ * waits if the semaphore signal is ever missed
+ */
+#define IO_DISPATCH_TICK_MS 10
+
+static Logging *logger;
+
+typedef struct {
+	io_work_callback_f callback;
+	void *arg;
+} io_completion_s;
+
+typedef struct {
+	const char *name;
+	io_work_callback_f callback;
+	void *arg;
+	int periodMs;
+	efitimeus_t nextRunUs;
+	uint32_t runCount;
+} io_periodic_work_s;
+
+static io_completion_s completionQueue[IO_DISPATCH_QUEUE_SIZE];
+static volatile int queueHead = 0;
+static volatile int queueTail = 0;
+
+static io_periodic_work_s periodicWork[IO_DISPATCH_PERIODIC_MAX_COUNT];
+static int periodicWorkCount = 0;
+
+static uint32_t postedCount = 0;
+static uint32_t dispatchedCount = 0;
+static uint32_t overflowCount = 0;
+
+static semaphore_t ioDispatchSemaphore;
+static THD_WORKING_AREA(ioDispatchThreadStack, UTILITY_THREAD_STACK_SIZE);
+
+/**
+ * the queue index math is shared by the ISR and thread variants, both run
+ * under the kernel lock
+ */
+static bool enqueue(io_work_callback_f callback, void *arg) {
+	int nextHead = (queueHead + 1) % IO_DISPATCH_QUEUE_SIZE;
+	if (nextHead == queueTail) {
+		overflowCount++;
+		return false;
+	}
+	completionQueue[queueHead].callback = callback;
+	completionQueue[queueHead].arg = arg;
+	queueHead = nextHead;
+	postedCount++;
+	return true;
+}
+
+void ioDispatchPostI(io_work_callback_f callback, void *arg) {
+	if (enqueue(callback, arg)) {
+		chSemSignalI(&ioDispatchSemaphore);
+	}
+}
+
+void ioDispatchPost(io_work_callback_f callback, void *arg) {
+	bool posted;
+	chSysLock();
+	posted = enqueue(callback, arg);
+	if (posted) {
+		chSemSignalI(&ioDispatchSemaphore);
+		chSchRescheduleS();
+	}
+	chSysUnlock();
+	if (!posted) {
+		warning(CUSTOM_ERR_6635, "I/O dispatch queue overflow");
+	}
+}
+
+void ioDispatchAddPeriodicWork(const char *name, io_work_callback_f callback, void *arg, int periodMs) {
+	if (periodicWorkCount >= IO_DISPATCH_PERIODIC_MAX_COUNT) {
+		warning(CUSTOM_ERR_6635, "too many I/O periodic works: %s", name);
+		return;
+	}
+	io_periodic_work_s *work = &periodicWork[periodicWorkCount++];
+	work->name = name;
+	work->callback = callback;
+	work->arg = arg;
+	work->periodMs = periodMs;
+	work->nextRunUs = getTimeNowUs() + periodMs * 1000;
+}
+
+static void drainCompletions(void) {
+	while (true) {
+		io_completion_s completion;
+		chSysLock();
+		if (queueTail == queueHead) {
+			chSysUnlock();
+			return;
+		}
+		completion = completionQueue[queueTail];
+		queueTail = (queueTail + 1) % IO_DISPATCH_QUEUE_SIZE;
+		chSysUnlock();
+		completion.callback(completion.arg);
+		dispatchedCount++;
+	}
+}
+
+static void runDuePeriodicWork(void) {
+	efitimeus_t nowUs = getTimeNowUs();
+	for (int i = 0; i < periodicWorkCount; i++) {
+		io_periodic_work_s *work = &periodicWork[i];
+		if (nowUs < work->nextRunUs) {
+			continue;
+		}
+		work->callback(work->arg);
+		work->runCount++;
+		work->nextRunUs = nowUs + work->periodMs * 1000;
+	}
+}
+
+static THD_FUNCTION(IoDispatchThread, arg) {
+	UNUSED(arg);
+	chRegSetThreadName("I/O dispatch");
+	while (true) {
+		// a post wakes us immediately, the timeout paces the periodic work
+		chSemWaitTimeout(&ioDispatchSemaphore, TIME_MS2I(IO_DISPATCH_TICK_MS));
+		drainCompletions();
+		runDuePeriodicWork();
+	}
+}
+
+static void showIoDispatch(void) {
+	scheduleMsg(logger, "posted %d dispatched %d overflow %d", postedCount,
+			dispatchedCount, overflowCount);
+	for (int i = 0; i < periodicWorkCount; i++) {
+		io_periodic_work_s *work = &periodicWork[i];
+		scheduleMsg(logger, "%s: every %dms, %d runs", work->name, work->periodMs,
+				work->runCount);
+	}
+}
+
+void initIoDispatch(Logging *sharedLogger) {
+	logger = sharedLogger;
+	chSemObjectInit(&ioDispatchSemaphore, 0);
+	chThdCreateStatic(ioDispatchThreadStack, sizeof(ioDispatchThreadStack), NORMALPRIO,
+			(tfunc_t)(void*) IoDispatchThread, NULL);
+	addConsoleAction("iodispatch", showIoDispatch);
+}
+
+#endif /* EFI_PROD_CODE */
@@ -0,0 +1,38 @@
+/**
+ * @file	io_dispatch.h
+ * @brief	shared I/O completion dispatch, see io_dispatch.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#ifndef IO_DISPATCH_H_
+#define IO_DISPATCH_H_
+
+#include "global.h"
+
+#if EFI_PROD_CODE
+
+#include "datalogging.h"
+
+typedef void (*io_work_callback_f)(void *arg);
+
+void initIoDispatch(Logging *sharedLogger);
+/**
+ * post a completion from interrupt context, the caller is expected to be
+ * within chSysLockFromISR()/chSysUnlockFromISR()
+ */
+void ioDispatchPostI(io_work_callback_f callback, void *arg);
+/**
+ * post a completion from thread context
+ */
+void ioDispatchPost(io_work_callback_f callback, void *arg);
+/**
+ * run a driver housekeeping callback on the shared I/O thread every periodMs -
+ * the replacement for a dedicated thread which only sleeps and polls a flag
+ */
+void ioDispatchAddPeriodicWork(const char *name, io_work_callback_f callback, void *arg, int periodMs);
+
+#endif /* EFI_PROD_CODE */
+
+#endif /* IO_DISPATCH_H_ */
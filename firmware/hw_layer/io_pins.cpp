@@ -25,7 +25,7 @@ EXTERN_ENGINE;
 #include "main_trigger_callback.h"
 #endif /* EFI_ENGINE_CONTROL */
 
-static LoggingWithStorage logger("io_pins");
+static Logging logger("io_pins");
 
 extern EnginePins enginePins;
 
@@ -52,9 +52,24 @@ enum {
 // http://web.alfredstate.edu/weimandn/lcd/lcd_addressing/lcd_addressing_index.html
 static const int lineStart[] = { 0, 0x40, 0x14, 0x54 };
 
+#define LCD_MAX_ROWS 4
+#define LCD_MAX_COLUMNS 20
+
 static int BUSY_WAIT_DELAY = FALSE;
+/**
+ * Print methods compose into this shadow frame, lcd_HD44780_flush() transmits only
+ * the cells which differ from what the panel is already showing. A wholesale redraw
+ * through the bit-banged 4-bit bus costs milliseconds, a typical gauge update
+ * changes a handful of characters.
+ */
+static char framebuffer[LCD_MAX_ROWS][LCD_MAX_COLUMNS];
+static char transmitted[LCD_MAX_ROWS][LCD_MAX_COLUMNS];
+// composition cursor, where the next print lands in the shadow frame
 static int currentRow = 0;
 static int currentColumn = 0;
+// hardware DDRAM cursor, avoids re-addressing between adjacent changed cells
+static int hwRow = -1;
+static int hwColumn = -1;
 
 static void lcdSleep(int period) {
 	if (BUSY_WAIT_DELAY) {
@@ -136,7 +151,7 @@ void lcd_HD44780_write_data(uint8_t data) {
 
 	lcd_HD44780_write(data);
 	lcd_HD44780_write(data << 4);
-	currentColumn++;
+	hwColumn++;
 
 	palClearPad(getHwPort("lcd", CONFIG(HD44780_rs)), getHwPin("lcd", CONFIG(HD44780_rs)));
 }
@@ -144,9 +159,32 @@ void lcd_HD44780_write_data(uint8_t data) {
 //-----------------------------------------------------------------------------
 void lcd_HD44780_set_position(uint8_t row, uint8_t column) {
 	efiAssertVoid(CUSTOM_ERR_6657, row <= engineConfiguration->HD44780height, "invalid row");
+	// composition only - the hardware cursor moves during flush
 	currentRow = row;
 	currentColumn = column;
-	lcd_HD44780_write_command(LCD_HD44780_DDRAM_ADDR + lineStart[row] + column);
+}
+
+void lcd_HD44780_flush(void) {
+	int height = minI(engineConfiguration->HD44780height, LCD_MAX_ROWS);
+	int width = minI(engineConfiguration->HD44780width, LCD_MAX_COLUMNS);
+	for (int row = 0; row < height; row++) {
+		for (int column = 0; column < width; column++) {
+			if (framebuffer[row][column] == transmitted[row][column]) {
+				continue;
+			}
+			if (hwRow != row || hwColumn != column) {
+				lcd_HD44780_write_command(LCD_HD44780_DDRAM_ADDR + lineStart[row] + column);
+				hwRow = row;
+				hwColumn = column;
+			}
+			lcd_HD44780_write_data(framebuffer[row][column]);
+			transmitted[row][column] = framebuffer[row][column];
+			if (hwColumn >= width) {
+				// panel DDRAM is not contiguous across rows, force re-addressing
+				hwRow = -1;
+			}
+		}
+	}
 }
 
 int getCurrentHD44780row(void) {
@@ -160,8 +198,8 @@ int getCurrentHD44780column(void) {
 void lcd_HD44780_print_char(char data) {
 	if (data == '\n') {
 		lcd_HD44780_set_position(++currentRow, 0);
-	} else {
-		lcd_HD44780_write_data(data);
+	} else if (currentRow < LCD_MAX_ROWS && currentColumn < LCD_MAX_COLUMNS) {
+		framebuffer[currentRow][currentColumn++] = data;
 	}
 }
 
@@ -247,6 +285,12 @@ void lcd_HD44780_init(Logging *sharedLogger) {
 
 	lcd_HD44780_write_command(LCD_HD44780_DISPLAY_ON);
 
+	// DISPLAY_CLEAR left the panel all-spaces with the cursor at the origin
+	memset(framebuffer, ' ', sizeof(framebuffer));
+	memset(transmitted, ' ', sizeof(transmitted));
+	hwRow = 0;
+	hwColumn = 0;
+
 	lcd_HD44780_set_position(0, 0);
 	printMsg(logger, "lcd_HD44780_init() done");
 }
@@ -256,6 +300,8 @@ void lcdShowPanicMessage(char *message) {
 	lcd_HD44780_set_position(0, 0);
 	lcd_HD44780_print_string("PANIC\n");
 	lcd_HD44780_print_string(message);
+	// no periodic task is going to run anymore
+	lcd_HD44780_flush();
 }
 
 #endif /* EFI_HD44780_LCD */
@@ -19,6 +19,10 @@ void lcd_HD44780_init(Logging *sharedLogger);
 void lcd_HD44780_set_position(uint8_t row, uint8_t column);
 void lcd_HD44780_print_char(char data);
 void lcd_HD44780_print_string(const char *string);
+/**
+ * transmits the cells which changed since the previous flush
+ */
+void lcd_HD44780_flush(void);
 int getCurrentHD44780row(void);
 int getCurrentHD44780column(void);
 
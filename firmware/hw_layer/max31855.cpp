@@ -21,12 +21,20 @@
 #include "mpu_util.h"
 #include "settings.h"
 #include "pin_repository.h"
+#include "spi_scheduler.h"
+#include "io_dispatch.h"
 #endif /* EFI_PROD_CODE */
 
 #if EFI_MAX_31855
 
 #define EGT_ERROR_VALUE -1000
 
+/**
+ * the chip runs conversions continuously, one takes about 100ms - reading more
+ * often only returns the same result again, so this is the natural refresh rate
+ */
+#define MAX31855_CONVERSION_MS 100
+
 static SPIDriver *driver;
 
 static Logging* logger;
@@ -107,8 +115,7 @@ static uint32_t readEgtPacket(int egtChannel) {
 
 #define GET_TEMPERATURE_C(x) (((x) >> 18) / 4)
 
-uint16_t getEgtValue(int egtChannel) {
-	uint32_t packet = readEgtPacket(egtChannel);
+static uint16_t convertEgtPacket(uint32_t packet) {
 	max_32855_code code = getResultCode(packet);
 	if (code != MC_OK) {
 		return EGT_ERROR_VALUE + code;
@@ -117,6 +124,48 @@ uint16_t getEgtValue(int egtChannel) {
 	}
 }
 
+/**
+ * Sampling used to happen inside getEgtValue(): every status loop tick issued a
+ * blocking SPI transaction per configured chip, back to back - the biggest time
+ * sink of that thread on 8-channel setups, and pointless besides since the chip
+ * only produces a fresh conversion every ~100ms. Now one chip is read per
+ * sampling tick on the shared I/O thread, round-robin, paced so each chip is
+ * visited once per conversion window - the bus sees one short staggered
+ * transaction at a time instead of a burst. A completed round is published as
+ * one array snapshot, so consumers see all channels from the same round.
+ */
+static int activeChannels[EGT_CHANNEL_COUNT];
+static int activeChannelCount = 0;
+static int roundRobinIndex = 0;
+static uint16_t pendingValues[EGT_CHANNEL_COUNT];
+static uint16_t publishedValues[EGT_CHANNEL_COUNT];
+
+#if EFI_PROD_CODE
+static spi_client_s *egtSpiClient;
+
+static void egtSampleWork(void *arg) {
+	(void)arg;
+	int egtChannel = activeChannels[roundRobinIndex];
+
+	spiClientAcquire(egtSpiClient);
+	uint32_t packet = readEgtPacket(egtChannel);
+	spiClientRelease(egtSpiClient);
+
+	pendingValues[egtChannel] = convertEgtPacket(packet);
+
+	if (++roundRobinIndex >= activeChannelCount) {
+		roundRobinIndex = 0;
+		// a full round is published at once so a reader iterating the
+		// channels does not mix two rounds
+		memcpy(publishedValues, pendingValues, sizeof(publishedValues));
+	}
+}
+#endif /* EFI_PROD_CODE */
+
+uint16_t getEgtValue(int egtChannel) {
+	return publishedValues[egtChannel];
+}
+
 static void egtRead(void) {
 
 	if (driver == NULL) {
@@ -162,8 +211,19 @@ void initMax31855(Logging *sharedLogger, spi_device_e device, egt_cs_array_t max
 			initSpiCs(&spiConfig[i], max31855_cs[i]);
 
 			spiConfig[i].cr1 = getSpiPrescaler(_5MHz, device);
+
+			activeChannels[activeChannelCount++] = i;
 		}
 	}
+
+#if EFI_PROD_CODE
+	if (activeChannelCount > 0) {
+		egtSpiClient = registerSpiClient("EGT", SPI_PRIO_SENSOR);
+		// one chip per tick, the whole set once per conversion window
+		ioDispatchAddPeriodicWork("max31855", egtSampleWork, NULL,
+				MAX31855_CONVERSION_MS / activeChannelCount);
+	}
+#endif /* EFI_PROD_CODE */
 }
 
 #endif /* EFI_MAX_31855 */
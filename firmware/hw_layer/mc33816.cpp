@@ -41,6 +41,16 @@ static SPIConfig spiCfg = { .circular = false,
 
 static SPIDriver *driver;
 
+/**
+ * Shadow copy of the chip's Data RAM: runtime current-profile updates are
+ * frequent during transients while the values themselves rarely change, so
+ * we only transmit deltas and skip the bus transaction entirely when the
+ * chip already holds the requested word. Seeded by download_RAM(DATA_RAM).
+ */
+#define MC_DATA_RAM_SHADOW_SIZE 128 // 0x0080 words of data ram, see download_RAM
+
+static uint16_t dataRamShadow[MC_DATA_RAM_SHADOW_SIZE];
+static bool dataRamShadowValid[MC_DATA_RAM_SHADOW_SIZE];
 
 static void showStats() {
 
@@ -151,24 +161,31 @@ static void download_RAM(int target) {
    // Chip-Select high
    spiSelect(driver);
 
+   // collect the command framing into one buffer so the whole header goes out
+   // as a single DMA-backed spiSend instead of one transfer setup per word
+   unsigned short header[5];
+   unsigned int headerSize = 0;
+
    if (target != DATA_RAM)
    {
 	   command = codeWidthRegAddr << 5;   // control width register address
 	   command |= 1;                      // number of words to follow
-	   spi_writew(command);           // sends code_width command
-   	   spi_writew(size);              // sends size (Code Width)
+	   header[headerSize++] = command;    // code_width command
+	   header[headerSize++] = size;       // size (Code Width)
    }
 
    // Select Channel command
-   spi_writew(0x7FE1);
+   header[headerSize++] = 0x7FE1;
    // RAM1, RAM2, or Common Page (Data RAM)
-   spi_writew(memory_area);
+   header[headerSize++] = memory_area;
 
    // "Command" of starting address
    // up to 0x03FE of code ram
    // up to 0x0080 of data ram
    command = start_address << 5;
-   spi_writew(command);           // sends start address command
+   header[headerSize++] = command;   // start address command
+
+   spiSend(driver, headerSize, header);
 
    /*
    for(k = 0; k < size; k++)          // downloads RAM
@@ -180,6 +197,14 @@ static void download_RAM(int target) {
    */
    spiSend(driver, size, RAM_ptr);
    spiUnselect(driver);
+
+   if (target == DATA_RAM) {
+      // we know exactly what the chip holds now, seed the shadow from it
+      for (k = 0; k < size && k < MC_DATA_RAM_SHADOW_SIZE; k++) {
+         dataRamShadow[k] = RAM_ptr[k];
+         dataRamShadowValid[k] = true;
+      }
+   }
 }
 
 static void download_register(int r_target) {
@@ -302,6 +327,9 @@ void initMc33816() {
 	// Does starting turn this high to begin with??
 	spiUnselect(driver);
 
+	// chip reset wipes its RAM, the shadow knows nothing until re-download
+	memset(dataRamShadowValid, 0, sizeof(dataRamShadowValid));
+
 	//delay/wait? .. possibly only 30us for each needed, per datasheet
 	resetB.setValue(0);
 	chThdSleepMilliseconds(10);
@@ -323,18 +351,43 @@ void initMc33816() {
     //driven.setValue(1); // driven = HV
 }
 
-void update_scv(unsigned short current)
+/**
+ * Update a single word in Data RAM, consulting the shadow copy first: if the
+ * chip already holds the requested value the SPI bus is not touched at all
+ */
+static void write_data_ram(unsigned short address, unsigned short data)
 {
-	// Update a single word in Data RAM
-	spiSelect(driver);
+	if (address < MC_DATA_RAM_SHADOW_SIZE
+			&& dataRamShadowValid[address]
+			&& dataRamShadow[address] == data) {
+		// the chip is already there, do not contend for the bus
+		return;
+	}
+
+	// the whole frame in one DMA-backed transfer
+	unsigned short frame[4];
 	// Select Channel command
-    spi_writew(0x7FE1);
-    // Common Page
-    spi_writew(0x0004);
-	// write (MSB=0) at data ram x9 (SCV_I_Hold), and 1 word
-    spi_writew((9 << 5) + 1);
-    spi_writew(current);
-    spiUnselect(driver);
+	frame[0] = 0x7FE1;
+	// Common Page
+	frame[1] = 0x0004;
+	// write (MSB=0) at the given data ram address, and 1 word
+	frame[2] = (address << 5) + 1;
+	frame[3] = data;
+
+	spiSelect(driver);
+	spiSend(driver, 4, frame);
+	spiUnselect(driver);
+
+	if (address < MC_DATA_RAM_SHADOW_SIZE) {
+		dataRamShadow[address] = data;
+		dataRamShadowValid[address] = true;
+	}
+}
+
+void update_scv(unsigned short current)
+{
+	// data ram x9 is SCV_I_Hold
+	write_data_ram(9, current);
 
 	// Strobe it to reload the value
     //GPIO_ClearPinsOutput(GPIOE, 1<<PIN21_IDX); // SCV
@@ -22,8 +22,11 @@
 #include "pin_repository.h"
 #include "ff.h"
 #include "hardware.h"
+#include "spi_scheduler.h"
 #include "engine_configuration.h"
 #include "status_loop.h"
+#include "binary_log.h"
+#include "memory_report.h"
 #include "usb_msd_cfg.h"
 
 #include "rtc_helper.h"
@@ -50,6 +53,37 @@ static int writeCounter = 0;
 static int totalWritesCounter = 0;
 static int totalSyncCounter = 0;
 
+/**
+ * Classic ping-pong buffering: the sampling thread appends into one buffer while the
+ * writer thread drains the other one to the card, so the tens-of-ms SD busy spikes
+ * never block sampling. Sized as a multiple of the 512 byte MMC block so that a full
+ * buffer drains as whole blocks in raw-append mode.
+ */
+#define SD_PINGPONG_BUFFER_SIZE (4 * 512)
+// even an idle buffer gets pushed to the card this often
+#define SD_FLUSH_PERIOD_MS 200
+
+static char sdPingPongBuffers[2][SD_PINGPONG_BUFFER_SIZE] NO_CACHE;
+// which buffer is currently accepting log lines
+static int fillIndex = 0;
+static int fillPosition = 0;
+// bytes handed off to the writer thread, zero while the drain side is idle
+static int drainLength = 0;
+// lines dropped because both buffers were busy
+static int sdOverrunCounter = 0;
+// deepest fill level seen at hand-off time
+static int sdHighWaterMark = 0;
+
+static MUTEX_DECL(sdBufferMutex);
+
+#if EFI_SD_RAW_LOGGING
+/**
+ * SD traffic is bulk logging, the lowest SPI priority class
+ */
+static spi_client_s *sdSpiClient = NULL;
+#endif /* EFI_SD_RAW_LOGGING */
+static SEMAPHORE_DECL(sdDrainSignal, 0);
+
 #define LOG_INDEX_FILENAME "index.txt"
 
 #define RUSEFI_LOG_PREFIX "rus"
@@ -71,6 +105,7 @@ extern const USBConfig msdusbcfg;
 
 
 static THD_WORKING_AREA(mmcThreadStack,3 * UTILITY_THREAD_STACK_SIZE);		// MMC monitor thread
+static THD_WORKING_AREA(mmcWriterThreadStack,3 * UTILITY_THREAD_STACK_SIZE);	// MMC writer thread
 
 /**
  * MMC driver instance.
@@ -101,7 +136,7 @@ static MMCConfig mmccfg = { NULL, &ls_spicfg, &hs_spicfg };
  */
 static FATFS MMC_FS;
 
-static LoggingWithStorage logger("mmcCard");
+static Logging logger("mmcCard");
 
 static int fatFsErrors = 0;
 
@@ -126,6 +161,151 @@ static FIL FDCurrFile NO_CACHE;
 static int logFileIndex = 1;
 static char logName[_MAX_FILLER + 20];
 
+#if EFI_SD_RAW_LOGGING
+/**
+ * Plain f_write makes FatFS walk the cluster chain and maintain the FAT on every call,
+ * and that overhead caps us around 50Hz of logging. In raw-append mode we instead ask
+ * FatFS once, at file creation, for a large contiguous extent via f_expand, translate
+ * its first cluster into an LBA, and from then on push whole 512 byte blocks straight
+ * through the MMC driver in multi-block bursts. FatFS only touches the file again at
+ * close time when we record how much of the extent was actually used.
+ *
+ * Until the file is finalized the directory entry shows the full pre-allocated size,
+ * so a log cut short by a power loss simply carries a tail of padding.
+ */
+#define RAW_LOG_EXTENT_SIZE (32 * 1024 * 1024)
+#define RAW_LOG_EXTENT_BLOCKS (RAW_LOG_EXTENT_SIZE / MMCSD_BLOCK_SIZE)
+
+static bool rawLogReady = false;
+// first LBA of the contiguous extent, the only cluster-to-sector translation we ever need
+static uint32_t rawStartBlock = 0;
+// next block to be written, relative to rawStartBlock
+static uint32_t rawBlockIndex = 0;
+static uint32_t rawBytesWritten = 0;
+// staging area for the current partially filled block
+static uint8_t rawBlockBuffer[MMCSD_BLOCK_SIZE] NO_CACHE;
+static int rawBlockFill = 0;
+
+static bool writeRawBlocks(const uint8_t *data, uint32_t blockCount) {
+	if (rawBlockIndex + blockCount > RAW_LOG_EXTENT_BLOCKS) {
+		return false;
+	}
+	if (mmcStartSequentialWrite(&MMCD1, rawStartBlock + rawBlockIndex) != HAL_SUCCESS) {
+		return false;
+	}
+	bool isOk = true;
+	for (uint32_t i = 0; i < blockCount; i++) {
+		if (mmcSequentialWrite(&MMCD1, data + i * MMCSD_BLOCK_SIZE) != HAL_SUCCESS) {
+			isOk = false;
+			break;
+		}
+	}
+	if (mmcStopSequentialWrite(&MMCD1) != HAL_SUCCESS) {
+		isOk = false;
+	}
+	if (isOk) {
+		rawBlockIndex += blockCount;
+		totalWritesCounter++;
+	}
+	return isOk;
+}
+
+/**
+ * Invoked from mmcUnMount: flushes the staged tail and tells FatFS how much of the
+ * extent was actually used so that the directory entry ends up with the real size.
+ */
+static void finalizeRawLog(void) {
+	if (!rawLogReady) {
+		return;
+	}
+	rawLogReady = false;
+	if (rawBlockFill > 0) {
+		// pad the tail up to a full block, trailing line feeds are harmless in a text log
+		memset(rawBlockBuffer + rawBlockFill, '\n', MMCSD_BLOCK_SIZE - rawBlockFill);
+		writeRawBlocks(rawBlockBuffer, 1);
+		rawBlockFill = 0;
+	}
+	FRESULT err = f_lseek(&FDLogFile, rawBytesWritten);
+	if (err == FR_OK) {
+		err = f_truncate(&FDLogFile);
+	}
+	if (err != FR_OK) {
+		printError("raw log finalize failed", err);
+	}
+}
+
+/**
+ * Invoked from createLogFile while the new file is still empty. A failure here is not
+ * fatal - a fragmented or small card just keeps using the plain FatFS append path.
+ */
+static void prepareRawLogExtent(void) {
+	rawLogReady = false;
+	if (f_size(&FDLogFile) != 0) {
+		// appending to an existing file, that's a job for the FatFS path
+		return;
+	}
+	FRESULT err = f_expand(&FDLogFile, RAW_LOG_EXTENT_SIZE, 1);
+	if (err != FR_OK) {
+		printError("no contiguous extent, falling back to f_write", err);
+		return;
+	}
+	// commit the directory entry and the FAT chain before we go behind FatFS's back
+	f_sync(&FDLogFile);
+	rawStartBlock = MMC_FS.database + (uint32_t) MMC_FS.csize * (FDLogFile.obj.sclust - 2);
+	rawBlockIndex = 0;
+	rawBlockFill = 0;
+	rawBytesWritten = 0;
+	rawLogReady = true;
+}
+
+/**
+ * Hot path of raw-append mode: only the MMC driver is involved, no FatFS, no FAT reads.
+ */
+static void appendToRawLog(const char *line, UINT lineLength) {
+	spiClientAcquire(sdSpiClient);
+	bool isOk = true;
+	while (isOk && lineLength > 0) {
+		/**
+		 * preemption point: a wideband or knock read queued behind this bulk
+		 * write gets the bus between two block segments instead of waiting
+		 * for the whole line
+		 */
+		spiClientYield(sdSpiClient);
+		if (rawBlockFill == 0 && lineLength >= MMCSD_BLOCK_SIZE) {
+			// aligned bulk of the line goes straight from the caller's buffer in one burst
+			uint32_t blockCount = lineLength / MMCSD_BLOCK_SIZE;
+			isOk = writeRawBlocks((const uint8_t *) line, blockCount);
+			if (isOk) {
+				line += blockCount * MMCSD_BLOCK_SIZE;
+				lineLength -= blockCount * MMCSD_BLOCK_SIZE;
+				rawBytesWritten += blockCount * MMCSD_BLOCK_SIZE;
+			}
+			continue;
+		}
+		UINT chunk = minI(lineLength, MMCSD_BLOCK_SIZE - rawBlockFill);
+		memcpy(rawBlockBuffer + rawBlockFill, line, chunk);
+		rawBlockFill += chunk;
+		rawBytesWritten += chunk;
+		line += chunk;
+		lineLength -= chunk;
+		if (rawBlockFill == MMCSD_BLOCK_SIZE) {
+			isOk = writeRawBlocks(rawBlockBuffer, 1);
+			rawBlockFill = 0;
+		}
+	}
+	if (!isOk) {
+		if (rawBlockIndex + 1 >= RAW_LOG_EXTENT_BLOCKS) {
+			scheduleMsg(&logger, "SD raw log extent full, rotating");
+		} else {
+			printError("raw block write failed", FR_DISK_ERR);
+		}
+		// finalizes the current file, the monitor thread would re-mount into a fresh one
+		mmcUnMount();
+	}
+	spiClientRelease(sdSpiClient);
+}
+#endif /* EFI_SD_RAW_LOGGING */
+
 static void printMmcPinout(void) {
 	scheduleMsg(&logger, "MMC CS %s", hwPortname(CONFIG(sdCardCsPin)));
 	// todo: we need to figure out the right SPI pinout, not just SPI2
@@ -140,6 +320,12 @@ static void sdStatistics(void) {
 			sdStatus);
 	if (isSdCardAlive()) {
 		scheduleMsg(&logger, "filename=%s size=%d", logName, totalLoggedBytes);
+		scheduleMsg(&logger, "overruns=%d high water=%d/%d", sdOverrunCounter, sdHighWaterMark,
+				SD_PINGPONG_BUFFER_SIZE);
+#if EFI_SD_RAW_LOGGING
+		scheduleMsg(&logger, "raw mode=%s start block=%d blocks written=%d", boolToString(rawLogReady),
+				rawStartBlock, rawBlockIndex);
+#endif /* EFI_SD_RAW_LOGGING */
 	}
 }
 
@@ -188,7 +374,11 @@ static void prepareLogFileName(void) {
 	} else {
 		ptr = itoa10(&logName[PREFIX_LEN], logFileIndex);
 	}
+#if EFI_SD_BINARY_LOGGING
+	strcat(ptr, ".mlg");
+#else
 	strcat(ptr, ".msl");
+#endif /* EFI_SD_BINARY_LOGGING */
 
 }
 
@@ -221,6 +411,9 @@ static void createLogFile(void) {
 		return;
 	}
 	f_sync(&FDLogFile);
+#if EFI_SD_RAW_LOGGING
+	prepareRawLogExtent();
+#endif /* EFI_SD_RAW_LOGGING */
 	setSdCardReady(true);						// everything Ok
 	unlockSpi();
 }
@@ -306,22 +499,26 @@ void readLogFileContent(char *buffer, short fileId, short offset, short length)
 #endif
 
 /**
- * @brief Appends specified line to the current log file
+ * Pushes one buffer worth of log data to the card, this is the only place actually
+ * talking to the storage and it runs on the writer thread, never on the sampling path.
  */
-void appendToLog(const char *line) {
+static void flushSdBuffer(const char *buffer, UINT length) {
 	UINT bytesWritten;
 
 	if (!isSdCardAlive()) {
-		if (!errorReported)
-			scheduleMsg(&logger, "appendToLog Error: No File system is mounted");
-		errorReported = TRUE;
+		// the card went away while this buffer was in flight
 		return;
 	}
-	UINT lineLength = strlen(line);
-	totalLoggedBytes += lineLength;
+
+#if EFI_SD_RAW_LOGGING
+	if (rawLogReady) {
+		appendToRawLog(buffer, length);
+		return;
+	}
+#endif /* EFI_SD_RAW_LOGGING */
 	lockSpi(SPI_NONE);
-	FRESULT err = f_write(&FDLogFile, line, lineLength, &bytesWritten);
-	if (bytesWritten < lineLength) {
+	FRESULT err = f_write(&FDLogFile, buffer, length, &bytesWritten);
+	if (bytesWritten < length) {
 		printError("write error or disk full", err); // error or disk full
 		mmcUnMount();
 	} else {
@@ -341,6 +538,85 @@ void appendToLog(const char *line) {
 	unlockSpi();
 }
 
+/**
+ * must be invoked under sdBufferMutex and only while the drain side is idle
+ */
+static void swapSdBuffers(void) {
+	if (fillPosition > sdHighWaterMark) {
+		sdHighWaterMark = fillPosition;
+	}
+	drainLength = fillPosition;
+	fillIndex ^= 1;
+	fillPosition = 0;
+}
+
+/**
+ * @brief Appends specified line to the current log file
+ *
+ * This is just a memcpy into the fill side of the ping-pong pair: the card write with
+ * its multi-ms busy spikes happens on the writer thread against the other buffer, so
+ * the sampling cadence of the caller is not affected by card latency.
+ */
+void appendToLogBuffer(const char *data, int length) {
+	if (!isSdCardAlive()) {
+		if (!errorReported)
+			scheduleMsg(&logger, "appendToLog Error: No File system is mounted");
+		errorReported = TRUE;
+		return;
+	}
+	UINT lineLength = length;
+	if (lineLength >= SD_PINGPONG_BUFFER_SIZE) {
+		// pathological line, no way to stage it
+		sdOverrunCounter++;
+		return;
+	}
+	chMtxLock(&sdBufferMutex);
+	if (fillPosition + lineLength > SD_PINGPONG_BUFFER_SIZE) {
+		if (drainLength != 0) {
+			// both buffers are busy: we produce faster than the card drains
+			sdOverrunCounter++;
+			chMtxUnlock(&sdBufferMutex);
+			return;
+		}
+		swapSdBuffers();
+		chSemSignal(&sdDrainSignal);
+	}
+	memcpy(&sdPingPongBuffers[fillIndex][fillPosition], data, lineLength);
+	fillPosition += lineLength;
+	totalLoggedBytes += lineLength;
+	chMtxUnlock(&sdBufferMutex);
+}
+
+void appendToLog(const char *line) {
+	appendToLogBuffer(line, strlen(line));
+}
+
+static THD_FUNCTION(MmcWriterThread, arg) {
+	(void)arg;
+	chRegSetThreadName("MMC_Writer");
+
+	while (true) {
+		// woken up by a buffer hand-off, the timeout makes sure a quiet period still reaches the card
+		msg_t msg = chSemWaitTimeout(&sdDrainSignal, TIME_MS2I(SD_FLUSH_PERIOD_MS));
+		chMtxLock(&sdBufferMutex);
+		if (msg == MSG_TIMEOUT && drainLength == 0 && fillPosition > 0 && isSdCardAlive()) {
+			// nothing was handed off, take whatever has accumulated so far
+			swapSdBuffers();
+		}
+		int drainIndex = fillIndex ^ 1;
+		int length = drainLength;
+		chMtxUnlock(&sdBufferMutex);
+
+		if (length == 0) {
+			continue;
+		}
+		flushSdBuffer(sdPingPongBuffers[drainIndex], length);
+		chMtxLock(&sdBufferMutex);
+		drainLength = 0;
+		chMtxUnlock(&sdBufferMutex);
+	}
+}
+
 /*
  * MMC card un-mount.
  */
@@ -349,6 +625,9 @@ static void mmcUnMount(void) {
 		scheduleMsg(&logger, "Error: No File system is mounted. \"mountsd\" first");
 		return;
 	}
+#if EFI_SD_RAW_LOGGING
+	finalizeRawLog();
+#endif /* EFI_SD_RAW_LOGGING */
 	f_close(&FDLogFile);						// close file
 	f_sync(&FDLogFile);							// sync ALL
 	mmcDisconnect(&MMCD1);						// Brings the driver in a state safe for card removal.
@@ -428,6 +707,10 @@ static void MMCmount(void) {
 		incLogFileName();
 		createLogFile();
 		fileCreatedCounter++;
+#if EFI_SD_BINARY_LOGGING
+		// the layout header goes out exactly once, before the first record
+		writeBinaryLogHeader();
+#endif /* EFI_SD_BINARY_LOGGING */
 		scheduleMsg(&logger, "MMC/SD mounted!");
 	} else {
 		sdStatus = SD_STATE_MOUNT_FAILED;
@@ -475,6 +758,11 @@ bool isSdCardAlive(void) {
 void initMmcCard(void) {
 	logName[0] = 0;
 	addConsoleAction("sdinfo", sdStatistics);
+	registerStaticBuffer("SD ping-pong", sdPingPongBuffers, sizeof(sdPingPongBuffers));
+#if EFI_SD_RAW_LOGGING
+	registerStaticBuffer("SD raw block", rawBlockBuffer, sizeof(rawBlockBuffer));
+	sdSpiClient = registerSpiClient("SD card", SPI_PRIO_LOGGING);
+#endif /* EFI_SD_RAW_LOGGING */
 	if (!CONFIG(isSdCardEnabled)) {
 		return;
 	}
@@ -493,6 +781,7 @@ void initMmcCard(void) {
 	mmcStart(&MMCD1, &mmccfg);
 
 	chThdCreateStatic(mmcThreadStack, sizeof(mmcThreadStack), LOWPRIO, (tfunc_t)(void*) MMCmonThread, NULL);
+	chThdCreateStatic(mmcWriterThreadStack, sizeof(mmcWriterThreadStack), LOWPRIO, (tfunc_t)(void*) MmcWriterThread, NULL);
 
 	addConsoleAction("mountsd", MMCmount);
 	addConsoleActionS("appendtolog", appendToLog);
@@ -18,6 +18,8 @@ extern "C"
 void initMmcCard(void);
 bool isSdCardAlive(void);
 void appendToLog(const char *line);
+// same as appendToLog but for data which is not zero-terminated text, e.g. binary log records
+void appendToLogBuffer(const char *data, int length);
 
 void readLogFileContent(char *buffer, short fileId, short offset, short length);
 
@@ -26,7 +26,7 @@
 #include "rtc_helper.h"
 #include "engine.h"
 
-static LoggingWithStorage logging("uart gps");
+static Logging logging("uart gps");
 
 static SerialConfig GPSserialConfig = { GPS_SERIAL_SPEED, 0, USART_CR2_STOP1_BITS | USART_CR2_LINEN, 0 };
 static THD_WORKING_AREA(gpsThreadStack, UTILITY_THREAD_STACK_SIZE);
@@ -60,42 +60,33 @@ static void printGpsInfo(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 
 static struct tm curTm;
 
-static void onGpsMessage(char *buffer) {
-
-	gps_location(&GPSdata, buffer);
+static void onGpsFix(void) {
 	date_get_tm(&curTm);
 
 	if (GPSdata.quality == 4 && GPSdata.GPStm.tm_year > 0 && GPSdata.GPStm.tm_sec != curTm.tm_sec) {
-		// quality =4 (valis GxRMC), year > 0, and difference more then second
+		// quality =4 (valid GxRMC), year > 0, and difference more then second
 		date_set_tm(&GPSdata.GPStm);					// set GPS time
-		//}
 	}
 	gpsMesagesCount++;
 }
 
 // we do not want this on stack, right?
-static char gps_str[GPS_MAX_STRING];
+static nmea_parser_state gpsParser;
 
 static THD_FUNCTION(GpsThreadEntryPoint, arg) {
 	(void) arg;
 	chRegSetThreadName("GPS thread");
 
-	int count = 0;
+	nmea_parser_init(&gpsParser);
 
 	while (true) {
 		msg_t charbuf = streamGet(GPS_SERIAL_DEVICE);
-		if (charbuf == 10 || count == GPS_MAX_STRING) {					// if 0xD,0xA or limit
-			if (count >= 1)
-				gps_str[--count] = '\0';					// delete 0xD
-
-//			scheduleMsg(&logger, "got GPS [%s]", gps_str);
-
-			// 'gps_str' string completed
-			onGpsMessage(gps_str);
-			memset(&gps_str, '\0', GPS_MAX_STRING);			// clear buffer
-			count = 0;
-		} else {
-			gps_str[count++] = charbuf;
+		/**
+		 * each byte is consumed exactly once with fixed state, no line buffer and
+		 * no re-scan of the sentence once it is complete
+		 */
+		if (nmea_parser_feed(&gpsParser, (char) charbuf, &GPSdata)) {
+			onGpsFix();
 		}
 	}
 }
@@ -24,7 +24,7 @@
 
 static bool initialized = false;
 
-static LoggingWithStorage logger("pin repos");
+static Logging logger("pin repos");
 static int totalPinsUsed = 0;
 
 static int brainPin_to_index(brain_pin_e brainPin)
@@ -48,6 +48,32 @@ static brain_pin_e index_to_brainPin(int i)
 	return (brain_pin_e)((int)GPIOA_0 + i);
 }
 
+/**
+ * bitset of used pins, kept in sync with the name strings: 'is this pin used'
+ * queries during runtime reconfiguration and the console report skip over free
+ * pins without touching the string array at all
+ */
+#define PIN_REPO_TOTAL_PINS (BRAIN_PIN_LAST_ONCHIP - GPIOA_0 + 1 + BOARD_EXT_PINREPOPINS)
+
+static uint32_t usedPinsBits[(PIN_REPO_TOTAL_PINS + 31) / 32];
+
+static void setUsedBit(int index, bool used) {
+	if (index < 0 || index >= PIN_REPO_TOTAL_PINS)
+		return;
+	if (used) {
+		usedPinsBits[index / 32] |= 1U << (index % 32);
+	} else {
+		usedPinsBits[index / 32] &= ~(1U << (index % 32));
+	}
+}
+
+bool brain_pin_is_used(brain_pin_e brainPin) {
+	int index = brainPin_to_index(brainPin);
+	if (index < 0)
+		return false;
+	return (usedPinsBits[index / 32] >> (index % 32)) & 1;
+}
+
 PinRepository::PinRepository() {
 }
 
@@ -70,11 +96,20 @@ void tle8888_dump_regs(void)
 		uint8_t data = (tmp >> 8) & 0xff;
 
 		scheduleMsg(&logger, "%02x: %02x", response, data);
+		if ((request % 16) == 15) {
+			loggingYieldForHeadroom();
+		}
 	}
 }
 
 static void reportPins(void) {
+	int linesInChunk = 0;
 	for (unsigned int i = 0; i < getNumBrainPins(); i++) {
+		/* a whole word of free pins is skipped in one go */
+		if ((i % 32) == 0 && usedPinsBits[i / 32] == 0) {
+			i += 31;
+			continue;
+		}
 		const char *pin_user = getBrainUsedPin(i);
 
 		/* show used pins */
@@ -84,6 +119,10 @@ static void reportPins(void) {
 			ioportid_t port = getBrainPort(brainPin);
 
 			scheduleMsg(&logger, "pin %s%d: %s", portname(port), pin, pin_user);
+			if (++linesInChunk == 8) {
+				linesInChunk = 0;
+				loggingYieldForHeadroom();
+			}
 		}
 	}
 
@@ -126,6 +165,9 @@ static void reportPins(void) {
 						chip_name, gpiochips_getPinOffset(brainPin), pin_user ? pin_user : "free", pin_error);
 				}
 			}
+			if ((i % 8) == 7) {
+				loggingYieldForHeadroom();
+			}
 		}
 	#endif
 
@@ -233,6 +275,7 @@ bool brain_pin_markUsed(brain_pin_e brainPin, const char *msg) {
 	}
 
 	getBrainUsedPin(index) = msg;
+	setUsedBit(index, true);
 	totalPinsUsed++;
 	return false;
 }
@@ -256,6 +299,7 @@ void brain_pin_markUnused(brain_pin_e brainPin) {
 	if (getBrainUsedPin(index) != NULL)
 		totalPinsUsed--;
 	getBrainUsedPin(index) = nullptr;
+	setUsedBit(index, false);
 }
 
 /**
@@ -280,6 +324,7 @@ bool gpio_pin_markUsed(ioportid_t port, ioportmask_t pin, const char *msg) {
 		return true;
 	}
 	getBrainUsedPin(index) = msg;
+	setUsedBit(index, true);
 	totalPinsUsed++;
 	return false;
 }
@@ -299,6 +344,7 @@ void gpio_pin_markUnused(ioportid_t port, ioportmask_t pin) {
 	if (getBrainUsedPin(index) != NULL)
 		totalPinsUsed--;
 	getBrainUsedPin(index) = nullptr;
+	setUsedBit(index, false);
 }
 
 const char *getPinFunction(brain_input_pin_e brainPin) {
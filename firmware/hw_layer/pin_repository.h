@@ -28,6 +28,10 @@ class PinRepository {
 void initPinRepository(void);
 EXTERNC bool brain_pin_is_onchip(brain_pin_e brainPin);
 EXTERNC bool brain_pin_is_ext(brain_pin_e brainPin);
+/**
+ * O(1) bitset query, cheaper than fetching the owner name string
+ */
+EXTERNC bool brain_pin_is_used(brain_pin_e brainPin);
 EXTERNC void tle8888_dump_regs(void);
 
 /**
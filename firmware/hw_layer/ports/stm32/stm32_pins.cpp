@@ -49,65 +49,39 @@ static const char *PIN_USED[PIN_REPO_SIZE + BOARD_EXT_PINREPOPINS];
 
 extern ioportid_t PORTS[];
 
+/**
+ * O(1) port-to-index: STM32 GPIO blocks sit at evenly spaced addresses, see
+ * the memory map in the reference manual, so the index is plain address
+ * arithmetic instead of a comparison chain. Validated against the ports table.
+ * @return port index or -1, no error reporting
+ */
+static int getPortAddressIndex(ioportid_t port) {
+	int index = ((uintptr_t)port - (uintptr_t)GPIOA) / ((uintptr_t)GPIOB - (uintptr_t)GPIOA);
+	if (index < 0 || index >= (int)(sizeof(ports) / sizeof(ports[0])) || ports[index] != port)
+		return -1;
+	return index;
+}
+
+static const char *portNames[] = { "PA", "PB", "PC", "PD", "PE", "PF", "PG", "PH" };
+
 /**
  * @deprecated - use hwPortname() instead
  */
 const char *portname(ioportid_t GPIOx) {
-	if (GPIOx == GPIOA)
-		return "PA";
-	if (GPIOx == GPIOB)
-		return "PB";
-	if (GPIOx == GPIOC)
-		return "PC";
-	if (GPIOx == GPIOD)
-		return "PD";
-#if STM32_HAS_GPIOE
-	if (GPIOx == GPIOE)
-		return "PE";
-#endif /* STM32_HAS_GPIOE */
-#if STM32_HAS_GPIOF
-	if (GPIOx == GPIOF)
-		return "PF";
-#endif /* STM32_HAS_GPIOF */
-#if STM32_HAS_GPIOG
-	if (GPIOx == GPIOG)
-		return "PG";
-#endif /* STM32_HAS_GPIOG */
-#if STM32_HAS_GPIOH
-	if (GPIOx == GPIOH)
-		return "PH";
-#endif /* STM32_HAS_GPIOH */
-	return "unknown";
+	int index = getPortAddressIndex(GPIOx);
+	if (index < 0)
+		return "unknown";
+	return portNames[index];
 }
 
 static int getPortIndex(ioportid_t port) {
 	efiAssert(CUSTOM_ERR_ASSERT, port != NULL, "null port", -1);
-	if (port == GPIOA)
-		return 0;
-	if (port == GPIOB)
-		return 1;
-	if (port == GPIOC)
-		return 2;
-	if (port == GPIOD)
-		return 3;
-#if STM32_HAS_GPIOE
-	if (port == GPIOE)
-		return 4;
-#endif /* STM32_HAS_GPIOE */
-#if STM32_HAS_GPIOF
-	if (port == GPIOF)
-		return 5;
-#endif /* STM32_HAS_GPIOF */
-#if STM32_HAS_GPIOG
-	if (port == GPIOG)
-		return 6;
-#endif /* STM32_HAS_GPIOG */
-#if STM32_HAS_GPIOH
-	if (port == GPIOH)
-		return 7;
-#endif /* STM32_HAS_GPIOH */
-	firmwareError(CUSTOM_ERR_UNKNOWN_PORT, "unknown port");
-	return -1;
+	int index = getPortAddressIndex(port);
+	if (index < 0) {
+		firmwareError(CUSTOM_ERR_UNKNOWN_PORT, "unknown port");
+		return -1;
+	}
+	return index;
 }
 
 ioportid_t getBrainPort(brain_pin_e brainPin) {
@@ -123,6 +97,59 @@ int getBrainIndex(ioportid_t port, ioportmask_t pin) {
 	return portIndex * PORT_SIZE + pin;
 }
 
+#if defined(STM32F4XX) || defined(STM32F7XX)
+/**
+ * Configures a set of pins as outputs at a known level with a handful of
+ * port-wide register writes instead of a palSetPadMode() walk. The level is
+ * latched into BSRR before the MODER bits flip the pins to output, so there is
+ * no window where the pin drives the wrong level or floats - this is how the
+ * safety-critical outputs (injectors, coils) are forced safe in the first
+ * microseconds of boot, long before the regular pin repository walk.
+ */
+void palBulkConfigureOutputs(const brain_pin_e *brainPins, int count, bool setHigh, bool openDrain) {
+	// per-port accumulated images, indexed like ports[]
+	uint32_t pinMask[PIN_REPO_SIZE / PORT_SIZE] = { 0 };
+
+	for (int i = 0; i < count; i++) {
+		brain_pin_e brainPin = brainPins[i];
+		if (brainPin < GPIOA_0 || brainPin > BRAIN_PIN_LAST_ONCHIP) {
+			continue;
+		}
+		int portIndex = (brainPin - GPIOA_0) / PORT_SIZE;
+		if (ports[portIndex] == nullptr) {
+			continue;
+		}
+		pinMask[portIndex] |= 1 << getBrainPinIndex(brainPin);
+	}
+
+	for (size_t portIndex = 0; portIndex < PIN_REPO_SIZE / PORT_SIZE; portIndex++) {
+		uint32_t mask = pinMask[portIndex];
+		if (mask == 0) {
+			continue;
+		}
+		ioportid_t port = ports[portIndex];
+		// expand the 16bit pin mask into the 2-bits-per-pin register layout
+		uint32_t mask2 = 0;
+		for (int pin = 0; pin < PORT_SIZE; pin++) {
+			if (mask & (1 << pin)) {
+				mask2 |= 3U << (2 * pin);
+			}
+		}
+		uint32_t moderOutput = mask2 & 0x55555555;
+
+		// output latch first: once MODER flips the pins they drive the safe level
+		port->BSRR = setHigh ? mask : mask << 16;
+		if (openDrain) {
+			port->OTYPER |= mask;
+		} else {
+			port->OTYPER &= ~mask;
+		}
+		port->PUPDR &= ~mask2;
+		port->MODER = (port->MODER & ~mask2) | moderOutput;
+	}
+}
+#endif /* STM32F4XX || STM32F7XX */
+
 ioportid_t getHwPort(const char *msg, brain_pin_e brainPin) {
 	if (brainPin == GPIO_UNASSIGNED || brainPin == GPIO_INVALID)
 		return GPIO_NULL;
@@ -12,6 +12,7 @@
 #include "pin_repository.h"
 #include "stm32f7xx_hal_flash.h"
 #include "os_util.h"
+#include "postmortem_ring.h"
 
 EXTERN_ENGINE;
 
@@ -169,6 +170,8 @@ void prvGetRegistersFromStack(uint32_t *pulFaultStackAddress) {
 
 	postmortem_SCB_SHCSR = SCB->SHCSR;
 
+	postmortemRecordHardFault(postmortem_pc, postmortem_lr, postmortem_CFSR, postmortem_HFSR, postmortem_BFAR);
+
 	if (is_under_debugger()) {
 		__asm("BKPT #0\n");
 		// Break into the debugger
@@ -197,6 +200,8 @@ void HardFaultVector(void) {
 #endif /* 0 && defined __GNUC__ */
 
 	int cfsr = GET_CFSR();
+	postmortemRecordHardFault(0, 0, cfsr,
+			(*((volatile uint32_t *) (0xE000ED2C))), (*((volatile uint32_t *) (0xE000ED38))));
 	if (cfsr & 0x1) {
 		chDbgPanic3("H IACCVIOL", __FILE__, __LINE__);
 	} else if (cfsr & 0x100) {
@@ -0,0 +1,171 @@
+/**
+ * @file	postmortem_ring.cpp
+ * @brief	Crash diagnostic ring in battery-backed SRAM, see postmortem_ring.h
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "postmortem_ring.h"
+
+#if EFI_POSTMORTEM_RING && EFI_PROD_CODE
+
+#include "os_access.h"
+#include "efitime.h"
+#include "cli_registry.h"
+
+// bump the magic when the layout changes, a stale layout is treated as garbage
+#define POSTMORTEM_MAGIC 0x504D5231
+#define POSTMORTEM_WARNING_COUNT 16
+#define POSTMORTEM_MESSAGE_SIZE 64
+
+#define POSTMORTEM_FLAG_FATAL		1
+#define POSTMORTEM_FLAG_HARD_FAULT	2
+
+typedef struct {
+	int32_t code;
+	uint32_t timeSeconds;
+} postmortem_warning_s;
+
+typedef struct {
+	uint32_t magic;
+	uint32_t bootCounter;
+	uint32_t pendingFlags;
+
+	uint32_t warningWriteIndex;
+	postmortem_warning_s warnings[POSTMORTEM_WARNING_COUNT];
+
+	char fatalMessage[POSTMORTEM_MESSAGE_SIZE];
+	char fatalFile[POSTMORTEM_MESSAGE_SIZE];
+	uint32_t fatalLine;
+
+	uint32_t faultPc;
+	uint32_t faultLr;
+	uint32_t faultCfsr;
+	uint32_t faultHfsr;
+	uint32_t faultBfar;
+
+	// scheduler health at the time of death, see event_queue.cpp
+	uint32_t maxSchedulingPrecisionLoss;
+	uint32_t maxEventCallbackDuration;
+} postmortem_state_s;
+
+#if defined(STM32F4XX) || defined(STM32F7XX)
+// .ram5 is the 4k backup SRAM region, not touched by startup initialization
+#define POSTMORTEM_RAM __attribute__((section(".ram5")))
+#else
+#define POSTMORTEM_RAM
+#endif
+
+static postmortem_state_s postmortemState POSTMORTEM_RAM;
+
+static Logging *logger;
+
+extern uint32_t maxSchedulingPrecisionLoss;
+extern uint32_t maxEventCallbackDuration;
+
+static void copyTruncated(char *destination, const char *source, size_t size) {
+	if (source == NULL) {
+		destination[0] = 0;
+		return;
+	}
+	strncpy(destination, source, size - 1);
+	destination[size - 1] = 0;
+}
+
+void postmortemRecordWarning(obd_code_e code) {
+	if (postmortemState.magic != POSTMORTEM_MAGIC) {
+		return;
+	}
+	postmortem_warning_s *slot = &postmortemState.warnings[postmortemState.warningWriteIndex % POSTMORTEM_WARNING_COUNT];
+	slot->code = (int32_t) code;
+	slot->timeSeconds = (uint32_t) getTimeNowSeconds();
+	postmortemState.warningWriteIndex++;
+}
+
+void postmortemRecordFatal(const char *msg, const char *file, int line) {
+	if (postmortemState.magic != POSTMORTEM_MAGIC) {
+		return;
+	}
+	copyTruncated(postmortemState.fatalMessage, msg, POSTMORTEM_MESSAGE_SIZE);
+	copyTruncated(postmortemState.fatalFile, file, POSTMORTEM_MESSAGE_SIZE);
+	postmortemState.fatalLine = (uint32_t) line;
+	postmortemState.maxSchedulingPrecisionLoss = maxSchedulingPrecisionLoss;
+	postmortemState.maxEventCallbackDuration = maxEventCallbackDuration;
+	postmortemState.pendingFlags |= POSTMORTEM_FLAG_FATAL;
+}
+
+void postmortemRecordHardFault(uint32_t pc, uint32_t lr, uint32_t cfsr, uint32_t hfsr, uint32_t bfar) {
+	if (postmortemState.magic != POSTMORTEM_MAGIC) {
+		return;
+	}
+	postmortemState.faultPc = pc;
+	postmortemState.faultLr = lr;
+	postmortemState.faultCfsr = cfsr;
+	postmortemState.faultHfsr = hfsr;
+	postmortemState.faultBfar = bfar;
+	postmortemState.maxSchedulingPrecisionLoss = maxSchedulingPrecisionLoss;
+	postmortemState.maxEventCallbackDuration = maxEventCallbackDuration;
+	postmortemState.pendingFlags |= POSTMORTEM_FLAG_HARD_FAULT;
+}
+
+static void showPostmortem(void) {
+	scheduleMsg(logger, "postmortem boot #%d flags=%x", postmortemState.bootCounter, postmortemState.pendingFlags);
+	if (postmortemState.fatalMessage[0] != 0) {
+		scheduleMsg(logger, "last fatal: %s %s:%d", postmortemState.fatalMessage,
+				postmortemState.fatalFile, postmortemState.fatalLine);
+	}
+	if (postmortemState.faultCfsr != 0 || postmortemState.faultHfsr != 0) {
+		scheduleMsg(logger, "hard fault pc=%x lr=%x CFSR=%x HFSR=%x BFAR=%x",
+				postmortemState.faultPc, postmortemState.faultLr,
+				postmortemState.faultCfsr, postmortemState.faultHfsr, postmortemState.faultBfar);
+	}
+	scheduleMsg(logger, "scheduler: precision loss %d, max callback %d",
+			postmortemState.maxSchedulingPrecisionLoss, postmortemState.maxEventCallbackDuration);
+	int count = minI(postmortemState.warningWriteIndex, POSTMORTEM_WARNING_COUNT);
+	for (int i = 0; i < count; i++) {
+		// oldest first
+		int index = (postmortemState.warningWriteIndex - count + i) % POSTMORTEM_WARNING_COUNT;
+		postmortem_warning_s *slot = &postmortemState.warnings[index];
+		scheduleMsg(logger, "warning #%d: code %d at %d sec", i, slot->code, slot->timeSeconds);
+	}
+}
+
+static void clearPostmortem(void) {
+	uint32_t bootCounter = postmortemState.bootCounter;
+	memset(&postmortemState, 0, sizeof(postmortemState));
+	postmortemState.bootCounter = bootCounter;
+	postmortemState.magic = POSTMORTEM_MAGIC;
+	scheduleMsg(logger, "postmortem cleared");
+}
+
+void initPostmortemRing(Logging *sharedLogger) {
+	logger = sharedLogger;
+
+#if defined(STM32F4XX) || defined(STM32F7XX)
+	// the backup domain is write-protected and unclocked by default
+#if defined(STM32F7XX)
+	PWR->CR1 |= PWR_CR1_DBP;
+#else
+	PWR->CR |= PWR_CR_DBP;
+#endif
+	RCC->AHB1ENR |= RCC_AHB1ENR_BKPSRAMEN;
+#endif /* STM32F4XX || STM32F7XX */
+
+	if (postmortemState.magic != POSTMORTEM_MAGIC) {
+		// first boot with this firmware or backup power was lost
+		memset(&postmortemState, 0, sizeof(postmortemState));
+		postmortemState.magic = POSTMORTEM_MAGIC;
+	} else if (postmortemState.pendingFlags != 0) {
+		// one line so that a field log always shows the previous session died hard
+		scheduleMsg(logger, "postmortem: previous boot #%d ended with flags=%x, see 'postmortem' command",
+				postmortemState.bootCounter, postmortemState.pendingFlags);
+		postmortemState.pendingFlags = 0;
+	}
+	postmortemState.bootCounter++;
+
+	addConsoleAction("postmortem", showPostmortem);
+	addConsoleAction("postmortem_clear", clearPostmortem);
+}
+
+#endif /* EFI_POSTMORTEM_RING && EFI_PROD_CODE */
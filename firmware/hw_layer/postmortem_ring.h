@@ -0,0 +1,39 @@
+/**
+ * @file	postmortem_ring.h
+ * @brief	Crash diagnostic ring in battery-backed SRAM
+ *
+ * Chasing an in-field reset with nothing but a blinking LED means attaching a
+ * debugger and waiting for the next one. This module keeps the last warnings,
+ * the last fatal message and a hard-fault register snapshot in the 4k backup
+ * SRAM region (.ram5), which survives both soft resets and - with a backup
+ * battery - power cycles. After reboot the previous session is announced on
+ * the console and the full ring is readable via the 'postmortem' command.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+#include "obd_error_codes.h"
+
+#if EFI_POSTMORTEM_RING
+
+void initPostmortemRing(Logging *sharedLogger);
+/**
+ * invoked for every warning() - must stay cheap, this is a couple of stores
+ */
+void postmortemRecordWarning(obd_code_e code);
+void postmortemRecordFatal(const char *msg, const char *file, int line);
+/**
+ * invoked from the fault vectors, only plain memory writes happen here
+ */
+void postmortemRecordHardFault(uint32_t pc, uint32_t lr, uint32_t cfsr, uint32_t hfsr, uint32_t bfar);
+
+#else
+#define initPostmortemRing(sharedLogger) {}
+#define postmortemRecordWarning(code) {}
+#define postmortemRecordFatal(msg, file, line) {}
+#define postmortemRecordHardFault(pc, lr, cfsr, hfsr, bfar) {}
+#endif /* EFI_POSTMORTEM_RING */
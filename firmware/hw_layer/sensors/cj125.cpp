@@ -8,6 +8,7 @@
 
 #include "engine.h"
 #include "cj125.h"
+#include "board_features.h"
 #include "pwm_generator.h"
 #include "rpm_calculator.h"
 
@@ -39,9 +40,11 @@ static THD_WORKING_AREA(cj125ThreadStack, UTILITY_THREAD_STACK_SIZE);
 
 static SPIDriver *driver;
 
+static void cjSpiEndCallback(SPIDriver *spip);
+
 static SPIConfig cj125spicfg = {
 		.circular = false,
-		.end_cb = NULL,
+		.end_cb = cjSpiEndCallback,
 		.ssport = NULL,
 		.sspad = 0,
 		.cr1 =
@@ -80,8 +83,76 @@ static constexpr float lambdaLsu49[] = {
 };
 
 
+/**
+ * Asynchronous register read engine: the periodic thread only kicks off a transaction,
+ * the rest proceeds on DMA completion callbacks while the thread sleeps. This way a
+ * slow or contended SPI bus (SD card on shared-bus boards) cannot stall the heater
+ * control loop. Only the diagnostics polling uses this - one-tick-old diag data is
+ * perfectly fine while heater safety decisions are made on fresh ADC values.
+ */
+typedef enum {
+	CJ125_SPI_PHASE_IDLE = 0,
+	CJ125_SPI_PHASE_ADDRESS,
+	CJ125_SPI_PHASE_DATA,
+	CJ125_SPI_PHASE_DONE,
+} cj125_spi_phase_e;
+
+static volatile cj125_spi_phase_e spiPhase = CJ125_SPI_PHASE_IDLE;
+
+static void cjSpiEndCallback(SPIDriver *spip) {
+	// this callback is also invoked for the synchronous exchanges in this file - those
+	// manage their own completion so we only advance the asynchronous state machine
+	if (spiPhase == CJ125_SPI_PHASE_ADDRESS) {
+		spiPhase = CJ125_SPI_PHASE_DATA;
+		chSysLockFromISR();
+		spiStartReceiveI(spip, 1, rx_buff);
+		chSysUnlockFromISR();
+	} else if (spiPhase == CJ125_SPI_PHASE_DATA) {
+		chSysLockFromISR();
+		spiUnselectI(spip);
+		chSysUnlockFromISR();
+		spiPhase = CJ125_SPI_PHASE_DONE;
+	}
+}
+
+static void cjStartDiagRead(void) {
+#if ! EFI_UNIT_TEST
+	tx_buff[0] = DIAG_REG_RD;
+	spiPhase = CJ125_SPI_PHASE_ADDRESS;
+	spiSelect(driver);
+	spiStartSend(driver, 1, tx_buff);
+#endif /* EFI_UNIT_TEST */
+}
+
+/**
+ * Consumes the result of the previous cjStartDiagRead() if it has completed and starts
+ * the next transaction. Never blocks.
+ */
+static void cjPollDiag(CJ125 *instance) {
+	if (spiPhase == CJ125_SPI_PHASE_DONE) {
+		instance->diag = rx_buff[0];
+		spiPhase = CJ125_SPI_PHASE_IDLE;
+	}
+	if (spiPhase == CJ125_SPI_PHASE_IDLE) {
+		cjStartDiagRead();
+	}
+}
+
+/**
+ * Synchronous exchanges may not overlap an in-flight asynchronous transaction - at
+ * 150kHz a diag read completes in well under a millisecond so this never spins long.
+ */
+static void cjWaitForAsyncIdle(void) {
+#if ! EFI_UNIT_TEST
+	while (spiPhase == CJ125_SPI_PHASE_ADDRESS || spiPhase == CJ125_SPI_PHASE_DATA) {
+		chThdSleepMilliseconds(1);
+	}
+#endif /* EFI_UNIT_TEST */
+}
+
 static uint8_t cjReadRegister(uint8_t regAddr) {
 #if ! EFI_UNIT_TEST
+	cjWaitForAsyncIdle();
 	spiSelect(driver);
 	tx_buff[0] = regAddr;
 	spiSend(driver, 1, tx_buff);
@@ -98,6 +169,7 @@ static uint8_t cjReadRegister(uint8_t regAddr) {
 }
 
 static void cjWriteRegister(uint8_t regAddr, uint8_t regValue) {
+	cjWaitForAsyncIdle();
 	tx_buff[0] = regAddr;
 	tx_buff[1] = regValue;
 #ifdef CJ125_DEBUG_SPI
@@ -198,6 +270,10 @@ public:
 
 static RealSpi spi;
 
+/**
+ * Blocking flavor: waits for a fresh slow ADC batch and then reads both channels out
+ * of it. Only used by calibration which needs a known number of distinct samples.
+ */
 static void cjUpdateAnalogValues() {
 #if EFI_PROD_CODE
 	// todo: some solution for testing
@@ -211,6 +287,23 @@ static void cjUpdateAnalogValues() {
 #endif
 }
 
+/**
+ * Non-blocking flavor for the periodic thread: if the slow ADC has not produced a new
+ * batch since we last looked we keep the previous UA/UR readings instead of stalling,
+ * otherwise both channels are read out of the same batch.
+ */
+static void cjPollAnalogValues() {
+#if EFI_PROD_CODE
+	int adcCounter = getSlowAdcCounter();
+	if (adcCounter == lastSlowAdcCounter) {
+		return;
+	}
+	lastSlowAdcCounter = adcCounter;
+#endif
+	globalInstance.vUr = getUr();
+	globalInstance.vUa = getUa();
+}
+
 static void cjCalibrate(void) {
 	globalInstance.cjIdentify();
 
@@ -271,7 +364,7 @@ static void cjCalibrate(void) {
 }
 
 static void cjStart(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
-	if (!CONFIG(isCJ125Enabled)) {
+	if (!board::hasCj125 || !CONFIG(isCJ125Enabled)) {
 		scheduleMsg(logger, "cj125 is disabled.");
 		return;
 	}
@@ -364,8 +457,8 @@ static bool cj125periodic(CJ125 *instance DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	efitick_t nowNt = getTimeNowNt();
 		bool isStopped = engine->rpmCalculator.isStopped(PASS_ENGINE_PARAMETER_SIGNATURE);
 
-		cjUpdateAnalogValues();
-		
+		cjPollAnalogValues();
+
 		// If the controller is disabled
 		if (instance->state == CJ125_IDLE || instance->state == CJ125_ERROR) {
 			return true;
@@ -377,8 +470,8 @@ static bool cj125periodic(CJ125 *instance DECLARE_ENGINE_PARAMETER_SUFFIX) {
 			instance->state = CJ125_INIT;
 			globalInstance.cjSetMode(CJ125_MODE_NORMAL_17);
 		}
-		
-		globalInstance.diag = cjReadRegister(DIAG_REG_RD);
+
+		cjPollDiag(instance);
 
 		// check heater state
 		if (globalInstance.vUr > CJ125_UR_PREHEAT_THR || instance->heaterDuty < CJ125_PREHEAT_MIN_DUTY) {
@@ -523,7 +616,8 @@ float cjGetAfr(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 }
 
 bool cjHasAfrSensor(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
-	if (!CONFIG(isCJ125Enabled))
+	// constant false on boards without the chip, callers lose the branch entirely
+	if (!board::hasCj125 || !CONFIG(isCJ125Enabled))
 		return false;
 	return globalInstance.isValidState();
 }
@@ -548,7 +642,7 @@ void initCJ125(Logging *sharedLogger DECLARE_ENGINE_PARAMETER_SUFFIX) {
 	globalInstance.spi = &spi;
 	globalInstance.logger = sharedLogger;
 
-	if (!CONFIG(isCJ125Enabled)) {
+	if (!board::hasCj125 || !CONFIG(isCJ125Enabled)) {
 		globalInstance.errorCode = CJ125_ERROR_DISABLED;
 		return;
 	}
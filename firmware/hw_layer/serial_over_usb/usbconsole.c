@@ -56,9 +56,100 @@ bool is_usb_serial_ready(void) {
 	return isUsbSerialInitialized && SDU1.config->usbp->state == USB_ACTIVE;
 }
 
+// USB full speed CDC bulk endpoint payload
+#define USB_BULK_PACKET_SIZE 64
+
+static uint8_t txAggregationBuffer[USB_BULK_PACKET_SIZE];
+static int txAggregationFill = 0;
+// how many separate writes contributed to the currently pending packet
+static int writesSinceFlush = 0;
+
+// bytes which travelled through the aggregation buffer
+static uint32_t coalescedByteCounter = 0;
+// bulk transactions we did not have to issue thanks to coalescing
+static uint32_t savedPacketCounter = 0;
+
+static void flushAggregationBuffer(int timeout) {
+	if (txAggregationFill == 0) {
+		return;
+	}
+	chnWriteTimeout(&SDU1, txAggregationBuffer, txAggregationFill, timeout);
+	if (writesSinceFlush > 1) {
+		savedPacketCounter += writesSinceFlush - 1;
+	}
+	txAggregationFill = 0;
+	writesSinceFlush = 0;
+}
+
+/**
+ * Coalescing flavor of a channel write: small writes accumulate until a whole 64-byte
+ * bulk packet is ready, already-aligned spans bypass the buffer. Without this every
+ * three-byte packet header costs its own mostly-empty bulk transaction, which is what
+ * used to throttle console throughput way below USB FS capability.
+ */
+void usb_buffered_write(const uint8_t *buffer, int size, int timeout) {
+	if (size > 0) {
+		writesSinceFlush++;
+	}
+	while (size > 0) {
+		if (txAggregationFill == 0 && size >= USB_BULK_PACKET_SIZE) {
+			// nothing pending and at least one full packet to send: skip the copy
+			int wholePackets = size - size % USB_BULK_PACKET_SIZE;
+			chnWriteTimeout(&SDU1, buffer, wholePackets, timeout);
+			buffer += wholePackets;
+			size -= wholePackets;
+			continue;
+		}
+		int chunk = USB_BULK_PACKET_SIZE - txAggregationFill;
+		if (chunk > size) {
+			chunk = size;
+		}
+		memcpy(txAggregationBuffer + txAggregationFill, buffer, chunk);
+		txAggregationFill += chunk;
+		coalescedByteCounter += chunk;
+		buffer += chunk;
+		size -= chunk;
+		if (txAggregationFill == USB_BULK_PACKET_SIZE) {
+			flushAggregationBuffer(timeout);
+			// keep counting writes against the next packet while this write continues
+			writesSinceFlush = 1;
+		}
+	}
+}
+
+void usb_buffered_flush(int timeout) {
+	flushAggregationBuffer(timeout);
+}
+
+uint32_t getUsbCoalescedBytes(void) {
+	return coalescedByteCounter;
+}
+
+uint32_t getUsbPacketsSaved(void) {
+	return savedPacketCounter;
+}
+
 #else
 bool is_usb_serial_ready(void) {
 	return false;
 }
 
+void usb_buffered_write(const uint8_t *buffer, int size, int timeout) {
+	(void)buffer;
+	(void)size;
+	(void)timeout;
+}
+
+void usb_buffered_flush(int timeout) {
+	(void)timeout;
+}
+
+uint32_t getUsbCoalescedBytes(void) {
+	return 0;
+}
+
+uint32_t getUsbPacketsSaved(void) {
+	return 0;
+}
+
 #endif /* EFI_USB_SERIAL */
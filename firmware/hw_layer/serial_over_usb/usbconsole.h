@@ -18,6 +18,16 @@ extern "C"
 void usb_serial_start(void);
 bool is_usb_serial_ready(void);
 
+/**
+ * TX aggregation: writes are coalesced into full 64-byte bulk packets instead of each
+ * small write costing its own USB transaction, see usbconsole.c. Callers must invoke
+ * usb_buffered_flush() before going idle, otherwise the tail of the data stays pending.
+ */
+void usb_buffered_write(const uint8_t *buffer, int size, int timeout);
+void usb_buffered_flush(int timeout);
+uint32_t getUsbCoalescedBytes(void);
+uint32_t getUsbPacketsSaved(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -0,0 +1,116 @@
+/**
+ * @file	spi_scheduler.cpp
+ * @brief	shared SPI bus arbitration with priority classes and bus-time accounting
+ *
+ * Multiple devices share the SPI buses and until now were coordinated only by
+ * a plain mutex, so a long SD card write could delay a wideband read by
+ * milliseconds. Clients now register with a priority class; bulk clients call
+ * spiClientYield() between multi-block segments and give way whenever a more
+ * latency-sensitive client is queued. Every acquisition is timed so 'spiinfo'
+ * turns random cross-device latency spikes into observable per-device numbers.
+ *
+ * This sits on top of the same global mutex lockSpi() has always used, see
+ * the todo about per-bus locks in hardware.cpp.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_PROD_CODE
+
+#include "os_access.h"
+#include "spi_scheduler.h"
+#include "eficonsole.h"
+
+#define MAX_SPI_CLIENTS 8
+
+static spi_client_s clients[MAX_SPI_CLIENTS];
+static int clientCount = 0;
+
+static MUTEX_DECL(schedulerMtx);
+/**
+ * number of clients of each priority class currently blocked waiting for the
+ * bus, updated under chSysLock
+ */
+static int waitingCount[SPI_PRIO_COUNT];
+
+static Logging logger("SPI scheduler");
+
+spi_client_s *registerSpiClient(const char *name, spi_prio_e prio) {
+	if (clientCount >= MAX_SPI_CLIENTS) {
+		firmwareError(CUSTOM_STACK_SPI, "too many SPI clients: %s", name);
+		return NULL;
+	}
+	spi_client_s *client = &clients[clientCount++];
+	client->name = name;
+	client->prio = prio;
+	return client;
+}
+
+void spiClientAcquire(spi_client_s *client) {
+	chSysLock();
+	waitingCount[client->prio]++;
+	chSysUnlock();
+	chMtxLock(&schedulerMtx);
+	chSysLock();
+	waitingCount[client->prio]--;
+	chSysUnlock();
+	client->acquireCount++;
+	client->acquiredAtUs = getTimeNowUs();
+}
+
+void spiClientRelease(spi_client_s *client) {
+	uint32_t heldUs = getTimeNowUs() - client->acquiredAtUs;
+	client->busTimeUs += heldUs;
+	if (heldUs > client->maxHoldUs) {
+		client->maxHoldUs = heldUs;
+	}
+	chMtxUnlock(&schedulerMtx);
+}
+
+/**
+ * Preemption point for bulk clients: in the middle of a long transfer, between
+ * two self-contained segments, give way if somebody more latency-sensitive is
+ * queued. Mutex queuing hands the bus to the waiter before we re-acquire.
+ *
+ * @return true if the bus was actually given away and re-acquired
+ */
+bool spiClientYield(spi_client_s *client) {
+	bool moreImportantWaiting = false;
+	chSysLock();
+	for (int prio = 0; prio < client->prio; prio++) {
+		if (waitingCount[prio] > 0) {
+			moreImportantWaiting = true;
+			break;
+		}
+	}
+	chSysUnlock();
+	if (!moreImportantWaiting) {
+		return false;
+	}
+	client->yieldCount++;
+	spiClientRelease(client);
+	spiClientAcquire(client);
+	return true;
+}
+
+static void printSpiStats(void) {
+	printSpiClientStats(&logger);
+}
+
+void printSpiClientStats(Logging *logging) {
+	for (int i = 0; i < clientCount; i++) {
+		spi_client_s *client = &clients[i];
+		scheduleMsg(logging, "SPI %s prio=%d acquires=%d busTime=%dus maxHold=%dus yields=%d",
+				client->name, client->prio, client->acquireCount,
+				client->busTimeUs, client->maxHoldUs, client->yieldCount);
+	}
+}
+
+void initSpiScheduler(void) {
+	addConsoleAction("spiinfo", printSpiStats);
+}
+
+#endif /* EFI_PROD_CODE */
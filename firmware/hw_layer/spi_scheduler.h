@@ -0,0 +1,54 @@
+/**
+ * @file	spi_scheduler.h
+ * @brief	shared SPI bus arbitration with priority classes and bus-time accounting
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#ifndef SPI_SCHEDULER_H_
+#define SPI_SCHEDULER_H_
+
+#include "global.h"
+
+#if EFI_PROD_CODE
+
+#include "datalogging.h"
+
+/**
+ * lower value is more latency-sensitive
+ */
+typedef enum {
+	SPI_PRIO_SENSOR = 0,	// wideband, knock - a late read costs control quality
+	SPI_PRIO_CONTROL = 1,	// injector drivers, smart GPIO
+	SPI_PRIO_LOGGING = 2,	// SD card - bulk traffic which can always wait
+	SPI_PRIO_COUNT
+} spi_prio_e;
+
+typedef struct {
+	const char *name;
+	spi_prio_e prio;
+	uint32_t acquireCount;
+	/**
+	 * total and longest time holding the bus, in microseconds
+	 */
+	uint32_t busTimeUs;
+	uint32_t maxHoldUs;
+	/**
+	 * how many times this client gave way at a preemption point
+	 */
+	uint32_t yieldCount;
+	// internal
+	efitimeus_t acquiredAtUs;
+} spi_client_s;
+
+spi_client_s *registerSpiClient(const char *name, spi_prio_e prio);
+void spiClientAcquire(spi_client_s *client);
+void spiClientRelease(spi_client_s *client);
+bool spiClientYield(spi_client_s *client);
+void printSpiClientStats(Logging *logging);
+void initSpiScheduler(void);
+
+#endif /* EFI_PROD_CODE */
+
+#endif /* SPI_SCHEDULER_H_ */
@@ -21,6 +21,16 @@ EXTERN_ENGINE;
 
 static Logging *logger;
 
+/**
+ * the rate ramps up and down over this many steps at the ends of a move
+ */
+#define STEPPER_ACCEL_STEPS 16
+/**
+ * parking drives into the mechanical stop so skipped steps cost nothing - run it
+ * well above cruise to keep the key-on-to-crank time short
+ */
+#define STEPPER_HOMING_RATE_MULTIPLIER 4
+
 static void saveStepperPos(int pos) {
 	// use backup-power RTC registers to store the data
 #if EFI_PROD_CODE
@@ -63,7 +73,7 @@ void StepperMotor::ThreadTask() {
 	if (m_currentPosition < 0 || forceStepperParking) {
 		// reset saved value
 		saveStepperPos(-1);
-		
+
 		/**
 		 * let's park the motor in a known position to begin with
 		 *
@@ -72,43 +82,15 @@ void StepperMotor::ThreadTask() {
 		 *
 		 * Add extra steps to compensate step skipping by some old motors.
 		 */
-		int numParkingSteps = (int)efiRound((1.0f + (float)CONFIG(stepperParkingExtraSteps) / PERCENT_MULT) * m_totalSteps, 1.0f);
-		for (int i = 0; i < numParkingSteps; i++) {
-			m_hw->step(false);
-		}
-
-		// set & save zero stepper position after the parking completion
-		m_currentPosition = 0;
-		saveStepperPos(m_currentPosition);
+		m_homingStepsLeft = (int)efiRound((1.0f + (float)CONFIG(stepperParkingExtraSteps) / PERCENT_MULT) * m_totalSteps, 1.0f);
 	} else {
 		// The initial target position should correspond to the saved stepper position.
 		// Idle thread starts later and sets a new target position.
-		setTargetPosition(m_currentPosition);
+		m_targetPosition = m_currentPosition;
 	}
 
-	while (true) {
-		int targetPosition = getTargetPosition();
-		int currentPosition = m_currentPosition;
-
-		if (targetPosition == currentPosition) {
-			m_hw->pause();
-			continue;
-		}
-		bool isIncrementing = targetPosition > currentPosition;
-
-		if (isIncrementing) {
-			m_currentPosition++;
-		} else {
-			m_currentPosition--;
-		}
-
-		m_hw->step(isIncrementing);
-
-		// save position to backup RTC register
-#if EFI_PROD_CODE
-		saveStepperPos(m_currentPosition);
-#endif
-	}
+	// the boot-time decision is done, from here on the timer callbacks do all the stepping
+	startMotion();
 }
 
 StepperMotor::StepperMotor() : ThreadController("stepper", NORMALPRIO) {}
@@ -119,43 +101,126 @@ int StepperMotor::getTargetPosition() const {
 
 void StepperMotor::setTargetPosition(int targetPosition) {
 	m_targetPosition = targetPosition;
+	startMotion();
 }
 
-void StepDirectionStepper::setDirection(bool isIncrementing) {
-	if (isIncrementing != m_currentDirection) {
-		// compensate stepper motor inertia
-		pause();
-		m_currentDirection = isIncrementing;
+/**
+ * Kick off the timer-driven step sequence if it is not already in flight.
+ *
+ * This is invoked both from the idle thread and at boot; the check against a completing
+ * callback is deliberately lock-free: in the worst interleaving one kick is missed, and
+ * the periodic idle controller repeats setTargetPosition() soon enough to recover.
+ */
+void StepperMotor::startMotion() {
+	if (!m_hw || m_isMoving) {
+		return;
+	}
+	if (m_homingStepsLeft == 0 && m_targetPosition == m_currentPosition) {
+		return;
 	}
+	m_isMoving = true;
+	m_stepsTaken = 0;
+	engine->executor.scheduleForLater(&m_stepSchedule, (int)MS2US(m_hw->getStepTime()), { stepBeginCallback, this });
+}
 
-	directionPin.setValue(isIncrementing);
+int StepperMotor::getStepIntervalUs(int stepsRemaining) {
+	// with the historical thread implementation one step took two reaction times
+	float cruiseRate = 1000.0f / m_hw->getStepTime();
+	if (m_homingStepsLeft > 0) {
+		return (int)(US_PER_SECOND_F / (cruiseRate * STEPPER_HOMING_RATE_MULTIPLIER));
+	}
+	float minRate = cruiseRate / 4;
+	// linear-in-steps trapezoid: whichever end of the move we are closer to wins
+	int rampSteps = minI(m_stepsTaken, stepsRemaining);
+	float rampFraction = minF(1, (float)rampSteps / STEPPER_ACCEL_STEPS);
+	float rate = minRate + (cruiseRate - minRate) * rampFraction;
+	return (int)(US_PER_SECOND_F / rate);
 }
 
-void StepDirectionStepper::pulse() {
-	enablePin.setValue(false); // enable stepper
+void StepperMotor::stepBeginCallback(StepperMotor *motor) {
+	motor->onStepBegin();
+}
+
+void StepperMotor::stepEndCallback(StepperMotor *motor) {
+	motor->onStepEnd();
+}
+
+void StepperMotor::onStepBegin() {
+	bool isIncrementing;
+	int stepsRemaining;
+	if (m_homingStepsLeft > 0) {
+		isIncrementing = false;
+		stepsRemaining = m_homingStepsLeft;
+	} else {
+		int targetPosition = m_targetPosition;
+		if (targetPosition == m_currentPosition) {
+			m_isMoving = false;
+			return;
+		}
+		isIncrementing = targetPosition > m_currentPosition;
+		stepsRemaining = absI(targetPosition - m_currentPosition);
+	}
 
+	if (isIncrementing != m_currentDirectionUp) {
+		// a reversal restarts the acceleration ramp, which replaces the old fixed inertia pause
+		m_currentDirectionUp = isIncrementing;
+		m_stepsTaken = 0;
+	}
+
+	m_hw->beginStep(isIncrementing);
+
+	m_lastIntervalUs = getStepIntervalUs(stepsRemaining);
+	engine->executor.scheduleForLater(&m_stepSchedule, m_lastIntervalUs / 2, { stepEndCallback, this });
+}
+
+void StepperMotor::onStepEnd() {
+	m_hw->endStep();
+	m_stepsTaken++;
+
+	if (m_homingStepsLeft > 0) {
+		m_homingStepsLeft = m_homingStepsLeft - 1;
+		if (m_homingStepsLeft == 0) {
+			// we are parked against the mechanical stop, this is our zero
+			m_currentPosition = 0;
+			saveStepperPos(m_currentPosition);
+			m_stepsTaken = 0;
+		}
+	} else {
+		m_currentPosition += m_currentDirectionUp ? 1 : -1;
+		// save position to backup RTC register
+		saveStepperPos(m_currentPosition);
+	}
+
+	if (m_homingStepsLeft == 0 && m_targetPosition == m_currentPosition) {
+		m_isMoving = false;
+		return;
+	}
+	engine->executor.scheduleForLater(&m_stepSchedule, m_lastIntervalUs - m_lastIntervalUs / 2, { stepBeginCallback, this });
+}
+
+void StepDirectionStepper::beginStep(bool positive) {
+	if (positive != m_currentDirection) {
+		m_currentDirection = positive;
+		directionPin.setValue(positive);
+	}
+
+	enablePin.setValue(false); // enable stepper
 	stepPin.setValue(true);
-	pause();
+}
 
+void StepDirectionStepper::endStep() {
 	stepPin.setValue(false);
-	pause();
-
 	enablePin.setValue(true); // disable stepper
 }
 
-void StepperHw::pause() const {
-	chThdSleepMilliseconds(m_reactionTime);
+float StepperHw::getStepTime() const {
+	return m_reactionTime;
 }
 
 void StepperHw::setReactionTime(float ms) {
 	m_reactionTime = maxF(1, ms);
 }
 
-void StepDirectionStepper::step(bool positive) {
-	setDirection(positive);
-	pulse();
-}
-
 void StepperMotor::initialize(StepperHw *hardware, int totalSteps, Logging *sharedLogger) {
 	m_totalSteps = maxI(3, totalSteps);
 
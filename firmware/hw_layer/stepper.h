@@ -11,11 +11,20 @@
 #include "efi_gpio.h"
 #include "backup_ram.h"
 #include "thread_controller.h"
+#include "scheduler.h"
 
 class StepperHw {
 public:
-	virtual void step(bool positive) = 0;
-	void pause() const;
+	/**
+	 * latch the direction and raise the step edge, returns immediately
+	 */
+	virtual void beginStep(bool positive) = 0;
+	/**
+	 * finish the step pulse started by beginStep()
+	 */
+	virtual void endStep() = 0;
+
+	float getStepTime() const;
 
 protected:
 	void setReactionTime(float ms);
@@ -28,18 +37,27 @@ class StepDirectionStepper final : public StepperHw {
 public:
 	void initialize(brain_pin_e stepPin, brain_pin_e directionPin, pin_output_mode_e directionPinMode, float reactionTime, brain_pin_e enablePin, pin_output_mode_e enablePinMode);
 
-	void step(bool positive) override;
+	void beginStep(bool positive) override;
+	void endStep() override;
 
 private:
-	void pulse();
-	void setDirection(bool isIncrementing);
-
 	bool m_currentDirection = false;
 
 	OutputPin directionPin, stepPin, enablePin;
 	pin_output_mode_e directionPinMode, stepPinMode, enablePinMode;
 };
 
+/**
+ * Step pulses are generated by the microsecond scheduler, not by a thread: each step is a
+ * pair of timer events so the pulse cadence is immune to thread scheduling jitter. The step
+ * rate follows a trapezoidal profile - ramp up from a quarter of the cruise rate, cruise,
+ * ramp down over the last few steps - so the valve moves faster without skipping steps at
+ * the ends of a move. Boot-time parking runs at a multiple of the cruise rate since we are
+ * driving into the mechanical stop anyway, see STEPPER_HOMING_RATE_MULTIPLIER.
+ *
+ * The thread below only makes the one-time parking decision at boot, all motion is
+ * timer-driven.
+ */
 class StepperMotor final : private ThreadController<UTILITY_THREAD_STACK_SIZE> {
 public:
 	StepperMotor();
@@ -56,9 +74,29 @@ protected:
 	void ThreadTask() override;
 
 private:
+	static void stepBeginCallback(StepperMotor *motor);
+	static void stepEndCallback(StepperMotor *motor);
+	void onStepBegin();
+	void onStepEnd();
+	int getStepIntervalUs(int stepsRemaining);
+	void startMotion();
+
 	StepperHw* m_hw = nullptr;
 
+	scheduling_s m_stepSchedule;
+
 	int m_targetPosition = 0;
+	/**
+	 * while positive we are parking: stepping down regardless of position
+	 */
+	volatile int m_homingStepsLeft = 0;
+	volatile bool m_isMoving = false;
+	bool m_currentDirectionUp = false;
+	/**
+	 * steps since motion start or last direction reversal, drives the acceleration ramp
+	 */
+	int m_stepsTaken = 0;
+	int m_lastIntervalUs = 0;
 };
 
 #endif /* STEPPER_H_ */
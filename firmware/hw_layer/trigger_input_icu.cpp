@@ -100,11 +100,11 @@ int icuTriggerTurnOnInputPin(const char *msg, int index, bool isTriggerShaft) {
 
 	if (isTriggerShaft) {
 		void * arg = (void*) (index == 0);
-		input->setWidthCallback((VoidInt)(void*)shaftWidthCallback, arg);
-		input->setPeriodCallback((VoidInt)(void*)shaftPeriodCallback, arg);
+		input->setWidthCallback((VoidPtr)(void*)shaftWidthCallback, arg);
+		input->setPeriodCallback((VoidPtr)(void*)shaftPeriodCallback, arg);
 	} else {
-		input->setWidthCallback((VoidInt)(void*)vvtWidthCallback, NULL);
-		input->setPeriodCallback((VoidInt)(void*)vvtPeriodCallback, NULL);
+		input->setWidthCallback((VoidPtr)(void*)vvtWidthCallback, NULL);
+		input->setPeriodCallback((VoidPtr)(void*)vvtPeriodCallback, NULL);
 	}
 
 	return 0;
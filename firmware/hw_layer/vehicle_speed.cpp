@@ -21,6 +21,19 @@ static Logging *logger;
 static efitick_t lastSignalTimeNt = 0;
 static efitick_t vssDiff = 0;
 
+/**
+ * Median/low-pass filter stage: the capture callback only stores the raw tooth
+ * period, all math happens on the consumer side. The median of the last few
+ * periods rejects single-edge jitter from tooth asymmetry, the exponential stage
+ * smooths what remains - one step per received edge, not per consumer call.
+ */
+#define VSS_FILTER_SIZE 5
+#define VSS_SMOOTHING_ALPHA 0.3f
+static volatile efitick_t vssPeriods[VSS_FILTER_SIZE];
+static volatile int vssPeriodIndex = 0;
+static float filteredVehicleSpeed = 0;
+static uint32_t lastFilterEventCounter = 0;
+
 #define DEFAULT_MOCK_SPEED -1
 static float mockVehicleSpeed = DEFAULT_MOCK_SPEED; // in kilometers per hour
 
@@ -37,10 +50,39 @@ float getVehicleSpeed(void) {
 	if (!hasVehicleSpeedSensor())
 		return 0;
 	efitick_t nowNt = getTimeNowNt();
-	if (nowNt - lastSignalTimeNt > NT_PER_SECOND)
+	if (nowNt - lastSignalTimeNt > NT_PER_SECOND) {
+		filteredVehicleSpeed = 0;
 		return 0; // previous signal time is too long ago - we are stopped
-
-	return engineConfiguration->vehicleSpeedCoef * NT_PER_SECOND / vssDiff;
+	}
+
+	// snapshot and insertion-sort the tiny period ring, median is the middle one
+	efitick_t samples[VSS_FILTER_SIZE];
+	for (int i = 0; i < VSS_FILTER_SIZE; i++) {
+		samples[i] = vssPeriods[i];
+	}
+	for (int i = 1; i < VSS_FILTER_SIZE; i++) {
+		efitick_t value = samples[i];
+		int j = i;
+		while (j > 0 && samples[j - 1] > value) {
+			samples[j] = samples[j - 1];
+			j--;
+		}
+		samples[j] = value;
+	}
+	efitick_t medianPeriod = samples[VSS_FILTER_SIZE / 2];
+	if (medianPeriod == 0) {
+		// not enough edges seen yet
+		return 0;
+	}
+	float rawSpeed = engineConfiguration->vehicleSpeedCoef * NT_PER_SECOND / medianPeriod;
+
+	uint32_t eventCounter = engine->engineState.vssEventCounter;
+	if (eventCounter != lastFilterEventCounter) {
+		lastFilterEventCounter = eventCounter;
+		filteredVehicleSpeed = filteredVehicleSpeed == 0 ? rawSpeed
+				: filteredVehicleSpeed + VSS_SMOOTHING_ALPHA * (rawSpeed - filteredVehicleSpeed);
+	}
+	return filteredVehicleSpeed;
 }
 
 static void vsAnaWidthCallback(void) {
@@ -48,6 +90,10 @@ static void vsAnaWidthCallback(void) {
 	efitick_t nowNt = getTimeNowNt();
 	vssDiff = nowNt - lastSignalTimeNt;
 	lastSignalTimeNt = nowNt;
+	// one ring slot write per edge, everything else runs on the consumer side
+	int index = vssPeriodIndex + 1 == VSS_FILTER_SIZE ? 0 : vssPeriodIndex + 1;
+	vssPeriods[index] = vssDiff;
+	vssPeriodIndex = index;
 }
 
 static void speedInfo(void) {
@@ -58,7 +104,7 @@ static void speedInfo(void) {
 			engineConfiguration->vehicleSpeedCoef,
 			engine->engineState.vssEventCounter,
 			getVehicleSpeed());
-	scheduleMsg(logger, "vss diff %d", vssDiff);
+	scheduleMsg(logger, "vss diff %d filtered speed=%.2f", vssDiff, filteredVehicleSpeed);
 
 }
 
@@ -75,7 +121,7 @@ void startVSSPins(void) {
 		return;
 	digital_input_s* vehicleSpeedInput = addWaveAnalyzerDriver("VSS", CONFIG(vehicleSpeedSensorInputPin));
 	startInputDriver("VSS", vehicleSpeedInput, true);
-	vehicleSpeedInput->widthListeners.registerCallback((VoidInt) vsAnaWidthCallback, NULL);
+	vehicleSpeedInput->setWidthCallback((VoidPtr) vsAnaWidthCallback, NULL);
 }
 
 void initVehicleSpeed(Logging *l) {
@@ -0,0 +1,114 @@
+/**
+ * @file	warm_boot.cpp
+ * @brief	trigger sync preservation across controlled resets
+ *
+ * A firmware reset used to cost a full trigger resync plus whatever state the
+ * controllers had learned - a multi-second disruption for a config change which
+ * merely requires a reboot. The learned trims already survive through the
+ * learned value store (see backup_ram.cpp); this module closes the remaining
+ * gap by stashing the trigger phase and the RPM estimate in backup SRAM just
+ * before a controlled reset and handing them back to the decoder on the next
+ * boot, so sync resumes with the first tooth instead of waiting for the
+ * synchronization gap.
+ *
+ * Validity protocol: the stash carries a magic, the firmware version and a
+ * checksum, and is consumed exactly once - a stale or foreign stash is
+ * discarded and the boot proceeds cold. If the restored phase turns out wrong
+ * (the crank moved further than expected during the reset), the decoder's
+ * per-cycle event count validation flags it and resyncs at the next gap, which
+ * is no worse than a cold boot. Watchdog resets come up cold on purpose: there
+ * is no opportunity to stash at the moment of a hang, and state captured
+ * around one would not be trustworthy anyway.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+
+#if EFI_WARM_BOOT
+
+#include "os_access.h"
+#include "warm_boot.h"
+#include "engine.h"
+#include "trigger_central.h"
+#include "rpm_calculator.h"
+#include "error_handling.h"
+#include "eficonsole.h"
+
+EXTERN_ENGINE
+;
+
+#define WARM_BOOT_MAGIC 0x57424F31
+
+typedef struct {
+	uint32_t magic;
+	// a stash from a different firmware build is not trusted
+	uint32_t firmwareVersion;
+	uint32_t triggerIndex;
+	uint32_t revolutionCounter;
+	float rpm;
+	uint32_t checksum;
+} warm_boot_state_s;
+
+// .ram5 is the 4k backup SRAM region, not touched by startup initialization
+#define WARM_BOOT_RAM __attribute__((section(".ram5")))
+static warm_boot_state_s warmBootState WARM_BOOT_RAM;
+
+static Logging *logger;
+static bool restoredThisBoot = false;
+
+static uint32_t warmBootChecksum(const warm_boot_state_s *state) {
+	return state->magic ^ state->firmwareVersion ^ state->triggerIndex
+			^ state->revolutionCounter ^ (uint32_t)(state->rpm * 10);
+}
+
+void warmBootStash(void) {
+	TriggerState *state = &engine->triggerCentral.triggerState;
+	if (!state->shaft_is_synchronized) {
+		// nothing worth preserving, let the next boot come up cold
+		warmBootState.magic = 0;
+		return;
+	}
+	warmBootState.firmwareVersion = getRusEfiVersion();
+	warmBootState.triggerIndex = state->getCurrentIndex();
+	warmBootState.revolutionCounter = state->getTotalRevolutionCounter();
+	float rpm = GET_RPM();
+	warmBootState.rpm = cisnan(rpm) ? 0 : rpm;
+	warmBootState.magic = WARM_BOOT_MAGIC;
+	warmBootState.checksum = warmBootChecksum(&warmBootState);
+}
+
+static void showWarmBoot(void) {
+	scheduleMsg(logger, "warm boot: %s, stash %s", restoredThisBoot ? "restored" : "cold",
+			warmBootState.magic == WARM_BOOT_MAGIC ? "armed" : "empty");
+}
+
+void warmBootRestore(Logging *sharedLogger) {
+	logger = sharedLogger;
+	addConsoleAction("warmbootinfo", showWarmBoot);
+
+	if (warmBootState.magic != WARM_BOOT_MAGIC) {
+		return;
+	}
+	bool valid = warmBootState.checksum == warmBootChecksum(&warmBootState)
+			&& warmBootState.firmwareVersion == (uint32_t)getRusEfiVersion();
+	// consumed exactly once - an uncontrolled reset right after this point
+	// would otherwise resurrect a long-stale phase
+	warmBootState.magic = 0;
+	if (!valid) {
+		scheduleMsg(logger, "warm boot stash rejected");
+		return;
+	}
+
+	engine->triggerCentral.triggerState.restoreSynchronization(warmBootState.triggerIndex,
+			warmBootState.revolutionCounter);
+	// seed the estimate so event scheduling has a sane angle-to-time scale
+	// from the very first tooth, the decoder refines it immediately
+	ENGINE(rpmCalculator).assignRpmValue(warmBootState.rpm PASS_ENGINE_PARAMETER_SUFFIX);
+	restoredThisBoot = true;
+	scheduleMsg(logger, "warm boot: resuming sync at index %d, %f RPM",
+			warmBootState.triggerIndex, warmBootState.rpm);
+}
+
+#endif /* EFI_WARM_BOOT */
@@ -0,0 +1,34 @@
+/**
+ * @file	warm_boot.h
+ * @brief	trigger sync preservation across controlled resets, see warm_boot.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#ifndef WARM_BOOT_H_
+#define WARM_BOOT_H_
+
+#include "global.h"
+
+#if EFI_WARM_BOOT
+
+#include "datalogging.h"
+
+/**
+ * captures trigger phase and RPM into backup SRAM, invoked right before a
+ * controlled reset
+ */
+void warmBootStash(void);
+/**
+ * one-shot: applies a valid stash to the trigger decoder and invalidates it,
+ * invoked once at boot after the trigger shapes are ready
+ */
+void warmBootRestore(Logging *sharedLogger);
+
+#else
+#define warmBootStash() {}
+#define warmBootRestore(sharedLogger) {}
+#endif /* EFI_WARM_BOOT */
+
+#endif /* WARM_BOOT_H_ */
@@ -6,6 +6,10 @@
 #include "linear_func.h"
 #include "tps.h"
 
+#if EFI_ELECTRONIC_THROTTLE_BODY
+#include "electronic_throttle.h"
+#endif /* EFI_ELECTRONIC_THROTTLE_BODY */
+
 EXTERN_ENGINE;
 
 LinearFunc tpsFunc1p;
@@ -47,6 +51,13 @@ static void initTpsFunc(LinearFunc& func, FunctionalSensor& sensor, adc_channel_
 void initTps() {
 	initTpsFunc(tpsFunc1p, tpsSens1p, CONFIG(tps1_1AdcChannel), CONFIG(tpsMin), CONFIG(tpsMax));
 	initTpsFunc(tpsFunc2p, tpsSens2p, CONFIG(tps2_1AdcChannel), CONFIG(tps2Min), CONFIG(tps2Max));
+
+#if EFI_ELECTRONIC_THROTTLE_BODY
+	// push mode: a throttle position movement beyond 0.1% pulls the ETB PID iteration in,
+	// see etbOnTpsChanged
+	tpsSens1p.setOnChange(etbOnTpsChanged, 0.1f);
+	tpsSens2p.setOnChange(etbOnTpsChanged, 0.1f);
+#endif /* EFI_ELECTRONIC_THROTTLE_BODY */
 }
 
 void reconfigureTps() {
@@ -112,10 +112,15 @@
 #include "efi_gpio.h"
 
 #include "rfi_perftest.h"
+#include "boot_profiler.h"
+#include "prearm.h"
+#include "warm_boot.h"
+#include "memory_report.h"
 #include "rusefi.h"
 #include "memstreams.h"
 
 #include "eficonsole.h"
+#include "console_io.h"
 #include "status_loop.h"
 #include "pin_repository.h"
 #include "flash_main.h"
@@ -146,6 +151,8 @@ EXTERN_ENGINE
 
 // todo: move this into a hw-specific file
 void rebootNow(void) {
+	// a controlled reset is the one chance to preserve trigger sync
+	warmBootStash();
 	NVIC_SystemReset();
 }
 
@@ -168,6 +175,8 @@ void runRusEfi(void) {
 	initIntermediateLoggingBuffer();
 	addConsoleAction(CMD_REBOOT, scheduleReboot);
 	addConsoleAction(CMD_REBOOT_DFU, jump_to_bootloader);
+	initBootProfiler();
+	initMemoryReport();
 
 #if EFI_SHAFT_POSITION_INPUT
 	/**
@@ -205,6 +214,8 @@ void runRusEfi(void) {
 	 */
 	initializeConsole(&sharedLogger);
 
+	bootProfilerMark("console");
+
 	/**
 	 * Initialize hardware drivers
 	 */
@@ -218,6 +229,20 @@ void runRusEfi(void) {
 	initEngineContoller(&sharedLogger PASS_ENGINE_PARAMETER_SIGNATURE);
 	rememberCurrentConfiguration();
 
+#if EFI_KEYON_PREARM
+	// absorb whatever the pre-arm worker is still finishing and publish readiness
+	prearmJoinAll();
+#endif /* EFI_KEYON_PREARM */
+
+	// trigger shapes are ready, a phase stashed across a controlled reset can
+	// be adopted before the first tooth arrives
+	warmBootRestore(&sharedLogger);
+
+	// trigger decoding and injection are live at this point, now we can afford
+	// to spend time on the subsystems nobody needs for engine start
+	bootProfilerMark("crankable");
+	runDeferredBootInit();
+
 #if EFI_PERF_METRICS
 	initTimePerfActions(&sharedLogger);
 #endif
@@ -243,7 +268,13 @@ void runRusEfi(void) {
 		updateDevConsoleState();
 #endif /* EFI_CLI_SUPPORT */
 
-		chThdSleepMilliseconds(CONFIG(consoleLoopPeriodMs));
+		int consolePeriodMs = CONFIG(consoleLoopPeriodMs);
+		if (!isConsoleActive()) {
+			// no consumer attached - relax the loop, the first received byte
+			// brings us back to full rate within one relaxed period
+			consolePeriodMs = 5 * consolePeriodMs;
+		}
+		chThdSleepMilliseconds(consolePeriodMs);
 	}
 }
 
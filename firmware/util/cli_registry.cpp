@@ -30,11 +30,21 @@ static Logging * logging;
 static int consoleActionCount = 0;
 static TokenCallback consoleActions[CONSOLE_MAX_ACTIONS] CCM_OPTIONAL;
 
+/**
+ * Dispatch goes through this token-sorted index: with a couple hundred registered
+ * commands a linear scan per received line is not free, and the console shares its
+ * channel with the binary protocol. The index is (re)built lazily on the first
+ * lookup after a registration - registrations only happen during initialization.
+ */
+static TokenCallback *sortedActions[CONSOLE_MAX_ACTIONS] CCM_OPTIONAL;
+static bool isSortedIndexReady = false;
+
 #define SECURE_LINE_PREFIX "sec!"
 #define SECURE_LINE_PREFIX_LENGTH 4
 
 void resetConsoleActions(void) {
 	consoleActionCount = 0;
+	isSortedIndexReady = false;
 }
 
 static void doAddAction(const char *token, action_type_e type, Void callback, void *param) {
@@ -57,6 +67,7 @@ static void doAddAction(const char *token, action_type_e type, Void callback, vo
 	current->parameterType = type;
 	current->callback = callback;
 	current->param = param;
+	isSortedIndexReady = false;
 #endif /* EFI_DISABLE_CONSOLE_ACTIONS */
 }
 
@@ -164,15 +175,53 @@ static int getParameterCount(action_type_e parameterType) {
 	}
 }
 
+static void buildSortedIndex(void) {
+	// insertion sort of pointers, runs once after the last registration
+	for (int i = 0; i < consoleActionCount; i++) {
+		TokenCallback *current = &consoleActions[i];
+		int j = i;
+		while (j > 0 && strcmp(sortedActions[j - 1]->token, current->token) > 0) {
+			sortedActions[j] = sortedActions[j - 1];
+			j--;
+		}
+		sortedActions[j] = current;
+	}
+	isSortedIndexReady = true;
+}
+
+static TokenCallback *findAction(const char *token) {
+	if (!isSortedIndexReady) {
+		buildSortedIndex();
+	}
+	int low = 0;
+	int high = consoleActionCount - 1;
+	while (low <= high) {
+		int middle = (low + high) / 2;
+		int result = strcmp(token, sortedActions[middle]->token);
+		if (result == 0) {
+			return sortedActions[middle];
+		}
+		if (result < 0) {
+			high = middle - 1;
+		} else {
+			low = middle + 1;
+		}
+	}
+	return NULL;
+}
+
 /**
  * @brief This function prints out a list of all available commands
  */
 void helpCommand(void) {
 
 #if EFI_PROD_CODE || EFI_SIMULATOR
+	if (!isSortedIndexReady) {
+		buildSortedIndex();
+	}
 	scheduleMsg(logging, "%d actions available", consoleActionCount);
 	for (int i = 0; i < consoleActionCount; i++) {
-		TokenCallback *current = &consoleActions[i];
+		TokenCallback *current = sortedActions[i];
 		scheduleMsg(logging, "  %s: %d parameters", current->token, getParameterCount(current->parameterType));
 	}
 #endif
@@ -511,44 +560,42 @@ char *validateSecureLine(char *line) {
 }
 
 static char confirmation[200];
-static char handleBuffer[200];
 
-static bool handleConsoleLineInternal(const char *commandLine, int lineLength) {
-	strncpy(handleBuffer, commandLine, sizeof(handleBuffer) - 1);
-	handleBuffer[sizeof(handleBuffer) - 1] = 0; // we want this to be null-terminated for sure
-	char *line = handleBuffer;
+/**
+ * Parses in place over the RX buffer: validateSecureLine() above already writes
+ * into the line, so every caller hands us a private writable buffer anyway and
+ * another copy would buy nothing.
+ */
+static bool handleConsoleLineInternal(char *line, int lineLength) {
 	int firstTokenLength = tokenLength(line);
 
-//	print("processing [%s] with %d actions\r\n", line, consoleActionCount);
-
 	if (firstTokenLength == lineLength) {
 		// no-param actions are processed here
-		for (int i = 0; i < consoleActionCount; i++) {
-			TokenCallback *current = &consoleActions[i];
-			if (strEqual(line, current->token)) {
-				if (current->parameterType == NO_PARAMETER) {
-					(*current->callback)();
-				} else if (current->parameterType == NO_PARAMETER_P) {
-					VoidPtr cb = (VoidPtr) current->callback;
-					(*cb)(current->param);
-				}
-				return true;
-			}
+		TokenCallback *current = findAction(line);
+		if (current == NULL) {
+			return false;
 		}
-	} else {
-		char *ptr = line + firstTokenLength;
-		ptr[0] = 0; // change space into line end
-		ptr++; // start from next symbol
-
-		for (int i = 0; i < consoleActionCount; i++) {
-			TokenCallback *current = &consoleActions[i];
-			if (strEqual(line, current->token)) {
-				handleActionWithParameter(current, ptr);
-				return true;
-			}
+		if (current->parameterType == NO_PARAMETER) {
+			(*current->callback)();
+		} else if (current->parameterType == NO_PARAMETER_P) {
+			VoidPtr cb = (VoidPtr) current->callback;
+			(*cb)(current->param);
 		}
+		return true;
+	}
+
+	char *ptr = line + firstTokenLength;
+	ptr[0] = 0; // change space into line end
+	ptr++; // start from next symbol
+
+	TokenCallback *current = findAction(line);
+	if (current == NULL) {
+		// put the space back so the 'unknown command' report shows the whole line
+		*(ptr - 1) = SPACE_CHAR;
+		return false;
 	}
-	return false;
+	handleActionWithParameter(current, ptr);
+	return true;
 }
 
 #if EFI_PROD_CODE || EFI_SIMULATOR
@@ -185,4 +185,79 @@ void cyclic_buffer<T, maxSize>::clear() {
 	currentIndex = 0;
 }
 
+/**
+ * Power-of-two variant of cyclic_buffer: index wrap is a bit mask instead of a
+ * modulo, and the sum over the window is maintained incrementally on add/evict
+ * so getRunningSum() is O(1) regardless of window length. The plain
+ * cyclic_buffer recomputes sum() by scanning every element, which hides O(n)
+ * work inside an innocuous-looking getter - use this variant for counters
+ * queried from ISRs or per-event code. For O(1) sliding min/max see
+ * monotonic_deque.
+ */
+template<typename T, size_t maxSize = CB_MAX_SIZE>
+class running_cyclic_buffer
+{
+	static_assert(maxSize > 0 && (maxSize & (maxSize - 1)) == 0, "maxSize must be a power of two");
+  public:
+	running_cyclic_buffer() {
+		setSize(maxSize);
+	}
+	explicit running_cyclic_buffer(int size) {
+		setSize(size);
+	}
+
+	void add(T value) {
+		if (count >= size) {
+			// the element 'size' writes back falls out of the window
+			runningSum -= elements[(currentIndex - size) & (maxSize - 1)];
+		}
+		runningSum += value;
+		elements[currentIndex & (maxSize - 1)] = value;
+		++currentIndex;
+		++count;
+	}
+
+	T get(int index) const {
+		// the mask handles negative relative indexes for free
+		return elements[index & (maxSize - 1)];
+	}
+
+	/**
+	 * @return sum of the last getSize() added elements, constant time
+	 */
+	T getRunningSum() const {
+		return runningSum;
+	}
+
+	void setSize(unsigned int size) {
+		clear();
+		this->size = size < maxSize ? size : maxSize;
+	}
+
+	int getSize() const {
+		return size;
+	}
+
+	int getCount() const {
+		return count;
+	}
+
+	void clear() {
+		memset((void*) elements, 0, sizeof(elements));
+		runningSum = 0;
+		count = 0;
+		currentIndex = 0;
+	}
+
+  private:
+	volatile T elements[maxSize];
+	volatile T runningSum;
+	volatile int currentIndex;
+	/**
+	 * number of elements added into this buffer, would be eventually bigger then size
+	 */
+	volatile int count;
+	int size;
+};
+
 #endif //CYCLIC_BUFFER_H
@@ -0,0 +1,152 @@
+/**
+ * @file	ext_table_cache.h
+ *
+ * High resolution tables behind a working-set cache. persistent_config_s has to
+ * fit internal flash and RAM, which caps tune tables at 16x16; this class keeps
+ * a bigger table (32x32 and beyond) on external storage - SPI flash, SD card,
+ * anything able to serve a rectangular block read - and caches only the active
+ * RPM/load neighborhood in RAM. Lookups use the same bin-hint mechanism as
+ * Map3D, so at steady state a getValue() is two hinted index checks and a
+ * bilinear blend from the cached window; the backing store is only touched when
+ * the operating point approaches the window edge (prefetch) or jumps outside of
+ * it entirely (demand miss).
+ *
+ * The backing store is a callback on purpose: this tree has no universal
+ * external flash driver, and boards provide whatever block read their hardware
+ * supports. The cache does not care whether a fetch takes microseconds (SPI
+ * flash) or milliseconds (SD) - a slow store simply makes the prefetch margin
+ * more valuable.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#ifndef EXT_TABLE_CACHE_H_
+#define EXT_TABLE_CACHE_H_
+
+#include "table_helper.h"
+
+/**
+ * how close to the cached window edge the operating point may get before the
+ * window is recentered ahead of time
+ */
+#define EXT_TABLE_PREFETCH_MARGIN 1
+
+template<int SIZE, int WINDOW>
+class ExtTableCache : public ValueProvider3D {
+public:
+	/**
+	 * reads a WINDOW x WINDOW block starting at (startRpmIndex, startLoadIndex)
+	 * into dest, rpm-major. @return false when the store could not serve the read
+	 */
+	typedef bool (*ext_table_fetch_f)(void *arg, int startRpmIndex, int startLoadIndex,
+			int rows, int cols, float *dest);
+
+	void init(const float rpmBins[SIZE], const float loadBins[SIZE],
+			ext_table_fetch_f fetch, void *fetchArg) {
+		this->rpmBins = rpmBins;
+		this->loadBins = loadBins;
+		this->fetch = fetch;
+		this->fetchArg = fetchArg;
+		windowValid = false;
+		fetchCount = 0;
+		missCount = 0;
+		rpmIndexHint = -1;
+		loadIndexHint = -1;
+	}
+
+	float getValue(float xRpm, float y) override {
+		int rpmIndex = findIndexFixedWithHint<SIZE, float>(rpmBins, xRpm, &rpmIndexHint);
+		int loadIndex = findIndexFixedWithHint<SIZE, float>(loadBins, y, &loadIndexHint);
+		rpmIndex = maxI(0, minI(rpmIndex, SIZE - 2));
+		loadIndex = maxI(0, minI(loadIndex, SIZE - 2));
+
+		if (!ensureWindow(rpmIndex, loadIndex)) {
+			// the backing store failed us, the edge cell is the best we have
+			return windowValid ? cache[0][0] : 0;
+		}
+
+		float rpmFraction = maxF(0, minF((xRpm - rpmBins[rpmIndex])
+				/ (rpmBins[rpmIndex + 1] - rpmBins[rpmIndex]), 1));
+		float loadFraction = maxF(0, minF((y - loadBins[loadIndex])
+				/ (loadBins[loadIndex + 1] - loadBins[loadIndex]), 1));
+
+		int r = rpmIndex - rpmStart;
+		int l = loadIndex - loadStart;
+		float v00 = cache[r][l];
+		float v01 = cache[r][l + 1];
+		float v10 = cache[r + 1][l];
+		float v11 = cache[r + 1][l + 1];
+		float low = v00 + (v10 - v00) * rpmFraction;
+		float high = v01 + (v11 - v01) * rpmFraction;
+		return low + (high - low) * loadFraction;
+	}
+
+	int getFetchCount() const {
+		return fetchCount;
+	}
+
+	int getMissCount() const {
+		return missCount;
+	}
+
+private:
+	static int clampWindowStart(int center) {
+		return maxI(0, minI(center - WINDOW / 2, SIZE - WINDOW));
+	}
+
+	/**
+	 * @return true when the cells [index, index + 1] sit outside the cached span
+	 */
+	bool isMiss(int index, int start) const {
+		return index < start || index + 1 > start + WINDOW - 1;
+	}
+
+	/**
+	 * @return true when the operating point is within the prefetch margin of a
+	 * window edge which can still move in that direction
+	 */
+	bool wantsRecenter(int index, int start) const {
+		if (index - start < EXT_TABLE_PREFETCH_MARGIN && start > 0) {
+			return true;
+		}
+		return (start + WINDOW - 1) - (index + 1) < EXT_TABLE_PREFETCH_MARGIN
+				&& start + WINDOW < SIZE;
+	}
+
+	bool ensureWindow(int rpmIndex, int loadIndex) {
+		bool miss = !windowValid || isMiss(rpmIndex, rpmStart) || isMiss(loadIndex, loadStart);
+		bool prefetchDue = miss || wantsRecenter(rpmIndex, rpmStart) || wantsRecenter(loadIndex, loadStart);
+		if (!prefetchDue) {
+			return true;
+		}
+		if (miss) {
+			missCount++;
+		}
+		int newRpmStart = clampWindowStart(rpmIndex);
+		int newLoadStart = clampWindowStart(loadIndex);
+		fetchCount++;
+		if (!fetch(fetchArg, newRpmStart, newLoadStart, WINDOW, WINDOW, &cache[0][0])) {
+			return !miss && windowValid;
+		}
+		rpmStart = newRpmStart;
+		loadStart = newLoadStart;
+		windowValid = true;
+		return true;
+	}
+
+	const float *rpmBins = NULL;
+	const float *loadBins = NULL;
+	ext_table_fetch_f fetch = NULL;
+	void *fetchArg = NULL;
+	float cache[WINDOW][WINDOW];
+	int rpmStart = 0;
+	int loadStart = 0;
+	bool windowValid = false;
+	int fetchCount = 0;
+	int missCount = 0;
+	int rpmIndexHint = -1;
+	int loadIndexHint = -1;
+};
+
+#endif /* EXT_TABLE_CACHE_H_ */
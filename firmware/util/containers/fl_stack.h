@@ -2,6 +2,10 @@
  * @file fl_stack.h
  * @brief Fixed-length stack
  *
+ * ISR-safety contract: none. FLStack and ArrayList are single-context
+ * containers, callers which share one across contexts must bring their own
+ * locking. For the lock-free cross-context case see spsc_ring.h.
+ *
  * @date Jul 9, 2014
  * @author Andrey Belomutskiy, (c) 2012-2020
  */
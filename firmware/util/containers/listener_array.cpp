@@ -1,10 +0,0 @@
-/*
- * @file listener_array.cpp
- *
- * @date Jan 1, 2013
- * @author Andrey Belomutskiy, (c) 2012-2020
- */
-
-#include "global.h"
-#include "listener_array.h"
-
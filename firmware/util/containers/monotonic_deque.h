@@ -0,0 +1,110 @@
+/**
+ * @file	monotonic_deque.h
+ * @brief	Sliding-window maximum in O(1) amortized time per sample
+ *
+ * A classic monotonic deque: stored entries are kept in strictly decreasing value
+ * order so the window maximum is always at the head. Every sample is pushed and
+ * popped at most once, making add() O(1) amortized versus the O(window) rescan
+ * which cyclic_buffer-based code has to do on every query.
+ *
+ * See https://en.wikipedia.org/wiki/Monotone_priority_queue
+ *
+ * @date Apr 21, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+static const short MD_MAX_SIZE = 128;
+
+/**
+ * Each sample carries an opaque tag so that the caller can recover context about
+ * the winning sample (say, the absolute position a delta was computed against)
+ * without keeping a parallel history buffer.
+ */
+template<typename TValue, typename TTag, int maxCapacity = MD_MAX_SIZE>
+class monotonic_deque {
+public:
+	/**
+	 * @param window how many of the most recent samples compete for the maximum
+	 */
+	void setWindow(int window) {
+		if (window < 1)
+			window = 1;
+		if (window > maxCapacity)
+			window = maxCapacity;
+		windowSize = window;
+		clear();
+	}
+
+	void clear() {
+		head = 0;
+		tail = 0;
+		nextSeq = 0;
+	}
+
+	bool isEmpty() const {
+		return head == tail;
+	}
+
+	void add(TValue value, TTag tag) {
+		uint32_t seq = nextSeq++;
+		// entries which have slid out of the window can never be the maximum again
+		while (!isEmpty() && (uint32_t)(seq - elements[head].seq) >= (uint32_t)windowSize) {
+			head = inc(head);
+		}
+		// entries dominated by the new sample can never be the maximum either,
+		// '<=' so that the newest of equal samples wins like a newest-first scan would
+		while (!isEmpty() && elements[dec(tail)].value <= value) {
+			tail = dec(tail);
+		}
+		elements[tail].value = value;
+		elements[tail].tag = tag;
+		elements[tail].seq = seq;
+		tail = inc(tail);
+	}
+
+	/**
+	 * @return the largest value within the window, only meaningful while !isEmpty()
+	 */
+	TValue getMax() const {
+		return elements[head].value;
+	}
+
+	/**
+	 * @return the tag supplied together with the current maximum
+	 */
+	TTag getMaxTag() const {
+		return elements[head].tag;
+	}
+
+private:
+	struct entry {
+		TValue value;
+		TTag tag;
+		/**
+		 * monotonic sample counter used for window expiration, the subtraction
+		 * in add() is wrap-around safe
+		 */
+		uint32_t seq;
+	};
+
+	int inc(int index) const {
+		return index == maxCapacity ? 0 : index + 1;
+	}
+
+	int dec(int index) const {
+		return index == 0 ? maxCapacity : index - 1;
+	}
+
+	/**
+	 * one spare slot so that a full deque is distinguishable from an empty one
+	 */
+	entry elements[maxCapacity + 1];
+	int head = 0;
+	int tail = 0;
+	int windowSize = maxCapacity;
+	uint32_t nextSeq = 0;
+};
@@ -0,0 +1,79 @@
+/**
+ * @file	spsc_ring.h
+ * @brief	Single-producer single-consumer lock-free ring buffer
+ *
+ * ISR-safety contract: exactly one context calls offer() and exactly one context
+ * calls poll(); either side may be an ISR. No locks and no disabled interrupts are
+ * needed because the producer is the only writer of writeIndex and the consumer is
+ * the only writer of readIndex, both indexes are free-running 32 bit counters and
+ * capacity is a power of two so the wrap is a bit mask. On our single-core
+ * Cortex-M targets the volatile accesses keep the element store ordered before the
+ * index publish.
+ *
+ * clear() is NOT part of the concurrent contract - call it only while both sides
+ * are quiet, typically during initialization.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#ifndef SPSC_RING_H_
+#define SPSC_RING_H_
+
+#include <stdint.h>
+
+template<typename T, size_t maxSize>
+class spsc_ring {
+	static_assert(maxSize > 0 && (maxSize & (maxSize - 1)) == 0, "maxSize must be a power of two");
+  public:
+	/**
+	 * producer side only
+	 * @return false if the ring is full, the element is not added
+	 */
+	bool offer(T value) {
+		if (writeIndex - readIndex >= maxSize) {
+			return false;
+		}
+		elements[writeIndex & (maxSize - 1)] = value;
+		// the element store above is sequenced before this volatile increment
+		writeIndex = writeIndex + 1;
+		return true;
+	}
+
+	/**
+	 * consumer side only
+	 * @return false if the ring is empty
+	 */
+	bool poll(T *result) {
+		if (readIndex == writeIndex) {
+			return false;
+		}
+		*result = elements[readIndex & (maxSize - 1)];
+		readIndex = readIndex + 1;
+		return true;
+	}
+
+	/**
+	 * dirty read is fine from either side: the worst case is a value one element stale
+	 */
+	int size() const {
+		return (int) (writeIndex - readIndex);
+	}
+
+	bool isEmpty() const {
+		return readIndex == writeIndex;
+	}
+
+	void clear() {
+		readIndex = writeIndex;
+	}
+
+  private:
+	// the element array itself is not volatile so that struct payloads work,
+	// the volatile index accesses around it provide the ordering we need
+	T elements[maxSize];
+	volatile uint32_t writeIndex = 0;
+	volatile uint32_t readIndex = 0;
+};
+
+#endif /* SPSC_RING_H_ */
@@ -15,6 +15,78 @@
 // popular left edge of CLT-based correction curves
 #define CLT_CURVE_RANGE_FROM -40
 
+/**
+ * Resolves one (RPM, load) cell with interpolation weights so that several tables sharing
+ * the same axes can be evaluated against a single pair of bin searches, see
+ * EngineState::periodicFastCallback(). Use axesMatch() before evaluating a table which was
+ * configured with its own bin arrays - the tune usually keeps them identical but nothing
+ * enforces that.
+ */
+template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename kType>
+class SharedTableCell {
+public:
+	void resolve(const kType rpmBins[RPM_BIN_SIZE], const kType loadBins[LOAD_BIN_SIZE], float rpm, float load) {
+		this->rpmBins = rpmBins;
+		this->loadBins = loadBins;
+		int rawRpmIndex = findIndexFixedWithHint<RPM_BIN_SIZE, kType>(rpmBins, rpm, &rpmIndexHint);
+		int rawLoadIndex = findIndexFixedWithHint<LOAD_BIN_SIZE, kType>(loadBins, load, &loadIndexHint);
+		// clamped weights degenerate into the edge value outside of the axis range,
+		// same result as the interpolate3d edge handling
+		rpmIndex = maxI(0, minI(rawRpmIndex, RPM_BIN_SIZE - 2));
+		loadIndex = maxI(0, minI(rawLoadIndex, LOAD_BIN_SIZE - 2));
+		rpmFraction = maxF(0, minF((rpm - rpmBins[rpmIndex]) / (rpmBins[rpmIndex + 1] - rpmBins[rpmIndex]), 1));
+		loadFraction = maxF(0, minF((load - loadBins[loadIndex]) / (loadBins[loadIndex + 1] - loadBins[loadIndex]), 1));
+	}
+
+	bool axesMatch(const kType otherRpmBins[RPM_BIN_SIZE], const kType otherLoadBins[LOAD_BIN_SIZE]) const {
+		if (otherRpmBins == rpmBins && otherLoadBins == loadBins) {
+			return true;
+		}
+		return memcmp(otherRpmBins, rpmBins, sizeof(kType) * RPM_BIN_SIZE) == 0
+				&& memcmp(otherLoadBins, loadBins, sizeof(kType) * LOAD_BIN_SIZE) == 0;
+	}
+
+	/**
+	 * bilinear evaluation against the shared weights, a handful of multiply-adds
+	 * and no searching. Mind the Map3D layout: pointers are indexed by load first.
+	 */
+	template<typename vType>
+	float evaluate(vType *const map[]) const {
+		float v00 = map[loadIndex][rpmIndex];
+		float v01 = map[loadIndex][rpmIndex + 1];
+		float v10 = map[loadIndex + 1][rpmIndex];
+		float v11 = map[loadIndex + 1][rpmIndex + 1];
+		float low = v00 + (v01 - v00) * rpmFraction;
+		float high = v10 + (v11 - v10) * rpmFraction;
+		return low + (high - low) * loadFraction;
+	}
+
+private:
+	const kType *rpmBins = NULL;
+	const kType *loadBins = NULL;
+	int rpmIndex = 0;
+	int loadIndex = 0;
+	float rpmFraction = 0;
+	float loadFraction = 0;
+	int rpmIndexHint = -1;
+	int loadIndexHint = -1;
+};
+
+/**
+ * axis is valid when it's NaN-free and strictly ascending, see Map3D::validateAxes()
+ */
+template<typename kType>
+bool isValidAxis(const kType bins[], int size) {
+	for (int i = 0; i < size - 1; i++) {
+		float current = (float)bins[i];
+		if (cisnan(current) || !(bins[i] < bins[i + 1])) {
+			return false;
+		}
+	}
+	float last = (float)bins[size - 1];
+	return !cisnan(last);
+}
+
 class ValueProvider3D {
 public:
 	virtual float getValue(float xRpm, float y) = 0;
@@ -29,17 +101,139 @@ class Map3D : public ValueProvider3D {
 public:
 	explicit Map3D(const char*name);
 	Map3D(const char*name, float multiplier);
+	/**
+	 * Quantized storage mode: cells hold int8/int16 raw values and every lookup
+	 * dequantizes on the fly as multiplier * raw + offset. A 16x16 float table shrinks
+	 * from 1KB to 256 bytes of int8 at the cost of one extra add per lookup.
+	 */
+	Map3D(const char*name, float multiplier, float offset);
 	void init(vType table[RPM_BIN_SIZE][LOAD_BIN_SIZE], const kType loadBins[LOAD_BIN_SIZE], const kType rpmBins[RPM_BIN_SIZE]);
 	float getValue(float xRpm, float y);
+	/**
+	 * Lookup with per-call validation hoisted out: no NaN input checks and no axis order
+	 * checks. Only taken once validateAxes() has blessed the axes - which happens
+	 * periodically from the slow callback - and callers are expected to reject NaN
+	 * arguments themselves, which every hot call site already does.
+	 */
+	float getValueFast(float xRpm, float y);
+	/**
+	 * periodic axis sanity stage, see getValueFast()
+	 */
+	bool validateAxes();
+	/**
+	 * evaluates this table against a cell which was already resolved on identical axes,
+	 * see SharedTableCell - the caller is expected to have checked axesMatch()
+	 */
+	float getValueAtCell(const SharedTableCell<RPM_BIN_SIZE, LOAD_BIN_SIZE, kType> &cell) const {
+		return multiplier * cell.template evaluate<vType>(pointers) + offset;
+	}
+	bool axesMatch(const SharedTableCell<RPM_BIN_SIZE, LOAD_BIN_SIZE, kType> &cell) const {
+		return cell.axesMatch(rpmBins, loadBins);
+	}
 	void setAll(vType value);
 	vType *pointers[LOAD_BIN_SIZE];
 private:
-	void create(const char*name, float multiplier);
+	void create(const char*name, float multiplier, float offset);
 	const kType *loadBins = NULL;
 	const kType *rpmBins = NULL;
+	/**
+	 * last lookup cell indexes, see findIndexWithHint(): at steady state consecutive
+	 * lookups land in the same cell so we skip both binary searches most of the time
+	 */
+	int loadIndexHint = -1;
+	int rpmIndexHint = -1;
+	bool axesValid = false;
 	bool initialized =  false;
 	const char *name;
 	float multiplier;
+	float offset;
+};
+
+#define MAX_TABLE_OVERLAYS 4
+
+/**
+ * Precomposed overlay stack for tables sharing one axis pair: per-gear timing retard,
+ * per-bank fuel trim and similar conditional adjustments. Instead of consulting several
+ * Map3D instances serially on every event, the base table and the currently active
+ * overlays are flattened cell-wise into the effective buffer whenever the active set
+ * changes - a gear change recomposes once, the hot path keeps reading a single table.
+ *
+ * Overlays add raw cell values, so with quantized storage (non-1 multiplier) base and
+ * overlays must share the same multiplier and a zero offset.
+ *
+ * Point Map3D::init() at the effective buffer and call recompose() from the
+ * configuration-apply path; setOverlayActive() is cheap to call repeatedly, it only
+ * recomposes on an actual activation change.
+ */
+template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename vType>
+class TableOverlayComposer {
+public:
+	void initBase(const vType base[RPM_BIN_SIZE][LOAD_BIN_SIZE]) {
+		this->base = base;
+		recompose();
+	}
+
+	/**
+	 * @return overlay index to use with setOverlayActive(), or -1 when the stack is full
+	 */
+	int addOverlay(const vType overlay[RPM_BIN_SIZE][LOAD_BIN_SIZE]) {
+		if (overlayCount >= MAX_TABLE_OVERLAYS) {
+			firmwareError(CUSTOM_ERR_6635, "too many table overlays");
+			return -1;
+		}
+		overlays[overlayCount] = overlay;
+		return overlayCount++;
+	}
+
+	void setOverlayActive(int index, bool active) {
+		if (index < 0 || index >= overlayCount) {
+			return;
+		}
+		uint32_t newMask = active ? activeMask | (1 << index) : activeMask & ~(1 << index);
+		if (newMask == activeMask) {
+			return;
+		}
+		activeMask = newMask;
+		recompose();
+	}
+
+	bool isOverlayActive(int index) const {
+		return (activeMask & (1 << index)) != 0;
+	}
+
+	void recompose() {
+		if (base == NULL) {
+			return;
+		}
+		memcpy(effective, base, sizeof(effective));
+		for (int overlayIndex = 0; overlayIndex < overlayCount; overlayIndex++) {
+			if ((activeMask & (1 << overlayIndex)) == 0) {
+				continue;
+			}
+			const vType (*overlay)[LOAD_BIN_SIZE] = overlays[overlayIndex];
+			for (int rpmIndex = 0; rpmIndex < RPM_BIN_SIZE; rpmIndex++) {
+				for (int loadIndex = 0; loadIndex < LOAD_BIN_SIZE; loadIndex++) {
+					effective[rpmIndex][loadIndex] += overlay[rpmIndex][loadIndex];
+				}
+			}
+		}
+		composeCounter++;
+	}
+
+	/**
+	 * the flattened table, this is what Map3D::init() should be pointed at
+	 */
+	vType effective[RPM_BIN_SIZE][LOAD_BIN_SIZE];
+	/**
+	 * diagnostics: how many flattening passes have run
+	 */
+	int composeCounter = 0;
+
+private:
+	const vType (*base)[LOAD_BIN_SIZE] = NULL;
+	const vType (*overlays[MAX_TABLE_OVERLAYS])[LOAD_BIN_SIZE];
+	int overlayCount = 0;
+	uint32_t activeMask = 0;
 };
 
 /*
@@ -103,24 +297,60 @@ float Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::getValue(float xRpm, flo
 		warning(CUSTOM_PARAM_RANGE, "%s: y is NaN", name);
 		return NAN;
 	}
+	if (cisnan(xRpm)) {
+		warning(CUSTOM_INTEPOLATE_ERROR_3, "%s: x is NaN", name);
+		return NAN;
+	}
+	int loadIndex = findIndexFixedWithHint<LOAD_BIN_SIZE, kType>(loadBins, y, &loadIndexHint);
+	int rpmIndex = findIndexFixedWithHint<RPM_BIN_SIZE, kType>(rpmBins, xRpm, &rpmIndexHint);
 	// todo: we have a bit of a mess: in TunerStudio, RPM is X-axis
-	return multiplier * interpolate3d<vType, kType>(y, loadBins, LOAD_BIN_SIZE, xRpm, rpmBins, RPM_BIN_SIZE, pointers);
+	return multiplier * interpolate3dAtCell<vType, kType>(y, loadBins, LOAD_BIN_SIZE, loadIndex, xRpm, rpmBins, RPM_BIN_SIZE, rpmIndex, pointers) + offset;
+}
+
+template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename vType, typename kType>
+float Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::getValueFast(float xRpm, float y) {
+	if (!axesValid) {
+		// until the slow callback has validated the axes we stay on the checked path
+		return getValue(xRpm, y);
+	}
+	int loadIndex = findIndexFixedWithHint<LOAD_BIN_SIZE, kType>(loadBins, y, &loadIndexHint);
+	int rpmIndex = findIndexFixedWithHint<RPM_BIN_SIZE, kType>(rpmBins, xRpm, &rpmIndexHint);
+	return multiplier * interpolate3dAtCell<vType, kType>(y, loadBins, LOAD_BIN_SIZE, loadIndex, xRpm, rpmBins, RPM_BIN_SIZE, rpmIndex, pointers) + offset;
+}
+
+template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename vType, typename kType>
+bool Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::validateAxes() {
+	if (!initialized) {
+		axesValid = false;
+		return false;
+	}
+	axesValid = isValidAxis<kType>(loadBins, LOAD_BIN_SIZE) && isValidAxis<kType>(rpmBins, RPM_BIN_SIZE);
+	if (!axesValid) {
+		warning(CUSTOM_ERR_AXIS_ORDER, "%s: invalid axis", name);
+	}
+	return axesValid;
 }
 
 template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename vType, typename kType>
 Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::Map3D(const char *name) {
-	create(name, 1);
+	create(name, 1, 0);
 }
 
 template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename vType, typename kType>
 Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::Map3D(const char *name, float multiplier) {
-	create(name, multiplier);
+	create(name, multiplier, 0);
+}
+
+template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename vType, typename kType>
+Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::Map3D(const char *name, float multiplier, float offset) {
+	create(name, multiplier, offset);
 }
 
 template<int RPM_BIN_SIZE, int LOAD_BIN_SIZE, typename vType, typename kType>
-void Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::create(const char *name, float multiplier) {
+void Map3D<RPM_BIN_SIZE, LOAD_BIN_SIZE, vType, kType>::create(const char *name, float multiplier, float offset) {
 	this->name = name;
 	this->multiplier = multiplier;
+	this->offset = offset;
 	memset(&pointers, 0, sizeof(pointers));
 }
 
@@ -161,6 +391,13 @@ typedef Map3D<PEDAL_TO_TPS_SIZE, PEDAL_TO_TPS_SIZE, uint8_t, uint8_t> pedal2tps_
 typedef Map3D<BOOST_RPM_COUNT, BOOST_LOAD_COUNT, uint8_t, uint8_t> boostOpenLoop_Map3D_t;
 typedef Map3D<BOOST_RPM_COUNT, BOOST_LOAD_COUNT, uint8_t, uint8_t> boostClosedLoop_Map3D_t;
 typedef Map3D<IAC_PID_MULT_SIZE, IAC_PID_MULT_SIZE, uint8_t, uint8_t> iacPidMultiplier_t;
+/**
+ * quantized variants, see the scale/offset Map3D constructor: int16 fuel cells keep
+ * 0.01ms resolution over a 0..655ms range in half the RAM, int8 ignition cells keep
+ * 0.5 degree resolution over -64..63 degrees in a quarter of it
+ */
+typedef Map3D<FUEL_RPM_COUNT, FUEL_LOAD_COUNT, int16_t, float> fuel_quantized_Map3D_t;
+typedef Map3D<IGN_RPM_COUNT, IGN_LOAD_COUNT, int8_t, float> ign_quantized_Map3D_t;
 
 void setRpmBin(float array[], int size, float idleRpm, float topRpm);
 
@@ -0,0 +1,70 @@
+/**
+ * @file	copy_audit.cpp
+ * @brief	byte-copy accounting for the outbound communication path
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+#include "copy_audit.h"
+
+#include <string.h>
+
+static const char *subsystemNames[COPY_AUDIT_COUNT] = {
+		"log assembly",
+		"log central",
+		"TS gather",
+		"TS handlers",
+};
+
+/**
+ * totals since boot; incremented from several threads without locking, a lost
+ * increment under contention only nudges a statistic
+ */
+static volatile uint32_t copiedBytes[COPY_AUDIT_COUNT];
+static volatile uint32_t copyCalls[COPY_AUDIT_COUNT];
+
+void copyAuditCount(copy_audit_subsystem_e subsystem, size_t bytes) {
+	copiedBytes[subsystem] += bytes;
+	copyCalls[subsystem]++;
+}
+
+void *copyAuditMemcpy(copy_audit_subsystem_e subsystem, void *dst, const void *src, size_t bytes) {
+	copyAuditCount(subsystem, bytes);
+	return memcpy(dst, src, bytes);
+}
+
+#if EFI_PROD_CODE
+
+#include "os_access.h"
+#include "eficonsole.h"
+#include "datalogging.h"
+
+static Logging logger("copy audit");
+
+/**
+ * snapshots from the previous 'copyinfo' invocation so we can print bytes per
+ * second over the interval between two invocations
+ */
+static uint32_t lastBytes[COPY_AUDIT_COUNT];
+static efitimeus_t lastPrintUs = 0;
+
+static void printCopyAudit(void) {
+	efitimeus_t nowUs = getTimeNowUs();
+	float periodSeconds = (nowUs - lastPrintUs) / 1000000.0f;
+	for (int i = 0; i < COPY_AUDIT_COUNT; i++) {
+		uint32_t total = copiedBytes[i];
+		int rate = lastPrintUs == 0 || periodSeconds <= 0 ? 0 : (int) ((total - lastBytes[i]) / periodSeconds);
+		scheduleMsg(&logger, "copy %s: %d bytes in %d calls, %d bytes/sec", subsystemNames[i],
+				total, copyCalls[i], rate);
+		lastBytes[i] = total;
+	}
+	lastPrintUs = nowUs;
+}
+
+void initCopyAudit(void) {
+	addConsoleAction("copyinfo", printCopyAudit);
+}
+
+#endif /* EFI_PROD_CODE */
@@ -0,0 +1,49 @@
+/**
+ * @file	copy_audit.h
+ * @brief	byte-copy accounting for the outbound communication path
+ *
+ * Between the Logging line buffers, the central accumulation buffer and the
+ * binary protocol gather buffer each outbound byte may be copied two or three
+ * times. These counters measure how much copy bandwidth each subsystem burns
+ * so the zero-copy discussions can be had over numbers, see 'copyinfo'.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#pragma once
+
+#include "global.h"
+
+typedef enum {
+	/**
+	 * Logging::append/appendFast assembling log lines, see datalogging.cpp
+	 */
+	COPY_AUDIT_LOG_ASSEMBLY = 0,
+	/**
+	 * scheduleLogging() moving complete lines into the accumulation buffer
+	 */
+	COPY_AUDIT_LOG_CENTRAL = 1,
+	/**
+	 * sr5WriteCrcPacket() gathering header/payload/crc into one contiguous write
+	 */
+	COPY_AUDIT_TS_IO = 2,
+	/**
+	 * TunerStudio handler copies: output channel snapshots, config chunk writes
+	 */
+	COPY_AUDIT_TS = 3,
+	COPY_AUDIT_COUNT = 4
+} copy_audit_subsystem_e;
+
+/**
+ * account for bytes copied by code which does the copy itself, one add, cheap
+ * enough for the appendFast() hot path
+ */
+void copyAuditCount(copy_audit_subsystem_e subsystem, size_t bytes);
+
+/**
+ * drop-in counted replacement for memcpy on the comms path
+ */
+void *copyAuditMemcpy(copy_audit_subsystem_e subsystem, void *dst, const void *src, size_t bytes);
+
+void initCopyAudit(void);
@@ -31,6 +31,7 @@
  */
 
 #include "global.h"
+#include "copy_audit.h"
 
 #if ! EFI_UNIT_TEST
 #include "os_access.h"
@@ -38,6 +39,7 @@
 #include "memstreams.h"
 #include "console_io.h"
 #include "os_util.h"
+#include "memory_report.h"
 
 static MemoryStream intermediateLoggingBuffer;
 static uint8_t intermediateLoggingBufferData[INTERMEDIATE_LOGGING_BUFFER_SIZE] CCM_OPTIONAL;
@@ -65,12 +67,15 @@ static ALWAYS_INLINE bool validateBuffer(Logging *logging, const char *text, uin
 
 void Logging::append(const char *text) {
 	efiAssertVoid(CUSTOM_APPEND_NULL, text != NULL, "append NULL");
+	// name-only instances have no line storage, see scheduleMsg
+	efiAssertVoid(CUSTOM_ERR_BUFF_INIT_ERROR, buffer != NULL, "no log storage");
 	uint32_t extraLen = efiStrlen(text);
 	bool isCapacityProblem = validateBuffer(this, text, extraLen);
 	if (isCapacityProblem) {
 		return;
 	}
 	strcpy(linePointer, text);
+	copyAuditCount(COPY_AUDIT_LOG_ASSEMBLY, extraLen);
 	/**
 	 * And now we are pointing at the zero char at the end of the buffer again
 	 */
@@ -90,6 +95,7 @@ void appendFast(Logging *logging, const char *text) {
 	s = logging->linePointer;
 	while ((*s++ = *text++) != 0)
 		;
+	copyAuditCount(COPY_AUDIT_LOG_ASSEMBLY, s - 1 - logging->linePointer);
 	logging->linePointer = s - 1;
 }
 
@@ -276,6 +282,7 @@ uint32_t remainingSize(Logging *logging) {
 void initIntermediateLoggingBuffer(void) {
 	initLoggingCentral();
 
+	registerStaticBuffer("intermediate logging", intermediateLoggingBufferData, sizeof(intermediateLoggingBufferData));
 	msObjectInit(&intermediateLoggingBuffer, intermediateLoggingBufferData, INTERMEDIATE_LOGGING_BUFFER_SIZE, 0);
 	intermediateLoggingBufferInited = true;
 }
@@ -298,6 +305,10 @@ void Logging::appendPrintf(const char *fmt, ...) {
 Logging::Logging() {
 }
 
+Logging::Logging(char const *name) : Logging() {
+	this->name = name;
+}
+
 Logging::Logging(char const *name, char *buffer, int bufferSize) : Logging() {
 #if ! EFI_UNIT_TEST
 	initLoggingExt(name, buffer, bufferSize);
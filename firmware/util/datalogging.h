@@ -19,6 +19,11 @@
 class Logging {
 public:
 	Logging();
+	/**
+	 * name-only flavor for modules which just scheduleMsg(): such lines are formatted
+	 * straight into the central arena, so no per-module line storage is needed
+	 */
+	explicit Logging(const char *name);
 	Logging(const char *name, char *buffer, int bufferSize);
 	void initLoggingExt(const char *name, char *buffer, int bufferSize);
 	void vappendPrintf(const char *fmt, va_list arg);
@@ -26,7 +31,6 @@ public:
 	void appendFast(const char *text);
 	void appendPrintf(const char *fmt, ...);
 	const char *name = nullptr;
-	char SMALL_BUFFER[40];
 	/**
 	 * Zero-terminated buffer of pending debug message
 	 *
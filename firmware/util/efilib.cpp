@@ -323,6 +323,30 @@ void printHistogram(Logging *logging, histogram_s *histogram) {
 #endif /* EFI_HISTOGRAMS */
 }
 
+/**
+ * @brief Dumps the non-empty power-of-two buckets of a log2_histogram_s
+ */
+void printLog2Histogram(Logging *logging, log2_histogram_s *histogram) {
+#if EFI_HISTOGRAMS && ! EFI_UNIT_TEST
+	resetLogging(logging);
+	appendMsgPrefix(logging);
+	appendPrintf(logging, "histogram %s *", histogram->name);
+	for (int i = 0; i < LOG2_BUCKET_COUNT; i++) {
+		uint32_t count = hsLog2GetCount(histogram, i);
+		if (count == 0)
+			continue;
+		// bucket 0 is exact zero, bucket i covers [2^(i-1), 2^i - 1]
+		appendPrintf(logging, "<2^%d:%d ", i, count);
+	}
+	appendPrintf(logging, "*");
+	appendMsgPostfix(logging);
+	scheduleLogging(logging);
+#else
+	UNUSED(logging);
+	UNUSED(histogram);
+#endif /* EFI_HISTOGRAMS */
+}
+
 float limitRateOfChange(float newValue, float oldValue, float incrLimitPerSec, float decrLimitPerSec, float secsPassed) {
 	if (newValue >= oldValue)
 		return (incrLimitPerSec <= 0.0f) ? newValue : oldValue + minF(newValue - oldValue, incrLimitPerSec * secsPassed);
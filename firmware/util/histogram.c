@@ -13,6 +13,11 @@
 #include "histogram.h"
 #include "global.h"
 
+#if EFI_PROD_CODE
+// for isIsrContext()
+#include "os_util.h"
+#endif /* EFI_PROD_CODE */
+
 #if defined(HAS_OS_ACCESS)
 #error "Unexpected OS ACCESS HERE"
 #endif
@@ -108,6 +113,42 @@ void hsAdd(histogram_s *h, int64_t value) {
 	h->values[index] += count;
 }
 
+void initLog2Histogram(log2_histogram_s *h, const char *name) {
+	if (efiStrlen(name) > sizeof(h->name) - 1) {
+		firmwareError(ERROR_HISTO_NAME, "Histogram name [%s] too long", name);
+	}
+	strcpy(h->name, name);
+	memset(h->isrValues, 0, sizeof(h->isrValues));
+	memset(h->threadValues, 0, sizeof(h->threadValues));
+}
+
+/**
+ * @brief Power-of-two bucket selection, one CLZ on Cortex-M
+ */
+int log2HistogramGetIndex(uint32_t value) {
+	if (value == 0)
+		return 0;
+	return 32 - __builtin_clz(value);
+}
+
+void hsLog2Add(log2_histogram_s *h, uint32_t value) {
+	int index = log2HistogramGetIndex(value);
+#if EFI_PROD_CODE
+	if (isIsrContext()) {
+		h->isrValues[index]++;
+		return;
+	}
+#endif /* EFI_PROD_CODE */
+	h->threadValues[index]++;
+}
+
+/**
+ * @brief Merged per-context counters, this is the read side
+ */
+uint32_t hsLog2GetCount(const log2_histogram_s *h, int index) {
+	return h->isrValues[index] + h->threadValues[index];
+}
+
 /**
  * @brief Prepare histogram report
  * @note This report should be displayed using 'printHistogram' method
@@ -38,6 +38,31 @@ void initHistogram(histogram_s *h, const char *name);
 void hsAdd(histogram_s *h, int64_t value);
 int hsReport(histogram_s *h, int* report);
 
+/**
+ * bucket 0 is value zero, bucket N covers [2^(N-1), 2^N - 1]
+ */
+#define LOG2_BUCKET_COUNT 33
+
+/**
+ * Coarse power-of-two histogram with constant-time record: bucket selection is
+ * a single CLZ instruction, so hsLog2Add() is safe to call from the hottest ISRs.
+ *
+ * There is no locking: ISR and thread contexts increment separate counter
+ * arrays and readers merge the two through hsLog2GetCount(). An increment is a
+ * single load/add/store on the owning context, a concurrent dirty read can be
+ * off by at most the in-flight sample.
+ */
+typedef struct {
+	char name[16];
+	uint32_t isrValues[LOG2_BUCKET_COUNT];
+	uint32_t threadValues[LOG2_BUCKET_COUNT];
+} log2_histogram_s;
+
+void initLog2Histogram(log2_histogram_s *h, const char *name);
+int log2HistogramGetIndex(uint32_t value);
+void hsLog2Add(log2_histogram_s *h, uint32_t value);
+uint32_t hsLog2GetCount(const log2_histogram_s *h, int index);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -11,8 +11,11 @@
 
 #include "global.h"
 #include "efilib.h"
+#include "copy_audit.h"
 
 #if ! EFI_UNIT_TEST
+#include "os_access.h"
+#include "memstreams.h"
 
 typedef char log_buf_t[DL_OUTPUT_BUFFER];
 
@@ -66,7 +69,7 @@ void scheduleLogging(Logging *logging) {
 		return;
 	}
 	// memcpy is faster then strcpy because it is not looking for line terminator
-	memcpy(accumulationBuffer + accumulatedSize, logging->buffer, newLength + 1);
+	copyAuditMemcpy(COPY_AUDIT_LOG_CENTRAL, accumulationBuffer + accumulatedSize, logging->buffer, newLength + 1);
 	accumulatedSize += newLength;
 	if (!alreadyLocked) {
 		unlockOutputBuffer();
@@ -119,6 +122,31 @@ char * swapOutputBuffers(int *actualOutputBufferSize) {
 	return outputBuffer;
 }
 
+/**
+ * Multi-line reports used to stuff the whole dump into the arena in one burst:
+ * whatever did not fit was silently dropped and the emitting thread kept
+ * formatting lines nobody would ever see. Report loops call this between chunks -
+ * it waits, bounded, for the consumer to drain the arena below the high-water
+ * mark, so reports come out complete and the emitting thread sleeps at a point
+ * where control threads can preempt instead of hogging its priority band.
+ *
+ * The wait is bounded: with no console attached nobody ever drains the arena and
+ * the report simply degrades to the old drop-on-overflow policy.
+ */
+#define LOGGING_HIGH_WATER (MAX_DL_CAPACITY / 2)
+#define LOGGING_BACKPRESSURE_MAX_WAIT_MS 200
+#define LOGGING_BACKPRESSURE_POLL_MS 10
+
+void loggingYieldForHeadroom(void) {
+	int waitedMs = 0;
+	// dirty read: a word-sized counter only written under lock, worst case we
+	// sleep one extra poll period
+	while (accumulatedSize > LOGGING_HIGH_WATER && waitedMs < LOGGING_BACKPRESSURE_MAX_WAIT_MS) {
+		chThdSleepMilliseconds(LOGGING_BACKPRESSURE_POLL_MS);
+		waitedMs += LOGGING_BACKPRESSURE_POLL_MS;
+	}
+}
+
 void initLoggingCentral(void) {
 	pendingBuffers0[0] = 0;
 	pendingBuffers1[0] = 0;
@@ -145,17 +173,38 @@ void scheduleMsg(Logging *logging, const char *fmt, ...) {
 		warning(CUSTOM_ERR_LOGGING_NULL, "logging NULL");
 		return;
 	}
+	/**
+	 * Reservation-commit against the central arena: we format the line straight into
+	 * the tail of the accumulation buffer and only advance accumulatedSize once the
+	 * whole line fit. No per-module staging buffer is touched, so the Logging
+	 * parameter does not even need line storage - see the name-only Logging
+	 * constructor.
+	 */
 	int wasLocked = lockAnyContext();
-	resetLogging(logging); // todo: is 'reset' really needed here?
-	appendMsgPrefix(logging);
-
-	va_list ap;
-	va_start(ap, fmt);
-	logging->vappendPrintf(fmt, ap);
-	va_end(ap);
-
-	appendMsgPostfix(logging);
-	scheduleLogging(logging);
+	uint32_t remaining = accumulatedSize < MAX_DL_CAPACITY ? MAX_DL_CAPACITY - accumulatedSize : 0;
+	if (remaining > 0) {
+		char *span = accumulationBuffer + accumulatedSize;
+		MemoryStream reservedStream;
+		msObjectInit(&reservedStream, (uint8_t *) span, remaining, 0);
+
+		chprintf((BaseSequentialStream *) &reservedStream, "msg" DELIMETER);
+		va_list ap;
+		va_start(ap, fmt);
+		chvprintf((BaseSequentialStream *) &reservedStream, fmt, ap);
+		va_end(ap);
+		chprintf((BaseSequentialStream *) &reservedStream, DELIMETER);
+
+		if (reservedStream.eos < remaining) {
+			// commit
+			span[reservedStream.eos] = 0;
+			accumulatedSize += reservedStream.eos;
+		}
+		/**
+		 * else: the stream hit the end of the arena, quite possibly truncating the
+		 * line. Nothing was committed so the next line simply overwrites this spot -
+		 * same drop-on-overflow policy we always had when no one consumes the data.
+		 */
+	}
 	if (!wasLocked) {
 		unlockAnyContext();
 	}
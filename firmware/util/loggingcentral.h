@@ -10,5 +10,14 @@
 void initLoggingCentral(void);
 char * swapOutputBuffers(int *actualOutputBufferSize);
 void scheduleMsg(Logging *logging, const char *fmt, ...);
+#if EFI_PROD_CODE || EFI_SIMULATOR
+/**
+ * multi-line console reports call this between chunks so the consumer can drain
+ * the arena and control threads can preempt, see loggingcentral.cpp
+ */
+void loggingYieldForHeadroom(void);
+#else
+#define loggingYieldForHeadroom() {}
+#endif
 
 #endif /* UTIL_LOGGINGCENTRAL_H_ */
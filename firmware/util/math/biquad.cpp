@@ -24,6 +24,18 @@ void Biquad::initValue(float input, bi_quard_s *settings) {
 	z2 = input * (1 - a0 - a1 + b1);
 }
 
+/**
+ * runs the filter over a recorded stream, same state update as getValue() per
+ * sample - the recurrence is serial, so within one channel there is nothing to
+ * vectorize, but the buffer entry point keeps host stream processing on the
+ * exact code path the target runs
+ */
+void Biquad::filterBuffer(const float *input, float *output, int count) {
+	for (int i = 0; i < count; i++) {
+		output[i] = getValue(input[i]);
+	}
+}
+
 float Biquad::getValue(float input) {
     float result = input * a0 + z1;
     z1 = input * a1 + z2 - b1 * result;
@@ -31,3 +43,57 @@ float Biquad::getValue(float input) {
     return result;
 }
 
+BiquadBank::BiquadBank() {
+	a0 = a1 = a2 = b1 = b2 = 0;
+	channelCount = 0;
+	for (int i = 0; i < BIQUAD_BANK_MAX_CHANNELS; i++) {
+		channels[i].z1 = channels[i].z2 = 0;
+	}
+}
+
+/**
+ * coefficients are loaded once for the whole bank - on configuration change
+ * this is the only method which needs to run again
+ */
+void BiquadBank::init(int channelCount, bi_quard_s *settings) {
+	this->channelCount = minI(channelCount, BIQUAD_BANK_MAX_CHANNELS);
+	a0 = settings->a0;
+	a1 = settings->a1;
+	a2 = settings->a2;
+	b1 = settings->b1;
+	b2 = settings->b2;
+}
+
+void BiquadBank::initValue(int channel, float input) {
+	if (channel < 0 || channel >= channelCount)
+		return;
+	// same steady-state preload as Biquad::initValue()
+	channels[channel].z1 = input * (1 - a0);
+	channels[channel].z2 = input * (1 - a0 - a1 + b1);
+}
+
+float BiquadBank::getValue(int channel, float input) {
+	if (channel < 0 || channel >= channelCount)
+		return input;
+	float result = input * a0 + channels[channel].z1;
+	channels[channel].z1 = input * a1 + channels[channel].z2 - b1 * result;
+	channels[channel].z2 = input * a2 - b2 * result;
+	return result;
+}
+
+void BiquadBank::filterBlock(int channel, const float *input, float *output, int count) {
+	if (channel < 0 || channel >= channelCount)
+		return;
+	// locals keep the recurrence in registers for the whole block
+	float z1 = channels[channel].z1;
+	float z2 = channels[channel].z2;
+	for (int i = 0; i < count; i++) {
+		float in = input[i];
+		float result = in * a0 + z1;
+		z1 = in * a1 + z2 - b1 * result;
+		z2 = in * a2 - b2 * result;
+		output[i] = result;
+	}
+	channels[channel].z1 = z1;
+	channels[channel].z2 = z2;
+}
@@ -17,9 +17,36 @@ public:
     Biquad();
     void initValue(float input, bi_quard_s *settings);
     float getValue(float input);
+    void filterBuffer(const float *input, float *output, int count);
 
     float a0, a1, a2, b1, b2;
     float z1, z2;
 };
 
+#define BIQUAD_BANK_MAX_CHANNELS 16
+
+/**
+ * A bank of biquad channels sharing one set of coefficients: per-channel state
+ * is just (z1, z2), so channels with identical tuning - oversampled MAP,
+ * knock envelope on several cylinders - pay for the coefficient setup once.
+ * filterBlock() runs a whole contiguous sample block (one ADC DMA batch) per
+ * call with coefficients and state held in locals instead of paying the
+ * per-sample call overhead.
+ */
+class BiquadBank {
+public:
+    BiquadBank();
+    void init(int channelCount, bi_quard_s *settings);
+    void initValue(int channel, float input);
+    float getValue(int channel, float input);
+    void filterBlock(int channel, const float *input, float *output, int count);
+
+private:
+    float a0, a1, a2, b1, b2;
+    struct {
+        float z1, z2;
+    } channels[BIQUAD_BANK_MAX_CHANNELS];
+    int channelCount;
+};
+
 #endif /* CONTROLLERS_MATH_BIQUAD_H_ */
@@ -0,0 +1,58 @@
+/**
+ * @file fast_math.cpp
+ * @brief fast approximations of transcendental functions
+ *
+ * All three kernels play the same game: reinterpret the IEEE 754 bits as an
+ * integer so that exponent arithmetic becomes integer arithmetic, then clean
+ * up the mantissa with a short rational correction or a couple of Newton
+ * steps. No lookup tables, no double promotion, branch-free on the happy path.
+ *
+ * @date Jun 7, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "global.h"
+#include "fast_math.h"
+
+#include <stdint.h>
+
+typedef union {
+	float f;
+	uint32_t i;
+} float_bits_u;
+
+float fastLog2f(float x) {
+	float_bits_u bits;
+	bits.f = x;
+	// the raw exponent scaled down gives a coarse log2, the rational term in
+	// the mantissa (forced into [0.5, 1) here) corrects it
+	float_bits_u mantissa;
+	mantissa.i = (bits.i & 0x007FFFFF) | 0x3f000000;
+	float y = bits.i * 1.1920929e-7f; // 2^-23
+	return y - 124.22551499f - 1.498030302f * mantissa.f
+			- 1.72587999f / (0.3520887068f + mantissa.f);
+}
+
+float fastExp2f(float x) {
+	// clamp instead of underflowing into a garbage bit pattern
+	float clipped = x < -126 ? -126.0f : x;
+	int whole = (int) clipped;
+	float frac = clipped - whole + (x < 0 ? 1.0f : 0.0f);
+	float_bits_u result;
+	result.i = (uint32_t) ((1 << 23)
+			* (clipped + 121.2740575f + 27.7280233f / (4.84252568f - frac)
+					- 1.49012907f * frac));
+	return result.f;
+}
+
+float fastRecipf(float x) {
+	float_bits_u bits;
+	bits.f = x;
+	// subtracting the exponent from a magic constant gives a seed good to a
+	// few percent, each Newton step then roughly squares the accuracy
+	bits.i = 0x7EF311C3 - bits.i;
+	float r = bits.f;
+	r = r * (2.0f - x * r);
+	r = r * (2.0f - x * r);
+	return r;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file fast_math.h
+ * @brief fast approximations of transcendental functions
+ *
+ * Central home for the bit-trick/polynomial math kernels used on hot paths,
+ * see expf_taylor in efilib.cpp for an older sibling. On Cortex-M4F these are
+ * roughly an order of magnitude faster than the libm equivalents at accuracy
+ * far beyond our sensor noise floor.
+ *
+ * EFI_FAST_MATH selects between these kernels and plain libm via the efiLogf/
+ * efiExpf/efiRecipf wrappers below, so callers do not need their own #if.
+ *
+ * @date Jun 7, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#ifndef FAST_MATH_H_
+#define FAST_MATH_H_
+
+#include <math.h>
+
+// efifeatures.h is only part of firmware builds, default to the fast kernels
+// elsewhere so unit tests exercise the same code the firmware runs
+#ifndef EFI_FAST_MATH
+#define EFI_FAST_MATH TRUE
+#endif
+
+/**
+ * base-2 logarithm, x must be positive and finite. Worst-case error is about
+ * 3e-4 in log2 units across the whole range.
+ */
+float fastLog2f(float x);
+
+/**
+ * 2 raised to the given power, relative error is about 3e-4
+ */
+float fastExp2f(float x);
+
+/**
+ * 1/x via magic-constant seed plus two Newton-Raphson iterations, relative
+ * error is about 1e-5. Note that unlike real division x=0 yields a huge
+ * finite number, not infinity.
+ */
+float fastRecipf(float x);
+
+#if EFI_FAST_MATH
+
+#define efiLogf(x) (fastLog2f(x) * 0.69314718f)
+#define efiExpf(x) fastExp2f((x) * 1.44269504f)
+#define efiRecipf(x) fastRecipf(x)
+
+#else
+
+#define efiLogf(x) logf(x)
+#define efiExpf(x) expf(x)
+#define efiRecipf(x) (1.0f / (x))
+
+#endif /* EFI_FAST_MATH */
+
+#endif /* FAST_MATH_H_ */
@@ -0,0 +1,38 @@
+/*
+ * @file goertzel.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "goertzel.h"
+
+#include <math.h>
+
+void GoertzelDetector::init(float targetFrequencyHz, float sampleRateHz) {
+	float omega = 2 * 3.14159265f * targetFrequencyHz / sampleRateHz;
+	coeffQ14 = (int32_t) (2 * cosf(omega) * (1 << 14));
+}
+
+float GoertzelDetector::processWindow(const int16_t *samples, int count) const {
+	/**
+	 * 64 bit state: with 12 bit ADC samples and windows of a few thousand samples
+	 * the resonator state stays well within range, the coefficient multiply is
+	 * what needs the headroom
+	 */
+	int64_t s1 = 0;
+	int64_t s2 = 0;
+	for (int i = 0; i < count; i++) {
+		int64_t s0 = samples[i] + ((coeffQ14 * s1) >> 14) - s2;
+		s2 = s1;
+		s1 = s0;
+	}
+	float f1 = (float) s1;
+	float f2 = (float) s2;
+	float magnitudeSquared = f1 * f1 + f2 * f2 - (coeffQ14 / 16384.0f) * f1 * f2;
+	if (magnitudeSquared < 0) {
+		// numerical noise on a silent window
+		magnitudeSquared = 0;
+	}
+	return sqrtf(magnitudeSquared) / count;
+}
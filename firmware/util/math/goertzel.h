@@ -0,0 +1,35 @@
+/*
+ * @file goertzel.h
+ *
+ * Fixed-point single-bin Goertzel DFT: evaluates the energy of one target
+ * frequency over a sample window without computing a full FFT. A handful of
+ * detectors over one knock window is far cheaper than any FFT on an F4 and
+ * needs no sample buffering beyond the window itself.
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#ifndef UTIL_MATH_GOERTZEL_H_
+#define UTIL_MATH_GOERTZEL_H_
+
+#include <stdint.h>
+
+class GoertzelDetector {
+public:
+    void init(float targetFrequencyHz, float sampleRateHz);
+    /**
+     * Runs the resonator over one complete sample window.
+     * The recurrence is pure integer math (Q14 coefficient), only the final
+     * magnitude extraction touches floating point.
+     *
+     * @return magnitude of the target bin normalized by window length
+     */
+    float processWindow(const int16_t *samples, int count) const;
+
+private:
+    // Q14 representation of 2*cos(2*pi*f/fs)
+    int32_t coeffQ14 = 0;
+};
+
+#endif /* UTIL_MATH_GOERTZEL_H_ */
@@ -104,11 +104,11 @@ float FastInterpolation::getValue(float x) const {
  */
 float interpolateMsg(const char *msg, float x1, float y1, float x2, float y2, float x) {
 	if (cisnan(x1) || cisnan(x2) || cisnan(y1) || cisnan(y2)) {
-		warning(CUSTOM_INTEPOLATE_ERROR, "interpolate%s: why param", msg);
+		warningDeferred(CUSTOM_INTEPOLATE_ERROR, "interpolate%s: why param", msg, 0, 0);
 		return NAN;
 	}
 	if (cisnan(x)) {
-		warning(CUSTOM_INTEPOLATE_ERROR, "interpolate%s: why X", msg);
+		warningDeferred(CUSTOM_INTEPOLATE_ERROR, "interpolate%s: why X", msg, 0, 0);
 		return NAN;
 	}
 	// todo: double comparison using EPS
@@ -116,7 +116,7 @@ float interpolateMsg(const char *msg, float x1, float y1, float x2, float y2, fl
 		/**
 		 * we could end up here for example while resetting bins while changing engine type
 		 */
-		warning(CUSTOM_INTEPOLATE_ERROR, "interpolate%s: Same x1 and x2 in interpolate: %.2f/%.2f", msg, x1, x2);
+		warningDeferred(CUSTOM_INTEPOLATE_ERROR, "interpolate%s: Same x1 and x2 in interpolate: %.2f/%.2f", msg, x1, x2);
 		return NAN;
 	}
 
@@ -125,7 +125,7 @@ float interpolateMsg(const char *msg, float x1, float y1, float x2, float y2, fl
 //	efiAssertVoid(CUSTOM_ERR_ASSERT_VOID, x1 != x2, "no way we can interpolate");
 	float a = INTERPOLATION_A(x1, y1, x2, y2);
 	if (cisnan(a)) {
-		warning(CUSTOM_INTEPOLATE_ERROR, "interpolate%s: why a", msg);
+		warningDeferred(CUSTOM_INTEPOLATE_ERROR, "interpolate%s: why a", msg, 0, 0);
 		return NAN;
 	}
 	float b = y1 - a * x1;
@@ -214,6 +214,69 @@ float interpolate2d(const char *msg, float value, const float bin[], const float
 }
 }
 
+/**
+ * the SSE2 macro comes straight from the compiler: every x86-64 host build
+ * (simulator, unit tests) has it, the ARM target build never does, so the two
+ * code paths select themselves without any configuration
+ */
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+void interpolate2dBatch(const char *msg, const float inputs[], float outputs[], int count,
+		const float bin[], const float values[], int size) {
+	int i = 0;
+#if defined(__SSE2__)
+	/**
+	 * the index search stays scalar, the interpolation arithmetic runs four
+	 * samples wide - same a/b formulation as interpolateMsg() so both paths
+	 * agree, see test_batch_math.cpp parity assertions
+	 */
+	for (; i + 4 <= count; i += 4) {
+		float x1[4], y1[4], x2[4], y2[4];
+		bool allInterior = true;
+		for (int lane = 0; lane < 4 && allInterior; lane++) {
+			float value = inputs[i + lane];
+			if (cisnan(value)) {
+				allInterior = false;
+				break;
+			}
+			int index = findIndexMsg("value", bin, size, value);
+			if (index == -1 || index == size - 1) {
+				allInterior = false;
+				break;
+			}
+			x1[lane] = bin[index];
+			y1[lane] = values[index];
+			x2[lane] = bin[index + 1];
+			y2[lane] = values[index + 1];
+			if (x1[lane] == x2[lane]) {
+				// broken bins, let the scalar path produce its usual warning
+				allInterior = false;
+			}
+		}
+		if (!allInterior) {
+			// clamped/degenerate samples are rare, handle those four the scalar way
+			for (int lane = 0; lane < 4; lane++) {
+				outputs[i + lane] = priv::interpolate2d(msg, inputs[i + lane], bin, values, size);
+			}
+			continue;
+		}
+		__m128 vx1 = _mm_loadu_ps(x1);
+		__m128 vy1 = _mm_loadu_ps(y1);
+		__m128 vx2 = _mm_loadu_ps(x2);
+		__m128 vy2 = _mm_loadu_ps(y2);
+		__m128 vx = _mm_loadu_ps(&inputs[i]);
+		__m128 a = _mm_div_ps(_mm_sub_ps(vy1, vy2), _mm_sub_ps(vx1, vx2));
+		__m128 b = _mm_sub_ps(vy1, _mm_mul_ps(a, vx1));
+		_mm_storeu_ps(&outputs[i], _mm_add_ps(_mm_mul_ps(a, vx), b));
+	}
+#endif /* __SSE2__ */
+	for (; i < count; i++) {
+		outputs[i] = priv::interpolate2d(msg, inputs[i], bin, values, size);
+	}
+}
+
 /**
  * Sets specified value for specified key in a correction curve
  * see also setLinearCurve()
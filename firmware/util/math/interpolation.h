@@ -38,6 +38,15 @@ float interpolate2d(const char *msg, const float value, const float (&bin)[TSize
 
 int needInterpolationLogging(void);
 
+/**
+ * Batch flavor of interpolate2d() for streams of samples, i.e. filtering a
+ * recorded sensor log. Behaviorally identical to calling interpolate2d() per
+ * sample; on an SSE2 host (simulator, unit tests) the interior-cell arithmetic
+ * runs four samples wide.
+ */
+void interpolate2dBatch(const char *msg, const float inputs[], float outputs[], int count,
+		const float bin[], const float values[], int size);
+
 /** @brief	Binary search
  * @returns	the highest index within sorted array such that array[i] is greater than or equal to the parameter
  * @note If the parameter is smaller than the first element of the array, -1 is returned.
@@ -99,25 +108,70 @@ int findIndexMsgExt(const char *msg, const kType array[], int size, kType value)
 }
 
 /**
- * @brief	Two-dimensional table lookup with linear interpolation
+ * Compile-time-size flavor of findIndex2(): with N known statically the log2(N) probe
+ * loop fully unrolls and each step compiles into a conditional move, so there are no
+ * data-dependent branches to mispredict. N must be a power of two, which holds for
+ * every table axis in the configuration. Same return contract as findIndex().
+ *
+ * NaN must be rejected by the caller, see Map3D::getValue().
  */
-template<typename vType, typename kType>
-float interpolate3d(float x, const kType xBin[], int xBinSize, float y, const kType yBin[], int yBinSize, vType* map[]) {
-	if (cisnan(x)) {
-		warning(CUSTOM_INTEPOLATE_ERROR_3, "%.2f: x is NaN in interpolate3d", x);
-		return NAN;
+template<unsigned N, typename kType>
+int findIndexFixed(const kType array[], kType value) {
+	static_assert((N & (N - 1)) == 0, "findIndexFixed needs a power of two size");
+	unsigned i = 0;
+	for (unsigned b = N >> 1; b; b >>= 1) {
+		unsigned j = i | b;
+		// ternary on purpose: compiles into a conditional move, unlike findIndexMsgExt
+		i = array[j] <= value ? j : i;
 	}
-	if (cisnan(y)) {
-		warning(CUSTOM_INTEPOLATE_ERROR_2, "%.2f: y is NaN in interpolate3d", y);
-		return NAN;
+	return i || array[0] <= value ? (int)i : -1;
+}
+
+/**
+ * Cached-hint flavor of the binary search: at steady state consecutive lookups land in the
+ * same cell most of the time, so a couple of comparisons replace the whole search. 'hint'
+ * holds the index returned by the previous invocation, -1 initially.
+ */
+template<typename kType>
+int findIndexWithHint(const kType array[], int size, kType value, int *hint) {
+	int index = *hint;
+	if (index == -1 && value < array[0]) {
+		return -1;
 	}
+	if (index >= 0 && index < size && value >= array[index]
+			&& (index == size - 1 || value < array[index + 1])) {
+		return index;
+	}
+	index = findIndexMsgExt<kType>("hint", array, size, value);
+	*hint = index;
+	return index;
+}
 
-	int xIndex = findIndexMsgExt<kType>("x", xBin, xBinSize, x);
-#if	DEBUG_INTERPOLATION
-	if (needInterpolationLogging())
-		printf("X index=%d\r\n", xIndex);
-#endif /* DEBUG_INTERPOLATION */
-	int yIndex = findIndexMsgExt<kType>("y", yBin, yBinSize, y);
+/**
+ * findIndexWithHint() with the fallback search specialized at compile time,
+ * see findIndexFixed()
+ */
+template<unsigned N, typename kType>
+int findIndexFixedWithHint(const kType array[], kType value, int *hint) {
+	int index = *hint;
+	if (index == -1 && value < array[0]) {
+		return -1;
+	}
+	if (index >= 0 && index < (int)N && value >= array[index]
+			&& (index == (int)N - 1 || value < array[index + 1])) {
+		return index;
+	}
+	index = findIndexFixed<N, kType>(array, value);
+	*hint = index;
+	return index;
+}
+
+/**
+ * the part of interpolate3d() which happens once both cell indexes are already known,
+ * see also findIndexWithHint()
+ */
+template<typename vType, typename kType>
+float interpolate3dAtCell(float x, const kType xBin[], int xBinSize, int xIndex, float y, const kType yBin[], int yBinSize, int yIndex, vType* map[]) {
 	if (xIndex < 0 && yIndex < 0) {
 #if	DEBUG_INTERPOLATION
 		if (needInterpolationLogging())
@@ -231,6 +285,30 @@ float interpolate3d(float x, const kType xBin[], int xBinSize, float y, const kT
 	float result = interpolateMsg("3d", keyMin, keyMinValue, keyMax, keyMaxValue, y);
 	return result;
 }
+
+/**
+ * @brief	Two-dimensional table lookup with linear interpolation
+ */
+template<typename vType, typename kType>
+float interpolate3d(float x, const kType xBin[], int xBinSize, float y, const kType yBin[], int yBinSize, vType* map[]) {
+	if (cisnan(x)) {
+		warning(CUSTOM_INTEPOLATE_ERROR_3, "%.2f: x is NaN in interpolate3d", x);
+		return NAN;
+	}
+	if (cisnan(y)) {
+		warning(CUSTOM_INTEPOLATE_ERROR_2, "%.2f: y is NaN in interpolate3d", y);
+		return NAN;
+	}
+
+	int xIndex = findIndexMsgExt<kType>("x", xBin, xBinSize, x);
+#if	DEBUG_INTERPOLATION
+	if (needInterpolationLogging())
+		printf("X index=%d\r\n", xIndex);
+#endif /* DEBUG_INTERPOLATION */
+	int yIndex = findIndexMsgExt<kType>("y", yBin, yBinSize, y);
+
+	return interpolate3dAtCell<vType, kType>(x, xBin, xBinSize, xIndex, y, yBin, yBinSize, yIndex, map);
+}
 void setCurveValue(float bins[], float values[], int size, float key, float value);
 void initInterpolation(Logging *sharedLogger);
 
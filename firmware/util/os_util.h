@@ -39,6 +39,7 @@ void chVTSetAny(virtual_timer_t *vtp, systime_t time, vtfunc_t vtfunc, void *par
 #ifdef __cplusplus
 }
 void printHistogram(Logging *logging, histogram_s *histogram);
+void printLog2Histogram(Logging *logging, log2_histogram_s *histogram);
 #endif /* __cplusplus */
 
 #endif /* EFI_UNIT_TEST */
@@ -1372,7 +1372,7 @@ public class Fields {
 	public static final int unused_offset = 972;
 	public static final int unusedAnotherOne_offset = 744;
 	public static final int unusedAtOldBoardConfigurationEnd_offset = 1052;
-	public static final int unusedBit4_1476_offset = 1476;
+	public static final int useFSIOForAuxValveAngles_offset = 1476;
 	public static final int unusedBit_250_10_offset = 976;
 	public static final int unusedBit_250_11_offset = 976;
 	public static final int unusedBit_250_12_offset = 976;
@@ -2024,7 +2024,7 @@ public class Fields {
 	public static final Field ISIGNITIONENABLED = Field.create("ISIGNITIONENABLED", 1476, FieldType.BIT, 1);
 	public static final Field ISCYLINDERCLEANUPENABLED = Field.create("ISCYLINDERCLEANUPENABLED", 1476, FieldType.BIT, 2);
 	public static final Field SECONDTRIGGERCHANNELENABLED = Field.create("SECONDTRIGGERCHANNELENABLED", 1476, FieldType.BIT, 3);
-	public static final Field UNUSEDBIT4_1476 = Field.create("UNUSEDBIT4_1476", 1476, FieldType.BIT, 4);
+	public static final Field USEFSIOFORAUXVALVEANGLES = Field.create("USEFSIOFORAUXVALVEANGLES", 1476, FieldType.BIT, 4);
 	public static final Field ISMAPAVERAGINGENABLED = Field.create("ISMAPAVERAGINGENABLED", 1476, FieldType.BIT, 5);
 	public static final Field OVERRIDECRANKINGIACSETTING = Field.create("OVERRIDECRANKINGIACSETTING", 1476, FieldType.BIT, 6);
 	public static final Field USESEPARATEADVANCEFORIDLE = Field.create("USESEPARATEADVANCEFORIDLE", 1476, FieldType.BIT, 7);
@@ -2918,7 +2918,7 @@ public class Fields {
 	ISIGNITIONENABLED,
 	ISCYLINDERCLEANUPENABLED,
 	SECONDTRIGGERCHANNELENABLED,
-	UNUSEDBIT4_1476,
+	USEFSIOFORAUXVALVEANGLES,
 	ISMAPAVERAGINGENABLED,
 	OVERRIDECRANKINGIACSETTING,
 	USESEPARATEADVANCEFORIDLE,
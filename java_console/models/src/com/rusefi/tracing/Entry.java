@@ -61,7 +61,8 @@ public class Entry {
         try {
             DataInputStream is = new DataInputStream(new ByteArrayInputStream(packet));
             is.readByte(); // skip TS result code
-            int firstTimeStamp = 0;
+            // the first record carries an absolute timestamp, the rest are deltas
+            long timestampCursor = 0;
             for (int i = 0; i < packet.length - 1; i += 8) {
                 byte type = is.readByte();
                 byte phase = is.readByte();
@@ -70,17 +71,12 @@ public class Entry {
 
                 int timestampNt = readInt(is);
                 if (i == 0) {
-                    firstTimeStamp = timestampNt;
+                    timestampCursor = timestampNt & 0xFFFFFFFFL;
                 } else {
-                    if (timestampNt < firstTimeStamp) {
-                        System.out.println("Dropping the remainder of the packet at " + i + " due to "
-                                + timestampNt + " below " + firstTimeStamp);
-                        break;
-                    }
+                    timestampCursor += timestampNt & 0xFFFFFFFFL;
                 }
 
-
-                double timestampSeconds = timestampNt / MAGIC_NT;
+                double timestampSeconds = timestampCursor / MAGIC_NT;
                 minValue = Math.min(minValue, timestampSeconds);
                 String name;
                 if (type == 1) {
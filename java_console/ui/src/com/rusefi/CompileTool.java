@@ -3,7 +3,7 @@ package com.rusefi;
 import com.fathzer.soft.javaluator.DoubleEvaluator;
 
 import java.io.*;
-import java.util.List;
+import java.util.*;
 
 /**
  * http://rusefi.com/wiki/index.php?title=Manual:Flexible_Logic
@@ -14,11 +14,36 @@ import java.util.List;
 public class CompileTool {
     private static String NEWLINE = "\n";
 
+    /**
+     * firmware identifiers for the FSIO variables, see LENameOrdinalPair instances in fsio_impl.cpp
+     */
+    private static final Map<String, String> VARIABLES = new HashMap<>();
+
+    static {
+        VARIABLES.put("rpm", "LE_METHOD_RPM");
+        VARIABLES.put("tps", "LE_METHOD_TPS");
+        VARIABLES.put("maf", "LE_METHOD_MAF");
+        VARIABLES.put("map", "LE_METHOD_MAP");
+        VARIABLES.put("vbatt", "LE_METHOD_VBATT");
+        VARIABLES.put("fan", "LE_METHOD_FAN");
+        VARIABLES.put("coolant", "LE_METHOD_COOLANT");
+        VARIABLES.put("is_clt_broken", "LE_METHOD_IS_COOLANT_BROKEN");
+        VARIABLES.put("ac_on_switch", "LE_METHOD_AC_TOGGLE");
+        VARIABLES.put("time_since_ac_on_switch", "LE_METHOD_TIME_SINCE_AC_TOGGLE");
+        VARIABLES.put("time_since_boot", "LE_METHOD_TIME_SINCE_BOOT");
+        VARIABLES.put("knock", "LE_METHOD_KNOCK");
+        VARIABLES.put("ivvt", "LE_METHOD_INTAKE_VVT");
+        VARIABLES.put("evvt", "LE_METHOD_EXHAUST_VVT");
+        VARIABLES.put("cranking_rpm", "LE_METHOD_CRANKING_RPM");
+        VARIABLES.put("startup_fuel_pump_duration", "LE_METHOD_STARTUP_FUEL_PUMP_DURATION");
+        VARIABLES.put("in_shutdown", "LE_METHOD_IN_SHUTDOWN");
+    }
+
     public static int run(List<String> args) throws IOException {
         System.out.println("Params " + args);
 
-        if (args.size() != 2) {
-            System.out.println("Please specify input file and output file name");
+        if (args.size() != 2 && args.size() != 3) {
+            System.out.println("Please specify input file and output file name, optionally a native output file name");
             return -1;
         }
 
@@ -26,27 +51,44 @@ public class CompileTool {
         System.out.println("Reading from " + inputFileName);
         String outputFileName = args.get(1);
         System.out.println("Writing to " + outputFileName);
+        String nativeFileName = args.size() == 3 ? args.get(2) : null;
+        if (nativeFileName != null)
+            System.out.println("Writing native evaluators to " + nativeFileName);
 
         BufferedReader br = new BufferedReader(new FileReader(inputFileName));
+        BufferedWriter nativeWriter = nativeFileName == null ? null : new BufferedWriter(new FileWriter(nativeFileName));
 
         try (BufferedWriter bw = new BufferedWriter(new FileWriter(outputFileName))) {
             bw.write("// this https://en.wikipedia.org/wiki/Reverse_Polish_notation is generated automatically" + NEWLINE);
             bw.write("// from " + inputFileName + NEWLINE);
             bw.write("// on " + FileLog.getDate() + NEWLINE + "//" + NEWLINE);
 
+            if (nativeWriter != null) {
+                nativeWriter.write("// native C++ evaluators generated automatically from " + inputFileName + NEWLINE);
+                nativeWriter.write("// on " + FileLog.getDate() + NEWLINE + "//" + NEWLINE);
+                nativeWriter.write("// include only from fsio_impl.cpp with EFI_USE_NATIVE_SYSTEM_FSIO enabled" + NEWLINE + "//" + NEWLINE);
+            }
+
             String line;
             while ((line = br.readLine()) != null) {
                 line = line.trim();
 //            line = line.replaceAll("\\s+", " ");
-                bw.write(handleOneFsioLine(line));
+                bw.write(handleOneFsioLine(line, nativeWriter));
 
             }
+        } finally {
+            if (nativeWriter != null)
+                nativeWriter.close();
         }
         System.out.println("Done!");
         return 0;
     }
 
     public static String handleOneFsioLine(String line) throws IOException {
+        return handleOneFsioLine(line, null);
+    }
+
+    public static String handleOneFsioLine(String line, BufferedWriter nativeWriter) throws IOException {
         if (line.isEmpty())
             return "";
         StringBuilder result = new StringBuilder();
@@ -77,6 +119,114 @@ public class CompileTool {
         }
         result.append(NEWLINE + "// Human-readable: " + expression + NEWLINE);
         result.append("#define " + name + " \"" + rpn + "\"" + NEWLINE);
+
+        if (nativeWriter != null)
+            nativeWriter.write(generateNative(name, expression, rpn));
         return result.toString();
     }
+
+    /**
+     * Turns the RPN form into a plain C++ expression matching LECalculator::processAction
+     * semantics, so board-baked logic skips the interpreter entirely.
+     *
+     * Expressions using the runtime-parametrized methods (fsio_setting, fsio_table,
+     * fsio_analog_input) stay interpreted and are skipped here.
+     */
+    private static String generateNative(String name, String expression, String rpn) {
+        Deque<String> stack = new ArrayDeque<>();
+        for (String token : rpn.split(" ")) {
+            if (token.isEmpty())
+                continue;
+            if (isNumeric(token)) {
+                stack.push(token + (token.contains(".") ? "f" : ".0f"));
+                continue;
+            }
+            String variable = toVariable(token);
+            if (variable != null) {
+                stack.push("getEngineValue(" + variable + " PASS_ENGINE_PARAMETER_SUFFIX)");
+                continue;
+            }
+            if (stack.size() < arity(token))
+                return skipped(name, "unsupported token [" + token + "]");
+            switch (token) {
+                case "not":
+                    stack.push("(!float2bool(" + stack.pop() + "))");
+                    break;
+                case "and":
+                case "&": {
+                    String v2 = stack.pop(), v1 = stack.pop();
+                    stack.push("(float2bool(" + v1 + ") && float2bool(" + v2 + "))");
+                    break;
+                }
+                case "or":
+                case "|": {
+                    String v2 = stack.pop(), v1 = stack.pop();
+                    stack.push("(float2bool(" + v1 + ") || float2bool(" + v2 + "))");
+                    break;
+                }
+                case "<":
+                case ">":
+                case "<=":
+                case ">=":
+                case "+":
+                case "-":
+                case "*":
+                case "/": {
+                    String v2 = stack.pop(), v1 = stack.pop();
+                    stack.push("(" + v1 + " " + token + " " + v2 + ")");
+                    break;
+                }
+                case "max": {
+                    String v2 = stack.pop(), v1 = stack.pop();
+                    stack.push("maxF(" + v1 + ", " + v2 + ")");
+                    break;
+                }
+                case "min": {
+                    String v2 = stack.pop(), v1 = stack.pop();
+                    stack.push("minF(" + v1 + ", " + v2 + ")");
+                    break;
+                }
+                case "if": {
+                    String vFalse = stack.pop(), vTrue = stack.pop(), vCond = stack.pop();
+                    stack.push("(" + vCond + " != 0 ? " + vTrue + " : " + vFalse + ")");
+                    break;
+                }
+                default:
+                    return skipped(name, "unsupported token [" + token + "]");
+            }
+        }
+        if (stack.size() != 1)
+            return skipped(name, "unexpected stack depth " + stack.size());
+        return NEWLINE + "// Human-readable: " + expression + NEWLINE
+                + "static float getSystemFsioNative_" + name + "(DECLARE_ENGINE_PARAMETER_SIGNATURE) {" + NEWLINE
+                + "\treturn " + stack.pop() + ";" + NEWLINE
+                + "}" + NEWLINE;
+    }
+
+    private static String skipped(String name, String reason) {
+        return NEWLINE + "// " + name + " not compiled to native: " + reason + NEWLINE;
+    }
+
+    private static int arity(String token) {
+        if ("not".equals(token))
+            return 1;
+        if ("if".equals(token))
+            return 3;
+        return 2;
+    }
+
+    private static String toVariable(String token) {
+        String variable = VARIABLES.get(token);
+        if (variable != null)
+            return variable;
+        // configuration fields referenced as cfg_fieldName map onto generated FSIO_SETTING ordinals
+        if (token.startsWith("cfg_"))
+            return "FSIO_SETTING_" + token.substring("cfg_".length()).toUpperCase();
+        return null;
+    }
+
+    private static boolean isNumeric(String token) {
+        char c = token.charAt(0);
+        return c >= '0' && c <= '9';
+    }
 }
@@ -53,6 +53,10 @@
 #define EFI_TOOTH_LOGGER TRUE
 #endif
 
+#ifndef EFI_DATALOG_STREAM
+#define EFI_DATALOG_STREAM TRUE
+#endif
+
 #define CONSOLE_MAX_ACTIONS 256
 
 #define EFI_SIMULATOR TRUE
@@ -12,10 +12,40 @@ efitick_t getTimeNowNt(void) {
 	return getTimeNowUs() * US_TO_NT_MULTIPLIER;
 }
 
-efitimeus_t getTimeNowUs(void) {
+/**
+ * The virtual clock every engine timestamp derives from can run faster than
+ * wall time, see setSimTimeFactor(). ChibiOS thread pacing stays wall-clock -
+ * the tick pump lives in the ChibiOS simulator port - so a factor above 1
+ * compresses simulated time between scheduler runs. That is exactly what the
+ * headless batch runner wants for fast-forwarding through scripted profiles.
+ */
+static int simTimeFactor = 1;
+static efitimeus_t virtualBaseUs = 0;
+static efitimeus_t realBaseUs = 0;
+
+static efitimeus_t getRealTimeUs(void) {
 	return chVTGetSystemTimeX() * (1000000 / CH_CFG_ST_FREQUENCY);
 }
 
+void setSimTimeFactor(int factor) {
+	if (factor < 1) {
+		return;
+	}
+	// re-anchor so virtual time stays continuous across a factor change
+	efitimeus_t realUs = getRealTimeUs();
+	virtualBaseUs = virtualBaseUs + (realUs - realBaseUs) * simTimeFactor;
+	realBaseUs = realUs;
+	simTimeFactor = factor;
+}
+
+int getSimTimeFactor(void) {
+	return simTimeFactor;
+}
+
+efitimeus_t getTimeNowUs(void) {
+	return virtualBaseUs + (getRealTimeUs() - realBaseUs) * simTimeFactor;
+}
+
 static size_t wt_writes(void *ip, const uint8_t *bp, size_t n) {
 	printToConsole((char*)bp);
 	return CONSOLE_PORT->vmt->write(CONSOLE_PORT, bp, n);
@@ -14,6 +14,12 @@ extern "C"
 
 void initTestStream(BaseChannel *ts);
 
+/**
+ * how much faster than wall time the simulated efitime clock runs, default 1
+ */
+void setSimTimeFactor(int factor);
+int getSimTimeFactor(void);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -29,7 +29,9 @@
 #include "engine_controller.h"
 #include "map_averaging.h"
 #include "memstreams.h"
+#include "framework.h"
 #include <chprintf.h>
+#include <stdlib.h>
 
 #define DEFAULT_SIM_RPM 1200
 #define DEFAULT_SNIFFER_THR 2500
@@ -89,6 +91,51 @@ static void runChprintfTest() {
 
 }
 
+/**
+ * Headless batch mode: RUSEFI_SIM_PROFILE points at a text file of
+ * "<durationMs> <rpm>" lines. The profile is executed against the trigger
+ * emulator, a CSV log of simulated time and decoded RPM is written next to
+ * the binary, and the process exits - which is what a CI job wants. Combine
+ * with RUSEFI_SIM_TIME_FACTOR (or 'set_time_factor') to fast-forward through
+ * the profile instead of waiting wall-clock minutes.
+ */
+#define BATCH_SAMPLE_PERIOD_MS 50
+
+static THD_WORKING_AREA(batchThreadStack, THD_WORKING_AREA_SIZE(4096));
+
+static void runBatchProfile(const char *fileName) {
+	FILE *profile = fopen(fileName, "r");
+	if (profile == NULL) {
+		printf("sim batch: cannot open profile [%s]\n", fileName);
+		exit(-1);
+	}
+	FILE *result = fopen("sim_batch_result.csv", "w");
+	fprintf(result, "timeMs,targetRpm,actualRpm\n");
+
+	int durationMs;
+	int targetRpm;
+	while (fscanf(profile, "%d %d", &durationMs, &targetRpm) == 2) {
+		setTriggerEmulatorRPM(targetRpm PASS_ENGINE_PARAMETER_SUFFIX);
+		for (int elapsedMs = 0; elapsedMs < durationMs; elapsedMs += BATCH_SAMPLE_PERIOD_MS) {
+			// sample cadence is in simulated time, sleep in compressed wall time
+			int sleepMs = BATCH_SAMPLE_PERIOD_MS / getSimTimeFactor();
+			chThdSleepMilliseconds(sleepMs < 1 ? 1 : sleepMs);
+			fprintf(result, "%d,%d,%d\n", (int) (getTimeNowUs() / 1000), targetRpm, GET_RPM());
+		}
+	}
+	fclose(profile);
+	fclose(result);
+	printf("sim batch: profile [%s] complete\n", fileName);
+	exit(0);
+}
+
+static THD_FUNCTION(BatchThread, arg) {
+	chRegSetThreadName("sim batch");
+	// let the rest of the initialization settle before driving the profile
+	chThdSleepMilliseconds(1000);
+	runBatchProfile((const char *) arg);
+}
+
 void rusEfiFunctionalTest(void) {
 	printToConsole("Running rusEfi simulator version:");
 	initErrorHandlingDataStructures();
@@ -132,6 +179,17 @@ void rusEfiFunctionalTest(void) {
 
 	setTriggerEmulatorRPM(DEFAULT_SIM_RPM PASS_ENGINE_PARAMETER_SUFFIX);
 	engineConfiguration->engineSnifferRpmThreshold = DEFAULT_SNIFFER_THR;
+
+	addConsoleActionI("set_time_factor", setSimTimeFactor);
+	const char *timeFactor = getenv("RUSEFI_SIM_TIME_FACTOR");
+	if (timeFactor != NULL) {
+		setSimTimeFactor(atoi(timeFactor));
+	}
+	const char *batchProfile = getenv("RUSEFI_SIM_PROFILE");
+	if (batchProfile != NULL) {
+		chThdCreateStatic(batchThreadStack, sizeof(batchThreadStack), NORMALPRIO,
+				(tfunc_t)(void*) BatchThread, (void *) batchProfile);
+	}
 }
 
 void printPendingMessages(void) {
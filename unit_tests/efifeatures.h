@@ -56,6 +56,29 @@
 #define EFI_SIGNAL_EXECUTOR_ONE_TIMER FALSE
 #define EFI_SIGNAL_EXECUTOR_SLEEP FALSE
 
+// unit tests exercise the sorted linked list implementation, it has richer introspection
+#define EFI_EVENT_QUEUE_HEAP FALSE
+
+// unit tests assert against float gap ratios, keep the reference implementation here
+#define EFI_FIXED_POINT_TRIGGER_MATH FALSE
+
+// no interrupts in unit tests, trigger events are decoded synchronously
+#define EFI_TRIGGER_DEFERRED_DECODE FALSE
+
+// tests mock sensors and expect every explicit periodicFastCallback() to recalculate
+#define EFI_FAST_CALLBACK_CACHE FALSE
+
+#define EFI_CYLINDER_BALANCE TRUE
+
+#define EFI_SHADOW_TUNE TRUE
+#define EFI_DFCO_SEQUENCER TRUE
+#define EFI_INTERNAL_KNOCK_ADC TRUE
+
+#define EFI_POSTMORTEM_RING FALSE
+
+// no timer peripherals in unit tests, PWM is always the software implementation
+#define EFI_HARDWARE_PWM FALSE
+
 #define EFI_SHAFT_POSITION_INPUT TRUE
 #define EFI_ENGINE_CONTROL TRUE
 
@@ -144,12 +144,12 @@ void EngineTestHelper::fireTriggerEvents(int count) {
 }
 
 void EngineTestHelper::assertInjectorUpEvent(const char *msg, int eventIndex, efitime_t momentX, long injectorIndex) {
-	InjectionEvent *event = &engine.injectionEvents.elements[injectorIndex];
+	InjectionEvent *event = &engine.injectionEvents->elements[injectorIndex];
 	assertEvent(msg, eventIndex, (void*)turnInjectionPinHigh, momentX, event);
 }
 
 void EngineTestHelper::assertInjectorDownEvent(const char *msg, int eventIndex, efitime_t momentX, long injectorIndex) {
-	InjectionEvent *event = &engine.injectionEvents.elements[injectorIndex];
+	InjectionEvent *event = &engine.injectionEvents->elements[injectorIndex];
 	assertEvent(msg, eventIndex, (void*)turnInjectionPinLow, momentX, event);
 }
 
@@ -70,6 +70,7 @@ void print(const char *fmt, ...);
 #define EFI_ERROR_CODE 0xffffffff
 
 #define CCM_OPTIONAL
+#define ITCM_CODE
 
 #define EXTERN_ENGINE extern EnginePins enginePins; \
 	 extern engine_configuration_s & activeConfiguration
@@ -43,3 +43,73 @@ void TestExecutor::scheduleByTimestamp(scheduling_s *scheduling, efitimeus_t tim
 void TestExecutor::scheduleByTimestampNt(scheduling_s* scheduling, efitick_t timeNt, action_s action) {
 	scheduleByTimestamp(scheduling, NT2US(timeNt), action);
 }
+
+extern int timeNowUs;
+
+void TestExecutor::setActionCost(schfunc_t callback, int costUs) {
+	for (int i = 0; i < actionCostCount; i++) {
+		if (costCallbacks[i] == callback) {
+			costDurationsUs[i] = costUs;
+			return;
+		}
+	}
+	if (actionCostCount >= MAX_ACTION_COSTS) {
+		return;
+	}
+	costCallbacks[actionCostCount] = callback;
+	costDurationsUs[actionCostCount] = costUs;
+	actionCostCount++;
+}
+
+int TestExecutor::getActionCostUs(schfunc_t callback) {
+	for (int i = 0; i < actionCostCount; i++) {
+		if (costCallbacks[i] == callback) {
+			return costDurationsUs[i];
+		}
+	}
+	// unknown actions are free, like the old executeAll() behavior
+	return 0;
+}
+
+void TestExecutor::resetLatencyStats() {
+	maxLatenessUs = 0;
+	maxQueueDepth = 0;
+	executedCounter = 0;
+	busyUntilUs = 0;
+}
+
+int TestExecutor::advanceTime(int deltaUs) {
+	efitimeus_t targetUs = getTimeNowUs() + deltaUs;
+	int executed = 0;
+	while (size() > 0) {
+		if (size() > maxQueueDepth) {
+			maxQueueDepth = size();
+		}
+		scheduling_s *head = getForUnitTest(0);
+		efitimeus_t scheduledUs = head->momentX;
+		if (scheduledUs > targetUs) {
+			break;
+		}
+		// an event cannot start while the previous one still occupies the timeline
+		efitimeus_t startUs = scheduledUs > busyUntilUs ? scheduledUs : busyUntilUs;
+		if (startUs > targetUs) {
+			break;
+		}
+		int latenessUs = (int) (startUs - scheduledUs);
+		if (latenessUs > maxLatenessUs) {
+			maxLatenessUs = latenessUs;
+		}
+		int costUs = getActionCostUs(head->action.getCallback());
+		timeNowUs = (int) startUs;
+		/**
+		 * ties at the same timestamp execute as one batch, each charged the head
+		 * callback's cost - the common case of a single producer
+		 */
+		int count = schedulingQueue.executeAll(scheduledUs);
+		executed += count;
+		executedCounter += count;
+		busyUntilUs = startUs + (efitimeus_t) costUs * count;
+	}
+	timeNowUs = (int) targetUs;
+	return executed;
+}
@@ -20,8 +20,40 @@ public:
 	int executeAll(efitime_t now);
 	int size();
 	scheduling_s* getForUnitTest(int index);
+
+	/**
+	 * Virtual-time harness: attach a synthetic execution duration to a callback
+	 * and advance time precisely, then assert on observed lateness and queue
+	 * depth - makes worst-case scheduler latency enforceable in tests.
+	 */
+	void setActionCost(schfunc_t callback, int costUs);
+	/**
+	 * advances the test clock by deltaUs executing due events in order, each
+	 * execution occupying virtual time per setActionCost()
+	 * @return number of events executed
+	 */
+	int advanceTime(int deltaUs);
+	void resetLatencyStats();
+
+	/**
+	 * worst observed start delay relative to the scheduled timestamp
+	 */
+	int maxLatenessUs = 0;
+	int maxQueueDepth = 0;
+	int executedCounter = 0;
 private:
+	int getActionCostUs(schfunc_t callback);
+
 	EventQueue schedulingQueue;
+
+	static const int MAX_ACTION_COSTS = 8;
+	schfunc_t costCallbacks[MAX_ACTION_COSTS];
+	int costDurationsUs[MAX_ACTION_COSTS];
+	int actionCostCount = 0;
+	/**
+	 * end of the currently "running" action in virtual time
+	 */
+	efitimeus_t busyUntilUs = 0;
 };
 
 #endif /* GLOBAL_EXECUTION_QUEUE_H_ */
@@ -5,5 +5,8 @@ FRAMEWORK_SRC_CPP = unit_test_framework.cpp \
 	test_basic_math/test_find_index.cpp \
 	test_basic_math/test_interpolation_3d.cpp \
 	test_basic_math/test_efilib.cpp \
+	test_basic_math/test_fast_math.cpp \
+	test_basic_math/test_batch_math.cpp \
+	test_basic_math/benchmark_table_lookup.cpp \
 	afm2mapConverter.cpp
 	
@@ -0,0 +1,137 @@
+/*
+ * @file    benchmark_table_lookup.cpp
+ *
+ * Micro-benchmark harness for the math kernels on the fuel/ignition hot path:
+ * interpolate2d, interpolate3d, findIndex/findIndexFixed and Map3D::getValue.
+ *
+ * Each case reports ns/op and asserts against a recorded baseline with a very
+ * generous margin - the point is catching order-of-magnitude regressions (an
+ * accidental division or linear search creeping back in), not precise timing,
+ * since CI machines vary wildly. Run just these with
+ *     ./rusefi_test benchmark.*
+ *
+ * @date Aug 28, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "unit_test_framework.h"
+#include "interpolation.h"
+#include "table_helper.h"
+
+#include <chrono>
+
+#define BENCHMARK_ITERATIONS 1000000
+
+/**
+ * recorded ns/op baselines (desktop x86-64, -O2) with a 20x allowance so that slow
+ * or loaded CI machines do not produce false alarms
+ */
+#define BASELINE_MARGIN 20
+#define BASELINE_FIND_INDEX_NS 15
+#define BASELINE_FIND_INDEX_FIXED_NS 6
+#define BASELINE_INTERPOLATE_2D_NS 25
+#define BASELINE_INTERPOLATE_3D_NS 50
+#define BASELINE_MAP3D_GET_VALUE_NS 35
+
+static float benchRpmBins[FUEL_RPM_COUNT];
+static float benchLoadBins[FUEL_LOAD_COUNT];
+static float benchTable[FUEL_RPM_COUNT][FUEL_LOAD_COUNT];
+static float benchCurveValues[FUEL_RPM_COUNT];
+
+/**
+ * cheap deterministic pseudo-random walk so consecutive lookups mix cell-local moves
+ * (the hint hit case) with occasional jumps, like a real drive cycle does
+ */
+static uint32_t benchSeed = 20262808;
+
+static float nextInput(float from, float to) {
+	benchSeed = benchSeed * 1664525 + 1013904223;
+	return from + (to - from) * ((benchSeed >> 8) & 0xFFFF) / 65536.0f;
+}
+
+static void initBenchmarkTables() {
+	for (int i = 0; i < FUEL_RPM_COUNT; i++) {
+		// realistic non-uniform rpm distribution: denser at the bottom
+		benchRpmBins[i] = 800 + i * i * 25;
+		benchCurveValues[i] = 10 + i * 0.5f;
+	}
+	for (int i = 0; i < FUEL_LOAD_COUNT; i++) {
+		benchLoadBins[i] = 20 + i * 5.5f;
+	}
+	for (int load = 0; load < FUEL_LOAD_COUNT; load++) {
+		for (int rpm = 0; rpm < FUEL_RPM_COUNT; rpm++) {
+			benchTable[load][rpm] = 5 + load * 0.4f + rpm * 0.2f;
+		}
+	}
+}
+
+/**
+ * @return measured ns/op, also printed so that the number shows up in the test log
+ */
+template<typename TCallback>
+static double measure(const char *label, TCallback callback) {
+	// warm the caches before the timed section
+	for (int i = 0; i < 1000; i++) {
+		callback();
+	}
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < BENCHMARK_ITERATIONS; i++) {
+		callback();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double nsPerOp = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+			/ (double) BENCHMARK_ITERATIONS;
+	reportBenchResult(label, BENCHMARK_ITERATIONS, nsPerOp);
+	return nsPerOp;
+}
+
+// this volatile sink keeps the optimizer from discarding the measured work
+static volatile float benchSink;
+
+TEST(benchmark, findIndex) {
+	initBenchmarkTables();
+	double nsPerOp = measure("findIndex", [] {
+		benchSink = findIndex(benchRpmBins, FUEL_RPM_COUNT, nextInput(500, 8000));
+	});
+	EXPECT_LT(nsPerOp, BASELINE_FIND_INDEX_NS * BASELINE_MARGIN);
+}
+
+TEST(benchmark, findIndexFixed) {
+	initBenchmarkTables();
+	double nsPerOp = measure("findIndexFixed", [] {
+		benchSink = findIndexFixed<FUEL_RPM_COUNT, float>(benchRpmBins, nextInput(500, 8000));
+	});
+	EXPECT_LT(nsPerOp, BASELINE_FIND_INDEX_FIXED_NS * BASELINE_MARGIN);
+}
+
+TEST(benchmark, interpolate2d) {
+	initBenchmarkTables();
+	double nsPerOp = measure("interpolate2d", [] {
+		benchSink = interpolate2d("bench", nextInput(500, 8000), benchRpmBins, benchCurveValues);
+	});
+	EXPECT_LT(nsPerOp, BASELINE_INTERPOLATE_2D_NS * BASELINE_MARGIN);
+}
+
+TEST(benchmark, interpolate3d) {
+	initBenchmarkTables();
+	static float *pointers[FUEL_LOAD_COUNT];
+	for (int i = 0; i < FUEL_LOAD_COUNT; i++) {
+		pointers[i] = benchTable[i];
+	}
+	double nsPerOp = measure("interpolate3d", [] {
+		benchSink = interpolate3d(nextInput(30, 100), benchLoadBins, FUEL_LOAD_COUNT,
+				nextInput(800, 7000), benchRpmBins, FUEL_RPM_COUNT, pointers);
+	});
+	EXPECT_LT(nsPerOp, BASELINE_INTERPOLATE_3D_NS * BASELINE_MARGIN);
+}
+
+TEST(benchmark, map3dGetValue) {
+	initBenchmarkTables();
+	static fuel_Map3D_t benchMap("bench");
+	benchMap.init(benchTable, benchLoadBins, benchRpmBins);
+	double nsPerOp = measure("Map3D::getValue", [] {
+		benchSink = benchMap.getValue(nextInput(800, 7000), nextInput(30, 100));
+	});
+	EXPECT_LT(nsPerOp, BASELINE_MAP3D_GET_VALUE_NS * BASELINE_MARGIN);
+}
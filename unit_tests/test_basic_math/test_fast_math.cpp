@@ -0,0 +1,31 @@
+/*
+ * test_fast_math.cpp
+ *
+ * @date Jun 7, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "gtest/gtest.h"
+
+#include "fast_math.h"
+#include <math.h>
+
+TEST(FastMathTest, Log2) {
+	// thermistor resistances live well inside this range
+	for (float x = 1e-3f; x < 1e6f; x *= 1.1f) {
+		EXPECT_NEAR(fastLog2f(x), log2f(x), 0.001f) << "x=" << x;
+	}
+}
+
+TEST(FastMathTest, Exp2) {
+	for (float x = -20; x < 20; x += 0.01f) {
+		EXPECT_NEAR(fastExp2f(x) / exp2f(x), 1, 0.001f) << "x=" << x;
+	}
+}
+
+TEST(FastMathTest, Reciprocal) {
+	for (float x = 1e-3f; x < 1e6f; x *= 1.1f) {
+		EXPECT_NEAR(fastRecipf(x) * x, 1, 0.0001f) << "x=" << x;
+		EXPECT_NEAR(fastRecipf(-x) * -x, 1, 0.0001f) << "x=" << x;
+	}
+}
@@ -0,0 +1,195 @@
+/*
+ * @file    benchmark_suite.cpp
+ *
+ * Microbenchmarks for the event-driven core: trigger decode on a synthetic
+ * 60-2 stream, EventQueue insert/pop at several queue depths, and SimplePwm
+ * edge generation through the scheduler. Together with the math kernels in
+ * benchmark_table_lookup.cpp these cover the per-event cost centers of the
+ * firmware; perf regressions used to reach us via drivability complaints.
+ *
+ * Every case reports a machine-readable result line
+ *     BENCH,<name>,<iterations>,<ns_per_op>
+ * (see reportBenchResult) so the numbers can be grepped out of the test log
+ * and tracked across commits. The on-target 'benchmarks' console command in
+ * rfi_perftest.cpp emits the same format for the cases which run on firmware.
+ * Assertions are only against order-of-magnitude regressions, with the same
+ * generous margin rationale as benchmark_table_lookup.cpp. Run just these with
+ *     ./rusefi_test benchmark.*
+ *
+ * @date Aug 28, 2026
+ * @author Andrey Belomutskiy, (c) 2012-2026
+ */
+
+#include "global.h"
+#include "unit_test_framework.h"
+#include "trigger_decoder.h"
+#include "trigger_simulator.h"
+#include "trigger_universal.h"
+#include "event_queue.h"
+#include "pwm_generator_logic.h"
+#include "global_execution_queue.h"
+
+#include <chrono>
+
+/**
+ * recorded ns/op baselines (desktop x86-64, -O2) with the same 20x allowance
+ * as benchmark_table_lookup.cpp
+ */
+#define BASELINE_MARGIN 20
+#define BASELINE_TRIGGER_SYNC_NS 40000
+#define BASELINE_TRIGGER_DECODE_NS 400
+#define BASELINE_EVENT_QUEUE_NS 300
+#define BASELINE_PWM_EDGE_NS 600
+
+/**
+ * same units-per-engine-cycle scale as SIMULATION_CYCLE_PERIOD in
+ * trigger_simulator.cpp - the decoder only cares about event time ratios
+ */
+#define BENCH_CYCLE_PERIOD 720000
+
+extern int timeNowUs;
+
+/**
+ * @return measured ns/op, also reported in the unified machine-readable format
+ */
+template<typename TCallback>
+static double measureSuite(const char *label, int iterations, TCallback callback) {
+	// warm the caches before the timed section
+	for (int i = 0; i < 1000; i++) {
+		callback();
+	}
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		callback();
+	}
+	auto end = std::chrono::steady_clock::now();
+	double nsPerOp = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+			/ (double) iterations;
+	reportBenchResult(label, iterations, nsPerOp);
+	return nsPerOp;
+}
+
+// this volatile sink keeps the optimizer from discarding the measured work
+static volatile int benchSuiteSink;
+
+/**
+ * cold-start cost: how long the decoder chews on a 60-2 stream before
+ * declaring sync, measured per findTriggerSyncPoint() call
+ */
+TEST(benchmark, triggerSyncPoint60_2) {
+	persistent_config_s c;
+	Engine e(&c);
+	persistent_config_s *config = &c;
+	Engine *engine = &e;
+	engine_configuration_s *engineConfiguration = &c.engineConfiguration;
+
+	TriggerWaveform *shape = &e.triggerCentral.triggerShape;
+	initializeSkippedToothTriggerWaveformExt(shape, 60, 2, FOUR_STROKE_CRANK_SENSOR);
+
+	TriggerStimulatorHelper helper;
+	TriggerState state;
+
+	double nsPerOp = measureSuite("trigger_sync_60_2", 10000, [&] {
+		state.resetTriggerState();
+		benchSuiteSink = helper.findTriggerSyncPoint(shape, &state PASS_CONFIG_PARAMETER_SUFFIX);
+	});
+	EXPECT_LT(nsPerOp, BASELINE_TRIGGER_SYNC_NS * BASELINE_MARGIN);
+}
+
+/**
+ * steady-state per-event decode cost once synchronized - this is the hot path
+ * the shaft interrupt pays on every single tooth edge
+ */
+TEST(benchmark, triggerDecode60_2) {
+	persistent_config_s c;
+	Engine e(&c);
+	persistent_config_s *config = &c;
+	Engine *engine = &e;
+	engine_configuration_s *engineConfiguration = &c.engineConfiguration;
+
+	TriggerWaveform *shape = &e.triggerCentral.triggerShape;
+	initializeSkippedToothTriggerWaveformExt(shape, 60, 2, FOUR_STROKE_CRANK_SENSOR);
+
+	TriggerState state;
+	int size = shape->getSize();
+	int eventIndex = 0;
+
+	// the skipped tooth shape only has a primary channel so every index is an edge
+	auto feedOneEvent = [&] {
+		int stateIndex = eventIndex % size;
+		int loopIndex = eventIndex / size;
+		int time = (int) (BENCH_CYCLE_PERIOD * (loopIndex + shape->wave.getSwitchTime(stateIndex)));
+		trigger_event_e s = shape->wave.getChannelState(/*channelIndex*/0, stateIndex) ?
+				SHAFT_PRIMARY_RISING : SHAFT_PRIMARY_FALLING;
+		state.decodeTriggerEvent(shape, nullptr, /* override */ nullptr, s, time PASS_CONFIG_PARAMETER_SUFFIX);
+		eventIndex++;
+	};
+	// get into sync before the timed section so we measure the synchronized path
+	while (!state.shaft_is_synchronized) {
+		feedOneEvent();
+	}
+
+	double nsPerOp = measureSuite("trigger_decode_60_2", 200000, feedOneEvent);
+	EXPECT_LT(nsPerOp, BASELINE_TRIGGER_DECODE_NS * BASELINE_MARGIN);
+}
+
+static void benchQueueCallback(void *) {
+	benchSuiteSink++;
+}
+
+/**
+ * steady-state pop-earliest plus insert-at-the-back with the queue holding
+ * 'depth' entries throughout - insertion cost is what grows with depth on the
+ * sorted linked list, see the EFI_EVENT_QUEUE_HEAP notes in event_queue.h
+ */
+static double measureEventQueueAtDepth(const char *label, int depth) {
+	EventQueue queue;
+	static scheduling_s slots[64];
+	efitime_t now = 0;
+	for (int i = 0; i < depth; i++) {
+		queue.insertTask(&slots[i], now + 1 + i, { benchQueueCallback, nullptr });
+	}
+	int popIndex = 0;
+	return measureSuite(label, 500000, [&] {
+		now++;
+		// each tick exactly one entry becomes due: the one scheduled 'depth' ticks ago
+		queue.executeAll(now);
+		queue.insertTask(&slots[popIndex], now + depth, { benchQueueCallback, nullptr });
+		popIndex = (popIndex + 1) % depth;
+	});
+}
+
+TEST(benchmark, eventQueueInsertPop) {
+	EXPECT_LT(measureEventQueueAtDepth("event_queue_d4", 4), BASELINE_EVENT_QUEUE_NS * BASELINE_MARGIN);
+	EXPECT_LT(measureEventQueueAtDepth("event_queue_d16", 16), BASELINE_EVENT_QUEUE_NS * BASELINE_MARGIN);
+	EXPECT_LT(measureEventQueueAtDepth("event_queue_d64", 64), BASELINE_EVENT_QUEUE_NS * BASELINE_MARGIN);
+}
+
+static void benchApplyPinState(int stateIndex, PwmConfig *state) /* pwm_gen_callback */ {
+	benchSuiteSink = state->multiChannelStateSequence.getChannelState(/*channelIndex*/0, stateIndex);
+}
+
+/**
+ * full cost of one PWM edge: executor pop, handler, pin callback and
+ * rescheduling of the next edge
+ */
+TEST(benchmark, simplePwmEdge) {
+	timeNowUs = 0;
+	TestExecutor executor;
+	SimplePwm pwm("bench PWM");
+	OutputPin pin;
+
+	startSimplePwm(&pwm, "bench",
+			&executor,
+			&pin,
+			1000 /* frequency */,
+			0.5 /* duty cycle */,
+			(pwm_gen_callback*)&benchApplyPinState);
+
+	double nsPerOp = measureSuite("simple_pwm_edge", 1000000, [&] {
+		// jump straight to the next scheduled edge
+		timeNowUs = (int) executor.getForUnitTest(0)->momentX;
+		executor.executeAll(timeNowUs);
+	});
+	EXPECT_LT(nsPerOp, BASELINE_PWM_EDGE_NS * BASELINE_MARGIN);
+}
@@ -63,6 +63,69 @@ TEST_F(SensorBasic, SensorNotInitialized) {
 	EXPECT_FALSE(result.Valid);
 }
 
+namespace {
+// MockSensor always posts timestamp 0, this one lets the test control the clock
+struct TimestampedSensor : public StoredValueSensor {
+	TimestampedSensor(SensorType type, efitick_t timeoutNt)
+		: StoredValueSensor(type, timeoutNt) {
+	}
+
+	void post(float value, efitick_t stamp) {
+		setValidValue(value, stamp);
+	}
+};
+} // namespace
+
+TEST_F(SensorBasic, FreshnessSweep) {
+	TimestampedSensor dut(SensorType::Clt, MS2NT(50));
+	ASSERT_TRUE(dut.Register());
+
+	// a fresh reading doesn't trip the sweep
+	dut.post(30, MS2NT(10));
+	Sensor::checkFreshness(MS2NT(20));
+	EXPECT_EQ(0u, Sensor::getStaleCounter(SensorType::Clt));
+	EXPECT_EQ(0, Sensor::getStaleCount());
+
+	// deadline blown
+	Sensor::checkFreshness(MS2NT(100));
+	EXPECT_EQ(1u, Sensor::getStaleCounter(SensorType::Clt));
+	EXPECT_EQ(1, Sensor::getStaleCount());
+	EXPECT_EQ(1u, Sensor::getTotalStaleCounter());
+
+	// still stale - same fault, not a second event
+	Sensor::checkFreshness(MS2NT(200));
+	EXPECT_EQ(1u, Sensor::getStaleCounter(SensorType::Clt));
+
+	// a new reading recovers the sensor...
+	dut.post(31, MS2NT(210));
+	Sensor::checkFreshness(MS2NT(220));
+	EXPECT_EQ(0, Sensor::getStaleCount());
+
+	// ...and going stale again is a second event
+	Sensor::checkFreshness(MS2NT(300));
+	EXPECT_EQ(2u, Sensor::getStaleCounter(SensorType::Clt));
+	EXPECT_EQ(1, Sensor::getStaleCount());
+}
+
+TEST_F(SensorBasic, ReadWithAge) {
+	TimestampedSensor dut(SensorType::Clt, MS2NT(50));
+	ASSERT_TRUE(dut.Register());
+
+	dut.post(30, MS2NT(10));
+
+	efitick_t age = 0;
+	auto result = Sensor::getWithAge(SensorType::Clt, MS2NT(25), age);
+	EXPECT_TRUE(result.Valid);
+	EXPECT_FLOAT_EQ(result.Value, 30);
+	EXPECT_EQ(MS2NT(15), age);
+
+	// mocked sensors have no timestamps, they read back as perfectly fresh
+	Sensor::setMockValue(SensorType::Clt, 12);
+	auto mocked = Sensor::getWithAge(SensorType::Clt, MS2NT(1000), age);
+	EXPECT_TRUE(mocked.Valid);
+	EXPECT_EQ((efitick_t)0, age);
+}
+
 TEST_F(SensorBasic, SensorInitialized) {
 	MockSensor dut(SensorType::Clt);
 	ASSERT_TRUE(dut.Register());
@@ -113,6 +113,18 @@ TEST(sensors, testCamInput) {
 	// asserting that error code has cleared
 	ASSERT_EQ(0,  unitTestWarningCodeState.recentWarnings.getCount()) << "warningCounter#testCamInput #3";
 	ASSERT_NEAR(181, engine->triggerCentral.getVVTPosition(), EPS3D);
+	// the cam has been sitting at the same phase, no movement measured
+	ASSERT_NEAR(0, engine->triggerCentral.getVVTPhaseRate(), EPS3D);
+
+	// now the cam advances by 1ms within the 50ms revolution: 7.2 degrees of phase
+	eth.moveTimeForwardUs(MS2US(11));
+	hwHandleVvtCamSignal(TV_FALL, getTimeNowNt() PASS_ENGINE_PARAMETER_SUFFIX);
+	eth.moveTimeForwardUs(MS2US(39));
+	eth.firePrimaryTriggerRise();
+
+	ASSERT_NEAR(188.2, engine->triggerCentral.getVVTPosition(), EPS3D);
+	// 7.2 degrees over one 50ms cam period
+	ASSERT_NEAR(144, engine->triggerCentral.getVVTPhaseRate(), 0.01);
 }
 
 TEST(sensors, testNB2CamInput) {
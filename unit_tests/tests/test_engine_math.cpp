@@ -6,6 +6,7 @@
  */
 
 #include "engine_math.h"
+#include "gear_detector.h"
 #include "map.h"
 #include "speed_density.h"
 #include "engine_test_helper.h"
@@ -21,6 +22,38 @@ TEST(misc, structSize) {
 	ASSERT_EQ(20000, sizeof(persistent_config_s));
 }
 
+TEST(misc, testValidateConfiguration) {
+	WITH_ENGINE_TEST_HELPER(FORD_ESCORT_GT);
+
+	// a sane configuration passes through without fixups
+	engine->validateConfiguration(PASS_ENGINE_PARAMETER_SIGNATURE);
+	ASSERT_EQ(0, engine->validatedConfig.fixupCounter);
+	ASSERT_EQ(engineConfiguration->specs.cylindersCount, engine->validatedConfig.cylindersCount);
+
+	// broken raw values get clamped into the trusted view, one warning each
+	engineConfiguration->specs.cylindersCount = 0;
+	engineConfiguration->specs.displacement = NAN;
+	engineConfiguration->injector.flow = -5;
+	engine->validateConfiguration(PASS_ENGINE_PARAMETER_SIGNATURE);
+	ASSERT_EQ(3, engine->validatedConfig.fixupCounter);
+	ASSERT_EQ(1, engine->validatedConfig.cylindersCount);
+	ASSERT_TRUE(engine->validatedConfig.displacement > 0);
+	ASSERT_TRUE(engine->validatedConfig.injectorFlow > 0);
+}
+
+TEST(misc, testHotConfigMirror) {
+	WITH_ENGINE_TEST_HELPER(FORD_ESCORT_GT);
+
+	// populated during helper construction via applyNonPersistentConfiguration()
+	ASSERT_EQ(engineConfiguration->specs.cylindersCount, engine->hotConfig.cylindersCount);
+	ASSERT_EQ(engineConfiguration->injectionMode, engine->hotConfig.injectionMode);
+
+	// the mirror follows the raw configuration on the configuration-change event
+	engineConfiguration->rpmHardLimit = 7777;
+	incrementGlobalConfigurationVersion(PASS_ENGINE_PARAMETER_SIGNATURE);
+	ASSERT_EQ(7777, engine->hotConfig.rpmHardLimit);
+}
+
 TEST(misc, testIgnitionPlanning) {
 	printf("*************************************************** testIgnitionPlanning\r\n");
 	WITH_ENGINE_TEST_HELPER(FORD_ESCORT_GT);
@@ -63,6 +96,37 @@ TEST(misc, testEngineMath) {
 	ASSERT_FLOAT_EQ(65.5625f/*kg/h*/, engine->engineState.airFlow);
 }
 
+TEST(misc, testSpeedDensityPipelineStages) {
+	WITH_ENGINE_TEST_HELPER(FORD_ESCORT_GT);
+
+	resetSpeedDensityCache();
+	engine->engineState.sd.tChargeK = 273.15f + 20.0f;
+	engine->engineState.currentBaroCorrectedVE = 1.0f;
+	engine->engineState.targetAFR = 14.7f;
+
+	int airMassRuns = sdAirMassRecalcCounter;
+	int skipped = speedDensitySkippedRecalcCounter;
+
+	floatms_t fuel = getSpeedDensityFuel(/*MAP*/100 PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_TRUE(fuel > 0);
+	// the cold pipeline runs every stage
+	ASSERT_EQ(airMassRuns + 1, sdAirMassRecalcCounter);
+	ASSERT_NEAR(0.5464f, engine->engineState.sd.airMassInOneCylinder, EPS4D);
+	// 1.839L at 100kPa/VE=1 works out to roughly the engine's rated torque
+	ASSERT_NEAR(156.18f, engine->engineState.estimatedEngineTorque, 0.1f);
+
+	// identical inputs: every stage is served from cache
+	ASSERT_EQ(fuel, getSpeedDensityFuel(/*MAP*/100 PASS_ENGINE_PARAMETER_SUFFIX));
+	ASSERT_EQ(skipped + 1, speedDensitySkippedRecalcCounter);
+
+	// only the AFR target moved: the fuel and torque stages rerun while the
+	// manifold and air mass stages are reused
+	engine->engineState.targetAFR = 13.0f;
+	floatms_t richerFuel = getSpeedDensityFuel(/*MAP*/100 PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_TRUE(richerFuel > fuel);
+	ASSERT_EQ(airMassRuns + 1, sdAirMassRecalcCounter);
+}
+
 TEST(misc, testIgnitionMapGenerator) {
 	printf("*************************************************** testIgnitionMapGenerator\r\n");
 
@@ -93,3 +157,29 @@ TEST(misc, testIgnitionMapGenerator) {
 float getMap(DECLARE_ENGINE_PARAMETER_SIGNATURE) {
 	return engine->mockMapValue;
 }
+
+TEST(misc, testGearDetector) {
+	GearDetector detector;
+	detector.setGearRatio(1, 130);
+	detector.setGearRatio(2, 75);
+	detector.setGearRatio(3, 50);
+
+	ASSERT_EQ(1, detector.classifyRatio(130));
+	ASSERT_EQ(2, detector.classifyRatio(78));
+	ASSERT_EQ(3, detector.classifyRatio(46));
+	// between bands and beyond first gear is unknown
+	ASSERT_EQ(0, detector.classifyRatio(100));
+	ASSERT_EQ(0, detector.classifyRatio(300));
+
+	// a new gear is published only after a few consistent classifications
+	ASSERT_EQ(0, detector.update(3900, 30));
+	ASSERT_EQ(0, detector.update(3900, 30));
+	ASSERT_EQ(1, detector.update(3900, 30));
+	// mid-shift ratio reads as unknown and does not move the published gear
+	ASSERT_EQ(1, detector.update(3000, 30));
+	ASSERT_EQ(1, detector.update(2250, 30));
+	ASSERT_EQ(1, detector.update(2250, 30));
+	ASSERT_EQ(2, detector.update(2250, 30));
+	// standing still resets to unknown immediately
+	ASSERT_EQ(0, detector.update(900, 0));
+}
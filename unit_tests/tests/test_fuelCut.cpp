@@ -10,6 +10,7 @@
 #include "event_queue.h"
 #include "tps.h"
 #include "fsio_impl.h"
+#include "dfco_sequencer.h"
 
 TEST(fuelCut, coasting) {
 	printf("*************************************************** testCoastingFuelCut\r\n");
@@ -129,3 +130,46 @@ TEST(fuel, injectorFlowCorrection) {
 
 
 }
+
+TEST(fuelCut, sequencer) {
+	DfcoSequencer sequencer;
+	sequencer.configure(4, 4);
+	ASSERT_TRUE(sequencer.isFullyRunning());
+
+	// entry walks the firing order one cylinder per engine cycle
+	sequencer.setCutRequest(true);
+	sequencer.onEngineCycle();
+	ASSERT_NEAR(0, sequencer.getPositionMultiplier(0), EPS4D);
+	ASSERT_NEAR(1, sequencer.getPositionMultiplier(1), EPS4D);
+	sequencer.onEngineCycle();
+	sequencer.onEngineCycle();
+	ASSERT_NEAR(0, sequencer.getPositionMultiplier(2), EPS4D);
+	ASSERT_NEAR(1, sequencer.getPositionMultiplier(3), EPS4D);
+	ASSERT_FALSE(sequencer.isFullyCut());
+	sequencer.onEngineCycle();
+	ASSERT_TRUE(sequencer.isFullyCut());
+
+	// resume restores one cylinder per cycle, each with its own fuel ramp
+	sequencer.setCutRequest(false);
+	sequencer.onEngineCycle();
+	ASSERT_NEAR(0.25, sequencer.getPositionMultiplier(0), EPS4D);
+	ASSERT_NEAR(0, sequencer.getPositionMultiplier(1), EPS4D);
+	sequencer.onEngineCycle();
+	ASSERT_NEAR(0.5, sequencer.getPositionMultiplier(0), EPS4D);
+	ASSERT_NEAR(0.25, sequencer.getPositionMultiplier(1), EPS4D);
+	sequencer.onEngineCycle();
+	sequencer.onEngineCycle();
+	ASSERT_NEAR(1, sequencer.getPositionMultiplier(0), EPS4D);
+	ASSERT_NEAR(0.25, sequencer.getPositionMultiplier(3), EPS4D);
+	ASSERT_FALSE(sequencer.isFullyRunning());
+	sequencer.onEngineCycle();
+	sequencer.onEngineCycle();
+	sequencer.onEngineCycle();
+	ASSERT_TRUE(sequencer.isFullyRunning());
+
+	// a cut request mid-resume starts cutting again from the front of the order
+	sequencer.setCutRequest(true);
+	sequencer.onEngineCycle();
+	ASSERT_NEAR(0, sequencer.getPositionMultiplier(0), EPS4D);
+	ASSERT_NEAR(1, sequencer.getPositionMultiplier(1), EPS4D);
+}
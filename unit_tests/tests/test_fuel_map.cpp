@@ -13,6 +13,7 @@
 #include "engine_test_helper.h"
 #include "efi_gpio.h"
 #include "advance_map.h"
+#include "shadow_tune.h"
 
 extern float testMafValue;
 
@@ -220,6 +221,64 @@ TEST(misc, testPinHelper) {
 	ASSERT_EQ(1, getElectricalValue(0, OM_INVERTED));
 }
 
+TEST(misc, testQuantizedMap3d) {
+	// int8 ignition cells with 0.5 degree resolution and -64 offset
+	static ign_quantized_Map3D_t quantized("q", 0.5f, -64);
+	static int8_t qTable[IGN_RPM_COUNT][IGN_LOAD_COUNT];
+	static float loadBins[IGN_LOAD_COUNT];
+	static float rpmBins[IGN_RPM_COUNT];
+	setLinearCurve(loadBins, 0, IGN_LOAD_COUNT - 1, 1);
+	setLinearCurve(rpmBins, 0, IGN_RPM_COUNT - 1, 1);
+	quantized.init(qTable, loadBins, rpmBins);
+	// raw 20 dequantizes to 0.5 * 20 - 64 = -54 degrees
+	quantized.setAll(20);
+	ASSERT_NEAR(-54, quantized.getValue(5, 5), EPS4D);
+	// interpolation happens on raw values, dequantization is applied to the result
+	qTable[5][5] = 24;
+	qTable[5][6] = 24;
+	qTable[6][5] = 24;
+	qTable[6][6] = 24;
+	ASSERT_NEAR(-52, quantized.getValue(5.5f, 5.5f), EPS4D);
+}
+
+extern WarningCodeState unitTestWarningCodeState;
+
+TEST(fuel, testShadowTune) {
+	WITH_ENGINE_TEST_HELPER(FORD_ESCORT_GT);
+	// the engine helper has initialized the delta maps against the active tune axes
+
+	setShadowTuneEnabled(true);
+	for (int loadIndex = 0; loadIndex < FUEL_LOAD_COUNT; loadIndex++) {
+		for (int rpmIndex = 0; rpmIndex < FUEL_RPM_COUNT; rpmIndex++) {
+			setShadowVeDelta(loadIndex, rpmIndex, 5);
+		}
+	}
+	for (int loadIndex = 0; loadIndex < IGN_LOAD_COUNT; loadIndex++) {
+		for (int rpmIndex = 0; rpmIndex < IGN_RPM_COUNT; rpmIndex++) {
+			setShadowTimingDelta(loadIndex, rpmIndex, -1.5);
+		}
+	}
+
+	SharedTableCell<FUEL_RPM_COUNT, FUEL_LOAD_COUNT, float> cell;
+	cell.resolve(config->veRpmBins, config->veLoadBins, 2400, 40);
+	engine->engineState.currentRawVE = 50;
+	engine->engineState.timingAdvance = 10;
+	runShadowTune(cell, 2400, 40 PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_NEAR(55, engine->engineState.shadowVe, EPS4D);
+	ASSERT_NEAR(8.5, engine->engineState.shadowTimingAdvance, EPS4D);
+
+	// a disabled shadow tune is inert
+	setShadowTuneEnabled(false);
+	engine->engineState.currentRawVE = 80;
+	runShadowTune(cell, 2400, 40 PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_NEAR(55, engine->engineState.shadowVe, EPS4D);
+
+	// out-of-range edits are rejected with a warning
+	setShadowVeDelta(FUEL_LOAD_COUNT, 0, 9);
+	ASSERT_EQ(1, unitTestWarningCodeState.recentWarnings.getCount());
+	ASSERT_EQ(CUSTOM_ERR_6639, unitTestWarningCodeState.recentWarnings.get(0));
+}
+
 extern fuel_Map3D_t veMap;
 
 TEST(fuel, testTpsBasedVeDefect799) {
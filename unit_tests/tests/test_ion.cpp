@@ -32,3 +32,51 @@ TEST(ion, signalCounter) {
 	EXPECT_EQ(0, state.getValue(/* currentRevolution= */5));
 }
 
+TEST(ion, burnWindowFeatures) {
+	IonBurnWindow window;
+
+	// a triangle burst: the decimated peak should land mid-window
+	for (int i = 0; i < 64; i++) {
+		window.onSample(i < 32 ? i * 10 : (63 - i) * 10);
+	}
+	ASSERT_EQ(16, window.binCount);
+	// bin 7 holds the average of raw samples 28..31
+	EXPECT_EQ(7, window.getPeakBin());
+	EXPECT_EQ(295, window.getPeakValue());
+	EXPECT_TRUE(window.hasData());
+
+	window.reset();
+	EXPECT_FALSE(window.hasData());
+	EXPECT_EQ(0, window.getPeakValue());
+}
+
+TEST(ion, combustionQuality) {
+	IonBurnAnalysis analysis;
+
+	// the first healthy burn seeds the per-cylinder reference
+	analysis.startWindow(0);
+	for (int i = 0; i < 64; i++) {
+		analysis.onSample(100);
+	}
+	analysis.endWindow();
+	EXPECT_EQ(1, analysis.windowCount);
+	EXPECT_EQ(100, analysis.getCombustionQuality(0));
+
+	// a half-strength burn on the same cylinder reads as degraded quality
+	analysis.startWindow(0);
+	for (int i = 0; i < 64; i++) {
+		analysis.onSample(50);
+	}
+	analysis.endWindow();
+	EXPECT_EQ(50, analysis.getCombustionQuality(0));
+
+	// an empty window (capture not wired up) does not poison the state
+	analysis.startWindow(0);
+	analysis.endWindow();
+	EXPECT_EQ(2, analysis.windowCount);
+	EXPECT_EQ(50, analysis.getCombustionQuality(0));
+
+	// other cylinders are tracked independently
+	EXPECT_EQ(0, analysis.getCombustionQuality(1));
+}
+
@@ -0,0 +1,61 @@
+/*
+ * @file test_knock_analyzer.cpp
+ *
+ * @date Aug 28, 2020
+ * @author Andrey Belomutskiy, (c) 2012-2020
+ */
+
+#include "engine_test_helper.h"
+#include "knock_analyzer.h"
+#include "goertzel.h"
+
+#include <math.h>
+
+#define TEST_SAMPLE_RATE 100000.0f
+#define TEST_WINDOW_SIZE 500
+
+static void fillSine(int16_t *samples, int count, float frequencyHz, float amplitude) {
+	for (int i = 0; i < count; i++) {
+		samples[i] = (int16_t) (amplitude * sinf(2 * 3.14159265f * frequencyHz * i / TEST_SAMPLE_RATE));
+	}
+}
+
+TEST(knock, goertzelSelectivity) {
+	GoertzelDetector detector;
+	detector.init(6000, TEST_SAMPLE_RATE);
+
+	int16_t samples[TEST_WINDOW_SIZE];
+
+	fillSine(samples, TEST_WINDOW_SIZE, 6000, 1000);
+	float onBand = detector.processWindow(samples, TEST_WINDOW_SIZE);
+
+	fillSine(samples, TEST_WINDOW_SIZE, 15000, 1000);
+	float offBand = detector.processWindow(samples, TEST_WINDOW_SIZE);
+
+	// a 1000-count sine on the target bin reads close to half its amplitude
+	ASSERT_NEAR(500, onBand, 50);
+	ASSERT_TRUE(onBand > 20 * offBand) << "single-bin DFT selectivity";
+}
+
+TEST(knock, windowFlow) {
+	WITH_ENGINE_TEST_HELPER(TEST_ENGINE);
+
+	// pin the knock band so the test does not depend on the bore default
+	engineConfiguration->knockBandCustom = 6;
+	initKnockAnalyzer(NULL PASS_ENGINE_PARAMETER_SUFFIX);
+
+	int16_t samples[TEST_WINDOW_SIZE];
+	fillSine(samples, TEST_WINDOW_SIZE, 6000, 1000);
+
+	// samples outside any window are discarded
+	endKnockSampleWindow();
+	onKnockSamplesReady(samples, TEST_WINDOW_SIZE PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_EQ(0, getKnockIndex(0));
+
+	startKnockSampleWindow(0);
+	onKnockSamplesReady(samples, TEST_WINDOW_SIZE PASS_ENGINE_PARAMETER_SUFFIX);
+	endKnockSampleWindow();
+
+	ASSERT_TRUE(getKnockIndex(0) > 10) << "on-band window raises the cylinder index";
+	ASSERT_EQ(0, getKnockIndex(1)) << "other cylinders unaffected";
+}
@@ -0,0 +1,246 @@
+/*
+ * @file test_pid_characterization.cpp
+ *
+ * Step/ramp/sine response characterization and throughput benchmark for the
+ * Pid variants (Pid, PidCic, PidIndustrial) against simulated plants: a
+ * DC-motor-with-return-spring model standing in for the throttle body and a
+ * first-order thermal model standing in for the CJ125 heater. We tune a dozen
+ * PID loops; a reproducible rig beats dyno trial-and-error and catches
+ * regressions in the controller math itself.
+ *
+ * Response metrics print as machine-readable lines for diffing across builds:
+ *     PIDCHAR,<controller>,<plant>,<profile>,<riseMs>,<overshootPct>,<settleMs>,<rmsError>
+ *
+ * @date Aug 28, 2020
+ */
+
+#include "unit_test_framework.h"
+#include "pid.h"
+
+#include <chrono>
+#include <math.h>
+
+#define CHAR_STEP_COUNT 2000
+// 200Hz control frequency, see PID_MINIMAL_PERIOD_MS
+#define CHAR_DT_SEC 0.005f
+
+/**
+ * DC motor against a return spring, the dominant dynamics of a throttle body:
+ * duty produces torque, the spring pulls the plate back to the limp-home
+ * position, viscous friction damps the plate
+ */
+class EtbPlant {
+public:
+	float position = 0;
+
+	float update(float duty) {
+		float accel = TORQUE_GAIN * duty - SPRING_RATE * position - FRICTION * velocity;
+		velocity += accel * CHAR_DT_SEC;
+		position += velocity * CHAR_DT_SEC;
+		position = maxF(0, minF(position, 100));
+		return position;
+	}
+
+private:
+	static constexpr float TORQUE_GAIN = 120.0f;
+	static constexpr float SPRING_RATE = 80.0f;
+	static constexpr float FRICTION = 12.0f;
+	float velocity = 0;
+};
+
+/**
+ * first-order thermal plant: heater duty against convective loss, roughly the
+ * CJ125 sensor heating problem
+ */
+class ThermalPlant {
+public:
+	float temperature = 20;
+
+	float update(float duty) {
+		temperature += (HEAT_GAIN * duty - COOLING_RATE * (temperature - 20)) * CHAR_DT_SEC;
+		return temperature;
+	}
+
+private:
+	static constexpr float HEAT_GAIN = 14.0f;
+	static constexpr float COOLING_RATE = 0.8f;
+};
+
+typedef struct {
+	float riseMs;
+	float overshootPct;
+	float settleMs;
+	float rmsError;
+} response_metrics_s;
+
+static response_metrics_s analyzeResponse(const float response[], const float targets[], int count,
+		bool isStep) {
+	response_metrics_s metrics;
+	metrics.riseMs = -1;
+	metrics.overshootPct = 0;
+	metrics.settleMs = -1;
+
+	double errorSquareSum = 0;
+	for (int i = 0; i < count; i++) {
+		float error = targets[i] - response[i];
+		errorSquareSum += error * error;
+	}
+	metrics.rmsError = sqrtf(errorSquareSum / count);
+
+	if (!isStep) {
+		return metrics;
+	}
+
+	float target = targets[count - 1];
+	float rise10Ms = -1;
+	float rise90Ms = -1;
+	float peak = 0;
+	for (int i = 0; i < count; i++) {
+		float timeMs = i * CHAR_DT_SEC * 1000;
+		if (rise10Ms < 0 && response[i] >= 0.1f * target) {
+			rise10Ms = timeMs;
+		}
+		if (rise90Ms < 0 && response[i] >= 0.9f * target) {
+			rise90Ms = timeMs;
+		}
+		peak = maxF(peak, response[i]);
+		// settling time: last moment outside the 5% band
+		if (absF(response[i] - target) > 0.05f * target) {
+			metrics.settleMs = timeMs;
+		}
+	}
+	if (rise10Ms >= 0 && rise90Ms >= 0) {
+		metrics.riseMs = rise90Ms - rise10Ms;
+	}
+	if (target > 0) {
+		metrics.overshootPct = maxF(0, 100 * (peak - target) / target);
+	}
+	return metrics;
+}
+
+typedef float (*target_profile_t)(int stepIndex);
+
+static float stepProfile(int) {
+	return 50;
+}
+
+static float rampProfile(int stepIndex) {
+	return minF(80, stepIndex * 0.1f);
+}
+
+static float sineProfile(int stepIndex) {
+	return 50 + 30 * sinf(stepIndex * CHAR_DT_SEC * 2 * 3.14159265f);
+}
+
+template<typename Plant>
+static response_metrics_s characterize(const char *controllerName, Pid *pid, Plant *plant,
+		const char *plantName, const char *profileName, target_profile_t profile) {
+	static float response[CHAR_STEP_COUNT];
+	static float targets[CHAR_STEP_COUNT];
+
+	pid->reset();
+	float feedback = plant->update(0);
+	for (int i = 0; i < CHAR_STEP_COUNT; i++) {
+		targets[i] = profile(i);
+		float duty = pid->getOutput(targets[i], feedback, CHAR_DT_SEC);
+		feedback = plant->update(duty);
+		response[i] = feedback;
+	}
+
+	response_metrics_s metrics = analyzeResponse(response, targets, CHAR_STEP_COUNT,
+			profile == stepProfile);
+	printf("PIDCHAR,%s,%s,%s,%.1f,%.1f,%.1f,%.3f\r\n", controllerName, plantName, profileName,
+			metrics.riseMs, metrics.overshootPct, metrics.settleMs, metrics.rmsError);
+	return metrics;
+}
+
+static void characterizeAllProfiles(const char *controllerName, Pid *pid) {
+	{
+		EtbPlant plant;
+		response_metrics_s step = characterize(controllerName, pid, &plant, "etb", "step", stepProfile);
+		// a sane controller on this plant reaches the target and stays there
+		EXPECT_TRUE(step.riseMs > 0) << controllerName << " never reached 90% of the step target";
+		EXPECT_LT(step.settleMs, CHAR_STEP_COUNT * CHAR_DT_SEC * 1000) << controllerName << " never settled";
+	}
+	{
+		EtbPlant plant;
+		characterize(controllerName, pid, &plant, "etb", "ramp", rampProfile);
+	}
+	{
+		EtbPlant plant;
+		characterize(controllerName, pid, &plant, "etb", "sine", sineProfile);
+	}
+	{
+		ThermalPlant plant;
+		characterize(controllerName, pid, &plant, "heater", "step", stepProfile);
+	}
+}
+
+TEST(util, pidCharacterization) {
+	pid_s pidS;
+	pidS.pFactor = 2.0;
+	pidS.iFactor = 12.0;
+	pidS.dFactor = 0.05;
+	pidS.offset = 0;
+	pidS.minValue = -100;
+	pidS.maxValue = 100;
+	pidS.periodMs = 5;
+
+	Pid pid(&pidS);
+	characterizeAllProfiles("pid", &pid);
+
+	PidIndustrial industrial(&pidS);
+	industrial.antiwindupFreq = 0.1f;
+	industrial.derivativeFilterLoss = 0.01f;
+	characterizeAllProfiles("pidIndustrial", &industrial);
+
+	// the CIC variant is built for slow incremental control, only characterized
+	// on the slow plant where its averaging window makes sense
+	PidCic cic(&pidS);
+	ThermalPlant plant;
+	characterize("pidCic", &cic, &plant, "heater", "step", stepProfile);
+}
+
+static volatile float pidBenchSink;
+
+static void benchmarkController(const char *name, Pid *pid) {
+	const int iterations = 1000000;
+	pid->reset();
+
+	// warmup keeps the first-call paths out of the measurement
+	for (int i = 0; i < 1000; i++) {
+		pidBenchSink = pid->getOutput(50, i % 100, CHAR_DT_SEC);
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++) {
+		pidBenchSink = pid->getOutput(50, i % 100, CHAR_DT_SEC);
+	}
+	auto end = std::chrono::steady_clock::now();
+
+	double nsPerOp = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+			/ (double) iterations;
+	reportBenchResult(name, iterations, nsPerOp);
+}
+
+TEST(benchmark, pidGetOutput) {
+	pid_s pidS;
+	pidS.pFactor = 2.0;
+	pidS.iFactor = 12.0;
+	pidS.dFactor = 0.05;
+	pidS.offset = 0;
+	pidS.minValue = -100;
+	pidS.maxValue = 100;
+	pidS.periodMs = 5;
+
+	Pid pid(&pidS);
+	benchmarkController("pidGetOutput", &pid);
+
+	PidCic cic(&pidS);
+	benchmarkController("pidCicGetOutput", &cic);
+
+	PidIndustrial industrial(&pidS);
+	industrial.antiwindupFreq = 0.1f;
+	industrial.derivativeFilterLoss = 0.01f;
+	benchmarkController("pidIndustrialGetOutput", &industrial);
+}
@@ -101,6 +101,58 @@ static void testSwitchToNanPeriod() {
 	assertNextEvent("exec3@NAN", LOW_VALUE, &executor);
 }
 
+static int syncPinValues[2] = { -1, -1 };
+
+static void testApplySyncPinState(int stateIndex, PwmConfig *state) /* pwm_gen_callback */ {
+	for (int channelIndex = 0; channelIndex < state->multiChannelStateSequence.waveCount; channelIndex++) {
+		syncPinValues[channelIndex] = state->multiChannelStateSequence.getChannelState(channelIndex, stateIndex);
+	}
+	printf("PWM_test: sync pins=%d/%d @ timeNow=%d\r\n", syncPinValues[0], syncPinValues[1], timeNowUs);
+}
+
+TEST(misc, testSynchronizedPwm) {
+	timeNowUs = 0;
+	TestExecutor executor;
+	SynchronizedPwm pwm("sync PWM");
+	OutputPin pinA;
+	OutputPin pinB;
+	OutputPin *outputs[2] = { &pinA, &pinB };
+
+	// channel 0: 50% duty at cycle start, channel 1: 25% duty half a period later
+	float dutyCycles[2] = { 0.5, 0.25 };
+	float phaseOffsets[2] = { 0, 0.5 };
+
+	startSynchronizedPwm(&pwm, "unit_test", &executor, 2, outputs,
+			1000 /* frequency */, dutyCycles, phaseOffsets,
+			(pwm_gen_callback*)&testApplySyncPinState);
+
+	// both channels live on a single scheduling entry
+	ASSERT_EQ( 1,  executor.size()) << "sync PWM single event";
+	// cycle start: channel 0 high, channel 1 low
+	ASSERT_EQ( 1,  syncPinValues[0]) << "ch0@0";
+	ASSERT_EQ( 0,  syncPinValues[1]) << "ch1@0";
+	assertEqualsM2("sync switch 1", 500, executor.getForUnitTest(0)->momentX, 0);
+
+	timeNowUs = 500;
+	ASSERT_EQ( 1,  executor.executeAll(timeNowUs));
+	// 0.5 into the period: channel 0 falls as channel 1 rises, deterministic phase shift
+	ASSERT_EQ( 0,  syncPinValues[0]) << "ch0@500";
+	ASSERT_EQ( 1,  syncPinValues[1]) << "ch1@500";
+	assertEqualsM2("sync switch 2", 750, executor.getForUnitTest(0)->momentX, 0);
+
+	timeNowUs = 750;
+	ASSERT_EQ( 1,  executor.executeAll(timeNowUs));
+	ASSERT_EQ( 0,  syncPinValues[0]) << "ch0@750";
+	ASSERT_EQ( 0,  syncPinValues[1]) << "ch1@750";
+	assertEqualsM2("sync cycle end", 1000, executor.getForUnitTest(0)->momentX, 0);
+
+	timeNowUs = 1000;
+	ASSERT_EQ( 1,  executor.executeAll(timeNowUs));
+	// next cycle starts over
+	ASSERT_EQ( 1,  syncPinValues[0]) << "ch0@1000";
+	ASSERT_EQ( 0,  syncPinValues[1]) << "ch1@1000";
+}
+
 TEST(misc, testPwmGenerator) {
 	test100dutyCycle();
 	testSwitchToNanPeriod();
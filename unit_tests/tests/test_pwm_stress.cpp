@@ -0,0 +1,211 @@
+/**
+ * @file	test_pwm_stress.cpp
+ *
+ * Edge-rate stress fixture for the scheduler and the software PWM backend: thousands
+ * of concurrent SimplePwm instances and raw EventQueue entries driven under simulated
+ * time (see TestExecutor::advanceTime), with invariant checks instead of golden
+ * values - no missed or duplicated edges, queue depth bounded by the number of live
+ * producers, zero start latency while virtual execution is free. The functional
+ * tests in test_pwm_generator.cpp cover single-instance correctness; this fixture is
+ * the safety net a scheduler or timer-wheel rewrite has to pass before we trust it
+ * with coils.
+ *
+ * The PWM case also reports a machine-readable
+ *     BENCH,pwm_stress_edges,<edges>,<ns_per_edge>
+ * line in the benchmark_suite.cpp format, so the same binary doubles as an on-host
+ * profiling target. Run just these with
+ *     ./rusefi_test pwm_stress.*
+ *
+ * @date Aug 28, 2020
+ */
+
+#include "global.h"
+#include "unit_test_framework.h"
+#include "pwm_generator_logic.h"
+#include "global_execution_queue.h"
+#include "event_queue.h"
+
+#include <chrono>
+
+extern int timeNowUs;
+
+/**
+ * enough instances that linear scheduler cost would show, small enough that the
+ * sorted-list checks of the debug build finish in CI time; the heap backend has a
+ * fixed backing store, so under EFI_EVENT_QUEUE_HEAP the population shrinks to its
+ * capacity and the depth invariants still hold
+ */
+#if EFI_EVENT_QUEUE_HEAP
+#define STRESS_PWM_COUNT (EVENT_QUEUE_MAX_SIZE - 1)
+#else
+#define STRESS_PWM_COUNT 1024
+#endif
+#define STRESS_SIMULATED_US 500000
+
+static SimplePwm stressPwms[STRESS_PWM_COUNT];
+static OutputPin stressPins[STRESS_PWM_COUNT];
+static int stressEdgeCounters[STRESS_PWM_COUNT];
+
+static void stressApplyPinState(int stateIndex, PwmConfig *state) /* pwm_gen_callback */ {
+	UNUSED(stateIndex);
+	int index = (SimplePwm *) state - stressPwms;
+	stressEdgeCounters[index]++;
+}
+
+static float stressFrequency(int index) {
+	// 20..219 Hz, deterministic spread so every list insertion position is exercised
+	return 20 + (index % 200);
+}
+
+TEST(pwm_stress, thousandConcurrentPwm) {
+	timeNowUs = 0;
+	TestExecutor executor;
+	memset(stressEdgeCounters, 0, sizeof(stressEdgeCounters));
+
+	for (int i = 0; i < STRESS_PWM_COUNT; i++) {
+		// avoid 0% and 100%: PM_ZERO/PM_FULL instances stop producing edges on purpose
+		float duty = 0.25f + 0.125f * (i % 5);
+		startSimplePwm(&stressPwms[i], "stress",
+				&executor,
+				&stressPins[i],
+				stressFrequency(i),
+				duty,
+				(pwm_gen_callback*)&stressApplyPinState);
+	}
+	// every instance keeps exactly one scheduling entry in flight
+	ASSERT_EQ(STRESS_PWM_COUNT, executor.size());
+
+	executor.resetLatencyStats();
+	auto start = std::chrono::steady_clock::now();
+	executor.advanceTime(STRESS_SIMULATED_US);
+	auto end = std::chrono::steady_clock::now();
+
+	int totalEdges = 0;
+	for (int i = 0; i < STRESS_PWM_COUNT; i++) {
+		// two transitions per period; the tolerance only covers the fractional
+		// period at the horizon, a systematic miss is orders of magnitude larger
+		double expected = 2.0 * stressFrequency(i) * STRESS_SIMULATED_US / 1e6;
+		ASSERT_NEAR(expected, stressEdgeCounters[i], 4) << "edge count of instance " << i;
+		totalEdges += stressEdgeCounters[i];
+	}
+	// no instance ever lost its scheduling entry or acquired a second one
+	ASSERT_EQ(STRESS_PWM_COUNT, executor.size()) << "queue depth at horizon";
+	ASSERT_EQ(STRESS_PWM_COUNT, executor.maxQueueDepth) << "queue depth bound";
+	// virtual execution is free here, so any start delay is a scheduler defect
+	ASSERT_EQ(0, executor.maxLatenessUs) << "start latency";
+	ASSERT_EQ(totalEdges, executor.executedCounter) << "executor/callback edge accounting";
+
+	double nsPerEdge = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+			/ (double) totalEdges;
+	reportBenchResult("pwm_stress_edges", totalEdges, nsPerEdge);
+}
+
+/**
+ * duty and frequency churn on a rotating subset while everything keeps running -
+ * reconfiguration must never lose an edge stream or duplicate a scheduling entry
+ */
+TEST(pwm_stress, reconfigurationChurn) {
+	timeNowUs = 0;
+	TestExecutor executor;
+	memset(stressEdgeCounters, 0, sizeof(stressEdgeCounters));
+
+	const int count = STRESS_PWM_COUNT < 256 ? STRESS_PWM_COUNT : 256;
+	for (int i = 0; i < count; i++) {
+		startSimplePwm(&stressPwms[i], "churn",
+				&executor,
+				&stressPins[i],
+				stressFrequency(i),
+				0.5f,
+				(pwm_gen_callback*)&stressApplyPinState);
+	}
+
+	int previousCounters[256];
+	for (int window = 0; window < 10; window++) {
+		memcpy(previousCounters, stressEdgeCounters, count * sizeof(int));
+		executor.advanceTime(100000);
+		for (int i = 0; i < count; i++) {
+			// the slowest instance still produces four edges per 100ms window
+			ASSERT_GT(stressEdgeCounters[i], previousCounters[i]) << "instance " << i
+					<< " stalled in window " << window;
+		}
+		ASSERT_EQ(count, executor.size()) << "queue depth after window " << window;
+		// reconfigure a rotating quarter of the population mid-flight
+		for (int i = window % 4; i < count; i += 4) {
+			stressPwms[i].setSimplePwmDutyCycle(0.2f + 0.1f * (window % 6));
+			stressPwms[i].setFrequency(stressFrequency((i + window) % count));
+		}
+	}
+	ASSERT_EQ(0, executor.maxLatenessUs) << "start latency";
+}
+
+/**
+ * tiny deterministic PRNG in the test_trigger_fuzz.cpp mold so the insertion
+ * order is reproducible across hosts
+ */
+class StressRandom {
+public:
+	explicit StressRandom(uint32_t seed) {
+		state = seed == 0 ? 1 : seed;
+	}
+	uint32_t next() {
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return state;
+	}
+private:
+	uint32_t state;
+};
+
+#if EFI_EVENT_QUEUE_HEAP
+#define STRESS_SLOT_COUNT (EVENT_QUEUE_MAX_SIZE - 1)
+#else
+#define STRESS_SLOT_COUNT 2048
+#endif
+
+static scheduling_s stressSlots[STRESS_SLOT_COUNT];
+static int stressSlotFireCounts[STRESS_SLOT_COUNT];
+
+static void stressSlotCallback(void *param) {
+	stressSlotFireCounts[(scheduling_s *) param - stressSlots]++;
+}
+
+/**
+ * raw EventQueue churn with random timestamps: every inserted event fires exactly
+ * once, in timestamp order, and the queue drains completely at the horizon
+ */
+TEST(pwm_stress, schedulerChurn) {
+	EventQueue queue;
+	StressRandom random(20200828);
+
+	const int rounds = 10;
+	const int horizonUs = 10000;
+	efitime_t now = 0;
+	int totalExecuted = 0;
+
+	for (int round = 0; round < rounds; round++) {
+		memset(stressSlotFireCounts, 0, sizeof(stressSlotFireCounts));
+		for (int i = 0; i < STRESS_SLOT_COUNT; i++) {
+			queue.insertTask(&stressSlots[i], now + 1 + random.next() % horizonUs,
+					{ stressSlotCallback, &stressSlots[i] });
+		}
+		ASSERT_EQ(STRESS_SLOT_COUNT, queue.size()) << "fill of round " << round;
+
+		// advance in uneven slices so executions interleave with pending entries
+		efitime_t roundEnd = now + horizonUs;
+		while (now < roundEnd) {
+			now += 1 + random.next() % 500;
+			if (now > roundEnd) {
+				now = roundEnd;
+			}
+			totalExecuted += queue.executeAll(now);
+			ASSERT_LE(queue.size(), STRESS_SLOT_COUNT) << "queue depth bound";
+		}
+
+		ASSERT_EQ(0, queue.size()) << "drain of round " << round;
+		for (int i = 0; i < STRESS_SLOT_COUNT; i++) {
+			ASSERT_EQ(1, stressSlotFireCounts[i]) << "slot " << i << " of round " << round;
+		}
+	}
+	ASSERT_EQ(rounds * STRESS_SLOT_COUNT, totalExecuted) << "total execution accounting";
+}
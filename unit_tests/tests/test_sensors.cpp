@@ -8,6 +8,7 @@
 #include "global.h"
 #include "thermistors.h"
 #include "allsensors.h"
+#include "sensor_calibration.h"
 #include "engine_test_helper.h"
 
 
@@ -83,3 +84,61 @@ TEST(sensors, ThermistorNeon)
 	assertEqualsM("B", 0.0003, tm.s_h_b);
 	ASSERT_NEAR(0.0, tm.s_h_c, EPS4D);
 }
+
+TEST(sensors, thermistorPiecewiseLinearCurve)
+{
+	ThermistorMath tm;
+	// 2003 Neon sensor with a 2.7K pull-up
+	thermistor_conf_s tc = {0, 30, 100, 32500, 7550, 700, 2700};
+	tm.setConfig(&tc);
+
+	// the compiled curve has to agree with the exact Steinhart-Hart math across the
+	// usable voltage range - worst case error for this sensor is about 0.14 deg C
+	for (float voltage = 0.5f; voltage < 4.51f; voltage += 0.05f) {
+		float resistance = getR2InVoltageDividor(voltage, 5.0f, tc.bias_resistor);
+		float exact = tm.getKelvinTemperatureByResistance(resistance) - KELV;
+		ASSERT_NEAR(exact, tm.getCelsiusByVoltage(voltage), 0.3f) << "V=" << voltage;
+	}
+}
+
+TEST(sensors, tpsSweepCalibrator) {
+	TpsSweepCalibrator calibrator;
+	ASSERT_FALSE(calibrator.isActive());
+
+	calibrator.start(10);
+	ASSERT_TRUE(calibrator.isActive());
+
+	// closed throttle with +-2 counts of ADC noise
+	calibrator.onSample(100);
+	calibrator.onSample(102);
+	calibrator.onSample(98);
+	ASSERT_NEAR(30, calibrator.getProgress(), EPS4D);
+
+	// sweep through mid travel - neither extreme cluster moves
+	calibrator.onSample(400);
+	calibrator.onSample(700);
+
+	// wide open, again with noise
+	calibrator.onSample(900);
+	calibrator.onSample(902);
+	calibrator.onSample(898);
+
+	// back towards closed, one sample rejoins the min cluster
+	calibrator.onSample(300);
+	calibrator.onSample(101);
+
+	ASSERT_FALSE(calibrator.isActive());
+	ASSERT_TRUE(calibrator.isDone());
+	ASSERT_TRUE(calibrator.isResultUsable());
+	// cluster averages, not single extreme samples
+	ASSERT_NEAR(100.25, calibrator.getMinResult(), EPS4D);
+	ASSERT_NEAR(900, calibrator.getMaxResult(), EPS4D);
+
+	// a sweep which never moved the throttle is rejected
+	calibrator.start(3);
+	calibrator.onSample(100);
+	calibrator.onSample(101);
+	calibrator.onSample(99);
+	ASSERT_TRUE(calibrator.isDone());
+	ASSERT_FALSE(calibrator.isResultUsable());
+}
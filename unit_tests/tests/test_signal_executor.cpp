@@ -164,3 +164,81 @@ TEST(misc, testSignalExecutor) {
 	ASSERT_EQ(2, callbackCounter);
 	testSignalExecutor2();
 }
+
+static int executionLog[4];
+static int executionLogIndex;
+
+static void logOrderCallback(void *a) {
+	executionLog[executionLogIndex++] = (int)(long)a;
+}
+
+TEST(misc, testEventQueueShedding) {
+	eq.clear();
+	eq.shedCounter = 0;
+	executionLogIndex = 0;
+
+	scheduling_s tachEvent;
+	scheduling_s coilEvent;
+
+	// both events are overdue: the auxiliary one is due first but the ignition one must not wait for it
+	eq.insertTask(&tachEvent, 10, { logOrderCallback, (void*)1, SCHEDULE_PRIORITY_AUXILIARY });
+	eq.insertTask(&coilEvent, 12, { logOrderCallback, (void*)2, SCHEDULE_PRIORITY_IGNITION });
+
+	ASSERT_EQ(2, eq.executeAll(100));
+
+	ASSERT_EQ(2, executionLogIndex);
+	ASSERT_EQ(2, executionLog[0]) << "ignition found first";
+	ASSERT_EQ(1, executionLog[1]) << "auxiliary displaced";
+	ASSERT_EQ(1, eq.shedCounter);
+
+	// a lone overdue low-priority event is not displaced
+	eq.insertTask(&tachEvent, 200, { logOrderCallback, (void*)1, SCHEDULE_PRIORITY_AUXILIARY });
+	ASSERT_EQ(1, eq.executeAll(300));
+	ASSERT_EQ(1, eq.shedCounter);
+}
+
+extern int timeNowUs;
+
+static void expensiveCallback(void *) {
+	callbackCounter++;
+}
+
+static void cheapCallback(void *) {
+	callbackCounter++;
+}
+
+TEST(misc, testVirtualTimeLatencyHarness) {
+	timeNowUs = 0;
+	callbackCounter = 0;
+	TestExecutor executor;
+	executor.resetLatencyStats();
+	// the expensive action occupies 30us of virtual time per execution
+	executor.setActionCost((schfunc_t) expensiveCallback, 30);
+
+	scheduling_s s1;
+	scheduling_s s2;
+	scheduling_s s3;
+
+	/**
+	 * the expensive action starts on time at 100, runs until 130, so the cheap
+	 * actions scheduled for 110 and 120 start late by 20 and 40 respectively
+	 */
+	executor.scheduleByTimestamp(&s1, 100, expensiveCallback);
+	executor.scheduleByTimestamp(&s2, 110, cheapCallback);
+	executor.scheduleByTimestamp(&s3, 120, cheapCallback);
+
+	ASSERT_EQ(3, executor.advanceTime(200));
+	ASSERT_EQ(3, callbackCounter);
+	ASSERT_EQ(200, timeNowUs) << "clock advanced precisely to target";
+	ASSERT_EQ(3, executor.maxQueueDepth);
+	// the second cheap action waited from 120 until the first one "finished" at 160?
+	// no: cheap actions are free, so it only waited for the expensive one: 130 - 120
+	ASSERT_EQ(20, executor.maxLatenessUs);
+
+	// an event beyond the advance window is left alone
+	executor.resetLatencyStats();
+	scheduling_s s4;
+	executor.scheduleByTimestamp(&s4, 500, cheapCallback);
+	ASSERT_EQ(0, executor.advanceTime(100));
+	ASSERT_EQ(1, executor.size());
+}
@@ -333,7 +333,7 @@ TEST(misc, testRpmCalculator) {
 	eth.engine.periodicFastCallback(PASS_ENGINE_PARAMETER_SIGNATURE);
 
 	assertEqualsM("fuel #1", 4.5450, engine->injectionDuration);
-	InjectionEvent *ie0 = &engine->injectionEvents.elements[0];
+	InjectionEvent *ie0 = &engine->injectionEvents->elements[0];
 	assertEqualsM("injection angle", 31.365, ie0->injectionStart.angleOffsetFromTriggerEvent);
 
 	eth.firePrimaryTriggerRise();
@@ -593,7 +593,7 @@ static void setTestBug299(EngineTestHelper *eth) {
 	eth->assertInjectorDownEvent("1@3", 3, MS2US(20), 1);
 	ASSERT_EQ( 0,  eth->executeActions()) << "exec#0";
 
-	FuelSchedule * t = &ENGINE(injectionEvents);
+	FuelSchedule * t = ENGINE(injectionEvents);
 
 	assertInjectionEvent("#0", &t->elements[0], 0, 1, 153);
 	assertInjectionEvent("#1_i_@", &t->elements[1], 1, 1, 333);
@@ -768,7 +768,7 @@ void doTestFuelSchedulerBug299smallAndMedium(int startUpDelayMs) {
 	engine->periodicFastCallback(PASS_ENGINE_PARAMETER_SIGNATURE);
 
 
-	t = &ENGINE(injectionEvents);
+	t = ENGINE(injectionEvents);
 
 	assertInjectionEvent("#0", &t->elements[0], 0, 0, 315);
 	assertInjectionEvent("#1__", &t->elements[1], 1, 1, 135);
@@ -856,7 +856,7 @@ void doTestFuelSchedulerBug299smallAndMedium(int startUpDelayMs) {
 	eth.moveTimeForwardUs(MS2US(20));
 	ASSERT_EQ( 4,  eth.executeActions()) << "executeAll#4";
 
-	t = &ENGINE(injectionEvents);
+	t = ENGINE(injectionEvents);
 
 	assertInjectionEvent("#0#", &t->elements[0], 0, 0, 315);
 	assertInjectionEvent("#1#", &t->elements[1], 1, 1, 135);
@@ -906,7 +906,7 @@ void doTestFuelSchedulerBug299smallAndMedium(int startUpDelayMs) {
 
 	engine->periodicFastCallback(PASS_ENGINE_PARAMETER_SIGNATURE);
 
-	t = &ENGINE(injectionEvents);
+	t = ENGINE(injectionEvents);
 
 	assertInjectionEvent("#00", &t->elements[0], 0, 0, 225); // 87.5 duty cycle
 	assertInjectionEvent("#10", &t->elements[1], 1, 1, 45);
@@ -0,0 +1,232 @@
+/**
+ * @file	test_trigger_fuzz.cpp
+ *
+ * Noise-injection matrix over the trigger decoder: we feed every known trigger
+ * shape through TriggerState::decodeTriggerEvent the same way
+ * TriggerStimulatorHelper does, but with a seeded noise layer on top - timing
+ * jitter, dropped edges, spurious edges, duty cycle distortion. The point is a
+ * repeatable decode-robustness number for each trigger type so that decoder
+ * changes can be judged on sync retention, not just on the perfect waveform.
+ *
+ * Results are printed as machine-readable lines:
+ *     FUZZ,<trigger>,<profile>,<events>,<revolutions>,<errors>,<synced>
+ *
+ * @date Aug 28, 2020
+ */
+
+#include "global.h"
+#include "unit_test_framework.h"
+#include "engine.h"
+#include "trigger_decoder.h"
+#include "trigger_emulator_algo.h"
+#include "trigger_simulator.h"
+
+// same cycle period the perfect-waveform simulator uses, see trigger_simulator.cpp
+#define FUZZ_CYCLE_PERIOD 720000
+
+#define FUZZ_CYCLE_COUNT 20
+
+typedef struct {
+	const char *name;
+	/**
+	 * each edge is moved by up to this fraction of the gap to the previous edge
+	 */
+	float jitterFrac;
+	/**
+	 * probability that an edge is simply never delivered
+	 */
+	float dropProb;
+	/**
+	 * probability of a short spurious pulse on the primary channel between real edges
+	 */
+	float spuriousProb;
+	/**
+	 * primary falling edges are delayed by this fraction of the gap, i.e. duty distortion
+	 */
+	float dutyShiftFrac;
+} trigger_noise_profile_s;
+
+static const trigger_noise_profile_s noiseProfiles[] = {
+		{ "clean",     0.00f, 0.00f, 0.00f, 0.00f },
+		{ "jitter5",   0.05f, 0.00f, 0.00f, 0.00f },
+		{ "jitter20",  0.20f, 0.00f, 0.00f, 0.00f },
+		{ "dropped2",  0.00f, 0.02f, 0.00f, 0.00f },
+		{ "spurious2", 0.00f, 0.00f, 0.02f, 0.00f },
+		{ "duty10",    0.00f, 0.00f, 0.00f, 0.10f },
+		{ "dirty",     0.05f, 0.01f, 0.01f, 0.05f },
+};
+
+typedef struct {
+	int eventCount;
+	int revolutions;
+	int decodeErrors;
+	bool synced;
+} fuzz_result_s;
+
+/**
+ * tiny deterministic PRNG so runs are reproducible across hosts, seeded per cell
+ * of the matrix - rand() state would leak between cells
+ */
+class FuzzRandom {
+public:
+	explicit FuzzRandom(uint32_t seed) {
+		state = seed == 0 ? 1 : seed;
+	}
+
+	float nextFloat() {
+		// xorshift32
+		state ^= state << 13;
+		state ^= state >> 17;
+		state ^= state << 5;
+		return (state & 0xFFFFFF) / (float) 0x1000000;
+	}
+
+	/**
+	 * @return uniform in [-1;1]
+	 */
+	float nextSigned() {
+		return 2 * nextFloat() - 1;
+	}
+
+private:
+	uint32_t state;
+};
+
+static void fireFuzzedEvent(TriggerState *state, TriggerWaveform *shape, trigger_event_e signal,
+		int timeUs, fuzz_result_s *result DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	if (!isUsefulSignal(signal PASS_CONFIG_PARAMETER_SUFFIX)) {
+		return;
+	}
+	state->decodeTriggerEvent(shape, nullptr, nullptr, signal, timeUs PASS_CONFIG_PARAMETER_SUFFIX);
+	result->eventCount++;
+}
+
+static const trigger_event_e risingEventByChannel[] = { SHAFT_PRIMARY_RISING, SHAFT_SECONDARY_RISING, SHAFT_3RD_RISING };
+static const trigger_event_e fallingEventByChannel[] = { SHAFT_PRIMARY_FALLING, SHAFT_SECONDARY_FALLING, SHAFT_3RD_FALLING };
+
+/**
+ * same event stream TriggerStimulatorHelper::feedSimulatedEvent produces, with
+ * the noise profile applied on top of the nominal edge times
+ */
+static fuzz_result_s runFuzzedDecode(const trigger_noise_profile_s *profile, uint32_t seed
+		DECLARE_ENGINE_PARAMETER_SUFFIX) {
+	TriggerWaveform *shape = &engine->triggerCentral.triggerShape;
+	MultiChannelStateSequence *wave = &shape->wave;
+	int size = shape->getSize();
+
+	TriggerState state;
+	state.resetTriggerState();
+	FuzzRandom random(seed);
+	fuzz_result_s result = { 0, 0, 0, false };
+
+	int lastFiredUs = 0;
+	int lastNominalUs = 0;
+
+	for (int i = 0; i < FUZZ_CYCLE_COUNT * size; i++) {
+		int stateIndex = i % size;
+		int loopIndex = i / size;
+		int nominalUs = (int) (FUZZ_CYCLE_PERIOD * (loopIndex + wave->getSwitchTime(stateIndex)));
+		int gapUs = nominalUs - lastNominalUs;
+		lastNominalUs = nominalUs;
+
+		if (profile->spuriousProb > 0 && random.nextFloat() < profile->spuriousProb) {
+			// a short glitch pulse on the primary channel somewhere inside the gap
+			int glitchUs = maxI(lastFiredUs + 1, nominalUs - gapUs / 2);
+			fireFuzzedEvent(&state, shape, SHAFT_PRIMARY_RISING, glitchUs, &result PASS_ENGINE_PARAMETER_SUFFIX);
+			fireFuzzedEvent(&state, shape, SHAFT_PRIMARY_FALLING, glitchUs + 10, &result PASS_ENGINE_PARAMETER_SUFFIX);
+			lastFiredUs = glitchUs + 10;
+		}
+
+		for (int channel = 0; channel < PWM_PHASE_MAX_WAVE_PER_PWM; channel++) {
+			if (!needEvent(stateIndex, size, wave, channel)) {
+				continue;
+			}
+			if (profile->dropProb > 0 && random.nextFloat() < profile->dropProb) {
+				continue;
+			}
+			pin_state_t currentValue = wave->getChannelState(channel, stateIndex);
+			trigger_event_e signal = currentValue ? risingEventByChannel[channel] : fallingEventByChannel[channel];
+
+			int timeUs = nominalUs + (int) (gapUs * profile->jitterFrac * random.nextSigned());
+			if (channel == 0 && !currentValue) {
+				timeUs += (int) (gapUs * profile->dutyShiftFrac);
+			}
+			// noise must not break monotonic time, the real capture hardware cannot either
+			timeUs = maxI(timeUs, lastFiredUs + 1);
+
+			fireFuzzedEvent(&state, shape, signal, timeUs, &result PASS_ENGINE_PARAMETER_SUFFIX);
+			lastFiredUs = timeUs;
+		}
+	}
+
+	result.revolutions = state.getTotalRevolutionCounter();
+	result.decodeErrors = state.totalTriggerErrorCounter;
+	// retained sync: still synchronized at the end and not stuck for most of the run
+	result.synced = state.shaft_is_synchronized && result.revolutions >= FUZZ_CYCLE_COUNT / 2;
+	return result;
+}
+
+TEST(trigger, fuzzNoiseMatrix) {
+	int cleanSyncFailures = 0;
+
+	for (int triggerId = 1; triggerId < TT_UNUSED; triggerId++) {
+		trigger_type_e tt = (trigger_type_e) triggerId;
+
+		// same local-engine pattern as printAllTriggers()
+		persistent_config_s pc;
+		Engine e(&pc);
+		Engine *engine = &e;
+		persistent_config_s *config = &pc;
+		engine_configuration_s *engineConfiguration = &pc.engineConfiguration;
+
+		engineConfiguration->trigger.type = tt;
+		engineConfiguration->ambiguousOperationMode = FOUR_STROKE_CAM_SENSOR;
+
+		engine->initializeTriggerWaveform(NULL PASS_ENGINE_PARAMETER_SUFFIX);
+		if (engine->triggerCentral.triggerShape.shapeDefinitionError) {
+			printf("FUZZ,%s,skipped shape definition error\r\n", getTrigger_type_e(tt));
+			continue;
+		}
+
+		for (size_t profileIndex = 0; profileIndex < efi::size(noiseProfiles); profileIndex++) {
+			const trigger_noise_profile_s *profile = &noiseProfiles[profileIndex];
+			uint32_t seed = 7 * triggerId + 1000 * profileIndex;
+
+			fuzz_result_s result = runFuzzedDecode(profile, seed PASS_ENGINE_PARAMETER_SUFFIX);
+
+			printf("FUZZ,%s,%s,%d,%d,%d,%d\r\n", getTrigger_type_e(tt), profile->name,
+					result.eventCount, result.revolutions, result.decodeErrors, result.synced ? 1 : 0);
+
+			if (profileIndex == 0) {
+				// the clean profile is the simulator's own feed, every valid shape must decode
+				EXPECT_TRUE(result.synced) << "clean decode lost sync on " << getTrigger_type_e(tt);
+				cleanSyncFailures += result.synced ? 0 : 1;
+			}
+		}
+	}
+	ASSERT_EQ(0, cleanSyncFailures);
+}
+
+/**
+ * the missing-tooth wheel is our robustness baseline: mild jitter and a few
+ * dropped edges must not lose sync, only cost some error counter increments
+ */
+TEST(trigger, fuzz60_2Robustness) {
+	persistent_config_s pc;
+	Engine e(&pc);
+	Engine *engine = &e;
+	persistent_config_s *config = &pc;
+	engine_configuration_s *engineConfiguration = &pc.engineConfiguration;
+
+	engineConfiguration->trigger.type = TT_TOOTHED_WHEEL_60_2;
+	engineConfiguration->ambiguousOperationMode = FOUR_STROKE_CRANK_SENSOR;
+
+	engine->initializeTriggerWaveform(NULL PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_FALSE(engine->triggerCentral.triggerShape.shapeDefinitionError);
+
+	fuzz_result_s jittered = runFuzzedDecode(&noiseProfiles[1], /*seed*/ 42 PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_TRUE(jittered.synced) << "60-2 lost sync under 5% jitter";
+
+	fuzz_result_s dropped = runFuzzedDecode(&noiseProfiles[3], /*seed*/ 42 PASS_ENGINE_PARAMETER_SUFFIX);
+	ASSERT_TRUE(dropped.synced) << "60-2 lost sync with 2% dropped edges";
+}
@@ -8,6 +8,9 @@
 #include <string.h>
 
 #include "cyclic_buffer.h"
+#include "monotonic_deque.h"
+#include "ext_table_cache.h"
+#include "switch_inputs.h"
 #include "global.h"
 #include "histogram.h"
 
@@ -21,10 +24,12 @@
 #include "lcd_menu_tree.h"
 #include "crc.h"
 #include "fl_stack.h"
+#include "spsc_ring.h"
 #include "io_pins.h"
 #include "counter64.h"
 #include "efi_gpio.h"
 #include "efilib.h"
+#include "table_helper.h"
 
 #include "gtest/gtest.h"
 
@@ -101,6 +106,102 @@ TEST(util, cyclicBuffer) {
 
 }
 
+TEST(util, runningCyclicBuffer) {
+	running_cyclic_buffer<int, 8> rb(6);
+
+	// partially filled window
+	rb.add(10);
+	rb.add(2);
+	ASSERT_EQ(12, rb.getRunningSum());
+
+	// fill past the window length, the oldest elements are evicted from the sum
+	for (int i = 0; i < 6; i++) {
+		rb.add(1);
+	}
+	ASSERT_EQ(6, rb.getRunningSum());
+
+	// wrap around the power-of-two capacity a few times
+	for (int i = 0; i < 20; i++) {
+		rb.add(i);
+	}
+	ASSERT_EQ(19 + 18 + 17 + 16 + 15 + 14, rb.getRunningSum());
+	ASSERT_EQ(19, rb.get(rb.getCount() - 1));
+
+	rb.clear();
+	ASSERT_EQ(0, rb.getRunningSum());
+}
+
+TEST(util, spscRing) {
+	spsc_ring<int, 4> ring;
+
+	ASSERT_TRUE(ring.isEmpty());
+	int value;
+	ASSERT_FALSE(ring.poll(&value));
+
+	ASSERT_TRUE(ring.offer(10));
+	ASSERT_TRUE(ring.offer(20));
+	ASSERT_EQ(2, ring.size());
+
+	ASSERT_TRUE(ring.poll(&value));
+	ASSERT_EQ(10, value);
+
+	// fill to capacity, the next offer is rejected, nothing is overwritten
+	ASSERT_TRUE(ring.offer(30));
+	ASSERT_TRUE(ring.offer(40));
+	ASSERT_TRUE(ring.offer(50));
+	ASSERT_FALSE(ring.offer(60));
+
+	ASSERT_TRUE(ring.poll(&value));
+	ASSERT_EQ(20, value);
+
+	// run the free-running counters around the power-of-two capacity a few times
+	for (int i = 0; i < 100; i++) {
+		ASSERT_TRUE(ring.offer(i));
+		ASSERT_TRUE(ring.poll(&value));
+		ASSERT_EQ(i, value);
+	}
+	ASSERT_EQ(3, ring.size());
+
+	ring.clear();
+	ASSERT_TRUE(ring.isEmpty());
+}
+
+TEST(util, monotonicDeque) {
+	monotonic_deque<int, int> md;
+	md.setWindow(3);
+
+	ASSERT_TRUE(md.isEmpty());
+
+	md.add(10, 100);
+	ASSERT_EQ(10, md.getMax());
+	ASSERT_EQ(100, md.getMaxTag());
+
+	md.add(30, 300);
+	ASSERT_EQ(30, md.getMax());
+	ASSERT_EQ(300, md.getMaxTag());
+
+	// a smaller sample does not displace the maximum
+	md.add(20, 200);
+	ASSERT_EQ(30, md.getMax());
+
+	// the 30 is still within the 3-sample window
+	md.add(5, 50);
+	ASSERT_EQ(30, md.getMax());
+
+	// now the 30 has expired, the 20 is the best of {20, 5, 7}
+	md.add(7, 70);
+	ASSERT_EQ(20, md.getMax());
+	ASSERT_EQ(200, md.getMaxTag());
+
+	// on a tie the newest sample wins
+	md.add(20, 222);
+	ASSERT_EQ(20, md.getMax());
+	ASSERT_EQ(222, md.getMaxTag());
+
+	md.clear();
+	ASSERT_TRUE(md.isEmpty());
+}
+
 TEST(util, histogram) {
 	print("******************************************* testHistogram\r\n");
 
@@ -144,6 +245,29 @@ TEST(util, histogram) {
 	ASSERT_EQ(1011, result[4]);
 }
 
+TEST(util, log2Histogram) {
+	ASSERT_EQ(0, log2HistogramGetIndex(0));
+	ASSERT_EQ(1, log2HistogramGetIndex(1));
+	ASSERT_EQ(2, log2HistogramGetIndex(2));
+	ASSERT_EQ(2, log2HistogramGetIndex(3));
+	ASSERT_EQ(8, log2HistogramGetIndex(255));
+	ASSERT_EQ(9, log2HistogramGetIndex(256));
+	ASSERT_EQ(32, log2HistogramGetIndex(0xffffffff));
+
+	log2_histogram_s h;
+	initLog2Histogram(&h, "test");
+
+	hsLog2Add(&h, 0);
+	hsLog2Add(&h, 5);
+	hsLog2Add(&h, 6);
+	hsLog2Add(&h, 1000);
+
+	ASSERT_EQ(1, hsLog2GetCount(&h, 0));
+	ASSERT_EQ(2, hsLog2GetCount(&h, 3));
+	ASSERT_EQ(1, hsLog2GetCount(&h, 10));
+	ASSERT_EQ(0, hsLog2GetCount(&h, 20));
+}
+
 static void testMalfunctionCentralRemoveNonExistent() {
 	print("******************************************* testMalfunctionCentralRemoveNonExistent\r\n");
 	initMalfunctionCentral();
@@ -306,6 +430,47 @@ TEST(misc, testGpsParser) {
 	ASSERT_EQ( 360,  GPSdata.course) << "4 course";
 }
 
+static int feedGpsSentence(nmea_parser_state *parser, const char *sentence, loc_t *fix) {
+	int fixes = 0;
+	for (const char *p = sentence; *p != 0; p++) {
+		fixes += nmea_parser_feed(parser, *p, fix);
+	}
+	return fixes;
+}
+
+TEST(misc, testGpsParserIncremental) {
+	static nmea_parser_state parser;
+	static loc_t fix;
+	nmea_parser_init(&parser);
+	memset(&fix, 0, sizeof(fix));
+
+	// same sentences as testGpsParser above, fed one byte at a time
+	ASSERT_EQ(1, feedGpsSentence(&parser, "$GPRMC,111609.14,A,5001.27,N,3613.06,E,11.2,0.0,261206,0.0,E*50\r\n", &fix));
+	ASSERT_EQ(4, fix.quality);
+	assertEqualsM("inc latitude", 5001.27, fix.latitude);
+	assertEqualsM("inc longitude", 3613.06, fix.longitude);
+	assertEqualsM("inc speed", 11.2, fix.speed);
+	ASSERT_EQ(2006, fix.GPStm.tm_year + 1900);
+	ASSERT_EQ(26, fix.GPStm.tm_mday);
+	ASSERT_EQ(11, fix.GPStm.tm_hour);
+	ASSERT_EQ(9, fix.GPStm.tm_sec);
+
+	// a corrupted checksum is rejected and leaves the fix untouched
+	ASSERT_EQ(0, feedGpsSentence(&parser, "$GPRMC,111609.14,A,5001.27,N,3613.06,E,99.9,0.0,261206,0.0,E*51\r\n", &fix));
+	assertEqualsM("kept speed", 11.2, fix.speed);
+
+	// GPGGA converts to decimal degrees, same as the buffer-based parser
+	ASSERT_EQ(1, feedGpsSentence(&parser, "$GPGGA,111609.14,5001.27,N,3613.06,E,3,08,0.0,10.2,M,0.0,M,0.0,0000*70\r\n", &fix));
+	ASSERT_EQ(3, fix.quality);
+	assertEqualsM("gga latitude", 50.0212, fix.latitude);
+	assertEqualsM("gga longitude", 36.2177, fix.longitude);
+	assertEqualsM("gga altitude", 10.2, fix.altitude);
+
+	// garbage between sentences is ignored, the next '$' resyncs the machine
+	ASSERT_EQ(1, feedGpsSentence(&parser, "x#42$GPRMC,173843,A,3349.896,N,11808.521,W,000.0,360.0,230108,013.4,E*69\r\n", &fix));
+	ASSERT_EQ(360, fix.course);
+}
+
 // this buffer is needed because on Unix you would not be able to change static char constants
 static char buffer[300];
 
@@ -508,3 +673,143 @@ TEST(util, datalogging) {
 //	printf("Got [%s]\r\n", LOGGING_BUFFER);
 //	ASSERT_STREQ("rusEfiVersion,776655@321ID DEFAULT_FRANKENSO 239,", LOGGING_BUFFER);
 }
+
+TEST(misc, testFindIndexFixed) {
+	float array16[16];
+	for (int i = 0; i < 16; i++) {
+		array16[i] = 100 * (i + 1);
+	}
+
+	// the unrolled fixed-size search must agree with the generic one across the whole axis
+	for (float value = 0; value < 1800; value += 7) {
+		ASSERT_EQ(findIndex(array16, 16, value), (findIndexFixed<16, float>(array16, value))) << "value " << value;
+	}
+
+	ASSERT_EQ(-1, (findIndexFixed<16, float>(array16, 99)));
+	ASSERT_EQ(0, (findIndexFixed<16, float>(array16, 100)));
+	ASSERT_EQ(15, (findIndexFixed<16, float>(array16, 5000)));
+
+	// hint flavor: a warm hint returns the same index without searching
+	int hint = -1;
+	ASSERT_EQ(7, (findIndexFixedWithHint<16, float>(array16, 850, &hint)));
+	ASSERT_EQ(7, hint);
+	ASSERT_EQ(7, (findIndexFixedWithHint<16, float>(array16, 870, &hint)));
+	ASSERT_EQ(-1, (findIndexFixedWithHint<16, float>(array16, 12, &hint)));
+}
+
+TEST(util, tableOverlayComposer) {
+	float base[2][2] = { { 10, 20 }, { 30, 40 } };
+	float gearRetard[2][2] = { { -1, -1 }, { -2, -2 } };
+	float bankTrim[2][2] = { { 0.5, 0.5 }, { 0.5, 0.5 } };
+
+	TableOverlayComposer<2, 2, float> composer;
+	composer.initBase(base);
+	int gearIndex = composer.addOverlay(gearRetard);
+	int bankIndex = composer.addOverlay(bankTrim);
+
+	// base flattening with nothing active is a plain copy
+	ASSERT_EQ(1, composer.composeCounter);
+	ASSERT_FLOAT_EQ(10, composer.effective[0][0]);
+	ASSERT_FLOAT_EQ(40, composer.effective[1][1]);
+
+	composer.setOverlayActive(gearIndex, true);
+	ASSERT_EQ(2, composer.composeCounter);
+	ASSERT_FLOAT_EQ(9, composer.effective[0][0]);
+	ASSERT_FLOAT_EQ(38, composer.effective[1][1]);
+
+	// re-activating an already active overlay must not recompose
+	composer.setOverlayActive(gearIndex, true);
+	ASSERT_EQ(2, composer.composeCounter);
+
+	composer.setOverlayActive(bankIndex, true);
+	ASSERT_FLOAT_EQ(9.5, composer.effective[0][0]);
+
+	composer.setOverlayActive(gearIndex, false);
+	ASSERT_FLOAT_EQ(10.5, composer.effective[0][0]);
+	ASSERT_TRUE(composer.isOverlayActive(bankIndex));
+	ASSERT_FALSE(composer.isOverlayActive(gearIndex));
+}
+
+#define EXT_CACHE_TEST_SIZE 32
+#define EXT_CACHE_TEST_WINDOW 8
+
+/**
+ * values are linear in indexes so interior bilinear interpolation is exact
+ */
+static float extCellValue(int rpmIndex, int loadIndex) {
+	return rpmIndex * 10 + loadIndex * 3;
+}
+
+static int extFetchCalls = 0;
+
+static bool extTestFetch(void *arg, int startRpmIndex, int startLoadIndex, int rows, int cols, float *dest) {
+	(void)arg;
+	extFetchCalls++;
+	for (int r = 0; r < rows; r++) {
+		for (int l = 0; l < cols; l++) {
+			dest[r * cols + l] = extCellValue(startRpmIndex + r, startLoadIndex + l);
+		}
+	}
+	return true;
+}
+
+TEST(util, extTableCache) {
+	static float rpmBins[EXT_CACHE_TEST_SIZE];
+	static float loadBins[EXT_CACHE_TEST_SIZE];
+	for (int i = 0; i < EXT_CACHE_TEST_SIZE; i++) {
+		rpmBins[i] = 1000 + i * 200;
+		loadBins[i] = i * 10;
+	}
+
+	static ExtTableCache<EXT_CACHE_TEST_SIZE, EXT_CACHE_TEST_WINDOW> cache;
+	extFetchCalls = 0;
+	cache.init(rpmBins, loadBins, extTestFetch, NULL);
+
+	// first lookup is a demand miss which fills the window
+	ASSERT_FLOAT_EQ(extCellValue(5, 5), cache.getValue(rpmBins[5], loadBins[5]));
+	ASSERT_EQ(1, cache.getFetchCount());
+	ASSERT_EQ(1, cache.getMissCount());
+
+	// wandering inside the cached window costs no fetches
+	ASSERT_FLOAT_EQ(5.5 * 10 + 5.5 * 3, cache.getValue(rpmBins[5] + 100, loadBins[5] + 5));
+	ASSERT_EQ(1, cache.getFetchCount());
+
+	// a jump across the table is a miss and recenters the window
+	ASSERT_FLOAT_EQ(extCellValue(25, 25), cache.getValue(rpmBins[25], loadBins[25]));
+	ASSERT_EQ(2, cache.getFetchCount());
+	ASSERT_EQ(2, cache.getMissCount());
+
+	// approaching the window edge prefetches ahead of the operating point
+	ASSERT_FLOAT_EQ(extCellValue(27, 25), cache.getValue(rpmBins[27], loadBins[25]));
+	ASSERT_EQ(3, cache.getFetchCount());
+	ASSERT_EQ(2, cache.getMissCount());
+	ASSERT_EQ(3, extFetchCalls);
+}
+
+TEST(util, debouncedSwitch) {
+	DebouncedSwitch sw;
+	ASSERT_FALSE(sw.getState());
+
+	// contact bounce: short blips never commit an edge
+	ASSERT_FALSE(sw.onSample(true, 1000));
+	ASSERT_FALSE(sw.onSample(false, 2000));
+	ASSERT_FALSE(sw.onSample(true, 3000));
+	ASSERT_FALSE(sw.onSample(true, 4000));
+	ASSERT_FALSE(sw.getState());
+
+	// a state which persists for SWITCH_DEBOUNCE_TICKS commits and timestamps
+	ASSERT_TRUE(sw.onSample(true, 5000));
+	ASSERT_TRUE(sw.getState());
+	ASSERT_EQ(5000, sw.getLastEdgeUs());
+
+	// stable state resets the counter, no spurious edges
+	ASSERT_FALSE(sw.onSample(true, 6000));
+	ASSERT_EQ(5000, sw.getLastEdgeUs());
+
+	// release debounces the same way
+	ASSERT_FALSE(sw.onSample(false, 7000));
+	ASSERT_FALSE(sw.onSample(false, 8000));
+	ASSERT_TRUE(sw.onSample(false, 9000));
+	ASSERT_FALSE(sw.getState());
+	ASSERT_EQ(9000, sw.getLastEdgeUs());
+}
@@ -4,6 +4,7 @@ TESTS_SRC_CPP = \
 	tests/test_aux_valves.cpp \
 	tests/test_on_demand_parameters.cpp \
 	tests/test_hip9011.cpp \
+	tests/test_knock_analyzer.cpp \
 	tests/test_cj125.cpp \
 	tests/test_cam_vtt_input.cpp \
 	tests/test_engine_math.cpp \
@@ -32,8 +33,13 @@ TESTS_SRC_CPP = \
 	tests/test_sensors.cpp \
 	tests/test_pid_auto.cpp \
 	tests/test_pid.cpp \
+	tests/test_pid_characterization.cpp \
 	tests/test_accel_enrichment.cpp \
 	tests/test_gpiochip.cpp \
+	tests/benchmark_suite.cpp \
+	tests/test_trigger_fuzz.cpp \
+	tests/test_corpus_replay.cpp \
+	tests/test_pwm_stress.cpp \
 	tests/sensor/basic_sensor.cpp \
 	tests/sensor/func_sensor.cpp \
 	tests/sensor/function_pointer_sensor.cpp \
@@ -29,6 +29,13 @@ void assertEqualsM(const char *msg, float expected, float actual) {
 	assertEqualsM2(msg, expected, actual, 0.0001);
 }
 
+void reportBenchResult(const char *name, int iterations, double nsPerOp) {
+	// human-readable line for the person watching the run
+	printf("benchmark: %s %.1f ns/op\r\n", name, nsPerOp);
+	// machine-readable line for regression tracking, grep "^BENCH," out of the test log
+	printf("BENCH,%s,%d,%.1f\r\n", name, iterations, nsPerOp);
+}
+
 void chDbgAssert(int c, char *msg, void *arg) {
 	if (!c) {
 		printf("assert failed: %s\r\n", msg);
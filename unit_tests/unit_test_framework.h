@@ -31,3 +31,9 @@ void assertEqualsM(const char *msg, float expected, float actual);
 void assertEqualsLM(const char *msg, long expected, long actual);
 void assertEqualsM4(const char *prefix, const char *msg, float expected, float actual);
 
+/**
+ * prints the unified machine-readable "BENCH,<name>,<iterations>,<ns_per_op>" result
+ * line used by the benchmark.* test cases for regression tracking across commits
+ */
+void reportBenchResult(const char *name, int iterations, double nsPerOp);
+